@@ -0,0 +1,228 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define BENCH_MIN_ELEMENTS 1000
+#define BENCH_LIMIT_ELEMENTS 100000000
+
+/* Every key string is "key-" and eight hex digits */
+#define BENCH_STRING_SIZE 13
+
+volatile uint64_t bench_sink;
+
+static const char *const bench_type_names[] = {"int", "string"};
+
+static long bench_peak_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+void bench_report(const BenchContext *context, const char *variant, const char *operation,
+                  const char *distribution, const BenchClock *clock, size_t ops) {
+    double ns_per_op = ops > 0 ? (double) clock->total / (double) ops : 0.0;
+    double ops_per_sec = clock->total > 0 ? (double) ops * 1e9 / (double) clock->total : 0.0;
+
+    printf("{\"suite\":\"%s\",\"variant\":\"%s\",\"operation\":\"%s\",\"type\":\"%s\","
+           "\"distribution\":\"%s\",\"elements\":%zu,\"ops\":%zu,\"ns_per_op\":%.2f,"
+           "\"ops_per_sec\":%.0f,\"peak_rss_kb\":%ld,\"keys_rss_kb\":%ld}\n",
+           context->suite, variant, operation, bench_type_names[context->type],
+           distribution, context->elements, ops, ns_per_op, ops_per_sec, bench_peak_rss_kb(),
+           context->keys_rss_kb);
+}
+
+/* splitmix64, to make the runs reproducible */
+static uint64_t bench_random(uint64_t *state) {
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static double bench_random_unit(uint64_t *state) {
+    return (double) (bench_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* The Zipfian generator of Gray et al., "Quickly Generating Billion-Record
+ * Synthetic Databases", as YCSB uses it. Ranks are scattered over the
+ * positions so that the hot keys are not also the first ones inserted. */
+static void bench_zipfian(size_t *positions, size_t count, uint64_t *state) {
+    double theta = BENCH_ZIPF_THETA;
+    double zeta_n = 0.0;
+
+    for (size_t i = 1; i <= count; ++i) {
+        zeta_n += 1.0 / pow((double) i, theta);
+    }
+
+    double zeta_2 = 1.0 + 1.0 / pow(2.0, theta);
+    double alpha = 1.0 / (1.0 - theta);
+    double eta = (1.0 - pow(2.0 / (double) count, 1.0 - theta)) / (1.0 - zeta_2 / zeta_n);
+
+    for (size_t i = 0; i < count; ++i) {
+        double u = bench_random_unit(state);
+        double uz = u * zeta_n;
+        size_t rank;
+
+        if (uz < 1.0) {
+            rank = 0;
+        } else if (uz < 1.0 + pow(0.5, theta)) {
+            rank = 1;
+        } else {
+            rank = (size_t) ((double) count * pow(eta * u - eta + 1.0, alpha));
+            if (rank >= count) {
+                rank = count - 1;
+            }
+        }
+
+        uint64_t scatter = rank;
+        positions[i] = (size_t) (bench_random(&scatter) % count);
+    }
+}
+
+static int bench_keys_init(BenchKeys *keys, size_t count, BenchType type) {
+    keys->ints = malloc(2 * count * sizeof(int));
+    keys->strings = NULL;
+    keys->uniform = malloc(count * sizeof(size_t));
+    keys->zipfian = malloc(count * sizeof(size_t));
+    if (keys->ints == NULL || keys->uniform == NULL || keys->zipfian == NULL) {
+        return -1;
+    }
+
+    // Multiplying by an odd constant permutes the 32-bit integers, so the
+    // keys are distinct and scattered
+    for (size_t i = 0; i < 2 * count; ++i) {
+        keys->ints[i] = (int) (uint32_t) ((uint32_t) i * UINT32_C(2654435761));
+    }
+
+    if (type == BENCH_TYPE_STRING) {
+        keys->strings = malloc(2 * count * sizeof(char *));
+        char *chars = malloc(2 * count * BENCH_STRING_SIZE);
+        if (keys->strings == NULL || chars == NULL) {
+            free(chars);
+            return -1;
+        }
+
+        for (size_t i = 0; i < 2 * count; ++i) {
+            keys->strings[i] = chars + i * BENCH_STRING_SIZE;
+            snprintf(keys->strings[i], BENCH_STRING_SIZE, "key-%08x", (unsigned) keys->ints[i]);
+        }
+    }
+
+    uint64_t state = count;
+    for (size_t i = 0; i < count; ++i) {
+        keys->uniform[i] = (size_t) (bench_random(&state) % count);
+    }
+
+    bench_zipfian(keys->zipfian, count, &state);
+
+    return 0;
+}
+
+static void bench_keys_deinit(BenchKeys *keys) {
+    if (keys->strings != NULL) {
+        free(keys->strings[0]);
+    }
+
+    free(keys->strings);
+    free(keys->ints);
+    free(keys->uniform);
+    free(keys->zipfian);
+}
+
+static int bench_child(const char *suite, BenchSuite run, size_t elements, BenchType type) {
+    BenchKeys keys;
+    if (bench_keys_init(&keys, elements, type) != 0) {
+        fprintf(stderr, "%s: cannot allocate keys for %zu elements\n", suite, elements);
+        return EXIT_FAILURE;
+    }
+
+    BenchContext context;
+    context.suite = suite;
+    context.type = type;
+    context.elements = elements;
+    context.reps = elements < BENCH_TARGET_OPS ? BENCH_TARGET_OPS / elements : 1;
+    context.keys = &keys;
+    context.keys_rss_kb = bench_peak_rss_kb();
+
+    run(&context);
+
+    bench_keys_deinit(&keys);
+    fflush(stdout);
+
+    return EXIT_SUCCESS;
+}
+
+int bench_main(int argc, char **argv, const char *suite, BenchSuite run) {
+    const char *limit = argc > 1 ? argv[1] : getenv("BENCH_MAX_ELEMENTS");
+    size_t max_elements = BENCH_MAX_ELEMENTS;
+
+    if (limit != NULL && *limit != '\0') {
+        char *end;
+        unsigned long long value = strtoull(limit, &end, 10);
+        if (*end != '\0' || value < BENCH_MIN_ELEMENTS || value > BENCH_LIMIT_ELEMENTS) {
+            fprintf(stderr, "usage: %s [max elements, %d to %d]\n", argv[0],
+                    BENCH_MIN_ELEMENTS, BENCH_LIMIT_ELEMENTS);
+            return EXIT_FAILURE;
+        }
+
+        max_elements = (size_t) value;
+    }
+
+    int status = EXIT_SUCCESS;
+
+    for (size_t elements = BENCH_MIN_ELEMENTS; elements <= max_elements; elements *= 10) {
+        for (int type = BENCH_TYPE_INT; type <= BENCH_TYPE_STRING; ++type) {
+            // Unflushed output would be printed by both processes
+            fflush(stdout);
+
+            pid_t child = fork();
+            if (child < 0) {
+                perror("fork");
+                return EXIT_FAILURE;
+            }
+
+            if (child == 0) {
+                exit(bench_child(suite, run, elements, (BenchType) type));
+            }
+
+            int child_status;
+            if (waitpid(child, &child_status, 0) < 0 || !WIFEXITED(child_status) ||
+                WEXITSTATUS(child_status) != EXIT_SUCCESS) {
+                fprintf(stderr, "%s: run at %zu %s elements failed\n", suite, elements,
+                        bench_type_names[type]);
+                status = EXIT_FAILURE;
+            }
+        }
+    }
+
+    return status;
+}
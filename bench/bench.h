@@ -0,0 +1,184 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench.h
+ * @brief Shared harness of the libdsc microbenchmarks.
+ *
+ * Every benchmark binary registers one suite with bench_main. The suite is
+ * run once per element count (1K to BENCH_MAX_ELEMENTS, by factors of ten)
+ * and key type, each time in a child process of its own so that the peak RSS
+ * it reports belongs to that run alone.
+ *
+ * Results are written to stdout as JSON lines, one per measurement:
+ *
+ *     {"suite":"map","variant":"open","operation":"lookup","type":"int",
+ *      "distribution":"zipfian","elements":1000,"ops":2000000,
+ *      "ns_per_op":11.52,"ops_per_sec":86805555,"peak_rss_kb":5120,
+ *      "keys_rss_kb":3968}
+ *
+ * peak_rss_kb is the peak RSS of the run up to the measurement, and
+ * keys_rss_kb the peak once the keys were generated, so the difference is
+ * what the containers measured so far took at most.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../include/dsc_type.h"
+
+/**
+ * @brief The largest element count run by default.
+ *
+ * Override it with the first argument or the BENCH_MAX_ELEMENTS environment
+ * variable, up to 100000000.
+ */
+#define BENCH_MAX_ELEMENTS 1000000
+
+/**
+ * @brief The number of operations each measurement aims for.
+ *
+ * Small element counts are repeated until they reach it, so that every
+ * figure averages over enough work to be stable.
+ */
+#define BENCH_TARGET_OPS 2000000
+
+/**
+ * @brief The skew of the Zipfian lookup keys, as used by YCSB.
+ */
+#define BENCH_ZIPF_THETA 0.99
+
+typedef enum BenchType {
+    BENCH_TYPE_INT,    /** DSC_TYPE_INT elements. */
+    BENCH_TYPE_STRING  /** DSC_TYPE_STRING elements, 12 characters each. */
+} BenchType;
+
+/**
+ * @brief The keys of one run, generated before the suite starts.
+ */
+typedef struct BenchKeys BenchKeys;
+
+struct BenchKeys {
+    int *ints;         // count distinct keys, then count keys never inserted
+    char **strings;    // The same keys formatted as strings
+    size_t *uniform;   // count positions below count, uniformly distributed
+    size_t *zipfian;   // count positions below count, Zipfian distributed
+};
+
+typedef struct BenchContext BenchContext;
+
+struct BenchContext {
+    const char *suite;     // The name passed to bench_main
+    BenchType type;        // The type of the keys
+    size_t elements;       // The number of elements of every container
+    size_t reps;           // How often the suite repeats each measurement
+    const BenchKeys *keys; // The keys of this run
+    long keys_rss_kb;      // The peak RSS once the keys were generated
+};
+
+/**
+ * @brief Run every measurement of a suite for one element count and type.
+ */
+typedef void (*BenchSuite)(const BenchContext *context);
+
+/**
+ * @brief Accumulates the time spent in one operation over the repetitions.
+ */
+typedef struct BenchClock BenchClock;
+
+struct BenchClock {
+    uint64_t start; // When the current interval started
+    uint64_t total; // The time of every finished interval, in nanoseconds
+};
+
+/**
+ * @brief Written by suites with what they read, so that the compiler cannot
+ *        drop the reads.
+ */
+extern volatile uint64_t bench_sink;
+
+static inline uint64_t bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+static inline void bench_start(BenchClock *clock) {
+    clock->start = bench_now();
+}
+
+static inline void bench_stop(BenchClock *clock) {
+    clock->total += bench_now() - clock->start;
+}
+
+static inline DSCType bench_dsc_type(const BenchContext *context) {
+    return context->type == BENCH_TYPE_INT ? DSC_TYPE_INT : DSC_TYPE_STRING;
+}
+
+/**
+ * @brief The i-th key as the list, queue, stack, set and map functions take
+ *        it: a pointer to the int or to the char pointer.
+ *
+ * Indices from elements to twice that are keys that are never inserted.
+ */
+static inline void *bench_key(const BenchContext *context, size_t i) {
+    return context->type == BENCH_TYPE_INT ? (void *) &context->keys->ints[i]
+                                           : (void *) &context->keys->strings[i];
+}
+
+/**
+ * @brief The i-th key as dsc_vector_push_back takes it.
+ */
+static inline void *bench_element(const BenchContext *context, size_t i) {
+    return context->type == BENCH_TYPE_INT ? (void *) &context->keys->ints[i]
+                                           : (void *) context->keys->strings[i];
+}
+
+/**
+ * @brief Fold an element handed out by a for_each into bench_sink's input.
+ */
+static inline uint64_t bench_fold(const BenchContext *context, const void *element) {
+    return context->type == BENCH_TYPE_INT ? (uint64_t) *(const int *) element
+                                           : (uint64_t) *(const char *) element;
+}
+
+/**
+ * @brief Print one measurement.
+ *
+ * @param context The run the measurement belongs to.
+ * @param variant The implementation measured, such as a map backend.
+ * @param operation What was measured: insert, lookup, iterate or erase.
+ * @param distribution How the keys were picked: sequential, uniform,
+ *                     zipfian or missing.
+ * @param clock The time of every repetition.
+ * @param ops The number of operations timed by the clock.
+ */
+void bench_report(const BenchContext *context, const char *variant, const char *operation,
+                  const char *distribution, const BenchClock *clock, size_t ops);
+
+/**
+ * @brief Run a suite at every element count and key type.
+ *
+ * @return The exit status of the benchmark binary.
+ */
+int bench_main(int argc, char **argv, const char *suite, BenchSuite run);
+
+#endif // BENCH_H
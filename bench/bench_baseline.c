@@ -0,0 +1,354 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Baselines the containers are measured against: a plain growable C array,
+ * and a minimal linear-probing hash table with no type dispatch. Both copy
+ * string keys, as the containers do. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* Array */
+
+static void bench_array_lookup(const BenchContext *context, const int *ints, char *const *strings,
+                               const size_t *positions, BenchClock *clock) {
+    uint64_t sum = 0;
+
+    bench_start(clock);
+    if (context->type == BENCH_TYPE_INT) {
+        for (size_t i = 0; i < context->elements; ++i) {
+            sum += (uint64_t) ints[positions[i]];
+        }
+    } else {
+        for (size_t i = 0; i < context->elements; ++i) {
+            sum += strlen(strings[positions[i]]);
+        }
+    }
+    bench_stop(clock);
+
+    bench_sink += sum;
+}
+
+static void bench_array(const BenchContext *context) {
+    BenchClock insert = {0}, uniform = {0}, zipfian = {0}, iterate = {0}, erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        int *ints = NULL;
+        char **strings = NULL;
+        size_t size = 0;
+        size_t capacity = 0;
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i, ++size) {
+            if (size == capacity) {
+                capacity = capacity > 0 ? capacity * 2 : 16;
+                void *grown = context->type == BENCH_TYPE_INT
+                                  ? realloc(ints, capacity * sizeof(int))
+                                  : realloc(strings, capacity * sizeof(char *));
+                if (grown == NULL) {
+                    exit(EXIT_FAILURE);
+                }
+
+                if (context->type == BENCH_TYPE_INT) {
+                    ints = grown;
+                } else {
+                    strings = grown;
+                }
+            }
+
+            if (context->type == BENCH_TYPE_INT) {
+                ints[size] = context->keys->ints[i];
+            } else {
+                strings[size] = strdup(context->keys->strings[i]);
+            }
+        }
+        bench_stop(&insert);
+
+        bench_array_lookup(context, ints, strings, context->keys->uniform, &uniform);
+        bench_array_lookup(context, ints, strings, context->keys->zipfian, &zipfian);
+
+        uint64_t sum = 0;
+        bench_start(&iterate);
+        for (size_t i = 0; i < size; ++i) {
+            sum += context->type == BENCH_TYPE_INT ? (uint64_t) ints[i]
+                                                   : (uint64_t) *strings[i];
+        }
+        bench_stop(&iterate);
+        bench_sink += sum;
+
+        bench_start(&erase);
+        while (size > 0) {
+            --size;
+            if (context->type == BENCH_TYPE_STRING) {
+                free(strings[size]);
+            }
+        }
+        bench_stop(&erase);
+
+        free(ints);
+        free(strings);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "array", "insert", "sequential", &insert, ops);
+    bench_report(context, "array", "lookup", "uniform", &uniform, ops);
+    bench_report(context, "array", "lookup", "zipfian", &zipfian, ops);
+    bench_report(context, "array", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "array", "erase", "sequential", &erase, ops);
+}
+
+/* Open-addressing table */
+
+typedef struct BenchTable BenchTable;
+
+struct BenchTable {
+    unsigned char *used; // Whether each slot holds a key
+    int *ints;           // Int keys, or NULL
+    char **strings;      // String keys, or NULL
+    int *values;
+    size_t capacity;     // A power of two
+    size_t size;
+    BenchType type;
+};
+
+static uint64_t bench_table_hash(const BenchTable *table, const void *key) {
+    if (table->type == BENCH_TYPE_INT) {
+        uint64_t x = (uint32_t) *(const int *) key;
+        x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+        x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+        return x ^ (x >> 31);
+    }
+
+    // FNV-1a
+    uint64_t hash = UINT64_C(0xCBF29CE484222325);
+    for (const unsigned char *c = *(const unsigned char *const *) key; *c != '\0'; ++c) {
+        hash = (hash ^ *c) * UINT64_C(0x100000001B3);
+    }
+
+    return hash;
+}
+
+static bool bench_table_equal(const BenchTable *table, size_t slot, const void *key) {
+    return table->type == BENCH_TYPE_INT ? table->ints[slot] == *(const int *) key
+                                         : strcmp(table->strings[slot],
+                                                  *(char *const *) key) == 0;
+}
+
+static void bench_table_alloc(BenchTable *table, size_t capacity) {
+    table->used = calloc(capacity, 1);
+    table->ints = table->type == BENCH_TYPE_INT ? malloc(capacity * sizeof(int)) : NULL;
+    table->strings = table->type == BENCH_TYPE_STRING ? malloc(capacity * sizeof(char *)) : NULL;
+    table->values = malloc(capacity * sizeof(int));
+    table->capacity = capacity;
+
+    if (table->used == NULL || (table->ints == NULL && table->strings == NULL) ||
+        table->values == NULL) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void bench_table_free(BenchTable *table) {
+    free(table->used);
+    free(table->ints);
+    free(table->strings);
+    free(table->values);
+}
+
+/* Place a key known to be absent, taking ownership of string keys */
+static void bench_table_place(BenchTable *table, uint64_t hash, int key, char *string, int value) {
+    size_t mask = table->capacity - 1;
+    size_t slot = (size_t) hash & mask;
+
+    while (table->used[slot]) {
+        slot = (slot + 1) & mask;
+    }
+
+    table->used[slot] = 1;
+    if (table->type == BENCH_TYPE_INT) {
+        table->ints[slot] = key;
+    } else {
+        table->strings[slot] = string;
+    }
+    table->values[slot] = value;
+    table->size++;
+}
+
+static void bench_table_grow(BenchTable *table) {
+    BenchTable old = *table;
+
+    bench_table_alloc(table, old.capacity * 2);
+    table->size = 0;
+
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.used[i]) {
+            const void *key = old.type == BENCH_TYPE_INT ? (const void *) &old.ints[i]
+                                                         : (const void *) &old.strings[i];
+            bench_table_place(table, bench_table_hash(table, key),
+                              old.ints != NULL ? old.ints[i] : 0,
+                              old.strings != NULL ? old.strings[i] : NULL, old.values[i]);
+        }
+    }
+
+    bench_table_free(&old);
+}
+
+static bool bench_table_find(const BenchTable *table, const void *key, size_t *slot) {
+    size_t mask = table->capacity - 1;
+    size_t pos = (size_t) bench_table_hash(table, key) & mask;
+
+    while (table->used[pos]) {
+        if (bench_table_equal(table, pos, key)) {
+            *slot = pos;
+            return true;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return false;
+}
+
+static void bench_table_insert(BenchTable *table, const void *key, int value) {
+    size_t slot;
+    if (bench_table_find(table, key, &slot)) {
+        return;
+    }
+
+    // At most half full
+    if (2 * (table->size + 1) > table->capacity) {
+        bench_table_grow(table);
+    }
+
+    bench_table_place(table, bench_table_hash(table, key),
+                      table->type == BENCH_TYPE_INT ? *(const int *) key : 0,
+                      table->type == BENCH_TYPE_STRING ? strdup(*(char *const *) key) : NULL,
+                      value);
+}
+
+/* Backward-shift deletion, so that no tombstones are left behind */
+static void bench_table_erase(BenchTable *table, const void *key) {
+    size_t hole;
+    if (!bench_table_find(table, key, &hole)) {
+        return;
+    }
+
+    if (table->type == BENCH_TYPE_STRING) {
+        free(table->strings[hole]);
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t pos = (hole + 1) & mask;
+
+    while (table->used[pos]) {
+        const void *moved = table->type == BENCH_TYPE_INT ? (const void *) &table->ints[pos]
+                                                          : (const void *) &table->strings[pos];
+        size_t home = (size_t) bench_table_hash(table, moved) & mask;
+
+        // Move the key into the hole unless its home lies cyclically in (hole, pos]
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            if (table->type == BENCH_TYPE_INT) {
+                table->ints[hole] = table->ints[pos];
+            } else {
+                table->strings[hole] = table->strings[pos];
+            }
+            table->values[hole] = table->values[pos];
+            hole = pos;
+        }
+
+        pos = (pos + 1) & mask;
+    }
+
+    table->used[hole] = 0;
+    table->size--;
+}
+
+static void bench_table_lookup(const BenchContext *context, const BenchTable *table,
+                               const size_t *positions, size_t offset, BenchClock *clock) {
+    uint64_t sum = 0;
+
+    bench_start(clock);
+    for (size_t i = 0; i < context->elements; ++i) {
+        size_t slot;
+        if (bench_table_find(table, bench_key(context, offset + (positions ? positions[i] : i)),
+                             &slot)) {
+            sum += (uint64_t) table->values[slot];
+        }
+    }
+    bench_stop(clock);
+
+    bench_sink += sum;
+}
+
+static void bench_open_table(const BenchContext *context) {
+    BenchClock insert = {0}, uniform = {0}, zipfian = {0}, missing = {0}, iterate = {0},
+               erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        BenchTable table;
+        table.type = context->type;
+        table.size = 0;
+        bench_table_alloc(&table, 16);
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            bench_table_insert(&table, bench_key(context, i), (int) i);
+        }
+        bench_stop(&insert);
+
+        bench_table_lookup(context, &table, context->keys->uniform, 0, &uniform);
+        bench_table_lookup(context, &table, context->keys->zipfian, 0, &zipfian);
+        bench_table_lookup(context, &table, NULL, n, &missing);
+
+        uint64_t sum = 0;
+        bench_start(&iterate);
+        for (size_t i = 0; i < table.capacity; ++i) {
+            if (table.used[i]) {
+                sum += (uint64_t) table.values[i];
+            }
+        }
+        bench_stop(&iterate);
+        bench_sink += sum;
+
+        bench_start(&erase);
+        for (size_t i = 0; i < n; ++i) {
+            bench_table_erase(&table, bench_key(context, i));
+        }
+        bench_stop(&erase);
+
+        bench_table_free(&table);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "open_table", "insert", "sequential", &insert, ops);
+    bench_report(context, "open_table", "lookup", "uniform", &uniform, ops);
+    bench_report(context, "open_table", "lookup", "zipfian", &zipfian, ops);
+    bench_report(context, "open_table", "lookup", "missing", &missing, ops);
+    bench_report(context, "open_table", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "open_table", "erase", "sequential", &erase, ops);
+}
+
+static void bench_baseline(const BenchContext *context) {
+    bench_array(context);
+    bench_open_table(context);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "baseline", bench_baseline);
+}
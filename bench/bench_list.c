@@ -0,0 +1,74 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_list.h"
+#include "bench.h"
+
+static bool bench_list_visit(const void *element, void *context) {
+    bench_sink += bench_fold(context, element);
+    return true;
+}
+
+static void bench_list(const BenchContext *context) {
+    BenchClock insert = {0}, iterate = {0}, erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCList *list = dsc_list_init(bench_dsc_type(context));
+        if (list == NULL) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_list_push_back(list, bench_key(context, i));
+        }
+        bench_stop(&insert);
+
+        bench_start(&iterate);
+        dsc_list_for_each(list, bench_list_visit, (void *) context);
+        bench_stop(&iterate);
+
+        bench_start(&erase);
+        if (context->type == BENCH_TYPE_INT) {
+            for (size_t i = 0; i < n; ++i) {
+                int value;
+                dsc_list_pop_front(list, &value);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                char *value;
+                dsc_list_pop_front(list, &value);
+                free(value);
+            }
+        }
+        bench_stop(&erase);
+
+        dsc_list_deinit(list);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "list", "insert", "sequential", &insert, ops);
+    bench_report(context, "list", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "list", "erase", "sequential", &erase, ops);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "list", bench_list);
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_map.h"
+#include "bench.h"
+
+static const struct {
+    const char *name;
+    DSCMapBackend backend;
+} bench_map_backends[] = {
+    {"chained", DSC_MAP_BACKEND_CHAINED},
+    {"open", DSC_MAP_BACKEND_OPEN},
+    {"sharded", DSC_MAP_BACKEND_SHARDED},
+};
+
+static bool bench_map_visit(const void *key, const void *value, void *context) {
+    (void) key;
+    (void) context;
+    bench_sink += (uint64_t) *(const int *) value;
+    return true;
+}
+
+static void bench_map_lookup(const BenchContext *context, const DSCMap *map,
+                             const size_t *positions, size_t offset, BenchClock *clock) {
+    uint64_t sum = 0;
+
+    bench_start(clock);
+    for (size_t i = 0; i < context->elements; ++i) {
+        int value = 0;
+        dsc_map_get(map, bench_key(context, offset + (positions ? positions[i] : i)), &value);
+        sum += (uint64_t) value;
+    }
+    bench_stop(clock);
+
+    bench_sink += sum;
+}
+
+static void bench_map_backend(const BenchContext *context, const char *variant,
+                              DSCMapBackend backend) {
+    BenchClock insert = {0}, uniform = {0}, zipfian = {0}, missing = {0}, iterate = {0},
+               erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCMap *map;
+        if (dsc_map_init_backend(&map, bench_dsc_type(context), DSC_TYPE_INT, backend) !=
+            DSC_ERROR_OK) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            int value = (int) i;
+            dsc_map_insert(map, bench_key(context, i), &value);
+        }
+        bench_stop(&insert);
+
+        bench_map_lookup(context, map, context->keys->uniform, 0, &uniform);
+        bench_map_lookup(context, map, context->keys->zipfian, 0, &zipfian);
+        bench_map_lookup(context, map, NULL, n, &missing);
+
+        bench_start(&iterate);
+        dsc_map_for_each(map, bench_map_visit, NULL);
+        bench_stop(&iterate);
+
+        bench_start(&erase);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_map_erase(map, bench_key(context, i));
+        }
+        bench_stop(&erase);
+
+        dsc_map_deinit(map);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, variant, "insert", "sequential", &insert, ops);
+    bench_report(context, variant, "lookup", "uniform", &uniform, ops);
+    bench_report(context, variant, "lookup", "zipfian", &zipfian, ops);
+    bench_report(context, variant, "lookup", "missing", &missing, ops);
+    bench_report(context, variant, "iterate", "sequential", &iterate, ops);
+    bench_report(context, variant, "erase", "sequential", &erase, ops);
+}
+
+static void bench_map(const BenchContext *context) {
+    for (size_t i = 0; i < sizeof(bench_map_backends) / sizeof(bench_map_backends[0]); ++i) {
+        bench_map_backend(context, bench_map_backends[i].name, bench_map_backends[i].backend);
+    }
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "map", bench_map);
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_queue.h"
+#include "bench.h"
+
+static bool bench_queue_visit(const void *element, void *context) {
+    bench_sink += bench_fold(context, element);
+    return true;
+}
+
+static void bench_queue(const BenchContext *context) {
+    BenchClock insert = {0}, iterate = {0}, erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCQueue *queue;
+        if (dsc_queue_init(&queue, bench_dsc_type(context)) != DSC_ERROR_OK) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_queue_push(queue, bench_key(context, i));
+        }
+        bench_stop(&insert);
+
+        bench_start(&iterate);
+        dsc_queue_for_each(queue, bench_queue_visit, (void *) context);
+        bench_stop(&iterate);
+
+        bench_start(&erase);
+        if (context->type == BENCH_TYPE_INT) {
+            for (size_t i = 0; i < n; ++i) {
+                int value;
+                dsc_queue_pop(queue, &value);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                char *value;
+                dsc_queue_pop(queue, &value);
+                free(value);
+            }
+        }
+        bench_stop(&erase);
+
+        dsc_queue_deinit(queue);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "queue", "insert", "sequential", &insert, ops);
+    bench_report(context, "queue", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "queue", "erase", "sequential", &erase, ops);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "queue", bench_queue);
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_set.h"
+#include "bench.h"
+
+static bool bench_set_visit(const void *element, void *context) {
+    bench_sink += bench_fold(context, element);
+    return true;
+}
+
+static void bench_set_lookup(const BenchContext *context, const DSCSet *set,
+                             const size_t *positions, size_t offset, BenchClock *clock) {
+    uint64_t found = 0;
+
+    bench_start(clock);
+    for (size_t i = 0; i < context->elements; ++i) {
+        bool result;
+        dsc_set_contains(set, bench_key(context, offset + (positions ? positions[i] : i)),
+                         &result);
+        found += result;
+    }
+    bench_stop(clock);
+
+    bench_sink += found;
+}
+
+static void bench_set(const BenchContext *context) {
+    BenchClock insert = {0}, uniform = {0}, zipfian = {0}, missing = {0}, iterate = {0},
+               erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCSet *set;
+        if (dsc_set_init(&set, bench_dsc_type(context)) != DSC_ERROR_OK) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_set_insert(set, bench_key(context, i));
+        }
+        bench_stop(&insert);
+
+        bench_set_lookup(context, set, context->keys->uniform, 0, &uniform);
+        bench_set_lookup(context, set, context->keys->zipfian, 0, &zipfian);
+        bench_set_lookup(context, set, NULL, n, &missing);
+
+        bench_start(&iterate);
+        dsc_set_for_each(set, bench_set_visit, (void *) context);
+        bench_stop(&iterate);
+
+        bench_start(&erase);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_set_erase(set, bench_key(context, i));
+        }
+        bench_stop(&erase);
+
+        dsc_set_deinit(set);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "set", "insert", "sequential", &insert, ops);
+    bench_report(context, "set", "lookup", "uniform", &uniform, ops);
+    bench_report(context, "set", "lookup", "zipfian", &zipfian, ops);
+    bench_report(context, "set", "lookup", "missing", &missing, ops);
+    bench_report(context, "set", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "set", "erase", "sequential", &erase, ops);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "set", bench_set);
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_stack.h"
+#include "bench.h"
+
+static void bench_stack(const BenchContext *context) {
+    BenchClock insert = {0}, erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCStack *stack;
+        if (dsc_stack_init(&stack, bench_dsc_type(context)) != DSC_ERROR_OK) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_stack_push(stack, bench_key(context, i));
+        }
+        bench_stop(&insert);
+
+        bench_start(&erase);
+        if (context->type == BENCH_TYPE_INT) {
+            for (size_t i = 0; i < n; ++i) {
+                int value;
+                dsc_stack_pop(stack, &value);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                char *value;
+                dsc_stack_pop(stack, &value);
+                free(value);
+            }
+        }
+        bench_stop(&erase);
+
+        dsc_stack_deinit(stack);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "stack", "insert", "sequential", &insert, ops);
+    bench_report(context, "stack", "erase", "sequential", &erase, ops);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "stack", bench_stack);
+}
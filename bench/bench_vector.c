@@ -0,0 +1,102 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "../include/dsc_vector.h"
+#include "bench.h"
+
+static bool bench_vector_visit(const void *element, void *context) {
+    bench_sink += bench_fold(context, element);
+    return true;
+}
+
+static void bench_vector_lookup(const BenchContext *context, const DSCVector *vector,
+                                const size_t *positions, BenchClock *clock) {
+    uint64_t sum = 0;
+
+    bench_start(clock);
+    if (context->type == BENCH_TYPE_INT) {
+        for (size_t i = 0; i < context->elements; ++i) {
+            int value;
+            dsc_vector_at(vector, positions[i], &value);
+            sum += (uint64_t) value;
+        }
+    } else {
+        for (size_t i = 0; i < context->elements; ++i) {
+            DSCStringView view;
+            dsc_vector_at_view(vector, positions[i], &view);
+            sum += view.length;
+        }
+    }
+    bench_stop(clock);
+
+    bench_sink += sum;
+}
+
+static void bench_vector(const BenchContext *context) {
+    BenchClock insert = {0}, uniform = {0}, zipfian = {0}, iterate = {0}, erase = {0};
+    size_t n = context->elements;
+
+    for (size_t rep = 0; rep < context->reps; ++rep) {
+        DSCVector *vector;
+        if (dsc_vector_init(&vector, bench_dsc_type(context)) != DSC_ERROR_OK) {
+            exit(EXIT_FAILURE);
+        }
+
+        bench_start(&insert);
+        for (size_t i = 0; i < n; ++i) {
+            dsc_vector_push_back(vector, bench_element(context, i));
+        }
+        bench_stop(&insert);
+
+        bench_vector_lookup(context, vector, context->keys->uniform, &uniform);
+        bench_vector_lookup(context, vector, context->keys->zipfian, &zipfian);
+
+        bench_start(&iterate);
+        dsc_vector_for_each(vector, bench_vector_visit, (void *) context);
+        bench_stop(&iterate);
+
+        bench_start(&erase);
+        if (context->type == BENCH_TYPE_INT) {
+            for (size_t i = 0; i < n; ++i) {
+                int value;
+                dsc_vector_pop_back(vector, &value);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                char *value;
+                dsc_vector_pop_back(vector, &value);
+                free(value);
+            }
+        }
+        bench_stop(&erase);
+
+        dsc_vector_deinit(vector);
+    }
+
+    size_t ops = n * context->reps;
+    bench_report(context, "vector", "insert", "sequential", &insert, ops);
+    bench_report(context, "vector", "lookup", "uniform", &uniform, ops);
+    bench_report(context, "vector", "lookup", "zipfian", &zipfian, ops);
+    bench_report(context, "vector", "iterate", "sequential", &iterate, ops);
+    bench_report(context, "vector", "erase", "sequential", &erase, ops);
+}
+
+int main(int argc, char **argv) {
+    return bench_main(argc, argv, "vector", bench_vector);
+}
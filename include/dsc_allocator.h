@@ -0,0 +1,212 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_allocator.h
+ * @brief Pluggable memory allocation for libdsc containers.
+ *
+ * Every container can be initialized with a DSCAllocator, which it then uses
+ * for all of its internal memory, including its own struct and any string
+ * copies. Strings returned to the caller are always allocated with malloc and
+ * must be released with free, whatever allocator the container uses.
+ *
+ * libdsc ships two allocators besides the default one: a bump-pointer arena
+ * that releases everything at once, and a pool of fixed-size objects.
+ */
+
+#ifndef DSC_ALLOCATOR_H
+#define DSC_ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dsc_error.h"
+
+/**
+ * @brief The default size of one arena block.
+ */
+#define DSC_ARENA_BLOCK_SIZE ((size_t) 64 * 1024)
+
+/**
+ * @brief The default number of objects carved out of one pool slab.
+ */
+#define DSC_POOL_SLAB_OBJECTS 256
+
+/**
+ * @brief A set of allocation callbacks and the context they share.
+ *
+ * The callbacks follow malloc, realloc and free. free may be NULL for
+ * allocators that only release memory all at once; containers using such an
+ * allocator skip walking their elements on deinit and clear.
+ */
+typedef struct DSCAllocator DSCAllocator;
+
+struct DSCAllocator {
+    void *(*alloc)(void *context, size_t size);              /** Allocate. */
+    void *(*realloc)(void *context, void *ptr, size_t size); /** Resize. */
+    void (*free)(void *context, void *ptr);                  /** Release, or
+                                                                NULL. */
+    void *context;                                           /** Passed to
+                                                                every call. */
+};
+
+/**
+ * @brief A bump-pointer arena.
+ */
+typedef struct DSCArena DSCArena;
+
+/**
+ * @brief A pool of fixed-size objects backed by slabs.
+ */
+typedef struct DSCPool DSCPool;
+
+/**
+ * @brief Returns the allocator built on malloc, realloc and free.
+ *
+ * Containers use it whenever they are given a NULL allocator.
+ */
+const DSCAllocator *dsc_allocator_default(void);
+
+/* Helpers containers use to call an allocator. A NULL allocator stands for
+ * the default one. */
+
+void *dsc_alloc(const DSCAllocator *allocator, size_t size);
+
+void *dsc_calloc(const DSCAllocator *allocator, size_t count, size_t size);
+
+void *dsc_realloc(const DSCAllocator *allocator, void *ptr, size_t size);
+
+void dsc_free(const DSCAllocator *allocator, void *ptr);
+
+char *dsc_strdup(const DSCAllocator *allocator, const char *string);
+
+/**
+ * @brief Checks whether freeing individual blocks does anything.
+ *
+ * @return false for allocators without a free callback, true otherwise.
+ */
+bool dsc_allocator_frees(const DSCAllocator *allocator);
+
+/**
+ * @brief Hands a container-owned string over to the caller.
+ *
+ * With the default allocator the string is returned as is. Otherwise it is
+ * copied with malloc and the container's copy is released.
+ *
+ * @return A string the caller must free, or NULL if the copy failed, in
+ *         which case the container still owns the original.
+ */
+char *dsc_allocator_export(const DSCAllocator *allocator, char *string);
+
+/**
+ * @brief Takes over a string the caller allocated with malloc.
+ *
+ * The inverse of dsc_allocator_export. With the default allocator the string
+ * is returned as is. Otherwise a copy from the allocator is returned and the
+ * caller's string is left alone: the container frees it with free once the
+ * copy is stored, so that a failure in between leaves it with the caller.
+ *
+ * @return The string the container now owns, or NULL if the copy failed.
+ */
+char *dsc_allocator_adopt(const DSCAllocator *allocator, char *string);
+
+/**
+ * @brief Checks whether two allocators hand out interchangeable memory.
+ *
+ * Counting allocators are compared by the allocator they forward to.
+ *
+ * @return true if memory from one can be resized and freed by the other.
+ */
+bool dsc_allocator_equal(const DSCAllocator *lhs, const DSCAllocator *rhs);
+
+/**
+ * @brief Create an arena.
+ *
+ * @param arena A pointer to store the new arena in.
+ * @param block_size The size of each block the arena carves allocations out
+ *                   of, or 0 for DSC_ARENA_BLOCK_SIZE. Larger allocations get
+ *                   a block of their own.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_arena_init(DSCArena **arena, size_t block_size);
+
+/**
+ * @brief Release every block of the arena and the arena itself.
+ *
+ * Containers allocated from the arena must not be used afterwards, and need
+ * not be deinitialized first.
+ */
+DSCError dsc_arena_deinit(DSCArena *arena);
+
+/**
+ * @brief Release every allocation at once but keep one block for reuse.
+ */
+DSCError dsc_arena_reset(DSCArena *arena);
+
+/**
+ * @brief Get an allocator that allocates from the arena.
+ *
+ * The allocator has no free callback; growing the most recent allocation is
+ * done in place when the block has room.
+ *
+ * @param arena The arena to allocate from.
+ * @param result A pointer to store the allocator in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_arena_allocator(DSCArena *arena, DSCAllocator *result);
+
+/**
+ * @brief Create a pool of fixed-size objects.
+ *
+ * @param pool A pointer to store the new pool in.
+ * @param object_size The size of every object in the pool.
+ * @param slab_objects The number of objects per slab, or 0 for
+ *                     DSC_POOL_SLAB_OBJECTS.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_pool_init(DSCPool **pool, size_t object_size, size_t slab_objects);
+
+/**
+ * @brief Release every slab of the pool and the pool itself.
+ */
+DSCError dsc_pool_deinit(DSCPool *pool);
+
+/**
+ * @brief Take one object from the pool.
+ *
+ * @return The object, or NULL if a new slab could not be allocated.
+ */
+void *dsc_pool_alloc(DSCPool *pool);
+
+/**
+ * @brief Return an object to the pool.
+ */
+void dsc_pool_free(DSCPool *pool, void *object);
+
+/**
+ * @brief Get an allocator that serves objects from the pool.
+ *
+ * Requests larger than the pool's object size fail, so the allocator suits
+ * containers whose allocations are all of one size.
+ *
+ * @param pool The pool to allocate from.
+ * @param result A pointer to store the allocator in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_pool_allocator(DSCPool *pool, DSCAllocator *result);
+
+#endif  // DSC_ALLOCATOR_H
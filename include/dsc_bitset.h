@@ -0,0 +1,310 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_bitset.h
+ * @brief A growable, bit-packed array of booleans.
+ *
+ * A DSCBitset stores one bit per element in 64-bit words, an eighth of the
+ * memory a DSCVector of DSC_TYPE_BOOL takes, and works on whole words where
+ * it can: counting, rank and searching use popcount and count-trailing-zeros
+ * over words, and AND, OR, XOR and ANDNOT between bitsets run on the widest
+ * vector instructions the CPU offers. The bits past the size in the last
+ * word are always zero.
+ */
+
+#ifndef DSC_BITSET_H
+#define DSC_BITSET_H
+
+#include <stdint.h>
+
+#include "dsc_allocator.h"
+#include "dsc_error.h"
+#include "dsc_stats.h"
+
+/**
+ * @brief The number of bits in one word of a bitset.
+ */
+#define DSC_BITSET_WORD_BITS 64
+
+typedef struct DSCBitset DSCBitset;
+
+/**
+ * @brief Initialize a new bitset with every bit clear.
+ *
+ * @param bitset Pointer to store the new bitset in.
+ * @param size The number of bits.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_init(DSCBitset **bitset, size_t size);
+
+/**
+ * @brief Initialize a new bitset that takes all of its memory from an
+ *        allocator.
+ *
+ * @param bitset Pointer to store the new bitset in.
+ * @param size The number of bits, all clear.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the bitset.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_init_allocator(DSCBitset **bitset, size_t size,
+                                   const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a bitset, freeing all allocated memory.
+ *
+ * @param bitset Pointer to the bitset to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_deinit(DSCBitset *bitset);
+
+/**
+ * @brief Get the number of bits in the bitset.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param result Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_size(const DSCBitset *bitset, size_t *result);
+
+/**
+ * @brief Change the number of bits. New bits are clear.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param size The new number of bits.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_resize(DSCBitset *bitset, size_t size);
+
+/**
+ * @brief Append one bit, growing the storage geometrically.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param value The bit to append.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_push_back(DSCBitset *bitset, bool value);
+
+/**
+ * @brief Set a bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The bit to set.
+ * @return DSCError code indicating success or failure: DSC_ERROR_OUT_OF_RANGE
+ *         if index is not below the size.
+ */
+DSCError dsc_bitset_set(DSCBitset *bitset, size_t index);
+
+/**
+ * @brief Clear a bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The bit to clear.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_reset(DSCBitset *bitset, size_t index);
+
+/**
+ * @brief Invert a bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The bit to invert.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_flip(DSCBitset *bitset, size_t index);
+
+/**
+ * @brief Read a bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The bit to read.
+ * @param result Pointer to store the bit in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_test(const DSCBitset *bitset, size_t index, bool *result);
+
+/**
+ * @brief Set or clear count bits starting at start, whole words at a time.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param start The first bit.
+ * @param count The number of bits, which must all lie below the size.
+ * @param value Whether to set or clear them.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_set_range(DSCBitset *bitset, size_t start, size_t count, bool value);
+
+/**
+ * @brief Set or clear every bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param value Whether to set or clear them.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_fill(DSCBitset *bitset, bool value);
+
+/**
+ * @brief Read the 64 bits starting at bit index * DSC_BITSET_WORD_BITS.
+ *
+ * Bit i of the word is bit index * DSC_BITSET_WORD_BITS + i of the bitset.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The word to read, below the size rounded up to whole words.
+ * @param result Pointer to store the word in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_word(const DSCBitset *bitset, size_t index, uint64_t *result);
+
+/**
+ * @brief Overwrite the 64 bits starting at bit index * DSC_BITSET_WORD_BITS.
+ *
+ * Bits of the word past the size are ignored.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The word to write.
+ * @param word The new bits.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_set_word(DSCBitset *bitset, size_t index, uint64_t word);
+
+/**
+ * @brief Count the set bits.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param result Pointer to store the count.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_count(const DSCBitset *bitset, size_t *result);
+
+/**
+ * @brief Count the set bits below an index.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param index The bit to stop before, at most the size.
+ * @param result Pointer to store the count.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_rank(const DSCBitset *bitset, size_t index, size_t *result);
+
+/**
+ * @brief Find the first set bit at or after an index.
+ *
+ * Passing one past the previous result walks every set bit in order,
+ * skipping clear words whole.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param start The bit to start at.
+ * @param result Pointer to store the set bit's index in.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if no bit at or after start is set.
+ */
+DSCError dsc_bitset_find_next(const DSCBitset *bitset, size_t start, size_t *result);
+
+/**
+ * @brief Find the first set bit.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param result Pointer to store the set bit's index in.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if no bit is set.
+ */
+DSCError dsc_bitset_find_first(const DSCBitset *bitset, size_t *result);
+
+/**
+ * @brief Keep the bits set in both bitsets: dest &= src.
+ *
+ * @param dest Pointer to the bitset to update.
+ * @param src Pointer to a bitset of the same size.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_INVALID_ARGUMENT if the sizes differ.
+ */
+DSCError dsc_bitset_and(DSCBitset *dest, const DSCBitset *src);
+
+/**
+ * @brief Set the bits set in either bitset: dest |= src.
+ *
+ * @param dest Pointer to the bitset to update.
+ * @param src Pointer to a bitset of the same size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_or(DSCBitset *dest, const DSCBitset *src);
+
+/**
+ * @brief Keep the bits set in exactly one bitset: dest ^= src.
+ *
+ * @param dest Pointer to the bitset to update.
+ * @param src Pointer to a bitset of the same size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_xor(DSCBitset *dest, const DSCBitset *src);
+
+/**
+ * @brief Clear the bits set in src: dest &= ~src.
+ *
+ * @param dest Pointer to the bitset to update.
+ * @param src Pointer to a bitset of the same size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_andnot(DSCBitset *dest, const DSCBitset *src);
+
+/**
+ * @brief Replace the contents with an array of bools, one bit each.
+ *
+ * Together with dsc_vector_data this packs a DSCVector of DSC_TYPE_BOOL.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param values The bools to pack.
+ * @param count The number of bools, which becomes the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_assign(DSCBitset *bitset, const bool *values, size_t count);
+
+/**
+ * @brief Unpack every bit into an array of bools.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param result An array of at least size bools.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_unpack(const DSCBitset *bitset, bool *result);
+
+/**
+ * @brief Borrow the words of the bitset.
+ *
+ * The words are valid until the bitset is next resized.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param words Pointer to store the words in, the size rounded up to whole
+ *              words of them.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_data(const DSCBitset *bitset, const uint64_t **words);
+
+/**
+ * @brief Read the instrumentation counters of the bitset.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param bitset Pointer to the bitset.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bitset_stats(const DSCBitset *bitset, DSCStats *stats);
+
+#endif // DSC_BITSET_H
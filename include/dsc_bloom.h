@@ -0,0 +1,209 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_bloom.h
+ * @brief A cache-line-blocked Bloom filter for cheap negative lookups.
+ *
+ * A DSCBloomFilter answers "definitely absent" or "possibly present" for a
+ * key. It is a split-block Bloom filter: a key's hash picks one 64-byte
+ * block, the size of a cache line, and sets one bit in each of the block's
+ * eight 64-bit words. A query therefore touches exactly one cache line and
+ * chases no pointers, whatever the filter's size; the price is a slightly
+ * higher false-positive rate than a classic Bloom filter of the same size.
+ *
+ * Put a filter in front of a DSCSet or DSCMap whose lookups mostly miss, and
+ * only consult the container when the filter says a key may be present.
+ * Bloom filters cannot forget keys: erasing a key from the container leaves
+ * it possibly present in the filter, which stays correct but gets less
+ * selective, so rebuild the filter after many erases.
+ *
+ * Keys are passed the way DSCSet takes them: a pointer to the value, to a
+ * char * for strings, or to a whole record for DSC_TYPE_BYTES.
+ */
+
+#ifndef DSC_BLOOM_H
+#define DSC_BLOOM_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_stats.h"
+#include "dsc_type.h"
+
+/**
+ * @brief The size of one block in bytes, a cache line.
+ */
+#define DSC_BLOOM_BLOCK_BYTES 64
+
+/**
+ * @brief The number of bits a key sets, one per word of its block.
+ */
+#define DSC_BLOOM_BITS_PER_KEY 8
+
+/**
+ * @brief The number of keys hashed and prefetched ahead of testing in a
+ *        batch query.
+ */
+#define DSC_BLOOM_BATCH_WINDOW 16
+
+typedef struct DSCBloomFilter DSCBloomFilter;
+
+/**
+ * @brief Initialize a new, empty Bloom filter sized for a number of keys.
+ *
+ * @param filter Pointer to store the new filter in.
+ * @param type The data type of the keys.
+ * @param expected_count The number of keys the filter is sized for. More
+ *                       can be inserted, at a rising false-positive rate.
+ * @param false_positive_rate The rate of false positives wanted at
+ *                            expected_count keys, between 0 and 1.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_init(DSCBloomFilter **filter, DSCType type, size_t expected_count,
+                        double false_positive_rate);
+
+/**
+ * @brief Initialize a new Bloom filter that takes all of its memory from an
+ *        allocator.
+ *
+ * @param filter Pointer to store the new filter in.
+ * @param type The data type of the keys.
+ * @param expected_count The number of keys the filter is sized for.
+ * @param false_positive_rate The rate of false positives wanted at
+ *                            expected_count keys.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the filter.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_init_allocator(DSCBloomFilter **filter, DSCType type, size_t expected_count,
+                                  double false_positive_rate, const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new Bloom filter over fixed-size records.
+ *
+ * The records are hashed with the descriptor's hash callback, or by their
+ * bytes without one.
+ *
+ * @param filter Pointer to store the new filter in.
+ * @param element The descriptor of the records, copied into the filter.
+ * @param expected_count The number of keys the filter is sized for.
+ * @param false_positive_rate The rate of false positives wanted at
+ *                            expected_count keys.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_init_bytes(DSCBloomFilter **filter, const DSCElementType *element,
+                              size_t expected_count, double false_positive_rate,
+                              const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a Bloom filter, freeing all allocated memory.
+ *
+ * @param filter Pointer to the filter to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_deinit(DSCBloomFilter *filter);
+
+/**
+ * @brief Add a key to the filter.
+ *
+ * @param filter Pointer to the filter.
+ * @param key Pointer to the key data.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_insert(DSCBloomFilter *filter, void *key);
+
+/**
+ * @brief Add a contiguous array of keys to the filter.
+ *
+ * @param filter Pointer to the filter.
+ * @param keys A contiguous array of count keys: values, char * for strings,
+ *             or records.
+ * @param count The number of keys.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_insert_range(DSCBloomFilter *filter, void *keys, size_t count);
+
+/**
+ * @brief Check whether a key may have been added.
+ *
+ * @param filter Pointer to the filter.
+ * @param key Pointer to the key data.
+ * @param result Set to false if the key was never added, true if it was or
+ *               on a false positive.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_contains(const DSCBloomFilter *filter, void *key, bool *result);
+
+/**
+ * @brief Check many keys at once.
+ *
+ * Every key of a window of DSC_BLOOM_BATCH_WINDOW is hashed and its block
+ * prefetched before any of them is tested, so the cache misses of a large
+ * filter overlap instead of being taken one by one.
+ *
+ * @param filter Pointer to the filter.
+ * @param keys A contiguous array of count keys, laid out as for
+ *             dsc_bloom_insert_range.
+ * @param count The number of keys.
+ * @param results Set to dsc_bloom_contains's answer for every key.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_contains_batch(const DSCBloomFilter *filter, void *keys, size_t count,
+                                  bool *results);
+
+/**
+ * @brief Forget every key.
+ *
+ * @param filter Pointer to the filter.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_clear(DSCBloomFilter *filter);
+
+/**
+ * @brief Get the number of insertions since the filter was created or
+ *        cleared, duplicates included.
+ *
+ * @param filter Pointer to the filter.
+ * @param result Pointer to store the count.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_count(const DSCBloomFilter *filter, size_t *result);
+
+/**
+ * @brief Get the size of the filter's bit array in bytes.
+ *
+ * @param filter Pointer to the filter.
+ * @param result Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_bytes(const DSCBloomFilter *filter, size_t *result);
+
+/**
+ * @brief Read the instrumentation counters of the filter.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param filter Pointer to the filter.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_bloom_stats(const DSCBloomFilter *filter, DSCStats *stats);
+
+#endif // DSC_BLOOM_H
@@ -23,6 +23,9 @@
 #ifndef DSC_DATA_H
 #define DSC_DATA_H
 
+#include <stdint.h>
+
+#include "dsc_allocator.h"
 #include "dsc_error.h"
 #include "dsc_type.h"
 
@@ -53,6 +56,139 @@ union DSCData {
                       pointers). */
 };
 
+/**
+ * @brief Describes the records held by a DSC_TYPE_BYTES container.
+ *
+ * Records are stored inline in the container's buffer, size bytes apart, so
+ * each one costs neither an allocation nor a pointer chase. Every callback is
+ * optional: without them records are hashed, compared and copied as plain
+ * bytes and own nothing.
+ *
+ * A container copies the descriptor when it is created. Records passed in are
+ * copied with copy; records read with at, front, back, top or get are copied
+ * out the same way, so the caller owns that copy. Popped records are moved out
+ * without a copy, and records the container drops are passed to destroy.
+ */
+typedef struct DSCElementType DSCElementType;
+
+struct DSCElementType {
+    size_t size;                                          /** Record size in
+                                                             bytes, nonzero. */
+    uint64_t (*hash)(const void *record, uint64_t seed);  /** Hash, or NULL to
+                                                             hash the bytes. */
+    int (*compare)(const void *lhs, const void *rhs);     /** Three-way
+                                                             compare, or NULL
+                                                             for memcmp. */
+    DSCError (*copy)(void *dest, const void *src);        /** Deep copy, or
+                                                             NULL for memcpy. */
+    void (*destroy)(void *record);                        /** Release what a
+                                                             record owns, or
+                                                             NULL. */
+};
+
+/**
+ * @brief Checks if a record descriptor is unusable.
+ *
+ * @return true if element is NULL or its size is 0, false otherwise.
+ */
+bool dsc_element_invalid(const DSCElementType *element);
+
+/**
+ * @brief The descriptor of a built-in type: its size and no callbacks.
+ *
+ * Containers keep one for every type so that the stride of their buffer is
+ * always element.size.
+ */
+DSCElementType dsc_element_of(DSCType type);
+
+/**
+ * @brief Checks if two descriptors describe the same records.
+ *
+ * @return true if the sizes and every callback match, false otherwise.
+ */
+bool dsc_element_equal(const DSCElementType *lhs, const DSCElementType *rhs);
+
+/**
+ * @brief Hash a record with the descriptor's hash callback or its bytes.
+ */
+uint64_t dsc_element_hash(const DSCElementType *element, const void *record,
+                          uint64_t seed);
+
+/**
+ * @brief Compare two records with the descriptor's compare callback or memcmp.
+ */
+int dsc_element_compare(const DSCElementType *element, const void *lhs,
+                        const void *rhs);
+
+/**
+ * @brief Copy a record into uninitialized storage.
+ *
+ * @return DSC_ERROR_OK, or the copy callback's error, in which case dest
+ *         holds nothing that needs destroying.
+ */
+DSCError dsc_element_copy(const DSCElementType *element, void *dest,
+                          const void *src);
+
+/**
+ * @brief Release a contiguous run of records with the destroy callback.
+ */
+void dsc_element_destroy(const DSCElementType *element, void *records,
+                         size_t count);
+
+/**
+ * @brief Turn a stored element into the pointer that cursors hand out.
+ *
+ * Cursors and for_each yield the container's own storage without copying
+ * it: a pointer to the value for the built-in types (an int * for
+ * DSC_TYPE_INT), the characters for DSC_TYPE_STRING and the record itself
+ * for DSC_TYPE_BYTES. The pointer stays valid until the container is
+ * modified, and must not be written through.
+ *
+ * @param slot A stored element: the value, a char * or the record.
+ * @param type The type of the element.
+ */
+const void *dsc_element_view(const void *slot, DSCType type);
+
+/**
+ * @brief Called by the for_each functions once per element, in order.
+ *
+ * @param element The element, as dsc_element_view describes it.
+ * @param context The pointer passed to for_each.
+ * @return true to go on, false to stop the walk early.
+ */
+typedef bool (*DSCVisitor)(const void *element, void *context);
+
+/**
+ * @brief Called by the erase_if and retain functions once per element.
+ *
+ * The predicate must not modify the container.
+ *
+ * @param element The element, as dsc_element_view describes it.
+ * @param context The pointer passed to erase_if or retain.
+ * @return Whether the element matches.
+ */
+typedef bool (*DSCPredicate)(const void *element, void *context);
+
+/**
+ * @brief Called by the parallel reductions to fold one element into an
+ *        accumulator.
+ *
+ * @param accumulator The running result of one chunk of elements.
+ * @param element The element, as dsc_element_view describes it.
+ * @param context The pointer passed to the reduction.
+ */
+typedef void (*DSCReducer)(void *accumulator, const void *element, void *context);
+
+/**
+ * @brief Called by the parallel reductions to fold the result of a chunk
+ *        into the final result, chunk by chunk in order.
+ *
+ * @param accumulator The final result so far.
+ * @param partial The result of the next chunk.
+ * @param context The pointer passed to the reduction.
+ */
+typedef void (*DSCCombiner)(void *accumulator, const void *partial, void *context);
+
 /**
  * @brief Allocate memory for a DSCData value of the specified type.
  *
@@ -62,11 +198,22 @@ union DSCData {
  * @param data A pointer to the DSCData value to allocate memory for.
  * @param type The type of the DSCData value to allocate memory for.
  * @param capacity The number of elements to allocate memory for.
+ * @param allocator The allocator to allocate from, or NULL for the default.
  * @return A DSCError value indicating the result of the operation:
  *         - DSC_ERROR_OK if the operation was successful.
  *         - DSC_ERROR_OUT_OF_MEMORY if memory allocation failed.
  */
-DSCError dsc_data_malloc(DSCData *data, DSCType type, size_t capacity);
+DSCError dsc_data_malloc(DSCData *data, DSCType type, size_t capacity,
+                         const DSCAllocator *allocator);
+
+/**
+ * @brief Allocate memory for capacity elements of elem_size bytes each.
+ *
+ * The form of dsc_data_malloc used for DSC_TYPE_BYTES, whose element size is
+ * not implied by the type.
+ */
+DSCError dsc_data_malloc_stride(DSCData *data, size_t elem_size, size_t capacity,
+                                const DSCAllocator *allocator);
 
 /**
  * @brief Reallocate memory for a DSCData value of the specified type.
@@ -78,12 +225,23 @@ DSCError dsc_data_malloc(DSCData *data, DSCType type, size_t capacity);
  * @param data A pointer to the DSCData value to reallocate memory for.
  * @param type The type of the DSCData value to reallocate memory for.
  * @param capacity The new number of elements to reallocate memory for.
+ * @param allocator The allocator the memory came from, or NULL for the
+ *                  default.
  * @return A DSCError value indicating the result of the operation:
  *         - DSC_ERROR_OK if the operation was successful.
  *         - DSC_ERROR_INVALID_ARGUMENT if an invalid type is specified.
  *         - DSC_ERROR_OUT_OF_MEMORY if memory reallocation failed.
  */
-DSCError dsc_data_realloc(DSCData *data, DSCType type, size_t capacity);
+DSCError dsc_data_realloc(DSCData *data, DSCType type, size_t capacity,
+                          const DSCAllocator *allocator);
+
+/**
+ * @brief Reallocate memory for capacity elements of elem_size bytes each.
+ *
+ * The form of dsc_data_realloc used for DSC_TYPE_BYTES.
+ */
+DSCError dsc_data_realloc_stride(DSCData *data, size_t elem_size, size_t capacity,
+                                 const DSCAllocator *allocator);
 
 /**
  * @brief Free memory allocated for a DSCData value of the specified type.
@@ -94,17 +252,21 @@ DSCError dsc_data_realloc(DSCData *data, DSCType type, size_t capacity);
  * @param data A pointer to the DSCData value to free memory for.
  * @param type The type of the DSCData value to free memory for.
  * @param size The number of elements to free memory for.
+ * @param allocator The allocator the memory came from, or NULL for the
+ *                  default.
  * @return A DSCError value indicating the result of the operation:
  *         - DSC_ERROR_OK if the operation was successful.
  *         - DSC_ERROR_INVALID_ARGUMENT if an invalid type is specified.
  */
-DSCError dsc_data_free(DSCData *data, DSCType type, size_t size);
+DSCError dsc_data_free(DSCData *data, DSCType type, size_t size,
+                       const DSCAllocator *allocator);
 
 /**
  * @brief Copy data from a source buffer to a DSCData value.
  *
  * This function copies the data stored in the `src` buffer to the `dest`
- * DSCData value. The data is copied based on the specified `type`.
+ * DSCData value. The data is copied based on the specified `type`. For
+ * strings, `src` points to a character pointer and the string is duplicated.
  *
  * @param dest A pointer to the destination DSCData value to copy data to.
  * @param src A pointer to the source buffer to copy data from.
@@ -112,6 +274,7 @@ DSCError dsc_data_free(DSCData *data, DSCType type, size_t size);
  * @return A DSCError value indicating the result of the operation:
  *         - DSC_ERROR_OK if the operation was successful.
  *         - DSC_ERROR_INVALID_ARGUMENT if an invalid type is specified.
+ *         - DSC_ERROR_OUT_OF_MEMORY if a string could not be duplicated.
  */
 DSCError dsc_data_copy(DSCData *dest, void *src, DSCType type);
 
@@ -119,8 +282,9 @@ DSCError dsc_data_copy(DSCData *dest, void *src, DSCType type);
  * @brief Compare two DSCData values of the specified type.
  *
  * This function compares the values stored in `data1` and `data2` based on the
- * specified `type`. The comparison follows the same rules as the standard
- * comparison operators for the respective types.
+ * specified `type`. Numbers compare by value; NaNs compare equal to each
+ * other and greater than every other number, so floating-point values have a
+ * total order. Strings compare as with strcmp.
  *
  * @param data1 The first DSCData value to compare.
  * @param data2 A pointer to the second value to compare.
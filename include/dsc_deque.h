@@ -0,0 +1,420 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_deque.h
+ * @brief A double-ended queue on a power-of-two ring buffer.
+ *
+ * A DSCDeque stores its elements inline in one circular buffer whose capacity
+ * is always a power of two, so that a logical index maps to its slot with a
+ * single mask. Pushing and popping at either end and reading any element by
+ * index are O(1); the range functions move whole runs with at most two
+ * copies, one for each side of the wrap.
+ */
+
+#ifndef DSC_DEQUE_H
+#define DSC_DEQUE_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_stats.h"
+#include "dsc_string.h"
+#include "dsc_type.h"
+
+/**
+ * @brief The capacity a new deque starts with, a power of two.
+ */
+#define DSC_DEQUE_INITIAL_CAPACITY 16
+
+typedef struct DSCDeque DSCDeque;
+
+/**
+ * @brief Initialize a new deque.
+ *
+ * @param deque Pointer to store the new deque in.
+ * @param type The data type stored in the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_init(DSCDeque **deque, DSCType type);
+
+/**
+ * @brief Initialize a new deque that takes all of its memory from an
+ *        allocator.
+ *
+ * @param deque Pointer to store the new deque in.
+ * @param type The data type stored in the deque.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_init_allocator(DSCDeque **deque, DSCType type,
+                                  const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new deque of fixed-size records stored inline.
+ *
+ * The deque has type DSC_TYPE_BYTES. Every element pointer passed to or
+ * returned from it points at a whole record of element->size bytes, and the
+ * records sit back to back in the ring buffer.
+ *
+ * @param deque A pointer to store the new deque in.
+ * @param element The record descriptor, copied into the deque.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_deque_init_bytes(DSCDeque **deque, const DSCElementType *element,
+                              const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a deque, freeing all allocated memory.
+ *
+ * @param deque Pointer to the deque to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_deinit(DSCDeque *deque);
+
+/**
+ * @brief Get the current size of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_size(const DSCDeque *deque, size_t *result);
+
+/**
+ * @brief Get the current capacity of the deque, always a power of two.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the capacity.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_capacity(const DSCDeque *deque, size_t *result);
+
+/**
+ * @brief Check if the deque is empty.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_empty(const DSCDeque *deque, bool *result);
+
+/**
+ * @brief Grow the deque so that it holds count elements without resizing.
+ *
+ * Never shrinks. The capacity is rounded up to a power of two.
+ *
+ * @param deque Pointer to the deque.
+ * @param count The number of elements to make room for.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_reserve(DSCDeque *deque, size_t count);
+
+/**
+ * @brief Release the memory the deque holds beyond the smallest power of two
+ *        that fits its current size.
+ *
+ * @param deque Pointer to the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_shrink_to_fit(DSCDeque *deque);
+
+/**
+ * @brief Set how the deque grows when full and shrinks after pops.
+ *
+ * A new deque uses DSC_GROWTH_POLICY_DEFAULT. Every capacity the policy
+ * computes is rounded up to a power of two, so a full deque at least doubles.
+ * With a non-zero shrink ratio the pops release memory once the size drops
+ * far enough below the capacity, but never below DSC_DEQUE_INITIAL_CAPACITY.
+ *
+ * @param deque Pointer to the deque.
+ * @param policy The policy to copy into the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_set_growth(DSCDeque *deque, const DSCGrowthPolicy *policy);
+
+/**
+ * @brief Get the element at an index, counted from the front.
+ *
+ * @param deque Pointer to the deque.
+ * @param index The index of the element, 0 being the front.
+ * @param result Pointer to store the element data. A string is copied with
+ *               malloc and must be freed by the caller.
+ * @return DSCError code indicating success or failure: DSC_ERROR_OUT_OF_RANGE
+ *         if index is not below the size.
+ */
+DSCError dsc_deque_at(const DSCDeque *deque, size_t index, void *result);
+
+/**
+ * @brief Borrow the string at an index without copying it.
+ *
+ * The view is valid until the deque is next modified.
+ *
+ * @param deque Pointer to the deque, whose elements must be DSC_TYPE_STRING.
+ * @param index The index of the element, 0 being the front.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_at_view(const DSCDeque *deque, size_t index, DSCStringView *result);
+
+/**
+ * @brief Get the element at the front of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the element data.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_front(const DSCDeque *deque, void *result);
+
+/**
+ * @brief Get the element at the back of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the element data.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_back(const DSCDeque *deque, void *result);
+
+/**
+ * @brief Push an element onto the front of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param data Pointer to the element data to push (a char ** for a string
+ *             deque).
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_push_front(DSCDeque *deque, void *data);
+
+/**
+ * @brief Push an element onto the back of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param data Pointer to the element data to push (a char ** for a string
+ *             deque).
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_push_back(DSCDeque *deque, void *data);
+
+/**
+ * @brief Add an element to the front of the deque, taking ownership of it.
+ *
+ * Like dsc_deque_push_front, but a string is not copied: the deque adopts the
+ * char * data points to, which must have been allocated with malloc and must
+ * not be used by the caller afterwards. A record is moved in without its copy
+ * callback. On failure the caller keeps ownership.
+ *
+ * @param deque Pointer to the deque.
+ * @param data Pointer to the element data to push (a char ** for a string
+ *             deque).
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_push_front_move(DSCDeque *deque, void *data);
+
+/**
+ * @brief Add an element to the back of the deque, taking ownership of it.
+ *
+ * The ownership rules of dsc_deque_push_front_move apply.
+ *
+ * @param deque Pointer to the deque.
+ * @param data Pointer to the element data to push (a char ** for a string
+ *             deque).
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_push_back_move(DSCDeque *deque, void *data);
+
+/**
+ * @brief Pop the element at the front of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the popped element data. A popped string
+ *               is handed over to the caller, who must free it.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_pop_front(DSCDeque *deque, void *result);
+
+/**
+ * @brief Pop the element at the back of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param result Pointer to store the popped element data. A popped string
+ *               is handed over to the caller, who must free it.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_pop_back(DSCDeque *deque, void *result);
+
+/**
+ * @brief Push a contiguous array of elements onto the back of the deque.
+ *
+ * The deque is resized at most once for the whole range. Primitive elements
+ * and records without a copy callback are copied with at most two memcpy
+ * calls; strings and other records are copied one by one. data[count - 1]
+ * becomes the new back.
+ *
+ * @param deque Pointer to the deque.
+ * @param data A pointer to the first of count elements (an array of char *
+ *             for a string deque).
+ * @param count The number of elements to push.
+ * @return DSCError code indicating success or failure. On failure the deque
+ *         is left unchanged.
+ */
+DSCError dsc_deque_push_back_range(DSCDeque *deque, void *data, size_t count);
+
+/**
+ * @brief Push a contiguous array of elements onto the front of the deque.
+ *
+ * The elements keep their order: data[0] becomes the new front and
+ * data[count - 1] sits just before the old one. Copies as
+ * dsc_deque_push_back_range does.
+ *
+ * @param deque Pointer to the deque.
+ * @param data A pointer to the first of count elements (an array of char *
+ *             for a string deque).
+ * @param count The number of elements to push.
+ * @return DSCError code indicating success or failure. On failure the deque
+ *         is left unchanged.
+ */
+DSCError dsc_deque_push_front_range(DSCDeque *deque, void *data, size_t count);
+
+/**
+ * @brief Pop the first count elements of the deque into an array.
+ *
+ * The elements land in results in deque order, the old front first.
+ * Popped strings are handed over to the caller, who must free them.
+ *
+ * @param deque Pointer to the deque.
+ * @param results An array of count elements to store the popped ones in.
+ * @param count The number of elements to pop.
+ * @return DSCError code indicating success or failure: DSC_ERROR_OUT_OF_RANGE
+ *         if the deque holds fewer than count elements. Handing over a
+ *         string can only fail with a custom allocator; the strings handed
+ *         over before the failure stay popped.
+ */
+DSCError dsc_deque_pop_front_range(DSCDeque *deque, void *results, size_t count);
+
+/**
+ * @brief Pop the last count elements of the deque into an array.
+ *
+ * The elements land in results in deque order, the old back last.
+ * Popped strings are handed over to the caller, who must free them.
+ *
+ * @param deque Pointer to the deque.
+ * @param results An array of count elements to store the popped ones in.
+ * @param count The number of elements to pop.
+ * @return DSCError code indicating success or failure: DSC_ERROR_OUT_OF_RANGE
+ *         if the deque holds fewer than count elements. Handing over a
+ *         string can only fail with a custom allocator; the strings handed
+ *         over before the failure, which fill the end of results, stay
+ *         popped.
+ */
+DSCError dsc_deque_pop_back_range(DSCDeque *deque, void *results, size_t count);
+
+/**
+ * @brief Remove every element but keep the current capacity.
+ *
+ * @param deque Pointer to the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_clear(DSCDeque *deque);
+
+/**
+ * @brief Exchange the elements of two deques in constant time.
+ *
+ * Only the buffers change hands; each deque keeps its allocator, growth
+ * policy and statistics. Swapping with an empty deque moves every element
+ * across without copying any.
+ *
+ * @param deque Pointer to the first deque.
+ * @param other Pointer to the second deque, of the same element type and
+ *              with an interchangeable allocator.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_swap(DSCDeque *deque, DSCDeque *other);
+
+/**
+ * @brief A position in a deque, for walking its elements from front to back.
+ *
+ * A cursor is a plain value set up with dsc_deque_cursor_init and advanced
+ * with dsc_deque_cursor_next. The deque must not be modified while it is
+ * walked. The fields are private.
+ */
+typedef struct DSCDequeCursor DSCDequeCursor;
+
+struct DSCDequeCursor {
+    const DSCDeque *deque; /** The deque being walked. */
+    size_t index;          /** The number of elements already yielded. */
+};
+
+/**
+ * @brief Start a cursor at the first element of a deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_cursor_init(const DSCDeque *deque, DSCDequeCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the deque's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_deque_cursor_next(DSCDequeCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, from front to back.
+ *
+ * The visitor must not modify the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_for_each(const DSCDeque *deque, DSCVisitor visitor, void *context);
+
+/**
+ * @brief Save the deque to a snapshot file, front to back.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param deque Pointer to the deque.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_deque_save(const DSCDeque *deque, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the deque.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param deque Pointer to the deque.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_deque_stats(const DSCDeque *deque, DSCStats *stats);
+
+#endif // DSC_DEQUE_H
@@ -39,7 +39,10 @@ enum DSCError {
     DSC_ERROR_OUT_OF_MEMORY,    /** Out of memory. */
     DSC_ERROR_OUT_OF_RANGE,     /** Out of range. */
     DSC_ERROR_NOT_FOUND,        /** Element not found. */
-    DSC_ERROR_ALREADY_EXISTS    /** Element already exists. */
+    DSC_ERROR_ALREADY_EXISTS,   /** Element already exists. */
+    DSC_ERROR_FULL,             /** Bounded container is full. */
+    DSC_ERROR_IO,               /** Reading or writing a file failed. */
+    DSC_ERROR_INVALID_FORMAT    /** A file is malformed or incompatible. */
 };
 
 #endif // DSC_ERROR_H
@@ -0,0 +1,125 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_growth.h
+ * @brief Capacity growth policy shared by the array-backed containers.
+ */
+
+#ifndef DSC_GROWTH_H
+#define DSC_GROWTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief The default factor a full container grows its capacity by.
+ *
+ * 1.5 rather than 2 lets a reallocation reuse the space freed by the blocks
+ * before it, and wastes less memory on average.
+ */
+#define DSC_GROWTH_FACTOR 1.5
+
+/**
+ * @brief A shrink ratio that pairs well with the default growth factor.
+ */
+#define DSC_GROWTH_SHRINK_RATIO 0.25
+
+/**
+ * @brief The allocation granularity used when huge-page rounding is enabled.
+ */
+#define DSC_GROWTH_HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/**
+ * @brief Describes how an array-backed container grows and shrinks.
+ *
+ * The DSCGrowthPolicy struct is copied into a container when it is set, so a
+ * caller may reuse or discard its own instance afterwards.
+ */
+typedef struct DSCGrowthPolicy DSCGrowthPolicy;
+
+struct DSCGrowthPolicy {
+    double factor;       /** Capacity multiplier when full, greater than 1. */
+    double shrink_ratio; /** Shrink once size drops below capacity times this
+                            ratio, 0 to disable. Must be below 1 / factor. */
+    bool huge_pages;     /** Round allocations of a huge page or more up to a
+                            whole number of huge pages. */
+};
+
+/**
+ * @brief The policy every container starts with: grow by 1.5, never shrink
+ *        automatically, no huge-page rounding.
+ */
+#define DSC_GROWTH_POLICY_DEFAULT \
+    ((DSCGrowthPolicy) {DSC_GROWTH_FACTOR, 0.0, false})
+
+/**
+ * @brief Checks if the specified growth policy is invalid.
+ *
+ * A policy is invalid if it would not grow a full container, or if its shrink
+ * ratio is so high that a freshly shrunk container would immediately qualify
+ * for shrinking again.
+ *
+ * @param policy The policy to check.
+ * @return true if the policy is NULL or invalid, false otherwise.
+ */
+bool dsc_growth_invalid(const DSCGrowthPolicy *policy);
+
+/**
+ * @brief Computes the capacity a container should grow to.
+ *
+ * @param policy The container's growth policy.
+ * @param capacity The current capacity.
+ * @param min_capacity The capacity the container needs at least.
+ * @param element_size The size in bytes of one element.
+ * @return The new capacity, which is at least min_capacity and greater than
+ *         capacity.
+ */
+size_t dsc_growth_next(const DSCGrowthPolicy *policy, size_t capacity,
+                       size_t min_capacity, size_t element_size);
+
+/**
+ * @brief Rounds a capacity up according to the policy's page rounding.
+ *
+ * @param policy The container's growth policy.
+ * @param capacity The capacity to round.
+ * @param element_size The size in bytes of one element.
+ * @return The rounded capacity, at least capacity.
+ */
+size_t dsc_growth_round(const DSCGrowthPolicy *policy, size_t capacity,
+                        size_t element_size);
+
+/**
+ * @brief Computes the capacity a container should shrink to after removals.
+ *
+ * Shrinking leaves room for the container to grow by one growth factor again.
+ * Because the shrink ratio is below the inverse of the growth factor, a
+ * container that oscillates around a boundary does not reallocate on every
+ * operation.
+ *
+ * @param policy The container's growth policy.
+ * @param size The current number of elements.
+ * @param capacity The current capacity.
+ * @param min_capacity The capacity the container never shrinks below.
+ * @param element_size The size in bytes of one element.
+ * @return The new capacity, or capacity itself if no shrink is due.
+ */
+size_t dsc_growth_shrink(const DSCGrowthPolicy *policy, size_t size,
+                         size_t capacity, size_t min_capacity,
+                         size_t element_size);
+
+#endif  // DSC_GROWTH_H
@@ -18,10 +18,27 @@
 #ifndef DSC_LIST_H
 #define DSC_LIST_H
 
+#include "dsc_allocator.h"
 #include "dsc_data.h"
 #include "dsc_error.h"
+#include "dsc_stats.h"
+#include "dsc_string.h"
 #include "dsc_type.h"
 
+/**
+ * @brief The number of nodes in the first slab chunk of a list.
+ *
+ * Nodes are carved from per-list chunks so that the nodes of one list sit
+ * next to each other in memory. Each chunk holds twice as many nodes as the
+ * one before, up to DSC_LIST_CHUNK_MAX_NODES.
+ */
+#define DSC_LIST_CHUNK_MIN_NODES 16
+
+/**
+ * @brief The largest number of nodes carved from one chunk.
+ */
+#define DSC_LIST_CHUNK_MAX_NODES 1024
+
 typedef struct DSCList DSCList;
 
 /**
@@ -32,6 +49,32 @@ typedef struct DSCList DSCList;
  */
 DSCList *dsc_list_init(DSCType type);
 
+/**
+ * @brief Initialize a new list that takes all of its memory from an
+ *        allocator.
+ *
+ * @param type The data type stored in the list.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the list.
+ * @return A pointer to the new list, or NULL on failure.
+ */
+DSCList *dsc_list_init_allocator(DSCType type, const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new list of fixed-size records stored inline.
+ *
+ * The list has type DSC_TYPE_BYTES. Every element pointer passed to or
+ * returned from it points at a whole record of element->size bytes, and each
+ * record is stored inside its node. Popping hands the record over without
+ * destroying it.
+ *
+ * @param element The record descriptor, copied into the list.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return A pointer to the new list, or NULL on failure.
+ */
+DSCList *dsc_list_init_bytes(const DSCElementType *element,
+                             const DSCAllocator *allocator);
+
 /**
  * @brief Deinitialize a list, freeing all allocated memory.
  *
@@ -86,6 +129,40 @@ DSCError dsc_list_back(const DSCList *list, void *result);
  */
 DSCError dsc_list_at(const DSCList *list, size_t index, void *result);
 
+/**
+ * @brief Borrow the string at the front of the list without copying it.
+ *
+ * The view is valid until the list is next modified.
+ *
+ * @param list Pointer to the list, whose elements must be DSC_TYPE_STRING.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_front_view(const DSCList *list, DSCStringView *result);
+
+/**
+ * @brief Borrow the string at the back of the list without copying it.
+ *
+ * The view is valid until the list is next modified.
+ *
+ * @param list Pointer to the list, whose elements must be DSC_TYPE_STRING.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_back_view(const DSCList *list, DSCStringView *result);
+
+/**
+ * @brief Borrow the string at the specified index without copying it.
+ *
+ * The view is valid until the list is next modified.
+ *
+ * @param list Pointer to the list, whose elements must be DSC_TYPE_STRING.
+ * @param index The index of the element.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_at_view(const DSCList *list, size_t index, DSCStringView *result);
+
 /**
  * @brief Push an element onto the front of the list.
  *
@@ -95,6 +172,20 @@ DSCError dsc_list_at(const DSCList *list, size_t index, void *result);
  */
 DSCError dsc_list_push_front(DSCList *list, void *data);
 
+/**
+ * @brief Push an element onto the front of the list, taking ownership of it.
+ *
+ * Like dsc_list_push_front, but a string is not copied: the list adopts the
+ * char * data points to, which must have been allocated with malloc and must
+ * not be used by the caller afterwards. A record is moved in without its copy
+ * callback. On failure the caller keeps ownership.
+ *
+ * @param list Pointer to the list.
+ * @param data Pointer to the element data to push.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_push_front_move(DSCList *list, void *data);
+
 /**
  * @brief Pop an element from the front of the list.
  *
@@ -113,6 +204,17 @@ DSCError dsc_list_pop_front(DSCList *list, void *result);
  */
 DSCError dsc_list_push_back(DSCList *list, void *data);
 
+/**
+ * @brief Push an element onto the back of the list, taking ownership of it.
+ *
+ * The ownership rules of dsc_list_push_front_move apply.
+ *
+ * @param list Pointer to the list.
+ * @param data Pointer to the element data to push.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_push_back_move(DSCList *list, void *data);
+
 /**
  * @brief Pop an element from the back of the list.
  *
@@ -141,4 +243,112 @@ DSCError dsc_list_insert(DSCList *list, void *data, size_t index);
  */
 DSCError dsc_list_erase(DSCList *list, size_t index);
 
+/**
+ * @brief Erase every element a predicate matches in one walk of the list.
+ *
+ * @param list Pointer to the list.
+ * @param predicate Called once per element, front to back.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of elements erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_erase_if(DSCList *list, DSCPredicate predicate, void *context,
+                           size_t *removed);
+
+/**
+ * @brief Keep only the elements a predicate matches.
+ *
+ * @param list Pointer to the list.
+ * @param predicate Called once per element, front to back.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of elements erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_retain(DSCList *list, DSCPredicate predicate, void *context,
+                         size_t *removed);
+
+/**
+ * @brief Exchange the elements of two lists in constant time.
+ *
+ * The nodes change hands together with the chunks they live in; each list
+ * keeps its allocator and statistics. Swapping with an empty list moves every
+ * element across without copying any.
+ *
+ * @param list Pointer to the first list.
+ * @param other Pointer to the second list, of the same element type and with
+ *              an interchangeable allocator.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_swap(DSCList *list, DSCList *other);
+
+/**
+ * @brief A position in a list, for walking its elements from head to tail.
+ *
+ * A cursor is a plain value set up with dsc_list_cursor_init and advanced
+ * with dsc_list_cursor_next; walking the whole list is one linear pass that
+ * copies nothing. Erasing the element the cursor is about to yield invalidates it. The fields are private.
+ */
+typedef struct DSCListCursor DSCListCursor;
+
+struct DSCListCursor {
+    const DSCList *list; /** The list being walked. */
+    const void *node;    /** The node of the next element, NULL at the end. */
+};
+
+/**
+ * @brief Start a cursor at the first element of a list.
+ *
+ * @param list Pointer to the list.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_cursor_init(const DSCList *list, DSCListCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the list's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_list_cursor_next(DSCListCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, from head to tail.
+ *
+ * The visitor must not modify the list.
+ *
+ * @param list Pointer to the list.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_for_each(const DSCList *list, DSCVisitor visitor, void *context);
+
+/**
+ * @brief Save the list to a snapshot file, head to tail.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param list Pointer to the list.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_list_save(const DSCList *list, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the list.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param list Pointer to the list.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_list_stats(const DSCList *list, DSCStats *stats);
+
 #endif  // DSC_LIST_H
@@ -18,25 +18,171 @@
 #ifndef DSC_MAP_H
 #define DSC_MAP_H
 
+#include "dsc_allocator.h"
 #include "dsc_data.h"  
+#include "dsc_string.h"
 #include "dsc_type.h"
 #include "dsc_error.h"
+#include "dsc_stats.h"
+#include "dsc_thread_pool.h"
 
 #define DSC_MAP_INITIAL_CAPACITY 16
 
 #define DSC_MAP_LOAD_FACTOR 0.75
 
+/**
+ * @brief The number of shards of a DSC_MAP_BACKEND_SHARDED map created with
+ *        dsc_map_init_backend.
+ */
+#define DSC_MAP_SHARDS 64
+
 typedef struct DSCMap DSCMap;
 
 /**
- * @brief Initialize a new map.
+ * @brief The storage strategies a map can be initialized with.
+ */
+typedef enum DSCMapBackend {
+    DSC_MAP_BACKEND_CHAINED, /** Separate chaining, one node per entry. */
+    DSC_MAP_BACKEND_OPEN,    /** Open addressing over flat key/value slots
+                                 with group-probed control bytes. */
+    DSC_MAP_BACKEND_SHARDED  /** Open-addressing shards, each behind its own
+                                 read-write lock, for use from many threads. */
+} DSCMapBackend;
+
+/**
+ * @brief Initialize a new map using separate chaining.
  * 
- * @param new_map Pointer to the map to initialize.
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param value_type The data type of the map values.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_init(DSCMap **new_map, DSCType key_type, DSCType value_type);
+
+/**
+ * @brief Initialize a new map with the given storage backend.
+ *
+ * DSC_MAP_BACKEND_OPEN stores keys and values inline in contiguous arrays
+ * and needs no allocation per insert, which makes it the better choice for
+ * lookup-heavy workloads. DSC_MAP_BACKEND_SHARDED splits an open-addressing
+ * map into DSC_MAP_SHARDS shards that threads can use concurrently. Every
+ * backend exposes the same API.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param value_type The data type of the map values.
+ * @param backend The storage strategy to use.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_init_backend(DSCMap **new_map, DSCType key_type,
+                              DSCType value_type, DSCMapBackend backend);
+
+/**
+ * @brief Initialize a new map that takes all of its memory from an allocator.
+ *
+ * The map struct, its buckets or slots, its entries and its string copies all
+ * come from the allocator. With an arena the whole map can be dropped by
+ * releasing the arena, without calling dsc_map_deinit.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
  * @param key_type The data type of the map keys.
  * @param value_type The data type of the map values.
+ * @param backend The storage strategy to use.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the map.
  * @return DSCError code indicating success or failure.
  */
-DSCError dsc_map_init(DSCMap *new_map, DSCType key_type, DSCType value_type);
+DSCError dsc_map_init_allocator(DSCMap **new_map, DSCType key_type,
+                                DSCType value_type, DSCMapBackend backend,
+                                const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new map whose keys, values or both are fixed-size
+ *        records stored inline.
+ *
+ * A side of type DSC_TYPE_BYTES is described by its element descriptor and
+ * stored in the table's slots; a key or value pointer for it points at a
+ * whole record. The other side may be any built-in type, in which case its
+ * descriptor is ignored and may be NULL. Values are read back with the
+ * descriptor's copy callback. Such maps always use DSC_MAP_BACKEND_OPEN.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param key_element The descriptor of DSC_TYPE_BYTES keys, copied into the
+ *                    map.
+ * @param value_type The data type of the map values.
+ * @param value_element The descriptor of DSC_TYPE_BYTES values, copied into
+ *                      the map.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_init_bytes(DSCMap **new_map, DSCType key_type,
+                            const DSCElementType *key_element, DSCType value_type,
+                            const DSCElementType *value_element,
+                            const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new map that many threads can read and write at once.
+ *
+ * The map is split into shard_count open-addressing tables, each guarded by
+ * its own read-write lock, and the high bits of a key's hash pick its shard.
+ * Lookups take the shard's lock shared and updates take it exclusive, so
+ * threads only contend when they touch the same shard, and a shard that has
+ * to grow stalls no other. Whole-map calls such as size, clear and reserve
+ * visit the shards one at a time, so their view of a map that is being
+ * updated is a snapshot rather than an atomic one.
+ *
+ * The allocator is called from every thread that inserts and must be
+ * thread-safe; the default one is.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param value_type The data type of the map values.
+ * @param shard_count The number of shards, rounded up to a power of two, or
+ *                    0 for DSC_MAP_SHARDS. More shards than threads keep
+ *                    lock contention low.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_init_sharded(DSCMap **new_map, DSCType key_type,
+                              DSCType value_type, size_t shard_count,
+                              const DSCAllocator *allocator);
+
+/**
+ * @brief Enable or disable incremental rehashing.
+ *
+ * By default a map that outgrows its capacity moves every entry in a single
+ * pass. With incremental rehashing enabled the old slots stay live after a
+ * resize and each subsequent insert or erase migrates a bounded number of
+ * them, so no single call pays for the whole table. Lookups search both sets
+ * of slots until migration completes. Disabling it finishes any migration
+ * still in progress.
+ *
+ * Only supported by DSC_MAP_BACKEND_OPEN and DSC_MAP_BACKEND_SHARDED, where
+ * every shard resizes incrementally on its own.
+ *
+ * @param map Pointer to the map.
+ * @param enabled Whether resizes should be incremental.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_incremental_rehash(DSCMap *map, bool enabled);
+
+/**
+ * @brief Intern the map's long string keys in a string pool.
+ *
+ * String keys shorter than 16 bytes are always stored inline in their slot.
+ * With a pool, longer keys are interned instead of copied, so maps sharing a
+ * pool share one buffer per distinct key, and a lookup with a pointer
+ * obtained from the pool compares by address. The pool must outlive the map.
+ *
+ * Only supported by DSC_MAP_BACKEND_OPEN with DSC_TYPE_STRING keys, and only
+ * while the map is empty.
+ *
+ * @param map Pointer to the map.
+ * @param pool The pool to intern into.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_use_string_pool(DSCMap *map, DSCStringPool *pool);
 
 /**
  * @brief Deinitialize a map, freeing all allocated memory.
@@ -83,6 +229,21 @@ DSCError dsc_map_empty(const DSCMap *map, bool *result);
  */
 DSCError dsc_map_get(const DSCMap *map, void *key, void *result);
 
+/**
+ * @brief Borrow the string value associated with the specified key.
+ *
+ * Unlike dsc_map_get no copy is made; the view is valid until the map is
+ * next modified. On a sharded map the view is taken under the shard's read
+ * lock but stays valid only until the next write to that shard, by any
+ * thread, so concurrent users should prefer dsc_map_get.
+ *
+ * @param map Pointer to the map, whose values must be DSC_TYPE_STRING.
+ * @param key Pointer to the key data.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_get_view(const DSCMap *map, void *key, DSCStringView *result);
+
 /**
  * @brief Check if the map contains the specified key.
  *
@@ -93,6 +254,87 @@ DSCError dsc_map_get(const DSCMap *map, void *key, void *result);
  */
 DSCError dsc_map_contains(const DSCMap *map, void *key, bool *result);
 
+/**
+ * @brief Look up many keys at once.
+ *
+ * All keys are hashed and their buckets prefetched before any of them is
+ * resolved, so the memory latency of the lookups overlaps. Prefer this over a
+ * loop of dsc_map_get when resolving more than a handful of keys.
+ *
+ * @param map Pointer to the map.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param count The number of keys.
+ * @param values Contiguous array of count values to fill in. Entries for
+ *               missing keys are left untouched.
+ * @param results Array of count codes: DSC_ERROR_OK, DSC_ERROR_NOT_FOUND or
+ *                DSC_ERROR_OUT_OF_MEMORY for each key.
+ * @return DSCError code indicating success or failure of the call itself.
+ */
+DSCError dsc_map_get_batch(const DSCMap *map, void *keys, size_t count,
+                           void *values, DSCError *results);
+
+/**
+ * @brief Check whether the map contains each of many keys.
+ *
+ * @param map Pointer to the map.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param count The number of keys.
+ * @param results Array of count booleans to fill in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_contains_batch(const DSCMap *map, void *keys, size_t count,
+                                bool *results);
+
+/**
+ * @brief Grow the map so that it holds count elements without rehashing.
+ *
+ * The map never shrinks; a count below the current capacity is a no-op. A
+ * sharded map reserves every shard for its share of count, with headroom
+ * for keys that spread unevenly.
+ *
+ * @param map Pointer to the map.
+ * @param count The number of elements to make room for.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_reserve(DSCMap *map, size_t count);
+
+/**
+ * @brief Insert many key-value pairs at once.
+ *
+ * The map is sized once for the whole range before anything is inserted.
+ * Keys that are already present keep their current value and are skipped.
+ *
+ * @param map Pointer to the map.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param values Contiguous array of count values, parallel to keys.
+ * @param count The number of pairs.
+ * @return DSCError code indicating success or failure. On failure the pairs
+ *         before the failing one remain inserted.
+ */
+DSCError dsc_map_insert_range(DSCMap *map, void *keys, void *values, size_t count);
+
+/**
+ * @brief Insert many key-value pairs at once using a thread pool.
+ *
+ * Behaves like dsc_map_insert_range, and is meant for building a map from
+ * the buffers of two vectors (see dsc_vector_data). The keys are partitioned
+ * by hash: a sharded map inserts every shard's keys on one thread, taking
+ * its lock once; an open-addressing map hashes the keys in parallel and
+ * inserts them grouped by slot region. Chained maps, and ranges below the
+ * pool's cutoff, are inserted serially. Hash and compare callbacks of
+ * DSC_TYPE_BYTES keys are called from the pool's threads.
+ *
+ * @param map Pointer to the map.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param values Contiguous array of count values, parallel to keys.
+ * @param count The number of pairs.
+ * @param pool The pool to run on, or NULL.
+ * @return DSCError code indicating success or failure. On failure some of
+ *         the pairs may have been inserted.
+ */
+DSCError dsc_map_parallel_insert_range(DSCMap *map, void *keys, void *values, size_t count,
+                                       DSCThreadPool *pool);
+
 /**
  * @brief Insert a key-value pair into the map.
  *
@@ -103,6 +345,24 @@ DSCError dsc_map_contains(const DSCMap *map, void *key, bool *result);
  */
 DSCError dsc_map_insert(DSCMap *map, void *key, void *value);
 
+/**
+ * @brief Insert a key-value pair into the map, taking ownership of both.
+ *
+ * Like dsc_map_insert, but string keys and values are not copied: the map
+ * takes over the char * key and value point to, which must have been
+ * allocated with malloc and must not be used by the caller afterwards.
+ * String keys short enough to be stored inline are copied into the map and
+ * the caller's string freed. Records are moved in without their copy
+ * callbacks. On failure, including DSC_ERROR_ALREADY_EXISTS, the caller
+ * keeps ownership.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param value Pointer to the value data.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_insert_move(DSCMap *map, void *key, void *value);
+
 /**
  * @brief Erase the entry with the specified key from the map.
  *
@@ -120,4 +380,147 @@ DSCError dsc_map_erase(DSCMap *map, void *key);
  */
 DSCError dsc_map_clear(DSCMap *map);
 
+/**
+ * @brief Exchange the entries of two maps in constant time.
+ *
+ * Both maps must use the same backend, key and value types, and
+ * interchangeable allocators; each keeps its allocator and statistics.
+ * Swapping with an empty map moves every entry across without copying any.
+ * Neither map may be used by another thread during the swap.
+ *
+ * @param map Pointer to the first map.
+ * @param other Pointer to the second map.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_swap(DSCMap *map, DSCMap *other);
+
+/**
+ * @brief Called by dsc_map_for_each once per entry.
+ *
+ * @param key The entry's key, as dsc_element_view describes it.
+ * @param value The entry's value, the same way.
+ * @param context The pointer passed to dsc_map_for_each.
+ * @return true to go on, false to stop the walk early.
+ */
+typedef bool (*DSCMapVisitor)(const void *key, const void *value, void *context);
+
+/**
+ * @brief Called by dsc_map_erase_if and dsc_map_retain once per entry.
+ *
+ * The predicate must not modify the map.
+ *
+ * @param key The entry's key, as dsc_element_view describes it.
+ * @param value The entry's value, the same way.
+ * @param context The pointer passed to erase_if or retain.
+ * @return Whether the entry matches.
+ */
+typedef bool (*DSCMapPredicate)(const void *key, const void *value, void *context);
+
+/**
+ * @brief A position in a map, for walking its entries in storage order.
+ *
+ * A cursor is a plain value set up with dsc_map_cursor_init and advanced with
+ * dsc_map_cursor_next; walking the whole map is one linear pass over its
+ * buckets or slots that copies nothing. The order is unspecified, and the map
+ * must not be modified while it is walked. A cursor takes no locks: walk a
+ * sharded map only while no other thread writes to it, or use
+ * dsc_map_for_each. The fields are private.
+ */
+typedef struct DSCMapCursor DSCMapCursor;
+
+struct DSCMapCursor {
+    const DSCMap *map;  /** The map being walked. */
+    size_t shard;       /** The shard being walked, for sharded maps. */
+    size_t position;    /** The next bucket or slot to look at. */
+    const void *entry;  /** The next entry of a chained bucket, or NULL. */
+};
+
+/**
+ * @brief Start a cursor at the first entry of a map.
+ *
+ * @param map Pointer to the map.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_cursor_init(const DSCMap *map, DSCMapCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next entry.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param key Set to the entry's key in the map's own storage, as
+ *            dsc_element_view describes it.
+ * @param value Set to the entry's value the same way. May be NULL.
+ * @return true if there was an entry, false once the cursor is past the last
+ *         one.
+ */
+bool dsc_map_cursor_next(DSCMapCursor *cursor, const void **key, const void **value);
+
+/**
+ * @brief Call a visitor on every entry, in storage order.
+ *
+ * The visitor must not modify the map. A sharded map holds each shard's read
+ * lock while its entries are visited, so other threads may keep using the
+ * map meanwhile.
+ *
+ * @param map Pointer to the map.
+ * @param visitor Called with each entry; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_for_each(const DSCMap *map, DSCMapVisitor visitor, void *context);
+
+/**
+ * @brief Erase every entry a predicate matches.
+ *
+ * The entries are walked once in storage order. When the map ends up sparse
+ * enough its slots or buckets are rebuilt at a smaller capacity. A sharded
+ * map holds each shard's write lock while that shard is filtered.
+ *
+ * @param map Pointer to the map.
+ * @param predicate Called once per entry.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of entries erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_erase_if(DSCMap *map, DSCMapPredicate predicate, void *context,
+                          size_t *removed);
+
+/**
+ * @brief Keep only the entries a predicate matches.
+ *
+ * @param map Pointer to the map.
+ * @param predicate Called once per entry.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of entries erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_retain(DSCMap *map, DSCMapPredicate predicate, void *context,
+                        size_t *removed);
+
+/**
+ * @brief Save the map to a snapshot file with an index over its keys.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param map Pointer to the map.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_map_save(const DSCMap *map, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the map.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero. max_chain is measured over the buckets of a chaining map and is
+ * zero for the other backends.
+ *
+ * @param map Pointer to the map.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_map_stats(const DSCMap *map, DSCStats *stats);
+
 #endif // DSC_MAP_H
@@ -0,0 +1,318 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_ordered_map.h
+ * @brief A map that keeps its keys sorted, for ordered walks and range
+ *        queries.
+ *
+ * A DSCOrderedMap is a B+-tree: entries sit inline in leaves of a few cache
+ * lines each, and the leaves are linked in key order, so that a range scan
+ * touches one leaf after another instead of chasing a pointer per entry.
+ * Keys take any DSCType, or fixed-size records ordered by their descriptor's
+ * compare callback. Numbers are ordered by value with NaNs last, strings by
+ * strcmp.
+ *
+ * Keys and values are passed the way DSCMap takes them: a pointer to the
+ * value, to a char * for strings, or to a whole record for DSC_TYPE_BYTES.
+ */
+
+#ifndef DSC_ORDERED_MAP_H
+#define DSC_ORDERED_MAP_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_map.h"
+#include "dsc_stats.h"
+#include "dsc_string.h"
+#include "dsc_type.h"
+
+typedef struct DSCOrderedMap DSCOrderedMap;
+
+/**
+ * @brief Initialize a new ordered map.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param value_type The data type of the map values.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_init(DSCOrderedMap **new_map, DSCType key_type, DSCType value_type);
+
+/**
+ * @brief Initialize a new ordered map that takes all of its memory from an
+ *        allocator.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param value_type The data type of the map values.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the map.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_init_allocator(DSCOrderedMap **new_map, DSCType key_type,
+                                        DSCType value_type, const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new ordered map whose keys, values or both are
+ *        fixed-size records stored inline.
+ *
+ * Record keys are ordered by the key descriptor's compare callback, or by
+ * memcmp without one. A side of any other type ignores its descriptor,
+ * which may be NULL then.
+ *
+ * @param new_map Pointer to store the newly allocated map in.
+ * @param key_type The data type of the map keys.
+ * @param key_element The descriptor of DSC_TYPE_BYTES keys, copied into the
+ *                    map.
+ * @param value_type The data type of the map values.
+ * @param value_element The descriptor of DSC_TYPE_BYTES values, copied into
+ *                      the map.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_init_bytes(DSCOrderedMap **new_map, DSCType key_type,
+                                    const DSCElementType *key_element, DSCType value_type,
+                                    const DSCElementType *value_element,
+                                    const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize an ordered map, freeing all allocated memory.
+ *
+ * @param map Pointer to the map to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_deinit(DSCOrderedMap *map);
+
+/**
+ * @brief Get the number of entries in the map.
+ *
+ * @param map Pointer to the map.
+ * @param result Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_size(const DSCOrderedMap *map, size_t *result);
+
+/**
+ * @brief Check if the map is empty.
+ *
+ * @param map Pointer to the map.
+ * @param result Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_empty(const DSCOrderedMap *map, bool *result);
+
+/**
+ * @brief Get the value associated with the specified key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param result Pointer to store the value in; strings are copied with
+ *               malloc.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the key is absent.
+ */
+DSCError dsc_ordered_map_get(const DSCOrderedMap *map, void *key, void *result);
+
+/**
+ * @brief Borrow the string value associated with the specified key.
+ *
+ * The view is valid until the map is next modified.
+ *
+ * @param map Pointer to the map, whose values must be DSC_TYPE_STRING.
+ * @param key Pointer to the key data.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_get_view(const DSCOrderedMap *map, void *key, DSCStringView *result);
+
+/**
+ * @brief Check if the map contains the specified key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param result Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_contains(const DSCOrderedMap *map, void *key, bool *result);
+
+/**
+ * @brief Insert a key-value pair, copying strings and records.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param value Pointer to the value data.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_ALREADY_EXISTS if the key is present, in which case its
+ *         value is left alone. On failure the map is unchanged.
+ */
+DSCError dsc_ordered_map_insert(DSCOrderedMap *map, void *key, void *value);
+
+/**
+ * @brief Build an empty map from keys in strictly ascending order.
+ *
+ * The tree is built bottom-up with full leaves in a single pass, which is
+ * much faster than inserting the keys one by one and leaves no half-empty
+ * nodes behind.
+ *
+ * @param map Pointer to the map, which must be empty.
+ * @param keys A contiguous array of count keys: values, char * for strings,
+ *             or records.
+ * @param values A contiguous array of count values the same way.
+ * @param count The number of entries.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_INVALID_ARGUMENT if the map is not empty or the keys are
+ *         not strictly ascending. On failure the map is unchanged.
+ */
+DSCError dsc_ordered_map_load_sorted(DSCOrderedMap *map, void *keys, void *values, size_t count);
+
+/**
+ * @brief Erase a key and its value.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the key is absent.
+ */
+DSCError dsc_ordered_map_erase(DSCOrderedMap *map, void *key);
+
+/**
+ * @brief Remove every entry.
+ *
+ * @param map Pointer to the map.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_clear(DSCOrderedMap *map);
+
+/**
+ * @brief A position in an ordered map, for walking its entries in key order.
+ *
+ * A cursor is a plain value set up with dsc_ordered_map_cursor_init,
+ * dsc_ordered_map_lower_bound or dsc_ordered_map_upper_bound and advanced
+ * with dsc_ordered_map_cursor_next. The map must not be modified while it is
+ * walked. The fields are private.
+ */
+typedef struct DSCOrderedMapCursor DSCOrderedMapCursor;
+
+struct DSCOrderedMapCursor {
+    const DSCOrderedMap *map; /** The map being walked. */
+    const void *leaf;         /** The leaf being walked, NULL at the end. */
+    size_t index;             /** The next entry in the leaf. */
+};
+
+/**
+ * @brief Start a cursor at the smallest key of a map.
+ *
+ * @param map Pointer to the map.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_cursor_init(const DSCOrderedMap *map, DSCOrderedMapCursor *cursor);
+
+/**
+ * @brief Start a cursor at the first key not less than key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_lower_bound(const DSCOrderedMap *map, void *key,
+                                     DSCOrderedMapCursor *cursor);
+
+/**
+ * @brief Start a cursor at the first key greater than key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key data.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_upper_bound(const DSCOrderedMap *map, void *key,
+                                     DSCOrderedMapCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next entry in key order.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param key Set to the entry's key in the map's own storage, as
+ *            dsc_element_view describes it.
+ * @param value Set to the entry's value the same way. May be NULL.
+ * @return true if there was an entry, false once the cursor is past the last
+ *         one.
+ */
+bool dsc_ordered_map_cursor_next(DSCOrderedMapCursor *cursor, const void **key,
+                                 const void **value);
+
+/**
+ * @brief Call a visitor on every entry, in ascending key order.
+ *
+ * The visitor must not modify the map.
+ *
+ * @param map Pointer to the map.
+ * @param visitor Called with each entry; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_for_each(const DSCOrderedMap *map, DSCMapVisitor visitor,
+                                  void *context);
+
+/**
+ * @brief Call a visitor on every entry with a key in [low, high), in
+ *        ascending key order.
+ *
+ * The walk starts with one descent to low and then follows the leaves.
+ *
+ * @param map Pointer to the map.
+ * @param low Pointer to the smallest key to visit, or NULL to start at the
+ *            first entry.
+ * @param high Pointer to the key to stop before, or NULL to go on to the
+ *             last entry.
+ * @param visitor Called with each entry; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_range(const DSCOrderedMap *map, void *low, void *high,
+                               DSCMapVisitor visitor, void *context);
+
+/**
+ * @brief Save the map to a snapshot file with an index over its keys.
+ *
+ * The entries are written in key order. The file is replaced. Open it with
+ * dsc_snapshot_open.
+ *
+ * @param map Pointer to the map.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_ordered_map_save(const DSCOrderedMap *map, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the map.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param map Pointer to the map.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_map_stats(const DSCOrderedMap *map, DSCStats *stats);
+
+#endif // DSC_ORDERED_MAP_H
@@ -0,0 +1,257 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_ordered_set.h
+ * @brief A set that keeps its elements sorted, for ordered walks and range
+ *        queries.
+ *
+ * A DSCOrderedSet is the keys-only counterpart of DSCOrderedMap and shares
+ * its B+-tree, ordering and element conventions.
+ */
+
+#ifndef DSC_ORDERED_SET_H
+#define DSC_ORDERED_SET_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_stats.h"
+#include "dsc_type.h"
+
+typedef struct DSCOrderedSet DSCOrderedSet;
+
+/**
+ * @brief Initialize a new ordered set.
+ *
+ * @param new_set Pointer to store the newly allocated set in.
+ * @param type The data type stored in the set.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_init(DSCOrderedSet **new_set, DSCType type);
+
+/**
+ * @brief Initialize a new ordered set that takes all of its memory from an
+ *        allocator.
+ *
+ * @param new_set Pointer to store the newly allocated set in.
+ * @param type The data type stored in the set.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the set.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_init_allocator(DSCOrderedSet **new_set, DSCType type,
+                                        const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new ordered set of fixed-size records stored inline.
+ *
+ * The records are ordered by the descriptor's compare callback, or by memcmp
+ * without one.
+ *
+ * @param new_set Pointer to store the newly allocated set in.
+ * @param element The descriptor of the records, copied into the set.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_init_bytes(DSCOrderedSet **new_set, const DSCElementType *element,
+                                    const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize an ordered set, freeing all allocated memory.
+ *
+ * @param set Pointer to the set to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_deinit(DSCOrderedSet *set);
+
+/**
+ * @brief Get the number of elements in the set.
+ *
+ * @param set Pointer to the set.
+ * @param size Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_size(const DSCOrderedSet *set, size_t *size);
+
+/**
+ * @brief Check if the set is empty.
+ *
+ * @param set Pointer to the set.
+ * @param is_empty Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_empty(const DSCOrderedSet *set, bool *is_empty);
+
+/**
+ * @brief Check if the set contains an element.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the element.
+ * @param contains Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_contains(const DSCOrderedSet *set, void *key, bool *contains);
+
+/**
+ * @brief Insert an element, copying strings and records.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the element.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_ALREADY_EXISTS if the element is present.
+ */
+DSCError dsc_ordered_set_insert(DSCOrderedSet *set, void *key);
+
+/**
+ * @brief Build an empty set from elements in strictly ascending order.
+ *
+ * @param set Pointer to the set, which must be empty.
+ * @param keys A contiguous array of count elements.
+ * @param count The number of elements.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_INVALID_ARGUMENT if the set is not empty or the elements
+ *         are not strictly ascending. On failure the set is unchanged.
+ */
+DSCError dsc_ordered_set_load_sorted(DSCOrderedSet *set, void *keys, size_t count);
+
+/**
+ * @brief Erase an element.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the element.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the element is absent.
+ */
+DSCError dsc_ordered_set_erase(DSCOrderedSet *set, void *key);
+
+/**
+ * @brief Remove every element.
+ *
+ * @param set Pointer to the set.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_clear(DSCOrderedSet *set);
+
+/**
+ * @brief A position in an ordered set, for walking its elements in order.
+ *
+ * The set must not be modified while it is walked. The fields are private.
+ */
+typedef struct DSCOrderedSetCursor DSCOrderedSetCursor;
+
+struct DSCOrderedSetCursor {
+    const DSCOrderedSet *set; /** The set being walked. */
+    const void *leaf;         /** The leaf being walked, NULL at the end. */
+    size_t index;             /** The next element in the leaf. */
+};
+
+/**
+ * @brief Start a cursor at the smallest element of a set.
+ *
+ * @param set Pointer to the set.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_cursor_init(const DSCOrderedSet *set, DSCOrderedSetCursor *cursor);
+
+/**
+ * @brief Start a cursor at the first element not less than key.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the element to seek.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_lower_bound(const DSCOrderedSet *set, void *key,
+                                     DSCOrderedSetCursor *cursor);
+
+/**
+ * @brief Start a cursor at the first element greater than key.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the element to seek.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_upper_bound(const DSCOrderedSet *set, void *key,
+                                     DSCOrderedSetCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element in order.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the set's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_ordered_set_cursor_next(DSCOrderedSetCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, in ascending order.
+ *
+ * The visitor must not modify the set.
+ *
+ * @param set Pointer to the set.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_for_each(const DSCOrderedSet *set, DSCVisitor visitor, void *context);
+
+/**
+ * @brief Call a visitor on every element in [low, high), in ascending order.
+ *
+ * @param set Pointer to the set.
+ * @param low Pointer to the smallest element to visit, or NULL to start at
+ *            the first one.
+ * @param high Pointer to the element to stop before, or NULL to go on to the
+ *             last one.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_range(const DSCOrderedSet *set, void *low, void *high,
+                               DSCVisitor visitor, void *context);
+
+/**
+ * @brief Save the set to a snapshot file with an index over its elements.
+ *
+ * The elements are written in order. The file is replaced. Open it with
+ * dsc_snapshot_open.
+ *
+ * @param set Pointer to the set.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_ordered_set_save(const DSCOrderedSet *set, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the set.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param set Pointer to the set.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_ordered_set_stats(const DSCOrderedSet *set, DSCStats *stats);
+
+#endif // DSC_ORDERED_SET_H
@@ -0,0 +1,335 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_priority_queue.h
+ * @brief A priority queue on a contiguous 4-ary heap.
+ *
+ * A DSCPriorityQueue keeps its elements inline in one array laid out as a
+ * heap in which every node has DSC_PRIORITY_QUEUE_ARITY children. A wider
+ * node makes the heap shallower, and its children share one or two cache
+ * lines, so a pop touches fewer lines than with a binary heap.
+ *
+ * Elements are ordered as dsc_compare orders them: numbers by value with
+ * NaNs after every number, strings by strcmp and DSC_TYPE_BYTES records by
+ * the element descriptor's compare callback, or memcmp without one. A new
+ * queue pops its smallest element first.
+ *
+ * Every element gets a DSCPriorityHandle on push, which can later be used
+ * to change its priority or remove it in O(log n).
+ */
+
+#ifndef DSC_PRIORITY_QUEUE_H
+#define DSC_PRIORITY_QUEUE_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_stats.h"
+#include "dsc_type.h"
+
+/**
+ * @brief The number of children of every node of the heap.
+ */
+#define DSC_PRIORITY_QUEUE_ARITY 4
+
+#define DSC_PRIORITY_QUEUE_INITIAL_CAPACITY 16
+
+typedef struct DSCPriorityQueue DSCPriorityQueue;
+
+/**
+ * @brief Names one element of a priority queue for as long as it is queued.
+ *
+ * Once the element is popped or erased the handle is released, and a later
+ * push may hand the same value out again.
+ */
+typedef size_t DSCPriorityHandle;
+
+/**
+ * @brief Initialize a new priority queue.
+ *
+ * @param queue Pointer to store the new priority queue in.
+ * @param type The data type stored in the priority queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_init(DSCPriorityQueue **queue, DSCType type);
+
+/**
+ * @brief Initialize a new priority queue that takes all of its memory from
+ *        an allocator.
+ *
+ * @param queue Pointer to store the new priority queue in.
+ * @param type The data type stored in the priority queue.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the priority queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_init_allocator(DSCPriorityQueue **queue, DSCType type,
+                                           const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new priority queue of fixed-size records stored inline.
+ *
+ * The priority queue has type DSC_TYPE_BYTES. Every element pointer passed
+ * to or returned from it points at a whole record of element->size bytes,
+ * and the records sit back to back in the heap array.
+ *
+ * @param queue A pointer to store the new priority queue in.
+ * @param element The record descriptor, copied into the priority queue. Its
+ *                compare callback orders the records.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_priority_queue_init_bytes(DSCPriorityQueue **queue,
+                                       const DSCElementType *element,
+                                       const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a priority queue, freeing all allocated memory.
+ *
+ * @param queue Pointer to the priority queue to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_deinit(DSCPriorityQueue *queue);
+
+/**
+ * @brief Choose whether the largest or the smallest element is popped first.
+ *
+ * @param queue Pointer to the priority queue, which must be empty.
+ * @param max_first true to pop the largest element first, false (the
+ *                  default) for the smallest.
+ * @return DSCError code indicating success or failure:
+ *         DSC_ERROR_INVALID_ARGUMENT if the priority queue is not empty.
+ */
+DSCError dsc_priority_queue_set_max_first(DSCPriorityQueue *queue, bool max_first);
+
+/**
+ * @brief Get the current size of the priority queue.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param result Pointer to store the size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_size(const DSCPriorityQueue *queue, size_t *result);
+
+/**
+ * @brief Get the current capacity of the priority queue.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param result Pointer to store the capacity.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_capacity(const DSCPriorityQueue *queue, size_t *result);
+
+/**
+ * @brief Check if the priority queue is empty.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param result Pointer to store the boolean result.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_empty(const DSCPriorityQueue *queue, bool *result);
+
+/**
+ * @brief Grow the priority queue so that it holds count elements without
+ *        resizing.
+ *
+ * Never shrinks.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param count The number of elements to make room for.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_reserve(DSCPriorityQueue *queue, size_t count);
+
+/**
+ * @brief Release the memory the heap array holds beyond its current size.
+ *
+ * @param queue Pointer to the priority queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_shrink_to_fit(DSCPriorityQueue *queue);
+
+/**
+ * @brief Set how the priority queue grows when full and shrinks after pops.
+ *
+ * A new priority queue uses DSC_GROWTH_POLICY_DEFAULT. With a non-zero
+ * shrink ratio, the pops release memory once the size drops far enough below
+ * the capacity, but never below DSC_PRIORITY_QUEUE_INITIAL_CAPACITY.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param policy The policy to copy into the priority queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_set_growth(DSCPriorityQueue *queue,
+                                       const DSCGrowthPolicy *policy);
+
+/**
+ * @brief Get the element that would be popped next.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param result Pointer to store the element data. A string is copied with
+ *               malloc and must be freed by the caller.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_top(const DSCPriorityQueue *queue, void *result);
+
+/**
+ * @brief Push an element in O(log n).
+ *
+ * @param queue Pointer to the priority queue.
+ * @param data Pointer to the element data to push (a char ** for a string
+ *             priority queue).
+ * @param handle Set to the element's handle, or NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_push(DSCPriorityQueue *queue, void *data,
+                                 DSCPriorityHandle *handle);
+
+/**
+ * @brief Push a contiguous array of elements.
+ *
+ * The heap array is resized at most once. When count is at least the
+ * current size the whole heap is rebuilt bottom-up in O(size + count), so
+ * filling an empty priority queue from an array takes linear time; smaller
+ * batches are sifted in one by one.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param data A pointer to the first of count elements (an array of char *
+ *             for a string priority queue).
+ * @param count The number of elements to push.
+ * @param handles An array to store the handle of each element in, or NULL.
+ * @return DSCError code indicating success or failure. On failure the
+ *         priority queue is left unchanged.
+ */
+DSCError dsc_priority_queue_push_range(DSCPriorityQueue *queue, void *data, size_t count,
+                                       DSCPriorityHandle *handles);
+
+/**
+ * @brief Pop the element that comes first in O(log n).
+ *
+ * @param queue Pointer to the priority queue.
+ * @param result Pointer to store the popped element data. A popped string
+ *               is handed over to the caller, who must free it.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_pop(DSCPriorityQueue *queue, void *result);
+
+/**
+ * @brief Pop the first count elements into an array, in priority order.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param results An array of count elements to store the popped ones in.
+ * @param count The number of elements to pop.
+ * @return DSCError code indicating success or failure: DSC_ERROR_OUT_OF_RANGE
+ *         if the priority queue holds fewer than count elements. Handing
+ *         over a string can only fail with a custom allocator; the strings
+ *         handed over before the failure stay popped.
+ */
+DSCError dsc_priority_queue_pop_range(DSCPriorityQueue *queue, void *results, size_t count);
+
+/**
+ * @brief Read the element a handle names.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param handle The handle of the element.
+ * @param result Pointer to store the element data. A string is copied with
+ *               malloc and must be freed by the caller.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the handle names no queued element.
+ */
+DSCError dsc_priority_queue_get(const DSCPriorityQueue *queue, DSCPriorityHandle handle,
+                                void *result);
+
+/**
+ * @brief Replace the element a handle names and restore the heap in
+ *        O(log n).
+ *
+ * This is the decrease-key operation of a min-first priority queue, but the
+ * new element may come before or after the old one. The handle stays valid.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param handle The handle of the element.
+ * @param data Pointer to the new element data.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the handle names no queued element.
+ */
+DSCError dsc_priority_queue_update(DSCPriorityQueue *queue, DSCPriorityHandle handle,
+                                   void *data);
+
+/**
+ * @brief Remove the element a handle names in O(log n).
+ *
+ * @param queue Pointer to the priority queue.
+ * @param handle The handle of the element, released by the call.
+ * @return DSCError code indicating success or failure: DSC_ERROR_NOT_FOUND
+ *         if the handle names no queued element.
+ */
+DSCError dsc_priority_queue_erase(DSCPriorityQueue *queue, DSCPriorityHandle handle);
+
+/**
+ * @brief Remove every element but keep the current capacity.
+ *
+ * Every handle is released.
+ *
+ * @param queue Pointer to the priority queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_clear(DSCPriorityQueue *queue);
+
+/**
+ * @brief Call a visitor on every element, in heap order.
+ *
+ * Only the first element visited is guaranteed to come first; the rest
+ * follow the layout of the heap array. The visitor must not modify the
+ * priority queue.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param visitor Called with each element, as dsc_element_view describes it;
+ *                returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_for_each(const DSCPriorityQueue *queue, DSCVisitor visitor,
+                                     void *context);
+
+/**
+ * @brief Save the priority queue to a snapshot file, in heap order.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_priority_queue_save(const DSCPriorityQueue *queue, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the priority queue.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param queue Pointer to the priority queue.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_priority_queue_stats(const DSCPriorityQueue *queue, DSCStats *stats);
+
+#endif // DSC_PRIORITY_QUEUE_H
@@ -18,9 +18,13 @@
 #ifndef DSC_QUEUE_H
 #define DSC_QUEUE_H
 
+#include "dsc_allocator.h"
 #include "dsc_data.h"
+#include "dsc_string.h"
 #include "dsc_type.h" 
 #include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_stats.h"
 #include "dsc_utils.h"
 
 #define DSC_QUEUE_INITIAL_CAPACITY 16
@@ -30,11 +34,39 @@ typedef struct DSCQueue DSCQueue;
 /**
  * @brief Initialize a new queue.
  *
- * @param new_queue Pointer to the queue to initialize.
+ * @param queue Pointer to store the new queue in.
  * @param type The data type stored in the queue.
  * @return DSCError code indicating success or failure.
  */
-DSCError dsc_queue_init(DSCQueue *new_queue, DSCType type);
+DSCError dsc_queue_init(DSCQueue **queue, DSCType type);
+
+/**
+ * @brief Initialize a new queue that takes all of its memory from an
+ *        allocator.
+ *
+ * @param queue Pointer to store the new queue in.
+ * @param type The data type stored in the queue.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_init_allocator(DSCQueue **queue, DSCType type,
+                                  const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new queue of fixed-size records stored inline.
+ *
+ * The queue has type DSC_TYPE_BYTES. Every element pointer passed to or
+ * returned from it points at a whole record of element->size bytes, and the
+ * records sit back to back in the ring buffer.
+ *
+ * @param queue A pointer to store the new queue in.
+ * @param element The record descriptor, copied into the queue.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_queue_init_bytes(DSCQueue **queue, const DSCElementType *element,
+                              const DSCAllocator *allocator);
 
 /**
  * @brief Deinitialize a queue, freeing all allocated memory.
@@ -71,6 +103,27 @@ DSCError dsc_queue_capacity(const DSCQueue *queue, size_t *result);
  */
 DSCError dsc_queue_empty(const DSCQueue *queue, bool *result);
 
+/**
+ * @brief Release the memory the queue holds beyond its current size.
+ *
+ * @param queue Pointer to the queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_shrink_to_fit(DSCQueue *queue);
+
+/**
+ * @brief Set how the queue grows when full and shrinks after pops.
+ *
+ * A new queue uses DSC_GROWTH_POLICY_DEFAULT. With a non-zero shrink ratio,
+ * dsc_queue_pop releases memory once the size drops far enough below the
+ * capacity, but never below DSC_QUEUE_INITIAL_CAPACITY.
+ *
+ * @param queue Pointer to the queue.
+ * @param policy The policy to copy into the queue.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_set_growth(DSCQueue *queue, const DSCGrowthPolicy *policy);
+
 /**
  * @brief Get the element at the front of the queue.
  *
@@ -80,6 +133,17 @@ DSCError dsc_queue_empty(const DSCQueue *queue, bool *result);
  */
 DSCError dsc_queue_front(const DSCQueue *queue, void *result);
 
+/**
+ * @brief Borrow the string at the front of the queue without copying it.
+ *
+ * The view is valid until the queue is next modified.
+ *
+ * @param queue Pointer to the queue, whose elements must be DSC_TYPE_STRING.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_front_view(const DSCQueue *queue, DSCStringView *result);
+
 /**
  * @brief Get the element at the back of the queue.
  *
@@ -98,13 +162,112 @@ DSCError dsc_queue_back(const DSCQueue *queue, void *result);
  */
 DSCError dsc_queue_push(DSCQueue *queue, void *data);
 
+/**
+ * @brief Push an element onto the back of the queue, taking ownership of it.
+ *
+ * Like dsc_queue_push, but a string is not copied: the queue adopts the
+ * char * data points to, which must have been allocated with malloc and must
+ * not be used by the caller afterwards. A record is moved in without its copy
+ * callback. On failure the caller keeps ownership.
+ *
+ * @param queue Pointer to the queue.
+ * @param data Pointer to the element data to push.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_push_move(DSCQueue *queue, void *data);
+
 /**
  * @brief Pop an element from the front of the queue.
  *
  * @param queue Pointer to the queue.
- * @param result Pointer to store the popped element data.
+ * @param result Pointer to store the popped element data. A popped string
+ *               is handed over to the caller, who must free it.
  * @return DSCError code indicating success or failure.
  */
 DSCError dsc_queue_pop(DSCQueue *queue, void *result);
 
+/**
+ * @brief Exchange the elements of two queues in constant time.
+ *
+ * Only the buffers change hands; each queue keeps its allocator, growth
+ * policy and statistics. Swapping with an empty queue moves every element
+ * across without copying any.
+ *
+ * @param queue Pointer to the first queue.
+ * @param other Pointer to the second queue, of the same element type and
+ *              with an interchangeable allocator.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_swap(DSCQueue *queue, DSCQueue *other);
+
+/**
+ * @brief A position in a queue, for walking its elements from front to back.
+ *
+ * A cursor is a plain value set up with dsc_queue_cursor_init and advanced
+ * with dsc_queue_cursor_next; walking the whole queue is one linear pass that
+ * copies nothing. The queue must not be modified while it is walked. The fields are private.
+ */
+typedef struct DSCQueueCursor DSCQueueCursor;
+
+struct DSCQueueCursor {
+    const DSCQueue *queue; /** The queue being walked. */
+    size_t index;          /** The number of elements already yielded. */
+};
+
+/**
+ * @brief Start a cursor at the first element of a queue.
+ *
+ * @param queue Pointer to the queue.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_cursor_init(const DSCQueue *queue, DSCQueueCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the queue's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_queue_cursor_next(DSCQueueCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, from front to back.
+ *
+ * The visitor must not modify the queue.
+ *
+ * @param queue Pointer to the queue.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_for_each(const DSCQueue *queue, DSCVisitor visitor, void *context);
+
+/**
+ * @brief Save the queue to a snapshot file, front to back.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param queue Pointer to the queue.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_queue_save(const DSCQueue *queue, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the queue.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param queue Pointer to the queue.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_queue_stats(const DSCQueue *queue, DSCStats *stats);
+
 #endif // DSC_QUEUE_H
@@ -0,0 +1,270 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_ring.h
+ * @brief Bounded lock-free ring buffers for passing elements between threads.
+ *
+ * DSCSpscRing connects exactly one producer thread to one consumer thread;
+ * each side owns one index and only reads the other's, so push and pop are a
+ * load, a copy and a release store. DSCMpmcRing accepts any number of
+ * producers and consumers; every slot carries a sequence number that tells a
+ * thread whether the slot is ready for its turn (D. Vyukov's bounded queue),
+ * so contention is limited to one compare-and-swap per operation or batch.
+ *
+ * Both rings hold a fixed number of elements, rounded up to a power of two,
+ * and never grow: pushing into a full ring fails with DSC_ERROR_FULL and
+ * popping from an empty one with DSC_ERROR_EMPTY_CONTAINER, without
+ * blocking. Elements follow the DSCType model of the other containers.
+ * Strings are copied on push and handed over on pop; DSC_TYPE_BYTES records
+ * are moved in and out bitwise, so ownership travels with the record and the
+ * copy callback is never called.
+ *
+ * The allocator is only used to create and destroy a ring and need not be
+ * thread-safe. String copies are made with malloc, since any producer may
+ * make one, and the caller frees popped strings as usual.
+ */
+
+#ifndef DSC_RING_H
+#define DSC_RING_H
+
+#include "dsc_allocator.h"
+#include "dsc_data.h"
+#include "dsc_error.h"
+#include "dsc_type.h"
+#include "dsc_utils.h"
+
+/**
+ * @brief A bounded single-producer, single-consumer ring.
+ */
+typedef struct DSCSpscRing DSCSpscRing;
+
+/**
+ * @brief A bounded multi-producer, multi-consumer ring.
+ */
+typedef struct DSCMpmcRing DSCMpmcRing;
+
+/* Single producer, single consumer */
+
+/**
+ * @brief Initialize a new SPSC ring.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param type The data type stored in the ring.
+ * @param capacity The number of elements, rounded up to a power of two.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_spsc_ring_init(DSCSpscRing **ring, DSCType type, size_t capacity);
+
+/**
+ * @brief Initialize a new SPSC ring whose slots come from an allocator.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param type The data type stored in the ring.
+ * @param capacity The number of elements, rounded up to a power of two.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the ring.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_spsc_ring_init_allocator(DSCSpscRing **ring, DSCType type,
+                                      size_t capacity,
+                                      const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new SPSC ring of fixed-size records stored inline.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param element The record descriptor, copied into the ring. Only its size
+ *                and destroy callback are used.
+ * @param capacity The number of records, rounded up to a power of two.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_spsc_ring_init_bytes(DSCSpscRing **ring,
+                                  const DSCElementType *element,
+                                  size_t capacity,
+                                  const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a ring, releasing the elements still in it.
+ *
+ * No other thread may be using the ring.
+ */
+DSCError dsc_spsc_ring_deinit(DSCSpscRing *ring);
+
+/**
+ * @brief Get the number of elements the ring can hold.
+ */
+DSCError dsc_spsc_ring_capacity(const DSCSpscRing *ring, size_t *result);
+
+/**
+ * @brief Get the number of elements in the ring.
+ *
+ * Exact when called from the producer or the consumer, a snapshot otherwise.
+ */
+DSCError dsc_spsc_ring_size(const DSCSpscRing *ring, size_t *result);
+
+/**
+ * @brief Push an element. Producer only.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_FULL, or DSC_ERROR_OUT_OF_MEMORY if a
+ *         string could not be copied.
+ */
+DSCError dsc_spsc_ring_push(DSCSpscRing *ring, void *value);
+
+/**
+ * @brief Pop the oldest element. Consumer only.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_EMPTY_CONTAINER.
+ */
+DSCError dsc_spsc_ring_pop(DSCSpscRing *ring, void *result);
+
+/**
+ * @brief Push up to count contiguous elements and publish them at once.
+ *        Producer only.
+ *
+ * @param ring Pointer to the ring.
+ * @param values Contiguous array of count elements.
+ * @param count The number of elements to push.
+ * @param pushed Set to the number of elements pushed, which is less than
+ *               count when the ring fills up.
+ * @return DSCError code indicating success or failure. Running out of room is
+ *         not a failure.
+ */
+DSCError dsc_spsc_ring_push_batch(DSCSpscRing *ring, void *values, size_t count,
+                                  size_t *pushed);
+
+/**
+ * @brief Pop up to count elements into a contiguous array and release their
+ *        slots at once. Consumer only.
+ *
+ * @param ring Pointer to the ring.
+ * @param results Contiguous array with room for count elements.
+ * @param count The maximum number of elements to pop.
+ * @param popped Set to the number of elements popped.
+ * @return DSCError code indicating success or failure. An empty ring is not a
+ *         failure.
+ */
+DSCError dsc_spsc_ring_pop_batch(DSCSpscRing *ring, void *results, size_t count,
+                                 size_t *popped);
+
+/* Multiple producers, multiple consumers */
+
+/**
+ * @brief Initialize a new MPMC ring.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param type The data type stored in the ring.
+ * @param capacity The number of elements, rounded up to a power of two.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_mpmc_ring_init(DSCMpmcRing **ring, DSCType type, size_t capacity);
+
+/**
+ * @brief Initialize a new MPMC ring whose slots come from an allocator.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param type The data type stored in the ring.
+ * @param capacity The number of elements, rounded up to a power of two.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the ring.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_mpmc_ring_init_allocator(DSCMpmcRing **ring, DSCType type,
+                                      size_t capacity,
+                                      const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new MPMC ring of fixed-size records stored inline.
+ *
+ * @param ring Pointer to store the new ring in.
+ * @param element The record descriptor, copied into the ring. Only its size
+ *                and destroy callback are used.
+ * @param capacity The number of records, rounded up to a power of two.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_mpmc_ring_init_bytes(DSCMpmcRing **ring,
+                                  const DSCElementType *element,
+                                  size_t capacity,
+                                  const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a ring, releasing the elements still in it.
+ *
+ * No other thread may be using the ring.
+ */
+DSCError dsc_mpmc_ring_deinit(DSCMpmcRing *ring);
+
+/**
+ * @brief Get the number of elements the ring can hold.
+ */
+DSCError dsc_mpmc_ring_capacity(const DSCMpmcRing *ring, size_t *result);
+
+/**
+ * @brief Get a snapshot of the number of elements in the ring.
+ *
+ * Elements whose push or pop is still in progress are counted as pushed or
+ * popped.
+ */
+DSCError dsc_mpmc_ring_size(const DSCMpmcRing *ring, size_t *result);
+
+/**
+ * @brief Push an element from any thread.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_FULL, or DSC_ERROR_OUT_OF_MEMORY if a
+ *         string could not be copied.
+ */
+DSCError dsc_mpmc_ring_push(DSCMpmcRing *ring, void *value);
+
+/**
+ * @brief Pop the oldest available element from any thread.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_EMPTY_CONTAINER.
+ */
+DSCError dsc_mpmc_ring_pop(DSCMpmcRing *ring, void *result);
+
+/**
+ * @brief Push up to count contiguous elements from any thread.
+ *
+ * The free slots in a row are claimed with a single compare-and-swap, so the
+ * elements of one batch stay contiguous in the ring's order.
+ *
+ * @param ring Pointer to the ring.
+ * @param values Contiguous array of count elements.
+ * @param count The number of elements to push.
+ * @param pushed Set to the number of elements pushed.
+ * @return DSCError code indicating success or failure. Running out of room is
+ *         not a failure.
+ */
+DSCError dsc_mpmc_ring_push_batch(DSCMpmcRing *ring, void *values, size_t count,
+                                  size_t *pushed);
+
+/**
+ * @brief Pop up to count elements into a contiguous array from any thread.
+ *
+ * @param ring Pointer to the ring.
+ * @param results Contiguous array with room for count elements.
+ * @param count The maximum number of elements to pop.
+ * @param popped Set to the number of elements popped.
+ * @return DSCError code indicating success or failure. An empty ring is not a
+ *         failure.
+ */
+DSCError dsc_mpmc_ring_pop_batch(DSCMpmcRing *ring, void *results, size_t count,
+                                 size_t *popped);
+
+#endif  // DSC_RING_H
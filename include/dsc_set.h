@@ -18,9 +18,14 @@
 #ifndef DSC_SET_H  
 #define DSC_SET_H
 
+#include "dsc_allocator.h"
+#include "dsc_bloom.h"
 #include "dsc_data.h"
+#include "dsc_string.h"
 #include "dsc_type.h"
 #include "dsc_error.h"
+#include "dsc_stats.h"
+#include "dsc_thread_pool.h"
 
 #define DSC_SET_INITIAL_CAPACITY 16 
 
@@ -31,16 +36,79 @@ typedef struct DSCSet DSCSet;
 /**
  * @brief Initialize a new set.
  *
- * @param new_set Pointer to the set to initialize.
+ * @param new_set Pointer to store the newly allocated set in.
  * @param type The data type stored in the set.
  * @return DSCError code indicating success or failure.
  */
-DSCError dsc_set_init(DSCSet *new_set, DSCType type);
+DSCError dsc_set_init(DSCSet **new_set, DSCType type);
+
+/**
+ * @brief Initialize a new set that takes all of its memory from an allocator.
+ *
+ * @param new_set Pointer to store the newly allocated set in.
+ * @param type The data type stored in the set.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the set.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_init_allocator(DSCSet **new_set, DSCType type,
+                                const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new set of fixed-size records stored inline.
+ *
+ * The set has type DSC_TYPE_BYTES. Every key pointer passed to it points at a
+ * whole record of element->size bytes, and the records sit in the table's key
+ * slots. Records are hashed and compared with the descriptor's callbacks, so
+ * records that compare equal must hash equally.
+ *
+ * @param new_set Pointer to store the newly allocated set in.
+ * @param element The record descriptor, copied into the set.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_init_bytes(DSCSet **new_set, const DSCElementType *element,
+                            const DSCAllocator *allocator);
+
+/**
+ * @brief Enable or disable incremental rehashing.
+ *
+ * With incremental rehashing enabled a resize keeps the old slots live and
+ * each subsequent insert or erase migrates a bounded number of them, instead
+ * of moving every key in one pass. Disabling it finishes any migration still
+ * in progress.
+ *
+ * @param set Pointer to the set.
+ * @param enabled Whether resizes should be incremental.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_incremental_rehash(DSCSet *set, bool enabled);
+
+/**
+ * @brief Intern the set's long string keys in a string pool.
+ *
+ * String keys shorter than 16 bytes are always stored inline in their slot.
+ * With a pool, longer keys are interned instead of copied and a lookup with a
+ * pointer obtained from the pool compares by address. The pool must outlive
+ * the set.
+ *
+ * Only supported for DSC_TYPE_STRING sets, and only while the set is empty.
+ *
+ * @param set Pointer to the set.
+ * @param pool The pool to intern into.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_use_string_pool(DSCSet *set, DSCStringPool *pool);
 
 /**
  * @brief Deinitialize a set, freeing all allocated memory.
  *
  * @param set Pointer to the set to deinitialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_deinit(DSCSet *set);
+
+/**
  * @brief Get the current size of the set.
  *
  * @param set Pointer to the set.
@@ -86,6 +154,53 @@ DSCError dsc_set_empty(const DSCSet *set, bool *result);
  */
 DSCError dsc_set_contains(const DSCSet *set, void *key, bool *result);
 
+/**
+ * @brief Check whether the set contains each of many keys.
+ *
+ * All keys are hashed and their slots prefetched before any of them is
+ * resolved, so the memory latency of the lookups overlaps.
+ *
+ * @param set Pointer to the set.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param count The number of keys.
+ * @param results Array of count booleans to fill in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_contains_batch(const DSCSet *set, void *keys, size_t count,
+                                bool *results);
+
+/**
+ * @brief Grow the set so that it holds count keys without rehashing.
+ *
+ * The set never shrinks; a count below the current capacity is a no-op.
+ *
+ * @param set Pointer to the set.
+ * @param count The number of keys to make room for.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_reserve(DSCSet *set, size_t count);
+
+/**
+ * @brief Insert many keys at once using a thread pool.
+ *
+ * The set is sized once for every key. The keys are hashed in parallel and
+ * then inserted grouped by the region of slots their hash points to, which
+ * keeps the inserts within cache; this suits building a set from a vector's
+ * buffer (see dsc_vector_data). Ranges below the pool's cutoff are inserted
+ * serially. Keys already present, or repeated in the range, are skipped.
+ * Hash and compare callbacks of DSC_TYPE_BYTES keys are called from the
+ * pool's threads.
+ *
+ * @param set Pointer to the set.
+ * @param keys Contiguous array of count keys (char * entries for strings).
+ * @param count The number of keys.
+ * @param pool The pool to hash on, or NULL.
+ * @return DSCError code indicating success or failure. On failure some of
+ *         the keys may have been inserted.
+ */
+DSCError dsc_set_parallel_insert_range(DSCSet *set, void *keys, size_t count,
+                                       DSCThreadPool *pool);
+
 /**
  * @brief Insert a key into the set.
  *
@@ -95,6 +210,22 @@ DSCError dsc_set_contains(const DSCSet *set, void *key, bool *result);
  */
 DSCError dsc_set_insert(DSCSet *set, void *key);
 
+/**
+ * @brief Insert a key into the set, taking ownership of it.
+ *
+ * Like dsc_set_insert, but a string key is not copied: the set takes over
+ * the char * key points to, which must have been allocated with malloc and
+ * must not be used by the caller afterwards. Strings short enough to be
+ * stored inline are copied into the set and the caller's string freed. A
+ * record is moved in without its copy callback. On failure, including
+ * DSC_ERROR_ALREADY_EXISTS, the caller keeps ownership.
+ *
+ * @param set Pointer to the set.
+ * @param key Pointer to the key data.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_insert_move(DSCSet *set, void *key);
+
 /**
  * @brief Erase the specified key from the set.
  *
@@ -104,4 +235,140 @@ DSCError dsc_set_insert(DSCSet *set, void *key);
  */
 DSCError dsc_set_erase(DSCSet *set, void *key);
 
+/**
+ * @brief Erase every key a predicate matches.
+ *
+ * The keys are walked once in slot order. When the set ends up sparse enough
+ * its slots are rebuilt at a smaller capacity.
+ *
+ * @param set Pointer to the set.
+ * @param predicate Called once per key.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of keys erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_erase_if(DSCSet *set, DSCPredicate predicate, void *context, size_t *removed);
+
+/**
+ * @brief Keep only the keys a predicate matches.
+ *
+ * @param set Pointer to the set.
+ * @param predicate Called once per key.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of keys erased, may be NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_retain(DSCSet *set, DSCPredicate predicate, void *context, size_t *removed);
+
+/**
+ * @brief Clear all keys from the set.
+ *
+ * @param set Pointer to the set.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_clear(DSCSet *set);
+
+/**
+ * @brief Exchange the elements of two sets in constant time.
+ *
+ * The slots change hands together with any string pool and any incremental
+ * resize in flight; each set keeps its allocator and statistics. Swapping
+ * with an empty set moves every element across without copying any.
+ *
+ * @param set Pointer to the first set.
+ * @param other Pointer to the second set, of the same key type and with an
+ *              interchangeable allocator.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_swap(DSCSet *set, DSCSet *other);
+
+/**
+ * @brief A position in a set, for walking its elements in slot order.
+ *
+ * A cursor is a plain value set up with dsc_set_cursor_init and advanced
+ * with dsc_set_cursor_next; walking the whole set is one linear pass that
+ * copies nothing. The order is unspecified, and the set must not be modified while it is walked. The fields are private.
+ */
+typedef struct DSCSetCursor DSCSetCursor;
+
+struct DSCSetCursor {
+    const DSCSet *set; /** The set being walked. */
+    size_t position;   /** The next slot to look at. */
+};
+
+/**
+ * @brief Start a cursor at the first element of a set.
+ *
+ * @param set Pointer to the set.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_cursor_init(const DSCSet *set, DSCSetCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the set's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_set_cursor_next(DSCSetCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, in slot order.
+ *
+ * The visitor must not modify the set.
+ *
+ * @param set Pointer to the set.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_for_each(const DSCSet *set, DSCVisitor visitor, void *context);
+
+/**
+ * @brief Build a Bloom filter holding every element of the set.
+ *
+ * The filter is sized for the set's current size and uses the set's
+ * allocator. Checking it before dsc_set_contains turns most misses into a
+ * single cache-line read. The filter is a snapshot: elements inserted into
+ * the set later must be added to it with dsc_bloom_insert, and elements
+ * erased later stay possibly present.
+ *
+ * @param set Pointer to the set.
+ * @param false_positive_rate The rate of false positives wanted, between 0
+ *                            and 1.
+ * @param filter Pointer to store the new filter in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_build_bloom(const DSCSet *set, double false_positive_rate,
+                             DSCBloomFilter **filter);
+
+/**
+ * @brief Save the set to a snapshot file with an index over its
+ *        elements.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param set Pointer to the set.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_set_save(const DSCSet *set, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the set.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param set Pointer to the set.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_set_stats(const DSCSet *set, DSCStats *stats);
+
 #endif // DSC_SET_H
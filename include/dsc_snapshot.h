@@ -0,0 +1,144 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_snapshot.h
+ * @brief Read-only containers mapped straight from binary snapshot files.
+ *
+ * Every container can be saved to a snapshot file with its dsc_*_save
+ * function. A snapshot is a header followed by flat arrays: one column of
+ * fixed-size keys (the elements of a sequence), one of values for maps, a
+ * pool of NUL-terminated strings that string columns refer to by offset, and
+ * for sets and maps an open-addressing index over the keys. Nothing in the
+ * file is a pointer, so dsc_snapshot_open maps it and reads it in place:
+ * opening costs the same for any size, and the pages are faulted in as they
+ * are used instead of being rebuilt element by element.
+ *
+ * The file stores elements in the writer's native byte order and sizes,
+ * which the header records; opening a file from a different layout, or of
+ * a different DSC_SNAPSHOT_VERSION, fails with DSC_ERROR_INVALID_FORMAT.
+ * DSC_TYPE_BYTES keys are hashed and compared as raw bytes in a snapshot,
+ * whatever callbacks the saved container used.
+ *
+ * Element pointers handed out by a snapshot point into the mapping, as
+ * dsc_element_view describes them, and stay valid until it is closed.
+ * Saving replaces the file atomically, so a snapshot open on a path keeps
+ * reading the version it opened even when the path is saved over.
+ */
+
+#ifndef DSC_SNAPSHOT_H
+#define DSC_SNAPSHOT_H
+
+#include <stddef.h>
+
+#include "dsc_error.h"
+#include "dsc_type.h"
+
+/**
+ * @brief The version of the snapshot format written by this library.
+ */
+#define DSC_SNAPSHOT_VERSION 1
+
+/**
+ * @brief What a snapshot was saved from, and which lookups it supports.
+ */
+typedef enum DSCSnapshotKind DSCSnapshotKind;
+
+enum DSCSnapshotKind {
+    DSC_SNAPSHOT_SEQUENCE, /** A vector, stack, queue or list, in order. */
+    DSC_SNAPSHOT_SET,      /** A set, with a key index. */
+    DSC_SNAPSHOT_MAP       /** A map, with a key index and a value column. */
+};
+
+/**
+ * @brief A description of the contents of a snapshot.
+ */
+typedef struct DSCSnapshotInfo DSCSnapshotInfo;
+
+struct DSCSnapshotInfo {
+    DSCSnapshotKind kind; /** What the snapshot was saved from. */
+    DSCType key_type;     /** The type of the elements or keys. */
+    DSCType value_type;   /** The type of the values, DSC_TYPE_UNKNOWN
+                              unless kind is DSC_SNAPSHOT_MAP. */
+    size_t key_size;      /** The size of a DSC_TYPE_BYTES key. */
+    size_t value_size;    /** The size of a DSC_TYPE_BYTES value. */
+    size_t count;         /** The number of elements or entries. */
+};
+
+/**
+ * @brief A snapshot file mapped into memory.
+ */
+typedef struct DSCSnapshot DSCSnapshot;
+
+/**
+ * @brief Map a snapshot file read-only.
+ *
+ * Only the header is read; the layout is checked against the file size, and
+ * string offsets and index entries are checked as they are used.
+ *
+ * @param snapshot Pointer to store the new snapshot in.
+ * @param path The file to map.
+ * @return DSC_ERROR_OK, DSC_ERROR_IO if the file cannot be opened or mapped,
+ *         or DSC_ERROR_INVALID_FORMAT if it is not a snapshot this library
+ *         can read.
+ */
+DSCError dsc_snapshot_open(DSCSnapshot **snapshot, const char *path);
+
+/**
+ * @brief Unmap a snapshot.
+ */
+DSCError dsc_snapshot_close(DSCSnapshot *snapshot);
+
+/**
+ * @brief Describe a snapshot.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param info Set to what the snapshot holds.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_snapshot_info(const DSCSnapshot *snapshot, DSCSnapshotInfo *info);
+
+/**
+ * @brief Read an element or entry by position.
+ *
+ * Sequences keep the order of the saved container, front to back (bottom to
+ * top for a stack); sets and maps keep their iteration order.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param index The position, below the count.
+ * @param key Set to the element or key, as dsc_element_view describes it.
+ * @param value Set to the value of a map entry, or NULL for other kinds.
+ *              May be NULL.
+ * @return DSC_ERROR_OK, DSC_ERROR_OUT_OF_RANGE, or DSC_ERROR_INVALID_FORMAT
+ *         if the entry refers outside the file.
+ */
+DSCError dsc_snapshot_at(const DSCSnapshot *snapshot, size_t index, const void **key,
+                         const void **value);
+
+/**
+ * @brief Look up a key in a set or map snapshot.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param key Pointer to the key, as for dsc_set_contains and dsc_map_get.
+ * @param index Set to the key's position, for dsc_snapshot_at.
+ * @return DSC_ERROR_OK, DSC_ERROR_NOT_FOUND, DSC_ERROR_INVALID_TYPE for a
+ *         sequence snapshot, or DSC_ERROR_INVALID_FORMAT if the index refers
+ *         outside the file.
+ */
+DSCError dsc_snapshot_find(const DSCSnapshot *snapshot, void *key, size_t *index);
+
+#endif  // DSC_SNAPSHOT_H
@@ -18,8 +18,11 @@
 #ifndef DSC_STACK_H
 #define DSC_STACK_H
 
+#include "dsc_allocator.h"
 #include "dsc_data.h"
 #include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_stats.h"
 #include "dsc_type.h"
 
 #define DSC_STACK_INITIAL_CAPACITY 16
@@ -31,15 +34,50 @@ struct DSCStack {
     size_t size;      // The number of elements currently in the stack
     size_t capacity;  // The current capacity of the stack
     DSCType type;     // The type of the elements in the stack
+    DSCElementType element; // The element stride, and the callbacks of records
+    DSCGrowthPolicy growth; // How the capacity grows and shrinks
+    DSCAllocator allocator; // Source of the stack, its buffer and strings
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
 /**
  * @brief Initialize a new stack.
  *
+ * @param stack Pointer to store the new stack in.
  * @param type The data type stored in the stack.
- * @return A pointer to the new stack, or NULL on failure.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_init(DSCStack **stack, DSCType type);
+
+/**
+ * @brief Initialize a new stack that takes all of its memory from an
+ *        allocator.
+ *
+ * @param stack Pointer to store the new stack in.
+ * @param type The data type stored in the stack.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the stack.
+ * @return DSCError code indicating success or failure.
  */
-DSCStack *dsc_stack_init(DSCType type);
+DSCError dsc_stack_init_allocator(DSCStack **stack, DSCType type,
+                                  const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new stack of fixed-size records stored inline.
+ *
+ * The stack has type DSC_TYPE_BYTES. Every element pointer passed to or
+ * returned from it points at a whole record of element->size bytes, and the
+ * records sit back to back in one contiguous buffer.
+ *
+ * @param stack A pointer to store the new stack in.
+ * @param element The record descriptor, copied into the stack.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_stack_init_bytes(DSCStack **stack, const DSCElementType *element,
+                              const DSCAllocator *allocator);
 
 /**
  * @brief Deinitialize a stack, freeing all allocated memory.
@@ -76,6 +114,27 @@ DSCError dsc_stack_capacity(const DSCStack *stack, size_t *result);
  */
 DSCError dsc_stack_empty(const DSCStack *stack, bool *result);
 
+/**
+ * @brief Release the memory the stack holds beyond its current size.
+ *
+ * @param stack Pointer to the stack.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_shrink_to_fit(DSCStack *stack);
+
+/**
+ * @brief Set how the stack grows when full and shrinks after pops.
+ *
+ * A new stack uses DSC_GROWTH_POLICY_DEFAULT. With a non-zero shrink ratio,
+ * dsc_stack_pop releases memory once the size drops far enough below the
+ * capacity, but never below DSC_STACK_INITIAL_CAPACITY.
+ *
+ * @param stack Pointer to the stack.
+ * @param policy The policy to copy into the stack.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_set_growth(DSCStack *stack, const DSCGrowthPolicy *policy);
+
 /**
  * @brief Get the element at the top of the stack.
  *
@@ -94,6 +153,20 @@ DSCError dsc_stack_top(const DSCStack *stack, void *result);
  */
 DSCError dsc_stack_push(DSCStack *stack, void *value);
 
+/**
+ * @brief Push an element onto the stack, taking ownership of it.
+ *
+ * Like dsc_stack_push, but a string is not copied: the stack adopts the
+ * char * value points to, which must have been allocated with malloc and
+ * must not be used by the caller afterwards. A record is moved in without its
+ * copy callback. On failure the caller keeps ownership.
+ *
+ * @param stack Pointer to the stack.
+ * @param value Pointer to the element data to push.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_push_move(DSCStack *stack, void *value);
+
 /**
  * @brief Pop an element from the stack.
  *
@@ -103,4 +176,42 @@ DSCError dsc_stack_push(DSCStack *stack, void *value);
  */
 DSCError dsc_stack_pop(DSCStack *stack, void *result);
 
+/**
+ * @brief Exchange the elements of two stacks in constant time.
+ *
+ * Only the buffers change hands; each stack keeps its allocator, growth
+ * policy and statistics. Swapping with an empty stack moves every element
+ * across without copying any.
+ *
+ * @param stack Pointer to the first stack.
+ * @param other Pointer to the second stack, of the same element type and
+ *              with an interchangeable allocator.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_swap(DSCStack *stack, DSCStack *other);
+
+/**
+ * @brief Save the stack to a snapshot file, bottom to top.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param stack Pointer to the stack.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_stack_save(const DSCStack *stack, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the stack.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param stack Pointer to the stack.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_stack_stats(const DSCStack *stack, DSCStats *stats);
+
 #endif  // DSC_STACK_H
@@ -0,0 +1,100 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_stats.h
+ * @brief Optional instrumentation counters of the containers.
+ *
+ * libdsc built with DSC_STATS defined (make STATS=1) counts, per container,
+ * the allocations it makes and the bytes they request, how often the buffer
+ * of a vector, stack or queue is reallocated, how often a set or map is
+ * rehashed and how long that took, and how far its lookups probe. The
+ * counters are read with the container's dsc_*_stats function.
+ *
+ * Without DSC_STATS the counters and every update of them are compiled out;
+ * the dsc_*_stats functions still exist and report a DSCStats with enabled
+ * set to false and every count zero.
+ *
+ * Counters are updated with relaxed atomics, so a sharded map may be read
+ * and written from many threads while it is instrumented.
+ */
+
+#ifndef DSC_STATS_H
+#define DSC_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsc_allocator.h"
+
+#ifdef DSC_STATS
+#include <stdatomic.h>
+#endif
+
+/**
+ * @brief The number of buckets of the probe length histogram.
+ */
+#define DSC_STATS_PROBE_BUCKETS 16
+
+/**
+ * @brief A snapshot of the counters of one container.
+ */
+typedef struct DSCStats DSCStats;
+
+struct DSCStats {
+    bool enabled;           /** Whether libdsc was built with DSC_STATS. */
+    size_t allocations;     /** Allocator calls that allocated or resized
+                                memory, besides the container's own
+                                struct. */
+    size_t allocated_bytes; /** The bytes those calls requested. */
+    size_t reallocs;        /** Reallocations of the element buffer of a
+                                vector, stack or queue. */
+    size_t rehashes;        /** Resizes of the buckets or slots of a set or
+                                map. */
+    uint64_t rehash_ns;     /** The time spent in those resizes. */
+    size_t probes[DSC_STATS_PROBE_BUCKETS]; /** Lookups and inserts of a set
+                                or map by probe length: probes[n] counts
+                                those that examined n slot groups (open
+                                addressing) or n entries (chaining). The
+                                last bucket also counts longer probes. */
+    size_t max_probe;       /** The longest probe examined so far. */
+    size_t max_chain;       /** The longest bucket chain of a chaining map,
+                                measured when the stats are read. */
+};
+
+/**
+ * @brief The counters a container keeps when built with DSC_STATS.
+ *
+ * The fields are private.
+ */
+typedef struct DSCStatsCounters DSCStatsCounters;
+
+#ifdef DSC_STATS
+struct DSCStatsCounters {
+    atomic_size_t allocations;
+    atomic_size_t allocated_bytes;
+    atomic_size_t reallocs;
+    atomic_size_t rehashes;
+    atomic_uint_least64_t rehash_ns;
+    atomic_size_t probes[DSC_STATS_PROBE_BUCKETS];
+    atomic_size_t max_probe;
+    DSCAllocator inner; // The allocator the counting one forwards to
+};
+#endif
+
+#endif // DSC_STATS_H
@@ -0,0 +1,95 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_string.h
+ * @brief Borrowed string views and string interning.
+ *
+ * A DSCStringView lets callers read a string straight out of a container
+ * without the copy the regular getters make. The view is valid until the
+ * container is next modified.
+ *
+ * A DSCStringPool stores one copy of every distinct string handed to it. Maps
+ * and sets can store their long string keys in a pool, so that equal keys
+ * share a buffer and a lookup with the pool's own pointer compares by address.
+ */
+
+#ifndef DSC_STRING_H
+#define DSC_STRING_H
+
+#include <stddef.h>
+
+#include "dsc_allocator.h"
+#include "dsc_error.h"
+
+/**
+ * @brief The initial number of buckets of a string pool.
+ */
+#define DSC_STRING_POOL_INITIAL_CAPACITY 64
+
+/**
+ * @brief A borrowed, read-only view of a string owned by a container.
+ */
+typedef struct DSCStringView DSCStringView;
+
+struct DSCStringView {
+    const char *data; /** The characters, NUL-terminated. */
+    size_t length;    /** The length without the terminator. */
+};
+
+/**
+ * @brief A pool of interned strings.
+ */
+typedef struct DSCStringPool DSCStringPool;
+
+/**
+ * @brief Create an empty string pool.
+ *
+ * @param pool A pointer to store the new pool in.
+ * @param allocator The allocator for the pool and its strings, or NULL for the
+ *                  default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_string_pool_init(DSCStringPool **pool, const DSCAllocator *allocator);
+
+/**
+ * @brief Release the pool and every string interned in it.
+ *
+ * Containers storing strings from the pool must be deinitialized first.
+ */
+DSCError dsc_string_pool_deinit(DSCStringPool *pool);
+
+/**
+ * @brief Get the pool's copy of a string, adding it if it is new.
+ *
+ * @param pool The pool to intern into.
+ * @param string The characters to intern; they need not be NUL-terminated.
+ * @param length The number of characters.
+ * @param result A pointer to store the pool's NUL-terminated copy in. It stays
+ *               valid until the pool is deinitialized, and equal strings
+ *               always yield the same pointer.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_string_pool_intern(DSCStringPool *pool, const char *string,
+                                size_t length, const char **result);
+
+/**
+ * @brief Get the number of distinct strings in the pool.
+ */
+DSCError dsc_string_pool_size(const DSCStringPool *pool, size_t *size);
+
+#endif  // DSC_STRING_H
@@ -0,0 +1,90 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_thread_pool.h
+ * @brief A fixed set of worker threads for libdsc's parallel algorithms.
+ *
+ * A DSCThreadPool is handed to the dsc_*_parallel_* functions, which split
+ * their input into contiguous chunks and run the chunks on the pool's
+ * threads. The calling thread works on chunks too, so a pool of n workers
+ * starts n - 1 threads. The threads sleep between calls.
+ *
+ * Inputs with fewer elements than the pool's cutoff are processed serially
+ * on the calling thread, where starting the workers would cost more than it
+ * saves. Passing a NULL pool always runs serially.
+ *
+ * A pool runs one parallel call at a time; calls from several threads are
+ * serialized. Callbacks of a parallel call must not start another parallel
+ * call on the same pool.
+ */
+
+#ifndef DSC_THREAD_POOL_H
+#define DSC_THREAD_POOL_H
+
+#include <stddef.h>
+
+#include "dsc_error.h"
+
+/**
+ * @brief The default number of elements below which parallel algorithms run
+ *        serially.
+ */
+#define DSC_THREAD_POOL_CUTOFF 16384
+
+/**
+ * @brief A fixed set of worker threads.
+ */
+typedef struct DSCThreadPool DSCThreadPool;
+
+/**
+ * @brief Create a pool and start its threads.
+ *
+ * @param pool Pointer to store the new pool in.
+ * @param workers The number of threads that work on a parallel call, the
+ *                calling thread included, or 0 for one per online CPU.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_thread_pool_init(DSCThreadPool **pool, size_t workers);
+
+/**
+ * @brief Stop and join the threads of a pool and release it.
+ *
+ * No parallel call may be running on the pool.
+ */
+DSCError dsc_thread_pool_deinit(DSCThreadPool *pool);
+
+/**
+ * @brief Get the number of threads that work on a parallel call.
+ *
+ * @param pool Pointer to the pool.
+ * @param workers Set to the number of workers, the calling thread included.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_thread_pool_workers(const DSCThreadPool *pool, size_t *workers);
+
+/**
+ * @brief Set the input size below which parallel algorithms run serially.
+ *
+ * @param pool Pointer to the pool.
+ * @param cutoff The smallest number of elements worth splitting; 0 splits
+ *               every input.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_thread_pool_set_cutoff(DSCThreadPool *pool, size_t cutoff);
+
+#endif  // DSC_THREAD_POOL_H
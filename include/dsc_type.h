@@ -37,6 +37,8 @@ typedef enum DSCType {
     DSC_TYPE_FLOAT,   /** Single-precision floating-point type. */
     DSC_TYPE_DOUBLE,  /** Double-precision floating-point type. */
     DSC_TYPE_STRING,  /** String type (character pointer). */
+    DSC_TYPE_BYTES,   /** Fixed-size records stored inline, described by a
+                         DSCElementType. */
     DSC_TYPE_COUNT    /** The total number of types. */
 } DSCType;
 
@@ -52,4 +54,19 @@ typedef enum DSCType {
  */
 bool dsc_type_invalid(DSCType type);
 
+/**
+ * @brief Returns the size in bytes of one element of the specified type.
+ *
+ * The dsc_size_of function gives the stride of a caller-provided array of
+ * elements of the given type, as used by the batch and range APIs. Strings
+ * are passed as character pointers, so their size is sizeof(char *).
+ * Records have no size of their own; their stride comes from the
+ * DSCElementType of the container holding them.
+ *
+ * @param type The DSCType value representing the data type.
+ * @return The size of one element, or 0 if the type is invalid or
+ *         DSC_TYPE_BYTES.
+ */
+size_t dsc_size_of(DSCType type);
+
 #endif  // DSC_TYPE_H
@@ -0,0 +1,665 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_typed.h
+ * @brief Type-specialized containers generated at compile time.
+ *
+ * The DSCType containers dispatch on the element type at run time and move
+ * elements through void pointers. The macros in this header instead expand to
+ * a struct and a family of static inline functions for one concrete element
+ * type, so that every access compiles to plain loads and stores the compiler
+ * can inline and vectorize.
+ *
+ * @code
+ * DSC_VECTOR_DEFINE(i32, int32_t)
+ * DSC_MAP_DEFINE(u64_f64, uint64_t, double, dsc_hash_u64, dsc_typed_equal)
+ *
+ * DSCVector_i32 vector;
+ * dsc_vector_i32_init(&vector, NULL);
+ * dsc_vector_i32_push_back(&vector, 42);
+ * @endcode
+ *
+ * Each macro is expanded once per element type at file scope. The generated
+ * containers are initialized in place, use a DSCAllocator and, for vectors, a
+ * DSCGrowthPolicy like their DSCType counterparts, and report errors through
+ * DSCError. Elements are copied by value; pointers stored in them, strings
+ * included, are never followed or freed.
+ */
+
+#ifndef DSC_TYPED_H
+#define DSC_TYPED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsc_allocator.h"
+#include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_utils.h"
+
+/**
+ * @brief The smallest capacity a generated vector allocates.
+ */
+#define DSC_TYPED_VECTOR_MIN_CAPACITY 16
+
+/**
+ * @brief The smallest capacity a generated map allocates.
+ *
+ * A power of two; 16 also keeps the value array behind the key array aligned
+ * for any value type.
+ */
+#define DSC_TYPED_MAP_MIN_CAPACITY 16
+
+/* Control byte states of a generated map slot. A full slot holds the top 7
+ * bits of its key's hash instead, which is never negative. */
+#define DSC_TYPED_CTRL_EMPTY   ((int8_t) -128)
+#define DSC_TYPED_CTRL_DELETED ((int8_t) -2)
+
+/**
+ * @brief Equality for keys that compare with ==.
+ */
+#define dsc_typed_equal(lhs, rhs) ((lhs) == (rhs))
+
+/**
+ * @brief Hash a NUL-terminated string key of a generated map.
+ */
+static inline uint64_t dsc_typed_hash_string(const char *key, uint64_t seed) {
+    return dsc_hash_bytes(key, strlen(key), seed);
+}
+
+/**
+ * @brief Equality for NUL-terminated string keys of a generated map.
+ */
+static inline bool dsc_typed_equal_string(const char *lhs, const char *rhs) {
+    return lhs == rhs || strcmp(lhs, rhs) == 0;
+}
+
+/**
+ * @brief Generate a vector of T named DSCVector_<name>.
+ *
+ * The elements are a contiguous T array the caller may read and write through
+ * dsc_vector_<name>_data() for as long as the vector is not resized.
+ *
+ * Generated functions, with v a DSCVector_<name> pointer:
+ * - init(v, allocator), deinit(v), clear(v)
+ * - set_growth(v, policy), reserve(v, capacity), shrink_to_fit(v)
+ * - size(v), capacity(v), empty(v), data(v)
+ * - at(v, index, T *result), set(v, index, T value)
+ * - push_back(v, T value), pop_back(v, T *result)
+ * - insert(v, index, T value), erase(v, index)
+ *
+ * @param name The suffix of the generated type and function names.
+ * @param T The element type.
+ */
+#define DSC_VECTOR_DEFINE(name, T)                                                      \
+    typedef struct DSCVector_##name DSCVector_##name;                                   \
+                                                                                        \
+    struct DSCVector_##name {                                                           \
+        T *data;                /* The elements, NULL until the first allocation */     \
+        size_t size;            /* The number of elements */                            \
+        size_t capacity;        /* The number of elements data has room for */          \
+        DSCGrowthPolicy growth; /* How the capacity grows and shrinks */                \
+        DSCAllocator allocator; /* Source of the element buffer */                      \
+    };                                                                                  \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_init(DSCVector_##name *vector,           \
+                                                    const DSCAllocator *allocator) {    \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        vector->data = NULL;                                                            \
+        vector->size = 0;                                                               \
+        vector->capacity = 0;                                                           \
+        vector->growth = DSC_GROWTH_POLICY_DEFAULT;                                     \
+        vector->allocator = *(allocator != NULL ? allocator : dsc_allocator_default()); \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_deinit(DSCVector_##name *vector) {       \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        dsc_free(&vector->allocator, vector->data);                                     \
+        vector->data = NULL;                                                            \
+        vector->size = 0;                                                               \
+        vector->capacity = 0;                                                           \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_resize(DSCVector_##name *vector,         \
+                                                      size_t new_capacity) {            \
+        if (new_capacity > SIZE_MAX / sizeof(T)) {                                      \
+            return DSC_ERROR_OUT_OF_MEMORY;                                             \
+        }                                                                               \
+                                                                                        \
+        T *new_data = dsc_realloc(&vector->allocator, vector->data,                     \
+                                  new_capacity * sizeof(T));                            \
+        if (new_data == NULL) {                                                         \
+            return DSC_ERROR_OUT_OF_MEMORY;                                             \
+        }                                                                               \
+                                                                                        \
+        vector->data = new_data;                                                        \
+        vector->capacity = new_capacity;                                                \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    /* Kept out of line so that the push fast path stays small */                       \
+    static DSCError dsc_vector_##name##_grow(DSCVector_##name *vector,                  \
+                                             size_t min_capacity) {                     \
+        if (min_capacity < DSC_TYPED_VECTOR_MIN_CAPACITY) {                             \
+            min_capacity = DSC_TYPED_VECTOR_MIN_CAPACITY;                               \
+        }                                                                               \
+                                                                                        \
+        return dsc_vector_##name##_resize(                                              \
+            vector, dsc_growth_next(&vector->growth, vector->capacity,                  \
+                                    min_capacity, sizeof(T)));                          \
+    }                                                                                   \
+                                                                                        \
+    static inline void dsc_vector_##name##_maybe_shrink(DSCVector_##name *vector) {     \
+        size_t new_capacity = dsc_growth_shrink(&vector->growth, vector->size,          \
+                                                vector->capacity,                      \
+                                                DSC_TYPED_VECTOR_MIN_CAPACITY,         \
+                                                sizeof(T));                            \
+                                                                                        \
+        /* Keeping the larger buffer is harmless if the reallocation fails */           \
+        if (new_capacity < vector->capacity) {                                          \
+            (void) dsc_vector_##name##_resize(vector, new_capacity);                   \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_set_growth(DSCVector_##name *vector,     \
+                                                          const DSCGrowthPolicy *policy) { \
+        if (vector == NULL || dsc_growth_invalid(policy)) {                             \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        vector->growth = *policy;                                                       \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_reserve(DSCVector_##name *vector,        \
+                                                       size_t capacity) {               \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (capacity <= vector->capacity) {                                             \
+            return DSC_ERROR_OK;                                                        \
+        }                                                                               \
+                                                                                        \
+        return dsc_vector_##name##_resize(                                              \
+            vector, dsc_growth_round(&vector->growth, capacity, sizeof(T)));            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_shrink_to_fit(DSCVector_##name *vector) { \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (vector->size == vector->capacity) {                                         \
+            return DSC_ERROR_OK;                                                        \
+        }                                                                               \
+                                                                                        \
+        if (vector->size == 0) {                                                        \
+            return dsc_vector_##name##_deinit(vector);                                  \
+        }                                                                               \
+                                                                                        \
+        return dsc_vector_##name##_resize(vector, vector->size);                        \
+    }                                                                                   \
+                                                                                        \
+    static inline size_t dsc_vector_##name##_size(const DSCVector_##name *vector) {     \
+        return vector->size;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline size_t dsc_vector_##name##_capacity(const DSCVector_##name *vector) { \
+        return vector->capacity;                                                        \
+    }                                                                                   \
+                                                                                        \
+    static inline bool dsc_vector_##name##_empty(const DSCVector_##name *vector) {      \
+        return vector->size == 0;                                                       \
+    }                                                                                   \
+                                                                                        \
+    static inline T *dsc_vector_##name##_data(DSCVector_##name *vector) {               \
+        return vector->data;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_at(const DSCVector_##name *vector,       \
+                                                  size_t index, T *result) {            \
+        if (vector == NULL || result == NULL) {                                         \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (index >= vector->size) {                                                    \
+            return DSC_ERROR_OUT_OF_RANGE;                                              \
+        }                                                                               \
+                                                                                        \
+        *result = vector->data[index];                                                  \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_set(DSCVector_##name *vector,            \
+                                                   size_t index, T value) {             \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (index >= vector->size) {                                                    \
+            return DSC_ERROR_OUT_OF_RANGE;                                              \
+        }                                                                               \
+                                                                                        \
+        vector->data[index] = value;                                                    \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_push_back(DSCVector_##name *vector,      \
+                                                         T value) {                     \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (vector->size == vector->capacity) {                                         \
+            DSCError error = dsc_vector_##name##_grow(vector, vector->size + 1);        \
+            if (error != DSC_ERROR_OK) {                                                \
+                return error;                                                           \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        vector->data[vector->size++] = value;                                           \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_pop_back(DSCVector_##name *vector,       \
+                                                        T *result) {                    \
+        if (vector == NULL || result == NULL) {                                         \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (vector->size == 0) {                                                        \
+            return DSC_ERROR_EMPTY_CONTAINER;                                           \
+        }                                                                               \
+                                                                                        \
+        *result = vector->data[--vector->size];                                         \
+        dsc_vector_##name##_maybe_shrink(vector);                                       \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_insert(DSCVector_##name *vector,         \
+                                                      size_t index, T value) {          \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (index > vector->size) {                                                     \
+            return DSC_ERROR_OUT_OF_RANGE;                                              \
+        }                                                                               \
+                                                                                        \
+        if (vector->size == vector->capacity) {                                         \
+            DSCError error = dsc_vector_##name##_grow(vector, vector->size + 1);        \
+            if (error != DSC_ERROR_OK) {                                                \
+                return error;                                                           \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        memmove(vector->data + index + 1, vector->data + index,                         \
+                (vector->size - index) * sizeof(T));                                    \
+        vector->data[index] = value;                                                    \
+        vector->size++;                                                                 \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_erase(DSCVector_##name *vector,          \
+                                                     size_t index) {                    \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (index >= vector->size) {                                                    \
+            return DSC_ERROR_OUT_OF_RANGE;                                              \
+        }                                                                               \
+                                                                                        \
+        memmove(vector->data + index, vector->data + index + 1,                         \
+                (vector->size - index - 1) * sizeof(T));                                \
+        vector->size--;                                                                 \
+        dsc_vector_##name##_maybe_shrink(vector);                                       \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_vector_##name##_clear(DSCVector_##name *vector) {        \
+        if (vector == NULL) {                                                           \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        vector->size = 0;                                                               \
+        dsc_vector_##name##_maybe_shrink(vector);                                       \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }
+
+/**
+ * @brief Generate a hash map from K to V named DSCMap_<name>.
+ *
+ * Keys and values live in flat arrays indexed by a control byte per slot, and
+ * collisions are resolved by linear probing; the table doubles once three
+ * quarters of its slots are used.
+ *
+ * Generated functions, with m a DSCMap_<name> pointer:
+ * - init(m, allocator), deinit(m), clear(m), reserve(m, count)
+ * - size(m), empty(m)
+ * - find(m, K key), which returns a pointer to the value or NULL; it stays
+ *   valid until the next insert, reserve or clear
+ * - get(m, K key, V *result), contains(m, K key, bool *result)
+ * - insert(m, K key, V value), erase(m, K key)
+ *
+ * @param name The suffix of the generated type and function names.
+ * @param K The key type.
+ * @param V The value type.
+ * @param hash A function or macro taking (K key, uint64_t seed) and returning
+ *             a uint64_t, for instance dsc_hash_u64 for integer keys.
+ * @param equal A function or macro taking (K lhs, K rhs) and returning
+ *              whether they are equal, for instance dsc_typed_equal.
+ */
+#define DSC_MAP_DEFINE(name, K, V, hash, equal)                                         \
+    typedef struct DSCMap_##name DSCMap_##name;                                         \
+                                                                                        \
+    struct DSCMap_##name {                                                              \
+        int8_t *ctrl;           /* One control byte per slot */                         \
+        K *keys;                /* The key slots, sharing one block with the rest */    \
+        V *values;              /* The value slots */                                   \
+        size_t size;            /* The number of entries */                             \
+        size_t capacity;        /* The number of slots, 0 or a power of two */          \
+        size_t growth_left;     /* Inserts into empty slots left before a resize */     \
+        uint64_t seed;          /* Per-map hash seed */                                 \
+        DSCAllocator allocator; /* Source of the slot block */                          \
+    };                                                                                  \
+                                                                                        \
+    static inline size_t dsc_map_##name##_max_load(size_t capacity) {                   \
+        return capacity - capacity / 4;                                                 \
+    }                                                                                   \
+                                                                                        \
+    static inline int8_t dsc_map_##name##_tag(uint64_t key_hash) {                      \
+        return (int8_t) (key_hash >> 57);                                               \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_init(DSCMap_##name *map,                    \
+                                                 const DSCAllocator *allocator) {       \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        map->ctrl = NULL;                                                               \
+        map->keys = NULL;                                                               \
+        map->values = NULL;                                                             \
+        map->size = 0;                                                                  \
+        map->capacity = 0;                                                              \
+        map->growth_left = 0;                                                           \
+        map->seed = dsc_hash_seed();                                                    \
+        map->allocator = *(allocator != NULL ? allocator : dsc_allocator_default());    \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_deinit(DSCMap_##name *map) {                \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        dsc_free(&map->allocator, map->keys);                                           \
+        map->ctrl = NULL;                                                               \
+        map->keys = NULL;                                                               \
+        map->values = NULL;                                                             \
+        map->size = 0;                                                                  \
+        map->capacity = 0;                                                              \
+        map->growth_left = 0;                                                           \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    /* Find the slot holding key, or SIZE_MAX */                                        \
+    static inline size_t dsc_map_##name##_slot(const DSCMap_##name *map, K key,         \
+                                               uint64_t key_hash) {                     \
+        if (map->size == 0) {                                                           \
+            return SIZE_MAX;                                                            \
+        }                                                                               \
+                                                                                        \
+        size_t mask = map->capacity - 1;                                                \
+        int8_t tag = dsc_map_##name##_tag(key_hash);                                    \
+                                                                                        \
+        for (size_t i = dsc_hash_index(key_hash, map->capacity);; i = (i + 1) & mask) { \
+            int8_t ctrl = map->ctrl[i];                                                 \
+            if (ctrl == DSC_TYPED_CTRL_EMPTY) {                                         \
+                return SIZE_MAX;                                                        \
+            }                                                                           \
+                                                                                        \
+            if (ctrl == tag && equal(map->keys[i], key)) {                              \
+                return i;                                                               \
+            }                                                                           \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    /* Move every entry into a fresh block of new_capacity slots */                     \
+    static DSCError dsc_map_##name##_rehash(DSCMap_##name *map, size_t new_capacity) {  \
+        size_t slot_size = sizeof(K) + sizeof(V) + 1;                                   \
+        if (new_capacity > SIZE_MAX / slot_size) {                                      \
+            return DSC_ERROR_OUT_OF_MEMORY;                                             \
+        }                                                                               \
+                                                                                        \
+        /* Keys, then values, then control bytes, so every array stays aligned */      \
+        K *keys = dsc_alloc(&map->allocator, new_capacity * slot_size);                 \
+        if (keys == NULL) {                                                             \
+            return DSC_ERROR_OUT_OF_MEMORY;                                             \
+        }                                                                               \
+                                                                                        \
+        V *values = (V *) (void *) (keys + new_capacity);                               \
+        int8_t *ctrl = (int8_t *) (void *) (values + new_capacity);                     \
+        memset(ctrl, DSC_TYPED_CTRL_EMPTY, new_capacity);                               \
+                                                                                        \
+        size_t mask = new_capacity - 1;                                                 \
+        for (size_t slot = 0; slot < map->capacity; ++slot) {                           \
+            if (map->ctrl[slot] < 0) {                                                  \
+                continue;                                                               \
+            }                                                                           \
+                                                                                        \
+            uint64_t key_hash = hash(map->keys[slot], map->seed);                       \
+            size_t i = dsc_hash_index(key_hash, new_capacity);                          \
+            while (ctrl[i] != DSC_TYPED_CTRL_EMPTY) {                                   \
+                i = (i + 1) & mask;                                                     \
+            }                                                                           \
+                                                                                        \
+            ctrl[i] = map->ctrl[slot];                                                  \
+            keys[i] = map->keys[slot];                                                  \
+            values[i] = map->values[slot];                                              \
+        }                                                                               \
+                                                                                        \
+        dsc_free(&map->allocator, map->keys);                                           \
+                                                                                        \
+        map->ctrl = ctrl;                                                               \
+        map->keys = keys;                                                               \
+        map->values = values;                                                           \
+        map->capacity = new_capacity;                                                   \
+        map->growth_left = dsc_map_##name##_max_load(new_capacity) - map->size;         \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_reserve(DSCMap_##name *map, size_t count) { \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        size_t capacity = DSC_TYPED_MAP_MIN_CAPACITY;                                   \
+        while (dsc_map_##name##_max_load(capacity) < count) {                           \
+            if (capacity > SIZE_MAX / 2) {                                              \
+                return DSC_ERROR_OUT_OF_MEMORY;                                         \
+            }                                                                           \
+            capacity *= 2;                                                              \
+        }                                                                               \
+                                                                                        \
+        if (capacity <= map->capacity) {                                                \
+            return DSC_ERROR_OK;                                                        \
+        }                                                                               \
+                                                                                        \
+        return dsc_map_##name##_rehash(map, capacity);                                  \
+    }                                                                                   \
+                                                                                        \
+    static inline size_t dsc_map_##name##_size(const DSCMap_##name *map) {              \
+        return map->size;                                                               \
+    }                                                                                   \
+                                                                                        \
+    static inline bool dsc_map_##name##_empty(const DSCMap_##name *map) {               \
+        return map->size == 0;                                                          \
+    }                                                                                   \
+                                                                                        \
+    static inline V *dsc_map_##name##_find(const DSCMap_##name *map, K key) {           \
+        size_t slot = dsc_map_##name##_slot(map, key, hash(key, map->seed));            \
+                                                                                        \
+        return slot != SIZE_MAX ? &map->values[slot] : NULL;                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_get(const DSCMap_##name *map, K key,        \
+                                                V *result) {                            \
+        if (map == NULL || result == NULL) {                                            \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        V *value = dsc_map_##name##_find(map, key);                                     \
+        if (value == NULL) {                                                            \
+            return DSC_ERROR_NOT_FOUND;                                                 \
+        }                                                                               \
+                                                                                        \
+        *result = *value;                                                               \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_contains(const DSCMap_##name *map, K key,   \
+                                                     bool *result) {                    \
+        if (map == NULL || result == NULL) {                                            \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        *result = dsc_map_##name##_find(map, key) != NULL;                              \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_insert(DSCMap_##name *map, K key,           \
+                                                   V value) {                           \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        uint64_t key_hash = hash(key, map->seed);                                       \
+        if (dsc_map_##name##_slot(map, key, key_hash) != SIZE_MAX) {                    \
+            return DSC_ERROR_ALREADY_EXISTS;                                            \
+        }                                                                               \
+                                                                                        \
+        size_t mask = map->capacity - 1;                                                \
+        size_t i = map->capacity > 0 ? dsc_hash_index(key_hash, map->capacity) : 0;     \
+                                                                                        \
+        /* Reuse the first tombstone on the probe path if there is one */              \
+        if (map->capacity > 0) {                                                        \
+            while (map->ctrl[i] >= 0) {                                                 \
+                i = (i + 1) & mask;                                                     \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        if (map->capacity == 0 ||                                                       \
+            (map->ctrl[i] == DSC_TYPED_CTRL_EMPTY && map->growth_left == 0)) {          \
+            /* Double when genuinely full, otherwise just drop the tombstones */       \
+            size_t new_capacity = map->capacity == 0 ? DSC_TYPED_MAP_MIN_CAPACITY       \
+                                : map->size >= map->capacity / 2 ? map->capacity * 2   \
+                                : map->capacity;                                        \
+                                                                                        \
+            DSCError error = dsc_map_##name##_rehash(map, new_capacity);                \
+            if (error != DSC_ERROR_OK) {                                                \
+                return error;                                                           \
+            }                                                                           \
+                                                                                        \
+            mask = map->capacity - 1;                                                   \
+            i = dsc_hash_index(key_hash, map->capacity);                                \
+            while (map->ctrl[i] >= 0) {                                                 \
+                i = (i + 1) & mask;                                                     \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        if (map->ctrl[i] == DSC_TYPED_CTRL_EMPTY) {                                     \
+            map->growth_left--;                                                         \
+        }                                                                               \
+                                                                                        \
+        map->ctrl[i] = dsc_map_##name##_tag(key_hash);                                  \
+        map->keys[i] = key;                                                             \
+        map->values[i] = value;                                                         \
+        map->size++;                                                                    \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_erase(DSCMap_##name *map, K key) {          \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        size_t slot = dsc_map_##name##_slot(map, key, hash(key, map->seed));            \
+        if (slot == SIZE_MAX) {                                                         \
+            return DSC_ERROR_NOT_FOUND;                                                 \
+        }                                                                               \
+                                                                                        \
+        /* No probe sequence runs past a slot followed by an empty one, so it can */   \
+        /* become empty again instead of leaving a tombstone */                        \
+        if (map->ctrl[(slot + 1) & (map->capacity - 1)] == DSC_TYPED_CTRL_EMPTY) {      \
+            map->ctrl[slot] = DSC_TYPED_CTRL_EMPTY;                                     \
+            map->growth_left++;                                                         \
+        } else {                                                                        \
+            map->ctrl[slot] = DSC_TYPED_CTRL_DELETED;                                   \
+        }                                                                               \
+                                                                                        \
+        map->size--;                                                                    \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }                                                                                   \
+                                                                                        \
+    static inline DSCError dsc_map_##name##_clear(DSCMap_##name *map) {                 \
+        if (map == NULL) {                                                              \
+            return DSC_ERROR_INVALID_ARGUMENT;                                          \
+        }                                                                               \
+                                                                                        \
+        if (map->capacity > 0) {                                                        \
+            memset(map->ctrl, DSC_TYPED_CTRL_EMPTY, map->capacity);                     \
+        }                                                                               \
+                                                                                        \
+        map->size = 0;                                                                  \
+        map->growth_left = dsc_map_##name##_max_load(map->capacity);                    \
+                                                                                        \
+        return DSC_ERROR_OK;                                                            \
+    }
+
+#endif  // DSC_TYPED_H
@@ -15,6 +15,11 @@
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
 
+/**
+ * @file dsc_utils.h
+ * @brief Hashing and layout utilities shared by the containers.
+ */
+
 #ifndef DSC_UTILS
 #define DSC_UTILS
 
@@ -24,6 +29,70 @@
 #include "dsc_error.h"
 #include "dsc_type.h"
 
-uint32_t dsc_hash(void *key, DSCType key_type, size_t capacity);
+/**
+ * @brief The assumed size of a cache line. Fields written by different
+ *        threads are kept at least this far apart.
+ */
+#define DSC_CACHE_LINE 64
+
+/**
+ * @brief Hash an arbitrary byte buffer.
+ *
+ * Uses a wyhash-style construction that consumes the input eight bytes at a
+ * time and folds it through 64x64->128 bit multiplies.
+ *
+ * @param data The bytes to hash.
+ * @param size The number of bytes.
+ * @param seed The seed; different seeds give independent hash functions.
+ * @return A 64-bit hash value.
+ */
+uint64_t dsc_hash_bytes(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief Hash a 64-bit integer, mixing every input bit into every output bit.
+ *
+ * @param value The integer to hash.
+ * @param seed The seed.
+ * @return A 64-bit hash value.
+ */
+uint64_t dsc_hash_u64(uint64_t value, uint64_t seed);
+
+/**
+ * @brief Hash an element of the given type.
+ *
+ * For DSC_TYPE_STRING `key` is the string itself; for every other type it
+ * points at the value. Floating-point zeros hash the same regardless of sign,
+ * matching how they compare.
+ *
+ * @param key The element to hash.
+ * @param key_type The type of the element.
+ * @param seed The seed, usually obtained from dsc_hash_seed().
+ * @return A 64-bit hash value, or 0 for an invalid type.
+ */
+uint64_t dsc_hash(const void *key, DSCType key_type, uint64_t seed);
+
+/**
+ * @brief Produce a fresh random seed for a container.
+ *
+ * Seeding every container differently keeps an attacker who can pick keys
+ * from forcing them all onto the same probe sequence. The seed comes from the
+ * operating system's entropy source (getrandom, getentropy or /dev/urandom);
+ * only if none of those is available is it derived from a counter, the clock
+ * and a stack address.
+ *
+ * @return A 64-bit seed.
+ */
+uint64_t dsc_hash_seed(void);
+
+/**
+ * @brief Reduce a hash to a slot index in a power-of-two sized table.
+ *
+ * @param hash The hash value.
+ * @param capacity The table capacity, which must be a power of two.
+ * @return The slot index.
+ */
+static inline size_t dsc_hash_index(uint64_t hash, size_t capacity) {
+    return (size_t) hash & (capacity - 1);
+}
 
 #endif  // DSC_UTILS
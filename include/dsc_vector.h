@@ -23,9 +23,14 @@
 #ifndef DSC_VECTOR_H
 #define DSC_VECTOR_H
 
+#include "dsc_allocator.h"
 #include "dsc_data.h"
+#include "dsc_string.h"
 #include "dsc_type.h"
 #include "dsc_error.h"
+#include "dsc_growth.h"
+#include "dsc_stats.h"
+#include "dsc_thread_pool.h"
 
 /**
  * @brief A dynamic array of elements.
@@ -43,11 +48,39 @@ typedef struct DSCVector DSCVector;
 /**
  * @brief Initialize a new vector with the given element type.
  *
- * @param vector The vector to initialize.
+ * @param vector A pointer to store the new vector in.
  * @param type The type of elements the vector will contain.
  * @return DSC_ERROR_OK on success, an error code otherwise.
  */
-DSCError dsc_vector_init(DSCVector *vector, DSCType type);
+DSCError dsc_vector_init(DSCVector **vector, DSCType type);
+
+/**
+ * @brief Initialize a new vector that takes all of its memory from an
+ *        allocator.
+ *
+ * @param vector A pointer to store the new vector in.
+ * @param type The type of elements the vector will contain.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the vector.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_init_allocator(DSCVector **vector, DSCType type,
+                                   const DSCAllocator *allocator);
+
+/**
+ * @brief Initialize a new vector of fixed-size records stored inline.
+ *
+ * The vector has type DSC_TYPE_BYTES. Every element pointer passed to or
+ * returned from it points at a whole record of element->size bytes, and the
+ * records sit back to back in one contiguous buffer.
+ *
+ * @param vector A pointer to store the new vector in.
+ * @param element The record descriptor, copied into the vector.
+ * @param allocator The allocator to use, or NULL for the default.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_init_bytes(DSCVector **vector, const DSCElementType *element,
+                               const DSCAllocator *allocator);
 
 /**
  * @brief Deinitialize a vector, freeing all allocated memory.
@@ -100,12 +133,45 @@ DSCError dsc_vector_empty(const DSCVector *vector, bool *result);
  * will be truncated and elements will be lost.
  *
  * @param vector The vector to resize.
- * @param new_capacity The new capacity for the vector. Must be greater than
- *                     the current size.
+ * @param new_capacity The new capacity for the vector.
  * @return DSC_ERROR_OK on success, an error code otherwise.
  */
 DSCError dsc_vector_resize(DSCVector *vector, size_t new_capacity);
 
+/**
+ * @brief Make sure the vector can hold at least the given number of elements.
+ *
+ * Unlike dsc_vector_resize, this function never shrinks the vector, so it is
+ * safe to call before a series of insertions to avoid repeated reallocation.
+ *
+ * @param vector The vector to reserve memory for.
+ * @param capacity The minimum capacity the vector should have.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_reserve(DSCVector *vector, size_t capacity);
+
+/**
+ * @brief Release the memory the vector holds beyond its current size.
+ *
+ * @param vector The vector to shrink.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_shrink_to_fit(DSCVector *vector);
+
+/**
+ * @brief Set how the vector grows when full and shrinks after removals.
+ *
+ * A new vector uses DSC_GROWTH_POLICY_DEFAULT. With a non-zero shrink ratio,
+ * dsc_vector_pop_back, dsc_vector_erase and dsc_vector_erase_if release memory once the size drops
+ * far enough below the capacity; the vector never shrinks below
+ * DSC_VECTOR_INITIAL_CAPACITY this way.
+ *
+ * @param vector The vector to configure.
+ * @param policy The policy to copy into the vector.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_set_growth(DSCVector *vector, const DSCGrowthPolicy *policy);
+
 /**
  * @brief Get the element at the given index.
  *
@@ -120,6 +186,18 @@ DSCError dsc_vector_resize(DSCVector *vector, size_t new_capacity);
  */
 DSCError dsc_vector_at(const DSCVector *vector, size_t index, void *result);
 
+/**
+ * @brief Borrow the string at the specified index without copying it.
+ *
+ * The view is valid until the vector is next modified.
+ *
+ * @param vector Pointer to the vector, whose elements must be DSC_TYPE_STRING.
+ * @param index The index of the element.
+ * @param result Pointer to store the view in.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_at_view(const DSCVector *vector, size_t index, DSCStringView *result);
+
 /**
  * @brief Get the first element in the vector.
  *
@@ -147,7 +225,7 @@ DSCError dsc_vector_back(const DSCVector *vector, void *result);
  *
  * This function appends the given element to the end of the vector,
  * increasing its size by 1. If the new size exceeds the vector's current
- * capacity, the vector will be automatically resized.
+ * capacity, the vector will be automatically resized by its growth factor.
  *
  * @param vector The vector to modify.
  * @param data A pointer to the element to add.
@@ -155,6 +233,36 @@ DSCError dsc_vector_back(const DSCVector *vector, void *result);
  */
 DSCError dsc_vector_push_back(DSCVector *vector, void *data);
 
+/**
+ * @brief Add an element to the end of the vector, taking ownership of it.
+ *
+ * Like dsc_vector_push_back, but a string is not copied: the vector adopts
+ * data, which must have been allocated with malloc and must not be used by
+ * the caller afterwards. A record is moved in without its copy callback.
+ * Other types are copied as usual. On failure the caller keeps ownership.
+ *
+ * @param vector The vector to modify.
+ * @param data A pointer to the element to add.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_push_back_move(DSCVector *vector, void *data);
+
+/**
+ * @brief Add a contiguous array of elements to the end of the vector.
+ *
+ * The vector is resized at most once for the whole range. Primitive elements
+ * and records without a copy callback are copied with a single memcpy;
+ * strings and other records are copied one by one.
+ *
+ * @param vector The vector to modify.
+ * @param data A pointer to the first of count elements (an array of char *
+ *             for a string vector).
+ * @param count The number of elements to add.
+ * @return DSC_ERROR_OK on success, an error code otherwise. On failure the
+ *         vector is left unchanged.
+ */
+DSCError dsc_vector_append_range(DSCVector *vector, void *data, size_t count);
+
 /**
  * @brief Remove the last element from the vector and return it.
  *
@@ -196,6 +304,35 @@ DSCError dsc_vector_insert(DSCVector *vector, void *data, size_t index);
  */
 DSCError dsc_vector_erase(DSCVector *vector, size_t index);
 
+/**
+ * @brief Erase every element a predicate matches.
+ *
+ * The kept elements are compacted in a single pass and stay in order, so
+ * removing any number of elements costs one walk over the vector.
+ *
+ * @param vector The vector to modify.
+ * @param predicate Called once per element, front to back.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of elements erased, may be NULL.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_erase_if(DSCVector *vector, DSCPredicate predicate, void *context,
+                             size_t *removed);
+
+/**
+ * @brief Keep only the elements a predicate matches.
+ *
+ * The complement of dsc_vector_erase_if.
+ *
+ * @param vector The vector to modify.
+ * @param predicate Called once per element, front to back.
+ * @param context Passed to every call of the predicate.
+ * @param removed Set to the number of elements erased, may be NULL.
+ * @return DSC_ERROR_OK on success, an error code otherwise.
+ */
+DSCError dsc_vector_retain(DSCVector *vector, DSCPredicate predicate, void *context,
+                           size_t *removed);
+
 /**
  * @brief Remove all elements from the vector.
  *
@@ -207,4 +344,284 @@ DSCError dsc_vector_erase(DSCVector *vector, size_t index);
  */
 DSCError dsc_vector_clear(DSCVector *vector);
 
+/**
+ * @brief Exchange the elements of two vectors in constant time.
+ *
+ * Only the buffers change hands; each vector keeps its allocator, growth
+ * policy and statistics. Swapping with an empty vector moves every element
+ * across without copying any.
+ *
+ * @param vector The first vector.
+ * @param other The second vector, of the same element type and with an
+ *              interchangeable allocator.
+ * @return DSC_ERROR_OK on success, DSC_ERROR_INVALID_ARGUMENT if the element
+ *         types or allocators differ.
+ */
+DSCError dsc_vector_swap(DSCVector *vector, DSCVector *other);
+
+/**
+ * @brief A position in a vector, for walking its elements front to back.
+ *
+ * A cursor is a plain value set up with dsc_vector_cursor_init and advanced
+ * with dsc_vector_cursor_next; walking the whole vector is one linear pass that
+ * copies nothing. Modifying the vector invalidates the element pointers already yielded, not the cursor. The fields are private.
+ */
+typedef struct DSCVectorCursor DSCVectorCursor;
+
+struct DSCVectorCursor {
+    const DSCVector *vector; /** The vector being walked. */
+    size_t index;            /** The index of the next element. */
+};
+
+/**
+ * @brief Start a cursor at the first element of a vector.
+ *
+ * @param vector Pointer to the vector.
+ * @param cursor Pointer to the cursor to initialize.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_cursor_init(const DSCVector *vector, DSCVectorCursor *cursor);
+
+/**
+ * @brief Step a cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param element Set to the element in the vector's own storage, as
+ *                dsc_element_view describes it.
+ * @return true if there was an element, false once the cursor is past the
+ *         last one.
+ */
+bool dsc_vector_cursor_next(DSCVectorCursor *cursor, const void **element);
+
+/**
+ * @brief Call a visitor on every element, front to back.
+ *
+ * The visitor must not modify the vector.
+ *
+ * @param vector Pointer to the vector.
+ * @param visitor Called with each element; returning false ends the walk.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_for_each(const DSCVector *vector, DSCVisitor visitor, void *context);
+
+/* Numeric algorithms. These run directly on the buffer of DSC_TYPE_INT,
+ * DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE vectors with SIMD kernels chosen for the
+ * CPU at run time, and fail with DSC_ERROR_INVALID_TYPE on any other type.
+ * Floating-point elements compare as numbers: 0.0 equals -0.0, and a NaN
+ * equals nothing and makes min and max unspecified. */
+
+/**
+ * @brief Find the first element equal to a value.
+ *
+ * @param vector Pointer to the vector.
+ * @param value Pointer to the value to look for, of the vector's type.
+ * @param index Set to the index of the first match.
+ * @return DSC_ERROR_OK, or DSC_ERROR_NOT_FOUND if no element matches.
+ */
+DSCError dsc_vector_find(const DSCVector *vector, void *value, size_t *index);
+
+/**
+ * @brief Count the elements equal to a value.
+ *
+ * @param vector Pointer to the vector.
+ * @param value Pointer to the value to count, of the vector's type.
+ * @param count Set to the number of matches.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_count(const DSCVector *vector, void *value, size_t *count);
+
+/**
+ * @brief Get the smallest element.
+ *
+ * @param vector Pointer to the vector.
+ * @param result Set to the smallest element, of the vector's type.
+ * @return DSC_ERROR_OK, or DSC_ERROR_EMPTY_CONTAINER if the vector is empty.
+ */
+DSCError dsc_vector_min(const DSCVector *vector, void *result);
+
+/**
+ * @brief Get the largest element.
+ *
+ * @param vector Pointer to the vector.
+ * @param result Set to the largest element, of the vector's type.
+ * @return DSC_ERROR_OK, or DSC_ERROR_EMPTY_CONTAINER if the vector is empty.
+ */
+DSCError dsc_vector_max(const DSCVector *vector, void *result);
+
+/**
+ * @brief Add up the elements.
+ *
+ * The elements are added in interleaved lanes rather than one by one, so a
+ * floating-point sum may differ from a sequential loop in the last bits. It
+ * is the same on every CPU.
+ *
+ * @param vector Pointer to the vector.
+ * @param result Set to the sum: an int64_t for DSC_TYPE_INT vectors, a
+ *               double for DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE ones. An empty
+ *               vector sums to 0.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_sum(const DSCVector *vector, void *result);
+
+/* Ordering. Elements are ordered as dsc_compare orders them: numbers by
+ * value with NaNs after every number, strings by strcmp and DSC_TYPE_BYTES
+ * records by the element descriptor's compare callback, or memcmp without
+ * one. Sorting is not stable. */
+
+/**
+ * @brief Sort the elements in ascending order.
+ *
+ * DSC_TYPE_INT, DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE vectors are radix sorted
+ * with a scratch buffer from the vector's allocator once they are large
+ * enough, and fall back to the in-place sort if it cannot be allocated. Other
+ * vectors are sorted in place in O(n log n) worst-case time.
+ *
+ * @param vector Pointer to the vector.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_sort(DSCVector *vector);
+
+/**
+ * @brief Sort the smallest elements into the front of the vector.
+ *
+ * Afterwards the first count elements are the smallest ones of the vector in
+ * ascending order; the rest follow in unspecified order.
+ *
+ * @param vector Pointer to the vector.
+ * @param count The number of elements to sort into place.
+ * @return DSC_ERROR_OK, or DSC_ERROR_OUT_OF_RANGE if count exceeds the size.
+ */
+DSCError dsc_vector_partial_sort(DSCVector *vector, size_t count);
+
+/**
+ * @brief Move the element that belongs at an index in sorted order there.
+ *
+ * Afterwards no element before the index is greater than it and no element
+ * after it is less. Runs in expected linear time.
+ *
+ * @param vector Pointer to the vector.
+ * @param index The index to fill.
+ * @return DSC_ERROR_OK, or DSC_ERROR_OUT_OF_RANGE if the index is out of
+ *         bounds.
+ */
+DSCError dsc_vector_nth_element(DSCVector *vector, size_t index);
+
+/**
+ * @brief Find the first element of a sorted vector not less than a value.
+ *
+ * @param vector Pointer to the vector, sorted in ascending order.
+ * @param value Pointer to the value, as for dsc_vector_push_back.
+ * @param index Set to the index of that element, or the size if every element
+ *              is less than the value.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_lower_bound(const DSCVector *vector, void *value, size_t *index);
+
+/**
+ * @brief Find the first element of a sorted vector greater than a value.
+ *
+ * @param vector Pointer to the vector, sorted in ascending order.
+ * @param value Pointer to the value, as for dsc_vector_push_back.
+ * @param index Set to the index of that element, or the size if no element
+ *              is greater than the value.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_upper_bound(const DSCVector *vector, void *value, size_t *index);
+
+/* Parallel algorithms. These split the vector into contiguous chunks and
+ * run them on a DSCThreadPool; vectors below the pool's cutoff, or a NULL
+ * pool, are processed serially on the calling thread. The vector must not
+ * be modified by anyone while they run. */
+
+/**
+ * @brief Sort the elements in ascending order on a thread pool.
+ *
+ * Orders elements as dsc_vector_sort does. Elements are sample sorted into
+ * one value range per chunk and the ranges are sorted in parallel, with
+ * scratch buffers from the vector's allocator; if they cannot be allocated
+ * the vector is sorted serially.
+ *
+ * @param vector Pointer to the vector.
+ * @param pool The pool to sort on, or NULL.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_parallel_sort(DSCVector *vector, DSCThreadPool *pool);
+
+/**
+ * @brief Call a visitor on every element from the threads of a pool.
+ *
+ * Elements are visited concurrently and in no particular order, so the
+ * visitor must be safe to call from several threads at once. Returning false
+ * stops the walk early, though elements already taken up by other threads
+ * may still be visited.
+ *
+ * @param vector Pointer to the vector.
+ * @param pool The pool to run on, or NULL.
+ * @param visitor Called with each element, as dsc_element_view describes it.
+ * @param context Passed to every call of the visitor.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_parallel_for_each(const DSCVector *vector, DSCThreadPool *pool,
+                                      DSCVisitor visitor, void *context);
+
+/**
+ * @brief Fold every element into one result on a thread pool.
+ *
+ * Each chunk is reduced into its own copy of the initial result, and the
+ * chunk results are then combined into the result in chunk order. The
+ * initial result must therefore be an identity of the combination, and the
+ * reduction must be associative; it need not be commutative.
+ *
+ * @param vector Pointer to the vector.
+ * @param pool The pool to run on, or NULL.
+ * @param reduce Folds one element into a chunk's result.
+ * @param combine Folds a chunk's result into the final one.
+ * @param context Passed to every call of reduce and combine.
+ * @param result The initial result on entry, the final one on return.
+ * @param size The size of the result in bytes.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_parallel_reduce(const DSCVector *vector, DSCThreadPool *pool,
+                                    DSCReducer reduce, DSCCombiner combine, void *context,
+                                    void *result, size_t size);
+
+/**
+ * @brief Get the vector's buffer.
+ *
+ * The buffer holds the elements back to back, char * entries for strings, as
+ * the bulk functions of the other containers such as
+ * dsc_map_parallel_insert_range take them. It is valid until the vector is
+ * next modified.
+ *
+ * @param vector Pointer to the vector.
+ * @param data Set to the first element.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_data(const DSCVector *vector, void **data);
+
+/**
+ * @brief Save the vector to a snapshot file, front to back.
+ *
+ * The file is replaced. Open it with dsc_snapshot_open.
+ *
+ * @param vector Pointer to the vector.
+ * @param path The file to write.
+ * @return DSCError code indicating success or failure: DSC_ERROR_IO if the
+ *         file cannot be written.
+ */
+DSCError dsc_vector_save(const DSCVector *vector, const char *path);
+
+/**
+ * @brief Read the instrumentation counters of the vector.
+ *
+ * Without DSC_STATS the result reports enabled as false and every count as
+ * zero.
+ *
+ * @param vector Pointer to the vector.
+ * @param stats Set to the counters.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_vector_stats(const DSCVector *vector, DSCStats *stats);
+
 #endif // DSC_VECTOR_H
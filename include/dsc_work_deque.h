@@ -0,0 +1,135 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_work_deque.h
+ * @brief A growable work-stealing deque for task schedulers.
+ *
+ * DSCWorkDeque is the Chase-Lev deque: one owner thread pushes and pops at
+ * the bottom, as it would with a DSCStack, while any number of thief threads
+ * steal the oldest elements from the top. The owner's push is a plain store
+ * followed by a release store of the bottom index, and its pop only needs a
+ * compare-and-swap when it races a thief for the last element. Thieves take
+ * one compare-and-swap on the top index each.
+ *
+ * The slots form a circular array that the owner doubles when it fills up.
+ * Thieves may still be reading an outgrown array, so it is kept until the
+ * deque is deinitialized; together the old arrays never exceed the current
+ * one in size.
+ *
+ * Elements follow the DSCType model of the other containers, except that
+ * DSC_TYPE_BYTES records are not supported: a thief reads its slot before it
+ * knows whether it won the element, which is only safe for elements that fit
+ * in one atomic word. Push a pointer to the record instead. Strings are
+ * copied with malloc on push and handed over on pop or steal.
+ *
+ * The allocator is only called by the owner and by deinit, so it need not be
+ * thread-safe.
+ */
+
+#ifndef DSC_WORK_DEQUE_H
+#define DSC_WORK_DEQUE_H
+
+#include "dsc_allocator.h"
+#include "dsc_error.h"
+#include "dsc_type.h"
+#include "dsc_utils.h"
+
+/**
+ * @brief The number of slots a deque starts with when none is specified.
+ */
+#define DSC_WORK_DEQUE_INITIAL_CAPACITY 64
+
+/**
+ * @brief A work-stealing deque with one owner and any number of thieves.
+ */
+typedef struct DSCWorkDeque DSCWorkDeque;
+
+/**
+ * @brief Initialize a new work-stealing deque.
+ *
+ * @param deque Pointer to store the new deque in.
+ * @param type The data type stored in the deque.
+ * @param capacity The initial number of slots, rounded up to a power of two,
+ *                 or 0 for DSC_WORK_DEQUE_INITIAL_CAPACITY.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_work_deque_init(DSCWorkDeque **deque, DSCType type, size_t capacity);
+
+/**
+ * @brief Initialize a new work-stealing deque whose slots come from an
+ *        allocator.
+ *
+ * @param deque Pointer to store the new deque in.
+ * @param type The data type stored in the deque.
+ * @param capacity The initial number of slots, rounded up to a power of two,
+ *                 or 0 for DSC_WORK_DEQUE_INITIAL_CAPACITY.
+ * @param allocator The allocator to use, or NULL for the default. It is
+ *                  copied, but its context must outlive the deque.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_work_deque_init_allocator(DSCWorkDeque **deque, DSCType type,
+                                       size_t capacity,
+                                       const DSCAllocator *allocator);
+
+/**
+ * @brief Deinitialize a deque, releasing the elements still in it.
+ *
+ * No other thread may be using the deque.
+ */
+DSCError dsc_work_deque_deinit(DSCWorkDeque *deque);
+
+/**
+ * @brief Get the number of slots the deque currently has.
+ *
+ * Owner only.
+ */
+DSCError dsc_work_deque_capacity(const DSCWorkDeque *deque, size_t *result);
+
+/**
+ * @brief Get the number of elements in the deque.
+ *
+ * Exact when no thief is active, a snapshot otherwise.
+ */
+DSCError dsc_work_deque_size(const DSCWorkDeque *deque, size_t *result);
+
+/**
+ * @brief Push an element onto the bottom. Owner only.
+ *
+ * @return DSC_ERROR_OK, or DSC_ERROR_OUT_OF_MEMORY if the slots could not
+ *         grow or a string could not be copied.
+ */
+DSCError dsc_work_deque_push(DSCWorkDeque *deque, void *value);
+
+/**
+ * @brief Pop the newest element from the bottom. Owner only.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_EMPTY_CONTAINER.
+ */
+DSCError dsc_work_deque_pop(DSCWorkDeque *deque, void *result);
+
+/**
+ * @brief Steal the oldest element from the top, from any thread.
+ *
+ * A steal that loses the race for an element to another thief or to the
+ * owner retries, so the call only fails when the deque is empty.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_EMPTY_CONTAINER.
+ */
+DSCError dsc_work_deque_steal(DSCWorkDeque *deque, void *result);
+
+#endif  // DSC_WORK_DEQUE_H
@@ -22,7 +22,19 @@
 #include "dsc_list.h"
 #include "dsc_stack.h"
 #include "dsc_queue.h"
+#include "dsc_deque.h"
+#include "dsc_priority_queue.h"
+#include "dsc_ring.h"
+#include "dsc_work_deque.h"
+#include "dsc_bitset.h"
+#include "dsc_bloom.h"
 #include "dsc_set.h"
 #include "dsc_map.h"
+#include "dsc_ordered_set.h"
+#include "dsc_ordered_map.h"
+#include "dsc_typed.h"
+#include "dsc_thread_pool.h"
+#include "dsc_snapshot.h"
+#include "dsc_stats.h"
 
 #endif // LIBDSC_H
@@ -0,0 +1,444 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_allocator.h"
+#include "dsc_stats_counters.h"
+
+/* Default allocator */
+
+static void *dsc_malloc_alloc(void *context, size_t size) {
+    (void) context;
+    return malloc(size);
+}
+
+static void *dsc_malloc_realloc(void *context, void *ptr, size_t size) {
+    (void) context;
+    return realloc(ptr, size);
+}
+
+static void dsc_malloc_free(void *context, void *ptr) {
+    (void) context;
+    free(ptr);
+}
+
+static const DSCAllocator dsc_malloc_allocator = {
+    dsc_malloc_alloc,
+    dsc_malloc_realloc,
+    dsc_malloc_free,
+    NULL,
+};
+
+const DSCAllocator *dsc_allocator_default(void) {
+    return &dsc_malloc_allocator;
+}
+
+static inline const DSCAllocator *dsc_allocator_or_default(const DSCAllocator *allocator) {
+    return allocator != NULL ? allocator : &dsc_malloc_allocator;
+}
+
+void *dsc_alloc(const DSCAllocator *allocator, size_t size) {
+    allocator = dsc_allocator_or_default(allocator);
+    return allocator->alloc(allocator->context, size);
+}
+
+void *dsc_calloc(const DSCAllocator *allocator, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void *ptr = dsc_alloc(allocator, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+
+    return ptr;
+}
+
+void *dsc_realloc(const DSCAllocator *allocator, void *ptr, size_t size) {
+    allocator = dsc_allocator_or_default(allocator);
+    return allocator->realloc(allocator->context, ptr, size);
+}
+
+void dsc_free(const DSCAllocator *allocator, void *ptr) {
+    allocator = dsc_allocator_or_default(allocator);
+    if (allocator->free != NULL && ptr != NULL) {
+        allocator->free(allocator->context, ptr);
+    }
+}
+
+char *dsc_strdup(const DSCAllocator *allocator, const char *string) {
+    size_t size = strlen(string) + 1;
+
+    char *copy = dsc_alloc(allocator, size);
+    if (copy != NULL) {
+        memcpy(copy, string, size);
+    }
+
+    return copy;
+}
+
+bool dsc_allocator_frees(const DSCAllocator *allocator) {
+    return dsc_allocator_or_default(allocator)->free != NULL;
+}
+
+char *dsc_allocator_export(const DSCAllocator *allocator, char *string) {
+    allocator = dsc_allocator_or_default(allocator);
+
+    // Counting does not change who can free the string
+    if (DSC_STATS_UNWRAP(allocator)->alloc == dsc_malloc_alloc) {
+        return string;
+    }
+
+    char *copy = strdup(string);
+    if (copy != NULL) {
+        dsc_free(allocator, string);
+    }
+
+    return copy;
+}
+
+char *dsc_allocator_adopt(const DSCAllocator *allocator, char *string) {
+    allocator = dsc_allocator_or_default(allocator);
+
+    if (DSC_STATS_UNWRAP(allocator)->alloc == dsc_malloc_alloc) {
+        return string;
+    }
+
+    return dsc_strdup(allocator, string);
+}
+
+bool dsc_allocator_equal(const DSCAllocator *lhs, const DSCAllocator *rhs) {
+    lhs = DSC_STATS_UNWRAP(dsc_allocator_or_default(lhs));
+    rhs = DSC_STATS_UNWRAP(dsc_allocator_or_default(rhs));
+
+    return lhs->alloc == rhs->alloc && lhs->realloc == rhs->realloc &&
+           lhs->free == rhs->free && lhs->context == rhs->context;
+}
+
+/* Arena */
+
+/* Every allocation is preceded by its size, padded so that the allocation
+ * itself stays aligned for any type */
+#define DSC_ARENA_ALIGN alignof(max_align_t)
+
+typedef struct DSCArenaBlock DSCArenaBlock;
+
+struct DSCArenaBlock {
+    DSCArenaBlock *next; // The block allocated before this one
+    size_t size;         // The number of usable bytes in the block
+    size_t used;         // The number of bytes handed out so far
+    alignas(max_align_t) unsigned char data[];
+};
+
+struct DSCArena {
+    DSCArenaBlock *head; // The block allocations are currently carved from
+    size_t block_size;   // The usable size of a regular block
+};
+
+static inline size_t dsc_arena_round(size_t size) {
+    return (size + DSC_ARENA_ALIGN - 1) & ~(DSC_ARENA_ALIGN - 1);
+}
+
+static void *dsc_arena_alloc(void *context, size_t size) {
+    DSCArena *arena = context;
+
+    if (size > SIZE_MAX - sizeof(DSCArenaBlock) - 2 * DSC_ARENA_ALIGN) {
+        return NULL;
+    }
+
+    size_t needed = DSC_ARENA_ALIGN + dsc_arena_round(size);
+    DSCArenaBlock *block = arena->head;
+
+    if (block == NULL || block->size - block->used < needed) {
+        bool oversized = needed > arena->block_size;
+        size_t block_size = oversized ? needed : arena->block_size;
+
+        block = malloc(sizeof(DSCArenaBlock) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        block->size = block_size;
+        block->used = 0;
+
+        // An oversized block goes behind the current one, which keeps serving
+        // small requests
+        if (oversized && arena->head != NULL) {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        } else {
+            block->next = arena->head;
+            arena->head = block;
+        }
+    }
+
+    unsigned char *header = block->data + block->used;
+    *(size_t *) header = size;
+    block->used += needed;
+
+    return header + DSC_ARENA_ALIGN;
+}
+
+static void *dsc_arena_realloc(void *context, void *ptr, size_t size) {
+    DSCArena *arena = context;
+
+    if (ptr == NULL) {
+        return dsc_arena_alloc(context, size);
+    }
+
+    unsigned char *header = (unsigned char *) ptr - DSC_ARENA_ALIGN;
+    size_t old_size = *(size_t *) header;
+    DSCArenaBlock *head = arena->head;
+
+    // The most recent allocation can grow or shrink in place
+    if (head != NULL && size <= SIZE_MAX - DSC_ARENA_ALIGN &&
+        (unsigned char *) ptr + dsc_arena_round(old_size) == head->data + head->used) {
+        size_t start = (size_t) ((unsigned char *) ptr - head->data);
+
+        if (head->size - start >= dsc_arena_round(size)) {
+            head->used = start + dsc_arena_round(size);
+            *(size_t *) header = size;
+            return ptr;
+        }
+    }
+
+    if (size <= old_size) {
+        *(size_t *) header = size;
+        return ptr;
+    }
+
+    void *new_ptr = dsc_arena_alloc(context, size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size);
+    }
+
+    return new_ptr;
+}
+
+DSCError dsc_arena_init(DSCArena **arena, size_t block_size) {
+    if (arena == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCArena *new_arena = malloc(sizeof(DSCArena));
+    if (new_arena == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_arena->head = NULL;
+    new_arena->block_size = dsc_arena_round(block_size > 0 ? block_size : DSC_ARENA_BLOCK_SIZE);
+
+    *arena = new_arena;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_arena_deinit(DSCArena *arena) {
+    if (arena == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_arena_reset(arena);
+    free(arena->head);
+    free(arena);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_arena_reset(DSCArena *arena) {
+    if (arena == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCArenaBlock *keep = NULL;
+    DSCArenaBlock *block = arena->head;
+
+    while (block != NULL) {
+        DSCArenaBlock *next = block->next;
+
+        if (keep == NULL && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            free(block);
+        }
+
+        block = next;
+    }
+
+    if (keep != NULL) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+
+    arena->head = keep;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_arena_allocator(DSCArena *arena, DSCAllocator *result) {
+    if (arena == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    result->alloc = dsc_arena_alloc;
+    result->realloc = dsc_arena_realloc;
+    result->free = NULL;
+    result->context = arena;
+
+    return DSC_ERROR_OK;
+}
+
+/* Pool */
+
+/* Objects are aligned for pointers, doubles and 64-bit integers */
+#define DSC_POOL_ALIGN alignof(union { void *p; double d; long long l; })
+
+typedef struct DSCPoolSlab DSCPoolSlab;
+
+struct DSCPoolSlab {
+    DSCPoolSlab *next; // The slab allocated before this one
+    alignas(max_align_t) unsigned char data[];
+};
+
+struct DSCPool {
+    DSCPoolSlab *slabs;  // Every slab owned by the pool
+    void *free_list;     // Free objects, each storing a pointer to the next
+    size_t object_size;  // The rounded size of one object
+    size_t slab_objects; // The number of objects per slab
+};
+
+DSCError dsc_pool_init(DSCPool **pool, size_t object_size, size_t slab_objects) {
+    if (pool == NULL || object_size == 0) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (slab_objects == 0) {
+        slab_objects = DSC_POOL_SLAB_OBJECTS;
+    }
+
+    // A free object has to hold the free list link
+    if (object_size < sizeof(void *)) {
+        object_size = sizeof(void *);
+    }
+
+    object_size = (object_size + DSC_POOL_ALIGN - 1) & ~(DSC_POOL_ALIGN - 1);
+
+    if (object_size > (SIZE_MAX - sizeof(DSCPoolSlab)) / slab_objects) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCPool *new_pool = malloc(sizeof(DSCPool));
+    if (new_pool == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_pool->slabs = NULL;
+    new_pool->free_list = NULL;
+    new_pool->object_size = object_size;
+    new_pool->slab_objects = slab_objects;
+
+    *pool = new_pool;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_pool_deinit(DSCPool *pool) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    while (pool->slabs != NULL) {
+        DSCPoolSlab *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+
+    free(pool);
+
+    return DSC_ERROR_OK;
+}
+
+void *dsc_pool_alloc(DSCPool *pool) {
+    if (pool->free_list == NULL) {
+        DSCPoolSlab *slab = malloc(sizeof(DSCPoolSlab) + pool->object_size * pool->slab_objects);
+        if (slab == NULL) {
+            return NULL;
+        }
+
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+
+        // Thread the objects back to front so they are handed out in address order
+        for (size_t i = pool->slab_objects; i-- > 0; ) {
+            void *object = slab->data + i * pool->object_size;
+            *(void **) object = pool->free_list;
+            pool->free_list = object;
+        }
+    }
+
+    void *object = pool->free_list;
+    pool->free_list = *(void **) object;
+
+    return object;
+}
+
+void dsc_pool_free(DSCPool *pool, void *object) {
+    if (object == NULL) {
+        return;
+    }
+
+    *(void **) object = pool->free_list;
+    pool->free_list = object;
+}
+
+static void *dsc_pool_allocator_alloc(void *context, size_t size) {
+    DSCPool *pool = context;
+    return size <= pool->object_size ? dsc_pool_alloc(pool) : NULL;
+}
+
+static void *dsc_pool_allocator_realloc(void *context, void *ptr, size_t size) {
+    DSCPool *pool = context;
+
+    if (ptr == NULL) {
+        return dsc_pool_allocator_alloc(context, size);
+    }
+
+    // Every object already spans the full object size
+    return size <= pool->object_size ? ptr : NULL;
+}
+
+static void dsc_pool_allocator_free(void *context, void *ptr) {
+    dsc_pool_free(context, ptr);
+}
+
+DSCError dsc_pool_allocator(DSCPool *pool, DSCAllocator *result) {
+    if (pool == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    result->alloc = dsc_pool_allocator_alloc;
+    result->realloc = dsc_pool_allocator_realloc;
+    result->free = dsc_pool_allocator_free;
+    result->context = pool;
+
+    return DSC_ERROR_OK;
+}
@@ -0,0 +1,482 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/dsc_bitset.h"
+#include "../include/dsc_growth.h"
+#include "dsc_simd.h"
+#include "dsc_stats_counters.h"
+
+struct DSCBitset {
+    uint64_t *words;        // capacity words, the bits past size all clear
+    size_t size;            // The number of bits
+    size_t capacity;        // The number of words allocated, at least 1
+    DSCGrowthPolicy growth; // How push_back grows the words
+    DSCAllocator allocator; // Source of the words and the struct itself
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+};
+
+static inline size_t dsc_bitset_words(size_t size) {
+    return size / DSC_BITSET_WORD_BITS + (size % DSC_BITSET_WORD_BITS != 0);
+}
+
+/* The bits of word index inside a bitset of size bits */
+static inline uint64_t dsc_bitset_mask(size_t size, size_t index) {
+    size_t end = size - index * DSC_BITSET_WORD_BITS;
+    return end >= DSC_BITSET_WORD_BITS ? UINT64_MAX : ((uint64_t) 1 << end) - 1;
+}
+
+/* Clear the bits of the last word past the size */
+static inline void dsc_bitset_trim(DSCBitset *bitset) {
+    size_t words = dsc_bitset_words(bitset->size);
+    if (words > 0) {
+        bitset->words[words - 1] &= dsc_bitset_mask(bitset->size, words - 1);
+    }
+}
+
+static DSCError dsc_bitset_reallocate(DSCBitset *bitset, size_t capacity) {
+    if (capacity > SIZE_MAX / sizeof(uint64_t)) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint64_t *words = dsc_realloc(&bitset->allocator, bitset->words,
+                                  capacity * sizeof(uint64_t));
+    if (words == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    bitset->words = words;
+    bitset->capacity = capacity;
+    DSC_STATS_REALLOC(&bitset->stats);
+
+    return DSC_ERROR_OK;
+}
+
+/* Change the size to size bits, allocating exactly or by the growth policy */
+static DSCError dsc_bitset_set_size(DSCBitset *bitset, size_t size, bool grow) {
+    size_t old_words = dsc_bitset_words(bitset->size);
+    size_t new_words = dsc_bitset_words(size);
+
+    if (new_words > bitset->capacity) {
+        size_t capacity = grow ? dsc_growth_next(&bitset->growth, bitset->capacity, new_words,
+                                                 sizeof(uint64_t))
+                               : new_words;
+
+        DSCError error = dsc_bitset_reallocate(bitset, capacity);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+    }
+
+    if (new_words > old_words) {
+        memset(bitset->words + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    }
+
+    bitset->size = size;
+    dsc_bitset_trim(bitset);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_init(DSCBitset **bitset, size_t size) {
+    return dsc_bitset_init_allocator(bitset, size, NULL);
+}
+
+DSCError dsc_bitset_init_allocator(DSCBitset **bitset, size_t size,
+                                   const DSCAllocator *allocator) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCBitset *new_bitset = dsc_alloc(allocator, sizeof(DSCBitset));
+    if (new_bitset == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_bitset->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_bitset->stats, &new_bitset->allocator);
+
+    new_bitset->words = NULL;
+    new_bitset->size = 0;
+    new_bitset->capacity = 0;
+    new_bitset->growth = DSC_GROWTH_POLICY_DEFAULT;
+
+    size_t words = dsc_bitset_words(size);
+    DSCError error = dsc_bitset_reallocate(new_bitset, words > 0 ? words : 1);
+    if (error == DSC_ERROR_OK) {
+        error = dsc_bitset_set_size(new_bitset, size, false);
+    }
+
+    if (error != DSC_ERROR_OK) {
+        dsc_free(&new_bitset->allocator, new_bitset->words);
+        dsc_free(allocator, new_bitset);
+        return error;
+    }
+
+    *bitset = new_bitset;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_deinit(DSCBitset *bitset) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The allocator lives inside the bitset, so copy it out first
+    DSCAllocator allocator = bitset->allocator;
+
+    dsc_free(&allocator, bitset->words);
+    dsc_free(&allocator, bitset);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_size(const DSCBitset *bitset, size_t *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = bitset->size;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_resize(DSCBitset *bitset, size_t size) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_bitset_set_size(bitset, size, false);
+}
+
+DSCError dsc_bitset_push_back(DSCBitset *bitset, bool value) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t index = bitset->size;
+
+    DSCError error = dsc_bitset_set_size(bitset, index + 1, true);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    bitset->words[index / DSC_BITSET_WORD_BITS] |= (uint64_t) value
+                                                   << (index % DSC_BITSET_WORD_BITS);
+
+    return DSC_ERROR_OK;
+}
+
+/* Single bits */
+
+static inline uint64_t dsc_bitset_bit(size_t index) {
+    return (uint64_t) 1 << (index % DSC_BITSET_WORD_BITS);
+}
+
+DSCError dsc_bitset_set(DSCBitset *bitset, size_t index) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= bitset->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    bitset->words[index / DSC_BITSET_WORD_BITS] |= dsc_bitset_bit(index);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_reset(DSCBitset *bitset, size_t index) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= bitset->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    bitset->words[index / DSC_BITSET_WORD_BITS] &= ~dsc_bitset_bit(index);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_flip(DSCBitset *bitset, size_t index) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= bitset->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    bitset->words[index / DSC_BITSET_WORD_BITS] ^= dsc_bitset_bit(index);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_test(const DSCBitset *bitset, size_t index, bool *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= bitset->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    *result = (bitset->words[index / DSC_BITSET_WORD_BITS] & dsc_bitset_bit(index)) != 0;
+
+    return DSC_ERROR_OK;
+}
+
+/* Words */
+
+DSCError dsc_bitset_set_range(DSCBitset *bitset, size_t start, size_t count, bool value) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (start > bitset->size || count > bitset->size - start) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    size_t end = start + count;
+
+    while (start < end) {
+        size_t index = start / DSC_BITSET_WORD_BITS;
+        size_t offset = start % DSC_BITSET_WORD_BITS;
+        size_t bits = DSC_BITSET_WORD_BITS - offset < end - start ? DSC_BITSET_WORD_BITS - offset
+                                                                  : end - start;
+
+        // Whole words in the middle of the range take a single store
+        uint64_t mask = bits == DSC_BITSET_WORD_BITS ? UINT64_MAX
+                                                     : (((uint64_t) 1 << bits) - 1) << offset;
+
+        if (value) {
+            bitset->words[index] |= mask;
+        } else {
+            bitset->words[index] &= ~mask;
+        }
+
+        start += bits;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_fill(DSCBitset *bitset, bool value) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    memset(bitset->words, value ? 0xff : 0, dsc_bitset_words(bitset->size) * sizeof(uint64_t));
+    dsc_bitset_trim(bitset);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_word(const DSCBitset *bitset, size_t index, uint64_t *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= dsc_bitset_words(bitset->size)) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    *result = bitset->words[index];
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_set_word(DSCBitset *bitset, size_t index, uint64_t word) {
+    if (bitset == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= dsc_bitset_words(bitset->size)) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    bitset->words[index] = word & dsc_bitset_mask(bitset->size, index);
+
+    return DSC_ERROR_OK;
+}
+
+/* Counting and searching */
+
+DSCError dsc_bitset_count(const DSCBitset *bitset, size_t *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = dsc_simd_popcount(bitset->words, dsc_bitset_words(bitset->size));
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_rank(const DSCBitset *bitset, size_t index, size_t *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index > bitset->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    size_t words = index / DSC_BITSET_WORD_BITS;
+    size_t rank = dsc_simd_popcount(bitset->words, words);
+
+    if (index % DSC_BITSET_WORD_BITS != 0) {
+        uint64_t word = bitset->words[words] & (dsc_bitset_bit(index) - 1);
+        rank += dsc_simd_popcount(&word, 1);
+    }
+
+    *result = rank;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_find_next(const DSCBitset *bitset, size_t start, size_t *result) {
+    if (bitset == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (start >= bitset->size) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    size_t words = dsc_bitset_words(bitset->size);
+    size_t index = start / DSC_BITSET_WORD_BITS;
+    uint64_t word = bitset->words[index] & ~(dsc_bitset_bit(start) - 1);
+
+    // The bits past the size are clear, so the last word needs no mask
+    while (word == 0) {
+        if (++index == words) {
+            return DSC_ERROR_NOT_FOUND;
+        }
+
+        word = bitset->words[index];
+    }
+
+    *result = index * DSC_BITSET_WORD_BITS + (size_t) __builtin_ctzll(word);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_find_first(const DSCBitset *bitset, size_t *result) {
+    return dsc_bitset_find_next(bitset, 0, result);
+}
+
+/* Bitwise operations */
+
+static DSCError dsc_bitset_combine(DSCBitset *dest, const DSCBitset *src, DSCSimdBitwise op) {
+    if (dest == NULL || src == NULL || dest->size != src->size) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Every operation keeps the clear bits past the size clear
+    dsc_simd_bitwise(dest->words, src->words, dsc_bitset_words(dest->size), op);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_and(DSCBitset *dest, const DSCBitset *src) {
+    return dsc_bitset_combine(dest, src, DSC_SIMD_AND);
+}
+
+DSCError dsc_bitset_or(DSCBitset *dest, const DSCBitset *src) {
+    return dsc_bitset_combine(dest, src, DSC_SIMD_OR);
+}
+
+DSCError dsc_bitset_xor(DSCBitset *dest, const DSCBitset *src) {
+    return dsc_bitset_combine(dest, src, DSC_SIMD_XOR);
+}
+
+DSCError dsc_bitset_andnot(DSCBitset *dest, const DSCBitset *src) {
+    return dsc_bitset_combine(dest, src, DSC_SIMD_ANDNOT);
+}
+
+/* Conversion */
+
+DSCError dsc_bitset_assign(DSCBitset *bitset, const bool *values, size_t count) {
+    if (bitset == NULL || (values == NULL && count > 0)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t words = dsc_bitset_words(count);
+
+    if (words > bitset->capacity) {
+        DSCError error = dsc_bitset_reallocate(bitset, words);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+    }
+
+    for (size_t index = 0; index < words; ++index) {
+        size_t base = index * DSC_BITSET_WORD_BITS;
+        size_t bits = count - base < DSC_BITSET_WORD_BITS ? count - base : DSC_BITSET_WORD_BITS;
+        uint64_t word = 0;
+
+        for (size_t i = 0; i < bits; ++i) {
+            word |= (uint64_t) values[base + i] << i;
+        }
+
+        bitset->words[index] = word;
+    }
+
+    bitset->size = count;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_unpack(const DSCBitset *bitset, bool *result) {
+    if (bitset == NULL || (result == NULL && bitset->size > 0)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < bitset->size; ++i) {
+        result[i] = (bitset->words[i / DSC_BITSET_WORD_BITS] >> (i % DSC_BITSET_WORD_BITS)) & 1;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_data(const DSCBitset *bitset, const uint64_t **words) {
+    if (bitset == NULL || words == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *words = bitset->words;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bitset_stats(const DSCBitset *bitset, DSCStats *stats) {
+    if (bitset == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(bitset), stats);
+
+    return DSC_ERROR_OK;
+}
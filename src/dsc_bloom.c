@@ -0,0 +1,316 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/dsc_bloom.h"
+#include "../include/dsc_utils.h"
+#include "dsc_stats_counters.h"
+
+#define DSC_BLOOM_WORDS (DSC_BLOOM_BLOCK_BYTES / sizeof(uint64_t))
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DSC_BLOOM_PREFETCH(addr) __builtin_prefetch((addr), 0, 1)
+#else
+#define DSC_BLOOM_PREFETCH(addr) ((void) (addr))
+#endif
+
+struct DSCBloomFilter {
+    uint64_t *blocks;       // block_count blocks, aligned to a block
+    void *memory;           // The allocation the blocks are carved from
+    size_t block_count;     // The number of blocks
+    size_t count;           // Insertions since creation or the last clear
+    uint64_t seed;          // Per-filter hash seed
+    DSCType type;           // The type of the keys
+    DSCElementType element; // The key stride, and the callbacks of records
+    DSCAllocator allocator; // Source of the blocks and the struct itself
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+};
+
+/* Odd constants that spread a 32-bit hash into one bit index per word, as in
+ * the split-block filters of Impala and Parquet */
+static const uint32_t dsc_bloom_salts[DSC_BLOOM_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+static inline uint64_t dsc_bloom_hash(const DSCBloomFilter *filter, const void *key) {
+    switch (filter->type) {
+        case DSC_TYPE_STRING:
+            return dsc_hash(*(char *const *) key, DSC_TYPE_STRING, filter->seed);
+        case DSC_TYPE_BYTES:
+            return dsc_element_hash(&filter->element, key, filter->seed);
+        default:
+            return dsc_hash(key, filter->type, filter->seed);
+    }
+}
+
+/* The high half of the hash picks the block, the low half the bits in it */
+static inline uint64_t *dsc_bloom_block(const DSCBloomFilter *filter, uint64_t hash) {
+    size_t index = (size_t) (((hash >> 32) * filter->block_count) >> 32);
+    return filter->blocks + index * DSC_BLOOM_WORDS;
+}
+
+static inline void dsc_bloom_mask(uint64_t hash, uint64_t mask[DSC_BLOOM_WORDS]) {
+    uint32_t low = (uint32_t) hash;
+
+    for (size_t i = 0; i < DSC_BLOOM_WORDS; ++i) {
+        mask[i] = (uint64_t) 1 << ((uint32_t) (low * dsc_bloom_salts[i]) >> 26);
+    }
+}
+
+static inline void dsc_bloom_add(DSCBloomFilter *filter, uint64_t hash) {
+    uint64_t *block = dsc_bloom_block(filter, hash);
+    uint64_t mask[DSC_BLOOM_WORDS];
+
+    dsc_bloom_mask(hash, mask);
+
+    for (size_t i = 0; i < DSC_BLOOM_WORDS; ++i) {
+        block[i] |= mask[i];
+    }
+
+    filter->count++;
+}
+
+static inline bool dsc_bloom_test(const uint64_t *block, uint64_t hash) {
+    uint64_t mask[DSC_BLOOM_WORDS];
+    uint64_t missing = 0;
+
+    dsc_bloom_mask(hash, mask);
+
+    // No early exit: the whole line is loaded anyway, and the loop vectorizes
+    for (size_t i = 0; i < DSC_BLOOM_WORDS; ++i) {
+        missing |= mask[i] & ~block[i];
+    }
+
+    return missing == 0;
+}
+
+/* The number of blocks a classic filter setting as many bits per key needs
+ * for the rate, rounded up; blocking costs a little selectivity in return
+ * for touching one cache line */
+static size_t dsc_bloom_block_count(size_t expected_count, double false_positive_rate) {
+    double per_key = -(double) DSC_BLOOM_BITS_PER_KEY /
+                     log(1.0 - pow(false_positive_rate, 1.0 / DSC_BLOOM_BITS_PER_KEY));
+    double blocks = ceil((double) (expected_count > 0 ? expected_count : 1) * per_key /
+                         (DSC_BLOOM_BLOCK_BYTES * 8));
+
+    // Block indexes come from 32 bits of the hash
+    if (!(blocks <= (double) UINT32_MAX)) {
+        return 0;
+    }
+
+    return blocks > 1 ? (size_t) blocks : 1;
+}
+
+static DSCError dsc_bloom_create(DSCBloomFilter **filter, DSCType type,
+                                 const DSCElementType *element, size_t expected_count,
+                                 double false_positive_rate, const DSCAllocator *allocator) {
+    if (!(false_positive_rate > 0.0 && false_positive_rate < 1.0)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t block_count = dsc_bloom_block_count(expected_count, false_positive_rate);
+    if (block_count == 0 || block_count > (SIZE_MAX - DSC_BLOOM_BLOCK_BYTES) /
+                                              DSC_BLOOM_BLOCK_BYTES) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCBloomFilter *new_filter = dsc_alloc(allocator, sizeof(DSCBloomFilter));
+    if (new_filter == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_filter->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_filter->stats, &new_filter->allocator);
+
+    // Allocators only promise max_align_t, so round the blocks up to a line
+    size_t bytes = block_count * DSC_BLOOM_BLOCK_BYTES;
+    new_filter->memory = dsc_alloc(&new_filter->allocator, bytes + DSC_BLOOM_BLOCK_BYTES - 1);
+    if (new_filter->memory == NULL) {
+        dsc_free(allocator, new_filter);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    uintptr_t start = ((uintptr_t) new_filter->memory + DSC_BLOOM_BLOCK_BYTES - 1) &
+                      ~(uintptr_t) (DSC_BLOOM_BLOCK_BYTES - 1);
+
+    new_filter->blocks = (uint64_t *) start;
+    new_filter->block_count = block_count;
+    new_filter->count = 0;
+    new_filter->seed = dsc_hash_seed();
+    new_filter->type = type;
+    new_filter->element = type == DSC_TYPE_BYTES ? *element : dsc_element_of(type);
+
+    memset(new_filter->blocks, 0, bytes);
+
+    *filter = new_filter;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_init(DSCBloomFilter **filter, DSCType type, size_t expected_count,
+                        double false_positive_rate) {
+    return dsc_bloom_init_allocator(filter, type, expected_count, false_positive_rate, NULL);
+}
+
+DSCError dsc_bloom_init_allocator(DSCBloomFilter **filter, DSCType type, size_t expected_count,
+                                  double false_positive_rate, const DSCAllocator *allocator) {
+    if (filter == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return dsc_bloom_create(filter, type, NULL, expected_count, false_positive_rate,
+                            allocator);
+}
+
+DSCError dsc_bloom_init_bytes(DSCBloomFilter **filter, const DSCElementType *element,
+                              size_t expected_count, double false_positive_rate,
+                              const DSCAllocator *allocator) {
+    if (filter == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_bloom_create(filter, DSC_TYPE_BYTES, element, expected_count,
+                            false_positive_rate, allocator);
+}
+
+DSCError dsc_bloom_deinit(DSCBloomFilter *filter) {
+    if (filter == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The allocator lives inside the filter, so copy it out first
+    DSCAllocator allocator = filter->allocator;
+
+    dsc_free(&allocator, filter->memory);
+    dsc_free(&allocator, filter);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_insert(DSCBloomFilter *filter, void *key) {
+    if (filter == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_bloom_add(filter, dsc_bloom_hash(filter, key));
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_insert_range(DSCBloomFilter *filter, void *keys, size_t count) {
+    if (filter == NULL || (keys == NULL && count > 0)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const unsigned char *bytes = keys;
+
+    for (size_t i = 0; i < count; ++i) {
+        dsc_bloom_add(filter, dsc_bloom_hash(filter, bytes + i * filter->element.size));
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_contains(const DSCBloomFilter *filter, void *key, bool *result) {
+    if (filter == NULL || key == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t hash = dsc_bloom_hash(filter, key);
+    *result = dsc_bloom_test(dsc_bloom_block(filter, hash), hash);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_contains_batch(const DSCBloomFilter *filter, void *keys, size_t count,
+                                  bool *results) {
+    if (filter == NULL || ((keys == NULL || results == NULL) && count > 0)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const unsigned char *bytes = keys;
+
+    for (size_t base = 0; base < count; base += DSC_BLOOM_BATCH_WINDOW) {
+        size_t n = count - base < DSC_BLOOM_BATCH_WINDOW ? count - base
+                                                          : DSC_BLOOM_BATCH_WINDOW;
+        uint64_t hashes[DSC_BLOOM_BATCH_WINDOW];
+        const uint64_t *blocks[DSC_BLOOM_BATCH_WINDOW];
+
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = dsc_bloom_hash(filter, bytes + (base + i) * filter->element.size);
+            blocks[i] = dsc_bloom_block(filter, hashes[i]);
+            DSC_BLOOM_PREFETCH(blocks[i]);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            results[base + i] = dsc_bloom_test(blocks[i], hashes[i]);
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_clear(DSCBloomFilter *filter) {
+    if (filter == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    memset(filter->blocks, 0, filter->block_count * DSC_BLOOM_BLOCK_BYTES);
+    filter->count = 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_count(const DSCBloomFilter *filter, size_t *result) {
+    if (filter == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = filter->count;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_bytes(const DSCBloomFilter *filter, size_t *result) {
+    if (filter == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = filter->block_count * DSC_BLOOM_BLOCK_BYTES;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_bloom_stats(const DSCBloomFilter *filter, DSCStats *stats) {
+    if (filter == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(filter), stats);
+
+    return DSC_ERROR_OK;
+}
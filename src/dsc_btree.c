@@ -0,0 +1,907 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsc_btree.h"
+
+/* Node layout */
+
+static inline size_t dsc_btree_align(size_t size) {
+    return (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+}
+
+static inline unsigned char *dsc_btree_key(const DSCBTree *tree, const DSCBTreeNode *node,
+                                           size_t index) {
+    return (unsigned char *) node->data + index * tree->key_element.size;
+}
+
+static inline unsigned char *dsc_btree_value(const DSCBTree *tree, const DSCBTreeNode *node,
+                                             size_t index) {
+    return (unsigned char *) node->data + tree->values_offset +
+           index * tree->value_element.size;
+}
+
+static inline DSCBTreeNode **dsc_btree_children(const DSCBTree *tree, const DSCBTreeNode *node) {
+    return (DSCBTreeNode **) ((unsigned char *) node->data + tree->children_offset);
+}
+
+/* Every node has room for one entry (and child) more than its capacity, so
+ * an insert can overflow it before it is split. */
+static DSCBTreeNode *dsc_btree_node_alloc(const DSCBTree *tree, bool leaf) {
+    size_t size = leaf ? tree->values_offset +
+                             (tree->leaf_capacity + 1) * tree->value_element.size
+                       : tree->children_offset +
+                             (tree->inner_capacity + 2) * sizeof(DSCBTreeNode *);
+
+    DSCBTreeNode *node = dsc_alloc(&tree->allocator, sizeof(DSCBTreeNode) + size);
+    if (node != NULL) {
+        node->next = NULL;
+        node->count = 0;
+        node->leaf = leaf;
+    }
+
+    return node;
+}
+
+/* Element ownership */
+
+static DSCError dsc_btree_store(const DSCBTree *tree, DSCType type,
+                                const DSCElementType *element, void *dest, const void *src) {
+    switch (type) {
+        case DSC_TYPE_UNKNOWN:
+            return DSC_ERROR_OK;
+
+        case DSC_TYPE_STRING: {
+            char *copy = dsc_strdup(&tree->allocator, *(char *const *) src);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) dest = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(element, dest, src);
+
+        default:
+            memcpy(dest, src, element->size);
+            return DSC_ERROR_OK;
+    }
+}
+
+static void dsc_btree_release(const DSCBTree *tree, DSCType type,
+                              const DSCElementType *element, void *slots, size_t count) {
+    if (type == DSC_TYPE_STRING && dsc_allocator_frees(&tree->allocator)) {
+        char **strings = slots;
+
+        for (size_t i = 0; i < count; ++i) {
+            dsc_free(&tree->allocator, strings[i]);
+        }
+    }
+
+    if (type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(element, slots, count);
+    }
+}
+
+static inline DSCError dsc_btree_store_key(const DSCBTree *tree, void *dest, const void *src) {
+    return dsc_btree_store(tree, tree->key_type, &tree->key_element, dest, src);
+}
+
+static inline void dsc_btree_release_keys(const DSCBTree *tree, void *slots, size_t count) {
+    dsc_btree_release(tree, tree->key_type, &tree->key_element, slots, count);
+}
+
+static inline void dsc_btree_release_values(const DSCBTree *tree, void *slots, size_t count) {
+    dsc_btree_release(tree, tree->value_type, &tree->value_element, slots, count);
+}
+
+/* Release a node and everything below it, except keep, whose entries are
+ * released but whose memory is not */
+static void dsc_btree_free(DSCBTree *tree, DSCBTreeNode *node, DSCBTreeNode *keep) {
+    dsc_btree_release_keys(tree, node->data, node->count);
+
+    if (node->leaf) {
+        dsc_btree_release_values(tree, dsc_btree_value(tree, node, 0), node->count);
+    } else {
+        DSCBTreeNode **children = dsc_btree_children(tree, node);
+
+        for (size_t i = 0; i <= node->count; ++i) {
+            dsc_btree_free(tree, children[i], keep);
+        }
+    }
+
+    if (node != keep) {
+        dsc_free(&tree->allocator, node);
+    }
+}
+
+/* Ordering */
+
+static inline int dsc_btree_compare_double(double a, double b) {
+    // NaNs compare equal to each other and greater than every number
+    if (isnan(a) || isnan(b)) {
+        return (isnan(a) != 0) - (isnan(b) != 0);
+    }
+
+    return (a > b) - (a < b);
+}
+
+int dsc_btree_compare(const DSCBTree *tree, const void *lhs, const void *rhs) {
+    switch (tree->key_type) {
+        case DSC_TYPE_BOOL:
+            return *(const bool *) lhs - *(const bool *) rhs;
+        case DSC_TYPE_CHAR:
+            return (*(const char *) lhs > *(const char *) rhs) -
+                   (*(const char *) lhs < *(const char *) rhs);
+        case DSC_TYPE_INT:
+            return (*(const int *) lhs > *(const int *) rhs) -
+                   (*(const int *) lhs < *(const int *) rhs);
+        case DSC_TYPE_FLOAT:
+            return dsc_btree_compare_double(*(const float *) lhs, *(const float *) rhs);
+        case DSC_TYPE_DOUBLE:
+            return dsc_btree_compare_double(*(const double *) lhs, *(const double *) rhs);
+        case DSC_TYPE_STRING:
+            return strcmp(*(char *const *) lhs, *(char *const *) rhs);
+        default:
+            return dsc_element_compare(&tree->key_element, lhs, rhs);
+    }
+}
+
+/* The first key of a node not less than key, or with upper the first one
+ * greater than it; count if there is none */
+static size_t dsc_btree_search(const DSCBTree *tree, const DSCBTreeNode *node,
+                               const void *key, bool upper) {
+    size_t lo = 0;
+    size_t hi = node->count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int order = dsc_btree_compare(tree, dsc_btree_key(tree, node, mid), key);
+
+        if (order < 0 || (upper && order == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* Keys equal to a separator live in the subtree to its right */
+static inline DSCBTreeNode *dsc_btree_descend(const DSCBTree *tree, const DSCBTreeNode *node,
+                                              const void *key, size_t *slot) {
+    size_t index = dsc_btree_search(tree, node, key, true);
+
+    if (slot != NULL) {
+        *slot = index;
+    }
+
+    return dsc_btree_children(tree, node)[index];
+}
+
+/* Setup */
+
+static size_t dsc_btree_fanout(size_t entry_size) {
+    size_t fanout = DSC_BTREE_NODE_BYTES / entry_size;
+
+    if (fanout < DSC_BTREE_MIN_FANOUT) {
+        return DSC_BTREE_MIN_FANOUT;
+    }
+
+    return fanout > DSC_BTREE_MAX_FANOUT ? DSC_BTREE_MAX_FANOUT : fanout;
+}
+
+DSCError dsc_btree_init(DSCBTree *tree, DSCType key_type, const DSCElementType *key_element,
+                        DSCType value_type, const DSCElementType *value_element,
+                        const DSCAllocator *allocator) {
+    tree->key_type = key_type;
+    tree->value_type = value_type;
+    tree->key_element = key_type == DSC_TYPE_BYTES ? *key_element : dsc_element_of(key_type);
+
+    if (value_type == DSC_TYPE_UNKNOWN) {
+        tree->value_element = (DSCElementType) {0, NULL, NULL, NULL, NULL};
+    } else {
+        tree->value_element = value_type == DSC_TYPE_BYTES ? *value_element
+                                                           : dsc_element_of(value_type);
+    }
+
+    size_t key_size = tree->key_element.size;
+    size_t value_size = tree->value_element.size;
+
+    if (key_size > DSC_BTREE_NODE_BYTES * DSC_BTREE_MAX_FANOUT ||
+        value_size > DSC_BTREE_NODE_BYTES * DSC_BTREE_MAX_FANOUT) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    tree->leaf_capacity = dsc_btree_fanout(key_size + value_size);
+    tree->inner_capacity = dsc_btree_fanout(key_size + sizeof(DSCBTreeNode *));
+    tree->values_offset = dsc_btree_align((tree->leaf_capacity + 1) * key_size);
+    tree->children_offset = dsc_btree_align((tree->inner_capacity + 1) * key_size);
+    tree->scratch_stride = dsc_btree_align(key_size > value_size ? key_size : value_size);
+    tree->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    tree->size = 0;
+    tree->height = 1;
+
+    tree->scratch = dsc_alloc(&tree->allocator, 3 * tree->scratch_stride);
+    if (tree->scratch == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    tree->root = dsc_btree_node_alloc(tree, true);
+    if (tree->root == NULL) {
+        dsc_free(&tree->allocator, tree->scratch);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    tree->first = tree->root;
+
+    return DSC_ERROR_OK;
+}
+
+void dsc_btree_deinit(DSCBTree *tree) {
+    dsc_btree_free(tree, tree->root, NULL);
+    dsc_free(&tree->allocator, tree->scratch);
+}
+
+void dsc_btree_clear(DSCBTree *tree) {
+    DSCBTreeNode *first = tree->first;
+
+    dsc_btree_free(tree, tree->root, first);
+
+    first->count = 0;
+    first->next = NULL;
+    tree->root = first;
+    tree->size = 0;
+    tree->height = 1;
+}
+
+/* Lookup */
+
+static const DSCBTreeNode *dsc_btree_leaf(const DSCBTree *tree, const void *key) {
+    const DSCBTreeNode *node = tree->root;
+
+    while (!node->leaf) {
+        node = dsc_btree_descend(tree, node, key, NULL);
+    }
+
+    return node;
+}
+
+bool dsc_btree_find(const DSCBTree *tree, const void *key, void **value) {
+    const DSCBTreeNode *leaf = dsc_btree_leaf(tree, key);
+    size_t index = dsc_btree_search(tree, leaf, key, false);
+
+    if (index == leaf->count || dsc_btree_compare(tree, dsc_btree_key(tree, leaf, index), key)) {
+        return false;
+    }
+
+    if (value != NULL) {
+        *value = tree->value_type != DSC_TYPE_UNKNOWN ? dsc_btree_value(tree, leaf, index)
+                                                      : NULL;
+    }
+
+    return true;
+}
+
+void dsc_btree_seek(const DSCBTree *tree, const void *key, bool upper,
+                    const DSCBTreeNode **leaf, size_t *index) {
+    if (key == NULL) {
+        *leaf = tree->first;
+        *index = 0;
+        return;
+    }
+
+    *leaf = dsc_btree_leaf(tree, key);
+    *index = dsc_btree_search(tree, *leaf, key, upper);
+}
+
+const void *dsc_btree_peek(const DSCBTree *tree, const DSCBTreeNode **leaf, size_t *index) {
+    // Only the root leaf of an empty tree has no entries, but a seek can end
+    // past the last entry of any leaf
+    while (*leaf != NULL && *index >= (*leaf)->count) {
+        *leaf = (*leaf)->next;
+        *index = 0;
+    }
+
+    return *leaf != NULL ? dsc_btree_key(tree, *leaf, *index) : NULL;
+}
+
+bool dsc_btree_next(const DSCBTree *tree, const DSCBTreeNode **leaf, size_t *index,
+                    const void **key, const void **value) {
+    const void *slot = dsc_btree_peek(tree, leaf, index);
+    if (slot == NULL) {
+        return false;
+    }
+
+    *key = dsc_element_view(slot, tree->key_type);
+
+    if (value != NULL) {
+        *value = tree->value_type != DSC_TYPE_UNKNOWN
+                     ? dsc_element_view(dsc_btree_value(tree, *leaf, *index), tree->value_type)
+                     : NULL;
+    }
+
+    (*index)++;
+
+    return true;
+}
+
+DSCError dsc_btree_output(const DSCBTree *tree, const void *value, void *result) {
+    switch (tree->value_type) {
+        case DSC_TYPE_STRING: {
+            char *copy = strdup(*(char *const *) value);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) result = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(&tree->value_element, result, value);
+
+        default:
+            memcpy(result, value, tree->value_element.size);
+            return DSC_ERROR_OK;
+    }
+}
+
+/* Insertion */
+
+/* Open a gap at index in a run of count slots of size bytes each */
+static inline void dsc_btree_open(unsigned char *slots, size_t index, size_t count, size_t size) {
+    memmove(slots + (index + 1) * size, slots + index * size, (count - index) * size);
+}
+
+/* Close the gap at index in a run of count slots */
+static inline void dsc_btree_close(unsigned char *slots, size_t index, size_t count, size_t size) {
+    memmove(slots + index * size, slots + (index + 1) * size, (count - index - 1) * size);
+}
+
+DSCError dsc_btree_insert(DSCBTree *tree, const void *key, const void *value) {
+    DSCBTreeNode *path[DSC_BTREE_MAX_HEIGHT];
+    size_t slots[DSC_BTREE_MAX_HEIGHT];
+    size_t depth = 0;
+
+    DSCBTreeNode *leaf = tree->root;
+    while (!leaf->leaf) {
+        path[depth] = leaf;
+        leaf = dsc_btree_descend(tree, leaf, key, &slots[depth]);
+        depth++;
+    }
+
+    size_t index = dsc_btree_search(tree, leaf, key, false);
+    if (index < leaf->count && dsc_btree_compare(tree, dsc_btree_key(tree, leaf, index), key) == 0) {
+        return DSC_ERROR_ALREADY_EXISTS;
+    }
+
+    // A full leaf splits, and so does every full ancestor above it in a row;
+    // a full root adds a level
+    size_t splits = 0;
+    if (leaf->count == tree->leaf_capacity) {
+        splits = 1;
+
+        while (splits <= depth && path[depth - splits]->count == tree->inner_capacity) {
+            splits++;
+        }
+    }
+
+    size_t needed = splits + (splits == depth + 1);
+    size_t key_size = tree->key_element.size;
+    size_t value_size = tree->value_element.size;
+    unsigned char *new_key = tree->scratch;
+    unsigned char *separator = tree->scratch + tree->scratch_stride;
+    unsigned char *new_value = tree->scratch + 2 * tree->scratch_stride;
+
+    // Make every copy and allocation first, so that a failure changes nothing
+    DSCError error = dsc_btree_store_key(tree, new_key, key);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    error = dsc_btree_store(tree, tree->value_type, &tree->value_element, new_value, value);
+    if (error != DSC_ERROR_OK) {
+        dsc_btree_release_keys(tree, new_key, 1);
+        return error;
+    }
+
+    // The leaf keeps the lower half of its entries and the new one
+    size_t left_count = (tree->leaf_capacity + 1) / 2;
+
+    if (splits > 0) {
+        const void *first_right = left_count == index ? key
+                                  : left_count < index ? dsc_btree_key(tree, leaf, left_count)
+                                                       : dsc_btree_key(tree, leaf, left_count - 1);
+
+        error = dsc_btree_store_key(tree, separator, first_right);
+        if (error != DSC_ERROR_OK) {
+            dsc_btree_release_values(tree, new_value, 1);
+            dsc_btree_release_keys(tree, new_key, 1);
+            return error;
+        }
+    }
+
+    DSCBTreeNode *nodes[DSC_BTREE_MAX_HEIGHT + 1];
+    size_t allocated = 0;
+
+    for (; allocated < needed; ++allocated) {
+        nodes[allocated] = dsc_btree_node_alloc(tree, allocated == 0);
+        if (nodes[allocated] == NULL) {
+            break;
+        }
+    }
+
+    if (allocated < needed) {
+        while (allocated-- > 0) {
+            dsc_free(&tree->allocator, nodes[allocated]);
+        }
+
+        if (splits > 0) {
+            dsc_btree_release_keys(tree, separator, 1);
+        }
+
+        dsc_btree_release_values(tree, new_value, 1);
+        dsc_btree_release_keys(tree, new_key, 1);
+
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    dsc_btree_open(leaf->data, index, leaf->count, key_size);
+    memcpy(dsc_btree_key(tree, leaf, index), new_key, key_size);
+
+    if (value_size > 0) {
+        unsigned char *values = dsc_btree_value(tree, leaf, 0);
+        dsc_btree_open(values, index, leaf->count, value_size);
+        memcpy(values + index * value_size, new_value, value_size);
+    }
+
+    leaf->count++;
+    tree->size++;
+
+    if (splits == 0) {
+        return DSC_ERROR_OK;
+    }
+
+    // Split the leaf, linking the new right half in after it
+    DSCBTreeNode *right = nodes[0];
+
+    right->count = leaf->count - left_count;
+    memcpy(right->data, dsc_btree_key(tree, leaf, left_count), right->count * key_size);
+    memcpy(dsc_btree_value(tree, right, 0), dsc_btree_value(tree, leaf, left_count),
+           right->count * value_size);
+    leaf->count = left_count;
+
+    right->next = leaf->next;
+    leaf->next = right;
+
+    // Hand the separator and the new node up until a parent has room
+    size_t next_node = 1;
+
+    while (depth > 0) {
+        depth--;
+
+        DSCBTreeNode *parent = path[depth];
+        size_t slot = slots[depth];
+        DSCBTreeNode **children = dsc_btree_children(tree, parent);
+
+        dsc_btree_open(parent->data, slot, parent->count, key_size);
+        memcpy(dsc_btree_key(tree, parent, slot), separator, key_size);
+        dsc_btree_open((unsigned char *) children, slot + 1, parent->count + 1,
+                       sizeof(DSCBTreeNode *));
+        children[slot + 1] = right;
+        parent->count++;
+
+        if (parent->count <= tree->inner_capacity) {
+            return DSC_ERROR_OK;
+        }
+
+        // The middle key moves up; the keys after it go right with their
+        // children
+        size_t middle = parent->count / 2;
+        DSCBTreeNode *sibling = nodes[next_node++];
+
+        sibling->count = parent->count - middle - 1;
+        memcpy(sibling->data, dsc_btree_key(tree, parent, middle + 1), sibling->count * key_size);
+        memcpy(dsc_btree_children(tree, sibling), children + middle + 1,
+               (sibling->count + 1) * sizeof(DSCBTreeNode *));
+        memcpy(separator, dsc_btree_key(tree, parent, middle), key_size);
+        parent->count = middle;
+
+        right = sibling;
+    }
+
+    // The root split: grow the tree by a level
+    DSCBTreeNode *root = nodes[next_node];
+
+    root->count = 1;
+    memcpy(root->data, separator, key_size);
+    dsc_btree_children(tree, root)[0] = tree->root;
+    dsc_btree_children(tree, root)[1] = right;
+    tree->root = root;
+    tree->height++;
+
+    return DSC_ERROR_OK;
+}
+
+/* Erasure */
+
+/* Remove key index of an inner node and the child to its right */
+static void dsc_btree_remove_separator(DSCBTree *tree, DSCBTreeNode *node, size_t index) {
+    dsc_btree_close(node->data, index, node->count, tree->key_element.size);
+    dsc_btree_close((unsigned char *) dsc_btree_children(tree, node), index + 1,
+                    node->count + 1, sizeof(DSCBTreeNode *));
+    node->count--;
+}
+
+/* Append the right leaf to the left one, which precedes it in the parent
+ * at separator index */
+static void dsc_btree_merge_leaves(DSCBTree *tree, DSCBTreeNode *parent, size_t index,
+                                   DSCBTreeNode *left, DSCBTreeNode *right) {
+    size_t key_size = tree->key_element.size;
+    size_t value_size = tree->value_element.size;
+
+    memcpy(dsc_btree_key(tree, left, left->count), right->data, right->count * key_size);
+    memcpy(dsc_btree_value(tree, left, left->count), dsc_btree_value(tree, right, 0),
+           right->count * value_size);
+    left->count += right->count;
+    left->next = right->next;
+
+    dsc_free(&tree->allocator, right);
+
+    // The separator was a copy of a key, and nothing refers to it any more
+    dsc_btree_release_keys(tree, dsc_btree_key(tree, parent, index), 1);
+    dsc_btree_remove_separator(tree, parent, index);
+}
+
+/* Pull the separator at index down between two inner nodes and append the
+ * right one to the left one */
+static void dsc_btree_merge_inner(DSCBTree *tree, DSCBTreeNode *parent, size_t index,
+                                  DSCBTreeNode *left, DSCBTreeNode *right) {
+    size_t key_size = tree->key_element.size;
+
+    memcpy(dsc_btree_key(tree, left, left->count), dsc_btree_key(tree, parent, index), key_size);
+    memcpy(dsc_btree_key(tree, left, left->count + 1), right->data, right->count * key_size);
+    memcpy(dsc_btree_children(tree, left) + left->count + 1, dsc_btree_children(tree, right),
+           (right->count + 1) * sizeof(DSCBTreeNode *));
+    left->count += right->count + 1;
+
+    dsc_free(&tree->allocator, right);
+    dsc_btree_remove_separator(tree, parent, index);
+}
+
+/* Move the last key of the left sibling up and the separator down into node */
+static void dsc_btree_rotate_right(DSCBTree *tree, DSCBTreeNode *parent, size_t index,
+                                   DSCBTreeNode *left, DSCBTreeNode *node) {
+    size_t key_size = tree->key_element.size;
+    DSCBTreeNode **children = dsc_btree_children(tree, node);
+    DSCBTreeNode **left_children = dsc_btree_children(tree, left);
+
+    dsc_btree_open(node->data, 0, node->count, key_size);
+    dsc_btree_open((unsigned char *) children, 0, node->count + 1, sizeof(DSCBTreeNode *));
+    memcpy(node->data, dsc_btree_key(tree, parent, index), key_size);
+    children[0] = left_children[left->count];
+    node->count++;
+
+    memcpy(dsc_btree_key(tree, parent, index), dsc_btree_key(tree, left, left->count - 1),
+           key_size);
+    left->count--;
+}
+
+/* Move the first key of the right sibling up and the separator down into node */
+static void dsc_btree_rotate_left(DSCBTree *tree, DSCBTreeNode *parent, size_t index,
+                                  DSCBTreeNode *node, DSCBTreeNode *right) {
+    size_t key_size = tree->key_element.size;
+    DSCBTreeNode **right_children = dsc_btree_children(tree, right);
+
+    memcpy(dsc_btree_key(tree, node, node->count), dsc_btree_key(tree, parent, index), key_size);
+    dsc_btree_children(tree, node)[node->count + 1] = right_children[0];
+    node->count++;
+
+    memcpy(dsc_btree_key(tree, parent, index), right->data, key_size);
+    dsc_btree_close(right->data, 0, right->count, key_size);
+    dsc_btree_close((unsigned char *) right_children, 0, right->count + 1,
+                    sizeof(DSCBTreeNode *));
+    right->count--;
+}
+
+DSCError dsc_btree_erase(DSCBTree *tree, const void *key) {
+    DSCBTreeNode *path[DSC_BTREE_MAX_HEIGHT];
+    size_t slots[DSC_BTREE_MAX_HEIGHT];
+    size_t depth = 0;
+
+    DSCBTreeNode *node = tree->root;
+    while (!node->leaf) {
+        path[depth] = node;
+        node = dsc_btree_descend(tree, node, key, &slots[depth]);
+        depth++;
+    }
+
+    size_t index = dsc_btree_search(tree, node, key, false);
+    if (index == node->count || dsc_btree_compare(tree, dsc_btree_key(tree, node, index), key)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    size_t value_size = tree->value_element.size;
+
+    dsc_btree_release_keys(tree, dsc_btree_key(tree, node, index), 1);
+    dsc_btree_close(node->data, index, node->count, tree->key_element.size);
+
+    if (value_size > 0) {
+        unsigned char *values = dsc_btree_value(tree, node, 0);
+        dsc_btree_release_values(tree, values + index * value_size, 1);
+        dsc_btree_close(values, index, node->count, value_size);
+    }
+
+    node->count--;
+    tree->size--;
+
+    // Merge or borrow upwards for as long as a node is left too empty
+    while (depth > 0) {
+        DSCBTreeNode *parent = path[depth - 1];
+        size_t slot = slots[depth - 1];
+        DSCBTreeNode **children = dsc_btree_children(tree, parent);
+        DSCBTreeNode *left = slot > 0 ? children[slot - 1] : NULL;
+        DSCBTreeNode *right = slot < parent->count ? children[slot + 1] : NULL;
+
+        if (node->leaf) {
+            // Leaves never borrow, which would take a new separator copy
+            size_t capacity = tree->leaf_capacity;
+
+            if (node->count >= capacity / 2) {
+                break;
+            }
+
+            if (left != NULL && left->count + node->count <= capacity) {
+                dsc_btree_merge_leaves(tree, parent, slot - 1, left, node);
+            } else if (right != NULL && node->count + right->count <= capacity) {
+                dsc_btree_merge_leaves(tree, parent, slot, node, right);
+            } else {
+                break;
+            }
+        } else {
+            size_t minimum = tree->inner_capacity / 2;
+
+            if (node->count >= minimum) {
+                break;
+            }
+
+            if (left != NULL && left->count > minimum) {
+                dsc_btree_rotate_right(tree, parent, slot - 1, left, node);
+                break;
+            }
+
+            if (right != NULL && right->count > minimum) {
+                dsc_btree_rotate_left(tree, parent, slot, node, right);
+                break;
+            }
+
+            if (left != NULL) {
+                dsc_btree_merge_inner(tree, parent, slot - 1, left, node);
+            } else {
+                dsc_btree_merge_inner(tree, parent, slot, node, right);
+            }
+        }
+
+        node = parent;
+        depth--;
+    }
+
+    // A root left with a single child hands the tree over to it
+    if (!tree->root->leaf && tree->root->count == 0) {
+        DSCBTreeNode *root = tree->root;
+
+        tree->root = dsc_btree_children(tree, root)[0];
+        tree->height--;
+        dsc_free(&tree->allocator, root);
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Bulk loading */
+
+/* Release the entries and memory of every node in an array */
+static void dsc_btree_drop(DSCBTree *tree, DSCBTreeNode **nodes, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dsc_btree_release_keys(tree, nodes[i]->data, nodes[i]->count);
+
+        if (nodes[i]->leaf) {
+            dsc_btree_release_values(tree, dsc_btree_value(tree, nodes[i], 0), nodes[i]->count);
+        }
+
+        dsc_free(&tree->allocator, nodes[i]);
+    }
+}
+
+/* The number of items the given node of a level of count items spread over
+ * nodes gets: the first count % nodes nodes take one more */
+static inline size_t dsc_btree_share(size_t count, size_t nodes, size_t node) {
+    return count / nodes + (node < count % nodes);
+}
+
+DSCError dsc_btree_load_sorted(DSCBTree *tree, const void *keys, const void *values,
+                               size_t count) {
+    if (tree->size > 0 || (values == NULL && tree->value_type != DSC_TYPE_UNKNOWN)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t key_size = tree->key_element.size;
+    size_t value_size = tree->value_element.size;
+    const unsigned char *key_bytes = keys;
+    const unsigned char *value_bytes = values;
+
+    for (size_t i = 1; i < count; ++i) {
+        if (dsc_btree_compare(tree, key_bytes + (i - 1) * key_size, key_bytes + i * key_size) >= 0) {
+            return DSC_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+    if (count == 0) {
+        return DSC_ERROR_OK;
+    }
+
+    // Count the nodes of every level, leaves first
+    size_t level_sizes[DSC_BTREE_MAX_HEIGHT];
+    size_t levels = 0;
+    size_t total = 0;
+
+    for (size_t width = (count + tree->leaf_capacity - 1) / tree->leaf_capacity; ;
+         width = (width + tree->inner_capacity) / (tree->inner_capacity + 1)) {
+        level_sizes[levels++] = width;
+        total += width;
+
+        if (width == 1) {
+            break;
+        }
+    }
+
+    if (total > SIZE_MAX / sizeof(DSCBTreeNode *)) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCBTreeNode **nodes = dsc_alloc(&tree->allocator, total * sizeof(DSCBTreeNode *));
+    if (nodes == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t allocated = 0;
+    for (size_t level = 0, start = 0; level < levels; start += level_sizes[level++]) {
+        for (size_t i = 0; i < level_sizes[level]; ++i) {
+            nodes[allocated] = dsc_btree_node_alloc(tree, level == 0);
+            if (nodes[allocated] == NULL) {
+                dsc_btree_drop(tree, nodes, allocated);
+                dsc_free(&tree->allocator, nodes);
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            allocated++;
+        }
+    }
+
+    // Fill the leaves, keeping each node's count in step so that a failed
+    // copy can be undone by dropping every node
+    bool trivial = (tree->key_type != DSC_TYPE_STRING &&
+                    (tree->key_type != DSC_TYPE_BYTES || tree->key_element.copy == NULL)) &&
+                   (tree->value_type != DSC_TYPE_STRING &&
+                    (tree->value_type != DSC_TYPE_BYTES || tree->value_element.copy == NULL));
+    DSCError error = DSC_ERROR_OK;
+    size_t next = 0;
+
+    for (size_t i = 0; i < level_sizes[0] && error == DSC_ERROR_OK; ++i) {
+        DSCBTreeNode *leaf = nodes[i];
+        size_t share = dsc_btree_share(count, level_sizes[0], i);
+
+        leaf->next = i + 1 < level_sizes[0] ? nodes[i + 1] : NULL;
+
+        if (trivial) {
+            memcpy(leaf->data, key_bytes + next * key_size, share * key_size);
+
+            if (value_size > 0) {
+                memcpy(dsc_btree_value(tree, leaf, 0), value_bytes + next * value_size,
+                       share * value_size);
+            }
+
+            leaf->count = share;
+            next += share;
+            continue;
+        }
+
+        for (size_t j = 0; j < share; ++j, ++next) {
+            unsigned char *slot = dsc_btree_key(tree, leaf, j);
+
+            error = dsc_btree_store_key(tree, slot, key_bytes + next * key_size);
+            if (error != DSC_ERROR_OK) {
+                break;
+            }
+
+            if (value_size > 0) {
+                error = dsc_btree_store(tree, tree->value_type, &tree->value_element,
+                                        dsc_btree_value(tree, leaf, j),
+                                        value_bytes + next * value_size);
+            }
+
+            if (error != DSC_ERROR_OK) {
+                dsc_btree_release_keys(tree, slot, 1);
+                break;
+            }
+
+            leaf->count++;
+        }
+    }
+
+    // Build each inner level over the one below; a separator is a copy of
+    // the smallest key under the child to its right
+    size_t below = 0;
+
+    for (size_t level = 1; level < levels && error == DSC_ERROR_OK; ++level) {
+        size_t start = below + level_sizes[level - 1];
+        size_t child = below;
+
+        for (size_t i = 0; i < level_sizes[level] && error == DSC_ERROR_OK; ++i) {
+            DSCBTreeNode *inner = nodes[start + i];
+            DSCBTreeNode **children = dsc_btree_children(tree, inner);
+            size_t share = dsc_btree_share(level_sizes[level - 1], level_sizes[level], i);
+
+            for (size_t j = 0; j < share; ++j) {
+                children[j] = nodes[child++];
+
+                if (j == 0) {
+                    continue;
+                }
+
+                const DSCBTreeNode *smallest = children[j];
+                while (!smallest->leaf) {
+                    smallest = dsc_btree_children(tree, smallest)[0];
+                }
+
+                error = dsc_btree_store_key(tree, dsc_btree_key(tree, inner, j - 1),
+                                            smallest->data);
+                if (error != DSC_ERROR_OK) {
+                    break;
+                }
+
+                inner->count++;
+            }
+        }
+
+        below = start;
+    }
+
+    if (error != DSC_ERROR_OK) {
+        dsc_btree_drop(tree, nodes, total);
+        dsc_free(&tree->allocator, nodes);
+        return error;
+    }
+
+    dsc_free(&tree->allocator, tree->root);
+
+    tree->root = nodes[total - 1];
+    tree->first = nodes[0];
+    tree->size = count;
+    tree->height = levels;
+
+    dsc_free(&tree->allocator, nodes);
+
+    return DSC_ERROR_OK;
+}
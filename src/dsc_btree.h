@@ -0,0 +1,225 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_btree.h
+ * @brief Internal B+-tree shared by DSCOrderedMap and DSCOrderedSet.
+ *
+ * This header is not installed. A DSCBTree keeps its entries sorted in leaf
+ * nodes that are linked from left to right, so that a range scan is a walk
+ * along the leaves; inner nodes hold only separator keys and child pointers.
+ * Every node holds its keys inline in one array, and a leaf its values in a
+ * second one, each a fixed stride apart: a built-in key takes the size of its
+ * type (a char * for strings), a DSC_TYPE_BYTES key the record size. Nodes
+ * are sized to span about DSC_BTREE_NODE_BYTES, a handful of cache lines, so
+ * that a search touches few lines per level. Without values (sets) the value
+ * array is empty.
+ *
+ * Separators are copies of keys, owned by the inner nodes, so that erasing a
+ * key from a leaf never leaves a dangling separator. Leaves are merged with a
+ * neighbour once they are less than half full and the two fit in one node;
+ * inner nodes are kept at least half full by borrowing and merging.
+ */
+
+#ifndef DSC_BTREE_H
+#define DSC_BTREE_H
+
+#include <stdalign.h>
+#include <stddef.h>
+
+#include "../include/dsc_allocator.h"
+#include "../include/dsc_data.h"
+#include "../include/dsc_error.h"
+#include "../include/dsc_type.h"
+
+/**
+ * @brief The number of bytes of keys, values and child pointers a node is
+ *        sized for.
+ */
+#define DSC_BTREE_NODE_BYTES 512
+
+/**
+ * @brief The fewest and the most keys a node is made to hold.
+ */
+#define DSC_BTREE_MIN_FANOUT 4
+#define DSC_BTREE_MAX_FANOUT 1024
+
+/**
+ * @brief The deepest tree the insert and erase paths are recorded for.
+ *
+ * Every inner node but the root has at least three children, so this is
+ * far more than any tree that fits in memory needs.
+ */
+#define DSC_BTREE_MAX_HEIGHT 64
+
+typedef struct DSCBTreeNode DSCBTreeNode;
+
+struct DSCBTreeNode {
+    DSCBTreeNode *next; // The next leaf in key order, NULL for inner nodes
+    size_t count;       // The number of keys in the node
+    bool leaf;          // Whether the node is a leaf
+
+    // The keys, then the values of a leaf or the children of an inner node
+    alignas(max_align_t) unsigned char data[];
+};
+
+typedef struct DSCBTree DSCBTree;
+
+struct DSCBTree {
+    DSCBTreeNode *root;  // Never NULL; an empty tree is an empty leaf
+    DSCBTreeNode *first; // The leftmost leaf
+    size_t size;         // The number of entries in the tree
+    size_t height;       // The number of levels, 1 for a single leaf
+    DSCType key_type;    // The type of the keys
+    DSCType value_type;  // The type of the values, unknown for sets
+    DSCElementType key_element;   // The key stride, and callbacks of records
+    DSCElementType value_element; // The value stride (0 for sets) and callbacks
+    size_t leaf_capacity;   // The most entries a leaf holds
+    size_t inner_capacity;  // The most keys an inner node holds
+    size_t values_offset;   // Where the values of a leaf start in its data
+    size_t children_offset; // Where the children of an inner node start
+    size_t scratch_stride;  // The aligned size of one scratch key
+    unsigned char *scratch; // Room for a key, a separator and a value
+
+    // Source of the nodes and string copies
+    DSCAllocator allocator;
+};
+
+/**
+ * @brief Initialize a tree in place.
+ *
+ * @param tree The tree to initialize.
+ * @param key_type The type of the keys.
+ * @param key_element The record descriptor of DSC_TYPE_BYTES keys, ignored
+ *                    (and may be NULL) for every other key type. Its compare
+ *                    callback orders the keys.
+ * @param value_type The type of the values, or DSC_TYPE_UNKNOWN for a
+ *                   keys-only tree.
+ * @param value_element The record descriptor of DSC_TYPE_BYTES values,
+ *                      ignored (and may be NULL) for every other value type.
+ * @param allocator The allocator for the nodes and string copies, or NULL
+ *                  for the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_btree_init(DSCBTree *tree, DSCType key_type, const DSCElementType *key_element,
+                        DSCType value_type, const DSCElementType *value_element,
+                        const DSCAllocator *allocator);
+
+/**
+ * @brief Release every entry and node of a tree.
+ */
+void dsc_btree_deinit(DSCBTree *tree);
+
+/**
+ * @brief Remove every entry, keeping a single empty leaf.
+ */
+void dsc_btree_clear(DSCBTree *tree);
+
+/**
+ * @brief Compare two keys in the tree's order.
+ *
+ * Numbers compare by value with NaNs after every number, strings by strcmp
+ * and records by the descriptor's compare callback, or memcmp.
+ *
+ * @param lhs A key as stored: the value, a char * or the record.
+ * @param rhs Another key the same way.
+ */
+int dsc_btree_compare(const DSCBTree *tree, const void *lhs, const void *rhs);
+
+/**
+ * @brief Look up a key.
+ *
+ * @param key The key as stored (a char ** for strings, the record for
+ *            DSC_TYPE_BYTES).
+ * @param value Set to the key's value slot when it is found, NULL in
+ *              keys-only mode. May be NULL.
+ * @return true if the key is present, false otherwise.
+ */
+bool dsc_btree_find(const DSCBTree *tree, const void *key, void **value);
+
+/**
+ * @brief Insert a key and its value, copying strings and records.
+ *
+ * Every node a split needs is allocated before the tree is touched.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_ALREADY_EXISTS or DSC_ERROR_OUT_OF_MEMORY,
+ *         in which case the tree is unchanged.
+ */
+DSCError dsc_btree_insert(DSCBTree *tree, const void *key, const void *value);
+
+/**
+ * @brief Erase a key and its value. Never allocates.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_NOT_FOUND.
+ */
+DSCError dsc_btree_erase(DSCBTree *tree, const void *key);
+
+/**
+ * @brief Build the tree bottom-up from keys in strictly ascending order.
+ *
+ * The leaves are filled completely and every level above is built in one
+ * pass, in O(count) time.
+ *
+ * @param keys A contiguous array of count keys, key_element.size apart.
+ * @param values A contiguous array of count values, value_element.size
+ *               apart, or NULL in keys-only mode.
+ * @return DSC_ERROR_OK, DSC_ERROR_OUT_OF_MEMORY, or
+ *         DSC_ERROR_INVALID_ARGUMENT if the tree is not empty or the keys
+ *         are not strictly ascending. On failure the tree is unchanged.
+ */
+DSCError dsc_btree_load_sorted(DSCBTree *tree, const void *keys, const void *values,
+                               size_t count);
+
+/**
+ * @brief Find where a walk from a key starts.
+ *
+ * @param key The key to seek, or NULL for the first entry.
+ * @param upper false for the first key not less than key, true for the first
+ *              key greater than it.
+ * @param leaf Set to the leaf to start from.
+ * @param index Set to the position in the leaf, which may be past its last
+ *              entry; dsc_btree_next moves on to the next leaf then.
+ */
+void dsc_btree_seek(const DSCBTree *tree, const void *key, bool upper,
+                    const DSCBTreeNode **leaf, size_t *index);
+
+/**
+ * @brief Step to the next entry in key order.
+ *
+ * @param leaf The walk's leaf, advanced along the leaves.
+ * @param index The walk's position in the leaf, advanced past the entry.
+ * @param key Set to the entry's key, as dsc_element_view describes it.
+ * @param value Set to its value the same way, NULL in keys-only mode. May
+ *              be NULL.
+ * @return true if there was an entry, false at the end of the tree.
+ */
+bool dsc_btree_next(const DSCBTree *tree, const DSCBTreeNode **leaf, size_t *index,
+                    const void **key, const void **value);
+
+/**
+ * @brief The stored key of an entry a walk is positioned at, before
+ *        dsc_btree_next yields it, or NULL at the end of the tree.
+ */
+const void *dsc_btree_peek(const DSCBTree *tree, const DSCBTreeNode **leaf, size_t *index);
+
+/**
+ * @brief Copy a stored value out to a caller-provided pointer, strings with
+ *        malloc and records with the copy callback.
+ */
+DSCError dsc_btree_output(const DSCBTree *tree, const void *value, void *result);
+
+#endif  // DSC_BTREE_H
@@ -0,0 +1,68 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsc_cpu.h"
+
+/* The features DSC_SIMD leaves visible; unknown values cap nothing */
+static unsigned dsc_cpu_allowed(void) {
+    const char *cap = getenv("DSC_SIMD");
+
+    if (cap == NULL) {
+        return ~0u;
+    }
+
+    if (strcmp(cap, "baseline") == 0) {
+        return 0;
+    }
+
+    if (strcmp(cap, "avx2") == 0) {
+        return DSC_CPU_POPCNT | DSC_CPU_AVX2;
+    }
+
+    return ~0u;
+}
+
+unsigned dsc_cpu_features(void) {
+    unsigned features = 0;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // Constructors may run before the compiler's own probe has
+    __builtin_cpu_init();
+
+    // These also check that the OS saves the wider registers (XGETBV)
+    if (__builtin_cpu_supports("popcnt")) {
+        features |= DSC_CPU_POPCNT;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        features |= DSC_CPU_AVX2;
+    }
+
+    if (__builtin_cpu_supports("avx512f")) {
+        features |= DSC_CPU_AVX512F;
+    }
+
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        features |= DSC_CPU_AVX512VPOPCNTDQ;
+    }
+#endif
+
+    return features & dsc_cpu_allowed();
+}
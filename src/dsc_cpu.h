@@ -0,0 +1,55 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_cpu.h
+ * @brief Internal detection of the instruction sets the CPU offers.
+ *
+ * This header is not installed. The features are probed once, when the
+ * library is loaded, and the vectorized kernels pick their implementation
+ * from them there and then, so a single build runs at its best on every
+ * machine of a mixed fleet.
+ *
+ * Setting the DSC_SIMD environment variable caps what is reported:
+ * "baseline" hides every optional instruction set, "avx2" hides AVX-512.
+ * AArch64 needs no probing, since NEON is part of its baseline.
+ */
+
+#ifndef DSC_CPU_H
+#define DSC_CPU_H
+
+/**
+ * @brief The optional instruction sets the kernels can use.
+ */
+typedef enum DSCCpuFeature {
+    DSC_CPU_POPCNT = 1 << 0,           /** x86 popcnt. */
+    DSC_CPU_AVX2 = 1 << 1,             /** x86 AVX2. */
+    DSC_CPU_AVX512F = 1 << 2,          /** x86 AVX-512 Foundation. */
+    DSC_CPU_AVX512VPOPCNTDQ = 1 << 3   /** x86 AVX-512 vector popcount. */
+} DSCCpuFeature;
+
+/**
+ * @brief Probe the CPU, and the operating system's support for its wider
+ *        registers.
+ *
+ * Safe to call from a constructor.
+ *
+ * @return The DSCCpuFeature flags available, less any DSC_SIMD caps.
+ */
+unsigned dsc_cpu_features(void);
+
+#endif  // DSC_CPU_H
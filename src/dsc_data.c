@@ -15,27 +15,220 @@
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../include/dsc_data.h"
+#include "../include/dsc_utils.h"
+
+/* Record descriptors */
+
+bool dsc_element_invalid(const DSCElementType *element) {
+    return element == NULL || element->size == 0;
+}
+
+DSCElementType dsc_element_of(DSCType type) {
+    DSCElementType element = {dsc_size_of(type), NULL, NULL, NULL, NULL};
+
+    return element;
+}
+
+bool dsc_element_equal(const DSCElementType *lhs, const DSCElementType *rhs) {
+    return lhs->size == rhs->size && lhs->hash == rhs->hash && lhs->compare == rhs->compare &&
+           lhs->copy == rhs->copy && lhs->destroy == rhs->destroy;
+}
+
+uint64_t dsc_element_hash(const DSCElementType *element, const void *record,
+                          uint64_t seed) {
+    if (element->hash != NULL) {
+        return element->hash(record, seed);
+    }
+
+    return dsc_hash_bytes(record, element->size, seed);
+}
+
+int dsc_element_compare(const DSCElementType *element, const void *lhs,
+                        const void *rhs) {
+    if (element->compare != NULL) {
+        return element->compare(lhs, rhs);
+    }
+
+    return memcmp(lhs, rhs, element->size);
+}
+
+DSCError dsc_element_copy(const DSCElementType *element, void *dest,
+                          const void *src) {
+    if (element->copy != NULL) {
+        return element->copy(dest, src);
+    }
+
+    memcpy(dest, src, element->size);
+
+    return DSC_ERROR_OK;
+}
+
+void dsc_element_destroy(const DSCElementType *element, void *records,
+                         size_t count) {
+    if (element->destroy == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        element->destroy((unsigned char *) records + i * element->size);
+    }
+}
+
+const void *dsc_element_view(const void *slot, DSCType type) {
+    return type == DSC_TYPE_STRING ? *(char *const *) slot : slot;
+}
+
+/* Buffers */
+
+DSCError dsc_data_malloc(DSCData *data, DSCType type, size_t capacity,
+                         const DSCAllocator *allocator) {
+    if (data == NULL || dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Every array member of the union is a pointer, so one of them stands for all
+    return dsc_data_malloc_stride(data, dsc_size_of(type), capacity, allocator);
+}
+
+DSCError dsc_data_malloc_stride(DSCData *data, size_t elem_size, size_t capacity,
+                                const DSCAllocator *allocator) {
+    if (data == NULL || elem_size == 0) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (capacity > SIZE_MAX / elem_size) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    void *buffer = dsc_alloc(allocator, (capacity > 0 ? capacity : 1) * elem_size);
+    if (buffer == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    data->c_ptr = buffer;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_data_realloc(DSCData *data, DSCType type, size_t capacity,
+                          const DSCAllocator *allocator) {
+    if (data == NULL || dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_data_realloc_stride(data, dsc_size_of(type), capacity, allocator);
+}
+
+DSCError dsc_data_realloc_stride(DSCData *data, size_t elem_size, size_t capacity,
+                                 const DSCAllocator *allocator) {
+    if (data == NULL || elem_size == 0) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Keep at least one element so that realloc never frees the buffer
+    if (capacity > SIZE_MAX / elem_size) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    void *buffer = dsc_realloc(allocator, data->c_ptr, (capacity > 0 ? capacity : 1) * elem_size);
+    if (buffer == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    data->c_ptr = buffer;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_data_free(DSCData *data, DSCType type, size_t size,
+                       const DSCAllocator *allocator) {
+    if (data == NULL || dsc_type_invalid(type)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Allocators that release in bulk have nothing to walk
+    if (type == DSC_TYPE_STRING && dsc_allocator_frees(allocator)) {
+        for (size_t i = 0; i < size; ++i) {
+            dsc_free(allocator, data->s_ptr[i]);
+        }
+    }
+
+    dsc_free(allocator, data->c_ptr);
+    data->c_ptr = NULL;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_data_copy(DSCData *dest, void *src, DSCType type) {
+    if (dest == NULL || src == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            dest->b = *(bool *) src;
+            break;
+
+        case DSC_TYPE_CHAR:
+            dest->c = *(char *) src;
+            break;
+
+        case DSC_TYPE_INT:
+            dest->i = *(int *) src;
+            break;
+
+        case DSC_TYPE_FLOAT:
+            dest->f = *(float *) src;
+            break;
+
+        case DSC_TYPE_DOUBLE:
+            dest->d = *(double *) src;
+            break;
+
+        case DSC_TYPE_STRING:
+            dest->s = strdup(*(char **) src);
+            if (dest->s == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+            break;
+
+        default:
+            return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Three-way comparison without subtraction, which overflows for ints and
+ * truncates fractional differences for floats */
+#define DSC_COMPARE(a, b) (((a) > (b)) - ((a) < (b)))
+
+/* NaNs compare equal to each other and greater than every number */
+#define DSC_COMPARE_FLOAT(a, b) \
+    (isnan(a) || isnan(b) ? (isnan(a) != 0) - (isnan(b) != 0) : DSC_COMPARE(a, b))
 
 int dsc_compare(DSCData data1, void *data2, DSCType type) {
     switch (type) {
         case DSC_TYPE_BOOL:
-            return data1.b - *(bool *) data2;
+            return DSC_COMPARE(data1.b, *(bool *) data2);
 
         case DSC_TYPE_CHAR:
-            return data1.c - *(char *) data2;
+            return DSC_COMPARE(data1.c, *(char *) data2);
 
         case DSC_TYPE_INT:
-            return data1.i - *(int *) data2;
+            return DSC_COMPARE(data1.i, *(int *) data2);
 
         case DSC_TYPE_FLOAT:
-            return data1.f - *(float *) data2;
+            return DSC_COMPARE_FLOAT(data1.f, *(float *) data2);
 
         case DSC_TYPE_DOUBLE:
-            return data1.d - *(double *) data2;
+            return DSC_COMPARE_FLOAT(data1.d, *(double *) data2);
 
         case DSC_TYPE_STRING:
             return strcmp(data1.s, *(const char **) data2);
@@ -0,0 +1,807 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_deque.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
+struct DSCDeque {
+    DSCData data;    // The ring buffer of capacity slots
+    size_t head;     // Slot of the front element
+    size_t size;     // The number of elements currently in the deque
+    size_t capacity; // The number of slots, always a power of two
+    DSCType type;    // The type of the elements in the deque
+    DSCElementType element; // The element stride, and the callbacks of records
+    DSCGrowthPolicy growth; // How the capacity grows and shrinks
+    DSCAllocator allocator; // Source of the deque, its buffer and strings
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+};
+
+/* The slot of the element index places behind the front */
+static inline size_t dsc_deque_slot(const DSCDeque *deque, size_t index) {
+    return (deque->head + index) & (deque->capacity - 1);
+}
+
+static inline unsigned char *dsc_deque_record(const DSCDeque *deque, size_t slot) {
+    return (unsigned char *) deque->data.c_ptr + slot * deque->element.size;
+}
+
+/* The smallest power of two that is at least capacity (and at least 1), or 0
+ * if there is none */
+static size_t dsc_deque_round(size_t capacity) {
+    size_t rounded = 1;
+
+    while (rounded < capacity) {
+        if (rounded > SIZE_MAX / 2) {
+            return 0;
+        }
+
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+/* Whether elements can be copied in and out as raw bytes */
+static inline bool dsc_deque_trivial(const DSCDeque *deque) {
+    return deque->type != DSC_TYPE_STRING &&
+           (deque->type != DSC_TYPE_BYTES || deque->element.copy == NULL);
+}
+
+/* Copy count elements from src into the ring starting at a slot, wrapping
+ * once at the end of the buffer */
+static void dsc_deque_copy_in(DSCDeque *deque, size_t slot, const void *src, size_t count) {
+    size_t stride = deque->element.size;
+    size_t first = deque->capacity - slot;
+    if (first > count) {
+        first = count;
+    }
+
+    memcpy(dsc_deque_record(deque, slot), src, first * stride);
+    memcpy(deque->data.c_ptr, (const unsigned char *) src + first * stride,
+           (count - first) * stride);
+}
+
+/* Copy count elements out of the ring starting at a slot into dest */
+static void dsc_deque_copy_out(const DSCDeque *deque, size_t slot, void *dest, size_t count) {
+    size_t stride = deque->element.size;
+    size_t first = deque->capacity - slot;
+    if (first > count) {
+        first = count;
+    }
+
+    memcpy(dest, dsc_deque_record(deque, slot), first * stride);
+    memcpy((unsigned char *) dest + first * stride, deque->data.c_ptr,
+           (count - first) * stride);
+}
+
+/* Move the elements into a buffer of new_capacity >= size slots, a power of
+ * two, unwrapping the ring so that the front element lands in slot 0. */
+static DSCError dsc_deque_resize(DSCDeque *deque, size_t new_capacity) {
+    DSCData new_data;
+
+    DSCError error = dsc_data_malloc_stride(&new_data, deque->element.size, new_capacity,
+                                            &deque->allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    dsc_deque_copy_out(deque, deque->head, new_data.c_ptr, deque->size);
+    dsc_free(&deque->allocator, deque->data.c_ptr);
+
+    deque->data = new_data;
+    deque->head = 0;
+    deque->capacity = new_capacity;
+    DSC_STATS_REALLOC(&deque->stats);
+
+    return DSC_ERROR_OK;
+}
+
+/* Make room for needed elements, growing by the policy */
+static DSCError dsc_deque_grow(DSCDeque *deque, size_t needed) {
+    if (needed < deque->size) {
+        return DSC_ERROR_OUT_OF_MEMORY; // The size overflowed
+    }
+
+    if (needed <= deque->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = dsc_deque_round(dsc_growth_next(&deque->growth, deque->capacity,
+                                                          needed, deque->element.size));
+    if (new_capacity == 0) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    return dsc_deque_resize(deque, new_capacity);
+}
+
+/* Give memory back after a burst of pops; a failed shrink keeps the larger
+ * buffer */
+static void dsc_deque_shrink(DSCDeque *deque) {
+    size_t new_capacity = dsc_growth_shrink(&deque->growth, deque->size, deque->capacity,
+                                            DSC_DEQUE_INITIAL_CAPACITY,
+                                            deque->element.size);
+    if (new_capacity < deque->capacity) {
+        new_capacity = dsc_deque_round(new_capacity);
+    }
+
+    if (new_capacity < deque->capacity) {
+        dsc_deque_resize(deque, new_capacity);
+    }
+}
+
+/* Copy an element the caller passed into an empty slot */
+static DSCError dsc_deque_store(DSCDeque *deque, size_t slot, void *data) {
+    unsigned char *record = dsc_deque_record(deque, slot);
+
+    switch (deque->type) {
+        case DSC_TYPE_STRING: {
+            char *copy = dsc_strdup(&deque->allocator, *(char **) data);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            deque->data.s_ptr[slot] = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&deque->element, record, data);
+        }
+
+        default: {
+            memcpy(record, data, deque->element.size);
+            return DSC_ERROR_OK;
+        }
+    }
+}
+
+/* Move an element the caller passed into an empty slot, adopting strings */
+static DSCError dsc_deque_adopt(DSCDeque *deque, size_t slot, void *data) {
+    if (deque->type != DSC_TYPE_STRING) {
+        // Ownership of a record moves with its bytes
+        memcpy(dsc_deque_record(deque, slot), data, deque->element.size);
+        return DSC_ERROR_OK;
+    }
+
+    char *string = *(char **) data;
+    char *owned = dsc_allocator_adopt(&deque->allocator, string);
+    if (owned == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (owned != string) {
+        free(string);
+    }
+
+    deque->data.s_ptr[slot] = owned;
+
+    return DSC_ERROR_OK;
+}
+
+/* Copy the element in a slot out to the caller, strings with malloc */
+static DSCError dsc_deque_load(const DSCDeque *deque, size_t slot, void *result) {
+    const unsigned char *record = dsc_deque_record(deque, slot);
+
+    switch (deque->type) {
+        case DSC_TYPE_STRING: {
+            char *copy = strdup(deque->data.s_ptr[slot]);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) result = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&deque->element, result, record);
+        }
+
+        default: {
+            memcpy(result, record, deque->element.size);
+            return DSC_ERROR_OK;
+        }
+    }
+}
+
+/* Move the element in a slot out to the caller, leaving the slot empty */
+static DSCError dsc_deque_take(DSCDeque *deque, size_t slot, void *result) {
+    if (deque->type == DSC_TYPE_STRING) {
+        // Ownership of the string passes to the caller, who frees with free
+        char *string = dsc_allocator_export(&deque->allocator, deque->data.s_ptr[slot]);
+        if (string == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        *(char **) result = string;
+        deque->data.s_ptr[slot] = NULL;
+        return DSC_ERROR_OK;
+    }
+
+    // Ownership of a record moves with its bytes
+    memcpy(result, dsc_deque_record(deque, slot), deque->element.size);
+
+    return DSC_ERROR_OK;
+}
+
+/* Release count elements starting at a slot */
+static void dsc_deque_release(DSCDeque *deque, size_t slot, size_t count) {
+    if (deque->type == DSC_TYPE_STRING && dsc_allocator_frees(&deque->allocator)) {
+        for (size_t i = 0; i < count; ++i) {
+            dsc_free(&deque->allocator, deque->data.s_ptr[(slot + i) & (deque->capacity - 1)]);
+        }
+    }
+
+    if (deque->type == DSC_TYPE_BYTES && deque->element.destroy != NULL) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t index = (slot + i) & (deque->capacity - 1);
+            dsc_element_destroy(&deque->element, dsc_deque_record(deque, index), 1);
+        }
+    }
+}
+
+/* Copy count caller elements into the free slots starting at a slot */
+static DSCError dsc_deque_fill(DSCDeque *deque, size_t slot, void *data, size_t count) {
+    if (dsc_deque_trivial(deque)) {
+        dsc_deque_copy_in(deque, slot, data, count);
+        return DSC_ERROR_OK;
+    }
+
+    const unsigned char *elements = data;
+
+    for (size_t i = 0; i < count; ++i) {
+        DSCError error = dsc_deque_store(deque, (slot + i) & (deque->capacity - 1),
+                                         (void *) (elements + i * deque->element.size));
+        if (error != DSC_ERROR_OK) {
+            // Leave the deque as it was before the call
+            dsc_deque_release(deque, slot, i);
+            return error;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_init(DSCDeque **deque, DSCType type) {
+    return dsc_deque_init_allocator(deque, type, NULL);
+}
+
+static DSCError dsc_deque_create(DSCDeque **deque, DSCType type,
+                                 const DSCElementType *element,
+                                 const DSCAllocator *allocator) {
+    DSCDeque *new_deque = dsc_alloc(allocator, sizeof(DSCDeque));
+    if (new_deque == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_deque->head = 0;
+    new_deque->size = 0;
+    new_deque->capacity = DSC_DEQUE_INITIAL_CAPACITY;
+    new_deque->type = type;
+    new_deque->element = *element;
+    new_deque->growth = DSC_GROWTH_POLICY_DEFAULT;
+    new_deque->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_deque->stats, &new_deque->allocator);
+
+    DSCError error = dsc_data_malloc_stride(&new_deque->data, element->size,
+                                            new_deque->capacity, &new_deque->allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, new_deque);
+        return error;
+    }
+
+    *deque = new_deque;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_init_allocator(DSCDeque **deque, DSCType type,
+                                  const DSCAllocator *allocator) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_deque_create(deque, type, &element, allocator);
+}
+
+DSCError dsc_deque_init_bytes(DSCDeque **deque, const DSCElementType *element,
+                              const DSCAllocator *allocator) {
+    if (deque == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_deque_create(deque, DSC_TYPE_BYTES, element, allocator);
+}
+
+DSCError dsc_deque_deinit(DSCDeque *deque) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_deque_release(deque, deque->head, deque->size);
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = deque->allocator;
+
+    dsc_data_free(&deque->data, deque->type, 0, &allocator);
+    dsc_free(&allocator, deque);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_size(const DSCDeque *deque, size_t *size) {
+    if (deque == NULL || size == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *size = deque->size;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_capacity(const DSCDeque *deque, size_t *capacity) {
+    if (deque == NULL || capacity == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *capacity = deque->capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_empty(const DSCDeque *deque, bool *is_empty) {
+    if (deque == NULL || is_empty == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *is_empty = deque->size == 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_reserve(DSCDeque *deque, size_t count) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count <= deque->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = dsc_deque_round(count);
+    if (new_capacity == 0) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    return dsc_deque_resize(deque, new_capacity);
+}
+
+DSCError dsc_deque_shrink_to_fit(DSCDeque *deque) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t new_capacity = dsc_deque_round(deque->size);
+    if (new_capacity == deque->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_deque_resize(deque, new_capacity);
+}
+
+DSCError dsc_deque_set_growth(DSCDeque *deque, const DSCGrowthPolicy *policy) {
+    if (deque == NULL || dsc_growth_invalid(policy)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    deque->growth = *policy;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_at(const DSCDeque *deque, size_t index, void *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= deque->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    return dsc_deque_load(deque, dsc_deque_slot(deque, index), result);
+}
+
+DSCError dsc_deque_at_view(const DSCDeque *deque, size_t index, DSCStringView *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (index >= deque->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    result->data = deque->data.s_ptr[dsc_deque_slot(deque, index)];
+    result->length = strlen(result->data);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_front(const DSCDeque *deque, void *front) {
+    if (deque == NULL || front == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    return dsc_deque_load(deque, deque->head, front);
+}
+
+DSCError dsc_deque_back(const DSCDeque *deque, void *back) {
+    if (deque == NULL || back == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    return dsc_deque_load(deque, dsc_deque_slot(deque, deque->size - 1), back);
+}
+
+static DSCError dsc_deque_push_head(DSCDeque *deque, void *data, bool move) {
+    if (deque == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_deque_grow(deque, deque->size + 1);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t slot = (deque->head - 1) & (deque->capacity - 1);
+
+    error = move ? dsc_deque_adopt(deque, slot, data) : dsc_deque_store(deque, slot, data);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->head = slot;
+    deque->size++;
+
+    return DSC_ERROR_OK;
+}
+
+static DSCError dsc_deque_push_tail(DSCDeque *deque, void *data, bool move) {
+    if (deque == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_deque_grow(deque, deque->size + 1);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t slot = dsc_deque_slot(deque, deque->size);
+
+    error = move ? dsc_deque_adopt(deque, slot, data) : dsc_deque_store(deque, slot, data);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->size++;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_push_front(DSCDeque *deque, void *data) {
+    return dsc_deque_push_head(deque, data, false);
+}
+
+DSCError dsc_deque_push_front_move(DSCDeque *deque, void *data) {
+    return dsc_deque_push_head(deque, data, true);
+}
+
+DSCError dsc_deque_push_back(DSCDeque *deque, void *data) {
+    return dsc_deque_push_tail(deque, data, false);
+}
+
+DSCError dsc_deque_push_back_move(DSCDeque *deque, void *data) {
+    return dsc_deque_push_tail(deque, data, true);
+}
+
+DSCError dsc_deque_pop_front(DSCDeque *deque, void *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    DSCError error = dsc_deque_take(deque, deque->head, result);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->head = dsc_deque_slot(deque, 1);
+    deque->size--;
+    dsc_deque_shrink(deque);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_pop_back(DSCDeque *deque, void *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    DSCError error = dsc_deque_take(deque, dsc_deque_slot(deque, deque->size - 1), result);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->size--;
+    dsc_deque_shrink(deque);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_push_back_range(DSCDeque *deque, void *data, size_t count) {
+    if (deque == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_deque_grow(deque, deque->size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    error = dsc_deque_fill(deque, dsc_deque_slot(deque, deque->size), data, count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->size += count;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_push_front_range(DSCDeque *deque, void *data, size_t count) {
+    if (deque == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_deque_grow(deque, deque->size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    // The new front sits count slots before the old one, modulo the ring
+    size_t slot = (deque->head - count) & (deque->capacity - 1);
+
+    error = dsc_deque_fill(deque, slot, data, count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    deque->head = slot;
+    deque->size += count;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_pop_front_range(DSCDeque *deque, void *results, size_t count) {
+    if (deque == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count > deque->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    DSCError error = DSC_ERROR_OK;
+    size_t popped = count;
+
+    if (deque->type != DSC_TYPE_STRING) {
+        // Records move with their bytes, so every non-string type is one copy
+        dsc_deque_copy_out(deque, deque->head, results, count);
+    } else {
+        char **strings = results;
+
+        for (popped = 0; popped < count; ++popped) {
+            error = dsc_deque_take(deque, dsc_deque_slot(deque, popped), &strings[popped]);
+            if (error != DSC_ERROR_OK) {
+                break;
+            }
+        }
+    }
+
+    deque->head = dsc_deque_slot(deque, popped);
+    deque->size -= popped;
+    dsc_deque_shrink(deque);
+
+    return error;
+}
+
+DSCError dsc_deque_pop_back_range(DSCDeque *deque, void *results, size_t count) {
+    if (deque == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count > deque->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    DSCError error = DSC_ERROR_OK;
+    size_t start = deque->size - count;
+    size_t popped = count;
+
+    if (deque->type != DSC_TYPE_STRING) {
+        dsc_deque_copy_out(deque, dsc_deque_slot(deque, start), results, count);
+    } else {
+        char **strings = results;
+
+        // Hand over from the back so that a failure leaves no hole
+        for (popped = 0; popped < count; ++popped) {
+            size_t index = deque->size - 1 - popped;
+
+            error = dsc_deque_take(deque, dsc_deque_slot(deque, index),
+                                   &strings[index - start]);
+            if (error != DSC_ERROR_OK) {
+                break;
+            }
+        }
+    }
+
+    deque->size -= popped;
+    dsc_deque_shrink(deque);
+
+    return error;
+}
+
+DSCError dsc_deque_clear(DSCDeque *deque) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_deque_release(deque, deque->head, deque->size);
+
+    deque->head = 0;
+    deque->size = 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_swap(DSCDeque *deque, DSCDeque *other) {
+    if (deque == NULL || other == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (deque->type != other->type || !dsc_element_equal(&deque->element, &other->element) ||
+        !dsc_allocator_equal(&deque->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCData data = deque->data;
+    size_t head = deque->head;
+    size_t size = deque->size;
+    size_t capacity = deque->capacity;
+
+    deque->data = other->data;
+    deque->head = other->head;
+    deque->size = other->size;
+    deque->capacity = other->capacity;
+
+    other->data = data;
+    other->head = head;
+    other->size = size;
+    other->capacity = capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_deque_cursor_init(const DSCDeque *deque, DSCDequeCursor *cursor) {
+    if (deque == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    cursor->deque = deque;
+    cursor->index = 0;
+
+    return DSC_ERROR_OK;
+}
+
+bool dsc_deque_cursor_next(DSCDequeCursor *cursor, const void **element) {
+    const DSCDeque *deque = cursor->deque;
+
+    if (cursor->index >= deque->size) {
+        return false;
+    }
+
+    size_t slot = dsc_deque_slot(deque, cursor->index);
+    *element = dsc_element_view(dsc_deque_record(deque, slot), deque->type);
+    cursor->index++;
+
+    return true;
+}
+
+DSCError dsc_deque_for_each(const DSCDeque *deque, DSCVisitor visitor, void *context) {
+    if (deque == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < deque->size; ++i) {
+        size_t slot = dsc_deque_slot(deque, i);
+
+        if (!visitor(dsc_element_view(dsc_deque_record(deque, slot), deque->type), context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_deque_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_deque_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_deque_save(const DSCDeque *deque, const char *path) {
+    if (deque == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, deque->type, deque->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_deque_walk, deque);
+}
+
+DSCError dsc_deque_stats(const DSCDeque *deque, DSCStats *stats) {
+    if (deque == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(deque), stats);
+
+    return DSC_ERROR_OK;
+}
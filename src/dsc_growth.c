@@ -0,0 +1,73 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../include/dsc_growth.h"
+
+bool dsc_growth_invalid(const DSCGrowthPolicy *policy) {
+    if (policy == NULL || !(policy->factor > 1.0)) {
+        return true;
+    }
+
+    return policy->shrink_ratio < 0.0 || policy->shrink_ratio * policy->factor >= 1.0;
+}
+
+size_t dsc_growth_round(const DSCGrowthPolicy *policy, size_t capacity,
+                        size_t element_size) {
+    size_t bytes = capacity * element_size;
+
+    if (!policy->huge_pages || element_size == 0 || bytes < DSC_GROWTH_HUGE_PAGE_SIZE) {
+        return capacity;
+    }
+
+    // Whole huge pages let the kernel back the buffer with transparent huge pages
+    size_t pages = (bytes + DSC_GROWTH_HUGE_PAGE_SIZE - 1) / DSC_GROWTH_HUGE_PAGE_SIZE;
+
+    return pages * DSC_GROWTH_HUGE_PAGE_SIZE / element_size;
+}
+
+size_t dsc_growth_next(const DSCGrowthPolicy *policy, size_t capacity,
+                       size_t min_capacity, size_t element_size) {
+    size_t new_capacity = (size_t) (capacity * policy->factor);
+
+    if (new_capacity <= capacity) {
+        new_capacity = capacity + 1;
+    }
+
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+
+    return dsc_growth_round(policy, new_capacity, element_size);
+}
+
+size_t dsc_growth_shrink(const DSCGrowthPolicy *policy, size_t size,
+                         size_t capacity, size_t min_capacity,
+                         size_t element_size) {
+    if (policy->shrink_ratio == 0.0 || capacity <= min_capacity ||
+        size >= capacity * policy->shrink_ratio) {
+        return capacity;
+    }
+
+    size_t new_capacity = dsc_growth_round(policy, (size_t) (size * policy->factor),
+                                           element_size);
+
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+
+    return new_capacity < capacity ? new_capacity : capacity;
+}
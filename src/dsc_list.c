@@ -17,16 +17,30 @@
 
 #include "../include/dsc_list.h"
 
+#include <stdalign.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
 typedef struct DSCNode DSCNode;
 
+/* A record of a DSC_TYPE_BYTES list starts at data and may run past the end
+ * of the struct; such lists space their nodes node_size bytes apart. */
 struct DSCNode {
-    DSCData data;   // The data stored in the node
     DSCNode *prev;  // The previous node in the list
-    DSCNode *next;  // The next node in the list
+    DSCNode *next;  // The next node in the list, or the next free node
+    DSCData data;   // The data stored in the node
+};
+
+typedef struct DSCNodeChunk DSCNodeChunk;
+
+struct DSCNodeChunk {
+    DSCNodeChunk *next; // The chunk allocated before this one
+    alignas(max_align_t) unsigned char nodes[]; // Node slots, live or free
 };
 
 struct DSCList {
@@ -34,95 +48,183 @@ struct DSCList {
     DSCNode *tail;  // The last node in the list
     size_t size;    // The number of nodes currently in the list
     DSCType type;   // The type of the data stored in the list
+    DSCElementType element; // The callbacks of records
+    size_t node_size;       // The distance between two node slots
+    DSCAllocator allocator; // Source of the list, its chunks and strings
+    DSCNodeChunk *chunks;   // Every chunk of node slots owned by the list
+    DSCNode *free_nodes;    // Released slots, linked through next
+    size_t chunk_nodes;     // The number of slots in the next chunk
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
-static DSCError dsc_node_init(DSCNode *new_node, void *value, DSCType type) {
-    if (new_node == NULL || value == NULL) {
-        return DSC_ERROR_INVALID_ARGUMENT;
-    }
+/* Take a node slot, carving a new chunk once the free list runs dry. Chunks
+ * double in size so that a list of n nodes owns O(log n) of them. */
+static DSCNode *dsc_list_node_alloc(DSCList *list) {
+    if (list->free_nodes == NULL) {
+        if (list->node_size > (SIZE_MAX - sizeof(DSCNodeChunk)) / list->chunk_nodes) {
+            return NULL;
+        }
 
-    if (dsc_type_invalid(type)) {
-        return DSC_ERROR_INVALID_TYPE;
+        DSCNodeChunk *chunk = dsc_alloc(&list->allocator, sizeof(DSCNodeChunk) +
+                                                          list->chunk_nodes * list->node_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+
+        chunk->next = list->chunks;
+        list->chunks = chunk;
+
+        // Thread the slots back to front so they are handed out in address order
+        for (size_t i = list->chunk_nodes; i-- > 0; ) {
+            DSCNode *node = (DSCNode *) (void *) (chunk->nodes + i * list->node_size);
+            node->next = list->free_nodes;
+            list->free_nodes = node;
+        }
+
+        if (list->chunk_nodes < DSC_LIST_CHUNK_MAX_NODES) {
+            list->chunk_nodes *= 2;
+        }
     }
 
-    new_node = malloc(sizeof(DSCNode));
+    DSCNode *node = list->free_nodes;
+    list->free_nodes = node->next;
+
+    return node;
+}
+
+/* Fill a new node with a copy of value, or with value itself when moving */
+static DSCError dsc_node_init(DSCList *list, DSCNode **new_node, void *value, bool move) {
+    if (new_node == NULL || value == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-    if (new_node == NULL) {
+    DSCNode *node = dsc_list_node_alloc(list);
+    if (node == NULL) {
         return DSC_ERROR_OUT_OF_MEMORY;
     }
 
-    switch (type) {
+    switch (list->type) {
         case DSC_TYPE_BOOL:
-            new_node->data.b = *(bool *) value;
+            node->data.b = *(bool *) value;
             break;
 
         case DSC_TYPE_CHAR:
-            new_node->data.c = *(char *) value;
+            node->data.c = *(char *) value;
             break;
 
         case DSC_TYPE_INT:
-            new_node->data.i = *(int *) value;
+            node->data.i = *(int *) value;
             break;
 
         case DSC_TYPE_FLOAT:
-            new_node->data.f = *(float *) value;
+            node->data.f = *(float *) value;
             break;
 
         case DSC_TYPE_DOUBLE:
-            new_node->data.d = *(double *) value;
+            node->data.d = *(double *) value;
             break;
 
         case DSC_TYPE_STRING: {
-            const char *str = *(char **) value;
-            size_t str_size = strlen(str) + 1;
-
-            new_node->data.s = malloc(str_size);
-            if (new_node->data.s == NULL) {
-                free(new_node);
+            char *string = *(char **) value;
+            node->data.s = move ? dsc_allocator_adopt(&list->allocator, string)
+                                : dsc_strdup(&list->allocator, string);
+            if (node->data.s == NULL) {
+                node->next = list->free_nodes;
+                list->free_nodes = node;
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(new_node->data.s, value, str_size);
-            new_node->data.s[str_size] = '\0';
+            if (move && node->data.s != string) {
+                free(string);
+            }
+            break;
+        }
+
+        case DSC_TYPE_BYTES: {
+            if (move) {
+                // Ownership of the record moves with its bytes
+                memcpy(&node->data, value, list->element.size);
+                break;
+            }
+
+            DSCError error = dsc_element_copy(&list->element, &node->data, value);
+            if (error != DSC_ERROR_OK) {
+                node->next = list->free_nodes;
+                list->free_nodes = node;
+                return error;
+            }
             break;
         }
 
         default:
-            free(new_node);
-            return DSC_ERROR_OUT_OF_MEMORY;
+            node->next = list->free_nodes;
+            list->free_nodes = node;
+            return DSC_ERROR_INVALID_TYPE;
     }
 
-    new_node->prev = NULL;
-    new_node->next = NULL;
+    node->prev = NULL;
+    node->next = NULL;
+
+    *new_node = node;
 
     return DSC_ERROR_OK;
 }
 
-static DSCError dsc_node_deinit(DSCNode *node, DSCType type) {
+/* Return the slot of a node whose data has been released or handed over */
+static void dsc_node_release(DSCList *list, DSCNode *node) {
+    // The slot goes back to the list, never to the allocator
+    node->prev = NULL;
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+}
+
+static DSCError dsc_node_deinit(DSCList *list, DSCNode *node) {
     if (node == NULL) {
-        return DSC_ERROR_OUT_OF_MEMORY;
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    if (type == DSC_TYPE_STRING) {
-        free(node->data.s);
+    if (list->type == DSC_TYPE_STRING) {
+        dsc_free(&list->allocator, node->data.s);
         node->data.s = NULL;
     }
 
-    node->prev = NULL;
-    node->next = NULL;
+    if (list->type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&list->element, &node->data, 1);
+    }
 
-    free(node);
-    node = NULL;
+    dsc_node_release(list, node);
 
     return DSC_ERROR_OK;
 }
 
-DSCList *dsc_list_init(DSCType type) {
-    if (dsc_type_invalid(type)) {
-        return NULL;
+/* Find the node at a valid position, walking from whichever end is closer */
+static DSCNode *dsc_list_node_at(const DSCList *list, size_t position) {
+    DSCNode *curr;
+
+    if (position < list->size / 2) {
+        curr = list->head;
+        for (size_t i = 0; i < position; ++i) {
+            curr = curr->next;
+        }
+    } else {
+        curr = list->tail;
+        for (size_t i = list->size - 1; i > position; --i) {
+            curr = curr->prev;
+        }
     }
 
-    DSCList *list = malloc(sizeof(DSCList));
+    return curr;
+}
+
+DSCList *dsc_list_init(DSCType type) {
+    return dsc_list_init_allocator(type, NULL);
+}
+
+static DSCList *dsc_list_create(DSCType type, const DSCElementType *element,
+                                const DSCAllocator *allocator) {
+    DSCList *list = dsc_alloc(allocator, sizeof(DSCList));
     if (list == NULL) {
         return NULL;
     }
@@ -131,25 +233,76 @@ DSCList *dsc_list_init(DSCType type) {
     list->tail = NULL;
     list->size = 0;
     list->type = type;
+    list->element = *element;
+    list->node_size = sizeof(DSCNode);
+    list->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&list->stats, &list->allocator);
+    list->chunks = NULL;
+    list->free_nodes = NULL;
+    list->chunk_nodes = DSC_LIST_CHUNK_MIN_NODES;
+
+    // Records replace the data union, keeping every slot aligned for any type
+    if (type == DSC_TYPE_BYTES && element->size > sizeof(DSCData)) {
+        size_t align = alignof(max_align_t);
+        size_t size = offsetof(DSCNode, data) + element->size;
+
+        list->node_size = (size + align - 1) & ~(align - 1);
+    }
 
     return list;
 }
 
+DSCList *dsc_list_init_allocator(DSCType type, const DSCAllocator *allocator) {
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return NULL;
+    }
+
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_list_create(type, &element, allocator);
+}
+
+DSCList *dsc_list_init_bytes(const DSCElementType *element,
+                             const DSCAllocator *allocator) {
+    if (dsc_element_invalid(element)) {
+        return NULL;
+    }
+
+    return dsc_list_create(DSC_TYPE_BYTES, element, allocator);
+}
+
 DSCError dsc_list_deinit(DSCList *list) {
     if (list == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    DSCNode *curr = list->head;
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = list->allocator;
 
-    while (curr) {
-        DSCNode *next = curr->next;
-        dsc_node_deinit(curr, list->type);
-        curr = next;
+    // Records may own memory of their own, whatever the allocator
+    if (list->type == DSC_TYPE_BYTES && list->element.destroy != NULL) {
+        for (DSCNode *curr = list->head; curr; curr = curr->next) {
+            dsc_element_destroy(&list->element, &curr->data, 1);
+        }
     }
 
-    free(list);
-    list = NULL;
+    // Chunks of a bulk-release allocator go away with the allocator itself
+    if (dsc_allocator_frees(&allocator)) {
+        if (list->type == DSC_TYPE_STRING) {
+            for (DSCNode *curr = list->head; curr; curr = curr->next) {
+                dsc_free(&allocator, curr->data.s);
+            }
+        }
+
+        // Nodes live in the chunks, so there is nothing to free one by one
+        while (list->chunks != NULL) {
+            DSCNodeChunk *next = list->chunks->next;
+            dsc_free(&allocator, list->chunks);
+            list->chunks = next;
+        }
+    }
+
+    dsc_free(&allocator, list);
 
     return DSC_ERROR_OK;
 }
@@ -221,6 +374,9 @@ DSCError dsc_list_front(const DSCList *list, void *front) {
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(&list->element, front, &list->head->data);
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -275,6 +431,9 @@ DSCError dsc_list_back(const DSCList *list, void *back) {
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(&list->element, back, &list->tail->data);
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -338,6 +497,9 @@ DSCError dsc_list_at(const DSCList *list, size_t position, void *result) {
                     break;
                 }
 
+                case DSC_TYPE_BYTES:
+                    return dsc_element_copy(&list->element, result, &curr->data);
+
                 default:
                     return DSC_ERROR_INVALID_TYPE;
             }
@@ -353,15 +515,62 @@ DSCError dsc_list_at(const DSCList *list, size_t position, void *result) {
     return DSC_ERROR_OUT_OF_RANGE;
 }
 
-DSCError dsc_list_push_front(DSCList *list, void *to_push) {
+static DSCError dsc_list_view(const DSCNode *node, DSCStringView *result) {
+    result->data = node->data.s;
+    result->length = strlen(node->data.s);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_list_front_view(const DSCList *list, DSCStringView *result) {
+    return dsc_list_at_view(list, 0, result);
+}
+
+DSCError dsc_list_back_view(const DSCList *list, DSCStringView *result) {
+    if (list == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (list->type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (list->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    return dsc_list_view(list->tail, result);
+}
+
+DSCError dsc_list_at_view(const DSCList *list, size_t position, DSCStringView *result) {
+    if (list == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (list->type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (list->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    if (position >= list->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    return dsc_list_view(dsc_list_node_at(list, position), result);
+}
+
+static DSCError dsc_list_push_head(DSCList *list, void *to_push, bool move) {
     if (list == NULL || to_push == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
     DSCNode *new_head = NULL;
-    DSCError errno = dsc_node_init(new_head, to_push, list->type);
-    if (errno != DSC_ERROR_OK) {
-        return errno;
+    DSCError error = dsc_node_init(list, &new_head, to_push, move);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     if (list->size == 0) {
@@ -382,6 +591,14 @@ DSCError dsc_list_push_front(DSCList *list, void *to_push) {
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_list_push_front(DSCList *list, void *to_push) {
+    return dsc_list_push_head(list, to_push, false);
+}
+
+DSCError dsc_list_push_front_move(DSCList *list, void *to_push) {
+    return dsc_list_push_head(list, to_push, true);
+}
+
 DSCError dsc_list_pop_front(DSCList *list, void *result) {
     if (list == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -413,22 +630,25 @@ DSCError dsc_list_pop_front(DSCList *list, void *result) {
             break;
 
         case DSC_TYPE_STRING: {
-            const char *s = list->head->data.s;
-            size_t size = strlen(s);
-
-            char *temp = malloc(size + 1);
-            if (temp == NULL) {
+            // The node is going away, so hand its string over instead of
+            // copying it
+            char *s = dsc_allocator_export(&list->allocator, list->head->data.s);
+            if (s == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(temp, s, size);
-            temp[size] = '\0';
-
-            *(char **) result = temp;
+            list->head->data.s = NULL;
+            *(char **) result = s;
 
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            // Ownership of the record moves with its bytes, so the node must
+            // not destroy it
+            memcpy(result, &list->head->data, list->element.size);
+            break;
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -442,21 +662,21 @@ DSCError dsc_list_pop_front(DSCList *list, void *result) {
         list->tail = NULL;
     }
 
-    dsc_node_deinit(old_head, list->type);
+    dsc_node_release(list, old_head);
     list->size--;
 
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_list_push_back(DSCList *list, void *to_push) {
+static DSCError dsc_list_push_tail(DSCList *list, void *to_push, bool move) {
     if (list == NULL || to_push == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
     DSCNode *new_tail = NULL;
-    DSCError errno = dsc_node_init(new_tail, to_push, list->type);
-    if (errno != DSC_ERROR_OK) {
-        return errno;
+    DSCError error = dsc_node_init(list, &new_tail, to_push, move);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     if (list->size == 0) {
@@ -476,6 +696,14 @@ DSCError dsc_list_push_back(DSCList *list, void *to_push) {
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_list_push_back(DSCList *list, void *to_push) {
+    return dsc_list_push_tail(list, to_push, false);
+}
+
+DSCError dsc_list_push_back_move(DSCList *list, void *to_push) {
+    return dsc_list_push_tail(list, to_push, true);
+}
+
 DSCError dsc_list_pop_back(DSCList *list, void *result) {
     if (list == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -507,22 +735,25 @@ DSCError dsc_list_pop_back(DSCList *list, void *result) {
             break;
 
         case DSC_TYPE_STRING: {
-            const char *s = list->tail->data.s;
-            size_t size = strlen(s);
-
-            char *temp = malloc(size + 1);
-            if (temp == NULL) {
+            // The node is going away, so hand its string over instead of
+            // copying it
+            char *s = dsc_allocator_export(&list->allocator, list->tail->data.s);
+            if (s == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(temp, s, size);
-            temp[size] = '\0';
-
-            *(char **) result = temp;
+            list->tail->data.s = NULL;
+            *(char **) result = s;
 
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            // Ownership of the record moves with its bytes, so the node must
+            // not destroy it
+            memcpy(result, &list->tail->data, list->element.size);
+            break;
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -530,9 +761,14 @@ DSCError dsc_list_pop_back(DSCList *list, void *result) {
     DSCNode *old_tail = list->tail;
 
     list->tail = old_tail->prev;
-    list->tail->next = NULL;
 
-    dsc_node_deinit(old_tail, list->type);
+    if (list->tail) {
+        list->tail->next = NULL;
+    } else {
+        list->head = NULL;
+    }
+
+    dsc_node_release(list, old_tail);
 
     list->size--;
 
@@ -540,14 +776,10 @@ DSCError dsc_list_pop_back(DSCList *list, void *result) {
 }
 
 DSCError dsc_list_insert(DSCList *list, void *data, size_t position) {
-    if (list == NULL) {
+    if (list == NULL || data == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    if (dsc_size_of(list->type) != sizeof(*data)) {
-        return DSC_ERROR_INVALID_TYPE;
-    }
-
     if (position > list->size) {
         return DSC_ERROR_OUT_OF_RANGE;
     }
@@ -561,9 +793,9 @@ DSCError dsc_list_insert(DSCList *list, void *data, size_t position) {
     }
 
     DSCNode *new_node = NULL;
-    DSCError errno = dsc_node_init(new_node, data, list->type);
-    if (errno != DSC_ERROR_OK) {
-        return errno;
+    DSCError error = dsc_node_init(list, &new_node, data, false);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     size_t index = 0;
@@ -603,34 +835,172 @@ DSCError dsc_list_erase(DSCList *list, size_t position) {
         return DSC_ERROR_OUT_OF_RANGE;
     }
 
-    // Special case: erase the first element
-    if (position == 0) {
-        return dsc_list_pop_front(list, NULL);
+    DSCNode *curr = dsc_list_node_at(list, position);
+
+    if (curr->prev) {
+        curr->prev->next = curr->next;
+    } else {
+        list->head = curr->next;
     }
 
-    // Special case: erase the last element
-    if (position == list->size - 1) {
-        return dsc_list_pop_back(list, NULL);
+    if (curr->next) {
+        curr->next->prev = curr->prev;
+    } else {
+        list->tail = curr->prev;
     }
 
-    size_t index = 0;
+    dsc_node_deinit(list, curr);
+    list->size--;
+
+    return DSC_ERROR_OK;
+}
+
+static DSCError dsc_list_erase_matching(DSCList *list, DSCPredicate predicate, void *context,
+                                        size_t *removed, bool match) {
+    if (list == NULL || predicate == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t count = 0;
     DSCNode *curr = list->head;
 
-    while (curr) {
-        if (index == position) {
-            curr->prev->next = curr->next;
-            curr->next->prev = curr->prev;
+    while (curr != NULL) {
+        DSCNode *next = curr->next;
 
-            dsc_node_deinit(curr, list->type);
-            list->size--;
+        if (predicate(dsc_element_view(&curr->data, list->type), context) == match) {
+            if (curr->prev) {
+                curr->prev->next = next;
+            } else {
+                list->head = next;
+            }
 
-            return DSC_ERROR_OK;
+            if (next) {
+                next->prev = curr->prev;
+            } else {
+                list->tail = curr->prev;
+            }
+
+            dsc_node_deinit(list, curr);
+            count++;
         }
 
-        index++;
-        curr = curr->next;
+        curr = next;
     }
 
-    // Should never reach here
-    return DSC_ERROR_OUT_OF_RANGE;
+    list->size -= count;
+
+    if (removed != NULL) {
+        *removed = count;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_list_erase_if(DSCList *list, DSCPredicate predicate, void *context,
+                           size_t *removed) {
+    return dsc_list_erase_matching(list, predicate, context, removed, true);
+}
+
+DSCError dsc_list_retain(DSCList *list, DSCPredicate predicate, void *context,
+                         size_t *removed) {
+    return dsc_list_erase_matching(list, predicate, context, removed, false);
+}
+
+DSCError dsc_list_swap(DSCList *list, DSCList *other) {
+    if (list == NULL || other == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (list->type != other->type || !dsc_element_equal(&list->element, &other->element) ||
+        !dsc_allocator_equal(&list->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCNode *head = list->head;
+    DSCNode *tail = list->tail;
+    size_t size = list->size;
+    DSCNodeChunk *chunks = list->chunks;
+    DSCNode *free_nodes = list->free_nodes;
+    size_t chunk_nodes = list->chunk_nodes;
+
+    list->head = other->head;
+    list->tail = other->tail;
+    list->size = other->size;
+    list->chunks = other->chunks;
+    list->free_nodes = other->free_nodes;
+    list->chunk_nodes = other->chunk_nodes;
+
+    other->head = head;
+    other->tail = tail;
+    other->size = size;
+    other->chunks = chunks;
+    other->free_nodes = free_nodes;
+    other->chunk_nodes = chunk_nodes;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_list_cursor_init(const DSCList *list, DSCListCursor *cursor) {
+    if (list == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    cursor->list = list;
+    cursor->node = list->head;
+
+    return DSC_ERROR_OK;
+}
+
+bool dsc_list_cursor_next(DSCListCursor *cursor, const void **element) {
+    const DSCNode *node = cursor->node;
+
+    if (node == NULL) {
+        return false;
+    }
+
+    *element = dsc_element_view(&node->data, cursor->list->type);
+    cursor->node = node->next;
+
+    return true;
+}
+
+DSCError dsc_list_for_each(const DSCList *list, DSCVisitor visitor, void *context) {
+    if (list == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (const DSCNode *node = list->head; node != NULL; node = node->next) {
+        if (!visitor(dsc_element_view(&node->data, list->type), context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_list_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_list_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_list_save(const DSCList *list, const char *path) {
+    if (list == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, list->type, list->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_list_walk, list);
+}
+
+DSCError dsc_list_stats(const DSCList *list, DSCStats *stats) {
+    if (list == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(list), stats);
+
+    return DSC_ERROR_OK;
 }
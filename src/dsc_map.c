@@ -15,12 +15,25 @@
 * libdsc. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../include/dsc_map.h"
 #include "../include/dsc_utils.h"
+#include "dsc_parallel.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+#include "dsc_table.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DSC_MAP_PREFETCH(addr) __builtin_prefetch((addr), 0, 1)
+#else
+#define DSC_MAP_PREFETCH(addr) ((void) (addr))
+#endif
 
 typedef struct DSCMapEntry DSCMapEntry;
+typedef struct DSCMapShard DSCMapShard;
 
 struct DSCMapEntry {
    DSCData key;            // Key of the entry
@@ -28,603 +41,1285 @@ struct DSCMapEntry {
    DSCMapEntry *next;      // Pointer to the next entry in the same bucket
 };
 
+struct DSCMapShard {
+    pthread_rwlock_t lock;    // Shared by lookups, exclusive for updates
+    DSCTable table;           // The entries whose hash selects this shard
+    char pad[DSC_CACHE_LINE]; // Keeps the next shard's lock off this line
+};
+
 struct DSCMap {
-    DSCMapEntry **buckets; // Array of pointers to entries
-    size_t size;           // The number of elements currently in the hash map
-    size_t capacity;       // The current capacity of the hash map
+    DSCMapBackend backend; // The storage strategy chosen at init time
+    DSCMapEntry **buckets; // Chained: array of pointers to entries
+    size_t size;           // Chained: the number of elements in the hash map
+    size_t capacity;       // Chained: the current number of buckets
+    uint64_t seed;         // Chained and sharded: hash seed of this map
+    DSCTable table;        // Open: the shared open-addressing table
+    DSCMapShard *shards;   // Sharded: independently locked tables
+    size_t shard_count;    // Sharded: the number of shards, a power of two
+    unsigned shard_shift;  // Sharded: 64 - log2(shard_count)
     DSCType key_type;      // The type of the keys in the map
     DSCType value_type;    // The type of the values in the map
+    DSCElementType key_element;   // Size and callbacks of the keys
+    DSCElementType value_element; // Size and callbacks of the values
+    DSCAllocator allocator; // Source of the map, its entries and strings
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
-/* Helper method to rehash all the entries in the DSCMap when the load factor exceeds the threshold */
+/* Separate chaining backend */
+
+static DSCError dsc_map_chained_rehash(DSCMap *map, size_t new_capacity) {
+    DSC_STATS_TIMER(start);
 
-static bool dsc_map_rehash(DSCMap *map, size_t new_capacity) {
-   DSCMapEntry **new_buckets = calloc(new_capacity, sizeof(DSCMapEntry));
-   if (new_buckets == NULL) {
-       return false;
-   }
+    DSCMapEntry **new_buckets = dsc_calloc(&map->allocator, new_capacity, sizeof(DSCMapEntry *));
+    if (new_buckets == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    // Rehash all the elements into the new buckets
+    for (size_t i = 0; i < map->capacity; ++i) {
+        DSCMapEntry *entry = map->buckets[i];
 
-   // Rehash all the elements into the new buckets
-   for (size_t i = 0; i < map->capacity; ++i) {
-       DSCMapEntry *entry = map->buckets[i];
-       while (entry) {
+        while (entry) {
             DSCMapEntry *next = entry->next;
+            size_t index = dsc_hash_index(dsc_table_hash(entry->key, map->key_type, map->seed),
+                                          new_capacity);
+
+            entry->next = new_buckets[index];
+            new_buckets[index] = entry;
+            entry = next;
+        }
+    }
+
+    dsc_free(&map->allocator, map->buckets);
+    map->buckets = new_buckets;
+    map->capacity = new_capacity;
+
+    DSC_STATS_REHASH(DSC_STATS_OF(map), start);
+
+    return DSC_ERROR_OK;
+}
 
-            // Rehash the value to determine the new index
-            uint32_t index;
-            switch (map->key_type) {
-                case DSC_TYPE_CHAR: {
-                    index = dsc_hash(&entry->key.c, map->key_type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_INT: {
-                    index = dsc_hash(&entry->key.i, map->key_type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_FLOAT: {
-                    index = dsc_hash(&entry->key.f, map->key_type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_DOUBLE: {
-                    index = dsc_hash(&entry->key.d, map->key_type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_STRING: {
-                    index = dsc_hash(&entry->key.s, map->key_type, new_capacity);
-                    break;
-                }
-
-                default: {
-                    return false;
-                }
+static DSCMapEntry *dsc_map_chained_find(const DSCMap *map, DSCData key) {
+    size_t index = dsc_hash_index(dsc_table_hash(key, map->key_type, map->seed),
+                                  map->capacity);
+
+    size_t probe = 0;
+
+    for (DSCMapEntry *curr = map->buckets[index]; curr; curr = curr->next) {
+        probe++;
+        if (dsc_table_equal(curr->key, key, map->key_type)) {
+            DSC_STATS_PROBE(DSC_STATS_OF(map), probe);
+            return curr;
+        }
+    }
+
+    DSC_STATS_PROBE(DSC_STATS_OF(map), probe);
+
+    return NULL;
+}
+
+/* Take over the caller's strings for an entry; on failure the entry holds
+ * nothing and the caller keeps both */
+static DSCError dsc_map_chained_adopt(DSCMap *map, DSCMapEntry *entry, DSCData key,
+                                      DSCData value) {
+    entry->key = key;
+    entry->value = value;
+
+    if (map->key_type == DSC_TYPE_STRING) {
+        entry->key.s = dsc_allocator_adopt(&map->allocator, key.s);
+        if (entry->key.s == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    if (map->value_type == DSC_TYPE_STRING) {
+        entry->value.s = dsc_allocator_adopt(&map->allocator, value.s);
+        if (entry->value.s == NULL) {
+            if (map->key_type == DSC_TYPE_STRING && entry->key.s != key.s) {
+                dsc_free(&map->allocator, entry->key.s);
             }
 
-           entry->next = new_buckets[index];
-           new_buckets[index] = entry;
-           entry = next;
-       }
-   }
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    // Copies leave the caller's strings behind
+    if (map->key_type == DSC_TYPE_STRING && entry->key.s != key.s) {
+        free(key.s);
+    }
 
-   free(map->buckets);
-   map->buckets = new_buckets;
-   map->capacity = new_capacity;
+    if (map->value_type == DSC_TYPE_STRING && entry->value.s != value.s) {
+        free(value.s);
+    }
 
-   return true;
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_init(DSCMap *new_map, DSCType key_type, DSCType value_type) {
-    if (!dsc_type_is_valid(key_type) || !dsc_type_is_valid(value_type)) {
-        return DSC_ERROR_INVALID_TYPE;
+static DSCError dsc_map_chained_insert(DSCMap *map, DSCData key, DSCData value, bool move) {
+    if (dsc_map_chained_find(map, key) != NULL) {
+        return DSC_ERROR_ALREADY_EXISTS;
     }
 
-    new_map = malloc(sizeof new_map);
-    if (new_map == NULL) {
+    DSCMapEntry *new_entry = dsc_alloc(&map->allocator, sizeof(DSCMapEntry));
+    if (new_entry == NULL) {
         return DSC_ERROR_OUT_OF_MEMORY;
     }
 
-    new_map->buckets = calloc(new_map->capacity, sizeof(DSCMapEntry *));
-    if (new_map->buckets == NULL) {
-        free(new_map);
+    if (move) {
+        if (dsc_map_chained_adopt(map, new_entry, key, value) != DSC_ERROR_OK) {
+            dsc_free(&map->allocator, new_entry);
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    } else if (dsc_table_store(&new_entry->key, key, map->key_type,
+                               &map->allocator) != DSC_ERROR_OK) {
+        dsc_free(&map->allocator, new_entry);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    } else if (dsc_table_store(&new_entry->value, value, map->value_type,
+                               &map->allocator) != DSC_ERROR_OK) {
+        dsc_table_release(&new_entry->key, map->key_type, &map->allocator);
+        dsc_free(&map->allocator, new_entry);
         return DSC_ERROR_OUT_OF_MEMORY;
     }
-    
-    new_map->size = 0;
-    new_map->capacity = DSC_MAP_INITIAL_CAPACITY;
-    new_map->key_type = key_type;
-    new_map->value_type = value_type;
-    
-    return new_map;
+
+    // Insert the entry into the appropriate bucket
+    size_t index = dsc_hash_index(dsc_table_hash(key, map->key_type, map->seed),
+                                  map->capacity);
+
+    new_entry->next = map->buckets[index];
+    map->buckets[index] = new_entry;
+    map->size++;
+
+    // Rehash if the load factor exceeds the threshold
+    if (map->size >= DSC_MAP_LOAD_FACTOR * map->capacity) {
+        dsc_map_chained_rehash(map, map->capacity * 2);
+    }
+
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_deinit(DSCMap *map) {
-    if (map == NULL) {
-        return DSC_ERROR_INVALID_ARGUMENT;
+static DSCError dsc_map_chained_erase(DSCMap *map, DSCData key) {
+    size_t index = dsc_hash_index(dsc_table_hash(key, map->key_type, map->seed),
+                                  map->capacity);
+
+    DSCMapEntry *prev = NULL;
+    DSCMapEntry *curr = map->buckets[index];
+
+    while (curr != NULL) {
+        if (dsc_table_equal(curr->key, key, map->key_type)) {
+            if (prev == NULL) {
+                map->buckets[index] = curr->next;
+            } else {
+                prev->next = curr->next;
+            }
+
+            dsc_table_release(&curr->key, map->key_type, &map->allocator);
+            dsc_table_release(&curr->value, map->value_type, &map->allocator);
+            dsc_free(&map->allocator, curr);
+            map->size--;
+
+            return DSC_ERROR_OK;
+        }
+
+        prev = curr;
+        curr = curr->next;
     }
-    
+
+    return DSC_ERROR_NOT_FOUND;
+}
+
+static size_t dsc_map_chained_erase_if(DSCMap *map, DSCMapPredicate predicate, void *context,
+                                       bool match) {
+    size_t removed = 0;
+
+    for (size_t i = 0; i < map->capacity; ++i) {
+        DSCMapEntry **link = &map->buckets[i];
+
+        while (*link != NULL) {
+            DSCMapEntry *curr = *link;
+
+            if (predicate(dsc_element_view(&curr->key, map->key_type),
+                          dsc_element_view(&curr->value, map->value_type), context) != match) {
+                link = &curr->next;
+                continue;
+            }
+
+            *link = curr->next;
+
+            dsc_table_release(&curr->key, map->key_type, &map->allocator);
+            dsc_table_release(&curr->value, map->value_type, &map->allocator);
+            dsc_free(&map->allocator, curr);
+            removed++;
+        }
+    }
+
+    map->size -= removed;
+
+    // Fewer buckets once the chains are mostly empty; a failed rehash keeps
+    // the larger array, which is harmless
+    size_t new_capacity = map->capacity;
+    while (new_capacity > DSC_MAP_INITIAL_CAPACITY &&
+           map->size < DSC_MAP_LOAD_FACTOR * new_capacity / DSC_TABLE_SHRINK_LOAD) {
+        new_capacity /= 2;
+    }
+
+    if (new_capacity < map->capacity) {
+        dsc_map_chained_rehash(map, new_capacity);
+    }
+
+    return removed;
+}
+
+/* Resolve up to DSC_TABLE_BATCH_WINDOW keys. The bucket heads are prefetched
+ * first, then the head entries, so only the chain tails miss serially. */
+static void dsc_map_chained_find_window(const DSCMap *map, void *keys,
+                                        size_t count, DSCMapEntry **entries) {
+    size_t stride = dsc_size_of(map->key_type);
+    DSCData window[DSC_TABLE_BATCH_WINDOW];
+    size_t indices[DSC_TABLE_BATCH_WINDOW];
+
+    for (size_t i = 0; i < count; ++i) {
+        window[i] = dsc_table_load((char *) keys + i * stride, map->key_type);
+        indices[i] = dsc_hash_index(dsc_table_hash(window[i], map->key_type, map->seed),
+                                    map->capacity);
+        DSC_MAP_PREFETCH(&map->buckets[indices[i]]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        entries[i] = map->buckets[indices[i]];
+        if (entries[i] != NULL) {
+            DSC_MAP_PREFETCH(entries[i]);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        DSCMapEntry *curr = entries[i];
+
+        while (curr != NULL && !dsc_table_equal(curr->key, window[i], map->key_type)) {
+            curr = curr->next;
+        }
+
+        entries[i] = curr;
+    }
+}
+
+static void dsc_map_chained_clear(DSCMap *map) {
+    // Entries of a bulk-release allocator are simply abandoned
+    if (!dsc_allocator_frees(&map->allocator)) {
+        memset(map->buckets, 0, map->capacity * sizeof(DSCMapEntry *));
+        return;
+    }
+
     for (size_t i = 0; i < map->capacity; ++i) {
         DSCMapEntry *curr = map->buckets[i];
 
         while (curr != NULL) {
             DSCMapEntry *next = curr->next;
 
-            if (map->key_type == DSC_TYPE_STRING) {
-                free(curr->key.s);
+            dsc_table_release(&curr->key, map->key_type, &map->allocator);
+            dsc_table_release(&curr->value, map->value_type, &map->allocator);
+            dsc_free(&map->allocator, curr);
+
+            curr = next;
+        }
+
+        map->buckets[i] = NULL;
+    }
+}
+
+/* Sharded backend */
+
+static inline size_t dsc_map_shard_index(const DSCMap *map, DSCData key) {
+    // The high bits pick the shard; the shard's table hashes with its own seed
+    uint64_t hash = dsc_table_hash(key, map->key_type, map->seed);
+    return map->shard_count > 1 ? (size_t) (hash >> map->shard_shift) : 0;
+}
+
+static inline DSCMapShard *dsc_map_shard(const DSCMap *map, DSCData key) {
+    return &map->shards[dsc_map_shard_index(map, key)];
+}
+
+static void dsc_map_sharded_destroy(DSCMap *map, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dsc_table_deinit(&map->shards[i].table);
+        pthread_rwlock_destroy(&map->shards[i].lock);
+    }
+
+    dsc_free(&map->allocator, map->shards);
+    map->shards = NULL;
+}
+
+static DSCError dsc_map_sharded_init(DSCMap *map, size_t shard_count) {
+    size_t count = 1;
+    unsigned bits = 0;
+
+    while (count < shard_count) {
+        if (count > SIZE_MAX / 2 / sizeof(DSCMapShard)) {
+            return DSC_ERROR_INVALID_ARGUMENT;
+        }
+
+        count *= 2;
+        bits++;
+    }
+
+    map->shards = dsc_alloc(&map->allocator, count * sizeof(DSCMapShard));
+    if (map->shards == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    map->shard_count = count;
+    map->shard_shift = 64 - bits;
+    map->seed = dsc_hash_seed();
+
+    for (size_t i = 0; i < count; ++i) {
+        DSCMapShard *shard = &map->shards[i];
+
+        if (pthread_rwlock_init(&shard->lock, NULL) != 0) {
+            dsc_map_sharded_destroy(map, i);
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        DSCError error = dsc_table_init(&shard->table, map->key_type, NULL, map->value_type,
+                                        NULL, DSC_MAP_INITIAL_CAPACITY, &map->allocator);
+        if (error != DSC_ERROR_OK) {
+            pthread_rwlock_destroy(&shard->lock);
+            dsc_map_sharded_destroy(map, i);
+            return error;
+        }
+
+#ifdef DSC_STATS
+        shard->table.stats = &map->stats;
+#endif
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Public API */
+
+DSCError dsc_map_init(DSCMap **new_map, DSCType key_type, DSCType value_type) {
+    return dsc_map_init_backend(new_map, key_type, value_type, DSC_MAP_BACKEND_CHAINED);
+}
+
+DSCError dsc_map_init_backend(DSCMap **new_map, DSCType key_type,
+                              DSCType value_type, DSCMapBackend backend) {
+    return dsc_map_init_allocator(new_map, key_type, value_type, backend, NULL);
+}
+
+static DSCError dsc_map_create(DSCMap **new_map, DSCType key_type,
+                               const DSCElementType *key_element, DSCType value_type,
+                               const DSCElementType *value_element,
+                               DSCMapBackend backend, size_t shard_count,
+                               const DSCAllocator *allocator) {
+    DSCMap *map = dsc_calloc(allocator, 1, sizeof(DSCMap));
+    if (map == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    map->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&map->stats, &map->allocator);
+    map->backend = backend;
+    map->size = 0;
+    map->key_type = key_type;
+    map->value_type = value_type;
+    map->key_element = key_type == DSC_TYPE_BYTES ? *key_element : dsc_element_of(key_type);
+    map->value_element = value_type == DSC_TYPE_BYTES ? *value_element
+                                                      : dsc_element_of(value_type);
+
+    switch (backend) {
+        case DSC_MAP_BACKEND_CHAINED: {
+            map->capacity = DSC_MAP_INITIAL_CAPACITY;
+            map->seed = dsc_hash_seed();
+            map->buckets = dsc_calloc(&map->allocator, map->capacity, sizeof(DSCMapEntry *));
+            if (map->buckets == NULL) {
+                dsc_free(allocator, map);
+                return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            if (map->value_type == DSC_TYPE_STRING) {
-                free(curr->value.s);
+            break;
+        }
+
+        case DSC_MAP_BACKEND_OPEN: {
+            DSCError error = dsc_table_init(&map->table, key_type, key_element, value_type,
+                                            value_element, DSC_MAP_INITIAL_CAPACITY,
+                                            &map->allocator);
+            if (error != DSC_ERROR_OK) {
+                dsc_free(allocator, map);
+                return error;
             }
 
-            free(curr);
-            curr = next;
+#ifdef DSC_STATS
+            map->table.stats = &map->stats;
+#endif
+
+            break;
+        }
+
+        case DSC_MAP_BACKEND_SHARDED: {
+            DSCError error = dsc_map_sharded_init(map, shard_count);
+            if (error != DSC_ERROR_OK) {
+                dsc_free(allocator, map);
+                return error;
+            }
+
+            break;
+        }
+
+        default: {
+            dsc_free(allocator, map);
+            return DSC_ERROR_INVALID_ARGUMENT;
         }
     }
-    
-    free(map->buckets);
-    free(map);
+
+    *new_map = map;
 
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_size(const DSCMap *map, size_t *size) {
+DSCError dsc_map_init_allocator(DSCMap **new_map, DSCType key_type,
+                                DSCType value_type, DSCMapBackend backend,
+                                const DSCAllocator *allocator) {
+    if (new_map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(key_type) || dsc_type_invalid(value_type) ||
+        key_type == DSC_TYPE_BYTES || value_type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return dsc_map_create(new_map, key_type, NULL, value_type, NULL, backend,
+                          DSC_MAP_SHARDS, allocator);
+}
+
+DSCError dsc_map_init_bytes(DSCMap **new_map, DSCType key_type,
+                            const DSCElementType *key_element, DSCType value_type,
+                            const DSCElementType *value_element,
+                            const DSCAllocator *allocator) {
+    if (new_map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(key_type) || dsc_type_invalid(value_type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if ((key_type == DSC_TYPE_BYTES && dsc_element_invalid(key_element)) ||
+        (value_type == DSC_TYPE_BYTES && dsc_element_invalid(value_element))) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only the open backend keeps elements in slots sized per map
+    return dsc_map_create(new_map, key_type, key_element, value_type, value_element,
+                          DSC_MAP_BACKEND_OPEN, 0, allocator);
+}
+
+DSCError dsc_map_init_sharded(DSCMap **new_map, DSCType key_type,
+                              DSCType value_type, size_t shard_count,
+                              const DSCAllocator *allocator) {
+    if (new_map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(key_type) || dsc_type_invalid(value_type) ||
+        key_type == DSC_TYPE_BYTES || value_type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return dsc_map_create(new_map, key_type, NULL, value_type, NULL, DSC_MAP_BACKEND_SHARDED,
+                          shard_count > 0 ? shard_count : DSC_MAP_SHARDS, allocator);
+}
+
+DSCError dsc_map_incremental_rehash(DSCMap *map, bool enabled) {
+    if (map == NULL || map->backend == DSC_MAP_BACKEND_CHAINED) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_wrlock(&map->shards[i].lock);
+            dsc_table_set_incremental(&map->shards[i].table, enabled);
+            pthread_rwlock_unlock(&map->shards[i].lock);
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    dsc_table_set_incremental(&map->table, enabled);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_map_use_string_pool(DSCMap *map, DSCStringPool *pool) {
+    if (map == NULL || pool == NULL || map->backend != DSC_MAP_BACKEND_OPEN) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_table_set_pool(&map->table, pool);
+}
+
+DSCError dsc_map_deinit(DSCMap *map) {
     if (map == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    *size = map->size;
-    
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        dsc_table_deinit(&map->table);
+    } else if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        dsc_map_sharded_destroy(map, map->shard_count);
+    } else {
+        dsc_map_chained_clear(map);
+        dsc_free(&map->allocator, map->buckets);
+    }
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = map->allocator;
+    dsc_free(&allocator, map);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_map_size(const DSCMap *map, size_t *size) {
+    if (map == NULL || size == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        *size = 0;
+
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_rdlock(&map->shards[i].lock);
+            *size += map->shards[i].table.size;
+            pthread_rwlock_unlock(&map->shards[i].lock);
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    *size = map->backend == DSC_MAP_BACKEND_OPEN ? map->table.size : map->size;
+
     return DSC_ERROR_OK;
 }
 
 DSCError dsc_map_capacity(const DSCMap *map, size_t *capacity) {
-    if (map == NULL) {
+    if (map == NULL || capacity == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    *capacity = map->capacity;
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        *capacity = 0;
+
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_rdlock(&map->shards[i].lock);
+            *capacity += map->shards[i].table.capacity;
+            pthread_rwlock_unlock(&map->shards[i].lock);
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    *capacity = map->backend == DSC_MAP_BACKEND_OPEN ? map->table.capacity : map->capacity;
 
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_is_empty(const DSCMap *map, bool *is_empty) {
-    if (map == NULL) {
+DSCError dsc_map_empty(const DSCMap *map, bool *is_empty) {
+    if (map == NULL || is_empty == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    *is_empty = map->size == 0;
-    
+
+    size_t size;
+    dsc_map_size(map, &size);
+
+    *is_empty = size == 0;
+
     return DSC_ERROR_OK;
 }
 
+/* Write a stored value out to the caller, copying strings and records */
+static DSCError dsc_map_output(const DSCMap *map, const void *slot, void *value) {
+    if (map->value_type == DSC_TYPE_BYTES) {
+        return dsc_element_copy(&map->value_element, value, slot);
+    }
+
+    return dsc_table_output(*(const DSCData *) slot, value, map->value_type);
+}
+
 DSCError dsc_map_get(const DSCMap *map, void *key, void *value) {
-    if (map == NULL || key == NULL) {
+    if (map == NULL || key == NULL || value == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    uint32_t index = dsc_hash(key, map->key_type, map->capacity);
-    
-    DSCMapEntry *curr = map->buckets[index];
-    
-    while (curr != NULL) {
-        switch (map->key_type) {
-            case DSC_TYPE_CHAR: {
-                if (curr->key.c == *(char *) key) {
-                    *(char *) value = curr->value.c;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
 
-            case DSC_TYPE_INT: {
-                if (curr->key.i == *(int *) key) {
-                    *(int *) value = curr->value.i;
-                    return DSC_ERROR_OK;
-                }
+    DSCData needle = dsc_table_load(key, map->key_type);
 
-                break;
-            }
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        void *found;
+        if (!dsc_table_find(&map->table, needle, &found)) {
+            return DSC_ERROR_NOT_FOUND;
+        }
 
-            case DSC_TYPE_FLOAT: {
-                if (curr->key.f == *(float *) key) {
-                    *(float *) value = curr->value.f;
-                    return DSC_ERROR_OK;
-                }
+        return dsc_map_output(map, found, value);
+    }
 
-                break;
-            }
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        DSCMapShard *shard = dsc_map_shard(map, needle);
+        void *found;
 
-            case DSC_TYPE_DOUBLE: {
-                if (curr->key.d == *(double *) key) {
-                    *(double *) value = curr->value.d;
-                    return DSC_ERROR_OK;
-                }
+        // Lookups never migrate slots, so readers can share the shard
+        pthread_rwlock_rdlock(&shard->lock);
+        DSCError error = dsc_table_find(&shard->table, needle, &found)
+                             ? dsc_map_output(map, found, value)
+                             : DSC_ERROR_NOT_FOUND;
+        pthread_rwlock_unlock(&shard->lock);
 
-                break;
-            }
+        return error;
+    }
 
-            case DSC_TYPE_STRING: {
-                if (strcmp(curr->key.s, *(char **) key) == 0) {
-                    const char *string = curr->value.s;
-                    size_t string_size = strlen(string) + 1;
-                    size_t key_size = strlen(*(char **) key) + 1;
-
-                    if (string_size > key_size) {
-                        *(char **) value = malloc(string_size);
-                        if (*(char **) value == NULL) {
-                            return DSC_ERROR_OUT_OF_MEMORY;
-                        }
-                    }
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
+    DSCMapEntry *entry = dsc_map_chained_find(map, needle);
+    if (entry == NULL) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    return dsc_table_output(entry->value, value, map->value_type);
+}
+
+DSCError dsc_map_get_view(const DSCMap *map, void *key, DSCStringView *result) {
+    if (map == NULL || key == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->value_type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCData needle = dsc_table_load(key, map->key_type);
+    const DSCData *found;
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        void *slot;
+        if (!dsc_table_find(&map->table, needle, &slot)) {
+            return DSC_ERROR_NOT_FOUND;
         }
-        
-        curr = curr->next;
+
+        found = slot;
+    } else if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        DSCMapShard *shard = dsc_map_shard(map, needle);
+        void *slot;
+
+        // Read the slot before a writer on this shard can free or move it
+        pthread_rwlock_rdlock(&shard->lock);
+        bool present = dsc_table_find(&shard->table, needle, &slot);
+        if (present) {
+            found = slot;
+            result->data = found->s;
+            result->length = strlen(found->s);
+        }
+        pthread_rwlock_unlock(&shard->lock);
+
+        return present ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND;
+    } else {
+        DSCMapEntry *entry = dsc_map_chained_find(map, needle);
+        if (entry == NULL) {
+            return DSC_ERROR_NOT_FOUND;
+        }
+
+        found = &entry->value;
     }
-    
-    return DSC_ERROR_NOT_FOUND;
+
+    result->data = found->s;
+    result->length = strlen(found->s);
+
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_insert(DSCMap *map, void *key, void *value) {
+static DSCError dsc_map_put(DSCMap *map, void *key, void *value, bool move) {
     if (map == NULL || key == NULL || value == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    // Check if the key already exists
-    uint32_t index = dsc_hash(key, map->key_type, map->capacity);
 
-    DSCMapEntry *curr = map->buckets[index];
-    while (curr != NULL) {
-        switch (map->key_type) {
-            case DSC_TYPE_CHAR: {
-                if (curr->key.c == *(char *) key) {
-                    return DSC_ERROR_ALREADY_EXISTS;
-                }
+    DSCData new_key = dsc_table_load(key, map->key_type);
+    DSCData new_value = dsc_table_load(value, map->value_type);
 
-                break;
-            }
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        return move ? dsc_table_insert_move(&map->table, new_key, new_value)
+                    : dsc_table_insert(&map->table, new_key, new_value);
+    }
 
-            case DSC_TYPE_INT: {
-                if (curr->key.i == *(int *) key) {
-                    return DSC_ERROR_ALREADY_EXISTS;
-                }
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        DSCMapShard *shard = dsc_map_shard(map, new_key);
 
-                break;
-            }
+        pthread_rwlock_wrlock(&shard->lock);
+        DSCError error = move ? dsc_table_insert_move(&shard->table, new_key, new_value)
+                              : dsc_table_insert(&shard->table, new_key, new_value);
+        pthread_rwlock_unlock(&shard->lock);
 
-            case DSC_TYPE_FLOAT: {
-                if (curr->key.f == *(float *) key) {
-                    return DSC_ERROR_ALREADY_EXISTS;
-                }
+        return error;
+    }
 
-                break;
-            }
+    return dsc_map_chained_insert(map, new_key, new_value, move);
+}
 
-            case DSC_TYPE_DOUBLE: {
-                if (curr->key.d == *(double *) key) {
-                    return DSC_ERROR_ALREADY_EXISTS;
-                }
+DSCError dsc_map_insert(DSCMap *map, void *key, void *value) {
+    return dsc_map_put(map, key, value, false);
+}
 
-                break;
-            }
+DSCError dsc_map_insert_move(DSCMap *map, void *key, void *value) {
+    return dsc_map_put(map, key, value, true);
+}
 
-            case DSC_TYPE_STRING: {
-                if (strcmp(curr->key.s, *(char **) key) == 0) {
-                    return DSC_ERROR_ALREADY_EXISTS;
-                }
+DSCError dsc_map_erase(DSCMap *map, void *key) {
+    if (map == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-                break;
-            }
+    DSCData needle = dsc_table_load(key, map->key_type);
 
-            default: {
-                return DSC_ERROR_INVALID_TYPE;
-            }
-        }
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        return dsc_table_erase(&map->table, needle);
+    }
 
-        curr = curr->next;
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        DSCMapShard *shard = dsc_map_shard(map, needle);
+
+        pthread_rwlock_wrlock(&shard->lock);
+        DSCError error = dsc_table_erase(&shard->table, needle);
+        pthread_rwlock_unlock(&shard->lock);
+
+        return error;
     }
-    
-    // Create a new entry
-    DSCMapEntry *new_entry = malloc(sizeof new_entry);
-    if (new_entry == NULL) {
-        return DSC_ERROR_OUT_OF_MEMORY;
+
+    return dsc_map_chained_erase(map, needle);
+}
+
+static DSCError dsc_map_erase_matching(DSCMap *map, DSCMapPredicate predicate, void *context,
+                                       size_t *removed, bool match) {
+    if (map == NULL || predicate == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    switch (map->key_type) {
-        case DSC_TYPE_CHAR: {
-            new_entry->key.c = *(char *) key;
-            break;
+
+    size_t count = 0;
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        count = dsc_table_erase_if(&map->table, predicate, context, match);
+    } else if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_wrlock(&map->shards[i].lock);
+            count += dsc_table_erase_if(&map->shards[i].table, predicate, context, match);
+            pthread_rwlock_unlock(&map->shards[i].lock);
         }
+    } else {
+        count = dsc_map_chained_erase_if(map, predicate, context, match);
+    }
 
-        case DSC_TYPE_INT: {
-            new_entry->key.i = *(int *) key;
-            break;
+    if (removed != NULL) {
+        *removed = count;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_map_erase_if(DSCMap *map, DSCMapPredicate predicate, void *context,
+                          size_t *removed) {
+    return dsc_map_erase_matching(map, predicate, context, removed, true);
+}
+
+DSCError dsc_map_retain(DSCMap *map, DSCMapPredicate predicate, void *context,
+                        size_t *removed) {
+    return dsc_map_erase_matching(map, predicate, context, removed, false);
+}
+
+DSCError dsc_map_contains(const DSCMap *map, void *key, bool *contains) {
+    if (map == NULL || key == NULL || contains == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCData needle = dsc_table_load(key, map->key_type);
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        *contains = dsc_table_find(&map->table, needle, NULL);
+    } else if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        DSCMapShard *shard = dsc_map_shard(map, needle);
+
+        pthread_rwlock_rdlock(&shard->lock);
+        *contains = dsc_table_find(&shard->table, needle, NULL);
+        pthread_rwlock_unlock(&shard->lock);
+    } else {
+        *contains = dsc_map_chained_find(map, needle) != NULL;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_map_get_batch(const DSCMap *map, void *keys, size_t count,
+                           void *values, DSCError *results) {
+    if (map == NULL || keys == NULL || values == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t key_stride = map->key_element.size;
+    size_t value_stride = map->value_element.size;
+
+    // Neighbouring keys land in different shards, so each takes its own lock
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < count; ++i) {
+            results[i] = dsc_map_get(map, (char *) keys + i * key_stride,
+                                     (char *) values + i * value_stride);
         }
 
-        case DSC_TYPE_FLOAT: {
-            new_entry->key.f = *(float *) key;
-            break;
+        return DSC_ERROR_OK;
+    }
+
+    for (size_t base = 0; base < count; base += DSC_TABLE_BATCH_WINDOW) {
+        size_t n = count - base < DSC_TABLE_BATCH_WINDOW ? count - base
+                                                          : DSC_TABLE_BATCH_WINDOW;
+        void *window = (char *) keys + base * key_stride;
+        void *found[DSC_TABLE_BATCH_WINDOW];
+
+        if (map->backend == DSC_MAP_BACKEND_OPEN) {
+            bool present[DSC_TABLE_BATCH_WINDOW];
+            dsc_table_find_batch(&map->table, window, n, found, present);
+        } else {
+            DSCMapEntry *entries[DSC_TABLE_BATCH_WINDOW];
+            dsc_map_chained_find_window(map, window, n, entries);
+
+            for (size_t i = 0; i < n; ++i) {
+                found[i] = entries[i] != NULL ? &entries[i]->value : NULL;
+            }
         }
 
-        case DSC_TYPE_DOUBLE: {
-            new_entry->key.d = *(double *) key;
-            break;
+        for (size_t i = 0; i < n; ++i) {
+            results[base + i] = found[i] == NULL
+                              ? DSC_ERROR_NOT_FOUND
+                              : dsc_map_output(map, found[i],
+                                               (char *) values + (base + i) * value_stride);
         }
+    }
 
-        case DSC_TYPE_STRING: {
-            char *str = *(char **) key;
-            size_t str_size = strlen(str) + 1;
+    return DSC_ERROR_OK;
+}
 
-            new_entry->key.s = malloc(str_size);
-            if (new_entry->key.s == NULL) {
-                free(new_entry);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+DSCError dsc_map_contains_batch(const DSCMap *map, void *keys, size_t count,
+                                bool *results) {
+    if (map == NULL || keys == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-            strncpy(new_entry->key.s, str, str_size - 1);
-            memset(new_entry->key.s + str_size, '\0', 1);
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        dsc_table_find_batch(&map->table, keys, count, NULL, results);
+        return DSC_ERROR_OK;
+    }
 
-            break;
-        }
+    size_t stride = dsc_size_of(map->key_type);
 
-        default: {
-            return DSC_ERROR_INVALID_TYPE;
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < count; ++i) {
+            dsc_map_contains(map, (char *) keys + i * stride, &results[i]);
         }
+
+        return DSC_ERROR_OK;
     }
 
-    switch (map->value_type) {
-        case DSC_TYPE_CHAR: {
-            new_entry->value.c = *(char *) value;
-            break;
+    for (size_t base = 0; base < count; base += DSC_TABLE_BATCH_WINDOW) {
+        size_t n = count - base < DSC_TABLE_BATCH_WINDOW ? count - base
+                                                          : DSC_TABLE_BATCH_WINDOW;
+        DSCMapEntry *entries[DSC_TABLE_BATCH_WINDOW];
+
+        dsc_map_chained_find_window(map, (char *) keys + base * stride, n, entries);
+
+        for (size_t i = 0; i < n; ++i) {
+            results[base + i] = entries[i] != NULL;
         }
+    }
 
-        case DSC_TYPE_INT: {
-            new_entry->value.i = *(int *) value;
-            break;
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_map_reserve(DSCMap *map, size_t count) {
+    if (map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        return dsc_table_reserve(&map->table, count);
+    }
+
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        // A quarter on top of the even share absorbs the spread of random keys
+        size_t share = count / map->shard_count + 1;
+        share += share / 4 + DSC_MAP_INITIAL_CAPACITY;
+
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_wrlock(&map->shards[i].lock);
+            DSCError error = dsc_table_reserve(&map->shards[i].table, share);
+            pthread_rwlock_unlock(&map->shards[i].lock);
+
+            if (error != DSC_ERROR_OK) {
+                return error;
+            }
         }
 
-        case DSC_TYPE_FLOAT: {
-            new_entry->value.f = *(float *) value;
-            break;
+        return DSC_ERROR_OK;
+    }
+
+    // Inserting rehashes as soon as size reaches the load factor, so leave room
+    size_t new_capacity = map->capacity;
+    while (count >= DSC_MAP_LOAD_FACTOR * new_capacity) {
+        new_capacity *= 2;
+    }
+
+    if (new_capacity == map->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_map_chained_rehash(map, new_capacity);
+}
+
+DSCError dsc_map_insert_range(DSCMap *map, void *keys, void *values, size_t count) {
+    if (map == NULL || keys == NULL || values == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t size;
+    dsc_map_size(map, &size);
+
+    DSCError error = dsc_map_reserve(map, size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t key_stride = map->key_element.size;
+    size_t value_stride = map->value_element.size;
+
+    for (size_t i = 0; i < count; ++i) {
+        error = dsc_map_insert(map, (char *) keys + i * key_stride,
+                               (char *) values + i * value_stride);
+
+        if (error != DSC_ERROR_OK && error != DSC_ERROR_ALREADY_EXISTS) {
+            return error;
         }
+    }
 
-        case DSC_TYPE_DOUBLE: {
-            new_entry->value.d = *(double *) value;
-            break;
+    return DSC_ERROR_OK;
+}
+
+typedef struct {
+    DSCMap *map;
+    char *keys;
+    char *values;
+    size_t count;
+    size_t chunks;
+    uint32_t *ids;    // The shard of every pair
+    size_t *order;    // Pair indices grouped by shard
+    size_t *starts;   // Where each shard begins in order
+    DSCError *errors; // The outcome of every shard
+} DSCMapParallelInsert;
+
+static void dsc_map_parallel_classify(void *context, size_t index) {
+    DSCMapParallelInsert *batch = context;
+    DSCMap *map = batch->map;
+    size_t end = dsc_parallel_begin(batch->count, batch->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(batch->count, batch->chunks, index); i < end; ++i) {
+        DSCData key = dsc_table_load(batch->keys + i * map->key_element.size, map->key_type);
+        batch->ids[i] = (uint32_t) dsc_map_shard_index(map, key);
+    }
+}
+
+static void dsc_map_parallel_fill(void *context, size_t index) {
+    DSCMapParallelInsert *batch = context;
+    DSCMap *map = batch->map;
+    DSCMapShard *shard = &map->shards[index];
+    size_t begin = batch->starts[index];
+    size_t end = batch->starts[index + 1];
+    DSCError error = DSC_ERROR_OK;
+
+    if (begin == end) {
+        batch->errors[index] = DSC_ERROR_OK;
+        return;
+    }
+
+    pthread_rwlock_wrlock(&shard->lock);
+
+    for (size_t k = begin; k < end && error == DSC_ERROR_OK; ++k) {
+        size_t i = batch->order[k];
+        DSCData key = dsc_table_load(batch->keys + i * map->key_element.size, map->key_type);
+        DSCData value = dsc_table_load(batch->values + i * map->value_element.size,
+                                       map->value_type);
+
+        error = dsc_table_insert(&shard->table, key, value);
+        if (error == DSC_ERROR_ALREADY_EXISTS) {
+            error = DSC_ERROR_OK;
         }
+    }
 
-        case DSC_TYPE_STRING: {
-            char *str = *(char **) value;
-            size_t str_size = strlen(str);
+    pthread_rwlock_unlock(&shard->lock);
 
-            new_entry->value.s = malloc(str_size + 1);
-            if (new_entry->value.s == NULL) {
-                free(new_entry);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    batch->errors[index] = error;
+}
+
+DSCError dsc_map_parallel_insert_range(DSCMap *map, void *keys, void *values, size_t count,
+                                       DSCThreadPool *pool) {
+    if (map == NULL || keys == NULL || values == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        return dsc_table_insert_parallel(&map->table, keys, values, count, pool);
+    }
 
-            strncpy(new_entry->value.s, str, str_size);
-            memset(new_entry->value.s + str_size - 1, '\0', 1);
+    DSCMapParallelInsert batch = {map, keys, values, count, dsc_parallel_split(pool, count),
+                                  NULL, NULL, NULL, NULL};
 
-            break;
+    if (map->backend != DSC_MAP_BACKEND_SHARDED || batch.chunks == 1) {
+        return dsc_map_insert_range(map, keys, values, count);
+    }
+
+    size_t size;
+    dsc_map_size(map, &size);
+
+    DSCError error = dsc_map_reserve(map, size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    batch.ids = dsc_alloc(&map->allocator, count * sizeof(uint32_t));
+    batch.order = dsc_alloc(&map->allocator, count * sizeof(size_t));
+    batch.starts = dsc_alloc(&map->allocator, (map->shard_count + 1) * sizeof(size_t));
+    batch.errors = dsc_alloc(&map->allocator, map->shard_count * sizeof(DSCError));
+
+    error = DSC_ERROR_OUT_OF_MEMORY;
+
+    if (batch.ids != NULL && batch.order != NULL && batch.starts != NULL &&
+        batch.errors != NULL) {
+        dsc_parallel_run(pool, dsc_map_parallel_classify, &batch, batch.chunks);
+        error = dsc_parallel_partition(pool, batch.ids, count, map->shard_count, batch.order,
+                                       batch.starts, &map->allocator);
+    }
+
+    if (error == DSC_ERROR_OK) {
+        dsc_parallel_run(pool, dsc_map_parallel_fill, &batch, map->shard_count);
+
+        for (size_t i = 0; i < map->shard_count && error == DSC_ERROR_OK; ++i) {
+            error = batch.errors[i];
         }
     }
-    
-    // Insert the entry into the appropriate bucket
-    new_entry->next = map->buckets[index];
-    map->buckets[index] = new_entry;
-    map->size++;
-    
-    // Rehash if the load factor exceeds the threshold
-    if (map->size >= DSC_MAP_LOAD_FACTOR * map->capacity) {
-        dsc_map_rehash(map, map->capacity * 2);
+
+    dsc_free(&map->allocator, batch.ids);
+    dsc_free(&map->allocator, batch.order);
+    dsc_free(&map->allocator, batch.starts);
+    dsc_free(&map->allocator, batch.errors);
+
+    return error;
+}
+
+DSCError dsc_map_clear(DSCMap *map) {
+    if (map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        dsc_table_clear(&map->table);
+    } else if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            pthread_rwlock_wrlock(&map->shards[i].lock);
+            dsc_table_clear(&map->shards[i].table);
+            pthread_rwlock_unlock(&map->shards[i].lock);
+        }
+    } else {
+        dsc_map_chained_clear(map);
+        map->size = 0;
+    }
+
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_erase(DSCMap *map, void *key) {
-    if (map == NULL || key == NULL) {
+DSCError dsc_map_swap(DSCMap *map, DSCMap *other) {
+    if (map == NULL || other == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    uint32_t index = dsc_hash(key, map->key_type, map->capacity);
-    
-    DSCMapEntry *prev = NULL;
-    DSCMapEntry *curr = map->buckets[index];
-    
-    while (curr != NULL) {
-        switch (map->key_type) {
-            case DSC_TYPE_CHAR: {
-                if (curr->key.c == *(char *) key) {
-                    if (prev == NULL) {
-                        map->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    map->size--;
-            
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-
-            case DSC_TYPE_INT: {
-                if (curr->key.i == *(int *) key) {
-                    if (prev == NULL) {
-                        map->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    map->size--;
-            
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
 
-            case DSC_TYPE_FLOAT: {
-                if (curr->key.f == *(float *) key) {
-                    if (prev == NULL) {
-                        map->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    map->size--;
-            
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
+    if (map->backend != other->backend || map->key_type != other->key_type ||
+        map->value_type != other->value_type ||
+        !dsc_element_equal(&map->key_element, &other->key_element) ||
+        !dsc_element_equal(&map->value_element, &other->value_element) ||
+        !dsc_allocator_equal(&map->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-            case DSC_TYPE_DOUBLE: {
-                if (curr->key.d == *(double *) key) {
-                    if (prev == NULL) {
-                        map->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    map->size--;
-            
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
+    DSCMapEntry **buckets = map->buckets;
+    size_t size = map->size;
+    size_t capacity = map->capacity;
+    uint64_t seed = map->seed;
+    DSCMapShard *shards = map->shards;
+    size_t shard_count = map->shard_count;
+    unsigned shard_shift = map->shard_shift;
+
+    map->buckets = other->buckets;
+    map->size = other->size;
+    map->capacity = other->capacity;
+    map->seed = other->seed;
+    map->shards = other->shards;
+    map->shard_count = other->shard_count;
+    map->shard_shift = other->shard_shift;
+
+    other->buckets = buckets;
+    other->size = size;
+    other->capacity = capacity;
+    other->seed = seed;
+    other->shards = shards;
+    other->shard_count = shard_count;
+    other->shard_shift = shard_shift;
+
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        dsc_table_swap(&map->table, &other->table);
+    }
 
-            case DSC_TYPE_STRING: {
-                if (strcmp(curr->key.s, *(char **) key) == 0) {
-                    if (prev == NULL) {
-                        map->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-                    free(curr->key.s);
-                    free(curr);
-                    map->size--;
-            
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
+#ifdef DSC_STATS
+    // Shards move as a block, so their tables must be pointed at the
+    // counters of their new map
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (size_t i = 0; i < map->shard_count; ++i) {
+            map->shards[i].table.allocator = map->allocator;
+            map->shards[i].table.stats = &map->stats;
+        }
 
-            default: {
-                return DSC_ERROR_INVALID_TYPE;
-            }
+        for (size_t i = 0; i < other->shard_count; ++i) {
+            other->shards[i].table.allocator = other->allocator;
+            other->shards[i].table.stats = &other->stats;
         }
-        
-        prev = curr;
-        curr = curr->next;
     }
-    
-    return DSC_ERROR_NOT_FOUND;
+#endif
+
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_contains(const DSCMap *map, void *key, bool *contains) {
-    if (map == NULL || key == NULL) {
+DSCError dsc_map_cursor_init(const DSCMap *map, DSCMapCursor *cursor) {
+    if (map == NULL || cursor == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    uint32_t index = dsc_hash(key, map->key_type, map->capacity);
 
-    DSCMapEntry *curr = map->buckets[index];
-    
-    while (curr != NULL) {
-        switch (map->key_type) {
-            case DSC_TYPE_CHAR: {
-                if (curr->key.c == *(char *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
+    cursor->map = map;
+    cursor->shard = 0;
+    cursor->position = 0;
+    cursor->entry = NULL;
+
+    return DSC_ERROR_OK;
+}
 
-            case DSC_TYPE_INT: {
-                if (curr->key.i == *(int *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
+bool dsc_map_cursor_next(DSCMapCursor *cursor, const void **key, const void **value) {
+    const DSCMap *map = cursor->map;
+    const void *found_value;
 
-                break;
-            }
+    if (value == NULL) {
+        value = &found_value;
+    }
 
-            case DSC_TYPE_FLOAT: {
-                if (curr->key.f == *(float *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
+    if (map->backend == DSC_MAP_BACKEND_OPEN) {
+        return dsc_table_next(&map->table, &cursor->position, key, value);
+    }
 
-                break;
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        for (; cursor->shard < map->shard_count; ++cursor->shard, cursor->position = 0) {
+            if (dsc_table_next(&map->shards[cursor->shard].table, &cursor->position, key,
+                               value)) {
+                return true;
             }
+        }
+
+        return false;
+    }
 
-            case DSC_TYPE_DOUBLE: {
-                if (curr->key.d == *(double *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
+    // Chained: finish the current bucket, then move on to the next non-empty one
+    const DSCMapEntry *entry = cursor->entry;
 
-                break;
-            }
+    while (entry == NULL && cursor->position < map->capacity) {
+        entry = map->buckets[cursor->position++];
+    }
+
+    if (entry == NULL) {
+        return false;
+    }
 
-            case DSC_TYPE_STRING: {
-                if (strcmp(curr->key.s, *(char **) key) == 0) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
+    *key = dsc_element_view(&entry->key, map->key_type);
+    *value = dsc_element_view(&entry->value, map->value_type);
+    cursor->entry = entry->next;
 
-                break;
-            }
+    return true;
+}
 
-            case DSC_TYPE_BOOL: {
-                if (curr->key.b == *(bool *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
+DSCError dsc_map_for_each(const DSCMap *map, DSCMapVisitor visitor, void *context) {
+    if (map == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-                break;
-            }
+    const void *key;
+    const void *value;
 
-            default: {
-                return DSC_ERROR_INVALID_TYPE;
+    if (map->backend == DSC_MAP_BACKEND_SHARDED) {
+        bool more = true;
+
+        for (size_t i = 0; i < map->shard_count && more; ++i) {
+            size_t position = 0;
+
+            pthread_rwlock_rdlock(&map->shards[i].lock);
+            while (more && dsc_table_next(&map->shards[i].table, &position, &key, &value)) {
+                more = visitor(key, value, context);
             }
+            pthread_rwlock_unlock(&map->shards[i].lock);
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    DSCMapCursor cursor;
+    dsc_map_cursor_init(map, &cursor);
+
+    while (dsc_map_cursor_next(&cursor, &key, &value)) {
+        if (!visitor(key, value, context)) {
+            break;
         }
-        
-        curr = curr->next;
     }
 
-    *contains = false;
-    
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_map_clear(DSCMap *map) {
-    if (map == NULL) {
+/* Snapshots */
+
+static void dsc_map_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_map_for_each(container, dsc_snapshot_sink_entry, sink);
+}
+
+DSCError dsc_map_save(const DSCMap *map, const char *path) {
+    if (map == NULL || path == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
-    
-    for (size_t i = 0; i < map->capacity; ++i) {
-        DSCMapEntry *curr = map->buckets[i];
 
-        while (curr != NULL) {
-            DSCMapEntry *next = curr->next;
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_MAP, map->key_type, map->key_element.size,
+                                map->value_type, map->value_element.size};
 
-            if (map->key_type == DSC_TYPE_STRING) {
-                free(curr->key.s);
-            }
+    return dsc_snapshot_write(path, &layout, dsc_map_walk, map);
+}
 
-            if (map->value_type == DSC_TYPE_STRING) {
-                free(curr->value.s);
-            }
+DSCError dsc_map_stats(const DSCMap *map, DSCStats *stats) {
+    if (map == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-            free(curr);
+    dsc_stats_export(DSC_STATS_OF(map), stats);
 
-            curr = next;
-        }
+    if (stats->enabled && map->backend == DSC_MAP_BACKEND_CHAINED) {
+        for (size_t i = 0; i < map->capacity; ++i) {
+            size_t chain = 0;
+            for (DSCMapEntry *curr = map->buckets[i]; curr != NULL; curr = curr->next) {
+                chain++;
+            }
 
-        map->buckets[i] = NULL;
+            if (chain > stats->max_chain) {
+                stats->max_chain = chain;
+            }
+        }
     }
-    
-    map->size = 0;
-    
+
     return DSC_ERROR_OK;
 }
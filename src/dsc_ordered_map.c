@@ -0,0 +1,317 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "../include/dsc_ordered_map.h"
+#include "dsc_btree.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
+struct DSCOrderedMap {
+    DSCBTree tree; // B+-tree holding the entries in key order
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+};
+
+static DSCError dsc_ordered_map_create(DSCOrderedMap **new_map, DSCType key_type,
+                                       const DSCElementType *key_element, DSCType value_type,
+                                       const DSCElementType *value_element,
+                                       const DSCAllocator *allocator) {
+    DSCOrderedMap *map = dsc_alloc(allocator, sizeof(DSCOrderedMap));
+    if (map == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    // The tree copies the allocator, counting one included
+    DSCAllocator tree_allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&map->stats, &tree_allocator);
+
+    DSCError error = dsc_btree_init(&map->tree, key_type, key_element, value_type,
+                                    value_element, &tree_allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, map);
+        return error;
+    }
+
+    *new_map = map;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_init(DSCOrderedMap **new_map, DSCType key_type, DSCType value_type) {
+    return dsc_ordered_map_init_allocator(new_map, key_type, value_type, NULL);
+}
+
+DSCError dsc_ordered_map_init_allocator(DSCOrderedMap **new_map, DSCType key_type,
+                                        DSCType value_type, const DSCAllocator *allocator) {
+    if (new_map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(key_type) || key_type == DSC_TYPE_BYTES ||
+        dsc_type_invalid(value_type) || value_type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return dsc_ordered_map_create(new_map, key_type, NULL, value_type, NULL, allocator);
+}
+
+DSCError dsc_ordered_map_init_bytes(DSCOrderedMap **new_map, DSCType key_type,
+                                    const DSCElementType *key_element, DSCType value_type,
+                                    const DSCElementType *value_element,
+                                    const DSCAllocator *allocator) {
+    if (new_map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(key_type) || dsc_type_invalid(value_type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if ((key_type == DSC_TYPE_BYTES && dsc_element_invalid(key_element)) ||
+        (value_type == DSC_TYPE_BYTES && dsc_element_invalid(value_element))) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_map_create(new_map, key_type, key_element, value_type, value_element,
+                                  allocator);
+}
+
+DSCError dsc_ordered_map_deinit(DSCOrderedMap *map) {
+    if (map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The tree's allocator lives inside the map, so copy it out first
+    DSCAllocator allocator = map->tree.allocator;
+
+    dsc_btree_deinit(&map->tree);
+    dsc_free(&allocator, map);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_size(const DSCOrderedMap *map, size_t *result) {
+    if (map == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = map->tree.size;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_empty(const DSCOrderedMap *map, bool *result) {
+    if (map == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = map->tree.size == 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_get(const DSCOrderedMap *map, void *key, void *result) {
+    if (map == NULL || key == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    void *found;
+    if (!dsc_btree_find(&map->tree, key, &found)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    return dsc_btree_output(&map->tree, found, result);
+}
+
+DSCError dsc_ordered_map_get_view(const DSCOrderedMap *map, void *key, DSCStringView *result) {
+    if (map == NULL || key == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (map->tree.value_type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    void *found;
+    if (!dsc_btree_find(&map->tree, key, &found)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    result->data = *(char **) found;
+    result->length = strlen(result->data);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_contains(const DSCOrderedMap *map, void *key, bool *result) {
+    if (map == NULL || key == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = dsc_btree_find(&map->tree, key, NULL);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_insert(DSCOrderedMap *map, void *key, void *value) {
+    if (map == NULL || key == NULL || value == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_insert(&map->tree, key, value);
+}
+
+DSCError dsc_ordered_map_load_sorted(DSCOrderedMap *map, void *keys, void *values, size_t count) {
+    if (map == NULL || (count > 0 && (keys == NULL || values == NULL))) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_load_sorted(&map->tree, keys, values, count);
+}
+
+DSCError dsc_ordered_map_erase(DSCOrderedMap *map, void *key) {
+    if (map == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_erase(&map->tree, key);
+}
+
+DSCError dsc_ordered_map_clear(DSCOrderedMap *map) {
+    if (map == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_btree_clear(&map->tree);
+
+    return DSC_ERROR_OK;
+}
+
+/* Walks */
+
+static DSCError dsc_ordered_map_seek(const DSCOrderedMap *map, void *key, bool upper,
+                                     DSCOrderedMapCursor *cursor) {
+    if (map == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCBTreeNode *leaf;
+
+    cursor->map = map;
+    dsc_btree_seek(&map->tree, key, upper, &leaf, &cursor->index);
+    cursor->leaf = leaf;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_map_cursor_init(const DSCOrderedMap *map, DSCOrderedMapCursor *cursor) {
+    return dsc_ordered_map_seek(map, NULL, false, cursor);
+}
+
+DSCError dsc_ordered_map_lower_bound(const DSCOrderedMap *map, void *key,
+                                     DSCOrderedMapCursor *cursor) {
+    if (key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_map_seek(map, key, false, cursor);
+}
+
+DSCError dsc_ordered_map_upper_bound(const DSCOrderedMap *map, void *key,
+                                     DSCOrderedMapCursor *cursor) {
+    if (key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_map_seek(map, key, true, cursor);
+}
+
+bool dsc_ordered_map_cursor_next(DSCOrderedMapCursor *cursor, const void **key,
+                                 const void **value) {
+    const DSCBTreeNode *leaf = cursor->leaf;
+
+    bool found = dsc_btree_next(&cursor->map->tree, &leaf, &cursor->index, key, value);
+    cursor->leaf = leaf;
+
+    return found;
+}
+
+DSCError dsc_ordered_map_for_each(const DSCOrderedMap *map, DSCMapVisitor visitor,
+                                  void *context) {
+    return dsc_ordered_map_range(map, NULL, NULL, visitor, context);
+}
+
+DSCError dsc_ordered_map_range(const DSCOrderedMap *map, void *low, void *high,
+                               DSCMapVisitor visitor, void *context) {
+    if (map == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCBTree *tree = &map->tree;
+    const DSCBTreeNode *leaf;
+    size_t index;
+
+    dsc_btree_seek(tree, low, false, &leaf, &index);
+
+    while (true) {
+        const void *slot = dsc_btree_peek(tree, &leaf, &index);
+        if (slot == NULL || (high != NULL && dsc_btree_compare(tree, slot, high) >= 0)) {
+            break;
+        }
+
+        const void *key;
+        const void *value;
+
+        dsc_btree_next(tree, &leaf, &index, &key, &value);
+
+        if (!visitor(key, value, context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_ordered_map_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_ordered_map_for_each(container, dsc_snapshot_sink_entry, sink);
+}
+
+DSCError dsc_ordered_map_save(const DSCOrderedMap *map, const char *path) {
+    if (map == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_MAP, map->tree.key_type, map->tree.key_element.size,
+                                map->tree.value_type, map->tree.value_element.size};
+
+    return dsc_snapshot_write(path, &layout, dsc_ordered_map_walk, map);
+}
+
+DSCError dsc_ordered_map_stats(const DSCOrderedMap *map, DSCStats *stats) {
+    if (map == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(map), stats);
+
+    return DSC_ERROR_OK;
+}
@@ -0,0 +1,265 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../include/dsc_ordered_set.h"
+#include "dsc_btree.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
+struct DSCOrderedSet {
+    DSCBTree tree; // Keys-only B+-tree holding the elements in order
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+};
+
+static DSCError dsc_ordered_set_create(DSCOrderedSet **new_set, DSCType type,
+                                       const DSCElementType *element,
+                                       const DSCAllocator *allocator) {
+    DSCOrderedSet *set = dsc_alloc(allocator, sizeof(DSCOrderedSet));
+    if (set == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    // The tree copies the allocator, counting one included
+    DSCAllocator tree_allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&set->stats, &tree_allocator);
+
+    DSCError error = dsc_btree_init(&set->tree, type, element, DSC_TYPE_UNKNOWN, NULL,
+                                    &tree_allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, set);
+        return error;
+    }
+
+    *new_set = set;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_init(DSCOrderedSet **new_set, DSCType type) {
+    return dsc_ordered_set_init_allocator(new_set, type, NULL);
+}
+
+DSCError dsc_ordered_set_init_allocator(DSCOrderedSet **new_set, DSCType type,
+                                        const DSCAllocator *allocator) {
+    if (new_set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return dsc_ordered_set_create(new_set, type, NULL, allocator);
+}
+
+DSCError dsc_ordered_set_init_bytes(DSCOrderedSet **new_set, const DSCElementType *element,
+                                    const DSCAllocator *allocator) {
+    if (new_set == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_set_create(new_set, DSC_TYPE_BYTES, element, allocator);
+}
+
+DSCError dsc_ordered_set_deinit(DSCOrderedSet *set) {
+    if (set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The tree's allocator lives inside the set, so copy it out first
+    DSCAllocator allocator = set->tree.allocator;
+
+    dsc_btree_deinit(&set->tree);
+    dsc_free(&allocator, set);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_size(const DSCOrderedSet *set, size_t *size) {
+    if (set == NULL || size == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *size = set->tree.size;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_empty(const DSCOrderedSet *set, bool *is_empty) {
+    if (set == NULL || is_empty == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *is_empty = set->tree.size == 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_contains(const DSCOrderedSet *set, void *key, bool *contains) {
+    if (set == NULL || key == NULL || contains == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *contains = dsc_btree_find(&set->tree, key, NULL);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_insert(DSCOrderedSet *set, void *key) {
+    if (set == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_insert(&set->tree, key, NULL);
+}
+
+DSCError dsc_ordered_set_load_sorted(DSCOrderedSet *set, void *keys, size_t count) {
+    if (set == NULL || (count > 0 && keys == NULL)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_load_sorted(&set->tree, keys, NULL, count);
+}
+
+DSCError dsc_ordered_set_erase(DSCOrderedSet *set, void *key) {
+    if (set == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_btree_erase(&set->tree, key);
+}
+
+DSCError dsc_ordered_set_clear(DSCOrderedSet *set) {
+    if (set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_btree_clear(&set->tree);
+
+    return DSC_ERROR_OK;
+}
+
+/* Walks */
+
+static DSCError dsc_ordered_set_seek(const DSCOrderedSet *set, void *key, bool upper,
+                                     DSCOrderedSetCursor *cursor) {
+    if (set == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCBTreeNode *leaf;
+
+    cursor->set = set;
+    dsc_btree_seek(&set->tree, key, upper, &leaf, &cursor->index);
+    cursor->leaf = leaf;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_ordered_set_cursor_init(const DSCOrderedSet *set, DSCOrderedSetCursor *cursor) {
+    return dsc_ordered_set_seek(set, NULL, false, cursor);
+}
+
+DSCError dsc_ordered_set_lower_bound(const DSCOrderedSet *set, void *key,
+                                     DSCOrderedSetCursor *cursor) {
+    if (key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_set_seek(set, key, false, cursor);
+}
+
+DSCError dsc_ordered_set_upper_bound(const DSCOrderedSet *set, void *key,
+                                     DSCOrderedSetCursor *cursor) {
+    if (key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_ordered_set_seek(set, key, true, cursor);
+}
+
+bool dsc_ordered_set_cursor_next(DSCOrderedSetCursor *cursor, const void **element) {
+    const DSCBTreeNode *leaf = cursor->leaf;
+
+    bool found = dsc_btree_next(&cursor->set->tree, &leaf, &cursor->index, element, NULL);
+    cursor->leaf = leaf;
+
+    return found;
+}
+
+DSCError dsc_ordered_set_for_each(const DSCOrderedSet *set, DSCVisitor visitor, void *context) {
+    return dsc_ordered_set_range(set, NULL, NULL, visitor, context);
+}
+
+DSCError dsc_ordered_set_range(const DSCOrderedSet *set, void *low, void *high,
+                               DSCVisitor visitor, void *context) {
+    if (set == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCBTree *tree = &set->tree;
+    const DSCBTreeNode *leaf;
+    size_t index;
+
+    dsc_btree_seek(tree, low, false, &leaf, &index);
+
+    while (true) {
+        const void *slot = dsc_btree_peek(tree, &leaf, &index);
+        if (slot == NULL || (high != NULL && dsc_btree_compare(tree, slot, high) >= 0)) {
+            break;
+        }
+
+        const void *element;
+
+        dsc_btree_next(tree, &leaf, &index, &element, NULL);
+
+        if (!visitor(element, context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_ordered_set_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_ordered_set_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_ordered_set_save(const DSCOrderedSet *set, const char *path) {
+    if (set == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SET, set->tree.key_type,
+                                set->tree.key_element.size, DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_ordered_set_walk, set);
+}
+
+DSCError dsc_ordered_set_stats(const DSCOrderedSet *set, DSCStats *stats) {
+    if (set == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(set), stats);
+
+    return DSC_ERROR_OK;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_parallel.h
+ * @brief Internal fork-join primitives behind the parallel algorithms.
+ *
+ * This header is not installed. A parallel algorithm asks dsc_parallel_split
+ * how many chunks its input is worth, then runs one task per chunk with
+ * dsc_parallel_run; chunk bounds come from dsc_parallel_begin. Every buffer
+ * the tasks share is allocated by the calling thread beforehand, so a
+ * container's allocator is only called from the workers where the container
+ * already requires a thread-safe one.
+ */
+
+#ifndef DSC_PARALLEL_H
+#define DSC_PARALLEL_H
+
+#include <stdint.h>
+
+#include "../include/dsc_allocator.h"
+#include "../include/dsc_error.h"
+#include "../include/dsc_thread_pool.h"
+
+/**
+ * @brief The number of chunks per worker an input is split into, so that
+ *        workers finishing early pick up more.
+ */
+#define DSC_PARALLEL_OVERSPLIT 4
+
+/**
+ * @brief One task of a parallel call.
+ *
+ * @param context The context passed to dsc_parallel_run.
+ * @param index The index of the task, below the task count.
+ */
+typedef void (*DSCParallelTask)(void *context, size_t index);
+
+/**
+ * @brief Run count tasks on the pool and the calling thread, and wait for
+ *        all of them.
+ *
+ * Tasks are claimed in index order. With a NULL pool, or a pool of one
+ * worker, they run one after the other on the calling thread.
+ */
+void dsc_parallel_run(DSCThreadPool *pool, DSCParallelTask task, void *context,
+                      size_t count);
+
+/**
+ * @brief Get the number of chunks to split an input of count elements into.
+ *
+ * @return 1 if the input is below the pool's cutoff or the pool is NULL or
+ *         has one worker, otherwise DSC_PARALLEL_OVERSPLIT chunks per worker
+ *         but never more than count.
+ */
+size_t dsc_parallel_split(const DSCThreadPool *pool, size_t count);
+
+/**
+ * @brief Get the first element of a chunk.
+ *
+ * The chunks of count elements differ in size by at most one element; chunk
+ * `chunks` begins at count.
+ */
+static inline size_t dsc_parallel_begin(size_t count, size_t chunks, size_t index) {
+    size_t base = count / chunks;
+    size_t extra = count % chunks;
+
+    return index * base + (index < extra ? index : extra);
+}
+
+/**
+ * @brief Group element indices by bucket.
+ *
+ * A stable counting sort of the indices 0 to count - 1 by their bucket ids,
+ * histogrammed and scattered in parallel chunks.
+ *
+ * @param pool The pool to run on, or NULL.
+ * @param ids The bucket of every element, each below buckets.
+ * @param count The number of elements.
+ * @param buckets The number of buckets.
+ * @param order Set to the element indices, bucket by bucket.
+ * @param starts Set to where each bucket begins in order; starts[buckets] is
+ *               count, so it needs buckets + 1 entries.
+ * @param allocator Source of the per-chunk histograms.
+ * @return DSC_ERROR_OK or DSC_ERROR_OUT_OF_MEMORY.
+ */
+DSCError dsc_parallel_partition(DSCThreadPool *pool, const uint32_t *ids, size_t count,
+                                size_t buckets, size_t *order, size_t *starts,
+                                const DSCAllocator *allocator);
+
+#endif  // DSC_PARALLEL_H
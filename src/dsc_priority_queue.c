@@ -0,0 +1,795 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_priority_queue.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
+/* The position of a released handle */
+#define DSC_PRIORITY_QUEUE_FREE SIZE_MAX
+
+struct DSCPriorityQueue {
+    DSCData data;       // The heap array
+    size_t size;        // The number of elements currently in the heap
+    size_t capacity;    // The current capacity of the heap array
+    DSCType type;       // The type of the elements in the heap
+    DSCElementType element; // The element stride, and the callbacks of records
+    DSCGrowthPolicy growth; // How the capacity grows and shrinks
+    DSCAllocator allocator; // Source of the queue, its arrays and strings
+    bool max_first;     // Whether the largest element comes first
+
+    // Handles: ids maps heap slots to handles and positions maps back
+    size_t *ids;        // The handle of each heap slot, capacity entries
+    size_t *positions;  // The heap slot of each handle, or DSC_PRIORITY_QUEUE_FREE
+    size_t *free_ids;   // Released handles, reused last in first out
+    size_t free_count;  // The number of released handles
+    size_t next_id;     // Handles below this have been handed out
+    size_t id_capacity; // The length of positions and free_ids
+
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
+
+    // Room for the element being sifted
+    alignas(max_align_t) unsigned char scratch[];
+};
+
+static inline unsigned char *dsc_priority_queue_record(const DSCPriorityQueue *queue,
+                                                       size_t index) {
+    return (unsigned char *) queue->data.c_ptr + index * queue->element.size;
+}
+
+/* Whether lhs is popped before rhs, in dsc_compare's order */
+static bool dsc_priority_queue_before(const DSCPriorityQueue *queue, const void *lhs,
+                                      const void *rhs) {
+    if (queue->max_first) {
+        const void *swap = lhs;
+        lhs = rhs;
+        rhs = swap;
+    }
+
+    switch (queue->type) {
+        case DSC_TYPE_BOOL:
+            return *(const bool *) lhs < *(const bool *) rhs;
+        case DSC_TYPE_CHAR:
+            return *(const char *) lhs < *(const char *) rhs;
+        case DSC_TYPE_INT:
+            return *(const int *) lhs < *(const int *) rhs;
+        case DSC_TYPE_FLOAT: {
+            // NaNs come after every number, making the order total
+            float a = *(const float *) lhs;
+            float b = *(const float *) rhs;
+            return a < b || (isnan(b) && !isnan(a));
+        }
+        case DSC_TYPE_DOUBLE: {
+            double a = *(const double *) lhs;
+            double b = *(const double *) rhs;
+            return a < b || (isnan(b) && !isnan(a));
+        }
+        case DSC_TYPE_STRING:
+            return strcmp(*(char *const *) lhs, *(char *const *) rhs) < 0;
+        default:
+            return dsc_element_compare(&queue->element, lhs, rhs) < 0;
+    }
+}
+
+/* Put an element and its handle into a heap slot */
+static inline void dsc_priority_queue_place(DSCPriorityQueue *queue, size_t index,
+                                            const void *record, size_t id) {
+    memcpy(dsc_priority_queue_record(queue, index), record, queue->element.size);
+    queue->ids[index] = id;
+    queue->positions[id] = index;
+}
+
+/* Move the element in a slot towards the root until its parent comes first.
+ * The element waits in the scratch space while its ancestors move down. */
+static void dsc_priority_queue_sift_up(DSCPriorityQueue *queue, size_t index) {
+    size_t id = queue->ids[index];
+    memcpy(queue->scratch, dsc_priority_queue_record(queue, index), queue->element.size);
+
+    while (index > 0) {
+        size_t parent = (index - 1) / DSC_PRIORITY_QUEUE_ARITY;
+        const unsigned char *record = dsc_priority_queue_record(queue, parent);
+
+        if (!dsc_priority_queue_before(queue, queue->scratch, record)) {
+            break;
+        }
+
+        dsc_priority_queue_place(queue, index, record, queue->ids[parent]);
+        index = parent;
+    }
+
+    dsc_priority_queue_place(queue, index, queue->scratch, id);
+}
+
+/* Move the element in a slot towards the leaves until no child comes first */
+static void dsc_priority_queue_sift_down(DSCPriorityQueue *queue, size_t index) {
+    size_t id = queue->ids[index];
+    memcpy(queue->scratch, dsc_priority_queue_record(queue, index), queue->element.size);
+
+    for (;;) {
+        size_t first = index * DSC_PRIORITY_QUEUE_ARITY + 1;
+        if (first >= queue->size) {
+            break;
+        }
+
+        size_t last = queue->size - first > DSC_PRIORITY_QUEUE_ARITY
+                          ? first + DSC_PRIORITY_QUEUE_ARITY
+                          : queue->size;
+
+        // The children sit next to each other, one or two cache lines
+        size_t best = first;
+        for (size_t child = first + 1; child < last; ++child) {
+            if (dsc_priority_queue_before(queue, dsc_priority_queue_record(queue, child),
+                                          dsc_priority_queue_record(queue, best))) {
+                best = child;
+            }
+        }
+
+        const unsigned char *record = dsc_priority_queue_record(queue, best);
+        if (!dsc_priority_queue_before(queue, record, queue->scratch)) {
+            break;
+        }
+
+        dsc_priority_queue_place(queue, index, record, queue->ids[best]);
+        index = best;
+    }
+
+    dsc_priority_queue_place(queue, index, queue->scratch, id);
+}
+
+/* Restore the heap around a slot whose element was replaced */
+static void dsc_priority_queue_fix(DSCPriorityQueue *queue, size_t index) {
+    if (index > 0) {
+        size_t parent = (index - 1) / DSC_PRIORITY_QUEUE_ARITY;
+
+        if (dsc_priority_queue_before(queue, dsc_priority_queue_record(queue, index),
+                                      dsc_priority_queue_record(queue, parent))) {
+            dsc_priority_queue_sift_up(queue, index);
+            return;
+        }
+    }
+
+    dsc_priority_queue_sift_down(queue, index);
+}
+
+/* Build the heap bottom-up, from the last parent back to the root */
+static void dsc_priority_queue_heapify(DSCPriorityQueue *queue) {
+    if (queue->size < 2) {
+        return;
+    }
+
+    for (size_t i = (queue->size - 2) / DSC_PRIORITY_QUEUE_ARITY + 1; i-- > 0; ) {
+        dsc_priority_queue_sift_down(queue, i);
+    }
+}
+
+static DSCError dsc_priority_queue_realloc_ids(const DSCAllocator *allocator, size_t **ids,
+                                               size_t count) {
+    if (count > SIZE_MAX / sizeof(size_t)) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t *buffer = dsc_realloc(allocator, *ids, (count > 0 ? count : 1) * sizeof(size_t));
+    if (buffer == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    *ids = buffer;
+
+    return DSC_ERROR_OK;
+}
+
+/* Resize the heap array and the slot handles to new_capacity >= size. A
+ * larger array is grown handles first and a smaller one shrunk handles last,
+ * so a failure never leaves fewer handle slots than heap slots. */
+static DSCError dsc_priority_queue_resize(DSCPriorityQueue *queue, size_t new_capacity) {
+    DSCError error;
+
+    if (new_capacity > queue->capacity) {
+        error = dsc_priority_queue_realloc_ids(&queue->allocator, &queue->ids, new_capacity);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+    }
+
+    error = dsc_data_realloc_stride(&queue->data, queue->element.size, new_capacity,
+                                    &queue->allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (new_capacity < queue->capacity) {
+        dsc_priority_queue_realloc_ids(&queue->allocator, &queue->ids, new_capacity);
+    }
+
+    DSC_STATS_REALLOC(&queue->stats);
+    queue->capacity = new_capacity;
+
+    return DSC_ERROR_OK;
+}
+
+/* Make room for needed elements, growing by the policy */
+static DSCError dsc_priority_queue_grow(DSCPriorityQueue *queue, size_t needed) {
+    if (needed < queue->size) {
+        return DSC_ERROR_OUT_OF_MEMORY; // The size overflowed
+    }
+
+    if (needed <= queue->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = dsc_growth_next(&queue->growth, queue->capacity, needed,
+                                          queue->element.size);
+
+    return dsc_priority_queue_resize(queue, new_capacity);
+}
+
+/* Make sure count more handles can be handed out */
+static DSCError dsc_priority_queue_reserve_ids(DSCPriorityQueue *queue, size_t count) {
+    size_t fresh = count > queue->free_count ? count - queue->free_count : 0;
+
+    if (queue->next_id + fresh <= queue->id_capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = queue->id_capacity * 2;
+    if (new_capacity < queue->next_id + fresh) {
+        new_capacity = queue->next_id + fresh;
+    }
+
+    DSCError error = dsc_priority_queue_realloc_ids(&queue->allocator, &queue->positions,
+                                                    new_capacity);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    error = dsc_priority_queue_realloc_ids(&queue->allocator, &queue->free_ids, new_capacity);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    queue->id_capacity = new_capacity;
+
+    return DSC_ERROR_OK;
+}
+
+/* Hand out a handle; dsc_priority_queue_reserve_ids must have made room */
+static inline size_t dsc_priority_queue_acquire(DSCPriorityQueue *queue) {
+    if (queue->free_count > 0) {
+        return queue->free_ids[--queue->free_count];
+    }
+
+    return queue->next_id++;
+}
+
+static inline void dsc_priority_queue_release_id(DSCPriorityQueue *queue, size_t id) {
+    queue->positions[id] = DSC_PRIORITY_QUEUE_FREE;
+    queue->free_ids[queue->free_count++] = id;
+}
+
+static inline bool dsc_priority_queue_valid(const DSCPriorityQueue *queue,
+                                            DSCPriorityHandle handle) {
+    return handle < queue->next_id && queue->positions[handle] != DSC_PRIORITY_QUEUE_FREE;
+}
+
+/* Copy an element the caller passed into uninitialized storage */
+static DSCError dsc_priority_queue_store(DSCPriorityQueue *queue, void *record, void *data) {
+    switch (queue->type) {
+        case DSC_TYPE_STRING: {
+            char *copy = dsc_strdup(&queue->allocator, *(char **) data);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) record = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&queue->element, record, data);
+        }
+
+        default: {
+            memcpy(record, data, queue->element.size);
+            return DSC_ERROR_OK;
+        }
+    }
+}
+
+/* Copy a stored element out to the caller, strings with malloc */
+static DSCError dsc_priority_queue_load(const DSCPriorityQueue *queue, const void *record,
+                                        void *result) {
+    switch (queue->type) {
+        case DSC_TYPE_STRING: {
+            char *copy = strdup(*(char *const *) record);
+            if (copy == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) result = copy;
+            return DSC_ERROR_OK;
+        }
+
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&queue->element, result, record);
+        }
+
+        default: {
+            memcpy(result, record, queue->element.size);
+            return DSC_ERROR_OK;
+        }
+    }
+}
+
+/* Free any memory owned by count stored elements */
+static void dsc_priority_queue_release(DSCPriorityQueue *queue, void *records, size_t count) {
+    if (queue->type == DSC_TYPE_STRING && dsc_allocator_frees(&queue->allocator)) {
+        char **strings = records;
+
+        for (size_t i = 0; i < count; ++i) {
+            dsc_free(&queue->allocator, strings[i]);
+        }
+    }
+
+    if (queue->type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&queue->element, records, count);
+    }
+}
+
+/* Take the element out of a slot and fill the hole with the last element */
+static void dsc_priority_queue_remove(DSCPriorityQueue *queue, size_t index) {
+    dsc_priority_queue_release_id(queue, queue->ids[index]);
+    queue->size--;
+
+    if (index < queue->size) {
+        size_t last = queue->size;
+        dsc_priority_queue_place(queue, index, dsc_priority_queue_record(queue, last),
+                                 queue->ids[last]);
+        dsc_priority_queue_fix(queue, index);
+    }
+
+    // Give memory back after a burst; a failed shrink keeps the larger array
+    size_t new_capacity = dsc_growth_shrink(&queue->growth, queue->size, queue->capacity,
+                                            DSC_PRIORITY_QUEUE_INITIAL_CAPACITY,
+                                            queue->element.size);
+    if (new_capacity < queue->capacity) {
+        dsc_priority_queue_resize(queue, new_capacity);
+    }
+}
+
+DSCError dsc_priority_queue_init(DSCPriorityQueue **queue, DSCType type) {
+    return dsc_priority_queue_init_allocator(queue, type, NULL);
+}
+
+static DSCError dsc_priority_queue_create(DSCPriorityQueue **queue, DSCType type,
+                                          const DSCElementType *element,
+                                          const DSCAllocator *allocator) {
+    if (element->size > SIZE_MAX - sizeof(DSCPriorityQueue)) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCPriorityQueue *new_queue = dsc_alloc(allocator, sizeof(DSCPriorityQueue) + element->size);
+    if (new_queue == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_queue->size = 0;
+    new_queue->capacity = DSC_PRIORITY_QUEUE_INITIAL_CAPACITY;
+    new_queue->type = type;
+    new_queue->element = *element;
+    new_queue->growth = DSC_GROWTH_POLICY_DEFAULT;
+    new_queue->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    new_queue->max_first = false;
+    new_queue->data.c_ptr = NULL;
+    new_queue->ids = NULL;
+    new_queue->positions = NULL;
+    new_queue->free_ids = NULL;
+    new_queue->free_count = 0;
+    new_queue->next_id = 0;
+    new_queue->id_capacity = DSC_PRIORITY_QUEUE_INITIAL_CAPACITY;
+    DSC_STATS_INIT(&new_queue->stats, &new_queue->allocator);
+
+    const DSCAllocator *source = &new_queue->allocator;
+    size_t count = DSC_PRIORITY_QUEUE_INITIAL_CAPACITY;
+
+    DSCError error = dsc_data_malloc_stride(&new_queue->data, element->size, count, source);
+    if (error == DSC_ERROR_OK) {
+        error = dsc_priority_queue_realloc_ids(source, &new_queue->ids, count);
+    }
+    if (error == DSC_ERROR_OK) {
+        error = dsc_priority_queue_realloc_ids(source, &new_queue->positions, count);
+    }
+    if (error == DSC_ERROR_OK) {
+        error = dsc_priority_queue_realloc_ids(source, &new_queue->free_ids, count);
+    }
+
+    if (error != DSC_ERROR_OK) {
+        dsc_free(source, new_queue->data.c_ptr);
+        dsc_free(source, new_queue->ids);
+        dsc_free(source, new_queue->positions);
+        dsc_free(allocator, new_queue);
+        return error;
+    }
+
+    *queue = new_queue;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_init_allocator(DSCPriorityQueue **queue, DSCType type,
+                                           const DSCAllocator *allocator) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_priority_queue_create(queue, type, &element, allocator);
+}
+
+DSCError dsc_priority_queue_init_bytes(DSCPriorityQueue **queue,
+                                       const DSCElementType *element,
+                                       const DSCAllocator *allocator) {
+    if (queue == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_priority_queue_create(queue, DSC_TYPE_BYTES, element, allocator);
+}
+
+DSCError dsc_priority_queue_deinit(DSCPriorityQueue *queue) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_priority_queue_release(queue, queue->data.c_ptr, queue->size);
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = queue->allocator;
+
+    dsc_free(&allocator, queue->free_ids);
+    dsc_free(&allocator, queue->positions);
+    dsc_free(&allocator, queue->ids);
+    dsc_data_free(&queue->data, queue->type, 0, &allocator);
+    dsc_free(&allocator, queue);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_set_max_first(DSCPriorityQueue *queue, bool max_first) {
+    if (queue == NULL || queue->size > 0) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    queue->max_first = max_first;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_size(const DSCPriorityQueue *queue, size_t *size) {
+    if (queue == NULL || size == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *size = queue->size;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_capacity(const DSCPriorityQueue *queue, size_t *capacity) {
+    if (queue == NULL || capacity == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *capacity = queue->capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_empty(const DSCPriorityQueue *queue, bool *is_empty) {
+    if (queue == NULL || is_empty == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *is_empty = queue->size == 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_reserve(DSCPriorityQueue *queue, size_t count) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count <= queue->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_priority_queue_resize(queue, count);
+}
+
+DSCError dsc_priority_queue_shrink_to_fit(DSCPriorityQueue *queue) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (queue->size == queue->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_priority_queue_resize(queue, queue->size);
+}
+
+DSCError dsc_priority_queue_set_growth(DSCPriorityQueue *queue,
+                                       const DSCGrowthPolicy *policy) {
+    if (queue == NULL || dsc_growth_invalid(policy)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    queue->growth = *policy;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_top(const DSCPriorityQueue *queue, void *result) {
+    if (queue == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (queue->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    return dsc_priority_queue_load(queue, queue->data.c_ptr, result);
+}
+
+DSCError dsc_priority_queue_push(DSCPriorityQueue *queue, void *data,
+                                 DSCPriorityHandle *handle) {
+    return dsc_priority_queue_push_range(queue, data, 1, handle);
+}
+
+DSCError dsc_priority_queue_push_range(DSCPriorityQueue *queue, void *data, size_t count,
+                                       DSCPriorityHandle *handles) {
+    if (queue == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_priority_queue_grow(queue, queue->size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    error = dsc_priority_queue_reserve_ids(queue, count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    const unsigned char *elements = data;
+    size_t old_size = queue->size;
+
+    if (queue->type != DSC_TYPE_STRING &&
+        (queue->type != DSC_TYPE_BYTES || queue->element.copy == NULL)) {
+        memcpy(dsc_priority_queue_record(queue, old_size), data, count * queue->element.size);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            error = dsc_priority_queue_store(queue, dsc_priority_queue_record(queue, old_size + i),
+                                             (void *) (elements + i * queue->element.size));
+            if (error != DSC_ERROR_OK) {
+                // Leave the queue as it was before the call
+                dsc_priority_queue_release(queue, dsc_priority_queue_record(queue, old_size), i);
+                return error;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t id = dsc_priority_queue_acquire(queue);
+
+        queue->ids[old_size + i] = id;
+        queue->positions[id] = old_size + i;
+
+        if (handles != NULL) {
+            handles[i] = id;
+        }
+    }
+
+    queue->size += count;
+
+    // Rebuilding costs O(size), sifting each new element in O(count log size)
+    if (count >= old_size) {
+        dsc_priority_queue_heapify(queue);
+    } else {
+        for (size_t i = old_size; i < queue->size; ++i) {
+            dsc_priority_queue_sift_up(queue, i);
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_pop(DSCPriorityQueue *queue, void *result) {
+    if (queue == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (queue->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    if (queue->type == DSC_TYPE_STRING) {
+        // Ownership of the string passes to the caller, who frees with free
+        char *string = dsc_allocator_export(&queue->allocator, queue->data.s_ptr[0]);
+        if (string == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        *(char **) result = string;
+    } else {
+        // Ownership of a record moves with its bytes
+        memcpy(result, queue->data.c_ptr, queue->element.size);
+    }
+
+    dsc_priority_queue_remove(queue, 0);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_pop_range(DSCPriorityQueue *queue, void *results, size_t count) {
+    if (queue == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count > queue->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    unsigned char *outputs = results;
+
+    for (size_t i = 0; i < count; ++i) {
+        DSCError error = dsc_priority_queue_pop(queue, outputs + i * queue->element.size);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_get(const DSCPriorityQueue *queue, DSCPriorityHandle handle,
+                                void *result) {
+    if (queue == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_priority_queue_valid(queue, handle)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    return dsc_priority_queue_load(
+        queue, dsc_priority_queue_record(queue, queue->positions[handle]), result);
+}
+
+DSCError dsc_priority_queue_update(DSCPriorityQueue *queue, DSCPriorityHandle handle,
+                                   void *data) {
+    if (queue == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_priority_queue_valid(queue, handle)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    // Copy the new element before releasing the old one, which may fail
+    DSCError error = dsc_priority_queue_store(queue, queue->scratch, data);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t index = queue->positions[handle];
+    unsigned char *record = dsc_priority_queue_record(queue, index);
+
+    dsc_priority_queue_release(queue, record, 1);
+    memcpy(record, queue->scratch, queue->element.size);
+    dsc_priority_queue_fix(queue, index);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_erase(DSCPriorityQueue *queue, DSCPriorityHandle handle) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_priority_queue_valid(queue, handle)) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    size_t index = queue->positions[handle];
+
+    dsc_priority_queue_release(queue, dsc_priority_queue_record(queue, index), 1);
+    dsc_priority_queue_remove(queue, index);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_clear(DSCPriorityQueue *queue) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_priority_queue_release(queue, queue->data.c_ptr, queue->size);
+
+    queue->size = 0;
+    queue->free_count = 0;
+    queue->next_id = 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_priority_queue_for_each(const DSCPriorityQueue *queue, DSCVisitor visitor,
+                                     void *context) {
+    if (queue == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < queue->size; ++i) {
+        if (!visitor(dsc_element_view(dsc_priority_queue_record(queue, i), queue->type),
+                     context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_priority_queue_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_priority_queue_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_priority_queue_save(const DSCPriorityQueue *queue, const char *path) {
+    if (queue == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, queue->type, queue->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_priority_queue_walk, queue);
+}
+
+DSCError dsc_priority_queue_stats(const DSCPriorityQueue *queue, DSCStats *stats) {
+    if (queue == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(queue), stats);
+
+    return DSC_ERROR_OK;
+}
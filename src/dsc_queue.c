@@ -17,122 +17,69 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <stdint.h>
 
 #include "../include/dsc_queue.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
 
 struct DSCQueue {
     DSCData data;    // The data stored in the queue
     size_t front;    // Index of the front element
-    size_t rear;     // Index of the rear element
+    size_t rear;     // Index one past the rear element
     size_t size;     // The number of elements currently in the queue
     size_t capacity; // The current capacity of the queue
     DSCType type;    // The type of the elements in the queue
+    DSCElementType element; // The element stride, and the callbacks of records
+    DSCGrowthPolicy growth; // How the capacity grows and shrinks
+    DSCAllocator allocator; // Source of the queue, its buffer and strings
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
-static bool dsc_queue_resize(DSCQueue *queue, size_t new_capacity) {
-    size_t old_capacity = queue->capacity;
-
-    switch (queue->type) {
-        case DSC_TYPE_CHAR: {
-            queue->data.c_ptr = realloc(queue->data.c_ptr, new_capacity * sizeof(char));
-            if (queue->data.c_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
-        
-        case DSC_TYPE_INT: {
-            queue->data.i_ptr = realloc(queue->data.i_ptr, new_capacity * sizeof(int));
-            if (queue->data.i_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
-
-        case DSC_TYPE_FLOAT: {
-            queue->data.f_ptr = realloc(queue->data.f_ptr, new_capacity * sizeof(float));
-            if (queue->data.f_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
-
-        case DSC_TYPE_DOUBLE: {
-            queue->data.d_ptr = realloc(queue->data.d_ptr, new_capacity * sizeof(double));
-            if (queue->data.d_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
+static inline unsigned char *dsc_queue_record(const DSCQueue *queue, size_t index) {
+    return (unsigned char *) queue->data.c_ptr + index * queue->element.size;
+}
 
-        case DSC_TYPE_STRING: {
-            queue->data.s_ptr = realloc(queue->data.s_ptr, new_capacity * sizeof(char *));
-            if (queue->data.s_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
+/* Move the elements into a buffer of new_capacity >= size slots, unwrapping
+ * the ring so that the front element lands at index 0. */
+static DSCError dsc_queue_resize(DSCQueue *queue, size_t new_capacity) {
+    DSCData new_data;
 
-        case DSC_TYPE_BOOL: {
-            queue->data.b_ptr = realloc(queue->data.b_ptr, new_capacity * sizeof(bool));
-            if (queue->data.b_ptr == NULL) {
-                return false;
-            }
-            break;
-        }
-        default:
-            return false;
+    DSCError error = dsc_data_malloc_stride(&new_data, queue->element.size, new_capacity,
+                                            &queue->allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
-    // Rearrange elements in case of circular buffer
-    if (queue->front > queue->rear) {
-        size_t count = old_capacity - queue->front;
-
-        switch (queue->type) {
-            case DSC_TYPE_CHAR: {
-                memmove(queue->data.c_ptr + new_capacity - count, queue->data.c_ptr + queue->front, count * sizeof(char));
-            }
-
-            case DSC_TYPE_INT: {
-                memmove(queue->data.i_ptr + new_capacity - count, queue->data.i_ptr + queue->front, count * sizeof(int));
-            }
-
-            case DSC_TYPE_FLOAT: {
-                memmove(queue->data.f_ptr + new_capacity - count, queue->data.f_ptr + queue->front, count * sizeof(float));
-            }
+    size_t stride = queue->element.size;
+    size_t head = queue->capacity - queue->front;
+    if (head > queue->size) {
+        head = queue->size;
+    }
 
-            case DSC_TYPE_DOUBLE: {
-                memmove(queue->data.d_ptr + new_capacity - count, queue->data.d_ptr + queue->front, count * sizeof(double));
-            }
+    memcpy(new_data.c_ptr, queue->data.c_ptr + queue->front * stride, head * stride);
+    memcpy(new_data.c_ptr + head * stride, queue->data.c_ptr, (queue->size - head) * stride);
 
-            case DSC_TYPE_STRING: {
-                memmove(queue->data.s_ptr + new_capacity - count, queue->data.s_ptr + queue->front, count * sizeof(char *));
-            }
-
-            case DSC_TYPE_BOOL: {
-                memmove(queue->data.b_ptr + new_capacity - count, queue->data.b_ptr + queue->front, count * sizeof(bool));
-            }
-
-            default: {
-                return false;
-            }
-        }
-        
-        queue->front = new_capacity - count;
-    }
+    dsc_free(&queue->allocator, queue->data.c_ptr);
 
+    queue->data = new_data;
+    queue->front = 0;
+    queue->rear = new_capacity > 0 ? queue->size % new_capacity : 0;
     queue->capacity = new_capacity;
+    DSC_STATS_REALLOC(&queue->stats);
 
-    return true;
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_queue_init(DSCQueue *new_queue, DSCType type) {
-    if (!dsc_type_is_valid(type)) {
-        return NULL;
-    }
+DSCError dsc_queue_init(DSCQueue **queue, DSCType type) {
+    return dsc_queue_init_allocator(queue, type, NULL);
+}
 
-    new_queue = malloc(sizeof new_queue);
+static DSCError dsc_queue_create(DSCQueue **queue, DSCType type,
+                                 const DSCElementType *element,
+                                 const DSCAllocator *allocator) {
+    DSCQueue *new_queue = dsc_alloc(allocator, sizeof(DSCQueue));
     if (new_queue == NULL) {
         return DSC_ERROR_OUT_OF_MEMORY;
     }
@@ -142,75 +89,45 @@ DSCError dsc_queue_init(DSCQueue *new_queue, DSCType type) {
     new_queue->size = 0;
     new_queue->capacity = DSC_QUEUE_INITIAL_CAPACITY;
     new_queue->type = type;
+    new_queue->element = *element;
+    new_queue->growth = DSC_GROWTH_POLICY_DEFAULT;
+    new_queue->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_queue->stats, &new_queue->allocator);
+
+    DSCError error = dsc_data_malloc_stride(&new_queue->data, element->size,
+                                            new_queue->capacity, &new_queue->allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, new_queue);
+        return error;
+    }
 
-    switch (new_queue->type) {
-        case DSC_TYPE_CHAR: {
-            new_queue->data.c_ptr = malloc(new_queue->capacity * sizeof(char));
-            if (new_queue->data.c_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
-        
-        case DSC_TYPE_INT: {
-            new_queue->data.i_ptr = malloc(new_queue->capacity * sizeof(int));
-            if (new_queue->data.i_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
-
-        case DSC_TYPE_FLOAT: {
-            new_queue->data.f_ptr = malloc(new_queue->capacity * sizeof(float));
-            if (new_queue->data.f_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
+    *queue = new_queue;
 
-        case DSC_TYPE_DOUBLE: {
-            new_queue->data.d_ptr = malloc(new_queue->capacity * sizeof(double));
-            if (new_queue->data.d_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    return DSC_ERROR_OK;
+}
 
-            break;
-        }
+DSCError dsc_queue_init_allocator(DSCQueue **queue, DSCType type,
+                                  const DSCAllocator *allocator) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        case DSC_TYPE_STRING: {
-            new_queue->data.s_ptr = malloc(new_queue->capacity * sizeof(char *));
-            if (new_queue->data.s_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
 
-            break;
-        }
+    DSCElementType element = dsc_element_of(type);
 
-        case DSC_TYPE_BOOL: {
-            new_queue->data.b_ptr = malloc(new_queue->capacity * sizeof(bool));
-            if (new_queue->data.b_ptr == NULL) {
-                free(new_queue);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-    
-            break;
-        }
+    return dsc_queue_create(queue, type, &element, allocator);
+}
 
-        default: {
-            free(new_queue);
-            return DSC_ERROR_OUT_OF_MEMORY;
-        }
+DSCError dsc_queue_init_bytes(DSCQueue **queue, const DSCElementType *element,
+                              const DSCAllocator *allocator) {
+    if (queue == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    return new_queue;
+    return dsc_queue_create(queue, DSC_TYPE_BYTES, element, allocator);
 }
 
 DSCError dsc_queue_deinit(DSCQueue *queue) {
@@ -218,60 +135,54 @@ DSCError dsc_queue_deinit(DSCQueue *queue) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Free the elements in the queue
-    for (size_t i = queue->front; i != queue->rear; ) {
-        if (queue->type == DSC_TYPE_STRING) {
-            free(queue->data.s_ptr[i]);
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = queue->allocator;
+
+    // The strings wrap around the ring, so free them before the buffer
+    if (queue->type == DSC_TYPE_STRING && dsc_allocator_frees(&allocator)) {
+        for (size_t i = 0, index = queue->front; i < queue->size; ++i) {
+            dsc_free(&allocator, queue->data.s_ptr[index]);
+            index = (index + 1) % queue->capacity;
         }
     }
 
-    switch (queue->type) {
-        case DSC_TYPE_CHAR: {
-            free(queue->data.c_ptr);
-            break;
-        }
-        
-        case DSC_TYPE_INT: {
-            free(queue->data.i_ptr);
-            break;
+    if (queue->type == DSC_TYPE_BYTES && queue->element.destroy != NULL) {
+        for (size_t i = 0, index = queue->front; i < queue->size; ++i) {
+            dsc_element_destroy(&queue->element, dsc_queue_record(queue, index), 1);
+            index = (index + 1) % queue->capacity;
         }
+    }
 
-        case DSC_TYPE_FLOAT: {
-            free(queue->data.f_ptr);
-            break;
-        }
+    dsc_data_free(&queue->data, queue->type, 0, &allocator);
+    dsc_free(&allocator, queue);
 
-        case DSC_TYPE_DOUBLE: {
-            free(queue->data.d_ptr);
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        case DSC_TYPE_STRING: {
-            for (size_t i = queue->front; i != queue->rear; i = (i + 1) % queue->capacity) {
-                free(queue->data.s_ptr[i]);
-            }
+DSCError dsc_queue_set_growth(DSCQueue *queue, const DSCGrowthPolicy *policy) {
+    if (queue == NULL || dsc_growth_invalid(policy)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-            free(queue->data.s_ptr);
-            break;
-        }
+    queue->growth = *policy;
 
-        case DSC_TYPE_BOOL: {
-            free(queue->data.b_ptr);
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        default: {
-            return DSC_ERROR_INVALID_ARGUMENT;
-        }
+DSCError dsc_queue_shrink_to_fit(DSCQueue *queue) {
+    if (queue == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    free(queue);
+    if (queue->size == queue->capacity) {
+        return DSC_ERROR_OK;
+    }
 
-    return DSC_ERROR_OK;
+    return dsc_queue_resize(queue, queue->size);
 }
 
 DSCError dsc_queue_size(const DSCQueue *queue, size_t *size) {
-    if (queue == NULL) {
+    if (queue == NULL || size == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -281,7 +192,7 @@ DSCError dsc_queue_size(const DSCQueue *queue, size_t *size) {
 }
 
 DSCError dsc_queue_capacity(const DSCQueue *queue, size_t *capacity) {
-    if (queue == NULL) {
+    if (queue == NULL || capacity == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -290,8 +201,8 @@ DSCError dsc_queue_capacity(const DSCQueue *queue, size_t *capacity) {
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_queue_is_empty(const DSCQueue *queue, bool *is_empty) {
-    if (queue == NULL) {
+DSCError dsc_queue_empty(const DSCQueue *queue, bool *is_empty) {
+    if (queue == NULL || is_empty == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -300,56 +211,47 @@ DSCError dsc_queue_is_empty(const DSCQueue *queue, bool *is_empty) {
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_queue_front(const DSCQueue *queue, void *front) {
-    if (queue == NULL) {
-        return DSC_ERROR_INVALID_ARGUMENT;
-    }
-    
-    if (queue->size == 0) {
-        return DSC_ERROR_EMPTY_CONTAINER;
-    }
-
+static DSCError dsc_queue_get(const DSCQueue *queue, size_t index, void *result) {
     switch (queue->type) {
         case DSC_TYPE_CHAR: {
-            *(char *) front = queue->data.c_ptr[queue->front];
+            *(char *) result = queue->data.c_ptr[index];
             break;
         }
-        
+
         case DSC_TYPE_INT: {
-            *(int *) front = queue->data.i_ptr[queue->front];
+            *(int *) result = queue->data.i_ptr[index];
             break;
         }
 
         case DSC_TYPE_FLOAT: {
-            *(float *) front = queue->data.f_ptr[queue->front];
+            *(float *) result = queue->data.f_ptr[index];
             break;
         }
 
         case DSC_TYPE_DOUBLE: {
-            *(double *) front = queue->data.d_ptr[queue->front];
+            *(double *) result = queue->data.d_ptr[index];
             break;
         }
 
         case DSC_TYPE_STRING: {
-            const char *string = queue->data.s_ptr[queue->front];
-
-            size_t string_size = strlen(string) + 1;
-            size_t front_size = strlen((char *) front);
-
-            if (string_size > front_size) {
+            char *copy = strdup(queue->data.s_ptr[index]);
+            if (copy == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy((char *) front, string, front_size - 1);
-            memset((char *) front + string_size, '\0', 1);
+            *(char **) result = copy;
             break;
         }
 
         case DSC_TYPE_BOOL: {
-            *(bool *) front = queue->data.b_ptr[queue->front];
+            *(bool *) result = queue->data.b_ptr[index];
             break;
         }
 
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&queue->element, result, dsc_queue_record(queue, index));
+        }
+
         default: {
             return DSC_ERROR_INVALID_TYPE;
         }
@@ -358,8 +260,8 @@ DSCError dsc_queue_front(const DSCQueue *queue, void *front) {
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_queue_back(const DSCQueue *queue, void *back) {
-    if (queue == NULL) {
+DSCError dsc_queue_front(const DSCQueue *queue, void *front) {
+    if (queue == NULL || front == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -367,58 +269,62 @@ DSCError dsc_queue_back(const DSCQueue *queue, void *back) {
         return DSC_ERROR_EMPTY_CONTAINER;
     }
 
-    size_t back_index = (queue->rear - 1 + queue->capacity) % queue->capacity;
+    return dsc_queue_get(queue, queue->front, front);
+}
 
-    switch (queue->type) {
-        case DSC_TYPE_CHAR: {
-            *(char *) back = queue->data.c_ptr[back_index];
-            break;
-        }
+DSCError dsc_queue_front_view(const DSCQueue *queue, DSCStringView *result) {
+    if (queue == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        case DSC_TYPE_INT: {
-            *(int *) back = queue->data.i_ptr[back_index];
-            break;
-        }
+    if (queue->type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
 
-        case DSC_TYPE_FLOAT: {
-            *(float *) back = queue->data.f_ptr[back_index];
-            break;
-        }
+    if (queue->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
 
-        case DSC_TYPE_DOUBLE: {
-            *(double *) back = queue->data.d_ptr[back_index];
-            break;
-        }
+    result->data = queue->data.s_ptr[queue->front];
+    result->length = strlen(result->data);
 
-        case DSC_TYPE_STRING: {
-            dsc_str_cpy((char *) back, queue->data.s_ptr[back_index]);
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        case DSC_TYPE_BOOL: {
-            *(bool *) back = queue->data.b_ptr[back_index];
-            break;
-        }
+DSCError dsc_queue_back(const DSCQueue *queue, void *back) {
+    if (queue == NULL || back == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        default: {
-            return DSC_ERROR_INVALID_TYPE;
-        }
+    if (queue->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
     }
 
-    return DSC_ERROR_OK;
+    size_t back_index = (queue->rear + queue->capacity - 1) % queue->capacity;
+
+    return dsc_queue_get(queue, back_index, back);
+}
+
+/* Resize the queue if the size reaches the capacity */
+static DSCError dsc_queue_grow(DSCQueue *queue) {
+    if (queue->size < queue->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = dsc_growth_next(&queue->growth, queue->capacity,
+                                          queue->size + 1, queue->element.size);
+
+    return dsc_queue_resize(queue, new_capacity);
 }
 
 DSCError dsc_queue_push(DSCQueue *queue, void *data) {
-    if (queue == NULL) {
+    if (queue == NULL || data == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Resize the queue if the size reaches the capacity
-    if (queue->size >= queue->capacity) {
-        size_t new_capacity = queue->capacity * 1.5;
-        if (!dsc_queue_resize(queue, new_capacity)) {
-            return DSC_ERROR_OUT_OF_MEMORY;
-        }
+    DSCError error = dsc_queue_grow(queue);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     switch (queue->type) {
@@ -426,7 +332,7 @@ DSCError dsc_queue_push(DSCQueue *queue, void *data) {
             queue->data.c_ptr[queue->rear] = *(char *) data;
             break;
         }
-        
+
         case DSC_TYPE_INT: {
             queue->data.i_ptr[queue->rear] = *(int *) data;
             break;
@@ -443,13 +349,10 @@ DSCError dsc_queue_push(DSCQueue *queue, void *data) {
         }
 
         case DSC_TYPE_STRING: {
-            size_t string_size = strlen(*(char **) data) + 1;
-            queue->data.s_ptr[queue->size] = malloc(string_size);
-            if (queue->data.s_ptr[queue->size] == NULL) {
+            queue->data.s_ptr[queue->rear] = dsc_strdup(&queue->allocator, *(char **) data);
+            if (queue->data.s_ptr[queue->rear] == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
-
-            dsc_str_cpy(queue->data.s_ptr[queue->size], *(char **) data);
             break;
         }
 
@@ -458,6 +361,15 @@ DSCError dsc_queue_push(DSCQueue *queue, void *data) {
             break;
         }
 
+        case DSC_TYPE_BYTES: {
+            error = dsc_element_copy(&queue->element, dsc_queue_record(queue, queue->rear),
+                                     data);
+            if (error != DSC_ERROR_OK) {
+                return error;
+            }
+            break;
+        }
+
         default: {
             return DSC_ERROR_INVALID_TYPE;
         }
@@ -469,8 +381,46 @@ DSCError dsc_queue_push(DSCQueue *queue, void *data) {
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_queue_push_move(DSCQueue *queue, void *data) {
+    if (queue == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only strings and records own anything that could be moved
+    if (queue->type != DSC_TYPE_STRING && queue->type != DSC_TYPE_BYTES) {
+        return dsc_queue_push(queue, data);
+    }
+
+    DSCError error = dsc_queue_grow(queue);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (queue->type == DSC_TYPE_BYTES) {
+        // Ownership of the record moves with its bytes
+        memcpy(dsc_queue_record(queue, queue->rear), data, queue->element.size);
+    } else {
+        char *string = *(char **) data;
+        char *owned = dsc_allocator_adopt(&queue->allocator, string);
+        if (owned == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        if (owned != string) {
+            free(string);
+        }
+
+        queue->data.s_ptr[queue->rear] = owned;
+    }
+
+    queue->rear = (queue->rear + 1) % queue->capacity;
+    queue->size++;
+
+    return DSC_ERROR_OK;
+}
+
 DSCError dsc_queue_pop(DSCQueue *queue, void *data) {
-    if (queue == NULL) {
+    if (queue == NULL || data == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -494,11 +444,22 @@ DSCError dsc_queue_pop(DSCQueue *queue, void *data) {
         case DSC_TYPE_DOUBLE:
             *(double *) data = queue->data.d_ptr[queue->front];
             break;
-        case DSC_TYPE_STRING:
-            *(char **) data = queue->data.s_ptr[queue->front];
-            free(queue->data.s_ptr[queue->front]);
+        case DSC_TYPE_STRING: {
+            // Ownership of the string passes to the caller, who frees with free
+            char *string = dsc_allocator_export(&queue->allocator,
+                                                queue->data.s_ptr[queue->front]);
+            if (string == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) data = string;
             queue->data.s_ptr[queue->front] = NULL;
             break;
+        }
+        case DSC_TYPE_BYTES:
+            // Ownership of the record moves with its bytes
+            memcpy(data, dsc_queue_record(queue, queue->front), queue->element.size);
+            break;
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -506,5 +467,117 @@ DSCError dsc_queue_pop(DSCQueue *queue, void *data) {
     queue->front = (queue->front + 1) % queue->capacity;
     queue->size--;
 
+    // Give memory back after a burst; a failed shrink keeps the larger buffer
+    size_t new_capacity = dsc_growth_shrink(&queue->growth, queue->size, queue->capacity,
+                                            DSC_QUEUE_INITIAL_CAPACITY,
+                                            queue->element.size);
+    if (new_capacity < queue->capacity) {
+        dsc_queue_resize(queue, new_capacity);
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_queue_swap(DSCQueue *queue, DSCQueue *other) {
+    if (queue == NULL || other == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (queue->type != other->type || !dsc_element_equal(&queue->element, &other->element) ||
+        !dsc_allocator_equal(&queue->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCData data = queue->data;
+    size_t front = queue->front;
+    size_t rear = queue->rear;
+    size_t size = queue->size;
+    size_t capacity = queue->capacity;
+
+    queue->data = other->data;
+    queue->front = other->front;
+    queue->rear = other->rear;
+    queue->size = other->size;
+    queue->capacity = other->capacity;
+
+    other->data = data;
+    other->front = front;
+    other->rear = rear;
+    other->size = size;
+    other->capacity = capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_queue_cursor_init(const DSCQueue *queue, DSCQueueCursor *cursor) {
+    if (queue == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    cursor->queue = queue;
+    cursor->index = 0;
+
+    return DSC_ERROR_OK;
+}
+
+bool dsc_queue_cursor_next(DSCQueueCursor *cursor, const void **element) {
+    const DSCQueue *queue = cursor->queue;
+
+    if (cursor->index >= queue->size) {
+        return false;
+    }
+
+    size_t index = (queue->front + cursor->index) % queue->capacity;
+    *element = dsc_element_view(dsc_queue_record(queue, index), queue->type);
+    cursor->index++;
+
+    return true;
+}
+
+DSCError dsc_queue_for_each(const DSCQueue *queue, DSCVisitor visitor, void *context) {
+    if (queue == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The elements run from front to the end of the buffer, then wrap to 0
+    size_t index = queue->front;
+
+    for (size_t i = 0; i < queue->size; ++i) {
+        if (!visitor(dsc_element_view(dsc_queue_record(queue, index), queue->type), context)) {
+            break;
+        }
+
+        if (++index == queue->capacity) {
+            index = 0;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_queue_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_queue_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_queue_save(const DSCQueue *queue, const char *path) {
+    if (queue == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, queue->type, queue->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_queue_walk, queue);
+}
+
+DSCError dsc_queue_stats(const DSCQueue *queue, DSCStats *stats) {
+    if (queue == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(queue), stats);
+
     return DSC_ERROR_OK;
 }
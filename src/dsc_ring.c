@@ -0,0 +1,620 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_ring.h"
+
+/* Both rings keep their read-mostly configuration on its own cache line and
+ * pad every index that a different thread writes onto a line of its own, so
+ * a producer storing its index never invalidates the consumer's line. */
+
+struct DSCSpscRing {
+    unsigned char *slots;   // capacity slots of element.size bytes
+    size_t mask;            // capacity - 1
+    DSCType type;           // The type of the elements in the ring
+    DSCElementType element; // The slot stride, and the callbacks of records
+    DSCAllocator allocator; // Source of the ring and its slots
+    char pad_config[DSC_CACHE_LINE];
+
+    _Atomic size_t head;    // Next position to pop, written by the consumer
+    size_t cached_tail;     // The consumer's last view of tail
+    char pad_head[DSC_CACHE_LINE - 2 * sizeof(size_t)];
+
+    _Atomic size_t tail;    // Next position to push, written by the producer
+    size_t cached_head;     // The producer's last view of head
+    char pad_tail[DSC_CACHE_LINE - 2 * sizeof(size_t)];
+};
+
+struct DSCMpmcRing {
+    unsigned char *cells;   // capacity cells of stride bytes
+    size_t mask;            // capacity - 1
+    size_t stride;          // The size of one cell
+    size_t offset;          // Where the element starts inside a cell
+    DSCType type;           // The type of the elements in the ring
+    DSCElementType element; // The element size, and the callbacks of records
+    DSCAllocator allocator; // Source of the ring and its cells
+    char pad_config[DSC_CACHE_LINE];
+
+    _Atomic size_t enqueue_pos; // Next position a producer claims
+    char pad_enqueue[DSC_CACHE_LINE - sizeof(size_t)];
+
+    _Atomic size_t dequeue_pos; // Next position a consumer claims
+    char pad_dequeue[DSC_CACHE_LINE - sizeof(size_t)];
+};
+
+/* Every MPMC cell starts with the sequence number of the position it is ready
+ * for: pos while free for the producer of pos, pos + 1 once that producer has
+ * filled it, and pos + capacity once the consumer of pos has emptied it. */
+typedef _Atomic size_t DSCRingSequence;
+
+/* Helpers shared by both rings */
+
+static DSCError dsc_ring_round(size_t capacity, size_t *rounded) {
+    if (capacity == 0 || capacity > SIZE_MAX / 2) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t result = 2;
+    while (result < capacity) {
+        result *= 2;
+    }
+
+    *rounded = result;
+
+    return DSC_ERROR_OK;
+}
+
+/* Copy a string's characters ahead of claiming a slot, since a claimed slot
+ * can no longer be given back */
+static DSCError dsc_ring_prepare(DSCType type, void *value, char **copy) {
+    *copy = NULL;
+
+    if (type != DSC_TYPE_STRING) {
+        return DSC_ERROR_OK;
+    }
+
+    *copy = strdup(*(char **) value);
+
+    return *copy != NULL ? DSC_ERROR_OK : DSC_ERROR_OUT_OF_MEMORY;
+}
+
+/* Write a prepared element into its slot: the string copy if there is one,
+ * the caller's bytes otherwise */
+static inline void dsc_ring_store(const DSCElementType *element, void *slot,
+                                  const void *value, char **copy) {
+    memcpy(slot, *copy != NULL ? (const void *) copy : value, element->size);
+}
+
+static void dsc_ring_release(DSCType type, const DSCElementType *element, void *slot) {
+    if (type == DSC_TYPE_STRING) {
+        free(*(char **) slot);
+    } else if (type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(element, slot, 1);
+    }
+}
+
+/* Single producer, single consumer */
+
+static inline unsigned char *dsc_spsc_ring_slot(const DSCSpscRing *ring, size_t pos) {
+    return ring->slots + (pos & ring->mask) * ring->element.size;
+}
+
+static DSCError dsc_spsc_ring_create(DSCSpscRing **ring, DSCType type,
+                                     const DSCElementType *element, size_t capacity,
+                                     const DSCAllocator *allocator) {
+    size_t rounded;
+    DSCError error = dsc_ring_round(capacity, &rounded);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (element->size > SIZE_MAX / rounded) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCSpscRing *new_ring = dsc_alloc(allocator, sizeof(DSCSpscRing));
+    if (new_ring == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_ring->slots = dsc_alloc(allocator, rounded * element->size);
+    if (new_ring->slots == NULL) {
+        dsc_free(allocator, new_ring);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_ring->mask = rounded - 1;
+    new_ring->type = type;
+    new_ring->element = *element;
+    new_ring->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    atomic_init(&new_ring->head, 0);
+    atomic_init(&new_ring->tail, 0);
+    new_ring->cached_tail = 0;
+    new_ring->cached_head = 0;
+
+    *ring = new_ring;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_spsc_ring_init(DSCSpscRing **ring, DSCType type, size_t capacity) {
+    return dsc_spsc_ring_init_allocator(ring, type, capacity, NULL);
+}
+
+DSCError dsc_spsc_ring_init_allocator(DSCSpscRing **ring, DSCType type,
+                                      size_t capacity,
+                                      const DSCAllocator *allocator) {
+    if (ring == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_spsc_ring_create(ring, type, &element, capacity, allocator);
+}
+
+DSCError dsc_spsc_ring_init_bytes(DSCSpscRing **ring,
+                                  const DSCElementType *element,
+                                  size_t capacity,
+                                  const DSCAllocator *allocator) {
+    if (ring == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_spsc_ring_create(ring, DSC_TYPE_BYTES, element, capacity, allocator);
+}
+
+DSCError dsc_spsc_ring_deinit(DSCSpscRing *ring) {
+    if (ring == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    for (size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed); pos != tail; ++pos) {
+        dsc_ring_release(ring->type, &ring->element, dsc_spsc_ring_slot(ring, pos));
+    }
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = ring->allocator;
+    dsc_free(&allocator, ring->slots);
+    dsc_free(&allocator, ring);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_spsc_ring_capacity(const DSCSpscRing *ring, size_t *result) {
+    if (ring == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = ring->mask + 1;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_spsc_ring_size(const DSCSpscRing *ring, size_t *result) {
+    if (ring == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Read head first: tail only moves forward, so it cannot fall behind it
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t size = tail - head;
+
+    *result = size <= ring->mask + 1 ? size : ring->mask + 1;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_spsc_ring_push_batch(DSCSpscRing *ring, void *values, size_t count,
+                                  size_t *pushed) {
+    if (ring == NULL || values == NULL || pushed == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t capacity = ring->mask + 1;
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t room = capacity - (tail - ring->cached_head);
+
+    // Only look at the consumer's index when the cached one says we are short
+    if (room < count) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        room = capacity - (tail - ring->cached_head);
+    }
+
+    size_t n = count < room ? count : room;
+    size_t stride = ring->element.size;
+    DSCError error = DSC_ERROR_OK;
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char *value = (unsigned char *) values + i * stride;
+        char *copy;
+
+        error = dsc_ring_prepare(ring->type, value, &copy);
+        if (error != DSC_ERROR_OK) {
+            n = i;
+            break;
+        }
+
+        dsc_ring_store(&ring->element, dsc_spsc_ring_slot(ring, tail + i), value, &copy);
+    }
+
+    // One release store publishes the whole batch
+    atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+    *pushed = n;
+
+    return error;
+}
+
+DSCError dsc_spsc_ring_pop_batch(DSCSpscRing *ring, void *results, size_t count,
+                                 size_t *popped) {
+    if (ring == NULL || results == NULL || popped == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t available = ring->cached_tail - head;
+
+    if (available < count) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        available = ring->cached_tail - head;
+    }
+
+    size_t n = count < available ? count : available;
+    size_t stride = ring->element.size;
+
+    // Strings and records are handed over as they are
+    for (size_t i = 0; i < n; ++i) {
+        memcpy((unsigned char *) results + i * stride, dsc_spsc_ring_slot(ring, head + i),
+               stride);
+    }
+
+    atomic_store_explicit(&ring->head, head + n, memory_order_release);
+    *popped = n;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_spsc_ring_push(DSCSpscRing *ring, void *value) {
+    size_t pushed;
+
+    DSCError error = dsc_spsc_ring_push_batch(ring, value, 1, &pushed);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    return pushed == 1 ? DSC_ERROR_OK : DSC_ERROR_FULL;
+}
+
+DSCError dsc_spsc_ring_pop(DSCSpscRing *ring, void *result) {
+    size_t popped;
+
+    DSCError error = dsc_spsc_ring_pop_batch(ring, result, 1, &popped);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    return popped == 1 ? DSC_ERROR_OK : DSC_ERROR_EMPTY_CONTAINER;
+}
+
+/* Multiple producers, multiple consumers */
+
+static inline DSCRingSequence *dsc_mpmc_ring_sequence(const DSCMpmcRing *ring, size_t pos) {
+    return (DSCRingSequence *) (void *) (ring->cells + (pos & ring->mask) * ring->stride);
+}
+
+static inline unsigned char *dsc_mpmc_ring_slot(const DSCMpmcRing *ring, size_t pos) {
+    return ring->cells + (pos & ring->mask) * ring->stride + ring->offset;
+}
+
+/* Claim up to max consecutive positions starting at *position. A cell is
+ * ready for its position when its sequence equals the position plus lag: 0
+ * for producers, 1 for consumers. Every cell counted as ready stays ready
+ * until the claim, since only the owner of a position changes its cell, and
+ * the compare-and-swap fails if anyone else claimed one of them first.
+ *
+ * Returns the number of positions claimed, 0 when the ring is full (for
+ * producers) or empty (for consumers). */
+static size_t dsc_mpmc_ring_claim(const DSCMpmcRing *ring, _Atomic size_t *position,
+                                  size_t lag, size_t max, size_t *first) {
+    size_t pos = atomic_load_explicit(position, memory_order_relaxed);
+
+    for (;;) {
+        size_t seq = atomic_load_explicit(dsc_mpmc_ring_sequence(ring, pos),
+                                          memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + lag);
+
+        if (diff < 0) {
+            // The cell is still a lap behind: nothing to claim
+            return 0;
+        }
+
+        if (diff > 0) {
+            // Another thread claimed pos already
+            pos = atomic_load_explicit(position, memory_order_relaxed);
+            continue;
+        }
+
+        size_t ready = 1;
+        while (ready < max &&
+               atomic_load_explicit(dsc_mpmc_ring_sequence(ring, pos + ready),
+                                    memory_order_acquire) == pos + ready + lag) {
+            ready++;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(position, &pos, pos + ready,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            *first = pos;
+            return ready;
+        }
+    }
+}
+
+static DSCError dsc_mpmc_ring_create(DSCMpmcRing **ring, DSCType type,
+                                     const DSCElementType *element, size_t capacity,
+                                     const DSCAllocator *allocator) {
+    size_t rounded;
+    DSCError error = dsc_ring_round(capacity, &rounded);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    // Records may need any alignment; built-in elements fit after the
+    // sequence number as they are
+    size_t align = type == DSC_TYPE_BYTES ? alignof(max_align_t) : sizeof(DSCRingSequence);
+    size_t offset = sizeof(DSCRingSequence) > align ? sizeof(DSCRingSequence) : align;
+
+    if (element->size > SIZE_MAX / 2 - offset - align) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t stride = (offset + element->size + align - 1) & ~(align - 1);
+
+    if (stride > SIZE_MAX / rounded) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCMpmcRing *new_ring = dsc_alloc(allocator, sizeof(DSCMpmcRing));
+    if (new_ring == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_ring->cells = dsc_alloc(allocator, rounded * stride);
+    if (new_ring->cells == NULL) {
+        dsc_free(allocator, new_ring);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_ring->mask = rounded - 1;
+    new_ring->stride = stride;
+    new_ring->offset = offset;
+    new_ring->type = type;
+    new_ring->element = *element;
+    new_ring->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    atomic_init(&new_ring->enqueue_pos, 0);
+    atomic_init(&new_ring->dequeue_pos, 0);
+
+    for (size_t i = 0; i < rounded; ++i) {
+        atomic_init(dsc_mpmc_ring_sequence(new_ring, i), i);
+    }
+
+    *ring = new_ring;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_init(DSCMpmcRing **ring, DSCType type, size_t capacity) {
+    return dsc_mpmc_ring_init_allocator(ring, type, capacity, NULL);
+}
+
+DSCError dsc_mpmc_ring_init_allocator(DSCMpmcRing **ring, DSCType type,
+                                      size_t capacity,
+                                      const DSCAllocator *allocator) {
+    if (ring == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_mpmc_ring_create(ring, type, &element, capacity, allocator);
+}
+
+DSCError dsc_mpmc_ring_init_bytes(DSCMpmcRing **ring,
+                                  const DSCElementType *element,
+                                  size_t capacity,
+                                  const DSCAllocator *allocator) {
+    if (ring == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_mpmc_ring_create(ring, DSC_TYPE_BYTES, element, capacity, allocator);
+}
+
+DSCError dsc_mpmc_ring_deinit(DSCMpmcRing *ring) {
+    if (ring == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t end = atomic_load_explicit(&ring->enqueue_pos, memory_order_acquire);
+
+    for (size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_acquire);
+         pos != end; ++pos) {
+        dsc_ring_release(ring->type, &ring->element, dsc_mpmc_ring_slot(ring, pos));
+    }
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = ring->allocator;
+    dsc_free(&allocator, ring->cells);
+    dsc_free(&allocator, ring);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_capacity(const DSCMpmcRing *ring, size_t *result) {
+    if (ring == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = ring->mask + 1;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_size(const DSCMpmcRing *ring, size_t *result) {
+    if (ring == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t dequeue = atomic_load_explicit(&ring->dequeue_pos, memory_order_acquire);
+    size_t enqueue = atomic_load_explicit(&ring->enqueue_pos, memory_order_acquire);
+    size_t size = enqueue - dequeue;
+
+    // Both positions may have moved on between the two loads
+    *result = size <= ring->mask + 1 ? size : ring->mask + 1;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_push(DSCMpmcRing *ring, void *value) {
+    if (ring == NULL || value == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    char *copy;
+    DSCError error = dsc_ring_prepare(ring->type, value, &copy);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t pos;
+    if (dsc_mpmc_ring_claim(ring, &ring->enqueue_pos, 0, 1, &pos) == 0) {
+        free(copy);
+        return DSC_ERROR_FULL;
+    }
+
+    dsc_ring_store(&ring->element, dsc_mpmc_ring_slot(ring, pos), value, &copy);
+    atomic_store_explicit(dsc_mpmc_ring_sequence(ring, pos), pos + 1, memory_order_release);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_pop(DSCMpmcRing *ring, void *result) {
+    size_t popped;
+
+    DSCError error = dsc_mpmc_ring_pop_batch(ring, result, 1, &popped);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    return popped == 1 ? DSC_ERROR_OK : DSC_ERROR_EMPTY_CONTAINER;
+}
+
+DSCError dsc_mpmc_ring_push_batch(DSCMpmcRing *ring, void *values, size_t count,
+                                  size_t *pushed) {
+    if (ring == NULL || values == NULL || pushed == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t stride = ring->element.size;
+    *pushed = 0;
+
+    // Strings are copied one at a time, before each claim, so that a failed
+    // copy never leaves a claimed cell unfilled
+    if (ring->type == DSC_TYPE_STRING) {
+        while (*pushed < count) {
+            DSCError error = dsc_mpmc_ring_push(ring, (unsigned char *) values +
+                                                          *pushed * stride);
+            if (error == DSC_ERROR_FULL) {
+                break;
+            }
+
+            if (error != DSC_ERROR_OK) {
+                return error;
+            }
+
+            (*pushed)++;
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    while (*pushed < count) {
+        size_t first;
+        size_t n = dsc_mpmc_ring_claim(ring, &ring->enqueue_pos, 0, count - *pushed, &first);
+        if (n == 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(dsc_mpmc_ring_slot(ring, first + i),
+                   (unsigned char *) values + (*pushed + i) * stride, stride);
+            atomic_store_explicit(dsc_mpmc_ring_sequence(ring, first + i), first + i + 1,
+                                  memory_order_release);
+        }
+
+        *pushed += n;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_mpmc_ring_pop_batch(DSCMpmcRing *ring, void *results, size_t count,
+                                 size_t *popped) {
+    if (ring == NULL || results == NULL || popped == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t stride = ring->element.size;
+    size_t capacity = ring->mask + 1;
+    *popped = 0;
+
+    while (*popped < count) {
+        size_t first;
+        size_t n = dsc_mpmc_ring_claim(ring, &ring->dequeue_pos, 1, count - *popped, &first);
+        if (n == 0) {
+            break;
+        }
+
+        // Strings and records are handed over as they are
+        for (size_t i = 0; i < n; ++i) {
+            memcpy((unsigned char *) results + (*popped + i) * stride,
+                   dsc_mpmc_ring_slot(ring, first + i), stride);
+            atomic_store_explicit(dsc_mpmc_ring_sequence(ring, first + i),
+                                  first + i + capacity, memory_order_release);
+        }
+
+        *popped += n;
+    }
+
+    return DSC_ERROR_OK;
+}
@@ -18,243 +18,178 @@
 #include <stdlib.h>
 
 #include "../include/dsc_set.h"
-#include "../include/dsc_utils.h"
-
-typedef struct DSCSetEntry DSCSetEntry;
-
-struct DSCSetEntry {
-    DSCData key;           // The key stored in the entry
-    DSCSetEntry *next;     // Pointer to the next entry in case of collisions
-};
+#include "dsc_snapshot_file.h"
+#include "dsc_table.h"
 
 struct DSCSet {
-    DSCSetEntry **buckets; // Array of pointers to entries
-    size_t size;           // The number of elements currently in the hash set
-    size_t capacity;       // The current capacity of the hash set
-    DSCType type;          // The type of the set elements
+    DSCTable table; // Keys-only open-addressing table holding the elements
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
-static bool dsc_set_rehash(DSCSet *set, size_t new_capacity) {
-    DSCSetEntry **new_buckets = calloc(new_capacity, sizeof(DSCSetEntry *));
-    if (new_buckets == NULL) {
-        return false;
-    }
-
-    // Rehash all the elements into the new buckets
-    for (size_t i = 0; i < set->capacity; ++i) {
-        DSCSetEntry *entry = set->buckets[i];
-        while (entry) {
-            DSCSetEntry *next = entry->next;
-            uint32_t index;
-
-            switch (set->type) {
-                case DSC_TYPE_CHAR: {
-                    index = dsc_hash(&entry->key.c, set->type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_INT: {
-                    index = dsc_hash(&entry->key.i, set->type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_FLOAT: {
-                    index = dsc_hash(&entry->key.f, set->type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_DOUBLE: {
-                    index = dsc_hash(&entry->key.d, set->type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_STRING: {
-                    index = dsc_hash(&entry->key.s, set->type, new_capacity);
-                    break;
-                }
-
-                case DSC_TYPE_BOOL: {
-                    index = dsc_hash(&entry->key.s, set->type, new_capacity);
-                    break;
-                }
-            }
-
-            entry->next = new_buckets[index];
-            new_buckets[index] = entry;
-            entry = next;
-        }
+DSCError dsc_set_init(DSCSet **new_set, DSCType type) {
+    return dsc_set_init_allocator(new_set, type, NULL);
+}
+
+static DSCError dsc_set_create(DSCSet **new_set, DSCType type,
+                               const DSCElementType *element,
+                               const DSCAllocator *allocator) {
+    DSCSet *set = dsc_alloc(allocator, sizeof(DSCSet));
+    if (set == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    // The table copies the allocator, counting one included
+    DSCAllocator table_allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&set->stats, &table_allocator);
+
+    DSCError error = dsc_table_init(&set->table, type, element, DSC_TYPE_UNKNOWN, NULL,
+                                    DSC_SET_INITIAL_CAPACITY, &table_allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, set);
+        return error;
     }
 
-    free(set->buckets);
-    set->buckets = new_buckets;
-    set->capacity = new_capacity;
+#ifdef DSC_STATS
+    set->table.stats = &set->stats;
+#endif
+
+    *new_set = set;
 
-    return true;
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_set_init(DSCSet *new_set, DSCType type) {
-    if (!dsc_type_is_valid(type)) {
+DSCError dsc_set_init_allocator(DSCSet **new_set, DSCType type,
+                                const DSCAllocator *allocator) {
+    if (new_set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
         return DSC_ERROR_INVALID_TYPE;
     }
 
-    new_set = malloc(sizeof new_set);
-    if (new_set == NULL) {
-        return DSC_ERROR_OUT_OF_MEMORY;
+    return dsc_set_create(new_set, type, NULL, allocator);
+}
+
+DSCError dsc_set_init_bytes(DSCSet **new_set, const DSCElementType *element,
+                            const DSCAllocator *allocator) {
+    if (new_set == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    new_set->size = 0;
-    new_set->capacity = DSC_SET_INITIAL_CAPACITY;
-    new_set->type = type;
+    return dsc_set_create(new_set, DSC_TYPE_BYTES, element, allocator);
+}
 
-    new_set->buckets = calloc(new_set->capacity, sizeof(DSCSetEntry *));
-    if (new_set->buckets == NULL) {
-        free(new_set);
-        return DSC_ERROR_OUT_OF_MEMORY;
+DSCError dsc_set_incremental_rehash(DSCSet *set, bool enabled) {
+    if (set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
+    dsc_table_set_incremental(&set->table, enabled);
+
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_set_deinit(DSCSet *set) {
-    if (set == NULL) { 
+DSCError dsc_set_use_string_pool(DSCSet *set, DSCStringPool *pool) {
+    if (set == NULL || pool == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Free all of the entries in the set
-    for (size_t i = 0; i < set->capacity; ++i) {
-        DSCSetEntry *curr = set->buckets[i];
-
-        while (curr) {
-            if (set->type == DSC_TYPE_STRING) {
-                free(curr->key.s);
-            }
+    return dsc_table_set_pool(&set->table, pool);
+}
 
-            DSCSetEntry *next = curr->next;
-            free(curr);
-            curr = next;
-        }
+DSCError dsc_set_deinit(DSCSet *set) {
+    if (set == NULL) { 
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Free the buckets array and the set itself
-    free(set->buckets);
-    free(set);
+    // The table's allocator lives inside the set, so copy it out first
+    DSCAllocator allocator = set->table.allocator;
+
+    dsc_table_deinit(&set->table);
+    dsc_free(&allocator, set);
     
     return DSC_ERROR_OK;
 }
 
 DSCError dsc_set_size(const DSCSet *set, size_t *size) {
-    if (set == NULL) {
+    if (set == NULL || size == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    *size = set->size;
+    *size = set->table.size;
 
     return DSC_ERROR_OK;
 }
 
 DSCError dsc_set_capacity(const DSCSet *set, size_t *capacity) {
-    if (set == NULL) {
+    if (set == NULL || capacity == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    *capacity = set->capacity;
+    *capacity = set->table.capacity;
 
     return DSC_ERROR_OK;
 }
 
 DSCError dsc_set_load_factor(const DSCSet *set, double *load_factor) {
-    if (set == NULL) {
+    if (set == NULL || load_factor == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    *load_factor = (double) set->size / set->capacity;
+    *load_factor = (double) set->table.size / set->table.capacity;
 
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_set_is_empty(const DSCSet *set, bool *is_empty) {
-    if (set == NULL) {
+DSCError dsc_set_empty(const DSCSet *set, bool *is_empty) {
+    if (set == NULL || is_empty == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    *is_empty = set->size == 0;
+    *is_empty = set->table.size == 0;
 
     return DSC_ERROR_OK;
 }
 
 DSCError dsc_set_contains(const DSCSet *set, void *key, bool *contains) {
-    if (set == NULL || key == NULL) {
+    if (set == NULL || key == NULL || contains == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Hash the value to determine the bucket index
-    uint32_t index = dsc_hash(key, set->type, set->capacity);
+    *contains = dsc_table_find(&set->table, dsc_table_load(key, set->table.key_type), NULL);
 
-    *contains = false;
+    return DSC_ERROR_OK;
+}
 
-    // Search for the value in the bucket
-    DSCSetEntry *entry = set->buckets[index];
-    while (entry) {
-        switch (set->type) {
-            case DSC_TYPE_CHAR: {
-                if (entry->key.c == *(char *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-    
-                break;
-            }
-
-            case DSC_TYPE_INT: {
-                if (entry->key.i == *(int *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-
-            case DSC_TYPE_FLOAT: {
-                if (entry->key.f == *(float *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-
-            case DSC_TYPE_DOUBLE: {
-                if (entry->key.d == *(double *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-
-            case DSC_TYPE_STRING: {
-                if (strcmp(entry->key.s, *(char **) key) == 0) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-
-            case DSC_TYPE_BOOL: {
-                if (entry->key.b == *(bool *) key) {
-                    *contains = true;
-                    return DSC_ERROR_OK;
-                }
-
-                break;
-            }
-        }
+DSCError dsc_set_contains_batch(const DSCSet *set, void *keys, size_t count,
+                                bool *results) {
+    if (set == NULL || keys == NULL || results == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_table_find_batch(&set->table, keys, count, NULL, results);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_set_reserve(DSCSet *set, size_t count) {
+    if (set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    return dsc_table_reserve(&set->table, count);
+}
 
-        entry = entry->next;
+DSCError dsc_set_parallel_insert_range(DSCSet *set, void *keys, size_t count,
+                                       DSCThreadPool *pool) {
+    if (set == NULL || keys == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    return DSC_ERROR_NOT_FOUND;
+    return dsc_table_insert_parallel(&set->table, keys, NULL, count, pool);
 }
 
 DSCError dsc_set_insert(DSCSet *set, void *key) {
@@ -262,207 +197,185 @@ DSCError dsc_set_insert(DSCSet *set, void *key) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    bool contains;
-    dsc_set_contains(set, key, &contains);
+    DSCData unused = {0};
 
-    if (contains) {
-        return DSC_ERROR_ALREADY_EXISTS;
-    }
+    return dsc_table_insert(&set->table, dsc_table_load(key, set->table.key_type), unused);
+}
 
-    // Resize the set if the load factor exceeds the threshold
-    if (set->size >= DSC_SET_LOAD_FACTOR * set->capacity) {
-        size_t new_capacity = set->capacity * 2;
-        if (!dsc_set_rehash(set, new_capacity)) {
-            return DSC_ERROR_OUT_OF_MEMORY;
-        }
+DSCError dsc_set_insert_move(DSCSet *set, void *key) {
+    if (set == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    DSCSetEntry *new_entry = malloc(sizeof new_entry);
-    if (new_entry == NULL) {
-        return DSC_ERROR_OUT_OF_MEMORY;
+    DSCData unused = {0};
+
+    return dsc_table_insert_move(&set->table, dsc_table_load(key, set->table.key_type), unused);
+}
+
+DSCError dsc_set_erase(DSCSet *set, void *key) {
+    if (set == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    switch (set->type) {
-        case DSC_TYPE_CHAR: {
-            new_entry->key.c = *(char *) key;
-            break;
-        }
+    return dsc_table_erase(&set->table, dsc_table_load(key, set->table.key_type));
+}
 
-        case DSC_TYPE_INT: {
-            new_entry->key.i = *(int *) key;
-            break;
-        }
+typedef struct {
+    DSCPredicate predicate;
+    void *context;
+} DSCSetFilter;
 
-        case DSC_TYPE_FLOAT: {
-            new_entry->key.f = *(float *) key;
-            break;
-        }
+/* Present a set predicate to the table, which also passes a value */
+static bool dsc_set_filter(const void *key, const void *value, void *context) {
+    (void) value;
+    const DSCSetFilter *filter = context;
+    return filter->predicate(key, filter->context);
+}
 
-        case DSC_TYPE_DOUBLE: {
-            new_entry->key.d = *(double *) key;
-            break;
-        }
+static DSCError dsc_set_erase_matching(DSCSet *set, DSCPredicate predicate, void *context,
+                                       size_t *removed, bool match) {
+    if (set == NULL || predicate == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        case DSC_TYPE_STRING: {
-            dsc_str_cpy(&new_entry->key.s, *(char **) key);
-            break;
-        }
+    DSCSetFilter filter = {predicate, context};
+    size_t count = dsc_table_erase_if(&set->table, dsc_set_filter, &filter, match);
 
-        case DSC_TYPE_BOOL: {
-            new_entry->key.b = *(bool *) key;
-            break;
-        }
+    if (removed != NULL) {
+        *removed = count;
     }
 
-    new_entry->next = NULL;
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_set_erase_if(DSCSet *set, DSCPredicate predicate, void *context, size_t *removed) {
+    return dsc_set_erase_matching(set, predicate, context, removed, true);
+}
+
+DSCError dsc_set_retain(DSCSet *set, DSCPredicate predicate, void *context, size_t *removed) {
+    return dsc_set_erase_matching(set, predicate, context, removed, false);
+}
 
-    // Hash the value to determine the bucket index
-    uint32_t index = dsc_hash(key, set->type, set->capacity);
+DSCError dsc_set_clear(DSCSet *set) {
+    if (set == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-    // Insert the new entry at the beginning of the bucket
-    new_entry->next = set->buckets[index];
-    set->buckets[index] = new_entry;
-    set->size++;
+    dsc_table_clear(&set->table);
 
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_set_erase(DSCSet *set, void *key) {
-    if (set == NULL || key == NULL) {
+DSCError dsc_set_swap(DSCSet *set, DSCSet *other) {
+    if (set == NULL || other == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    uint32_t index = dsc_hash(key, set->type, set->capacity);
-
-    DSCSetEntry *curr = set->buckets[index];
-    DSCSetEntry *prev = NULL;
-
-    while (curr) {
-        switch (set->type) {
-            case DSC_TYPE_CHAR: {
-                if (curr->key.c == *(char *) key) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-
-            case DSC_TYPE_INT: {
-                if (curr->key.i == *(int *) key) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-
-            case DSC_TYPE_FLOAT: {
-                if (curr->key.f == *(float *) key) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-
-            case DSC_TYPE_DOUBLE: {
-                if (curr->key.d == *(double *) key) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-
-            case DSC_TYPE_STRING: {
-                if (strcmp(curr->key.s, *(char **) key) == 0) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr->key.s);
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-
-            case DSC_TYPE_BOOL: {
-                if (curr->key.b == *(bool *) key) {
-                    if (!prev) {
-                        set->buckets[index] = curr->next;
-                    } else {
-                        prev->next = curr->next;
-                    }
-
-                    free(curr);
-                    set->size--;
-
-                    return DSC_ERROR_OK;
-                }
-            }
-        }
+    const DSCTable *table = &set->table;
 
-        prev = curr;
-        curr = curr->next;
+    if (table->key_type != other->table.key_type ||
+        !dsc_element_equal(&table->key_element, &other->table.key_element) ||
+        !dsc_allocator_equal(&table->allocator, &other->table.allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    return DSC_ERROR_NOT_FOUND;
+    dsc_table_swap(&set->table, &other->table);
+
+    return DSC_ERROR_OK;
 }
 
-DSCError dsc_set_clear(DSCSet *set) {
-    if (set == NULL) {
+DSCError dsc_set_cursor_init(const DSCSet *set, DSCSetCursor *cursor) {
+    if (set == NULL || cursor == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    // Free all the entries in the set
-    for (size_t i = 0; i < set->capacity; ++i) {
-        DSCSetEntry *curr = set->buckets[i];
+    cursor->set = set;
+    cursor->position = 0;
 
-        while (curr) {
-            DSCSetEntry *next = curr->next;
+    return DSC_ERROR_OK;
+}
 
-            if (set->type == DSC_TYPE_STRING) {
-                free(curr->key.s);
-                curr->key.s = NULL;
-            }
+bool dsc_set_cursor_next(DSCSetCursor *cursor, const void **element) {
+    const void *value;
+    return dsc_table_next(&cursor->set->table, &cursor->position, element, &value);
+}
 
-            free(curr);
-            curr = next;
+DSCError dsc_set_for_each(const DSCSet *set, DSCVisitor visitor, void *context) {
+    if (set == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t position = 0;
+    const void *key;
+    const void *value;
+
+    while (dsc_table_next(&set->table, &position, &key, &value)) {
+        if (!visitor(key, context)) {
+            break;
         }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_set_build_bloom(const DSCSet *set, double false_positive_rate,
+                             DSCBloomFilter **filter) {
+    if (set == NULL || filter == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCTable *table = &set->table;
+    const DSCAllocator *allocator = DSC_STATS_UNWRAP(&table->allocator);
+    DSCBloomFilter *new_filter;
+
+    // The filter counts its own allocations, not the set's
+    DSCError error = table->key_type == DSC_TYPE_BYTES
+                         ? dsc_bloom_init_bytes(&new_filter, &table->key_element, table->size,
+                                                false_positive_rate, allocator)
+                         : dsc_bloom_init_allocator(&new_filter, table->key_type, table->size,
+                                                    false_positive_rate, allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
 
-        set->buckets[i] = NULL;
+    size_t position = 0;
+    const void *key;
+    const void *value;
+
+    while (dsc_table_next(table, &position, &key, &value)) {
+        // Strings are viewed as the characters but passed as a char **
+        dsc_bloom_insert(new_filter, table->key_type == DSC_TYPE_STRING ? (void *) &key
+                                                                        : (void *) key);
+    }
+
+    *filter = new_filter;
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_set_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_set_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_set_save(const DSCSet *set, const char *path) {
+    if (set == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SET, set->table.key_type,
+                                set->table.key_element.size, DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_set_walk, set);
+}
+
+DSCError dsc_set_stats(const DSCSet *set, DSCStats *stats) {
+    if (set == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    set->size = 0;
+    dsc_stats_export(DSC_STATS_OF(set), stats);
 
     return DSC_ERROR_OK;
 }
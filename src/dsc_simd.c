@@ -0,0 +1,587 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dsc_cpu.h"
+#include "dsc_simd.h"
+
+/* The kernels are written once with GCC/Clang vector extensions, which lower
+ * a DSC_SIMD_WIDTH-byte vector to as many registers as the target needs: four
+ * SSE2 or NEON registers, two AVX2 ones or a single AVX-512 one. Each kernel
+ * is force-inlined into one dispatcher per instruction set, so the same body
+ * is compiled once for every target. Other compilers get the scalar loops. */
+
+#if defined(__GNUC__)
+#define DSC_SIMD_VECTORS 1
+#define DSC_SIMD_INLINE static inline __attribute__((always_inline))
+#else
+#define DSC_SIMD_VECTORS 0
+#define DSC_SIMD_INLINE static inline
+#endif
+
+#if DSC_SIMD_VECTORS && (defined(__x86_64__) || defined(__i386__))
+#define DSC_SIMD_X86 1
+#else
+#define DSC_SIMD_X86 0
+#endif
+
+typedef enum DSCSimdOp {
+    DSC_SIMD_FIND,
+    DSC_SIMD_COUNT,
+    DSC_SIMD_MIN,
+    DSC_SIMD_MAX,
+    DSC_SIMD_SUM
+} DSCSimdOp;
+
+#if DSC_SIMD_VECTORS
+
+typedef int dsc_simd_i32 __attribute__((vector_size(DSC_SIMD_WIDTH)));
+typedef int64_t dsc_simd_i64 __attribute__((vector_size(DSC_SIMD_WIDTH)));
+typedef uint64_t dsc_simd_u64 __attribute__((vector_size(DSC_SIMD_WIDTH)));
+typedef float dsc_simd_f32 __attribute__((vector_size(DSC_SIMD_WIDTH)));
+typedef double dsc_simd_f64 __attribute__((vector_size(DSC_SIMD_WIDTH)));
+
+/* Widened forms of a 32-bit vector, for sums */
+typedef int64_t dsc_simd_i64x2 __attribute__((vector_size(2 * DSC_SIMD_WIDTH)));
+typedef double dsc_simd_f64x2 __attribute__((vector_size(2 * DSC_SIMD_WIDTH)));
+
+/* Whether any lane of a comparison result is set */
+DSC_SIMD_INLINE bool dsc_simd_any(const dsc_simd_u64 *mask) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < DSC_SIMD_WIDTH / sizeof(uint64_t); ++i) {
+        bits |= (*mask)[i];
+    }
+
+    return bits != 0;
+}
+
+#endif
+
+/* Count resets the lane counters this often so that they cannot overflow */
+#define DSC_SIMD_COUNT_FLUSH ((size_t) 1 << 20)
+
+/* One set of kernels per element type. T is the element, V its vector and M
+ * the integer vector a comparison of two V yields. */
+#if DSC_SIMD_VECTORS
+
+#define DSC_SIMD_KERNELS(name, T, V, M)                                              \
+    DSC_SIMD_INLINE size_t dsc_simd_find_##name(const T *data, size_t count,         \
+                                                T value) {                           \
+        const size_t lanes = sizeof(V) / sizeof(T);                                  \
+        V needle = (V) {0} + value;                                                  \
+        size_t i = 0;                                                                \
+                                                                                     \
+        /* Stop at the block holding the first match; the tail loop finds it */      \
+        for (; i + lanes <= count; i += lanes) {                                     \
+            V block;                                                                 \
+            memcpy(&block, data + i, sizeof(block));                                 \
+            dsc_simd_u64 match = (dsc_simd_u64) (block == needle);                   \
+            if (dsc_simd_any(&match)) {                                              \
+                break;                                                               \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        for (; i < count; ++i) {                                                     \
+            if (data[i] == value) {                                                  \
+                return i;                                                            \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        return count;                                                                \
+    }                                                                                \
+                                                                                     \
+    DSC_SIMD_INLINE size_t dsc_simd_count_##name(const T *data, size_t count,        \
+                                                 T value) {                          \
+        const size_t lanes = sizeof(V) / sizeof(T);                                  \
+        V needle = (V) {0} + value;                                                  \
+        size_t total = 0;                                                            \
+        size_t i = 0;                                                                \
+                                                                                     \
+        while (i + lanes <= count) {                                                 \
+            /* A true comparison lane is -1, so subtracting counts it */             \
+            M counters = {0};                                                        \
+            for (size_t n = 0; n < DSC_SIMD_COUNT_FLUSH && i + lanes <= count;       \
+                 ++n, i += lanes) {                                                  \
+                V block;                                                             \
+                memcpy(&block, data + i, sizeof(block));                             \
+                counters -= (M) (block == needle);                                   \
+            }                                                                        \
+                                                                                     \
+            for (size_t lane = 0; lane < lanes; ++lane) {                            \
+                total += (size_t) counters[lane];                                    \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        for (; i < count; ++i) {                                                     \
+            total += data[i] == value;                                               \
+        }                                                                            \
+                                                                                     \
+        return total;                                                                \
+    }                                                                                \
+                                                                                     \
+    DSC_SIMD_INLINE T dsc_simd_extreme_##name(const T *data, size_t count,           \
+                                              bool want_max) {                       \
+        const size_t lanes = sizeof(V) / sizeof(T);                                  \
+        size_t i = 0;                                                                \
+        T best = data[0];                                                            \
+                                                                                     \
+        if (count >= lanes) {                                                        \
+            V acc;                                                                   \
+            memcpy(&acc, data, sizeof(acc));                                         \
+                                                                                     \
+            for (i = lanes; i + lanes <= count; i += lanes) {                        \
+                V block;                                                             \
+                memcpy(&block, data + i, sizeof(block));                             \
+                M take = want_max ? (M) (block > acc) : (M) (block < acc);           \
+                acc = (V) (((M) block & take) | ((M) acc & ~take));                  \
+            }                                                                        \
+                                                                                     \
+            best = acc[0];                                                           \
+            for (size_t lane = 1; lane < lanes; ++lane) {                            \
+                if (want_max ? acc[lane] > best : acc[lane] < best) {                \
+                    best = acc[lane];                                                \
+                }                                                                    \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        for (; i < count; ++i) {                                                     \
+            if (want_max ? data[i] > best : data[i] < best) {                        \
+                best = data[i];                                                      \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        return best;                                                                 \
+    }
+
+#else
+
+#define DSC_SIMD_KERNELS(name, T, V, M)                                              \
+    DSC_SIMD_INLINE size_t dsc_simd_find_##name(const T *data, size_t count,         \
+                                                T value) {                           \
+        for (size_t i = 0; i < count; ++i) {                                         \
+            if (data[i] == value) {                                                  \
+                return i;                                                            \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        return count;                                                                \
+    }                                                                                \
+                                                                                     \
+    DSC_SIMD_INLINE size_t dsc_simd_count_##name(const T *data, size_t count,        \
+                                                 T value) {                          \
+        size_t total = 0;                                                            \
+        for (size_t i = 0; i < count; ++i) {                                         \
+            total += data[i] == value;                                               \
+        }                                                                            \
+                                                                                     \
+        return total;                                                                \
+    }                                                                                \
+                                                                                     \
+    DSC_SIMD_INLINE T dsc_simd_extreme_##name(const T *data, size_t count,           \
+                                              bool want_max) {                       \
+        T best = data[0];                                                            \
+        for (size_t i = 1; i < count; ++i) {                                         \
+            if (want_max ? data[i] > best : data[i] < best) {                        \
+                best = data[i];                                                      \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        return best;                                                                 \
+    }
+
+#endif
+
+DSC_SIMD_KERNELS(i32, int, dsc_simd_i32, dsc_simd_i32)
+DSC_SIMD_KERNELS(f32, float, dsc_simd_f32, dsc_simd_i32)
+DSC_SIMD_KERNELS(f64, double, dsc_simd_f64, dsc_simd_i64)
+
+/* Sums widen 32-bit lanes first, so ints cannot overflow and floats keep
+ * double precision */
+
+DSC_SIMD_INLINE int64_t dsc_simd_sum_i32(const int *data, size_t count) {
+    size_t i = 0;
+    int64_t total = 0;
+
+#if DSC_SIMD_VECTORS
+    const size_t lanes = sizeof(dsc_simd_i32) / sizeof(int);
+    dsc_simd_i64x2 acc = {0};
+
+    for (; i + lanes <= count; i += lanes) {
+        dsc_simd_i32 block;
+        memcpy(&block, data + i, sizeof(block));
+        acc += __builtin_convertvector(block, dsc_simd_i64x2);
+    }
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        total += acc[lane];
+    }
+#endif
+
+    for (; i < count; ++i) {
+        total += data[i];
+    }
+
+    return total;
+}
+
+#if DSC_SIMD_VECTORS
+
+DSC_SIMD_INLINE double dsc_simd_sum_f32(const float *data, size_t count) {
+    const size_t lanes = sizeof(dsc_simd_f32) / sizeof(float);
+    dsc_simd_f64x2 acc = {0};
+    size_t i = 0;
+
+    for (; i + lanes <= count; i += lanes) {
+        dsc_simd_f32 block;
+        memcpy(&block, data + i, sizeof(block));
+        acc += __builtin_convertvector(block, dsc_simd_f64x2);
+    }
+
+    double total = 0;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        total += acc[lane];
+    }
+
+    for (; i < count; ++i) {
+        total += data[i];
+    }
+
+    return total;
+}
+
+DSC_SIMD_INLINE double dsc_simd_sum_f64(const double *data, size_t count) {
+    const size_t lanes = sizeof(dsc_simd_f64) / sizeof(double);
+    dsc_simd_f64 acc = {0};
+    size_t i = 0;
+
+    for (; i + lanes <= count; i += lanes) {
+        dsc_simd_f64 block;
+        memcpy(&block, data + i, sizeof(block));
+        acc += block;
+    }
+
+    double total = 0;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        total += acc[lane];
+    }
+
+    for (; i < count; ++i) {
+        total += data[i];
+    }
+
+    return total;
+}
+
+#else
+
+DSC_SIMD_INLINE double dsc_simd_sum_f32(const float *data, size_t count) {
+    double total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += data[i];
+    }
+
+    return total;
+}
+
+DSC_SIMD_INLINE double dsc_simd_sum_f64(const double *data, size_t count) {
+    double total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += data[i];
+    }
+
+    return total;
+}
+
+#endif
+
+/* Bitwise kernels. The words are combined a vector at a time and counted
+ * lane by lane while they are still in registers. */
+
+DSC_SIMD_INLINE size_t dsc_simd_popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return (size_t) __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (size_t) ((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+DSC_SIMD_INLINE uint64_t dsc_simd_combine64(uint64_t dest, uint64_t src, DSCSimdBitwise op) {
+    switch (op) {
+        case DSC_SIMD_AND:
+            return dest & src;
+        case DSC_SIMD_OR:
+            return dest | src;
+        case DSC_SIMD_XOR:
+            return dest ^ src;
+        default:
+            return dest & ~src;
+    }
+}
+
+#if DSC_SIMD_VECTORS
+
+/* One loop per operation, so that the switch is not taken per block */
+#define DSC_SIMD_BITWISE_LOOP(expression)                                            \
+    for (; i + lanes <= count; i += lanes) {                                         \
+        dsc_simd_u64 a;                                                              \
+        dsc_simd_u64 b;                                                              \
+        memcpy(&a, dest + i, sizeof(a));                                             \
+        memcpy(&b, src + i, sizeof(b));                                              \
+        a = (expression);                                                            \
+        memcpy(dest + i, &a, sizeof(a));                                             \
+                                                                                     \
+        for (size_t lane = 0; lane < lanes; ++lane) {                                \
+            total += dsc_simd_popcount64(a[lane]);                                   \
+        }                                                                            \
+    }
+
+DSC_SIMD_INLINE size_t dsc_simd_bitwise_u64(uint64_t *dest, const uint64_t *src, size_t count,
+                                            DSCSimdBitwise op) {
+    const size_t lanes = sizeof(dsc_simd_u64) / sizeof(uint64_t);
+    size_t total = 0;
+    size_t i = 0;
+
+    switch (op) {
+        case DSC_SIMD_AND:
+            DSC_SIMD_BITWISE_LOOP(a & b)
+            break;
+        case DSC_SIMD_OR:
+            DSC_SIMD_BITWISE_LOOP(a | b)
+            break;
+        case DSC_SIMD_XOR:
+            DSC_SIMD_BITWISE_LOOP(a ^ b)
+            break;
+        case DSC_SIMD_ANDNOT:
+            DSC_SIMD_BITWISE_LOOP(a & ~b)
+            break;
+    }
+
+    for (; i < count; ++i) {
+        dest[i] = dsc_simd_combine64(dest[i], src[i], op);
+        total += dsc_simd_popcount64(dest[i]);
+    }
+
+    return total;
+}
+
+#undef DSC_SIMD_BITWISE_LOOP
+
+#else
+
+DSC_SIMD_INLINE size_t dsc_simd_bitwise_u64(uint64_t *dest, const uint64_t *src, size_t count,
+                                            DSCSimdBitwise op) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = dsc_simd_combine64(dest[i], src[i], op);
+        total += dsc_simd_popcount64(dest[i]);
+    }
+
+    return total;
+}
+
+#endif
+
+DSC_SIMD_INLINE size_t dsc_simd_popcount_u64(const uint64_t *words, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += dsc_simd_popcount64(words[i]);
+    }
+
+    return total;
+}
+
+/* Dispatchers. Every one holds all of the kernels, compiled for its target;
+ * value is an element for find and count, result what the operation yields. */
+
+#define DSC_SIMD_DISPATCHER(name, attributes)                                        \
+    attributes static size_t dsc_simd_run_##name(DSCSimdOp op, const void *data,     \
+                                                 size_t count, DSCType type,         \
+                                                 const void *value, void *result) {  \
+        switch (type) {                                                              \
+            case DSC_TYPE_INT: {                                                     \
+                const int *ints = data;                                              \
+                switch (op) {                                                        \
+                    case DSC_SIMD_FIND:                                              \
+                        return dsc_simd_find_i32(ints, count, *(const int *) value); \
+                    case DSC_SIMD_COUNT:                                             \
+                        return dsc_simd_count_i32(ints, count, *(const int *) value);\
+                    case DSC_SIMD_MIN:                                               \
+                    case DSC_SIMD_MAX:                                               \
+                        *(int *) result = dsc_simd_extreme_i32(ints, count,          \
+                                                               op == DSC_SIMD_MAX);  \
+                        return 0;                                                    \
+                    case DSC_SIMD_SUM:                                               \
+                        *(int64_t *) result = dsc_simd_sum_i32(ints, count);         \
+                        return 0;                                                    \
+                }                                                                    \
+                break;                                                               \
+            }                                                                        \
+                                                                                     \
+            case DSC_TYPE_FLOAT: {                                                   \
+                const float *floats = data;                                          \
+                switch (op) {                                                        \
+                    case DSC_SIMD_FIND:                                              \
+                        return dsc_simd_find_f32(floats, count,                      \
+                                                 *(const float *) value);            \
+                    case DSC_SIMD_COUNT:                                             \
+                        return dsc_simd_count_f32(floats, count,                     \
+                                                  *(const float *) value);           \
+                    case DSC_SIMD_MIN:                                               \
+                    case DSC_SIMD_MAX:                                               \
+                        *(float *) result = dsc_simd_extreme_f32(floats, count,      \
+                                                                 op == DSC_SIMD_MAX);\
+                        return 0;                                                    \
+                    case DSC_SIMD_SUM:                                               \
+                        *(double *) result = dsc_simd_sum_f32(floats, count);        \
+                        return 0;                                                    \
+                }                                                                    \
+                break;                                                               \
+            }                                                                        \
+                                                                                     \
+            default: {                                                               \
+                const double *doubles = data;                                        \
+                switch (op) {                                                        \
+                    case DSC_SIMD_FIND:                                              \
+                        return dsc_simd_find_f64(doubles, count,                     \
+                                                 *(const double *) value);           \
+                    case DSC_SIMD_COUNT:                                             \
+                        return dsc_simd_count_f64(doubles, count,                    \
+                                                  *(const double *) value);          \
+                    case DSC_SIMD_MIN:                                               \
+                    case DSC_SIMD_MAX:                                               \
+                        *(double *) result = dsc_simd_extreme_f64(doubles, count,    \
+                                                                  op == DSC_SIMD_MAX);\
+                        return 0;                                                    \
+                    case DSC_SIMD_SUM:                                               \
+                        *(double *) result = dsc_simd_sum_f64(doubles, count);       \
+                        return 0;                                                    \
+                }                                                                    \
+                break;                                                               \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        return 0;                                                                    \
+    }
+
+/* src is NULL for a plain count */
+#define DSC_SIMD_BIT_DISPATCHER(name, attributes)                                    \
+    attributes static size_t dsc_simd_bits_##name(uint64_t *dest, const uint64_t *src,\
+                                                  const uint64_t *words, size_t count,\
+                                                  DSCSimdBitwise op) {               \
+        return src != NULL ? dsc_simd_bitwise_u64(dest, src, count, op)              \
+                           : dsc_simd_popcount_u64(words, count);                    \
+    }
+
+DSC_SIMD_DISPATCHER(baseline, )
+DSC_SIMD_BIT_DISPATCHER(baseline, )
+
+#if DSC_SIMD_X86
+DSC_SIMD_DISPATCHER(avx2, __attribute__((target("avx2"))))
+DSC_SIMD_DISPATCHER(avx512, __attribute__((target("avx512f"))))
+
+// Counting uses the popcnt instruction where the CPU has it
+DSC_SIMD_BIT_DISPATCHER(avx2, __attribute__((target("avx2,popcnt"))))
+DSC_SIMD_BIT_DISPATCHER(avx512, __attribute__((target("avx512f,avx512vpopcntdq,popcnt"))))
+#endif
+
+/* The widest dispatchers the CPU runs, chosen once at load time. Until then
+ * (from other constructors, say) the baseline ones stand in. */
+
+typedef size_t (*DSCSimdRun)(DSCSimdOp op, const void *data, size_t count, DSCType type,
+                             const void *value, void *result);
+typedef size_t (*DSCSimdBits)(uint64_t *dest, const uint64_t *src, const uint64_t *words,
+                              size_t count, DSCSimdBitwise op);
+
+static DSCSimdRun dsc_simd_run_best = dsc_simd_run_baseline;
+static DSCSimdBits dsc_simd_bits_best = dsc_simd_bits_baseline;
+
+#if DSC_SIMD_X86
+__attribute__((constructor)) static void dsc_simd_resolve(void) {
+    unsigned features = dsc_cpu_features();
+
+    if (features & DSC_CPU_AVX512F) {
+        dsc_simd_run_best = dsc_simd_run_avx512;
+    } else if (features & DSC_CPU_AVX2) {
+        dsc_simd_run_best = dsc_simd_run_avx2;
+    }
+
+    const unsigned avx512_bits = DSC_CPU_AVX512F | DSC_CPU_AVX512VPOPCNTDQ;
+    const unsigned avx2_bits = DSC_CPU_AVX2 | DSC_CPU_POPCNT;
+
+    if ((features & avx512_bits) == avx512_bits) {
+        dsc_simd_bits_best = dsc_simd_bits_avx512;
+    } else if ((features & avx2_bits) == avx2_bits) {
+        dsc_simd_bits_best = dsc_simd_bits_avx2;
+    }
+}
+#endif
+
+static size_t dsc_simd_run(DSCSimdOp op, const void *data, size_t count, DSCType type,
+                           const void *value, void *result) {
+    // Arrays shorter than one step never reach a vector loop
+    if (count * sizeof(int) < DSC_SIMD_WIDTH) {
+        return dsc_simd_run_baseline(op, data, count, type, value, result);
+    }
+
+    return dsc_simd_run_best(op, data, count, type, value, result);
+}
+
+bool dsc_simd_supported(DSCType type) {
+    return type == DSC_TYPE_INT || type == DSC_TYPE_FLOAT || type == DSC_TYPE_DOUBLE;
+}
+
+size_t dsc_simd_find(const void *data, size_t count, DSCType type, const void *value) {
+    return dsc_simd_run(DSC_SIMD_FIND, data, count, type, value, NULL);
+}
+
+size_t dsc_simd_count(const void *data, size_t count, DSCType type, const void *value) {
+    return dsc_simd_run(DSC_SIMD_COUNT, data, count, type, value, NULL);
+}
+
+void dsc_simd_min(const void *data, size_t count, DSCType type, void *result) {
+    dsc_simd_run(DSC_SIMD_MIN, data, count, type, NULL, result);
+}
+
+void dsc_simd_max(const void *data, size_t count, DSCType type, void *result) {
+    dsc_simd_run(DSC_SIMD_MAX, data, count, type, NULL, result);
+}
+
+void dsc_simd_sum(const void *data, size_t count, DSCType type, void *result) {
+    dsc_simd_run(DSC_SIMD_SUM, data, count, type, NULL, result);
+}
+
+static size_t dsc_simd_bits(uint64_t *dest, const uint64_t *src, const uint64_t *words,
+                            size_t count, DSCSimdBitwise op) {
+    if (count * sizeof(uint64_t) < DSC_SIMD_WIDTH) {
+        return dsc_simd_bits_baseline(dest, src, words, count, op);
+    }
+
+    return dsc_simd_bits_best(dest, src, words, count, op);
+}
+
+size_t dsc_simd_bitwise(uint64_t *dest, const uint64_t *src, size_t count, DSCSimdBitwise op) {
+    return dsc_simd_bits(dest, src, NULL, count, op);
+}
+
+size_t dsc_simd_popcount(const uint64_t *words, size_t count) {
+    return dsc_simd_bits(NULL, NULL, words, count, DSC_SIMD_AND);
+}
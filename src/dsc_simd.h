@@ -0,0 +1,101 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_simd.h
+ * @brief Internal vectorized kernels over contiguous arrays of numbers.
+ *
+ * This header is not installed. The kernels work on DSC_TYPE_INT,
+ * DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE arrays, DSC_SIMD_WIDTH bytes per step,
+ * and pick the widest instruction set the CPU offers once, at load time (see
+ * dsc_cpu.h): AVX-512 or AVX2 on x86, otherwise whatever the build targets
+ * (SSE2 on x86-64, NEON on AArch64). The lane layout is the same on every path, so a kernel returns
+ * the same result, rounding included, whichever one runs.
+ */
+
+#ifndef DSC_SIMD_H
+#define DSC_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/dsc_type.h"
+
+/**
+ * @brief The number of bytes every kernel processes per step.
+ */
+#define DSC_SIMD_WIDTH 64
+
+/**
+ * @brief The word-wise operations dsc_simd_bitwise applies.
+ */
+typedef enum DSCSimdBitwise {
+    DSC_SIMD_AND,    /** dest & src */
+    DSC_SIMD_OR,     /** dest | src */
+    DSC_SIMD_XOR,    /** dest ^ src */
+    DSC_SIMD_ANDNOT  /** dest & ~src */
+} DSCSimdBitwise;
+
+/**
+ * @brief Checks whether the kernels support an element type.
+ */
+bool dsc_simd_supported(DSCType type);
+
+/**
+ * @brief Find the first element equal to value.
+ *
+ * @return Its index, or count if there is none.
+ */
+size_t dsc_simd_find(const void *data, size_t count, DSCType type, const void *value);
+
+/**
+ * @brief Count the elements equal to value.
+ */
+size_t dsc_simd_count(const void *data, size_t count, DSCType type, const void *value);
+
+/**
+ * @brief Store the smallest of count > 0 elements, of the array's type, in
+ *        result.
+ */
+void dsc_simd_min(const void *data, size_t count, DSCType type, void *result);
+
+/**
+ * @brief Store the largest of count > 0 elements, of the array's type, in
+ *        result.
+ */
+void dsc_simd_max(const void *data, size_t count, DSCType type, void *result);
+
+/**
+ * @brief Store the sum of count elements in result: an int64_t for
+ *        DSC_TYPE_INT, a double for DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE.
+ */
+void dsc_simd_sum(const void *data, size_t count, DSCType type, void *result);
+
+/**
+ * @brief Combine count words of src into dest in place.
+ *
+ * @return The number of bits set in dest afterwards, counted in the same
+ *         pass.
+ */
+size_t dsc_simd_bitwise(uint64_t *dest, const uint64_t *src, size_t count, DSCSimdBitwise op);
+
+/**
+ * @brief Count the bits set in count words.
+ */
+size_t dsc_simd_popcount(const uint64_t *words, size_t count);
+
+#endif  // DSC_SIMD_H
@@ -0,0 +1,578 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/dsc_snapshot.h"
+#include "../include/dsc_utils.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_table.h"
+
+struct DSCSnapshot {
+    const unsigned char *base;        // The mapping of the whole file
+    size_t size;                      // The size of the file
+    const DSCSnapshotHeader *header;  // At the start of the mapping
+    const unsigned char *keys;        // The key column
+    const unsigned char *values;      // The value column, or NULL
+    const char *strings;              // The string pool
+    const DSCSnapshotSlot *index;     // The key index, or NULL
+};
+
+/* Layout helpers shared by the reader and the writer */
+
+static inline size_t dsc_snapshot_align(size_t offset) {
+    return (offset + DSC_SNAPSHOT_ALIGN - 1) & ~(size_t) (DSC_SNAPSHOT_ALIGN - 1);
+}
+
+/* The size of one column entry of a type, 0 for no column */
+static size_t dsc_snapshot_column_size(DSCType type, size_t record_size) {
+    switch (type) {
+        case DSC_TYPE_UNKNOWN:
+            return 0;
+        case DSC_TYPE_STRING:
+            return sizeof(DSCSnapshotString);
+        case DSC_TYPE_BYTES:
+            return record_size;
+        default:
+            return dsc_size_of(type);
+    }
+}
+
+/* Hash a key held in a DSCData, with strings given with their length */
+static uint64_t dsc_snapshot_hash(DSCType type, DSCData key, size_t length, uint64_t seed) {
+    switch (type) {
+        case DSC_TYPE_STRING:
+            return dsc_hash_bytes(key.s, length, seed);
+        case DSC_TYPE_BYTES:
+            return dsc_hash_bytes(key.c_ptr, length, seed);
+        default:
+            return dsc_table_hash(key, type, seed);
+    }
+}
+
+/* Writing */
+
+struct DSCSnapshotSink {
+    const DSCSnapshotLayout *layout;
+    size_t key_size;      // Column entry sizes
+    size_t value_size;
+    unsigned char *keys;  // The columns being filled, NULL while measuring
+    unsigned char *values;
+    char *strings;        // The string pool being filled
+    size_t limit;         // Entries and pool bytes measured, when filling
+    size_t strings_limit;
+    size_t count;         // Entries seen so far
+    size_t strings_size;  // Pool bytes used so far
+    bool overflow;        // The container grew between the two walks
+};
+
+static void dsc_snapshot_sink_put(DSCSnapshotSink *sink, unsigned char *column, size_t size,
+                                  DSCType type, const void *element) {
+    if (type != DSC_TYPE_STRING) {
+        if (column != NULL) {
+            memcpy(column + sink->count * size, element, size);
+        }
+        return;
+    }
+
+    size_t length = strlen(element);
+
+    if (column != NULL) {
+        if (length >= sink->strings_limit - sink->strings_size) {
+            sink->overflow = true;
+            return;
+        }
+
+        DSCSnapshotString entry = {sink->strings_size, length};
+        memcpy(sink->strings + sink->strings_size, element, length + 1);
+        memcpy(column + sink->count * size, &entry, sizeof(entry));
+    }
+
+    sink->strings_size += length + 1;
+}
+
+bool dsc_snapshot_sink_entry(const void *key, const void *value, void *context) {
+    DSCSnapshotSink *sink = context;
+
+    if (sink->keys != NULL && sink->count >= sink->limit) {
+        sink->overflow = true;
+        return false;
+    }
+
+    dsc_snapshot_sink_put(sink, sink->keys, sink->key_size, sink->layout->key_type, key);
+
+    if (sink->value_size > 0) {
+        dsc_snapshot_sink_put(sink, sink->values, sink->value_size, sink->layout->value_type,
+                              value);
+    }
+
+    sink->count++;
+
+    return !sink->overflow;
+}
+
+bool dsc_snapshot_sink_element(const void *element, void *context) {
+    return dsc_snapshot_sink_entry(element, NULL, context);
+}
+
+/* Read back a key the writer has stored, for hashing */
+static DSCData dsc_snapshot_stored_key(const DSCSnapshotHeader *header, const unsigned char *keys,
+                                       const char *strings, size_t index, size_t *length) {
+    const unsigned char *slot = keys + index * header->key_size;
+    DSCData key;
+
+    if (header->key_type == DSC_TYPE_STRING) {
+        DSCSnapshotString entry;
+        memcpy(&entry, slot, sizeof(entry));
+        key.s = (char *) strings + entry.offset;
+        *length = entry.length;
+    } else if (header->key_type == DSC_TYPE_BYTES) {
+        key.c_ptr = (void *) slot;
+        *length = header->key_size;
+    } else {
+        key = dsc_table_load((void *) slot, header->key_type);
+        *length = 0;
+    }
+
+    return key;
+}
+
+static void dsc_snapshot_build_index(const DSCSnapshotHeader *header, const unsigned char *keys,
+                                     const char *strings, DSCSnapshotSlot *index) {
+    size_t mask = header->index_capacity - 1;
+
+    for (size_t i = 0; i < header->count; ++i) {
+        size_t length;
+        DSCData key = dsc_snapshot_stored_key(header, keys, strings, i, &length);
+        uint64_t hash = dsc_snapshot_hash(header->key_type, key, length, header->seed);
+
+        size_t pos = (size_t) hash & mask;
+        while (index[pos].entry != 0) {
+            pos = (pos + 1) & mask;
+        }
+
+        index[pos].tag = (uint32_t) (hash >> 32);
+        index[pos].entry = (uint32_t) (i + 1);
+    }
+}
+
+DSCError dsc_snapshot_write(const char *path, const DSCSnapshotLayout *layout,
+                            DSCSnapshotWalk walk, const void *container) {
+    DSCSnapshotSink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.layout = layout;
+    sink.key_size = dsc_snapshot_column_size(layout->key_type, layout->key_size);
+    sink.value_size = dsc_snapshot_column_size(layout->value_type, layout->value_size);
+
+    // First walk: count the entries and measure the string pool
+    walk(container, &sink);
+
+    size_t count = sink.count;
+    size_t strings_size = sink.strings_size;
+    size_t index_capacity = 0;
+
+    if (layout->kind != DSC_SNAPSHOT_SEQUENCE) {
+        if (count >= UINT32_MAX) {
+            return DSC_ERROR_INVALID_ARGUMENT;
+        }
+
+        // At most three quarters full, so probes stay short and always end
+        index_capacity = 8;
+        while (index_capacity - index_capacity / 4 <= count) {
+            index_capacity *= 2;
+        }
+    }
+
+    DSCSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DSC_SNAPSHOT_MAGIC, sizeof(DSC_SNAPSHOT_MAGIC));
+    header.version = DSC_SNAPSHOT_VERSION;
+    header.byte_order = DSC_SNAPSHOT_BYTE_ORDER;
+    header.kind = layout->kind;
+    header.key_type = layout->key_type;
+    header.value_type = layout->value_type;
+    header.count = count;
+    header.key_size = sink.key_size;
+    header.value_size = sink.value_size;
+    header.seed = dsc_hash_seed();
+    header.keys_offset = dsc_snapshot_align(sizeof(DSCSnapshotHeader));
+    header.values_offset = dsc_snapshot_align(header.keys_offset + count * sink.key_size);
+    header.strings_offset = dsc_snapshot_align(header.values_offset + count * sink.value_size);
+    header.strings_size = strings_size;
+    header.index_offset = dsc_snapshot_align(header.strings_offset + strings_size);
+    header.index_capacity = index_capacity;
+    header.file_size = header.index_offset + index_capacity * sizeof(DSCSnapshotSlot);
+
+    // Build the file beside the target and rename it into place, so readers
+    // mapping the old file keep its inode and a failure leaves it alone
+    size_t path_length = strlen(path);
+    char *temp_path = malloc(path_length + sizeof(DSC_SNAPSHOT_TEMP_SUFFIX));
+    if (temp_path == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(temp_path, path, path_length);
+    memcpy(temp_path + path_length, DSC_SNAPSHOT_TEMP_SUFFIX, sizeof(DSC_SNAPSHOT_TEMP_SUFFIX));
+
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(temp_path);
+        return DSC_ERROR_IO;
+    }
+
+    DSCError error = DSC_ERROR_IO;
+    unsigned char *base = MAP_FAILED;
+
+    // The file reads back as zeros until filled, which are empty index slots
+    if (ftruncate(fd, (off_t) header.file_size) == 0) {
+        base = mmap(NULL, header.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    if (base != MAP_FAILED) {
+        memcpy(base, &header, sizeof(header));
+
+        // Second walk: fill the columns and the pool in place
+        sink.keys = base + header.keys_offset;
+        sink.values = base + header.values_offset;
+        sink.strings = (char *) base + header.strings_offset;
+        sink.limit = count;
+        sink.strings_limit = strings_size;
+        sink.count = 0;
+        sink.strings_size = 0;
+
+        walk(container, &sink);
+
+        if (sink.overflow || sink.count != count) {
+            error = DSC_ERROR_INVALID_ARGUMENT;
+        } else {
+            if (index_capacity > 0) {
+                dsc_snapshot_build_index(&header, sink.keys, sink.strings,
+                                         (DSCSnapshotSlot *) (base + header.index_offset));
+            }
+
+            error = DSC_ERROR_OK;
+        }
+
+        // On disk before it becomes visible under the target's name
+        if (error == DSC_ERROR_OK && msync(base, header.file_size, MS_SYNC) != 0) {
+            error = DSC_ERROR_IO;
+        }
+
+        if (munmap(base, header.file_size) != 0 && error == DSC_ERROR_OK) {
+            error = DSC_ERROR_IO;
+        }
+    }
+
+    if (error == DSC_ERROR_OK && fsync(fd) != 0) {
+        error = DSC_ERROR_IO;
+    }
+
+    if (close(fd) != 0 && error == DSC_ERROR_OK) {
+        error = DSC_ERROR_IO;
+    }
+
+    if (error == DSC_ERROR_OK && rename(temp_path, path) != 0) {
+        error = DSC_ERROR_IO;
+    }
+
+    if (error != DSC_ERROR_OK) {
+        unlink(temp_path);
+    }
+
+    free(temp_path);
+
+    return error;
+}
+
+/* Reading */
+
+/* Whether count entries of size bytes fit between offset and limit */
+static inline bool dsc_snapshot_fits(uint64_t offset, uint64_t count, uint64_t size,
+                                     uint64_t limit) {
+    return offset <= limit && offset % DSC_SNAPSHOT_ALIGN == 0 &&
+           (size == 0 || count <= (limit - offset) / size);
+}
+
+static bool dsc_snapshot_valid_type(uint32_t type) {
+    return type > DSC_TYPE_UNKNOWN && type < DSC_TYPE_COUNT;
+}
+
+static bool dsc_snapshot_valid(const DSCSnapshotHeader *header, size_t size) {
+    if (memcmp(header->magic, DSC_SNAPSHOT_MAGIC, sizeof(DSC_SNAPSHOT_MAGIC)) != 0 ||
+        header->version != DSC_SNAPSHOT_VERSION ||
+        header->byte_order != DSC_SNAPSHOT_BYTE_ORDER || header->file_size != size ||
+        header->kind > DSC_SNAPSHOT_MAP || !dsc_snapshot_valid_type(header->key_type)) {
+        return false;
+    }
+
+    bool map = header->kind == DSC_SNAPSHOT_MAP;
+    if (map ? !dsc_snapshot_valid_type(header->value_type)
+            : header->value_type != DSC_TYPE_UNKNOWN) {
+        return false;
+    }
+
+    // Built-in types must have the sizes of this build
+    if (header->key_size == 0 ||
+        (header->key_type != DSC_TYPE_BYTES &&
+         header->key_size != dsc_snapshot_column_size(header->key_type, 0))) {
+        return false;
+    }
+
+    if (map ? header->value_size == 0 ||
+                  (header->value_type != DSC_TYPE_BYTES &&
+                   header->value_size != dsc_snapshot_column_size(header->value_type, 0))
+            : header->value_size != 0) {
+        return false;
+    }
+
+    if (!dsc_snapshot_fits(header->keys_offset, header->count, header->key_size,
+                           header->values_offset) ||
+        !dsc_snapshot_fits(header->values_offset, header->count, header->value_size,
+                           header->strings_offset) ||
+        !dsc_snapshot_fits(header->strings_offset, header->strings_size, 1,
+                           header->index_offset) ||
+        !dsc_snapshot_fits(header->index_offset, header->index_capacity,
+                           sizeof(DSCSnapshotSlot), size) ||
+        header->keys_offset < sizeof(DSCSnapshotHeader)) {
+        return false;
+    }
+
+    if (header->kind == DSC_SNAPSHOT_SEQUENCE) {
+        return header->index_capacity == 0;
+    }
+
+    // A power of two with room to spare, so every probe meets an empty slot
+    return header->index_capacity > header->count &&
+           (header->index_capacity & (header->index_capacity - 1)) == 0;
+}
+
+DSCError dsc_snapshot_open(DSCSnapshot **snapshot, const char *path) {
+    if (snapshot == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return DSC_ERROR_IO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return DSC_ERROR_IO;
+    }
+
+    size_t size = (size_t) st.st_size;
+    if (size < sizeof(DSCSnapshotHeader)) {
+        close(fd);
+        return DSC_ERROR_INVALID_FORMAT;
+    }
+
+    // The mapping outlives the descriptor
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return DSC_ERROR_IO;
+    }
+
+    const DSCSnapshotHeader *header = base;
+    if (!dsc_snapshot_valid(header, size)) {
+        munmap(base, size);
+        return DSC_ERROR_INVALID_FORMAT;
+    }
+
+    DSCSnapshot *new_snapshot = malloc(sizeof(DSCSnapshot));
+    if (new_snapshot == NULL) {
+        munmap(base, size);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_snapshot->base = base;
+    new_snapshot->size = size;
+    new_snapshot->header = header;
+    new_snapshot->keys = new_snapshot->base + header->keys_offset;
+    new_snapshot->values = header->value_size > 0 ? new_snapshot->base + header->values_offset
+                                                  : NULL;
+    new_snapshot->strings = (const char *) new_snapshot->base + header->strings_offset;
+    new_snapshot->index = header->index_capacity > 0
+                              ? (const DSCSnapshotSlot *) (new_snapshot->base +
+                                                           header->index_offset)
+                              : NULL;
+
+    *snapshot = new_snapshot;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_snapshot_close(DSCSnapshot *snapshot) {
+    if (snapshot == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    munmap((void *) snapshot->base, snapshot->size);
+    free(snapshot);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_snapshot_info(const DSCSnapshot *snapshot, DSCSnapshotInfo *info) {
+    if (snapshot == NULL || info == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCSnapshotHeader *header = snapshot->header;
+
+    info->kind = (DSCSnapshotKind) header->kind;
+    info->key_type = (DSCType) header->key_type;
+    info->value_type = (DSCType) header->value_type;
+    info->key_size = header->key_type == DSC_TYPE_BYTES ? header->key_size : 0;
+    info->value_size = header->value_type == DSC_TYPE_BYTES ? header->value_size : 0;
+    info->count = header->count;
+
+    return DSC_ERROR_OK;
+}
+
+/* Point at one column entry as dsc_element_view would, checking that a
+ * string lies within the pool */
+static bool dsc_snapshot_view(const DSCSnapshot *snapshot, const unsigned char *column,
+                              size_t size, DSCType type, size_t index, const void **view,
+                              size_t *length) {
+    const unsigned char *slot = column + index * size;
+
+    if (type != DSC_TYPE_STRING) {
+        *view = slot;
+        *length = size;
+        return true;
+    }
+
+    DSCSnapshotString entry;
+    memcpy(&entry, slot, sizeof(entry));
+
+    uint64_t pool = snapshot->header->strings_size;
+    if (entry.offset >= pool || entry.length >= pool - entry.offset ||
+        snapshot->strings[entry.offset + entry.length] != '\0') {
+        return false;
+    }
+
+    *view = snapshot->strings + entry.offset;
+    *length = entry.length;
+
+    return true;
+}
+
+DSCError dsc_snapshot_at(const DSCSnapshot *snapshot, size_t index, const void **key,
+                         const void **value) {
+    if (snapshot == NULL || key == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCSnapshotHeader *header = snapshot->header;
+    if (index >= header->count) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    size_t length;
+    const void *key_view;
+    const void *value_view = NULL;
+
+    if (!dsc_snapshot_view(snapshot, snapshot->keys, header->key_size, header->key_type, index,
+                           &key_view, &length)) {
+        return DSC_ERROR_INVALID_FORMAT;
+    }
+
+    if (snapshot->values != NULL &&
+        !dsc_snapshot_view(snapshot, snapshot->values, header->value_size, header->value_type,
+                           index, &value_view, &length)) {
+        return DSC_ERROR_INVALID_FORMAT;
+    }
+
+    *key = key_view;
+    if (value != NULL) {
+        *value = value_view;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_snapshot_find(const DSCSnapshot *snapshot, void *key, size_t *index) {
+    if (snapshot == NULL || key == NULL || index == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const DSCSnapshotHeader *header = snapshot->header;
+    if (snapshot->index == NULL) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    DSCType type = (DSCType) header->key_type;
+    DSCData needle = dsc_table_load(key, type);
+    size_t needle_length = type == DSC_TYPE_STRING  ? strlen(needle.s)
+                           : type == DSC_TYPE_BYTES ? header->key_size
+                                                    : 0;
+
+    uint64_t hash = dsc_snapshot_hash(type, needle, needle_length, header->seed);
+    uint32_t tag = (uint32_t) (hash >> 32);
+    size_t mask = header->index_capacity - 1;
+    size_t pos = (size_t) hash & mask;
+
+    // Bounded so that a corrupt index without empty slots cannot loop
+    for (size_t probes = 0; probes < header->index_capacity; ++probes) {
+        DSCSnapshotSlot slot = snapshot->index[pos];
+
+        if (slot.entry == 0) {
+            return DSC_ERROR_NOT_FOUND;
+        }
+
+        if (slot.entry > header->count) {
+            return DSC_ERROR_INVALID_FORMAT;
+        }
+
+        if (slot.tag == tag) {
+            const void *view;
+            size_t length;
+
+            if (!dsc_snapshot_view(snapshot, snapshot->keys, header->key_size, type,
+                                   slot.entry - 1, &view, &length)) {
+                return DSC_ERROR_INVALID_FORMAT;
+            }
+
+            bool equal;
+            if (type == DSC_TYPE_STRING || type == DSC_TYPE_BYTES) {
+                equal = length == needle_length &&
+                        memcmp(view, type == DSC_TYPE_STRING ? needle.s : needle.c_ptr,
+                               length) == 0;
+            } else {
+                equal = dsc_table_equal(dsc_table_load((void *) view, type), needle, type);
+            }
+
+            if (equal) {
+                *index = slot.entry - 1;
+                return DSC_ERROR_OK;
+            }
+        }
+
+        pos = (pos + 1) & mask;
+    }
+
+    return DSC_ERROR_NOT_FOUND;
+}
@@ -0,0 +1,153 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_snapshot_file.h
+ * @brief Internal on-disk layout of snapshots, and the writer the containers
+ *        save through.
+ *
+ * This header is not installed. A snapshot file is, in order and each
+ * section aligned to DSC_SNAPSHOT_ALIGN bytes:
+ *
+ * - a DSCSnapshotHeader;
+ * - the key column: count keys of key_size bytes each. Primitives are stored
+ *   as in a vector's buffer, records as themselves and strings as a
+ *   DSCSnapshotString;
+ * - the value column of a map, laid out the same way;
+ * - the string pool, of NUL-terminated strings;
+ * - the index of a set or map: index_capacity DSCSnapshotSlot entries,
+ *   probed linearly from the low bits of the key hash.
+ */
+
+#ifndef DSC_SNAPSHOT_FILE_H
+#define DSC_SNAPSHOT_FILE_H
+
+#include <stdint.h>
+
+#include "../include/dsc_data.h"
+#include "../include/dsc_snapshot.h"
+
+#define DSC_SNAPSHOT_MAGIC "DSCSNAP"
+
+/**
+ * @brief Written as is, to tell the reader the writer's byte order.
+ */
+#define DSC_SNAPSHOT_BYTE_ORDER UINT32_C(0x01020304)
+
+/**
+ * @brief The alignment of every section, a cache line.
+ */
+#define DSC_SNAPSHOT_ALIGN 64
+
+typedef struct DSCSnapshotHeader DSCSnapshotHeader;
+
+struct DSCSnapshotHeader {
+    char magic[8];           // DSC_SNAPSHOT_MAGIC
+    uint32_t version;        // DSC_SNAPSHOT_VERSION
+    uint32_t byte_order;     // DSC_SNAPSHOT_BYTE_ORDER in the writer's order
+    uint32_t kind;           // A DSCSnapshotKind
+    uint32_t key_type;       // A DSCType
+    uint32_t value_type;     // A DSCType, DSC_TYPE_UNKNOWN without values
+    uint32_t reserved;
+    uint64_t count;          // The number of elements or entries
+    uint64_t key_size;       // The size of one key column entry
+    uint64_t value_size;     // The size of one value column entry, or 0
+    uint64_t seed;           // The seed of the index hash
+    uint64_t keys_offset;
+    uint64_t values_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t index_offset;
+    uint64_t index_capacity; // A power of two, or 0 for sequences
+    uint64_t file_size;
+};
+
+/* A string column entry */
+typedef struct DSCSnapshotString DSCSnapshotString;
+
+struct DSCSnapshotString {
+    uint64_t offset; // From the start of the string pool
+    uint64_t length; // Without the terminator
+};
+
+/* An index slot */
+typedef struct DSCSnapshotSlot DSCSnapshotSlot;
+
+struct DSCSnapshotSlot {
+    uint32_t tag;   // The high 32 bits of the key hash
+    uint32_t entry; // The entry's position plus one, or 0 for an empty slot
+};
+
+/**
+ * @brief What a container is saved as.
+ */
+typedef struct DSCSnapshotLayout DSCSnapshotLayout;
+
+struct DSCSnapshotLayout {
+    DSCSnapshotKind kind;
+    DSCType key_type;
+    size_t key_size;    // The record size of DSC_TYPE_BYTES keys
+    DSCType value_type; // DSC_TYPE_UNKNOWN unless kind is DSC_SNAPSHOT_MAP
+    size_t value_size;  // The record size of DSC_TYPE_BYTES values
+};
+
+/**
+ * @brief Collects the elements of a container while it is saved.
+ */
+typedef struct DSCSnapshotSink DSCSnapshotSink;
+
+/**
+ * @brief Hand every element of a container to the sink, in order, through
+ *        dsc_snapshot_sink_element or dsc_snapshot_sink_entry.
+ *
+ * Called twice per save: once to measure the strings, once to write.
+ */
+typedef void (*DSCSnapshotWalk)(const void *container, DSCSnapshotSink *sink);
+
+/**
+ * @brief Add one element of a sequence or set, as dsc_element_view
+ *        describes it. Shaped as a DSCVisitor.
+ */
+bool dsc_snapshot_sink_element(const void *element, void *sink);
+
+/**
+ * @brief Add one map entry, as dsc_element_view describes its key and
+ *        value. Shaped as a DSCMapVisitor.
+ */
+bool dsc_snapshot_sink_entry(const void *key, const void *value, void *sink);
+
+/**
+ * @brief Appended to the target path to name the file a snapshot is built in.
+ */
+#define DSC_SNAPSHOT_TEMP_SUFFIX ".tmp"
+
+/**
+ * @brief Write a container to a snapshot file, replacing the file.
+ *
+ * The file is built under the target's name plus DSC_SNAPSHOT_TEMP_SUFFIX,
+ * sized up front, filled through a shared mapping and synced, then renamed
+ * over the target. Snapshots open on the old file keep reading it, and on
+ * error the old file is left as it was.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_IO, DSC_ERROR_OUT_OF_MEMORY, or
+ *         DSC_ERROR_INVALID_ARGUMENT if the container changed while it was
+ *         walked or holds too many entries to index.
+ */
+DSCError dsc_snapshot_write(const char *path, const DSCSnapshotLayout *layout,
+                            DSCSnapshotWalk walk, const void *container);
+
+#endif  // DSC_SNAPSHOT_FILE_H
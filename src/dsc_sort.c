@@ -0,0 +1,670 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsc_parallel.h"
+#include "dsc_sort.h"
+
+/* The introsort below is written once over untyped elements and a less-than
+ * callback. Each built-in type gets a wrapper that passes its element size
+ * and comparison as constants; the core is force-inlined into it and has no
+ * recursion, so the compiler specializes it with the comparison and the
+ * swaps inlined. Records keep the callback. */
+
+#if defined(__GNUC__)
+#define DSC_SORT_INLINE static inline __attribute__((always_inline))
+#else
+#define DSC_SORT_INLINE static inline
+#endif
+
+/* Ranges this short are insertion sorted */
+#define DSC_SORT_INSERTION 16
+
+/* Ranges at least this long take the median of three medians as pivot */
+#define DSC_SORT_NINTHER 128
+
+/* How many elements a partial insertion sort may move before giving up */
+#define DSC_SORT_PARTIAL_LIMIT 8
+
+/* Samples drawn per bucket of a parallel sort */
+#define DSC_SORT_OVERSAMPLE 32
+
+/* Bytes swapped per step, for records of any size */
+#define DSC_SORT_SWAP_CHUNK 64
+
+typedef bool (*DSCSortLess)(const void *lhs, const void *rhs, const void *context);
+
+/* Comparisons, in dsc_compare's order */
+
+static inline bool dsc_sort_less_bool(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    return *(const bool *) lhs < *(const bool *) rhs;
+}
+
+static inline bool dsc_sort_less_char(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    return *(const char *) lhs < *(const char *) rhs;
+}
+
+static inline bool dsc_sort_less_int(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    return *(const int *) lhs < *(const int *) rhs;
+}
+
+/* NaNs sort after every number, making the order total */
+static inline bool dsc_sort_less_float(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    float a = *(const float *) lhs;
+    float b = *(const float *) rhs;
+    return a < b || (isnan(b) && !isnan(a));
+}
+
+static inline bool dsc_sort_less_double(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    double a = *(const double *) lhs;
+    double b = *(const double *) rhs;
+    return a < b || (isnan(b) && !isnan(a));
+}
+
+static inline bool dsc_sort_less_string(const void *lhs, const void *rhs, const void *context) {
+    (void) context;
+    return strcmp(*(char *const *) lhs, *(char *const *) rhs) < 0;
+}
+
+static bool dsc_sort_less_bytes(const void *lhs, const void *rhs, const void *context) {
+    return dsc_element_compare(context, lhs, rhs) < 0;
+}
+
+/* Introsort */
+
+DSC_SORT_INLINE unsigned char *dsc_sort_at(unsigned char *base, size_t index, size_t stride) {
+    return base + index * stride;
+}
+
+DSC_SORT_INLINE void dsc_sort_swap(unsigned char *a, unsigned char *b, size_t stride) {
+    unsigned char tmp[DSC_SORT_SWAP_CHUNK];
+
+    while (stride > 0) {
+        size_t n = stride < sizeof(tmp) ? stride : sizeof(tmp);
+        memcpy(tmp, a, n);
+        memcpy(a, b, n);
+        memcpy(b, tmp, n);
+        a += n;
+        b += n;
+        stride -= n;
+    }
+}
+
+/* Insertion sort [lo, hi). With a limit, give up once that many elements
+ * have moved and report whether the range ended up sorted. */
+DSC_SORT_INLINE bool dsc_sort_insertion(unsigned char *base, size_t lo, size_t hi,
+                                        size_t stride, DSCSortLess less,
+                                        const void *context, size_t limit) {
+    size_t moved = 0;
+
+    for (size_t i = lo + 1; i < hi; ++i) {
+        size_t j = i;
+
+        while (j > lo && less(dsc_sort_at(base, j, stride), dsc_sort_at(base, j - 1, stride),
+                              context)) {
+            dsc_sort_swap(dsc_sort_at(base, j, stride), dsc_sort_at(base, j - 1, stride),
+                          stride);
+            j--;
+        }
+
+        moved += i - j;
+        if (moved > limit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Order three elements so that a <= b <= c */
+DSC_SORT_INLINE void dsc_sort_three(unsigned char *a, unsigned char *b, unsigned char *c,
+                                    size_t stride, DSCSortLess less, const void *context) {
+    if (less(b, a, context)) {
+        dsc_sort_swap(a, b, stride);
+    }
+    if (less(c, b, context)) {
+        dsc_sort_swap(b, c, stride);
+        if (less(b, a, context)) {
+            dsc_sort_swap(a, b, stride);
+        }
+    }
+}
+
+DSC_SORT_INLINE void dsc_sort_sift(unsigned char *base, size_t root, size_t count,
+                                   size_t stride, DSCSortLess less, const void *context) {
+    for (size_t child = 2 * root + 1; child < count; child = 2 * root + 1) {
+        if (child + 1 < count && less(dsc_sort_at(base, child, stride),
+                                      dsc_sort_at(base, child + 1, stride), context)) {
+            child++;
+        }
+
+        if (!less(dsc_sort_at(base, root, stride), dsc_sort_at(base, child, stride), context)) {
+            return;
+        }
+
+        dsc_sort_swap(dsc_sort_at(base, root, stride), dsc_sort_at(base, child, stride), stride);
+        root = child;
+    }
+}
+
+/* The fallback that keeps the worst case at O(n log n) */
+DSC_SORT_INLINE void dsc_sort_heap(unsigned char *base, size_t count, size_t stride,
+                                   DSCSortLess less, const void *context) {
+    for (size_t i = count / 2; i-- > 0; ) {
+        dsc_sort_sift(base, i, count, stride, less, context);
+    }
+
+    for (size_t end = count; end-- > 1; ) {
+        dsc_sort_swap(base, dsc_sort_at(base, end, stride), stride);
+        dsc_sort_sift(base, 0, end, stride, less, context);
+    }
+}
+
+/* Partition [lo, hi) around a pivot chosen from it. Returns the pivot's final
+ * index and whether the range was already partitioned. */
+DSC_SORT_INLINE size_t dsc_sort_partition(unsigned char *base, size_t lo, size_t hi,
+                                          size_t stride, DSCSortLess less,
+                                          const void *context, bool *partitioned) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (hi - lo >= DSC_SORT_NINTHER) {
+        dsc_sort_three(dsc_sort_at(base, lo, stride), dsc_sort_at(base, mid, stride),
+                       dsc_sort_at(base, hi - 1, stride), stride, less, context);
+        dsc_sort_three(dsc_sort_at(base, lo + 1, stride), dsc_sort_at(base, mid - 1, stride),
+                       dsc_sort_at(base, hi - 2, stride), stride, less, context);
+        dsc_sort_three(dsc_sort_at(base, lo + 2, stride), dsc_sort_at(base, mid + 1, stride),
+                       dsc_sort_at(base, hi - 3, stride), stride, less, context);
+        dsc_sort_three(dsc_sort_at(base, mid - 1, stride), dsc_sort_at(base, mid, stride),
+                       dsc_sort_at(base, mid + 1, stride), stride, less, context);
+    } else {
+        dsc_sort_three(dsc_sort_at(base, lo, stride), dsc_sort_at(base, mid, stride),
+                       dsc_sort_at(base, hi - 1, stride), stride, less, context);
+    }
+
+    unsigned char *pivot = dsc_sort_at(base, lo, stride);
+    dsc_sort_swap(pivot, dsc_sort_at(base, mid, stride), stride);
+
+    // Both scans stop at elements equal to the pivot, which splits runs of
+    // duplicates evenly
+    size_t i = lo + 1;
+    size_t j = hi - 1;
+    bool swapped = false;
+
+    for (;;) {
+        while (i <= j && less(dsc_sort_at(base, i, stride), pivot, context)) {
+            i++;
+        }
+        while (i <= j && less(pivot, dsc_sort_at(base, j, stride), context)) {
+            j--;
+        }
+
+        if (i >= j) {
+            break;
+        }
+
+        dsc_sort_swap(dsc_sort_at(base, i, stride), dsc_sort_at(base, j, stride), stride);
+        swapped = true;
+        i++;
+        j--;
+    }
+
+    dsc_sort_swap(pivot, dsc_sort_at(base, j, stride), stride);
+    *partitioned = !swapped;
+
+    return j;
+}
+
+/* Sort [0, count), or with nth < count only select the nth element. Larger
+ * halves go on an explicit stack and the loop carries on with the smaller
+ * one, so the stack never holds more than log2(count) ranges. */
+DSC_SORT_INLINE void dsc_sort_core(unsigned char *base, size_t count, size_t stride,
+                                   DSCSortLess less, const void *context, size_t nth) {
+    struct {
+        size_t lo;
+        size_t hi;
+        unsigned depth;
+    } stack[64];
+    size_t top = 0;
+
+    unsigned depth = 0;
+    for (size_t n = count; n > 1; n /= 2) {
+        depth += 2;
+    }
+
+    size_t lo = 0;
+    size_t hi = count;
+
+    for (;;) {
+        while (hi - lo > DSC_SORT_INSERTION) {
+            if (depth == 0) {
+                // Too many bad pivots: heapsort whatever is left of the range
+                dsc_sort_heap(dsc_sort_at(base, lo, stride), hi - lo, stride, less, context);
+                lo = hi;
+                break;
+            }
+
+            depth--;
+
+            bool partitioned;
+            size_t p = dsc_sort_partition(base, lo, hi, stride, less, context, &partitioned);
+
+            // Pattern check: if nothing had to move, the range may be sorted
+            // already, which a bounded insertion sort confirms cheaply
+            if (partitioned && nth >= count &&
+                dsc_sort_insertion(base, lo, p, stride, less, context, DSC_SORT_PARTIAL_LIMIT) &&
+                dsc_sort_insertion(base, p + 1, hi, stride, less, context,
+                                   DSC_SORT_PARTIAL_LIMIT)) {
+                lo = hi;
+                break;
+            }
+
+            if (nth < count) {
+                if (nth == p) {
+                    return;
+                }
+
+                if (nth < p) {
+                    hi = p;
+                } else {
+                    lo = p + 1;
+                }
+
+                continue;
+            }
+
+            if (p - lo < hi - (p + 1)) {
+                stack[top].lo = p + 1;
+                stack[top].hi = hi;
+                stack[top].depth = depth;
+                top++;
+                hi = p;
+            } else {
+                stack[top].lo = lo;
+                stack[top].hi = p;
+                stack[top].depth = depth;
+                top++;
+                lo = p + 1;
+            }
+        }
+
+        if (hi - lo > 1) {
+            dsc_sort_insertion(base, lo, hi, stride, less, context, SIZE_MAX);
+        }
+
+        if (top == 0) {
+            return;
+        }
+
+        top--;
+        lo = stack[top].lo;
+        hi = stack[top].hi;
+        depth = stack[top].depth;
+    }
+}
+
+DSC_SORT_INLINE size_t dsc_sort_bound_core(const unsigned char *base, size_t count,
+                                           size_t stride, DSCSortLess less,
+                                           const void *context, const void *value,
+                                           bool upper) {
+    size_t lo = 0;
+    size_t hi = count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const unsigned char *at = base + mid * stride;
+        bool before = upper ? !less(value, at, context) : less(at, value, context);
+
+        if (before) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* One specialization of every algorithm per built-in type */
+
+#define DSC_SORT_SPECIALIZE(name, T, less)                                              \
+    static void dsc_sort_run_##name(void *data, size_t count, size_t nth) {            \
+        dsc_sort_core(data, count, sizeof(T), less, NULL, nth);                         \
+    }                                                                                   \
+                                                                                        \
+    static size_t dsc_sort_bound_##name(const void *data, size_t count,                 \
+                                        const void *value, bool upper) {                \
+        return dsc_sort_bound_core(data, count, sizeof(T), less, NULL, value, upper);  \
+    }
+
+DSC_SORT_SPECIALIZE(bool, bool, dsc_sort_less_bool)
+DSC_SORT_SPECIALIZE(char, char, dsc_sort_less_char)
+DSC_SORT_SPECIALIZE(int, int, dsc_sort_less_int)
+DSC_SORT_SPECIALIZE(float, float, dsc_sort_less_float)
+DSC_SORT_SPECIALIZE(double, double, dsc_sort_less_double)
+DSC_SORT_SPECIALIZE(string, char *, dsc_sort_less_string)
+
+static void dsc_sort_run(void *data, size_t count, size_t nth, DSCType type,
+                         const DSCElementType *element) {
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            dsc_sort_run_bool(data, count, nth);
+            break;
+        case DSC_TYPE_CHAR:
+            dsc_sort_run_char(data, count, nth);
+            break;
+        case DSC_TYPE_INT:
+            dsc_sort_run_int(data, count, nth);
+            break;
+        case DSC_TYPE_FLOAT:
+            dsc_sort_run_float(data, count, nth);
+            break;
+        case DSC_TYPE_DOUBLE:
+            dsc_sort_run_double(data, count, nth);
+            break;
+        case DSC_TYPE_STRING:
+            dsc_sort_run_string(data, count, nth);
+            break;
+        default:
+            dsc_sort_core(data, count, element->size, dsc_sort_less_bytes, element, nth);
+            break;
+    }
+}
+
+/* Radix sort. Keys are the element bits mapped so that unsigned order is the
+ * comparison order: the sign bit flipped for ints and positive floats, every
+ * bit flipped for negative floats, and NaNs mapped past everything. */
+
+static inline uint32_t dsc_sort_key32(uint32_t bits, bool is_float) {
+    if (!is_float) {
+        return bits ^ UINT32_C(0x80000000);
+    }
+
+    if ((bits & UINT32_C(0x7fffffff)) > UINT32_C(0x7f800000)) {
+        return UINT32_MAX;
+    }
+
+    return (bits & UINT32_C(0x80000000)) ? ~bits : bits ^ UINT32_C(0x80000000);
+}
+
+static inline uint64_t dsc_sort_key64(uint64_t bits) {
+    if ((bits & UINT64_C(0x7fffffffffffffff)) > UINT64_C(0x7ff0000000000000)) {
+        return UINT64_MAX;
+    }
+
+    return (bits & UINT64_C(0x8000000000000000)) ? ~bits : bits ^ UINT64_C(0x8000000000000000);
+}
+
+static inline uint64_t dsc_sort_key(const unsigned char *element, DSCType type) {
+    if (type == DSC_TYPE_DOUBLE) {
+        uint64_t bits;
+        memcpy(&bits, element, sizeof(bits));
+        return dsc_sort_key64(bits);
+    }
+
+    uint32_t bits;
+    memcpy(&bits, element, sizeof(bits));
+    return dsc_sort_key32(bits, type == DSC_TYPE_FLOAT);
+}
+
+/* Least significant digit first, a byte per pass, bouncing between data and a
+ * scratch buffer of the same size. All the histograms are counted in one
+ * read, and digits every key shares are skipped. Returns whichever of the
+ * two buffers holds the sorted elements. */
+static unsigned char *dsc_sort_radix_passes(unsigned char *data, unsigned char *scratch,
+                                            size_t count, DSCType type) {
+    size_t stride = type == DSC_TYPE_DOUBLE ? sizeof(double) : sizeof(uint32_t);
+    size_t histogram[sizeof(uint64_t)][256];
+    memset(histogram, 0, sizeof(histogram));
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t key = dsc_sort_key(data + i * stride, type);
+
+        for (size_t digit = 0; digit < stride; ++digit) {
+            histogram[digit][(key >> (8 * digit)) & 0xff]++;
+        }
+    }
+
+    unsigned char *src = data;
+    unsigned char *dst = scratch;
+
+    for (size_t digit = 0; digit < stride; ++digit) {
+        size_t *counts = histogram[digit];
+        uint64_t key = dsc_sort_key(src, type);
+
+        if (counts[(key >> (8 * digit)) & 0xff] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; ++bucket) {
+            size_t n = counts[bucket];
+            counts[bucket] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char *element = src + i * stride;
+            size_t bucket = (dsc_sort_key(element, type) >> (8 * digit)) & 0xff;
+            memcpy(dst + counts[bucket]++ * stride, element, stride);
+        }
+
+        unsigned char *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    return src;
+}
+
+static bool dsc_sort_radix(unsigned char *data, size_t count, DSCType type,
+                           const DSCAllocator *allocator) {
+    size_t stride = type == DSC_TYPE_DOUBLE ? sizeof(double) : sizeof(uint32_t);
+
+    unsigned char *scratch = dsc_alloc(allocator, count * stride);
+    if (scratch == NULL) {
+        return false;
+    }
+
+    unsigned char *sorted = dsc_sort_radix_passes(data, scratch, count, type);
+    if (sorted != data) {
+        memcpy(data, sorted, count * stride);
+    }
+
+    dsc_free(allocator, scratch);
+
+    return true;
+}
+
+static inline bool dsc_sort_radix_type(DSCType type) {
+    return type == DSC_TYPE_INT || type == DSC_TYPE_FLOAT || type == DSC_TYPE_DOUBLE;
+}
+
+void dsc_sort(void *data, size_t count, DSCType type, const DSCElementType *element,
+              const DSCAllocator *allocator) {
+    if (dsc_sort_radix_type(type) && count >= DSC_SORT_RADIX_MIN &&
+        dsc_sort_radix(data, count, type, allocator)) {
+        return;
+    }
+
+    dsc_sort_run(data, count, count, type, element);
+}
+
+/* Parallel sample sort. Splitters drawn from a sorted sample cut the value
+ * range into one bucket per chunk; every element is classified by binary
+ * search over the splitters, the elements are gathered bucket by bucket into
+ * a scratch buffer, and each bucket is sorted on its own, back into place. */
+
+typedef struct {
+    unsigned char *data;
+    unsigned char *scratch;
+    size_t count;
+    size_t stride;
+    DSCType type;
+    const DSCElementType *element;
+    const unsigned char *splitters; // buckets - 1 elements, ascending
+    size_t buckets;
+    uint32_t *ids;                  // The bucket of every element
+    size_t *order;                  // Element indices grouped by bucket
+    size_t *starts;                 // Where each bucket begins in order
+} DSCSortParallel;
+
+static void dsc_sort_parallel_classify(void *context, size_t index) {
+    DSCSortParallel *sort = context;
+    size_t end = dsc_parallel_begin(sort->count, sort->buckets, index + 1);
+
+    for (size_t i = dsc_parallel_begin(sort->count, sort->buckets, index); i < end; ++i) {
+        sort->ids[i] = (uint32_t) dsc_sort_bound(sort->splitters, sort->buckets - 1, sort->type,
+                                                 sort->element, sort->data + i * sort->stride,
+                                                 true);
+    }
+}
+
+static void dsc_sort_parallel_gather(void *context, size_t bucket) {
+    DSCSortParallel *sort = context;
+
+    for (size_t k = sort->starts[bucket]; k < sort->starts[bucket + 1]; ++k) {
+        memcpy(sort->scratch + k * sort->stride, sort->data + sort->order[k] * sort->stride,
+               sort->stride);
+    }
+}
+
+static void dsc_sort_parallel_bucket(void *context, size_t bucket) {
+    DSCSortParallel *sort = context;
+    size_t start = sort->starts[bucket];
+    size_t count = sort->starts[bucket + 1] - start;
+    unsigned char *src = sort->scratch + start * sort->stride;
+    unsigned char *dst = sort->data + start * sort->stride;
+
+    // The bucket's range of data is free by now and serves as radix scratch
+    unsigned char *sorted = src;
+    if (dsc_sort_radix_type(sort->type) && count >= DSC_SORT_RADIX_MIN) {
+        sorted = dsc_sort_radix_passes(src, dst, count, sort->type);
+    } else {
+        dsc_sort_run(src, count, count, sort->type, sort->element);
+    }
+
+    if (sorted != dst) {
+        memcpy(dst, sorted, count * sort->stride);
+    }
+}
+
+void dsc_sort_parallel(void *data, size_t count, DSCType type, const DSCElementType *element,
+                       const DSCAllocator *allocator, DSCThreadPool *pool) {
+    size_t buckets = dsc_parallel_split(pool, count);
+    size_t samples = buckets * DSC_SORT_OVERSAMPLE;
+
+    if (buckets == 1 || samples > count) {
+        dsc_sort(data, count, type, element, allocator);
+        return;
+    }
+
+    DSCSortParallel sort = {data, NULL, count, element->size, type, element, NULL, buckets,
+                            NULL, NULL, NULL};
+
+    unsigned char *sample = dsc_alloc(allocator, samples * sort.stride);
+    sort.scratch = dsc_alloc(allocator, count * sort.stride);
+    sort.ids = dsc_alloc(allocator, count * sizeof(uint32_t));
+    sort.order = dsc_alloc(allocator, count * sizeof(size_t));
+    sort.starts = dsc_alloc(allocator, (buckets + 1) * sizeof(size_t));
+
+    if (sample != NULL && sort.scratch != NULL && sort.ids != NULL && sort.order != NULL &&
+        sort.starts != NULL) {
+        // Evenly spaced samples, sorted, with every DSC_SORT_OVERSAMPLE-th one
+        // moved to the front as a splitter
+        for (size_t i = 0; i < samples; ++i) {
+            memcpy(sample + i * sort.stride,
+                   sort.data + dsc_parallel_begin(count, samples, i) * sort.stride, sort.stride);
+        }
+
+        dsc_sort_run(sample, samples, samples, type, element);
+
+        for (size_t j = 0; j + 1 < buckets; ++j) {
+            memcpy(sample + j * sort.stride, sample + (j + 1) * DSC_SORT_OVERSAMPLE * sort.stride,
+                   sort.stride);
+        }
+        sort.splitters = sample;
+
+        dsc_parallel_run(pool, dsc_sort_parallel_classify, &sort, buckets);
+    }
+
+    if (sort.splitters == NULL ||
+        dsc_parallel_partition(pool, sort.ids, count, buckets, sort.order, sort.starts,
+                               allocator) != DSC_ERROR_OK) {
+        dsc_sort(data, count, type, element, allocator);
+    } else {
+        dsc_parallel_run(pool, dsc_sort_parallel_gather, &sort, buckets);
+        dsc_parallel_run(pool, dsc_sort_parallel_bucket, &sort, buckets);
+    }
+
+    dsc_free(allocator, sample);
+    dsc_free(allocator, sort.scratch);
+    dsc_free(allocator, sort.ids);
+    dsc_free(allocator, sort.order);
+    dsc_free(allocator, sort.starts);
+}
+
+void dsc_sort_select(void *data, size_t count, size_t nth, DSCType type,
+                     const DSCElementType *element) {
+    if (nth < count) {
+        dsc_sort_run(data, count, nth, type, element);
+    }
+}
+
+void dsc_sort_partial(void *data, size_t count, size_t sorted, DSCType type,
+                      const DSCElementType *element) {
+    if (sorted == 0) {
+        return;
+    }
+
+    if (sorted >= count) {
+        dsc_sort_run(data, count, count, type, element);
+        return;
+    }
+
+    // Select the last of the sorted elements, then sort what comes before it
+    dsc_sort_run(data, count, sorted - 1, type, element);
+    dsc_sort_run(data, sorted - 1, sorted - 1, type, element);
+}
+
+size_t dsc_sort_bound(const void *data, size_t count, DSCType type,
+                      const DSCElementType *element, const void *value, bool upper) {
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            return dsc_sort_bound_bool(data, count, value, upper);
+        case DSC_TYPE_CHAR:
+            return dsc_sort_bound_char(data, count, value, upper);
+        case DSC_TYPE_INT:
+            return dsc_sort_bound_int(data, count, value, upper);
+        case DSC_TYPE_FLOAT:
+            return dsc_sort_bound_float(data, count, value, upper);
+        case DSC_TYPE_DOUBLE:
+            return dsc_sort_bound_double(data, count, value, upper);
+        case DSC_TYPE_STRING:
+            return dsc_sort_bound_string(data, count, value, upper);
+        default:
+            return dsc_sort_bound_core(data, count, element->size, dsc_sort_less_bytes,
+                                       element, value, upper);
+    }
+}
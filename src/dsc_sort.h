@@ -0,0 +1,100 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_sort.h
+ * @brief Internal sorting, selection and binary search over element arrays.
+ *
+ * This header is not installed. Every function works on a contiguous array
+ * of count elements of one DSCType, element->size bytes apart, in the order
+ * dsc_compare defines: numbers by value with NaNs after every number,
+ * strings by strcmp and DSC_TYPE_BYTES records by the descriptor's compare
+ * callback or memcmp.
+ *
+ * DSC_TYPE_INT, DSC_TYPE_FLOAT and DSC_TYPE_DOUBLE arrays of at least
+ * DSC_SORT_RADIX_MIN elements are radix sorted. Everything else goes through
+ * an introsort whose comparisons are inlined for each built-in type, so only
+ * records pay for a call per comparison.
+ */
+
+#ifndef DSC_SORT_H
+#define DSC_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../include/dsc_allocator.h"
+#include "../include/dsc_data.h"
+#include "../include/dsc_thread_pool.h"
+#include "../include/dsc_type.h"
+
+/**
+ * @brief The smallest number array length worth a radix sort's scratch
+ *        buffer and counting passes.
+ */
+#define DSC_SORT_RADIX_MIN 512
+
+/**
+ * @brief Sort an array in ascending order.
+ *
+ * @param allocator Source of the scratch buffer of a radix sort. If it cannot
+ *                  be had, the array is introsorted instead.
+ */
+void dsc_sort(void *data, size_t count, DSCType type, const DSCElementType *element,
+              const DSCAllocator *allocator);
+
+/**
+ * @brief Sort an array in ascending order on a thread pool.
+ *
+ * A sample sort: the array is split into one bucket of value ranges per
+ * chunk and the buckets are sorted in parallel. Arrays below the pool's
+ * cutoff, or whose buffers cannot be allocated, are sorted by dsc_sort.
+ *
+ * @param allocator Source of the scratch buffers, only called by the calling
+ *                  thread.
+ * @param pool The pool to sort on, or NULL.
+ */
+void dsc_sort_parallel(void *data, size_t count, DSCType type, const DSCElementType *element,
+                       const DSCAllocator *allocator, DSCThreadPool *pool);
+
+/**
+ * @brief Move the element that belongs at index nth there, with no greater
+ *        one before it and no smaller one after it.
+ */
+void dsc_sort_select(void *data, size_t count, size_t nth, DSCType type,
+                     const DSCElementType *element);
+
+/**
+ * @brief Sort the smallest sorted elements into the front of the array,
+ *        leaving the rest in unspecified order.
+ */
+void dsc_sort_partial(void *data, size_t count, size_t sorted, DSCType type,
+                      const DSCElementType *element);
+
+/**
+ * @brief Binary search a sorted array.
+ *
+ * @param value The element to look for, as stored in the array (a char * for
+ *              strings).
+ * @param upper false for the first element not less than value, true for the
+ *              first element greater than it.
+ * @return Its index, or count if there is none.
+ */
+size_t dsc_sort_bound(const void *data, size_t count, DSCType type,
+                      const DSCElementType *element, const void *value, bool upper);
+
+#endif  // DSC_SORT_H
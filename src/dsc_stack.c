@@ -20,42 +20,80 @@
 #include <stdlib.h>
 #include <string.h>
 
-static DSCError dsc_stack_resize(DSCStack *stack, size_t new_capacity) {
-    if (stack == NULL || new_capacity <= 0) {
-        return DSC_ERROR_INVALID_ARGUMENT;
-    }
+#include "dsc_snapshot_file.h"
+#include "dsc_stats_counters.h"
+
+static inline unsigned char *dsc_stack_record(const DSCStack *stack, size_t index) {
+    return (unsigned char *) stack->data.c_ptr + index * stack->element.size;
+}
 
-    DSCError errno = dsc_data_realloc(&stack->data, stack->type, new_capacity);
-    if (errno != DSC_ERROR_OK) {
-        return errno;
+static DSCError dsc_stack_resize(DSCStack *stack, size_t new_capacity) {
+    DSCError error = dsc_data_realloc_stride(&stack->data, stack->element.size, new_capacity,
+                                             &stack->allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
+    DSC_STATS_REALLOC(&stack->stats);
     stack->capacity = new_capacity;
 
     return DSC_ERROR_OK;
 }
 
-DSCStack *dsc_stack_init(DSCType type) {
-    if (dsc_type_invalid(type)) {
-        return NULL;
-    }
+DSCError dsc_stack_init(DSCStack **stack, DSCType type) {
+    return dsc_stack_init_allocator(stack, type, NULL);
+}
 
-    DSCStack *new_stack = malloc(sizeof(DSCStack));
+static DSCError dsc_stack_create(DSCStack **stack, DSCType type,
+                                 const DSCElementType *element,
+                                 const DSCAllocator *allocator) {
+    DSCStack *new_stack = dsc_alloc(allocator, sizeof(DSCStack));
     if (new_stack == NULL) {
-        return NULL;
+        return DSC_ERROR_OUT_OF_MEMORY;
     }
 
     new_stack->size = 0;
     new_stack->capacity = DSC_STACK_INITIAL_CAPACITY;
     new_stack->type = type;
+    new_stack->element = *element;
+    new_stack->growth = DSC_GROWTH_POLICY_DEFAULT;
+    new_stack->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_stack->stats, &new_stack->allocator);
+
+    DSCError error = dsc_data_malloc_stride(&new_stack->data, element->size,
+                                            new_stack->capacity, &new_stack->allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, new_stack);
+        return error;
+    }
+
+    *stack = new_stack;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_stack_init_allocator(DSCStack **stack, DSCType type,
+                                  const DSCAllocator *allocator) {
+    if (stack == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
 
-    DSCError errno = dsc_data_malloc(&new_stack->data, type, new_stack->capacity);
-    if (errno != DSC_ERROR_OK) {
-        free(new_stack);
-        return NULL;
+    DSCElementType element = dsc_element_of(type);
+
+    return dsc_stack_create(stack, type, &element, allocator);
+}
+
+DSCError dsc_stack_init_bytes(DSCStack **stack, const DSCElementType *element,
+                              const DSCAllocator *allocator) {
+    if (stack == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    return new_stack;
+    return dsc_stack_create(stack, DSC_TYPE_BYTES, element, allocator);
 }
 
 DSCError dsc_stack_deinit(DSCStack *stack) {
@@ -63,14 +101,42 @@ DSCError dsc_stack_deinit(DSCStack *stack) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    dsc_data_free(&stack->data, stack->type, stack->size);
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = stack->allocator;
 
-    free(stack);
-    stack = NULL;
+    if (stack->type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&stack->element, stack->data.c_ptr, stack->size);
+    }
+
+    dsc_data_free(&stack->data, stack->type, stack->size, &allocator);
+
+    dsc_free(&allocator, stack);
 
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_stack_set_growth(DSCStack *stack, const DSCGrowthPolicy *policy) {
+    if (stack == NULL || dsc_growth_invalid(policy)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    stack->growth = *policy;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_stack_shrink_to_fit(DSCStack *stack) {
+    if (stack == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (stack->size == stack->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_stack_resize(stack, stack->size);
+}
+
 DSCError dsc_stack_size(const DSCStack *stack, size_t *result) {
     if (stack == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -147,6 +213,10 @@ DSCError dsc_stack_top(const DSCStack *stack, void *result) {
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(&stack->element, result,
+                                    dsc_stack_record(stack, stack->size - 1));
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -154,16 +224,25 @@ DSCError dsc_stack_top(const DSCStack *stack, void *result) {
     return DSC_ERROR_OK;
 }
 
+static DSCError dsc_stack_grow(DSCStack *stack) {
+    if (stack->size < stack->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    size_t new_capacity = dsc_growth_next(&stack->growth, stack->capacity,
+                                          stack->size + 1, stack->element.size);
+
+    return dsc_stack_resize(stack, new_capacity);
+}
+
 DSCError dsc_stack_push(DSCStack *stack, void *value) {
     if (stack == NULL || value == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    if (stack->size >= stack->capacity) {
-        DSCError errno = dsc_stack_resize(stack, stack->capacity * 2);
-        if (errno != DSC_ERROR_OK) {
-            return errno;
-        }
+    DSCError error = dsc_stack_grow(stack);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     switch (stack->type) {
@@ -191,7 +270,7 @@ DSCError dsc_stack_push(DSCStack *stack, void *value) {
             const char *str = *(char **) value;
             size_t str_size = strlen(str) + 1;
 
-            stack->data.s_ptr[stack->size] = malloc(str_size);
+            stack->data.s_ptr[stack->size] = dsc_alloc(&stack->allocator, str_size);
             if (stack->data.s_ptr[stack->size] == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
@@ -201,6 +280,15 @@ DSCError dsc_stack_push(DSCStack *stack, void *value) {
             break;
         }
 
+        case DSC_TYPE_BYTES: {
+            error = dsc_element_copy(&stack->element, dsc_stack_record(stack, stack->size),
+                                     value);
+            if (error != DSC_ERROR_OK) {
+                return error;
+            }
+            break;
+        }
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -210,6 +298,43 @@ DSCError dsc_stack_push(DSCStack *stack, void *value) {
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_stack_push_move(DSCStack *stack, void *value) {
+    if (stack == NULL || value == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only strings and records own anything that could be moved
+    if (stack->type != DSC_TYPE_STRING && stack->type != DSC_TYPE_BYTES) {
+        return dsc_stack_push(stack, value);
+    }
+
+    DSCError error = dsc_stack_grow(stack);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (stack->type == DSC_TYPE_BYTES) {
+        // Ownership of the record moves with its bytes
+        memcpy(dsc_stack_record(stack, stack->size), value, stack->element.size);
+    } else {
+        char *string = *(char **) value;
+        char *owned = dsc_allocator_adopt(&stack->allocator, string);
+        if (owned == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        if (owned != string) {
+            free(string);
+        }
+
+        stack->data.s_ptr[stack->size] = owned;
+    }
+
+    stack->size++;
+
+    return DSC_ERROR_OK;
+}
+
 DSCError dsc_stack_pop(DSCStack *stack, void *result) {
     if (stack == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -241,30 +366,96 @@ DSCError dsc_stack_pop(DSCStack *stack, void *result) {
             break;
 
         case DSC_TYPE_STRING: {
-            const char *str = stack->data.s_ptr[stack->size - 1];
-            size_t str_size = strlen(str) + 1;
-
-            char *temp = malloc(str_size);
-            if (temp == NULL) {
+            // Ownership moves to the caller, who frees with free
+            char *string = dsc_allocator_export(&stack->allocator,
+                                                stack->data.s_ptr[stack->size - 1]);
+            if (string == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(temp, str, str_size);
-            temp[str_size - 1] = '\0';
-
-            *(char **) result = temp;
-
-            free(stack->data.s_ptr[stack->size - 1]);
+            *(char **) result = string;
             stack->data.s_ptr[stack->size - 1] = NULL;
 
             break;
         }
 
+        case DSC_TYPE_BYTES:
+            // Ownership of the record moves with its bytes
+            memcpy(result, dsc_stack_record(stack, stack->size - 1), stack->element.size);
+            break;
+
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
 
     stack->size--;
 
+    // Give memory back after a burst; a failed shrink keeps the larger buffer
+    size_t new_capacity = dsc_growth_shrink(&stack->growth, stack->size, stack->capacity,
+                                            DSC_STACK_INITIAL_CAPACITY,
+                                            stack->element.size);
+    if (new_capacity < stack->capacity) {
+        dsc_stack_resize(stack, new_capacity);
+    }
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+DSCError dsc_stack_swap(DSCStack *stack, DSCStack *other) {
+    if (stack == NULL || other == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (stack->type != other->type || !dsc_element_equal(&stack->element, &other->element) ||
+        !dsc_allocator_equal(&stack->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCData data = stack->data;
+    size_t size = stack->size;
+    size_t capacity = stack->capacity;
+
+    stack->data = other->data;
+    stack->size = other->size;
+    stack->capacity = other->capacity;
+
+    other->data = data;
+    other->size = size;
+    other->capacity = capacity;
+
+    return DSC_ERROR_OK;
+}
+
+static void dsc_stack_walk(const void *container, DSCSnapshotSink *sink) {
+    const DSCStack *stack = container;
+    const unsigned char *slot = (const unsigned char *) stack->data.c_ptr;
+
+    for (size_t i = 0; i < stack->size; ++i, slot += stack->element.size) {
+        if (!dsc_snapshot_sink_element(dsc_element_view(slot, stack->type), sink)) {
+            break;
+        }
+    }
+}
+
+DSCError dsc_stack_save(const DSCStack *stack, const char *path) {
+    if (stack == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, stack->type, stack->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_stack_walk, stack);
+}
+
+DSCError dsc_stack_stats(const DSCStack *stack, DSCStats *stats) {
+    if (stack == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(stack), stats);
+
     return DSC_ERROR_OK;
 }
@@ -0,0 +1,126 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "dsc_stats_counters.h"
+
+#ifdef DSC_STATS
+
+static inline void dsc_stats_count(DSCStatsCounters *stats, size_t size) {
+    atomic_fetch_add_explicit(&stats->allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->allocated_bytes, size, memory_order_relaxed);
+}
+
+static void *dsc_stats_alloc(void *context, size_t size) {
+    DSCStatsCounters *stats = context;
+    dsc_stats_count(stats, size);
+    return stats->inner.alloc(stats->inner.context, size);
+}
+
+static void *dsc_stats_realloc(void *context, void *ptr, size_t size) {
+    DSCStatsCounters *stats = context;
+    dsc_stats_count(stats, size);
+    return stats->inner.realloc(stats->inner.context, ptr, size);
+}
+
+/* May free the container holding the counters, so touches nothing after */
+static void dsc_stats_free(void *context, void *ptr) {
+    DSCStatsCounters *stats = context;
+    stats->inner.free(stats->inner.context, ptr);
+}
+
+void dsc_stats_init(DSCStatsCounters *stats, DSCAllocator *allocator) {
+    memset(stats, 0, sizeof(DSCStatsCounters));
+
+    // Never count through two layers, should a counted allocator be passed on
+    stats->inner = *dsc_stats_unwrap(allocator);
+
+    allocator->alloc = dsc_stats_alloc;
+    allocator->realloc = dsc_stats_realloc;
+    allocator->free = stats->inner.free != NULL ? dsc_stats_free : NULL;
+    allocator->context = stats;
+}
+
+const DSCAllocator *dsc_stats_unwrap(const DSCAllocator *allocator) {
+    if (allocator->alloc == dsc_stats_alloc) {
+        return &((const DSCStatsCounters *) allocator->context)->inner;
+    }
+
+    return allocator;
+}
+
+void dsc_stats_probe(DSCStatsCounters *stats, size_t length) {
+    if (stats == NULL) {
+        return;
+    }
+
+    size_t bucket = length < DSC_STATS_PROBE_BUCKETS ? length : DSC_STATS_PROBE_BUCKETS - 1;
+    atomic_fetch_add_explicit(&stats->probes[bucket], 1, memory_order_relaxed);
+
+    size_t max = atomic_load_explicit(&stats->max_probe, memory_order_relaxed);
+    while (length > max &&
+           !atomic_compare_exchange_weak_explicit(&stats->max_probe, &max, length,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void dsc_stats_rehash(DSCStatsCounters *stats, uint64_t start) {
+    if (stats == NULL) {
+        return;
+    }
+
+    atomic_fetch_add_explicit(&stats->rehashes, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->rehash_ns, dsc_stats_now() - start, memory_order_relaxed);
+}
+
+uint64_t dsc_stats_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+#endif
+
+void dsc_stats_export(const DSCStatsCounters *stats, DSCStats *result) {
+    memset(result, 0, sizeof(DSCStats));
+
+#ifdef DSC_STATS
+    if (stats == NULL) {
+        return;
+    }
+
+    // The counters are read one by one, so a concurrently used container
+    // yields a snapshot that is only approximately consistent
+    DSCStatsCounters *counters = (DSCStatsCounters *) stats;
+
+    result->enabled = true;
+    result->allocations = atomic_load_explicit(&counters->allocations, memory_order_relaxed);
+    result->allocated_bytes = atomic_load_explicit(&counters->allocated_bytes,
+                                                   memory_order_relaxed);
+    result->reallocs = atomic_load_explicit(&counters->reallocs, memory_order_relaxed);
+    result->rehashes = atomic_load_explicit(&counters->rehashes, memory_order_relaxed);
+    result->rehash_ns = atomic_load_explicit(&counters->rehash_ns, memory_order_relaxed);
+    for (size_t i = 0; i < DSC_STATS_PROBE_BUCKETS; ++i) {
+        result->probes[i] = atomic_load_explicit(&counters->probes[i], memory_order_relaxed);
+    }
+    result->max_probe = atomic_load_explicit(&counters->max_probe, memory_order_relaxed);
+#else
+    (void) stats;
+#endif
+}
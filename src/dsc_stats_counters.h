@@ -0,0 +1,94 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_stats_counters.h
+ * @brief Internal helpers the containers update their DSC_STATS counters
+ *        with.
+ *
+ * This header is not installed. Every macro expands to nothing unless
+ * DSC_STATS is defined, so containers use them unconditionally and only the
+ * counter fields themselves sit behind #ifdef DSC_STATS.
+ */
+
+#ifndef DSC_STATS_COUNTERS_H
+#define DSC_STATS_COUNTERS_H
+
+#include "../include/dsc_stats.h"
+
+#ifdef DSC_STATS
+
+/**
+ * @brief Zero a container's counters and route its allocator through them.
+ *
+ * allocator is replaced in place by one that counts every call and forwards
+ * to the original, so anything initialized from it afterwards, such as the
+ * tables of a map, is counted too. The counters must stay at the same
+ * address for as long as the allocator is used.
+ */
+void dsc_stats_init(DSCStatsCounters *stats, DSCAllocator *allocator);
+
+/**
+ * @brief The allocator a counting allocator forwards to, or allocator itself.
+ */
+const DSCAllocator *dsc_stats_unwrap(const DSCAllocator *allocator);
+
+/**
+ * @brief Record one probe of the given length.
+ */
+void dsc_stats_probe(DSCStatsCounters *stats, size_t length);
+
+/**
+ * @brief Record one rehash that started at the given dsc_stats_now time.
+ */
+void dsc_stats_rehash(DSCStatsCounters *stats, uint64_t start);
+
+/**
+ * @brief A monotonic time in nanoseconds.
+ */
+uint64_t dsc_stats_now(void);
+
+#define DSC_STATS_INIT(stats, allocator) dsc_stats_init((stats), (allocator))
+// Lookups update the counters of const containers too
+#define DSC_STATS_OF(container) ((DSCStatsCounters *) &(container)->stats)
+#define DSC_STATS_PROBE(stats, length) dsc_stats_probe((stats), (length))
+#define DSC_STATS_REALLOC(stats) \
+    atomic_fetch_add_explicit(&(stats)->reallocs, 1, memory_order_relaxed)
+#define DSC_STATS_TIMER(start) uint64_t start = dsc_stats_now()
+#define DSC_STATS_REHASH(stats, start) dsc_stats_rehash((stats), (start))
+#define DSC_STATS_UNWRAP(allocator) dsc_stats_unwrap(allocator)
+
+#else
+
+#define DSC_STATS_INIT(stats, allocator) ((void) 0)
+#define DSC_STATS_OF(container) ((DSCStatsCounters *) NULL)
+#define DSC_STATS_PROBE(stats, length) ((void) (length))
+#define DSC_STATS_REALLOC(stats) ((void) 0)
+#define DSC_STATS_TIMER(start) ((void) 0)
+#define DSC_STATS_REHASH(stats, start) ((void) 0)
+#define DSC_STATS_UNWRAP(allocator) (allocator)
+
+#endif
+
+/**
+ * @brief Copy counters out, or report disabled statistics for NULL.
+ *
+ * max_chain is left for the caller to fill in.
+ */
+void dsc_stats_export(const DSCStatsCounters *stats, DSCStats *result);
+
+#endif // DSC_STATS_COUNTERS_H
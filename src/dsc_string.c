@@ -0,0 +1,174 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_string.h"
+#include "../include/dsc_utils.h"
+
+typedef struct DSCStringRecord DSCStringRecord;
+
+struct DSCStringRecord {
+    DSCStringRecord *next; // The next record in the same bucket
+    uint64_t hash;         // The hash of the string, for rehashing and compares
+    size_t length;         // The length without the terminator
+    char data[];           // The NUL-terminated characters
+};
+
+struct DSCStringPool {
+    DSCStringRecord **buckets; // Array of pointers to records
+    size_t size;               // The number of distinct strings
+    size_t capacity;           // The number of buckets, a power of two
+    uint64_t seed;             // Hash seed of this pool
+    DSCAllocator allocator;    // Source of the pool, its buckets and records
+};
+
+static DSCError dsc_string_pool_rehash(DSCStringPool *pool, size_t new_capacity) {
+    DSCStringRecord **new_buckets = dsc_calloc(&pool->allocator, new_capacity,
+                                               sizeof(DSCStringRecord *));
+    if (new_buckets == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < pool->capacity; ++i) {
+        DSCStringRecord *record = pool->buckets[i];
+
+        while (record != NULL) {
+            DSCStringRecord *next = record->next;
+            size_t index = dsc_hash_index(record->hash, new_capacity);
+
+            record->next = new_buckets[index];
+            new_buckets[index] = record;
+            record = next;
+        }
+    }
+
+    dsc_free(&pool->allocator, pool->buckets);
+    pool->buckets = new_buckets;
+    pool->capacity = new_capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_string_pool_init(DSCStringPool **pool, const DSCAllocator *allocator) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCStringPool *new_pool = dsc_alloc(allocator, sizeof(DSCStringPool));
+    if (new_pool == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    new_pool->size = 0;
+    new_pool->capacity = DSC_STRING_POOL_INITIAL_CAPACITY;
+    new_pool->seed = dsc_hash_seed();
+    new_pool->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+
+    new_pool->buckets = dsc_calloc(allocator, new_pool->capacity, sizeof(DSCStringRecord *));
+    if (new_pool->buckets == NULL) {
+        dsc_free(allocator, new_pool);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    *pool = new_pool;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_string_pool_deinit(DSCStringPool *pool) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = pool->allocator;
+
+    if (dsc_allocator_frees(&allocator)) {
+        for (size_t i = 0; i < pool->capacity; ++i) {
+            DSCStringRecord *record = pool->buckets[i];
+
+            while (record != NULL) {
+                DSCStringRecord *next = record->next;
+                dsc_free(&allocator, record);
+                record = next;
+            }
+        }
+    }
+
+    dsc_free(&allocator, pool->buckets);
+    dsc_free(&allocator, pool);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_string_pool_intern(DSCStringPool *pool, const char *string,
+                                size_t length, const char **result) {
+    if (pool == NULL || string == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t hash = dsc_hash_bytes(string, length, pool->seed);
+    size_t index = dsc_hash_index(hash, pool->capacity);
+
+    for (DSCStringRecord *curr = pool->buckets[index]; curr; curr = curr->next) {
+        if (curr->hash == hash && curr->length == length &&
+            memcmp(curr->data, string, length) == 0) {
+            *result = curr->data;
+            return DSC_ERROR_OK;
+        }
+    }
+
+    if (length > SIZE_MAX - sizeof(DSCStringRecord) - 1) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCStringRecord *record = dsc_alloc(&pool->allocator, sizeof(DSCStringRecord) + length + 1);
+    if (record == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    record->hash = hash;
+    record->length = length;
+    memcpy(record->data, string, length);
+    record->data[length] = '\0';
+
+    record->next = pool->buckets[index];
+    pool->buckets[index] = record;
+    pool->size++;
+
+    // A failed grow only makes the chains longer
+    if (pool->size >= pool->capacity - pool->capacity / 4) {
+        dsc_string_pool_rehash(pool, pool->capacity * 2);
+    }
+
+    *result = record->data;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_string_pool_size(const DSCStringPool *pool, size_t *size) {
+    if (pool == NULL || size == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *size = pool->size;
+
+    return DSC_ERROR_OK;
+}
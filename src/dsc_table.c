@@ -0,0 +1,1202 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../include/dsc_utils.h"
+#include "dsc_parallel.h"
+#include "dsc_table.h"
+
+/* Control byte values. A full slot stores the low 7 bits of its hash
+ * (0..127), so empty and deleted are negative. */
+#define DSC_TABLE_CTRL_EMPTY   ((int8_t) -128)
+#define DSC_TABLE_CTRL_DELETED ((int8_t) -2)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DSC_TABLE_PREFETCH(addr) __builtin_prefetch((addr), 0, 1)
+#else
+#define DSC_TABLE_PREFETCH(addr) ((void) (addr))
+#endif
+
+/* Per-type helpers */
+
+DSCData dsc_table_load(void *src, DSCType type) {
+    DSCData data;
+
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            data.b = *(bool *) src;
+            break;
+
+        case DSC_TYPE_CHAR:
+            data.c = *(char *) src;
+            break;
+
+        case DSC_TYPE_INT:
+            data.i = *(int *) src;
+            break;
+
+        case DSC_TYPE_FLOAT:
+            data.f = *(float *) src;
+            break;
+
+        case DSC_TYPE_DOUBLE:
+            data.d = *(double *) src;
+            break;
+
+        case DSC_TYPE_STRING:
+            data.s = *(char **) src;
+            break;
+
+        case DSC_TYPE_BYTES:
+            data.c_ptr = src;
+            break;
+
+        default:
+            data.s = NULL;
+            break;
+    }
+
+    return data;
+}
+
+bool dsc_table_equal(DSCData lhs, DSCData rhs, DSCType type) {
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            return lhs.b == rhs.b;
+
+        case DSC_TYPE_CHAR:
+            return lhs.c == rhs.c;
+
+        case DSC_TYPE_INT:
+            return lhs.i == rhs.i;
+
+        case DSC_TYPE_FLOAT:
+            return lhs.f == rhs.f;
+
+        case DSC_TYPE_DOUBLE:
+            return lhs.d == rhs.d;
+
+        case DSC_TYPE_STRING:
+            return strcmp(lhs.s, rhs.s) == 0;
+
+        default:
+            return false;
+    }
+}
+
+DSCError dsc_table_store(DSCData *dest, DSCData src, DSCType type,
+                         const DSCAllocator *allocator) {
+    if (type == DSC_TYPE_STRING) {
+        dest->s = dsc_strdup(allocator, src.s);
+        if (dest->s == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    *dest = src;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_table_output(DSCData src, void *result, DSCType type) {
+    switch (type) {
+        case DSC_TYPE_BOOL:
+            *(bool *) result = src.b;
+            break;
+
+        case DSC_TYPE_CHAR:
+            *(char *) result = src.c;
+            break;
+
+        case DSC_TYPE_INT:
+            *(int *) result = src.i;
+            break;
+
+        case DSC_TYPE_FLOAT:
+            *(float *) result = src.f;
+            break;
+
+        case DSC_TYPE_DOUBLE:
+            *(double *) result = src.d;
+            break;
+
+        case DSC_TYPE_STRING: {
+            char *temp = strdup(src.s);
+            if (temp == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) result = temp;
+            break;
+        }
+
+        default:
+            return DSC_ERROR_INVALID_TYPE;
+    }
+
+    return DSC_ERROR_OK;
+}
+
+void dsc_table_release(DSCData *data, DSCType type,
+                       const DSCAllocator *allocator) {
+    if (type == DSC_TYPE_STRING) {
+        dsc_free(allocator, data->s);
+        data->s = NULL;
+    }
+}
+
+uint64_t dsc_table_hash(DSCData key, DSCType type, uint64_t seed) {
+    // Strings are hashed by content, everything else by its value
+    if (type == DSC_TYPE_STRING) {
+        return dsc_hash(key.s, type, seed);
+    }
+
+    return dsc_hash(&key, type, seed);
+}
+
+/* Group probing. The control array holds capacity + DSC_TABLE_GROUP_WIDTH
+ * bytes; the trailing group mirrors the first one so that a group load
+ * starting at any slot never has to wrap around. */
+
+static inline uint32_t dsc_table_group_match(const int8_t *group, int8_t h2) {
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < DSC_TABLE_GROUP_WIDTH; ++i) {
+        mask |= (uint32_t) (group[i] == h2) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline uint32_t dsc_table_group_match_empty(const int8_t *group) {
+    return dsc_table_group_match(group, DSC_TABLE_CTRL_EMPTY);
+}
+
+static inline uint32_t dsc_table_group_match_free(const int8_t *group) {
+#if defined(__SSE2__)
+    // Empty and deleted are the only control bytes below -1
+    __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < DSC_TABLE_GROUP_WIDTH; ++i) {
+        mask |= (uint32_t) (group[i] < -1) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline size_t dsc_table_max_load(size_t capacity) {
+    return capacity - capacity / 8;
+}
+
+static inline bool dsc_table_has_values(const DSCTable *table) {
+    return table->value_type != DSC_TYPE_UNKNOWN;
+}
+
+static inline void dsc_table_set_ctrl(int8_t *ctrl, size_t capacity,
+                                      size_t index, int8_t h) {
+    ctrl[index] = h;
+    ctrl[((index - DSC_TABLE_GROUP_WIDTH) & (capacity - 1)) + DSC_TABLE_GROUP_WIDTH] = h;
+}
+
+static size_t dsc_table_find_free(const int8_t *ctrl, size_t capacity,
+                                  uint64_t hash) {
+    size_t mask = capacity - 1;
+    size_t pos = dsc_hash_index(hash >> 7, capacity);
+    size_t step = 0;
+
+    for (;;) {
+        uint32_t match = dsc_table_group_match_free(ctrl + pos);
+        if (match) {
+            return (pos + __builtin_ctz(match)) & mask;
+        }
+
+        step += DSC_TABLE_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+/* Key slots. Primitive keys are stored as a DSCData, string keys as a
+ * DSCTableString and records as themselves; every slot of a table has the
+ * same size. */
+
+static inline void *dsc_table_slot(const DSCTable *table, const void *keys, size_t index) {
+    return (unsigned char *) keys + index * table->key_size;
+}
+
+static inline void *dsc_table_value_slot(const DSCTable *table, const void *values,
+                                         size_t index) {
+    return (unsigned char *) values + index * table->value_size;
+}
+
+static inline bool dsc_table_string_keys(const DSCTable *table) {
+    return table->key_type == DSC_TYPE_STRING;
+}
+
+static inline bool dsc_table_bytes_keys(const DSCTable *table) {
+    return table->key_type == DSC_TYPE_BYTES;
+}
+
+static inline const char *dsc_table_string_data(const DSCTableString *string) {
+    return string->length < DSC_TABLE_STRING_INLINE ? string->data.buffer : string->data.heap;
+}
+
+/* Hash a loaded key, also reporting the length of a string key so that it is
+ * only measured once per operation */
+static inline uint64_t dsc_table_hash_key(const DSCTable *table, DSCData key,
+                                          size_t *length) {
+    if (dsc_table_string_keys(table)) {
+        *length = strlen(key.s);
+        return dsc_hash_bytes(key.s, *length, table->seed);
+    }
+
+    *length = 0;
+
+    if (dsc_table_bytes_keys(table)) {
+        return dsc_element_hash(&table->key_element, key.c_ptr, table->seed);
+    }
+
+    return dsc_table_hash(key, table->key_type, table->seed);
+}
+
+static inline uint64_t dsc_table_slot_hash(const DSCTable *table, const void *slot) {
+    if (dsc_table_string_keys(table)) {
+        const DSCTableString *string = slot;
+        return dsc_hash_bytes(dsc_table_string_data(string), string->length, table->seed);
+    }
+
+    if (dsc_table_bytes_keys(table)) {
+        return dsc_element_hash(&table->key_element, slot, table->seed);
+    }
+
+    return dsc_table_hash(*(const DSCData *) slot, table->key_type, table->seed);
+}
+
+static inline bool dsc_table_slot_equal(const DSCTable *table, const void *slot,
+                                        DSCData key, size_t length, uint64_t hash) {
+    if (dsc_table_string_keys(table)) {
+        const DSCTableString *string = slot;
+
+        // Length and cached hash settle almost every mismatch without
+        // touching the characters; an interned key can match by address
+        if (string->length != length || string->hash != (uint32_t) hash) {
+            return false;
+        }
+
+        const char *data = dsc_table_string_data(string);
+        return data == key.s || memcmp(data, key.s, length) == 0;
+    }
+
+    if (dsc_table_bytes_keys(table)) {
+        return dsc_element_compare(&table->key_element, slot, key.c_ptr) == 0;
+    }
+
+    return dsc_table_equal(*(const DSCData *) slot, key, table->key_type);
+}
+
+/* Store a key into a slot-sized buffer, copying or interning strings. A
+ * moved key is a record or heap string the slot takes over as it is. */
+static DSCError dsc_table_store_key(DSCTable *table, void *slot, DSCData key,
+                                    size_t length, uint64_t hash, bool move) {
+    if (dsc_table_bytes_keys(table)) {
+        if (move) {
+            memcpy(slot, key.c_ptr, table->key_size);
+            return DSC_ERROR_OK;
+        }
+
+        return dsc_element_copy(&table->key_element, slot, key.c_ptr);
+    }
+
+    if (!dsc_table_string_keys(table)) {
+        *(DSCData *) slot = key;
+        return DSC_ERROR_OK;
+    }
+
+    DSCTableString *string = slot;
+
+    if (length > UINT32_MAX) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    string->length = (uint32_t) length;
+    string->hash = (uint32_t) hash;
+
+    if (length < DSC_TABLE_STRING_INLINE) {
+        memcpy(string->data.buffer, key.s, length + 1);
+        return DSC_ERROR_OK;
+    }
+
+    if (table->pool != NULL) {
+        const char *interned;
+        DSCError error = dsc_string_pool_intern(table->pool, key.s, length, &interned);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+
+        string->data.heap = (char *) interned;
+        return DSC_ERROR_OK;
+    }
+
+    if (move) {
+        string->data.heap = key.s;
+        return DSC_ERROR_OK;
+    }
+
+    string->data.heap = dsc_alloc(&table->allocator, length + 1);
+    if (string->data.heap == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(string->data.heap, key.s, length + 1);
+
+    return DSC_ERROR_OK;
+}
+
+static void dsc_table_release_key(DSCTable *table, void *slot) {
+    if (dsc_table_bytes_keys(table)) {
+        dsc_element_destroy(&table->key_element, slot, 1);
+        return;
+    }
+
+    if (!dsc_table_string_keys(table)) {
+        return;
+    }
+
+    DSCTableString *string = slot;
+
+    // Inline strings own nothing and pooled ones belong to the pool
+    if (string->length >= DSC_TABLE_STRING_INLINE && table->pool == NULL) {
+        dsc_free(&table->allocator, string->data.heap);
+    }
+
+    string->length = 0;
+    string->data.buffer[0] = '\0';
+}
+
+/* Store a value into its slot, copying strings and records unless they are
+ * moved in */
+static DSCError dsc_table_store_value(DSCTable *table, void *slot, DSCData value,
+                                      bool move) {
+    if (table->value_type == DSC_TYPE_BYTES) {
+        if (move) {
+            memcpy(slot, value.c_ptr, table->value_size);
+            return DSC_ERROR_OK;
+        }
+
+        return dsc_element_copy(&table->value_element, slot, value.c_ptr);
+    }
+
+    if (move) {
+        *(DSCData *) slot = value;
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_table_store(slot, value, table->value_type, &table->allocator);
+}
+
+static void dsc_table_release_value(DSCTable *table, void *slot) {
+    if (table->value_type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&table->value_element, slot, 1);
+        return;
+    }
+
+    dsc_table_release(slot, table->value_type, &table->allocator);
+}
+
+static DSCError dsc_table_alloc(DSCTable *table, size_t capacity) {
+    const DSCAllocator *allocator = &table->allocator;
+    int8_t *ctrl = dsc_alloc(allocator, capacity + DSC_TABLE_GROUP_WIDTH);
+    void *keys = dsc_alloc(allocator, capacity * table->key_size);
+    void *values = NULL;
+
+    if (dsc_table_has_values(table)) {
+        values = dsc_alloc(allocator, capacity * table->value_size);
+    }
+
+    if (ctrl == NULL || keys == NULL || (dsc_table_has_values(table) && values == NULL)) {
+        dsc_free(allocator, ctrl);
+        dsc_free(allocator, keys);
+        dsc_free(allocator, values);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    memset(ctrl, DSC_TABLE_CTRL_EMPTY, capacity + DSC_TABLE_GROUP_WIDTH);
+
+    table->ctrl = ctrl;
+    table->keys = keys;
+    table->values = values;
+    table->capacity = capacity;
+    table->growth_left = dsc_table_max_load(capacity);
+
+    return DSC_ERROR_OK;
+}
+
+static bool dsc_table_probe(const DSCTable *table, const int8_t *ctrl,
+                            const void *keys, size_t capacity, DSCData key,
+                            size_t length, uint64_t hash, size_t *slot) {
+    size_t mask = capacity - 1;
+    int8_t h2 = (int8_t) (hash & 0x7f);
+    size_t pos = dsc_hash_index(hash >> 7, capacity);
+    size_t step = 0;
+
+    for (;;) {
+        const int8_t *group = ctrl + pos;
+
+        for (uint32_t match = dsc_table_group_match(group, h2); match; match &= match - 1) {
+            size_t index = (pos + __builtin_ctz(match)) & mask;
+            if (dsc_table_slot_equal(table, dsc_table_slot(table, keys, index), key, length, hash)) {
+                DSC_STATS_PROBE(table->stats, step / DSC_TABLE_GROUP_WIDTH + 1);
+                *slot = index;
+                return true;
+            }
+        }
+
+        // An empty slot ends the probe sequence: the key was never inserted
+        if (dsc_table_group_match_empty(group)) {
+            DSC_STATS_PROBE(table->stats, step / DSC_TABLE_GROUP_WIDTH + 1);
+            return false;
+        }
+
+        step += DSC_TABLE_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+/* Place an element known to be absent into the current slots */
+static void dsc_table_place(DSCTable *table, uint64_t hash, const void *key,
+                            const void *value) {
+    size_t index = dsc_table_find_free(table->ctrl, table->capacity, hash);
+
+    if (table->ctrl[index] == DSC_TABLE_CTRL_EMPTY) {
+        table->growth_left--;
+    }
+
+    dsc_table_set_ctrl(table->ctrl, table->capacity, index, (int8_t) (hash & 0x7f));
+    memcpy(dsc_table_slot(table, table->keys, index), key, table->key_size);
+
+    if (table->values != NULL) {
+        memcpy(dsc_table_value_slot(table, table->values, index), value, table->value_size);
+    }
+}
+
+static void dsc_table_free_old(DSCTable *table) {
+    dsc_free(&table->allocator, table->old_ctrl);
+    dsc_free(&table->allocator, table->old_keys);
+    dsc_free(&table->allocator, table->old_values);
+
+    table->old_ctrl = NULL;
+    table->old_keys = NULL;
+    table->old_values = NULL;
+    table->old_capacity = 0;
+    table->old_size = 0;
+    table->migrate_pos = 0;
+}
+
+/* Move up to `count` slots of the old table into the current one */
+static void dsc_table_migrate(DSCTable *table, size_t count) {
+    if (table->old_ctrl == NULL) {
+        return;
+    }
+
+    // Clamped before adding, since callers finishing a resize pass SIZE_MAX
+    size_t end = count >= table->old_capacity - table->migrate_pos
+                     ? table->old_capacity
+                     : table->migrate_pos + count;
+
+    for (size_t i = table->migrate_pos; i < end && table->old_size > 0; ++i) {
+        if (table->old_ctrl[i] < 0) {
+            continue;
+        }
+
+        void *key = dsc_table_slot(table, table->old_keys, i);
+        void *value = table->old_values != NULL
+                          ? dsc_table_value_slot(table, table->old_values, i)
+                          : NULL;
+
+        dsc_table_place(table, dsc_table_slot_hash(table, key), key, value);
+        table->old_size--;
+
+        // The new slot owns the element now; lookups, erases and clear must
+        // not reach it through this copy any more
+        dsc_table_set_ctrl(table->old_ctrl, table->old_capacity, i, DSC_TABLE_CTRL_DELETED);
+    }
+
+    table->migrate_pos = end;
+
+    if (table->migrate_pos >= table->old_capacity || table->old_size == 0) {
+        dsc_table_free_old(table);
+    }
+}
+
+/* Table operations */
+
+DSCError dsc_table_init(DSCTable *table, DSCType key_type,
+                        const DSCElementType *key_element, DSCType value_type,
+                        const DSCElementType *value_element, size_t capacity,
+                        const DSCAllocator *allocator) {
+    size_t rounded = DSC_TABLE_MIN_CAPACITY;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    memset(table, 0, sizeof(DSCTable));
+    table->key_type = key_type;
+    table->value_type = value_type;
+    table->key_element = key_type == DSC_TYPE_BYTES ? *key_element : dsc_element_of(key_type);
+    table->value_element = value_type == DSC_TYPE_BYTES ? *value_element
+                                                        : dsc_element_of(value_type);
+
+    switch (key_type) {
+        case DSC_TYPE_STRING:
+            table->key_size = sizeof(DSCTableString);
+            break;
+
+        case DSC_TYPE_BYTES:
+            table->key_size = key_element->size;
+            break;
+
+        default:
+            table->key_size = sizeof(DSCData);
+            break;
+    }
+
+    table->value_size = value_type == DSC_TYPE_BYTES ? value_element->size : sizeof(DSCData);
+    table->seed = dsc_hash_seed();
+    table->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+
+    return dsc_table_alloc(table, rounded);
+}
+
+void dsc_table_deinit(DSCTable *table) {
+    dsc_table_clear(table);
+
+    dsc_free(&table->allocator, table->ctrl);
+    dsc_free(&table->allocator, table->keys);
+    dsc_free(&table->allocator, table->values);
+
+    table->ctrl = NULL;
+    table->keys = NULL;
+    table->values = NULL;
+    table->capacity = 0;
+    table->growth_left = 0;
+}
+
+void dsc_table_set_incremental(DSCTable *table, bool incremental) {
+    if (!incremental) {
+        dsc_table_migrate(table, SIZE_MAX);
+    }
+
+    table->incremental = incremental;
+}
+
+DSCError dsc_table_set_pool(DSCTable *table, DSCStringPool *pool) {
+    if (table->size != 0 || !dsc_table_string_keys(table)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    table->pool = pool;
+
+    return DSC_ERROR_OK;
+}
+
+static bool dsc_table_find_hashed(const DSCTable *table, DSCData key,
+                                  size_t length, uint64_t hash, void **value) {
+    size_t slot;
+
+    if (dsc_table_probe(table, table->ctrl, table->keys, table->capacity,
+                        key, length, hash, &slot)) {
+        if (value != NULL) {
+            *value = table->values != NULL
+                         ? dsc_table_value_slot(table, table->values, slot)
+                         : NULL;
+        }
+
+        return true;
+    }
+
+    // Elements not migrated yet are still reachable through the old slots
+    if (table->old_ctrl != NULL &&
+        dsc_table_probe(table, table->old_ctrl, table->old_keys, table->old_capacity,
+                        key, length, hash, &slot)) {
+        if (value != NULL) {
+            *value = table->old_values != NULL
+                         ? dsc_table_value_slot(table, table->old_values, slot)
+                         : NULL;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool dsc_table_find(const DSCTable *table, DSCData key, void **value) {
+    size_t length;
+    uint64_t hash = dsc_table_hash_key(table, key, &length);
+
+    return dsc_table_find_hashed(table, key, length, hash, value);
+}
+
+void dsc_table_find_batch(const DSCTable *table, void *keys, size_t count,
+                          void **values, bool *found) {
+    size_t stride = table->key_element.size;
+    DSCData window[DSC_TABLE_BATCH_WINDOW];
+    size_t lengths[DSC_TABLE_BATCH_WINDOW];
+    uint64_t hashes[DSC_TABLE_BATCH_WINDOW];
+
+    for (size_t base = 0; base < count; base += DSC_TABLE_BATCH_WINDOW) {
+        size_t n = count - base < DSC_TABLE_BATCH_WINDOW ? count - base
+                                                          : DSC_TABLE_BATCH_WINDOW;
+
+        // First pass: hash every key and start loading its home group
+        for (size_t i = 0; i < n; ++i) {
+            window[i] = dsc_table_load((char *) keys + (base + i) * stride, table->key_type);
+            hashes[i] = dsc_table_hash_key(table, window[i], &lengths[i]);
+
+            size_t pos = dsc_hash_index(hashes[i] >> 7, table->capacity);
+            DSC_TABLE_PREFETCH(table->ctrl + pos);
+            DSC_TABLE_PREFETCH(dsc_table_slot(table, table->keys, pos));
+        }
+
+        // Second pass: resolve against lines that are now (mostly) cached
+        for (size_t i = 0; i < n; ++i) {
+            found[base + i] = dsc_table_find_hashed(table, window[i], lengths[i], hashes[i],
+                                                    values != NULL ? &values[base + i] : NULL);
+
+            if (!found[base + i] && values != NULL) {
+                values[base + i] = NULL;
+            }
+        }
+    }
+}
+
+DSCError dsc_table_rehash(DSCTable *table, size_t new_capacity) {
+    DSC_STATS_TIMER(start);
+
+    // Finish any resize in flight so there is only one set of slots to move
+    dsc_table_migrate(table, SIZE_MAX);
+
+    DSCTable old = *table;
+
+    if (dsc_table_alloc(table, new_capacity) != DSC_ERROR_OK) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    // Move every full slot; keys are known to be unique so no compares needed
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.ctrl[i] < 0) {
+            continue;
+        }
+
+        void *key = dsc_table_slot(table, old.keys, i);
+        void *value = old.values != NULL ? dsc_table_value_slot(table, old.values, i) : NULL;
+
+        dsc_table_place(table, dsc_table_slot_hash(table, key), key, value);
+    }
+
+    dsc_free(&table->allocator, old.ctrl);
+    dsc_free(&table->allocator, old.keys);
+    dsc_free(&table->allocator, old.values);
+
+    DSC_STATS_REHASH(table->stats, start);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_table_reserve(DSCTable *table, size_t count) {
+    size_t new_capacity = table->capacity;
+    while (dsc_table_max_load(new_capacity) < count) {
+        new_capacity *= 2;
+    }
+
+    if (new_capacity == table->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_table_rehash(table, new_capacity);
+}
+
+/* Yield the element in slot index of one set of slot arrays */
+static inline void dsc_table_view(const DSCTable *table, const void *keys,
+                                  const void *values, size_t index,
+                                  const void **key, const void **value) {
+    const void *slot = dsc_table_slot(table, keys, index);
+    *key = dsc_table_string_keys(table) ? dsc_table_string_data(slot) : slot;
+
+    *value = values != NULL
+                 ? dsc_element_view(dsc_table_value_slot(table, values, index), table->value_type)
+                 : NULL;
+}
+
+bool dsc_table_next(const DSCTable *table, size_t *position, const void **key,
+                    const void **value) {
+    size_t pos = *position;
+
+    for (; pos < table->capacity; ++pos) {
+        if (table->ctrl[pos] >= 0) {
+            dsc_table_view(table, table->keys, table->values, pos, key, value);
+            *position = pos + 1;
+            return true;
+        }
+    }
+
+    // Positions past the current slots index the old ones; those below
+    // migrate_pos have been moved across already
+    if (table->old_ctrl != NULL) {
+        if (pos - table->capacity < table->migrate_pos) {
+            pos = table->capacity + table->migrate_pos;
+        }
+
+        for (; pos - table->capacity < table->old_capacity; ++pos) {
+            size_t index = pos - table->capacity;
+
+            if (table->old_ctrl[index] >= 0) {
+                dsc_table_view(table, table->old_keys, table->old_values, index, key, value);
+                *position = pos + 1;
+                return true;
+            }
+        }
+    }
+
+    *position = pos;
+
+    return false;
+}
+
+static DSCError dsc_table_grow(DSCTable *table) {
+    // Reclaim tombstones in place if they make up most of the load
+    size_t new_capacity = table->size * 2 < dsc_table_max_load(table->capacity)
+                              ? table->capacity
+                              : table->capacity * 2;
+
+    if (!table->incremental) {
+        return dsc_table_rehash(table, new_capacity);
+    }
+
+    // Keep the current slots live as the old table and start on a fresh set.
+    // Only starting the resize is timed; the migration is spread over later
+    // calls
+    DSC_STATS_TIMER(start);
+    dsc_table_migrate(table, SIZE_MAX);
+
+    DSCTable old = *table;
+
+    if (dsc_table_alloc(table, new_capacity) != DSC_ERROR_OK) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    table->old_ctrl = old.ctrl;
+    table->old_keys = old.keys;
+    table->old_values = old.values;
+    table->old_capacity = old.capacity;
+    table->old_size = old.size;
+    table->migrate_pos = 0;
+
+    DSC_STATS_REHASH(table->stats, start);
+
+    return DSC_ERROR_OK;
+}
+
+static DSCError dsc_table_insert_hashed(DSCTable *table, DSCData key, DSCData value,
+                                        size_t length, uint64_t hash, bool move) {
+    dsc_table_migrate(table, DSC_TABLE_MIGRATE_STEP);
+
+    if (dsc_table_find_hashed(table, key, length, hash, NULL)) {
+        return DSC_ERROR_ALREADY_EXISTS;
+    }
+
+    if (table->growth_left == 0) {
+        DSCError error = dsc_table_grow(table);
+        if (error != DSC_ERROR_OK) {
+            return error;
+        }
+    }
+
+    // Copy straight into the free slot; it only becomes full once both the
+    // key and the value are stored
+    size_t index = dsc_table_find_free(table->ctrl, table->capacity, hash);
+    void *key_slot = dsc_table_slot(table, table->keys, index);
+
+    DSCError error = dsc_table_store_key(table, key_slot, key, length, hash, move);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (table->values != NULL) {
+        error = dsc_table_store_value(table, dsc_table_value_slot(table, table->values, index),
+                                      value, move);
+        if (error != DSC_ERROR_OK) {
+            dsc_table_release_key(table, key_slot);
+            return error;
+        }
+    }
+
+    if (table->ctrl[index] == DSC_TABLE_CTRL_EMPTY) {
+        table->growth_left--;
+    }
+
+    dsc_table_set_ctrl(table->ctrl, table->capacity, index, (int8_t) (hash & 0x7f));
+    table->size++;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_table_insert(DSCTable *table, DSCData key, DSCData value) {
+    size_t length;
+    uint64_t hash = dsc_table_hash_key(table, key, &length);
+
+    return dsc_table_insert_hashed(table, key, value, length, hash, false);
+}
+
+DSCError dsc_table_insert_move(DSCTable *table, DSCData key, DSCData value) {
+    size_t length;
+    uint64_t hash = dsc_table_hash_key(table, key, &length);
+
+    // Strings change hands before the insert, after which nothing can fail
+    // but interning, so that a failure leaves them with the caller
+    bool string_key = dsc_table_string_keys(table);
+    bool heap_key = string_key && length >= DSC_TABLE_STRING_INLINE && table->pool == NULL;
+    bool string_value = table->values != NULL && table->value_type == DSC_TYPE_STRING;
+    DSCData owned_key = key;
+    DSCData owned_value = value;
+
+    if (heap_key) {
+        owned_key.s = dsc_allocator_adopt(&table->allocator, key.s);
+        if (owned_key.s == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    if (string_value) {
+        owned_value.s = dsc_allocator_adopt(&table->allocator, value.s);
+        if (owned_value.s == NULL) {
+            if (heap_key && owned_key.s != key.s) {
+                dsc_free(&table->allocator, owned_key.s);
+            }
+
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    DSCError error = dsc_table_insert_hashed(table, owned_key, owned_value, length, hash, true);
+    if (error != DSC_ERROR_OK) {
+        if (heap_key && owned_key.s != key.s) {
+            dsc_free(&table->allocator, owned_key.s);
+        }
+
+        if (string_value && owned_value.s != value.s) {
+            dsc_free(&table->allocator, owned_value.s);
+        }
+
+        return error;
+    }
+
+    // Inline, pooled and copied strings leave the caller's behind
+    if (string_key && (!heap_key || owned_key.s != key.s)) {
+        free(key.s);
+    }
+
+    if (string_value && owned_value.s != value.s) {
+        free(value.s);
+    }
+
+    return DSC_ERROR_OK;
+}
+
+typedef struct {
+    const DSCTable *table;
+    const unsigned char *keys;
+    size_t count;
+    size_t chunks;
+    unsigned shift;   // Drops the home slot's low bits, leaving its region
+    uint64_t *hashes;
+    size_t *lengths;  // String keys only
+    uint32_t *ids;    // The region of every key
+} DSCTableParallelHash;
+
+static void dsc_table_parallel_hash(void *context, size_t index) {
+    DSCTableParallelHash *batch = context;
+    const DSCTable *table = batch->table;
+    size_t stride = table->key_element.size;
+    size_t end = dsc_parallel_begin(batch->count, batch->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(batch->count, batch->chunks, index); i < end; ++i) {
+        size_t length;
+        DSCData key = dsc_table_load((void *) (batch->keys + i * stride), table->key_type);
+        uint64_t hash = dsc_table_hash_key(table, key, &length);
+
+        batch->hashes[i] = hash;
+        batch->ids[i] = (uint32_t) (dsc_hash_index(hash >> 7, table->capacity) >> batch->shift);
+        if (batch->lengths != NULL) {
+            batch->lengths[i] = length;
+        }
+    }
+}
+
+DSCError dsc_table_insert_parallel(DSCTable *table, void *keys, void *values, size_t count,
+                                   DSCThreadPool *pool) {
+    DSCError error = dsc_table_reserve(table, table->size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    size_t key_stride = table->key_element.size;
+    size_t value_stride = table->value_element.size;
+    DSCData unused = {0};
+
+    DSCTableParallelHash batch = {table, keys, count, dsc_parallel_split(pool, count), 0,
+                                  NULL, NULL, NULL};
+
+    if (batch.chunks == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            DSCData key = dsc_table_load((char *) keys + i * key_stride, table->key_type);
+            DSCData value = values != NULL
+                                ? dsc_table_load((char *) values + i * value_stride,
+                                                 table->value_type)
+                                : unused;
+
+            error = dsc_table_insert(table, key, value);
+            if (error != DSC_ERROR_OK && error != DSC_ERROR_ALREADY_EXISTS) {
+                return error;
+            }
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    while ((table->capacity >> batch.shift) > DSC_TABLE_PARALLEL_REGIONS) {
+        batch.shift++;
+    }
+
+    size_t regions = table->capacity >> batch.shift;
+    size_t *order = dsc_alloc(&table->allocator, count * sizeof(size_t));
+    size_t *starts = dsc_alloc(&table->allocator, (regions + 1) * sizeof(size_t));
+    batch.hashes = dsc_alloc(&table->allocator, count * sizeof(uint64_t));
+    batch.ids = dsc_alloc(&table->allocator, count * sizeof(uint32_t));
+    if (dsc_table_string_keys(table)) {
+        batch.lengths = dsc_alloc(&table->allocator, count * sizeof(size_t));
+    }
+
+    error = DSC_ERROR_OUT_OF_MEMORY;
+
+    if (order != NULL && starts != NULL && batch.hashes != NULL && batch.ids != NULL &&
+        (batch.lengths != NULL || !dsc_table_string_keys(table))) {
+        dsc_parallel_run(pool, dsc_table_parallel_hash, &batch, batch.chunks);
+        error = dsc_parallel_partition(pool, batch.ids, count, regions, order, starts,
+                                       &table->allocator);
+    }
+
+    // Region by region, every insert probes just past the one before it
+    for (size_t k = 0; error == DSC_ERROR_OK && k < count; ++k) {
+        size_t i = order[k];
+        DSCData key = dsc_table_load((char *) keys + i * key_stride, table->key_type);
+        DSCData value = values != NULL
+                            ? dsc_table_load((char *) values + i * value_stride,
+                                             table->value_type)
+                            : unused;
+
+        error = dsc_table_insert_hashed(table, key, value,
+                                        batch.lengths != NULL ? batch.lengths[i] : 0,
+                                        batch.hashes[i], false);
+        if (error == DSC_ERROR_ALREADY_EXISTS) {
+            error = DSC_ERROR_OK;
+        }
+    }
+
+    dsc_free(&table->allocator, order);
+    dsc_free(&table->allocator, starts);
+    dsc_free(&table->allocator, batch.hashes);
+    dsc_free(&table->allocator, batch.ids);
+    dsc_free(&table->allocator, batch.lengths);
+
+    return error;
+}
+
+/* Release the element in a current slot and free the slot */
+static void dsc_table_vacate(DSCTable *table, size_t index) {
+    dsc_table_release_key(table, dsc_table_slot(table, table->keys, index));
+
+    if (table->values != NULL) {
+        dsc_table_release_value(table, dsc_table_value_slot(table, table->values, index));
+    }
+
+    // If no probe window covering this slot was ever completely full, no
+    // lookup can have probed past it, so it may go straight back to empty.
+    size_t mask = table->capacity - 1;
+    size_t before = (index - DSC_TABLE_GROUP_WIDTH) & mask;
+    uint32_t empty_after = dsc_table_group_match_empty(table->ctrl + index);
+    uint32_t empty_before = dsc_table_group_match_empty(table->ctrl + before);
+
+    bool was_never_full = empty_before && empty_after &&
+                          (size_t) (__builtin_ctz(empty_after) +
+                                    __builtin_clz(empty_before) - 16) <
+                              DSC_TABLE_GROUP_WIDTH;
+
+    if (was_never_full) {
+        dsc_table_set_ctrl(table->ctrl, table->capacity, index, DSC_TABLE_CTRL_EMPTY);
+        table->growth_left++;
+    } else {
+        dsc_table_set_ctrl(table->ctrl, table->capacity, index, DSC_TABLE_CTRL_DELETED);
+    }
+
+    table->size--;
+}
+
+DSCError dsc_table_erase(DSCTable *table, DSCData key) {
+    dsc_table_migrate(table, DSC_TABLE_MIGRATE_STEP);
+
+    size_t length;
+    uint64_t hash = dsc_table_hash_key(table, key, &length);
+    size_t index;
+
+    if (!dsc_table_probe(table, table->ctrl, table->keys, table->capacity,
+                         key, length, hash, &index)) {
+        // Not migrated yet: tombstone it in the old slots, which are never
+        // inserted into again
+        if (table->old_ctrl == NULL ||
+            !dsc_table_probe(table, table->old_ctrl, table->old_keys, table->old_capacity,
+                             key, length, hash, &index)) {
+            return DSC_ERROR_NOT_FOUND;
+        }
+
+        dsc_table_release_key(table, dsc_table_slot(table, table->old_keys, index));
+
+        if (table->old_values != NULL) {
+            dsc_table_release_value(table, dsc_table_value_slot(table, table->old_values, index));
+        }
+
+        dsc_table_set_ctrl(table->old_ctrl, table->old_capacity, index, DSC_TABLE_CTRL_DELETED);
+        table->old_size--;
+        table->size--;
+
+        if (table->old_size == 0) {
+            dsc_table_free_old(table);
+        }
+
+        return DSC_ERROR_OK;
+    }
+
+    dsc_table_vacate(table, index);
+
+    return DSC_ERROR_OK;
+}
+
+static void dsc_table_release_all(DSCTable *table, int8_t *ctrl, void *keys,
+                                  void *values, size_t capacity) {
+    // Strings only need a walk when the allocator frees them; records may own
+    // memory of their own, whatever the allocator
+    bool strings = (dsc_table_string_keys(table) || table->value_type == DSC_TYPE_STRING) &&
+                   dsc_allocator_frees(&table->allocator);
+    bool records = table->key_element.destroy != NULL ||
+                   (values != NULL && table->value_element.destroy != NULL);
+
+    if (!strings && !records) {
+        return;
+    }
+
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] >= 0) {
+            dsc_table_release_key(table, dsc_table_slot(table, keys, i));
+
+            if (values != NULL) {
+                dsc_table_release_value(table, dsc_table_value_slot(table, values, i));
+            }
+        }
+    }
+}
+
+void dsc_table_clear(DSCTable *table) {
+    if (table->ctrl == NULL) {
+        return;
+    }
+
+    if (table->old_ctrl != NULL) {
+        dsc_table_release_all(table, table->old_ctrl, table->old_keys, table->old_values,
+                              table->old_capacity);
+        dsc_table_free_old(table);
+    }
+
+    dsc_table_release_all(table, table->ctrl, table->keys, table->values, table->capacity);
+
+    memset(table->ctrl, DSC_TABLE_CTRL_EMPTY, table->capacity + DSC_TABLE_GROUP_WIDTH);
+    table->growth_left = dsc_table_max_load(table->capacity);
+    table->size = 0;
+}
+
+size_t dsc_table_erase_if(DSCTable *table, DSCTablePredicate predicate, void *context,
+                          bool match) {
+    // One set of slots to walk, so every element is seen exactly once
+    dsc_table_migrate(table, SIZE_MAX);
+
+    size_t removed = 0;
+    const void *key;
+    const void *value;
+
+    for (size_t i = 0; i < table->capacity; ++i) {
+        if (table->ctrl[i] < 0) {
+            continue;
+        }
+
+        dsc_table_view(table, table->keys, table->values, i, &key, &value);
+
+        if (predicate(key, value, context) == match) {
+            dsc_table_vacate(table, i);
+            removed++;
+        }
+    }
+
+    // Rebuild a table left mostly empty at a smaller capacity, which also
+    // drops the tombstones the pass left behind
+    size_t new_capacity = table->capacity;
+    while (new_capacity > DSC_TABLE_MIN_CAPACITY &&
+           table->size < new_capacity / DSC_TABLE_SHRINK_LOAD) {
+        new_capacity /= 2;
+    }
+
+    // A failed rebuild leaves the larger slots in place, which is harmless
+    if (new_capacity < table->capacity) {
+        dsc_table_rehash(table, new_capacity);
+    }
+
+    return removed;
+}
+
+void dsc_table_swap(DSCTable *table, DSCTable *other) {
+    DSCTable temp = *table;
+    *table = *other;
+    *other = temp;
+
+    // The allocators stay put, and with them the counters they route to
+    other->allocator = table->allocator;
+    table->allocator = temp.allocator;
+#ifdef DSC_STATS
+    other->stats = table->stats;
+    table->stats = temp.stats;
+#endif
+}
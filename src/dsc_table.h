@@ -0,0 +1,375 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dsc_table.h
+ * @brief Internal open-addressing hash table shared by DSCSet and DSCMap.
+ *
+ * This header is not installed. A DSCTable stores its keys inline in a flat
+ * array of fixed-size slots indexed by a parallel array of control bytes.
+ * Primitive keys take a DSCData slot; string keys take a DSCTableString slot
+ * that holds short strings inline; DSC_TYPE_BYTES keys take a slot of the
+ * record size. In key/value mode a second flat array holds the values, one
+ * DSCData or one record each; in keys-only mode (sets) it is not allocated at
+ * all.
+ */
+
+#ifndef DSC_TABLE_H
+#define DSC_TABLE_H
+
+#include <stdint.h>
+
+#include "../include/dsc_allocator.h"
+#include "../include/dsc_data.h"
+#include "../include/dsc_error.h"
+#include "../include/dsc_string.h"
+#include "../include/dsc_thread_pool.h"
+#include "../include/dsc_type.h"
+#include "dsc_stats_counters.h"
+
+/**
+ * @brief The number of control bytes probed at once (one SSE2 register).
+ */
+#define DSC_TABLE_GROUP_WIDTH 16
+
+/**
+ * @brief The smallest capacity a table is created with.
+ */
+#define DSC_TABLE_MIN_CAPACITY DSC_TABLE_GROUP_WIDTH
+
+/**
+ * @brief The number of old slots migrated per insert or erase while an
+ *        incremental resize is in progress.
+ *
+ * Must be at least 2 so that the old slots are drained before the new ones
+ * (twice as many) fill up.
+ */
+#define DSC_TABLE_MIGRATE_STEP 64
+
+/**
+ * @brief The number of keys hashed and prefetched ahead of resolution in a
+ *        batch lookup.
+ *
+ * Large enough to keep several cache misses in flight, small enough that the
+ * prefetched lines are still resident when the second pass reaches them.
+ */
+#define DSC_TABLE_BATCH_WINDOW 16
+
+/**
+ * @brief The number of slot regions keys are grouped by in a parallel bulk
+ *        insert.
+ */
+#define DSC_TABLE_PARALLEL_REGIONS 256
+
+/**
+ * @brief The size of the inline buffer of a string key slot.
+ *
+ * Strings shorter than this, so that the terminator fits too, are stored in
+ * the slot itself and need neither an allocation nor a pointer chase.
+ */
+#define DSC_TABLE_STRING_INLINE 16
+
+/**
+ * @brief The fraction of occupied slots, as a divisor, below which a bulk
+ *        erase rebuilds the table at a smaller capacity.
+ */
+#define DSC_TABLE_SHRINK_LOAD 4
+
+typedef struct DSCTableString DSCTableString;
+
+struct DSCTableString {
+    union {
+        char buffer[DSC_TABLE_STRING_INLINE]; // Short strings, NUL-terminated
+        char *heap;                           // Longer strings, owned or pooled
+    } data;
+    uint32_t length; // The length without the terminator
+    uint32_t hash;   // The low 32 bits of the key's hash, checked before bytes
+};
+
+typedef struct DSCTable DSCTable;
+
+struct DSCTable {
+    int8_t *ctrl;       // capacity + group width control bytes
+    void *keys;         // Contiguous key slots of key_size bytes each
+    void *values;       // Contiguous value slots, NULL in keys-only mode
+    size_t key_size;    // The size of one key slot
+    size_t value_size;  // The size of one value slot
+    size_t growth_left; // Inserts into empty slots left before a resize
+    size_t size;        // The number of elements currently in the table
+    size_t capacity;    // The number of slots, always a power of two
+    DSCType key_type;   // The type of the keys in the table
+    DSCType value_type; // The type of the values, unknown in keys-only mode
+    DSCElementType key_element;   // Callbacks of DSC_TYPE_BYTES keys
+    DSCElementType value_element; // Callbacks of DSC_TYPE_BYTES values
+    uint64_t seed;      // Per-table hash seed
+    bool incremental;   // Whether resizes migrate a few slots per operation
+
+    // Source of the slot arrays and string copies
+    DSCAllocator allocator;
+
+    // Where long string keys are interned instead of copied, or NULL
+    DSCStringPool *pool;
+
+    // Slots of the previous capacity while an incremental resize is running
+    int8_t *old_ctrl;
+    void *old_keys;
+    void *old_values;
+    size_t old_capacity;
+    size_t old_size;    // Elements still waiting to be migrated
+    size_t migrate_pos; // Next old slot to migrate
+
+#ifdef DSC_STATS
+    // The counters of the set or map the table belongs to, or NULL
+    DSCStatsCounters *stats;
+#endif
+};
+
+/**
+ * @brief Initialize a table in place.
+ *
+ * @param table The table to initialize.
+ * @param key_type The type of the keys.
+ * @param key_element The record descriptor of DSC_TYPE_BYTES keys, ignored
+ *                    (and may be NULL) for every other key type.
+ * @param value_type The type of the values, or DSC_TYPE_UNKNOWN for a
+ *                   keys-only table.
+ * @param value_element The record descriptor of DSC_TYPE_BYTES values, ignored
+ *                      (and may be NULL) for every other value type.
+ * @param capacity The initial number of slots, rounded up to a power of two.
+ * @param allocator The allocator for the slots and string copies, or NULL for
+ *                  the default.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_table_init(DSCTable *table, DSCType key_type,
+                        const DSCElementType *key_element, DSCType value_type,
+                        const DSCElementType *value_element, size_t capacity,
+                        const DSCAllocator *allocator);
+
+/**
+ * @brief Release every element and the slot arrays of a table.
+ */
+void dsc_table_deinit(DSCTable *table);
+
+/**
+ * @brief Switch between stop-the-world and incremental resizing.
+ *
+ * In incremental mode a resize allocates the new slots but keeps the old ones
+ * live; every following insert or erase moves DSC_TABLE_MIGRATE_STEP old
+ * slots across, and lookups consult both until the old slots are drained.
+ * Disabling incremental mode finishes any migration in progress.
+ */
+void dsc_table_set_incremental(DSCTable *table, bool incremental);
+
+/**
+ * @brief Intern long string keys in a pool instead of copying them.
+ *
+ * The table must be empty. Interned keys are never freed by the table.
+ *
+ * @return DSC_ERROR_OK, or DSC_ERROR_INVALID_ARGUMENT if the table is not
+ *         empty or its keys are not strings.
+ */
+DSCError dsc_table_set_pool(DSCTable *table, DSCStringPool *pool);
+
+/**
+ * @brief Look up a key.
+ *
+ * Lookups never migrate slots so that they can stay const.
+ *
+ * @param table The table to search.
+ * @param key The key to look for.
+ * @param value Set to the key's value slot when it is found (NULL in
+ *              keys-only mode): a DSCData, or the record itself for
+ *              DSC_TYPE_BYTES values. May be NULL.
+ * @return true if the key is present, false otherwise.
+ */
+bool dsc_table_find(const DSCTable *table, DSCData key, void **value);
+
+/**
+ * @brief Look up a contiguous array of keys.
+ *
+ * Every key is hashed and its home group prefetched before any of them is
+ * resolved, so the cache misses overlap instead of being taken one by one.
+ * Keys are processed DSC_TABLE_BATCH_WINDOW at a time.
+ *
+ * @param table The table to search.
+ * @param keys A contiguous array of count elements of the table's key type,
+ *             key_element.size bytes apart.
+ * @param count The number of keys.
+ * @param values Set to each found key's value slot (NULL for missing keys and
+ *               in keys-only mode). May be NULL.
+ * @param found Set to whether each key is present.
+ */
+void dsc_table_find_batch(const DSCTable *table, void *keys, size_t count,
+                          void **values, bool *found);
+
+/**
+ * @brief Insert a key (and value, in key/value mode), copying strings.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_ALREADY_EXISTS or DSC_ERROR_OUT_OF_MEMORY.
+ */
+DSCError dsc_table_insert(DSCTable *table, DSCData key, DSCData value);
+
+/**
+ * @brief Insert a key (and value), taking over the caller's strings and
+ *        records instead of copying them.
+ *
+ * Strings must have been allocated with malloc. A long string key without a
+ * pool and string values are adopted as they are; short and pooled string
+ * keys are copied into their slot and the caller's string is freed. Records
+ * are moved in without their copy callbacks.
+ *
+ * @return DSC_ERROR_OK, DSC_ERROR_ALREADY_EXISTS or DSC_ERROR_OUT_OF_MEMORY.
+ *         On failure the caller keeps ownership of everything passed in.
+ */
+DSCError dsc_table_insert_move(DSCTable *table, DSCData key, DSCData value);
+
+/**
+ * @brief Insert a contiguous array of keys (and values) using a thread pool.
+ *
+ * The table is reserved for every key first. The keys are then hashed in
+ * parallel and grouped by the region of slots their probe starts in, and
+ * inserted region after region, so that the inserts sweep through the slots
+ * instead of missing the cache on every one. Inputs below the pool's cutoff
+ * are inserted one by one. Keys already present are skipped.
+ *
+ * @param table The table to insert into.
+ * @param keys A contiguous array of count keys, key_element.size bytes apart.
+ * @param values A contiguous array of count values, value_element.size bytes
+ *               apart, or NULL in keys-only mode.
+ * @param count The number of keys.
+ * @param pool The pool to hash on, or NULL.
+ * @return DSCError code indicating success or failure. On failure some of
+ *         the keys may have been inserted.
+ */
+DSCError dsc_table_insert_parallel(DSCTable *table, void *keys, void *values, size_t count,
+                                   DSCThreadPool *pool);
+
+/**
+ * @brief Erase a key and its value.
+ *
+ * @return DSC_ERROR_OK or DSC_ERROR_NOT_FOUND.
+ */
+DSCError dsc_table_erase(DSCTable *table, DSCData key);
+
+/**
+ * @brief Remove every element but keep the current capacity.
+ */
+void dsc_table_clear(DSCTable *table);
+
+/**
+ * @brief Called by dsc_table_erase_if once per element, with the key and
+ *        value as dsc_table_next yields them.
+ */
+typedef bool (*DSCTablePredicate)(const void *key, const void *value, void *context);
+
+/**
+ * @brief Erase every element for which the predicate returns match.
+ *
+ * The slots are walked once, after any incremental resize in flight is
+ * finished. If fewer than 1/DSC_TABLE_SHRINK_LOAD of the slots are left
+ * full, the table is rehashed at the smallest capacity above that share.
+ *
+ * @param match true to erase the elements the predicate matches, false to
+ *              erase the others.
+ * @return The number of elements erased.
+ */
+size_t dsc_table_erase_if(DSCTable *table, DSCTablePredicate predicate, void *context,
+                          bool match);
+
+/**
+ * @brief Exchange the elements of two tables, string pools and incremental
+ *        resizes in flight included.
+ *
+ * Each table keeps its allocator and counters, so the two allocators must be
+ * interchangeable and the key and value types the same.
+ */
+void dsc_table_swap(DSCTable *table, DSCTable *other);
+
+/**
+ * @brief Move every element into a freshly allocated set of slots.
+ *
+ * @param table The table to rehash.
+ * @param new_capacity The new number of slots, a power of two that can hold
+ *                     the current size.
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_table_rehash(DSCTable *table, size_t new_capacity);
+
+/**
+ * @brief Grow the table so that it holds count elements without resizing.
+ *
+ * Never shrinks. Any incremental resize in flight is finished first.
+ *
+ * @return DSCError code indicating success or failure.
+ */
+DSCError dsc_table_reserve(DSCTable *table, size_t count);
+
+/**
+ * @brief Step to the next element in slot order.
+ *
+ * The current slots are walked first, then the old slots an incremental
+ * resize has not migrated yet. The table must not be modified in between.
+ *
+ * @param table The table to walk.
+ * @param position The walk's state, 0 to start, advanced past the element.
+ * @param key Set to the element's key, as dsc_element_view describes it.
+ * @param value Set to its value the same way, NULL in keys-only mode.
+ * @return true if an element was found, false at the end of the table.
+ */
+bool dsc_table_next(const DSCTable *table, size_t *position, const void **key,
+                    const void **value);
+
+/* Per-type helpers shared by every hashed container */
+
+/**
+ * @brief Read a caller-provided element pointer into a DSCData without
+ *        copying strings.
+ *
+ * A DSC_TYPE_BYTES element is loaded as a pointer to the record (c_ptr).
+ */
+DSCData dsc_table_load(void *src, DSCType type);
+
+/**
+ * @brief Compare two loaded elements for equality.
+ */
+bool dsc_table_equal(DSCData lhs, DSCData rhs, DSCType type);
+
+/**
+ * @brief Store an element into container-owned storage, copying strings with
+ *        the given allocator.
+ */
+DSCError dsc_table_store(DSCData *dest, DSCData src, DSCType type,
+                         const DSCAllocator *allocator);
+
+/**
+ * @brief Write an element out to a caller-provided pointer, copying strings
+ *        with malloc.
+ */
+DSCError dsc_table_output(DSCData src, void *result, DSCType type);
+
+/**
+ * @brief Free any memory owned by a stored element.
+ */
+void dsc_table_release(DSCData *data, DSCType type,
+                       const DSCAllocator *allocator);
+
+/**
+ * @brief Hash a loaded element.
+ */
+uint64_t dsc_table_hash(DSCData key, DSCType type, uint64_t seed);
+
+#endif  // DSC_TABLE_H
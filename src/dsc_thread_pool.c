@@ -0,0 +1,293 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/dsc_thread_pool.h"
+#include "dsc_parallel.h"
+
+struct DSCThreadPool {
+    pthread_mutex_t lock;     // Guards the job fields and the thread states
+    pthread_cond_t wake;      // Signalled when a job is posted or on stop
+    pthread_cond_t done;      // Signalled when the last thread leaves a job
+    pthread_mutex_t run_lock; // Held for the whole of a parallel call
+    pthread_t *threads;       // The workers - 1 started threads
+    size_t workers;           // Threads working on a job, the caller included
+    size_t cutoff;            // Inputs smaller than this run serially
+
+    // The current job, written under lock before the generation is bumped
+    DSCParallelTask task;
+    void *context;
+    size_t count;
+    _Atomic size_t next;      // The next task index to claim
+    size_t generation;        // Bumped for every job
+    size_t busy;              // Started threads still inside the current job
+    bool stopping;            // Set by deinit
+};
+
+/* Claim and run tasks until none are left */
+static void dsc_thread_pool_work(DSCThreadPool *pool) {
+    size_t index;
+
+    while ((index = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed)) <
+           pool->count) {
+        pool->task(pool->context, index);
+    }
+}
+
+static void *dsc_thread_pool_main(void *arg) {
+    DSCThreadPool *pool = arg;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+
+        if (pool->stopping) {
+            break;
+        }
+
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        dsc_thread_pool_work(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/* Stop and join the first count threads */
+static void dsc_thread_pool_stop(DSCThreadPool *pool, size_t count) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < count; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+}
+
+static void dsc_thread_pool_destroy(DSCThreadPool *pool) {
+    pthread_mutex_destroy(&pool->run_lock);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+DSCError dsc_thread_pool_init(DSCThreadPool **pool, size_t workers) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 0 ? (size_t) online : 1;
+    }
+
+    DSCThreadPool *new_pool = malloc(sizeof(DSCThreadPool));
+    if (new_pool == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    memset(new_pool, 0, sizeof(DSCThreadPool));
+    new_pool->workers = workers;
+    new_pool->cutoff = DSC_THREAD_POOL_CUTOFF;
+    atomic_init(&new_pool->next, 0);
+
+    if (workers > 1) {
+        new_pool->threads = malloc((workers - 1) * sizeof(pthread_t));
+        if (new_pool->threads == NULL) {
+            free(new_pool);
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    pthread_mutex_init(&new_pool->lock, NULL);
+    pthread_cond_init(&new_pool->wake, NULL);
+    pthread_cond_init(&new_pool->done, NULL);
+    pthread_mutex_init(&new_pool->run_lock, NULL);
+
+    for (size_t i = 0; i + 1 < workers; ++i) {
+        if (pthread_create(&new_pool->threads[i], NULL, dsc_thread_pool_main, new_pool) != 0) {
+            dsc_thread_pool_stop(new_pool, i);
+            dsc_thread_pool_destroy(new_pool);
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    *pool = new_pool;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_thread_pool_deinit(DSCThreadPool *pool) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_thread_pool_stop(pool, pool->workers - 1);
+    dsc_thread_pool_destroy(pool);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_thread_pool_workers(const DSCThreadPool *pool, size_t *workers) {
+    if (pool == NULL || workers == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *workers = pool->workers;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_thread_pool_set_cutoff(DSCThreadPool *pool, size_t cutoff) {
+    if (pool == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    pool->cutoff = cutoff;
+
+    return DSC_ERROR_OK;
+}
+
+/* Internal fork-join */
+
+void dsc_parallel_run(DSCThreadPool *pool, DSCParallelTask task, void *context,
+                      size_t count) {
+    if (pool == NULL || pool->workers == 1 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(context, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run_lock);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+    pool->busy = pool->workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    dsc_thread_pool_work(pool);
+
+    // Every started thread has to take part before the next job is posted,
+    // even if it wakes only after the tasks ran out
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+size_t dsc_parallel_split(const DSCThreadPool *pool, size_t count) {
+    if (pool == NULL || pool->workers == 1 || count < pool->cutoff) {
+        return 1;
+    }
+
+    size_t chunks = pool->workers * DSC_PARALLEL_OVERSPLIT;
+
+    return count < chunks ? (count > 0 ? count : 1) : chunks;
+}
+
+typedef struct {
+    const uint32_t *ids;
+    size_t count;
+    size_t chunks;
+    size_t buckets;
+    size_t *counts; // chunks x buckets: histograms, then scatter offsets
+    size_t *order;
+} DSCParallelPartition;
+
+static void dsc_parallel_histogram(void *context, size_t index) {
+    DSCParallelPartition *partition = context;
+    size_t *counts = partition->counts + index * partition->buckets;
+    size_t end = dsc_parallel_begin(partition->count, partition->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(partition->count, partition->chunks, index); i < end; ++i) {
+        counts[partition->ids[i]]++;
+    }
+}
+
+static void dsc_parallel_scatter(void *context, size_t index) {
+    DSCParallelPartition *partition = context;
+    size_t *offsets = partition->counts + index * partition->buckets;
+    size_t end = dsc_parallel_begin(partition->count, partition->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(partition->count, partition->chunks, index); i < end; ++i) {
+        partition->order[offsets[partition->ids[i]]++] = i;
+    }
+}
+
+DSCError dsc_parallel_partition(DSCThreadPool *pool, const uint32_t *ids, size_t count,
+                                size_t buckets, size_t *order, size_t *starts,
+                                const DSCAllocator *allocator) {
+    DSCParallelPartition partition = {ids, count, dsc_parallel_split(pool, count), buckets,
+                                      NULL, order};
+
+    partition.counts = dsc_calloc(allocator, partition.chunks * buckets, sizeof(size_t));
+    if (partition.counts == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    dsc_parallel_run(pool, dsc_parallel_histogram, &partition, partition.chunks);
+
+    // Each chunk scatters bucket b after every earlier bucket and after the
+    // earlier chunks' share of b, which keeps the order stable
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        starts[b] = offset;
+
+        for (size_t c = 0; c < partition.chunks; ++c) {
+            size_t n = partition.counts[c * buckets + b];
+            partition.counts[c * buckets + b] = offset;
+            offset += n;
+        }
+    }
+    starts[buckets] = count;
+
+    dsc_parallel_run(pool, dsc_parallel_scatter, &partition, partition.chunks);
+
+    dsc_free(allocator, partition.counts);
+
+    return DSC_ERROR_OK;
+}
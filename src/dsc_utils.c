@@ -15,77 +15,207 @@
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <time.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/random.h>
+#endif
 
 #include "../include/dsc_utils.h"
 
-int dsc_compare(void *ptr1, void *ptr2, DSCType type) {
-    if (!dsc_type_is_valid(type)) {
-        return -1;
-    }
+/* Default secret of wyhash */
+static const uint64_t dsc_hash_secret[4] = {
+    0xa0761d6478bd642fULL,
+    0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL,
+    0x589965cc75374cc3ULL,
+};
 
-    switch (type) {
-        case DSC_TYPE_CHAR:
-            return (*(char *) ptr1 - *(char *) ptr2);
-        case DSC_TYPE_INT:
-            return (*(int *) ptr1 - *(int *) ptr2);
-        case DSC_TYPE_FLOAT:
-            return (*(float *) ptr1 > *(float *) ptr2) - (*(float *) ptr1 < *(float *) ptr2);
-        case DSC_TYPE_DOUBLE:
-            return (*(double *) ptr1 > *(double *) ptr2) - (*(double *) ptr1 < *(double *) ptr2);
-        case DSC_TYPE_BOOL:
-            return (*(bool *) ptr1 - *(bool *) ptr2);
-        case DSC_TYPE_POINTER:
-            return ((uintptr_t) ptr1 - (uintptr_t) ptr2);
-        case DSC_TYPE_STRING:
-            return strcmp((const char *) ptr1, (const char *) ptr2);
-        default:
-            // Unknown type
-            return -1;
+/* 64x64->128 bit multiply, returning the low half in *a and high in *b */
+static inline void dsc_hash_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t) *a, lb = (uint32_t) *b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+static inline uint64_t dsc_hash_mix(uint64_t a, uint64_t b) {
+    dsc_hash_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t dsc_hash_read8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t dsc_hash_read4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t dsc_hash_read3(const uint8_t *p, size_t k) {
+    return ((uint64_t) p[0] << 16) | ((uint64_t) p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t dsc_hash_bytes(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *) data;
+    const uint64_t *secret = dsc_hash_secret;
+    uint64_t a;
+    uint64_t b;
+
+    seed ^= dsc_hash_mix(seed ^ secret[0], secret[1]);
+
+    if (size <= 16) {
+        if (size >= 4) {
+            // Two overlapping 4-byte reads from each end cover 4..16 bytes
+            a = (dsc_hash_read4(p) << 32) | dsc_hash_read4(p + ((size >> 3) << 2));
+            b = (dsc_hash_read4(p + size - 4) << 32) |
+                dsc_hash_read4(p + size - 4 - ((size >> 3) << 2));
+        } else if (size > 0) {
+            a = dsc_hash_read3(p, size);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = size;
+
+        if (i > 48) {
+            // Three independent lanes keep the multipliers busy
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+
+            do {
+                seed = dsc_hash_mix(dsc_hash_read8(p) ^ secret[1], dsc_hash_read8(p + 8) ^ seed);
+                see1 = dsc_hash_mix(dsc_hash_read8(p + 16) ^ secret[2], dsc_hash_read8(p + 24) ^ see1);
+                see2 = dsc_hash_mix(dsc_hash_read8(p + 32) ^ secret[3], dsc_hash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = dsc_hash_mix(dsc_hash_read8(p) ^ secret[1], dsc_hash_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = dsc_hash_read8(p + i - 16);
+        b = dsc_hash_read8(p + i - 8);
     }
+
+    a ^= secret[1];
+    b ^= seed;
+    dsc_hash_mum(&a, &b);
+
+    return dsc_hash_mix(a ^ secret[0] ^ size, b ^ secret[1]);
 }
 
-uint32_t dsc_hash(void *key, DSCType key_type, size_t capacity) {
-    uint32_t hash;
+uint64_t dsc_hash_u64(uint64_t value, uint64_t seed) {
+    return dsc_hash_mix(value ^ dsc_hash_secret[0], seed ^ dsc_hash_secret[1]);
+}
 
+uint64_t dsc_hash(const void *key, DSCType key_type, uint64_t seed) {
     switch (key_type) {
-        case DSC_TYPE_UNKNOWN:
-            // Handle unknown types or return an error
-            return 0;
+        case DSC_TYPE_BOOL:
+            return dsc_hash_u64(*(const bool *) key, seed);
+
         case DSC_TYPE_CHAR:
-            hash = *(char *) key;
-            break;
-        case DSC_TYPE_FLOAT:
-            hash = *(uint32_t *) key;
-            break;
-        case DSC_TYPE_DOUBLE:
-            hash = *(uint32_t *) key;
-            break;
-        case DSC_TYPE_STRING:
-            // Use the DJB2 string hashing algorithm
-            hash = 5381;
-            const char *str = (const char *) key;
-            int c;
-            while ((c = *str++)) {
-                hash = ((hash << 5) + hash) + c;
+            return dsc_hash_u64((unsigned char) *(const char *) key, seed);
+
+        case DSC_TYPE_INT:
+            return dsc_hash_u64((uint64_t) (int64_t) *(const int *) key, seed);
+
+        case DSC_TYPE_FLOAT: {
+            // -0.0f == 0.0f, so both must land on the same hash
+            float f = *(const float *) key;
+            uint32_t bits = 0;
+            if (f != 0.0f) {
+                memcpy(&bits, &f, sizeof(bits));
             }
-            break;
-        case DSC_TYPE_BOOL:
-            hash = *(bool *) key;
-            break;
-        case DSC_TYPE_POINTER:
-            hash = (uint32_t) (uintptr_t) key;
-            break;
+            return dsc_hash_u64(bits, seed);
+        }
+
+        case DSC_TYPE_DOUBLE: {
+            double d = *(const double *) key;
+            uint64_t bits = 0;
+            if (d != 0.0) {
+                memcpy(&bits, &d, sizeof(bits));
+            }
+            return dsc_hash_u64(bits, seed);
+        }
+
+        case DSC_TYPE_STRING: {
+            const char *str = (const char *) key;
+            return dsc_hash_bytes(str, strlen(str), seed);
+        }
+
         default:
-            // Handle unknown types or return an error
             return 0;
     }
+}
+
+static bool dsc_os_random(void *buffer, size_t size) {
+#if defined(__linux__)
+    if (getrandom(buffer, size, 0) == (ssize_t) size) {
+        return true;
+    }
+#elif defined(__APPLE__)
+    if (getentropy(buffer, size) == 0) {
+        return true;
+    }
+#endif
+
+    FILE *file = fopen("/dev/urandom", "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    setvbuf(file, NULL, _IONBF, 0);
+    bool ok = fread(buffer, 1, size, file) == size;
+    fclose(file);
+
+    return ok;
+}
+
+uint64_t dsc_hash_seed(void) {
+    uint64_t seed;
+    if (dsc_os_random(&seed, sizeof(seed))) {
+        return seed;
+    }
+
+    static uint64_t counter = 0;
+    int stack;
+
+    // Without OS entropy, mix a per-call counter with the clock and an
+    // ASLR-dependent address
+    uint64_t entropy = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
 
-    // Mix the bits of the hash value and use a prime number for better distribution
-    hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
-    hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
-    hash = (hash >> 16) ^ hash;
+    seed = dsc_hash_u64((uint64_t) (uintptr_t) &stack, entropy);
+    seed = dsc_hash_u64((uint64_t) now.tv_sec ^ seed, (uint64_t) now.tv_nsec);
 
-    return hash % capacity;
+    return seed;
 }
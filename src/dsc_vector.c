@@ -15,92 +15,96 @@
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../include/dsc_vector.h"
+#include "dsc_parallel.h"
+#include "dsc_simd.h"
+#include "dsc_snapshot_file.h"
+#include "dsc_sort.h"
+#include "dsc_stats_counters.h"
 
 struct DSCVector {
     DSCData    data; // The data stored in the vector
     size_t     size; // The number of elements currently in the vector
     size_t capacity; // The current capacity of the vector
     DSCType    type; // The type of the elements in the vector
+    DSCElementType element; // The element stride, and the callbacks of records
+    DSCGrowthPolicy growth; // How the capacity grows and shrinks
+    DSCAllocator allocator; // Source of the vector, its buffer and strings
+#ifdef DSC_STATS
+    DSCStatsCounters stats; // Instrumentation, see dsc_stats.h
+#endif
 };
 
+static inline unsigned char *dsc_vector_record(const DSCVector *vector, size_t index) {
+    return (unsigned char *) vector->data.c_ptr + index * vector->element.size;
+}
 
-static DSCError dsc_vector_resize(DSCVector *vector, size_t new_capacity) {
-    switch (vector->type) {
-        case DSC_TYPE_CHAR: {
-            char *new_data = realloc(vector->data.c_ptr, new_capacity * sizeof(char));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            vector->data.c_ptr = new_data;
-            break;
-        }
+DSCError dsc_vector_resize(DSCVector *vector, size_t new_capacity) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        case DSC_TYPE_INT: {
-            int *new_data = realloc(vector->data.i_ptr, new_capacity * sizeof(int));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            vector->data.i_ptr = new_data;
-            break;
+    // Free the strings that no longer fit before their slots go away
+    if (vector->type == DSC_TYPE_STRING) {
+        for (size_t i = new_capacity; i < vector->size; ++i) {
+            dsc_free(&vector->allocator, vector->data.s_ptr[i]);
         }
+    }
 
-        case DSC_TYPE_FLOAT: {
-            float *new_data = realloc(vector->data.f_ptr, new_capacity * sizeof(float));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            vector->data.f_ptr = new_data;
-            break;
-        }
+    if (vector->type == DSC_TYPE_BYTES && vector->size > new_capacity) {
+        dsc_element_destroy(&vector->element, dsc_vector_record(vector, new_capacity),
+                            vector->size - new_capacity);
+    }
 
-        case DSC_TYPE_DOUBLE: {
-            double *new_data = realloc(vector->data.d_ptr, new_capacity * sizeof(double));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            vector->data.d_ptr = new_data;
-            break;
-        }
+    if (vector->size > new_capacity) {
+        vector->size = new_capacity;
+    }
 
-        case DSC_TYPE_STRING: {
-            char **new_data = realloc(vector->data.s_ptr, new_capacity * sizeof(char *));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            vector->data.s_ptr = new_data;
-            break;
-        }
+    DSCError error = dsc_data_realloc_stride(&vector->data, vector->element.size, new_capacity,
+                                             &vector->allocator);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
 
-        case DSC_TYPE_BOOL: {
-            bool *new_data = realloc(vector->data.b_ptr, new_capacity * sizeof(bool));
-            if (new_data == NULL) {
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    DSC_STATS_REALLOC(&vector->stats);
+    vector->capacity = new_capacity;
 
-            vector->data.b_ptr = new_data;
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        default: {
-            // Unknown type
-            return DSC_ERROR_INVALID_TYPE;
-        }
+static DSCError dsc_vector_grow(DSCVector *vector, size_t min_capacity) {
+    if (min_capacity <= vector->capacity) {
+        return DSC_ERROR_OK;
     }
 
-    vector->capacity = new_capacity;
-    return DSC_ERROR_OK;
+    return dsc_vector_resize(vector, dsc_growth_next(&vector->growth, vector->capacity,
+                                                     min_capacity, vector->element.size));
 }
 
-DSCError dsc_vector_init(DSCVector *new_vector, DSCType type) {
-    if (!dsc_type_is_valid(type)) {
-        return DSC_ERROR_INVALID_TYPE;
+/* Give memory back after removals once the policy's shrink ratio is crossed */
+static void dsc_vector_auto_shrink(DSCVector *vector) {
+    size_t new_capacity = dsc_growth_shrink(&vector->growth, vector->size,
+                                            vector->capacity, DSC_VECTOR_INITIAL_CAPACITY,
+                                            vector->element.size);
+
+    // A failed shrink leaves the larger buffer in place, which is harmless
+    if (new_capacity < vector->capacity) {
+        dsc_vector_resize(vector, new_capacity);
     }
+}
+
+DSCError dsc_vector_init(DSCVector **vector, DSCType type) {
+    return dsc_vector_init_allocator(vector, type, NULL);
+}
 
-    new_vector = malloc(sizeof(DSCVector));
+static DSCError dsc_vector_create(DSCVector **vector, DSCType type,
+                                  const DSCElementType *element,
+                                  const DSCAllocator *allocator) {
+    DSCVector *new_vector = dsc_alloc(allocator, sizeof(DSCVector));
     if (new_vector == NULL) {
         return DSC_ERROR_OUT_OF_MEMORY;
     }
@@ -108,129 +112,89 @@ DSCError dsc_vector_init(DSCVector *new_vector, DSCType type) {
     new_vector->size = 0;
     new_vector->capacity = DSC_VECTOR_INITIAL_CAPACITY;
     new_vector->type = type;
+    new_vector->element = *element;
+    new_vector->growth = DSC_GROWTH_POLICY_DEFAULT;
+    new_vector->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    DSC_STATS_INIT(&new_vector->stats, &new_vector->allocator);
+
+    DSCError error = dsc_data_malloc_stride(&new_vector->data, element->size,
+                                            new_vector->capacity, &new_vector->allocator);
+    if (error != DSC_ERROR_OK) {
+        dsc_free(allocator, new_vector);
+        return error;
+    }
 
-    switch (type) {
-        case DSC_TYPE_CHAR: {
-            new_vector->data.c_ptr = malloc(new_vector->capacity * sizeof(char));
-            if (new_vector->data.c_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-            break;
-        }
-
-        case DSC_TYPE_INT: {
-            new_vector->data.i_ptr = malloc(new_vector->capacity * sizeof(int));
-            if (new_vector->data.i_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
-
-        case DSC_TYPE_FLOAT: {
-            new_vector->data.f_ptr = malloc(new_vector->capacity * sizeof(float));
-            if (new_vector->data.f_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
+    *vector = new_vector;
 
-        case DSC_TYPE_DOUBLE: {
-            new_vector->data.d_ptr = malloc(new_vector->capacity * sizeof(double));
-            if (new_vector->data.d_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    return DSC_ERROR_OK;
+}
 
-            break;
-        }
+DSCError dsc_vector_init_allocator(DSCVector **vector, DSCType type,
+                                   const DSCAllocator *allocator) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-        case DSC_TYPE_STRING: {
-            new_vector->data.s_ptr = malloc(new_vector->capacity * sizeof(char *));
-            if (new_vector->data.s_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
 
-            break;
-        }
+    DSCElementType element = dsc_element_of(type);
 
-        case DSC_TYPE_BOOL: {
-            new_vector->data.b_ptr = malloc(new_vector->capacity * sizeof(bool));
-            if (new_vector->data.b_ptr == NULL) {
-                free(new_vector);
-                return DSC_ERROR_OUT_OF_MEMORY;
-            }
-
-            break;
-        }
+    return dsc_vector_create(vector, type, &element, allocator);
+}
 
-        default: {
-            free(new_vector);
-            return DSC_ERROR_INVALID_TYPE;
-        }
+DSCError dsc_vector_init_bytes(DSCVector **vector, const DSCElementType *element,
+                               const DSCAllocator *allocator) {
+    if (vector == NULL || dsc_element_invalid(element)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    return new_vector;
+    return dsc_vector_create(vector, DSC_TYPE_BYTES, element, allocator);
 }
 
-
 DSCError dsc_vector_deinit(DSCVector *vector) {
     if (vector == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    switch (vector->type) {
-        case DSC_TYPE_CHAR: {
-            free(vector->data.c_ptr);
-            break;
-        }
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = vector->allocator;
 
-        case DSC_TYPE_INT: {
-            free(vector->data.i_ptr);
-            break;
-        }
+    if (vector->type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&vector->element, vector->data.c_ptr, vector->size);
+    }
 
-        case DSC_TYPE_FLOAT: {
-            free(vector->data.f_ptr);
-            break;
-        }
+    dsc_data_free(&vector->data, vector->type, vector->size, &allocator);
+    dsc_free(&allocator, vector);
 
-        case DSC_TYPE_DOUBLE: {
-            free(vector->data.d_ptr);
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        case DSC_TYPE_STRING: {
-            for (size_t i = 0; i < vector->size; ++i) {
-                free(vector->data.s_ptr[i]);
-            }
+DSCError dsc_vector_set_growth(DSCVector *vector, const DSCGrowthPolicy *policy) {
+    if (vector == NULL || dsc_growth_invalid(policy)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
 
-            free(vector->data.s_ptr);
-            break;
-        }
+    vector->growth = *policy;
 
-        case DSC_TYPE_BOOL: {
-            free(vector->data.b_ptr);
-            break;
-        }
+    return DSC_ERROR_OK;
+}
 
-        default: {
-            return DSC_ERROR_INVALID_TYPE;
-        }
+DSCError dsc_vector_shrink_to_fit(DSCVector *vector) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    free(vector);
+    if (vector->size == vector->capacity) {
+        return DSC_ERROR_OK;
+    }
 
-    return DSC_ERROR_OK;
+    return dsc_vector_resize(vector, vector->size);
 }
 
 DSCError dsc_vector_size(const DSCVector *vector, size_t *result) {
-    if (vector == NULL) {
+    if (vector == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -240,7 +204,7 @@ DSCError dsc_vector_size(const DSCVector *vector, size_t *result) {
 }
 
 DSCError dsc_vector_capacity(const DSCVector *vector, size_t *result) {
-    if (vector == NULL) {
+    if (vector == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -249,7 +213,7 @@ DSCError dsc_vector_capacity(const DSCVector *vector, size_t *result) {
     return DSC_ERROR_OK;
 }
 
-DSCError dsc_vector_is_empty(const DSCVector *vector, bool *result) {
+DSCError dsc_vector_empty(const DSCVector *vector, bool *result) {
     if (vector == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
@@ -260,7 +224,7 @@ DSCError dsc_vector_is_empty(const DSCVector *vector, bool *result) {
 }
 
 DSCError dsc_vector_at(const DSCVector *vector, size_t index, void *result) {
-    if (vector == NULL) {
+    if (vector == NULL || result == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
@@ -269,6 +233,11 @@ DSCError dsc_vector_at(const DSCVector *vector, size_t index, void *result) {
     }
 
     switch (vector->type) {
+        case DSC_TYPE_BOOL: {
+            *(bool *) result = vector->data.b_ptr[index];
+            break;
+        }
+
         case DSC_TYPE_CHAR: {
             *(char *) result = vector->data.c_ptr[index];
             break;
@@ -290,24 +259,50 @@ DSCError dsc_vector_at(const DSCVector *vector, size_t index, void *result) {
         }
 
         case DSC_TYPE_STRING: {
-            const char *s = vector->data.s_ptr[index];
-            size_t size = strlen(s) + 1;
-
-            result = malloc(size);
-            if (result == NULL) {
+            char *copy = strdup(vector->data.s_ptr[index]);
+            if (copy == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(result, s, size);
-            memset(result + size - 1, '\0', 1);
-
+            *(char **) result = copy;
             break;
         }
+
+        case DSC_TYPE_BYTES: {
+            return dsc_element_copy(&vector->element, result, dsc_vector_record(vector, index));
+        }
+
+        default: {
+            return DSC_ERROR_INVALID_TYPE;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_at_view(const DSCVector *vector, size_t index, DSCStringView *result) {
+    if (vector == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (vector->type != DSC_TYPE_STRING) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (index >= vector->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
     }
 
+    result->data = vector->data.s_ptr[index];
+    result->length = strlen(result->data);
+
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_vector_front(const DSCVector *vector, void *result) {
+    return dsc_vector_at(vector, 0, result);
+}
+
 DSCError dsc_vector_back(const DSCVector *vector, void *data) {
     if (vector == NULL || data == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -333,18 +328,18 @@ DSCError dsc_vector_back(const DSCVector *vector, void *data) {
         case DSC_TYPE_DOUBLE:
             *(double *) data = vector->data.d_ptr[vector->size - 1];
             break;
-        case DSC_TYPE_STRING:
-            size_t string_size = strlen(vector->data.s_ptr[vector->size - 1]);
-
-            // Allocate an extra byte of memory for the null terminator
-            data = malloc(string_size + 1);
-            if (data == NULL) {
+        case DSC_TYPE_STRING: {
+            char *copy = strdup(vector->data.s_ptr[vector->size - 1]);
+            if (copy == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
 
-            strncpy(data, vector->data.s_ptr[vector->size - 1], string_size);
-            memset(data + string_size, '\0', 1);
+            *(char **) data = copy;
             break;
+        }
+        case DSC_TYPE_BYTES:
+            return dsc_element_copy(&vector->element, data,
+                                    dsc_vector_record(vector, vector->size - 1));
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
@@ -358,11 +353,9 @@ DSCError dsc_vector_push_back(DSCVector *vector, void *data) {
     }
 
     // Resize the vector if the size exceeds the capacity
-    if (vector->size >= vector->capacity) {
-        size_t new_capacity = vector->capacity * 2;
-        if (!dsc_vector_resize(vector, new_capacity)) {
-            return DSC_ERROR_OUT_OF_MEMORY;
-        }
+    DSCError error = dsc_vector_grow(vector, vector->size + 1);
+    if (error != DSC_ERROR_OK) {
+        return error;
     }
 
     switch (vector->type) {
@@ -387,15 +380,10 @@ DSCError dsc_vector_push_back(DSCVector *vector, void *data) {
         }
 
         case DSC_TYPE_STRING: {
-            size_t data_size = strlen((char *) data);
-
-            vector->data.s_ptr[vector->size] = malloc(data_size + 1);
+            vector->data.s_ptr[vector->size] = dsc_strdup(&vector->allocator, (char *) data);
             if (vector->data.s_ptr[vector->size] == NULL) {
                 return DSC_ERROR_OUT_OF_MEMORY;
             }
-
-            strncpy(vector->data.s_ptr[vector->size], (char *) data, data_size);
-            memset(vector->data.s_ptr[vector->size] + data_size, '\0', 1);
             break;
         }
 
@@ -404,6 +392,15 @@ DSCError dsc_vector_push_back(DSCVector *vector, void *data) {
             break;
         }
 
+        case DSC_TYPE_BYTES: {
+            error = dsc_element_copy(&vector->element, dsc_vector_record(vector, vector->size),
+                                     data);
+            if (error != DSC_ERROR_OK) {
+                return error;
+            }
+            break;
+        }
+
         default: {
             // Unknown type
             return DSC_ERROR_INVALID_TYPE;
@@ -414,6 +411,41 @@ DSCError dsc_vector_push_back(DSCVector *vector, void *data) {
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_vector_push_back_move(DSCVector *vector, void *data) {
+    if (vector == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only strings and records own anything that could be moved
+    if (vector->type != DSC_TYPE_STRING && vector->type != DSC_TYPE_BYTES) {
+        return dsc_vector_push_back(vector, data);
+    }
+
+    DSCError error = dsc_vector_grow(vector, vector->size + 1);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (vector->type == DSC_TYPE_BYTES) {
+        // Ownership of the record moves with its bytes
+        memcpy(dsc_vector_record(vector, vector->size), data, vector->element.size);
+    } else {
+        char *string = dsc_allocator_adopt(&vector->allocator, data);
+        if (string == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        if (string != data) {
+            free(data);
+        }
+
+        vector->data.s_ptr[vector->size] = string;
+    }
+
+    vector->size++;
+    return DSC_ERROR_OK;
+}
+
 DSCError dsc_vector_pop_back(DSCVector *vector, void *data) {
     if (vector == NULL || data == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
@@ -439,15 +471,28 @@ DSCError dsc_vector_pop_back(DSCVector *vector, void *data) {
         case DSC_TYPE_DOUBLE:
             *(double *) data = vector->data.d_ptr[vector->size - 1];
             break;
-        case DSC_TYPE_STRING:
-            *(char **) data = vector->data.s_ptr[vector->size - 1];
-            vector->data.s[vector->size - 1] = NULL;
+        case DSC_TYPE_STRING: {
+            // Ownership moves to the caller, who frees with free
+            char *string = dsc_allocator_export(&vector->allocator,
+                                                vector->data.s_ptr[vector->size - 1]);
+            if (string == NULL) {
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+
+            *(char **) data = string;
+            vector->data.s_ptr[vector->size - 1] = NULL;
+            break;
+        }
+        case DSC_TYPE_BYTES:
+            // Ownership of the record moves with its bytes
+            memcpy(data, dsc_vector_record(vector, vector->size - 1), vector->element.size);
             break;
         default:
             return DSC_ERROR_INVALID_TYPE;
     }
 
     vector->size--;
+    dsc_vector_auto_shrink(vector);
 
     return DSC_ERROR_OK;
 }
@@ -463,11 +508,26 @@ DSCError dsc_vector_insert(DSCVector *vector, void *data, size_t index) {
     }
 
     // Resize the vector if the size exceeds the capacity
-    if (vector->size >= vector->capacity) {
-        size_t new_capacity = vector->capacity * 2;
-        if (!dsc_vector_resize(vector, new_capacity)) {
-            return DSC_ERROR_OUT_OF_MEMORY;
+    DSCError error = dsc_vector_grow(vector, vector->size + 1);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (vector->type == DSC_TYPE_BYTES) {
+        size_t stride = vector->element.size;
+        unsigned char *slot = dsc_vector_record(vector, index);
+
+        memmove(slot + stride, slot, (vector->size - index) * stride);
+
+        error = dsc_element_copy(&vector->element, slot, data);
+        if (error != DSC_ERROR_OK) {
+            memmove(slot, slot + stride, (vector->size - index) * stride);
+            return error;
         }
+
+        vector->size++;
+
+        return DSC_ERROR_OK;
     }
 
     // Shift elements to the right to make room for the new element
@@ -518,7 +578,13 @@ DSCError dsc_vector_insert(DSCVector *vector, void *data, size_t index) {
         }
 
         case DSC_TYPE_STRING: {
-            vector->data.s_ptr[index] = strdup(*(char **) data);
+            vector->data.s_ptr[index] = dsc_strdup(&vector->allocator, *(char **) data);
+            if (vector->data.s_ptr[index] == NULL) {
+                // Close the gap again so the vector is left as it was
+                memmove(&vector->data.s_ptr[index], &vector->data.s_ptr[index + 1],
+                        (vector->size - index) * sizeof(char *));
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
             break;
         }
 
@@ -547,7 +613,20 @@ DSCError dsc_vector_erase(DSCVector *vector, size_t index) {
     }
 
     if (vector->type == DSC_TYPE_STRING) {
-        free(vector->data.s[index]);
+        dsc_free(&vector->allocator, vector->data.s_ptr[index]);
+    }
+
+    if (vector->type == DSC_TYPE_BYTES) {
+        unsigned char *slot = dsc_vector_record(vector, index);
+
+        dsc_element_destroy(&vector->element, slot, 1);
+        memmove(slot, slot + vector->element.size,
+                (vector->size - index - 1) * vector->element.size);
+
+        vector->size--;
+        dsc_vector_auto_shrink(vector);
+
+        return DSC_ERROR_OK;
     }
 
     // Shift elements to the left to fill the gap
@@ -590,22 +669,497 @@ DSCError dsc_vector_erase(DSCVector *vector, size_t index) {
     }
 
     vector->size--;
+    dsc_vector_auto_shrink(vector);
+
+    return DSC_ERROR_OK;
+}
+
+static DSCError dsc_vector_erase_matching(DSCVector *vector, DSCPredicate predicate,
+                                          void *context, size_t *removed, bool match) {
+    if (vector == NULL || predicate == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t stride = vector->element.size;
+    size_t kept = 0;
+
+    // Kept elements slide down over the erased ones in a single pass; every
+    // type is moved as raw slot bytes, string pointers included
+    for (size_t i = 0; i < vector->size; ++i) {
+        unsigned char *slot = dsc_vector_record(vector, i);
+
+        if (predicate(dsc_element_view(slot, vector->type), context) != match) {
+            if (kept != i) {
+                memcpy(dsc_vector_record(vector, kept), slot, stride);
+            }
+
+            kept++;
+            continue;
+        }
+
+        if (vector->type == DSC_TYPE_STRING) {
+            dsc_free(&vector->allocator, vector->data.s_ptr[i]);
+        } else if (vector->type == DSC_TYPE_BYTES) {
+            dsc_element_destroy(&vector->element, slot, 1);
+        }
+    }
+
+    if (removed != NULL) {
+        *removed = vector->size - kept;
+    }
+
+    vector->size = kept;
+    dsc_vector_auto_shrink(vector);
 
     return DSC_ERROR_OK;
 }
 
+DSCError dsc_vector_erase_if(DSCVector *vector, DSCPredicate predicate, void *context,
+                             size_t *removed) {
+    return dsc_vector_erase_matching(vector, predicate, context, removed, true);
+}
+
+DSCError dsc_vector_retain(DSCVector *vector, DSCPredicate predicate, void *context,
+                           size_t *removed) {
+    return dsc_vector_erase_matching(vector, predicate, context, removed, false);
+}
+
 DSCError dsc_vector_clear(DSCVector *vector) {
     if (vector == NULL) {
         return DSC_ERROR_INVALID_ARGUMENT;
     }
 
-    if (vector->type == DSC_TYPE_STRING) {
+    if (vector->type == DSC_TYPE_STRING && dsc_allocator_frees(&vector->allocator)) {
         for (size_t i = 0; i < vector->size; ++i) {
-            free(vector->data.s_ptr[i]);
+            dsc_free(&vector->allocator, vector->data.s_ptr[i]);
         }
     }
 
+    if (vector->type == DSC_TYPE_BYTES) {
+        dsc_element_destroy(&vector->element, vector->data.c_ptr, vector->size);
+    }
+
     vector->size = 0;
 
     return DSC_ERROR_OK;
 }
+
+DSCError dsc_vector_swap(DSCVector *vector, DSCVector *other) {
+    if (vector == NULL || other == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (vector->type != other->type || !dsc_element_equal(&vector->element, &other->element) ||
+        !dsc_allocator_equal(&vector->allocator, &other->allocator)) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCData data = vector->data;
+    size_t size = vector->size;
+    size_t capacity = vector->capacity;
+
+    vector->data = other->data;
+    vector->size = other->size;
+    vector->capacity = other->capacity;
+
+    other->data = data;
+    other->size = size;
+    other->capacity = capacity;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_reserve(DSCVector *vector, size_t capacity) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (capacity <= vector->capacity) {
+        return DSC_ERROR_OK;
+    }
+
+    return dsc_vector_resize(vector, capacity);
+}
+
+DSCError dsc_vector_append_range(DSCVector *vector, void *data, size_t count) {
+    if (vector == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCError error = dsc_vector_grow(vector, vector->size + count);
+    if (error != DSC_ERROR_OK) {
+        return error;
+    }
+
+    if (vector->type == DSC_TYPE_STRING) {
+        char **strings = data;
+
+        for (size_t i = 0; i < count; ++i) {
+            vector->data.s_ptr[vector->size + i] = dsc_strdup(&vector->allocator, strings[i]);
+
+            if (vector->data.s_ptr[vector->size + i] == NULL) {
+                // Leave the vector as it was before the call
+                while (i-- > 0) {
+                    dsc_free(&vector->allocator, vector->data.s_ptr[vector->size + i]);
+                }
+
+                return DSC_ERROR_OUT_OF_MEMORY;
+            }
+        }
+    } else if (vector->type == DSC_TYPE_BYTES && vector->element.copy != NULL) {
+        const unsigned char *records = data;
+
+        for (size_t i = 0; i < count; ++i) {
+            error = dsc_element_copy(&vector->element, dsc_vector_record(vector, vector->size + i),
+                                     records + i * vector->element.size);
+
+            if (error != DSC_ERROR_OK) {
+                // Leave the vector as it was before the call
+                dsc_element_destroy(&vector->element, dsc_vector_record(vector, vector->size), i);
+                return error;
+            }
+        }
+    } else {
+        // Every primitive array shares the union's storage, so one copy does
+        size_t stride = vector->element.size;
+        memcpy(vector->data.c_ptr + vector->size * stride, data, count * stride);
+    }
+
+    vector->size += count;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_cursor_init(const DSCVector *vector, DSCVectorCursor *cursor) {
+    if (vector == NULL || cursor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    cursor->vector = vector;
+    cursor->index = 0;
+
+    return DSC_ERROR_OK;
+}
+
+bool dsc_vector_cursor_next(DSCVectorCursor *cursor, const void **element) {
+    const DSCVector *vector = cursor->vector;
+
+    if (cursor->index >= vector->size) {
+        return false;
+    }
+
+    *element = dsc_element_view(dsc_vector_record(vector, cursor->index), vector->type);
+    cursor->index++;
+
+    return true;
+}
+
+DSCError dsc_vector_for_each(const DSCVector *vector, DSCVisitor visitor, void *context) {
+    if (vector == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    const unsigned char *slot = (const unsigned char *) vector->data.c_ptr;
+    size_t stride = vector->element.size;
+
+    for (size_t i = 0; i < vector->size; ++i, slot += stride) {
+        if (!visitor(dsc_element_view(slot, vector->type), context)) {
+            break;
+        }
+    }
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_find(const DSCVector *vector, void *value, size_t *index) {
+    if (vector == NULL || value == NULL || index == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_simd_supported(vector->type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    size_t found = dsc_simd_find(vector->data.c_ptr, vector->size, vector->type, value);
+    if (found == vector->size) {
+        return DSC_ERROR_NOT_FOUND;
+    }
+
+    *index = found;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_count(const DSCVector *vector, void *value, size_t *count) {
+    if (vector == NULL || value == NULL || count == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_simd_supported(vector->type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    *count = dsc_simd_count(vector->data.c_ptr, vector->size, vector->type, value);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_min(const DSCVector *vector, void *result) {
+    if (vector == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_simd_supported(vector->type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (vector->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    dsc_simd_min(vector->data.c_ptr, vector->size, vector->type, result);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_max(const DSCVector *vector, void *result) {
+    if (vector == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_simd_supported(vector->type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (vector->size == 0) {
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    dsc_simd_max(vector->data.c_ptr, vector->size, vector->type, result);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_sum(const DSCVector *vector, void *result) {
+    if (vector == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!dsc_simd_supported(vector->type)) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    dsc_simd_sum(vector->data.c_ptr, vector->size, vector->type, result);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_sort(DSCVector *vector) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_sort(vector->data.c_ptr, vector->size, vector->type, &vector->element,
+             &vector->allocator);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_partial_sort(DSCVector *vector, size_t count) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (count > vector->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    dsc_sort_partial(vector->data.c_ptr, vector->size, count, vector->type, &vector->element);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_nth_element(DSCVector *vector, size_t index) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (index >= vector->size) {
+        return DSC_ERROR_OUT_OF_RANGE;
+    }
+
+    dsc_sort_select(vector->data.c_ptr, vector->size, index, vector->type, &vector->element);
+
+    return DSC_ERROR_OK;
+}
+
+static DSCError dsc_vector_bound(const DSCVector *vector, void *value, size_t *index,
+                                 bool upper) {
+    if (vector == NULL || value == NULL || index == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The search compares against elements as stored, and strings are stored
+    // as pointers
+    const char *string = value;
+    const void *key = vector->type == DSC_TYPE_STRING ? (const void *) &string : value;
+
+    *index = dsc_sort_bound(vector->data.c_ptr, vector->size, vector->type, &vector->element,
+                            key, upper);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_lower_bound(const DSCVector *vector, void *value, size_t *index) {
+    return dsc_vector_bound(vector, value, index, false);
+}
+
+DSCError dsc_vector_upper_bound(const DSCVector *vector, void *value, size_t *index) {
+    return dsc_vector_bound(vector, value, index, true);
+}
+
+DSCError dsc_vector_parallel_sort(DSCVector *vector, DSCThreadPool *pool) {
+    if (vector == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_sort_parallel(vector->data.c_ptr, vector->size, vector->type, &vector->element,
+                      &vector->allocator, pool);
+
+    return DSC_ERROR_OK;
+}
+
+typedef struct {
+    const DSCVector *vector;
+    size_t chunks;
+    DSCVisitor visitor;
+    void *context;
+    atomic_bool stopped; // Set once a visitor returns false
+} DSCVectorParallelWalk;
+
+static void dsc_vector_parallel_visit(void *context, size_t index) {
+    DSCVectorParallelWalk *walk = context;
+    const DSCVector *vector = walk->vector;
+    size_t end = dsc_parallel_begin(vector->size, walk->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(vector->size, walk->chunks, index); i < end; ++i) {
+        if (atomic_load_explicit(&walk->stopped, memory_order_relaxed)) {
+            return;
+        }
+
+        if (!walk->visitor(dsc_element_view(dsc_vector_record(vector, i), vector->type),
+                           walk->context)) {
+            atomic_store_explicit(&walk->stopped, true, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+DSCError dsc_vector_parallel_for_each(const DSCVector *vector, DSCThreadPool *pool,
+                                      DSCVisitor visitor, void *context) {
+    if (vector == NULL || visitor == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCVectorParallelWalk walk = {vector, dsc_parallel_split(pool, vector->size), visitor,
+                                  context, false};
+
+    dsc_parallel_run(pool, dsc_vector_parallel_visit, &walk, walk.chunks);
+
+    return DSC_ERROR_OK;
+}
+
+typedef struct {
+    const DSCVector *vector;
+    size_t chunks;
+    DSCReducer reduce;
+    void *context;
+    unsigned char *partials; // One result per chunk
+    size_t size;
+} DSCVectorParallelReduce;
+
+static void dsc_vector_parallel_fold(void *context, size_t index) {
+    DSCVectorParallelReduce *fold = context;
+    const DSCVector *vector = fold->vector;
+    void *accumulator = fold->partials + index * fold->size;
+    size_t end = dsc_parallel_begin(vector->size, fold->chunks, index + 1);
+
+    for (size_t i = dsc_parallel_begin(vector->size, fold->chunks, index); i < end; ++i) {
+        fold->reduce(accumulator, dsc_element_view(dsc_vector_record(vector, i), vector->type),
+                     fold->context);
+    }
+}
+
+DSCError dsc_vector_parallel_reduce(const DSCVector *vector, DSCThreadPool *pool,
+                                    DSCReducer reduce, DSCCombiner combine, void *context,
+                                    void *result, size_t size) {
+    if (vector == NULL || reduce == NULL || combine == NULL || result == NULL || size == 0) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCVectorParallelReduce fold = {vector, dsc_parallel_split(pool, vector->size), reduce,
+                                    context, NULL, size};
+
+    // A single chunk folds straight into the result
+    if (fold.chunks == 1) {
+        fold.partials = result;
+        dsc_vector_parallel_fold(&fold, 0);
+        return DSC_ERROR_OK;
+    }
+
+    fold.partials = dsc_calloc(&vector->allocator, fold.chunks, size);
+    if (fold.partials == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < fold.chunks; ++i) {
+        memcpy(fold.partials + i * size, result, size);
+    }
+
+    dsc_parallel_run(pool, dsc_vector_parallel_fold, &fold, fold.chunks);
+
+    for (size_t i = 0; i < fold.chunks; ++i) {
+        combine(result, fold.partials + i * size, context);
+    }
+
+    dsc_free(&vector->allocator, fold.partials);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_vector_data(const DSCVector *vector, void **data) {
+    if (vector == NULL || data == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *data = vector->data.c_ptr;
+
+    return DSC_ERROR_OK;
+}
+
+/* Snapshots */
+
+static void dsc_vector_walk(const void *container, DSCSnapshotSink *sink) {
+    dsc_vector_for_each(container, dsc_snapshot_sink_element, sink);
+}
+
+DSCError dsc_vector_save(const DSCVector *vector, const char *path) {
+    if (vector == NULL || path == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCSnapshotLayout layout = {DSC_SNAPSHOT_SEQUENCE, vector->type, vector->element.size,
+                                DSC_TYPE_UNKNOWN, 0};
+
+    return dsc_snapshot_write(path, &layout, dsc_vector_walk, vector);
+}
+
+DSCError dsc_vector_stats(const DSCVector *vector, DSCStats *stats) {
+    if (vector == NULL || stats == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    dsc_stats_export(DSC_STATS_OF(vector), stats);
+
+    return DSC_ERROR_OK;
+}
@@ -0,0 +1,327 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_work_deque.h"
+
+/* Slots hold the raw bytes of one element, a string pointer at most, in an
+ * atomic word: a thief reads a slot before its compare-and-swap tells it
+ * whether the element is really its own, and may race the owner refilling
+ * the slot one lap later. */
+typedef _Atomic uint64_t DSCWorkSlot;
+
+typedef struct DSCWorkArray DSCWorkArray;
+
+struct DSCWorkArray {
+    DSCWorkArray *next; // The array this one replaced, kept for late thieves
+    size_t mask;        // capacity - 1
+    DSCWorkSlot slots[];
+};
+
+/* Positions grow without bound and are never reused; bottom - top is the
+ * size, and the owner's pop briefly takes bottom one below top when the
+ * deque is empty, hence the signed type. */
+struct DSCWorkDeque {
+    _Atomic(DSCWorkArray *) array; // The current slots, replaced by the owner
+    DSCType type;                  // The type of the elements in the deque
+    size_t size;                   // The byte size of one element
+    DSCAllocator allocator;        // Source of the deque and its arrays
+    char pad_config[DSC_CACHE_LINE];
+
+    _Atomic ptrdiff_t top; // Next position to steal, advanced by any thread
+    char pad_top[DSC_CACHE_LINE - sizeof(ptrdiff_t)];
+
+    _Atomic ptrdiff_t bottom; // Next position to push, written by the owner
+    char pad_bottom[DSC_CACHE_LINE - sizeof(ptrdiff_t)];
+};
+
+static inline DSCWorkSlot *dsc_work_deque_slot(DSCWorkArray *array, ptrdiff_t pos) {
+    return &array->slots[(size_t) pos & array->mask];
+}
+
+static DSCWorkArray *dsc_work_array_create(const DSCAllocator *allocator, size_t capacity) {
+    if (capacity > (SIZE_MAX - sizeof(DSCWorkArray)) / sizeof(DSCWorkSlot)) {
+        return NULL;
+    }
+
+    DSCWorkArray *array = dsc_alloc(allocator, sizeof(DSCWorkArray) +
+                                               capacity * sizeof(DSCWorkSlot));
+    if (array == NULL) {
+        return NULL;
+    }
+
+    array->next = NULL;
+    array->mask = capacity - 1;
+
+    return array;
+}
+
+/* Move the live positions into an array twice the size. Slots are copied to
+ * the same positions, so thieves reading either array see the same element. */
+static DSCWorkArray *dsc_work_deque_grow(DSCWorkDeque *deque, DSCWorkArray *array,
+                                         ptrdiff_t top, ptrdiff_t bottom) {
+    if (array->mask + 1 > SIZE_MAX / 2) {
+        return NULL;
+    }
+
+    DSCWorkArray *grown = dsc_work_array_create(&deque->allocator, (array->mask + 1) * 2);
+    if (grown == NULL) {
+        return NULL;
+    }
+
+    for (ptrdiff_t pos = top; pos < bottom; ++pos) {
+        uint64_t bits = atomic_load_explicit(dsc_work_deque_slot(array, pos),
+                                             memory_order_relaxed);
+        atomic_store_explicit(dsc_work_deque_slot(grown, pos), bits, memory_order_relaxed);
+    }
+
+    grown->next = array;
+    atomic_store_explicit(&deque->array, grown, memory_order_release);
+
+    return grown;
+}
+
+/* Hand the element whose bits a caller won over to its result pointer */
+static inline void dsc_work_deque_output(const DSCWorkDeque *deque, uint64_t bits,
+                                         void *result) {
+    memcpy(result, &bits, deque->size);
+}
+
+DSCError dsc_work_deque_init(DSCWorkDeque **deque, DSCType type, size_t capacity) {
+    return dsc_work_deque_init_allocator(deque, type, capacity, NULL);
+}
+
+DSCError dsc_work_deque_init_allocator(DSCWorkDeque **deque, DSCType type,
+                                       size_t capacity,
+                                       const DSCAllocator *allocator) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (dsc_type_invalid(type) || type == DSC_TYPE_BYTES) {
+        return DSC_ERROR_INVALID_TYPE;
+    }
+
+    if (capacity == 0) {
+        capacity = DSC_WORK_DEQUE_INITIAL_CAPACITY;
+    }
+
+    if (capacity > SIZE_MAX / 2) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    DSCWorkDeque *new_deque = dsc_alloc(allocator, sizeof(DSCWorkDeque));
+    if (new_deque == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    DSCWorkArray *array = dsc_work_array_create(allocator, rounded);
+    if (array == NULL) {
+        dsc_free(allocator, new_deque);
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    atomic_init(&new_deque->array, array);
+    new_deque->type = type;
+    new_deque->size = dsc_size_of(type);
+    new_deque->allocator = allocator != NULL ? *allocator : *dsc_allocator_default();
+    atomic_init(&new_deque->top, 0);
+    atomic_init(&new_deque->bottom, 0);
+
+    *deque = new_deque;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_deinit(DSCWorkDeque *deque) {
+    if (deque == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    DSCWorkArray *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+
+    if (deque->type == DSC_TYPE_STRING) {
+        ptrdiff_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+
+        for (ptrdiff_t pos = atomic_load_explicit(&deque->top, memory_order_acquire);
+             pos < bottom; ++pos) {
+            char *string;
+            dsc_work_deque_output(deque, atomic_load_explicit(dsc_work_deque_slot(array, pos),
+                                                              memory_order_relaxed),
+                                  &string);
+            free(string);
+        }
+    }
+
+    // Copy the allocator out: it lives inside the memory being released
+    DSCAllocator allocator = deque->allocator;
+
+    while (array != NULL) {
+        DSCWorkArray *next = array->next;
+        dsc_free(&allocator, array);
+        array = next;
+    }
+
+    dsc_free(&allocator, deque);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_capacity(const DSCWorkDeque *deque, size_t *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = atomic_load_explicit(&deque->array, memory_order_relaxed)->mask + 1;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_size(const DSCWorkDeque *deque, size_t *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    ptrdiff_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    ptrdiff_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    // A pop in progress may have taken bottom below top for a moment
+    *result = bottom > top ? (size_t) (bottom - top) : 0;
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_push(DSCWorkDeque *deque, void *value) {
+    if (deque == NULL || value == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t bits = 0;
+
+    if (deque->type == DSC_TYPE_STRING) {
+        char *copy = strdup(*(char **) value);
+        if (copy == NULL) {
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+
+        memcpy(&bits, &copy, sizeof(copy));
+    } else {
+        memcpy(&bits, value, deque->size);
+    }
+
+    ptrdiff_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    ptrdiff_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    DSCWorkArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if ((size_t) (bottom - top) > array->mask) {
+        array = dsc_work_deque_grow(deque, array, top, bottom);
+        if (array == NULL) {
+            if (deque->type == DSC_TYPE_STRING) {
+                char *copy;
+                dsc_work_deque_output(deque, bits, &copy);
+                free(copy);
+            }
+
+            return DSC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    atomic_store_explicit(dsc_work_deque_slot(array, bottom), bits, memory_order_relaxed);
+
+    // Publish the slot before the position that makes it stealable
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_pop(DSCWorkDeque *deque, void *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    ptrdiff_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    DSCWorkArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    // Reserve the bottom element before looking at top; the full fence orders
+    // this store against a thief's load of bottom after its load of top
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    ptrdiff_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty: put bottom back
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return DSC_ERROR_EMPTY_CONTAINER;
+    }
+
+    uint64_t bits = atomic_load_explicit(dsc_work_deque_slot(array, bottom),
+                                         memory_order_relaxed);
+
+    if (top == bottom) {
+        // The last element: whoever moves top past it wins it
+        bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                           memory_order_seq_cst,
+                                                           memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+        if (!won) {
+            return DSC_ERROR_EMPTY_CONTAINER;
+        }
+    }
+
+    dsc_work_deque_output(deque, bits, result);
+
+    return DSC_ERROR_OK;
+}
+
+DSCError dsc_work_deque_steal(DSCWorkDeque *deque, void *result) {
+    if (deque == NULL || result == NULL) {
+        return DSC_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (;;) {
+        ptrdiff_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        ptrdiff_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+        if (top >= bottom) {
+            return DSC_ERROR_EMPTY_CONTAINER;
+        }
+
+        // The array is loaded after bottom, so it holds the slot at top
+        DSCWorkArray *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+        uint64_t bits = atomic_load_explicit(dsc_work_deque_slot(array, top),
+                                             memory_order_relaxed);
+
+        if (atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                    memory_order_seq_cst,
+                                                    memory_order_relaxed)) {
+            dsc_work_deque_output(deque, bits, result);
+            return DSC_ERROR_OK;
+        }
+    }
+}
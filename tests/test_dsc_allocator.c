@@ -0,0 +1,309 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_allocator.h"
+#include "../include/dsc_list.h"
+#include "../include/dsc_map.h"
+#include "../include/dsc_queue.h"
+#include "../include/dsc_set.h"
+#include "../include/dsc_vector.h"
+
+void test_dsc_allocator_default(void) {
+    const DSCAllocator *allocator = dsc_allocator_default();
+    assert(dsc_allocator_frees(allocator));
+    assert(dsc_allocator_frees(NULL));
+
+    char *copy = dsc_strdup(NULL, "hello");
+    assert(copy != NULL && strcmp(copy, "hello") == 0);
+
+    // The default allocator hands strings over without copying
+    assert(dsc_allocator_export(allocator, copy) == copy);
+    free(copy);
+
+    assert(dsc_calloc(NULL, SIZE_MAX / 2, 4) == NULL);
+}
+
+void test_dsc_arena(void) {
+    DSCArena *arena;
+    assert(dsc_arena_init(NULL, 0) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_arena_init(&arena, 1024) == DSC_ERROR_OK);
+
+    DSCAllocator allocator;
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+    assert(!dsc_allocator_frees(&allocator));
+
+    // Allocations are aligned and do not overlap
+    char *a = dsc_alloc(&allocator, 3);
+    char *b = dsc_alloc(&allocator, 100);
+    assert(a != NULL && b != NULL);
+    assert((uintptr_t) b % sizeof(double) == 0);
+    assert(b >= a + 3);
+    memset(a, 'a', 3);
+    memset(b, 'b', 100);
+
+    // The most recent allocation grows in place, older ones are copied
+    assert(dsc_realloc(&allocator, b, 200) == b);
+    char *moved = dsc_realloc(&allocator, a, 50);
+    assert(moved != a && memcmp(moved, "aaa", 3) == 0);
+
+    // Larger than a block, and small requests still fit after it
+    char *big = dsc_alloc(&allocator, 10000);
+    assert(big != NULL);
+    memset(big, 0, 10000);
+    assert(dsc_alloc(&allocator, 16) != NULL);
+
+    // Strings exported from an arena are independent of it
+    char *string = dsc_strdup(&allocator, "arena");
+    char *exported = dsc_allocator_export(&allocator, string);
+    assert(exported != string && strcmp(exported, "arena") == 0);
+    free(exported);
+
+    assert(dsc_arena_reset(arena) == DSC_ERROR_OK);
+    assert(dsc_alloc(&allocator, 8) != NULL);
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+void test_dsc_pool(void) {
+    DSCPool *pool;
+    assert(dsc_pool_init(&pool, 0, 0) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_pool_init(&pool, 24, 4) == DSC_ERROR_OK);
+
+    // Objects come out in address order and span several slabs
+    void *objects[10];
+    for (int i = 0; i < 10; ++i) {
+        objects[i] = dsc_pool_alloc(pool);
+        assert(objects[i] != NULL);
+        memset(objects[i], i, 24);
+    }
+
+    assert((char *) objects[1] > (char *) objects[0]);
+
+    // A freed object is the next one handed out
+    dsc_pool_free(pool, objects[3]);
+    assert(dsc_pool_alloc(pool) == objects[3]);
+
+    DSCAllocator allocator;
+    assert(dsc_pool_allocator(pool, &allocator) == DSC_ERROR_OK);
+    assert(dsc_allocator_frees(&allocator));
+    assert(dsc_alloc(&allocator, 25) == NULL);
+
+    void *object = dsc_alloc(&allocator, 16);
+    assert(object != NULL);
+    assert(dsc_realloc(&allocator, object, 24) == object);
+    dsc_free(&allocator, object);
+
+    assert(dsc_pool_deinit(pool) == DSC_ERROR_OK);
+}
+
+void test_dsc_allocator_map_arena(void) {
+    static const DSCMapBackend backends[] = {
+        DSC_MAP_BACKEND_CHAINED,
+        DSC_MAP_BACKEND_OPEN,
+    };
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); ++b) {
+        DSCArena *arena;
+        assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+
+        DSCAllocator allocator;
+        assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+        DSCMap *map;
+        assert(dsc_map_init_allocator(&map, DSC_TYPE_STRING, DSC_TYPE_INT,
+                                      backends[b], &allocator) == DSC_ERROR_OK);
+
+        char key[16];
+        for (int i = 0; i < 1000; ++i) {
+            snprintf(key, sizeof(key), "key%d", i);
+            char *ptr = key;
+            assert(dsc_map_insert(map, &ptr, &i) == DSC_ERROR_OK);
+        }
+
+        char *ptr = "key500";
+        int value;
+        assert(dsc_map_get(map, &ptr, &value) == DSC_ERROR_OK);
+        assert(value == 500);
+        assert(dsc_map_erase(map, &ptr) == DSC_ERROR_OK);
+
+        // The whole map goes away with the arena, no deinit walk needed
+        assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_allocator_containers(void) {
+    DSCArena *arena;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+
+    DSCAllocator allocator;
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCVector *vector;
+    assert(dsc_vector_init_allocator(&vector, DSC_TYPE_STRING, &allocator) == DSC_ERROR_OK);
+
+    char text[16];
+    for (int i = 0; i < 100; ++i) {
+        snprintf(text, sizeof(text), "item%d", i);
+        assert(dsc_vector_push_back(vector, text) == DSC_ERROR_OK);
+    }
+
+    // Popped strings belong to the caller, whatever the vector allocates from
+    char *popped;
+    assert(dsc_vector_pop_back(vector, &popped) == DSC_ERROR_OK);
+    assert(strcmp(popped, "item99") == 0);
+    free(popped);
+
+    DSCQueue *queue;
+    assert(dsc_queue_init_allocator(&queue, DSC_TYPE_INT, &allocator) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_queue_push(queue, &i) == DSC_ERROR_OK);
+    }
+
+    int front;
+    assert(dsc_queue_pop(queue, &front) == DSC_ERROR_OK);
+    assert(front == 0);
+
+    DSCSet *set;
+    assert(dsc_set_init_allocator(&set, DSC_TYPE_INT, &allocator) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    // Deinit is still allowed and only skips the per-element frees
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+
+    // Lists carve their nodes from chunks of the allocator's memory
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCList *list = dsc_list_init_allocator(DSC_TYPE_STRING, &allocator);
+    assert(list != NULL);
+
+    for (int i = 0; i < 100; ++i) {
+        snprintf(text, sizeof(text), "node%d", i);
+        char *ptr = text;
+        assert(dsc_list_push_back(list, &ptr) == DSC_ERROR_OK);
+    }
+
+    char *back;
+    assert(dsc_list_pop_back(list, &back) == DSC_ERROR_OK);
+    assert(strcmp(back, "node99") == 0);
+    free(back);
+
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+void test_dsc_allocator_move(void) {
+    DSCArena *arena;
+    DSCAllocator allocator;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    // An arena cannot free malloc'd strings, so moving copies them in and
+    // frees the caller's
+    DSCVector *vector;
+    assert(dsc_vector_init_allocator(&vector, DSC_TYPE_STRING, &allocator) == DSC_ERROR_OK);
+    assert(dsc_vector_push_back_move(vector, strdup("adopted")) == DSC_ERROR_OK);
+
+    DSCMap *map;
+    assert(dsc_map_init_allocator(&map, DSC_TYPE_STRING, DSC_TYPE_STRING,
+                                  DSC_MAP_BACKEND_OPEN, &allocator) == DSC_ERROR_OK);
+    char *key = strdup("a key too long to be stored inline");
+    char *value = strdup("value");
+    assert(dsc_map_insert_move(map, &key, &value) == DSC_ERROR_OK);
+
+    // Containers on different allocators cannot swap
+    DSCVector *heap;
+    assert(dsc_vector_init(&heap, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_vector_swap(vector, heap) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_deinit(heap) == DSC_ERROR_OK);
+
+    assert(dsc_allocator_equal(NULL, dsc_allocator_default()));
+    assert(!dsc_allocator_equal(&allocator, NULL));
+
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+static void *exhaustible_alloc(void *context, size_t size) {
+    return *(bool *) context ? NULL : malloc(size);
+}
+
+static void *exhaustible_realloc(void *context, void *ptr, size_t size) {
+    return *(bool *) context ? NULL : realloc(ptr, size);
+}
+
+static void exhaustible_free(void *context, void *ptr) {
+    (void) context;
+    free(ptr);
+}
+
+void test_dsc_allocator_exhausted(void) {
+    bool exhausted = false;
+    DSCAllocator allocator = {exhaustible_alloc, exhaustible_realloc, exhaustible_free,
+                              &exhausted};
+
+    DSCVector *vector;
+    assert(dsc_vector_init_allocator(&vector, DSC_TYPE_STRING, &allocator) == DSC_ERROR_OK);
+    assert(dsc_vector_reserve(vector, 16) == DSC_ERROR_OK);
+
+    const char *words[] = {"a", "b", "c"};
+    for (size_t i = 0; i < 3; ++i) {
+        assert(dsc_vector_push_back(vector, (void *) words[i]) == DSC_ERROR_OK);
+    }
+
+    // A string that cannot be copied leaves the vector untouched
+    exhausted = true;
+    char *extra = "x";
+    assert(dsc_vector_insert(vector, &extra, 1) == DSC_ERROR_OUT_OF_MEMORY);
+    assert(dsc_vector_insert(vector, &extra, 0) == DSC_ERROR_OUT_OF_MEMORY);
+    assert(dsc_vector_push_back(vector, extra) == DSC_ERROR_OUT_OF_MEMORY);
+    assert(dsc_vector_append_range(vector, &extra, 1) == DSC_ERROR_OUT_OF_MEMORY);
+    exhausted = false;
+
+    size_t size;
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        DSCStringView view;
+        assert(dsc_vector_at_view(vector, i, &view) == DSC_ERROR_OK);
+        assert(strcmp(view.data, words[i]) == 0);
+    }
+
+    assert(dsc_vector_insert(vector, &extra, 1) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_allocator_default();
+    test_dsc_arena();
+    test_dsc_pool();
+    test_dsc_allocator_map_arena();
+    test_dsc_allocator_containers();
+    test_dsc_allocator_move();
+    test_dsc_allocator_exhausted();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,256 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_bitset.h"
+
+void test_dsc_bitset_init_deinit(void) {
+    DSCBitset *bitset;
+
+    assert(dsc_bitset_init(NULL, 10) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_bitset_init(&bitset, 0) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_bitset_size(bitset, &size) == DSC_ERROR_OK);
+    assert(size == 0);
+
+    size_t index;
+    assert(dsc_bitset_find_first(bitset, &index) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_bitset_set(bitset, 0) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_bitset_deinit(bitset) == DSC_ERROR_OK);
+
+    assert(dsc_bitset_init(&bitset, 1000) == DSC_ERROR_OK);
+
+    size_t count;
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 0);
+
+    assert(dsc_bitset_deinit(bitset) == DSC_ERROR_OK);
+}
+
+void test_dsc_bitset_bits(void) {
+    DSCBitset *bitset;
+    assert(dsc_bitset_init(&bitset, 200) == DSC_ERROR_OK);
+
+    assert(dsc_bitset_set(bitset, 0) == DSC_ERROR_OK);
+    assert(dsc_bitset_set(bitset, 63) == DSC_ERROR_OK);
+    assert(dsc_bitset_set(bitset, 64) == DSC_ERROR_OK);
+    assert(dsc_bitset_set(bitset, 199) == DSC_ERROR_OK);
+    assert(dsc_bitset_set(bitset, 200) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_bitset_flip(bitset, 5) == DSC_ERROR_OK);
+    assert(dsc_bitset_flip(bitset, 0) == DSC_ERROR_OK);
+    assert(dsc_bitset_reset(bitset, 63) == DSC_ERROR_OK);
+
+    bool bit;
+    assert(dsc_bitset_test(bitset, 0, &bit) == DSC_ERROR_OK && !bit);
+    assert(dsc_bitset_test(bitset, 5, &bit) == DSC_ERROR_OK && bit);
+    assert(dsc_bitset_test(bitset, 64, &bit) == DSC_ERROR_OK && bit);
+    assert(dsc_bitset_test(bitset, 200, &bit) == DSC_ERROR_OUT_OF_RANGE);
+
+    size_t count;
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 3);
+
+    // Walk the set bits in order
+    size_t expected[] = {5, 64, 199};
+    size_t index;
+    size_t found = 0;
+    for (size_t start = 0; dsc_bitset_find_next(bitset, start, &index) == DSC_ERROR_OK;
+         start = index + 1) {
+        assert(index == expected[found++]);
+    }
+    assert(found == 3);
+
+    size_t rank;
+    assert(dsc_bitset_rank(bitset, 5, &rank) == DSC_ERROR_OK && rank == 0);
+    assert(dsc_bitset_rank(bitset, 6, &rank) == DSC_ERROR_OK && rank == 1);
+    assert(dsc_bitset_rank(bitset, 128, &rank) == DSC_ERROR_OK && rank == 2);
+    assert(dsc_bitset_rank(bitset, 200, &rank) == DSC_ERROR_OK && rank == 3);
+    assert(dsc_bitset_rank(bitset, 201, &rank) == DSC_ERROR_OUT_OF_RANGE);
+
+    uint64_t word;
+    assert(dsc_bitset_word(bitset, 1, &word) == DSC_ERROR_OK);
+    assert(word == 1);
+
+    // Bits past the size are dropped
+    assert(dsc_bitset_set_word(bitset, 3, UINT64_MAX) == DSC_ERROR_OK);
+    assert(dsc_bitset_word(bitset, 3, &word) == DSC_ERROR_OK);
+    assert(word == 0xff);
+    assert(dsc_bitset_word(bitset, 4, &word) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_bitset_deinit(bitset) == DSC_ERROR_OK);
+}
+
+void test_dsc_bitset_ranges(void) {
+    DSCBitset *bitset;
+    assert(dsc_bitset_init(&bitset, 1000) == DSC_ERROR_OK);
+
+    assert(dsc_bitset_set_range(bitset, 10, 500, true) == DSC_ERROR_OK);
+    assert(dsc_bitset_set_range(bitset, 100, 10, false) == DSC_ERROR_OK);
+    assert(dsc_bitset_set_range(bitset, 990, 11, true) == DSC_ERROR_OUT_OF_RANGE);
+
+    size_t count;
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 490);
+
+    size_t index;
+    assert(dsc_bitset_find_first(bitset, &index) == DSC_ERROR_OK && index == 10);
+    assert(dsc_bitset_find_next(bitset, 100, &index) == DSC_ERROR_OK && index == 110);
+    assert(dsc_bitset_find_next(bitset, 510, &index) == DSC_ERROR_NOT_FOUND);
+
+    assert(dsc_bitset_fill(bitset, true) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 1000);
+
+    // Growing keeps the old bits and clears the new ones
+    assert(dsc_bitset_resize(bitset, 1500) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 1000);
+
+    assert(dsc_bitset_resize(bitset, 70) == DSC_ERROR_OK);
+    assert(dsc_bitset_resize(bitset, 140) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 70);
+
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_bitset_push_back(bitset, i % 2 == 0) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_bitset_size(bitset, &size) == DSC_ERROR_OK);
+    assert(size == 240);
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 120);
+
+    assert(dsc_bitset_deinit(bitset) == DSC_ERROR_OK);
+}
+
+void test_dsc_bitset_bitwise(void) {
+    enum { BITS = 100003 };
+    DSCBitset *a;
+    DSCBitset *b;
+    assert(dsc_bitset_init(&a, BITS) == DSC_ERROR_OK);
+    assert(dsc_bitset_init(&b, BITS) == DSC_ERROR_OK);
+
+    // Multiples of 2 and of 3
+    for (size_t i = 0; i < BITS; i += 2) {
+        assert(dsc_bitset_set(a, i) == DSC_ERROR_OK);
+    }
+    for (size_t i = 0; i < BITS; i += 3) {
+        assert(dsc_bitset_set(b, i) == DSC_ERROR_OK);
+    }
+
+    size_t evens = (BITS + 1) / 2;
+    size_t threes = (BITS + 2) / 3;
+    size_t sixes = (BITS + 5) / 6;
+
+    DSCBitset *c;
+    assert(dsc_bitset_init(&c, BITS) == DSC_ERROR_OK);
+    size_t count;
+
+    assert(dsc_bitset_or(c, a) == DSC_ERROR_OK);
+    assert(dsc_bitset_and(c, b) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(c, &count) == DSC_ERROR_OK);
+    assert(count == sixes);
+
+    assert(dsc_bitset_xor(c, a) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(c, &count) == DSC_ERROR_OK);
+    assert(count == evens - sixes);
+
+    assert(dsc_bitset_or(c, b) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(c, &count) == DSC_ERROR_OK);
+    assert(count == evens + threes - sixes);
+
+    assert(dsc_bitset_andnot(c, a) == DSC_ERROR_OK);
+    assert(dsc_bitset_count(c, &count) == DSC_ERROR_OK);
+    assert(count == threes - sixes);
+
+    size_t index;
+    assert(dsc_bitset_find_first(c, &index) == DSC_ERROR_OK && index == 3);
+
+    DSCBitset *small;
+    assert(dsc_bitset_init(&small, BITS - 1) == DSC_ERROR_OK);
+    assert(dsc_bitset_and(small, a) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_bitset_deinit(small) == DSC_ERROR_OK);
+    assert(dsc_bitset_deinit(c) == DSC_ERROR_OK);
+    assert(dsc_bitset_deinit(b) == DSC_ERROR_OK);
+    assert(dsc_bitset_deinit(a) == DSC_ERROR_OK);
+}
+
+void test_dsc_bitset_bools(void) {
+    bool values[150];
+    for (int i = 0; i < 150; ++i) {
+        values[i] = i % 7 == 0;
+    }
+
+    DSCBitset *bitset;
+    assert(dsc_bitset_init(&bitset, 3) == DSC_ERROR_OK);
+    assert(dsc_bitset_assign(bitset, values, 150) == DSC_ERROR_OK);
+
+    size_t count;
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 22);
+
+    bool unpacked[150];
+    assert(dsc_bitset_unpack(bitset, unpacked) == DSC_ERROR_OK);
+    assert(memcmp(values, unpacked, sizeof(values)) == 0);
+
+    const uint64_t *words;
+    assert(dsc_bitset_data(bitset, &words) == DSC_ERROR_OK);
+    assert((words[0] & 0xff) == 0x81);
+
+    assert(dsc_bitset_deinit(bitset) == DSC_ERROR_OK);
+}
+
+void test_dsc_bitset_allocator(void) {
+    DSCArena *arena;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+
+    DSCAllocator allocator;
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCBitset *bitset;
+    assert(dsc_bitset_init_allocator(&bitset, 10, &allocator) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 10000; ++i) {
+        assert(dsc_bitset_push_back(bitset, true) == DSC_ERROR_OK);
+    }
+
+    size_t count;
+    assert(dsc_bitset_count(bitset, &count) == DSC_ERROR_OK);
+    assert(count == 10000);
+
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_bitset_init_deinit();
+    test_dsc_bitset_bits();
+    test_dsc_bitset_ranges();
+    test_dsc_bitset_bitwise();
+    test_dsc_bitset_bools();
+    test_dsc_bitset_allocator();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
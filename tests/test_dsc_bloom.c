@@ -0,0 +1,209 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_bloom.h"
+#include "../include/dsc_set.h"
+
+void test_dsc_bloom_init_deinit(void) {
+    DSCBloomFilter *filter;
+
+    assert(dsc_bloom_init(NULL, DSC_TYPE_INT, 100, 0.01) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_bloom_init(&filter, DSC_TYPE_UNKNOWN, 100, 0.01) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_bloom_init(&filter, DSC_TYPE_INT, 100, 0.0) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_bloom_init(&filter, DSC_TYPE_INT, 100, 1.0) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_bloom_init(&filter, DSC_TYPE_INT, 0, 0.01) == DSC_ERROR_OK);
+
+    size_t bytes;
+    assert(dsc_bloom_bytes(filter, &bytes) == DSC_ERROR_OK);
+    assert(bytes == DSC_BLOOM_BLOCK_BYTES);
+
+    int key = 7;
+    bool result;
+    assert(dsc_bloom_contains(filter, &key, &result) == DSC_ERROR_OK);
+    assert(!result);
+
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+}
+
+void test_dsc_bloom_false_positives(void) {
+    enum { COUNT = 100000 };
+    DSCBloomFilter *filter;
+    assert(dsc_bloom_init(&filter, DSC_TYPE_INT, COUNT, 0.01) == DSC_ERROR_OK);
+
+    // Even keys go in, odd keys test the false-positive rate
+    int *keys = malloc(COUNT * sizeof(int));
+    assert(keys != NULL);
+    for (int i = 0; i < COUNT; ++i) {
+        keys[i] = 2 * i;
+    }
+
+    assert(dsc_bloom_insert_range(filter, keys, COUNT) == DSC_ERROR_OK);
+
+    // No false negatives
+    for (int i = 0; i < COUNT; ++i) {
+        bool result;
+        assert(dsc_bloom_contains(filter, &keys[i], &result) == DSC_ERROR_OK);
+        assert(result);
+    }
+
+    size_t positives = 0;
+    for (int i = 0; i < COUNT; ++i) {
+        int key = 2 * i + 1;
+        bool result;
+        assert(dsc_bloom_contains(filter, &key, &result) == DSC_ERROR_OK);
+        positives += result;
+    }
+    assert(positives < COUNT / 50);
+
+    size_t count;
+    assert(dsc_bloom_count(filter, &count) == DSC_ERROR_OK);
+    assert(count == COUNT);
+
+    assert(dsc_bloom_clear(filter) == DSC_ERROR_OK);
+    bool result;
+    assert(dsc_bloom_contains(filter, &keys[0], &result) == DSC_ERROR_OK);
+    assert(!result);
+
+    free(keys);
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+}
+
+void test_dsc_bloom_batch(void) {
+    DSCBloomFilter *filter;
+    assert(dsc_bloom_init(&filter, DSC_TYPE_DOUBLE, 1000, 0.001) == DSC_ERROR_OK);
+
+    double keys[100];
+    for (int i = 0; i < 100; ++i) {
+        keys[i] = i * 0.5;
+        if (i % 3 == 0) {
+            assert(dsc_bloom_insert(filter, &keys[i]) == DSC_ERROR_OK);
+        }
+    }
+
+    // Matches one query at a time, windows and the tail included
+    bool results[100];
+    assert(dsc_bloom_contains_batch(filter, keys, 100, results) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        bool single;
+        assert(dsc_bloom_contains(filter, &keys[i], &single) == DSC_ERROR_OK);
+        assert(results[i] == single);
+        if (i % 3 == 0) {
+            assert(results[i]);
+        }
+    }
+
+    // Zeros hash alike whatever their sign
+    double zero = -0.0;
+    bool result;
+    assert(dsc_bloom_contains(filter, &zero, &result) == DSC_ERROR_OK);
+    assert(result);
+
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+}
+
+void test_dsc_bloom_strings(void) {
+    DSCBloomFilter *filter;
+    assert(dsc_bloom_init(&filter, DSC_TYPE_STRING, 10, 0.01) == DSC_ERROR_OK);
+
+    char *words[] = {"alpha", "beta", "gamma"};
+    assert(dsc_bloom_insert_range(filter, words, 3) == DSC_ERROR_OK);
+
+    // Strings are hashed by content, not by address
+    char buffer[8];
+    strcpy(buffer, "beta");
+    char *key = buffer;
+    bool result;
+    assert(dsc_bloom_contains(filter, &key, &result) == DSC_ERROR_OK);
+    assert(result);
+
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+}
+
+void test_dsc_bloom_from_set(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char buffer[16];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(buffer, sizeof(buffer), "id-%d", i);
+        char *key = buffer;
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    DSCBloomFilter *filter;
+    assert(dsc_set_build_bloom(set, 0.01, &filter) == DSC_ERROR_OK);
+
+    size_t misses = 0;
+    for (int i = 0; i < 2000; ++i) {
+        snprintf(buffer, sizeof(buffer), "id-%d", i);
+        char *key = buffer;
+        bool maybe;
+        bool contains;
+        assert(dsc_bloom_contains(filter, &key, &maybe) == DSC_ERROR_OK);
+        assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+
+        // A filter never rules out an element of the set
+        assert(maybe || !contains);
+        misses += !maybe;
+    }
+    assert(misses > 950);
+
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    short shard;
+} Key;
+
+void test_dsc_bloom_bytes(void) {
+    DSCElementType element = {sizeof(Key), NULL, NULL, NULL, NULL};
+    DSCBloomFilter *filter;
+    assert(dsc_bloom_init_bytes(&filter, &element, 100, 0.01, NULL) == DSC_ERROR_OK);
+
+    Key key;
+    memset(&key, 0, sizeof(key));
+    key.id = 12;
+    key.shard = 3;
+    assert(dsc_bloom_insert(filter, &key) == DSC_ERROR_OK);
+
+    bool result;
+    assert(dsc_bloom_contains(filter, &key, &result) == DSC_ERROR_OK);
+    assert(result);
+
+    assert(dsc_bloom_deinit(filter) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_bloom_init_deinit();
+    test_dsc_bloom_false_positives();
+    test_dsc_bloom_batch();
+    test_dsc_bloom_strings();
+    test_dsc_bloom_from_set();
+    test_dsc_bloom_bytes();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,436 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_deque.h"
+
+void test_dsc_deque_init_deinit(void) {
+    DSCDeque *deque;
+
+    assert(dsc_deque_init(NULL, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_deque_init(&deque, DSC_TYPE_UNKNOWN) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_deque_init(&deque, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_deque_init(&deque, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    size_t capacity;
+    assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+    assert(capacity == DSC_DEQUE_INITIAL_CAPACITY);
+
+    int value;
+    assert(dsc_deque_pop_front(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_deque_pop_back(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_deque_front(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_deque_at(deque, 0, &value) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+
+    assert(dsc_deque_init(&deque, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_deque_both_ends(void) {
+    DSCDeque *deque;
+    assert(dsc_deque_init(&deque, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Mirror every operation in a plain array centred in a large buffer
+    static int model[4096];
+    size_t first = 2048;
+    size_t last = 2048;
+
+    unsigned int state = 12345;
+    for (int i = 0; i < 2000; ++i) {
+        state = state * 1103515245u + 12345u;
+        int value = (int) (state >> 16);
+
+        switch ((state >> 8) % 4) {
+            case 0:
+                assert(dsc_deque_push_front(deque, &value) == DSC_ERROR_OK);
+                model[--first] = value;
+                break;
+            case 1:
+                assert(dsc_deque_push_back(deque, &value) == DSC_ERROR_OK);
+                model[last++] = value;
+                break;
+            case 2:
+                if (first < last) {
+                    assert(dsc_deque_pop_front(deque, &value) == DSC_ERROR_OK);
+                    assert(value == model[first++]);
+                }
+                break;
+            default:
+                if (first < last) {
+                    assert(dsc_deque_pop_back(deque, &value) == DSC_ERROR_OK);
+                    assert(value == model[--last]);
+                }
+                break;
+        }
+    }
+
+    size_t size;
+    assert(dsc_deque_size(deque, &size) == DSC_ERROR_OK);
+    assert(size == last - first);
+
+    for (size_t i = 0; i < size; ++i) {
+        int value;
+        assert(dsc_deque_at(deque, i, &value) == DSC_ERROR_OK);
+        assert(value == model[first + i]);
+    }
+
+    int value;
+    assert(dsc_deque_at(deque, size, &value) == DSC_ERROR_OUT_OF_RANGE);
+
+    if (size > 0) {
+        assert(dsc_deque_front(deque, &value) == DSC_ERROR_OK && value == model[first]);
+        assert(dsc_deque_back(deque, &value) == DSC_ERROR_OK && value == model[last - 1]);
+    }
+
+    size_t capacity;
+    assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+    assert((capacity & (capacity - 1)) == 0);
+
+    assert(dsc_deque_clear(deque) == DSC_ERROR_OK);
+    bool empty;
+    assert(dsc_deque_empty(deque, &empty) == DSC_ERROR_OK && empty);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_deque_strings(void) {
+    DSCDeque *deque;
+    assert(dsc_deque_init(&deque, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *front = "front";
+    char *back = "back";
+    assert(dsc_deque_push_back(deque, &back) == DSC_ERROR_OK);
+    assert(dsc_deque_push_front(deque, &front) == DSC_ERROR_OK);
+
+    DSCStringView view;
+    assert(dsc_deque_at_view(deque, 1, &view) == DSC_ERROR_OK);
+    assert(view.length == 4 && memcmp(view.data, "back", 4) == 0);
+    assert(dsc_deque_at_view(deque, 2, &view) == DSC_ERROR_OUT_OF_RANGE);
+
+    char *result;
+    assert(dsc_deque_at(deque, 0, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "front") == 0);
+    free(result);
+
+    assert(dsc_deque_pop_back(deque, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "back") == 0);
+    free(result);
+
+    assert(dsc_deque_pop_front(deque, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "front") == 0);
+    free(result);
+
+    // Strings left in the deque are released on deinit
+    char *words[] = {"alpha", "beta", "gamma"};
+    assert(dsc_deque_push_front_range(deque, words, 3) == DSC_ERROR_OK);
+    assert(dsc_deque_push_back_range(deque, words, 3) == DSC_ERROR_OK);
+
+    char *popped[2];
+    assert(dsc_deque_pop_back_range(deque, popped, 2) == DSC_ERROR_OK);
+    assert(strcmp(popped[0], "beta") == 0 && strcmp(popped[1], "gamma") == 0);
+    free(popped[0]);
+    free(popped[1]);
+
+    assert(dsc_deque_pop_front_range(deque, popped, 2) == DSC_ERROR_OK);
+    assert(strcmp(popped[0], "alpha") == 0 && strcmp(popped[1], "beta") == 0);
+    free(popped[0]);
+    free(popped[1]);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+
+    int ints;
+    assert(dsc_deque_init(&deque, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_deque_push_back(deque, &(int) {1}) == DSC_ERROR_OK);
+    assert(dsc_deque_at_view(deque, 0, &view) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_deque_pop_back(deque, &ints) == DSC_ERROR_OK && ints == 1);
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_deque_ranges(void) {
+    DSCDeque *deque;
+    assert(dsc_deque_init(&deque, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    int values[100];
+    for (int i = 0; i < 100; ++i) {
+        values[i] = i;
+    }
+
+    // Start near the end of the ring so that every range wraps
+    for (int i = 0; i < 12; ++i) {
+        assert(dsc_deque_push_back(deque, &values[0]) == DSC_ERROR_OK);
+    }
+    int sink[100];
+    assert(dsc_deque_pop_front_range(deque, sink, 12) == DSC_ERROR_OK);
+
+    assert(dsc_deque_push_back_range(deque, values + 50, 10) == DSC_ERROR_OK);
+    assert(dsc_deque_push_front_range(deque, values + 40, 10) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 20; ++i) {
+        int value;
+        assert(dsc_deque_at(deque, (size_t) i, &value) == DSC_ERROR_OK);
+        assert(value == 40 + i);
+    }
+
+    // Grow once for a large range on either side
+    assert(dsc_deque_push_back_range(deque, values + 60, 40) == DSC_ERROR_OK);
+    assert(dsc_deque_push_front_range(deque, values, 40) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_deque_size(deque, &size) == DSC_ERROR_OK && size == 100);
+    assert(dsc_deque_pop_front_range(deque, sink, 101) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_deque_pop_back_range(deque, sink, 30) == DSC_ERROR_OK);
+    for (int i = 0; i < 30; ++i) {
+        assert(sink[i] == 70 + i);
+    }
+
+    assert(dsc_deque_pop_front_range(deque, sink, 70) == DSC_ERROR_OK);
+    for (int i = 0; i < 70; ++i) {
+        assert(sink[i] == i);
+    }
+
+    assert(dsc_deque_push_back_range(deque, values, 0) == DSC_ERROR_OK);
+    assert(dsc_deque_pop_back_range(deque, sink, 0) == DSC_ERROR_OK);
+    assert(dsc_deque_size(deque, &size) == DSC_ERROR_OK && size == 0);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_deque_growth(void) {
+    DSCDeque *deque;
+    assert(dsc_deque_init(&deque, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+    DSCGrowthPolicy policy = {1.5, DSC_GROWTH_SHRINK_RATIO, false};
+    assert(dsc_deque_set_growth(deque, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_deque_set_growth(deque, &policy) == DSC_ERROR_OK);
+
+    size_t capacity;
+    for (int i = 0; i < 1000; ++i) {
+        double value = i;
+        assert(dsc_deque_push_front(deque, &value) == DSC_ERROR_OK);
+
+        assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+        assert((capacity & (capacity - 1)) == 0);
+    }
+    assert(capacity == 1024);
+
+    double value;
+    for (int i = 0; i < 990; ++i) {
+        assert(dsc_deque_pop_back(deque, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    // Popping released memory, but never below the initial capacity
+    assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+    assert(capacity < 1024 && capacity >= DSC_DEQUE_INITIAL_CAPACITY);
+
+    assert(dsc_deque_reserve(deque, 100) == DSC_ERROR_OK);
+    assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK && capacity == 128);
+
+    assert(dsc_deque_shrink_to_fit(deque) == DSC_ERROR_OK);
+    assert(dsc_deque_capacity(deque, &capacity) == DSC_ERROR_OK && capacity == 16);
+
+    for (int i = 990; i < 1000; ++i) {
+        assert(dsc_deque_pop_back(deque, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_deque_bytes(void) {
+    DSCDeque *deque;
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+
+    assert(dsc_deque_init_bytes(&deque, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_deque_init_bytes(&deque, &named, NULL) == DSC_ERROR_OK);
+
+    Named batch[20];
+    for (int i = 0; i < 20; ++i) {
+        batch[i] = (Named) {i, "dennis"};
+    }
+
+    assert(dsc_deque_push_back_range(deque, batch, 20) == DSC_ERROR_OK);
+    assert(dsc_deque_push_front_range(deque, batch, 20) == DSC_ERROR_OK);
+    assert(named_live == 40);
+
+    Named out;
+    assert(dsc_deque_at(deque, 25, &out) == DSC_ERROR_OK && out.id == 5);
+    named_destroy(&out);
+
+    assert(dsc_deque_pop_back(deque, &out) == DSC_ERROR_OK && out.id == 19);
+    named_destroy(&out);
+
+    Named popped[3];
+    assert(dsc_deque_pop_front_range(deque, popped, 3) == DSC_ERROR_OK);
+    for (int i = 0; i < 3; ++i) {
+        assert(popped[i].id == i);
+        named_destroy(&popped[i]);
+    }
+    assert(named_live == 36);
+
+    assert(dsc_deque_clear(deque) == DSC_ERROR_OK);
+    assert(named_live == 0);
+
+    assert(dsc_deque_push_front(deque, &batch[7]) == DSC_ERROR_OK);
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+void test_dsc_deque_allocator(void) {
+    DSCArena *arena;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+
+    DSCAllocator allocator;
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCDeque *deque;
+    assert(dsc_deque_init_allocator(&deque, DSC_TYPE_STRING, &allocator) == DSC_ERROR_OK);
+
+    char *word = "arena";
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_deque_push_front(deque, &word) == DSC_ERROR_OK);
+    }
+
+    // A popped string is copied out of the arena for the caller
+    char *result;
+    assert(dsc_deque_pop_back(deque, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "arena") == 0);
+    free(result);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+static bool sum_ints(const void *element, void *context) {
+    *(long *) context += *(const int *) element;
+    return true;
+}
+
+void test_dsc_deque_cursor(void) {
+    DSCDeque *deque;
+    assert(dsc_deque_init(&deque, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Push the halves from opposite ends so that the elements wrap
+    for (int i = 5; i >= 0; --i) {
+        assert(dsc_deque_push_front(deque, &i) == DSC_ERROR_OK);
+    }
+    for (int i = 6; i < 12; ++i) {
+        assert(dsc_deque_push_back(deque, &i) == DSC_ERROR_OK);
+    }
+
+    DSCDequeCursor cursor;
+    const void *element;
+    assert(dsc_deque_cursor_init(deque, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 12; ++i) {
+        assert(dsc_deque_cursor_next(&cursor, &element));
+        assert(*(const int *) element == i);
+    }
+    assert(!dsc_deque_cursor_next(&cursor, &element));
+
+    long sum = 0;
+    assert(dsc_deque_for_each(deque, sum_ints, &sum) == DSC_ERROR_OK);
+    assert(sum == 66);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_deque_move_swap(void) {
+    DSCDeque *deque;
+    DSCDeque *other;
+    assert(dsc_deque_init(&deque, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_deque_init(&other, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *strings[40];
+    for (int i = 0; i < 40; ++i) {
+        strings[i] = malloc(16);
+        snprintf(strings[i], 16, "%d", i);
+        if (i % 2 == 0) {
+            assert(dsc_deque_push_back_move(deque, &strings[i]) == DSC_ERROR_OK);
+        } else {
+            assert(dsc_deque_push_front_move(deque, &strings[i]) == DSC_ERROR_OK);
+        }
+    }
+
+    char *extra = "extra";
+    assert(dsc_deque_push_back(other, &extra) == DSC_ERROR_OK);
+    assert(dsc_deque_swap(deque, other) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_deque_size(deque, &size) == DSC_ERROR_OK && size == 1);
+    assert(dsc_deque_size(other, &size) == DSC_ERROR_OK && size == 40);
+
+    char *result;
+    assert(dsc_deque_pop_front(other, &result) == DSC_ERROR_OK);
+    assert(result == strings[39]);
+    free(result);
+    assert(dsc_deque_pop_back(other, &result) == DSC_ERROR_OK);
+    assert(result == strings[38]);
+    free(result);
+
+    assert(dsc_deque_deinit(deque) == DSC_ERROR_OK);
+    assert(dsc_deque_deinit(other) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_deque_init_deinit();
+    test_dsc_deque_both_ends();
+    test_dsc_deque_strings();
+    test_dsc_deque_ranges();
+    test_dsc_deque_growth();
+    test_dsc_deque_bytes();
+    test_dsc_deque_allocator();
+    test_dsc_deque_cursor();
+    test_dsc_deque_move_swap();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -14,3 +14,417 @@
  * You should have received a copy of the GNU General Public License along with
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_list.h"
+
+void test_dsc_list_init_deinit(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+    assert(list != NULL);
+
+    bool empty;
+    assert(dsc_list_empty(list, &empty) == DSC_ERROR_OK);
+    assert(empty);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+    assert(dsc_list_deinit(NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_list_init(DSC_TYPE_UNKNOWN) == NULL);
+}
+
+void test_dsc_list_push_pop(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+
+    for (int i = 0; i < 10; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    int value = -1;
+    assert(dsc_list_push_front(list, &value) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK);
+    assert(size == 11);
+
+    assert(dsc_list_at(list, 5, &value) == DSC_ERROR_OK);
+    assert(value == 4);
+
+    assert(dsc_list_pop_front(list, &value) == DSC_ERROR_OK);
+    assert(value == -1);
+    assert(dsc_list_pop_back(list, &value) == DSC_ERROR_OK);
+    assert(value == 9);
+
+    // Popping down to empty and refilling keeps head and tail consistent
+    while (dsc_list_pop_back(list, &value) == DSC_ERROR_OK) {
+    }
+
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK);
+    assert(size == 0);
+
+    value = 7;
+    assert(dsc_list_push_back(list, &value) == DSC_ERROR_OK);
+    assert(dsc_list_front(list, &value) == DSC_ERROR_OK);
+    assert(value == 7);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+void test_dsc_list_insert_erase(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+
+    for (int i = 0; i < 5; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    int value = 42;
+    assert(dsc_list_insert(list, &value, 2) == DSC_ERROR_OK);
+    assert(dsc_list_at(list, 2, &value) == DSC_ERROR_OK);
+    assert(value == 42);
+
+    // Both ends and the middle can be erased
+    assert(dsc_list_erase(list, 0) == DSC_ERROR_OK);
+    assert(dsc_list_erase(list, 4) == DSC_ERROR_OK);
+    assert(dsc_list_erase(list, 1) == DSC_ERROR_OK);
+    assert(dsc_list_erase(list, 3) == DSC_ERROR_OUT_OF_RANGE);
+
+    int expected[] = {1, 2, 3};
+    for (size_t i = 0; i < 3; ++i) {
+        assert(dsc_list_at(list, i, &value) == DSC_ERROR_OK);
+        assert(value == expected[i]);
+    }
+
+    assert(dsc_list_back(list, &value) == DSC_ERROR_OK);
+    assert(value == 3);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+void test_dsc_list_strings(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_STRING);
+
+    char text[16];
+    for (int i = 0; i < 3; ++i) {
+        snprintf(text, sizeof(text), "str%d", i);
+        char *ptr = text;
+        assert(dsc_list_push_back(list, &ptr) == DSC_ERROR_OK);
+    }
+
+    char *value;
+    assert(dsc_list_at(list, 1, &value) == DSC_ERROR_OK);
+    assert(strcmp(value, "str1") == 0);
+    free(value);
+
+    DSCStringView view;
+    assert(dsc_list_front_view(list, &view) == DSC_ERROR_OK);
+    assert(view.length == 4 && memcmp(view.data, "str0", 4) == 0);
+    assert(dsc_list_back_view(list, &view) == DSC_ERROR_OK);
+    assert(view.length == 4 && memcmp(view.data, "str2", 4) == 0);
+    assert(dsc_list_at_view(list, 1, &view) == DSC_ERROR_OK);
+    assert(view.length == 4 && memcmp(view.data, "str1", 4) == 0);
+    assert(dsc_list_at_view(list, 3, &view) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_list_pop_front(list, &value) == DSC_ERROR_OK);
+    assert(strcmp(value, "str0") == 0);
+    free(value);
+
+    assert(dsc_list_pop_back(list, &value) == DSC_ERROR_OK);
+    assert(strcmp(value, "str2") == 0);
+    free(value);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+static void *counting_alloc(void *context, size_t size) {
+    ++*(size_t *) context;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *context, void *ptr, size_t size) {
+    ++*(size_t *) context;
+    return realloc(ptr, size);
+}
+
+static void counting_free(void *context, void *ptr) {
+    (void) context;
+    free(ptr);
+}
+
+void test_dsc_list_node_reuse(void) {
+    size_t allocations = 0;
+    DSCAllocator allocator = {counting_alloc, counting_realloc, counting_free, &allocations};
+
+    DSCList *list = dsc_list_init_allocator(DSC_TYPE_INT, &allocator);
+
+    // A steady-state queue pattern keeps recycling the same slots
+    for (int i = 0; i < DSC_LIST_CHUNK_MIN_NODES; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    size_t before = allocations;
+
+    for (int i = 0; i < 100000; ++i) {
+        int value;
+        assert(dsc_list_pop_front(list, &value) == DSC_ERROR_OK);
+        assert(value == i);
+
+        value = i + DSC_LIST_CHUNK_MIN_NODES;
+        assert(dsc_list_push_back(list, &value) == DSC_ERROR_OK);
+    }
+
+    assert(allocations == before);
+
+    // Many nodes spread over a growing run of chunks
+    for (int i = 0; i < 100000; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK);
+    assert(size == 100000 + DSC_LIST_CHUNK_MIN_NODES);
+
+    // One allocation per chunk rather than per node: about a hundred here
+    assert(allocations - before < 110);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    double position[3];
+} Particle;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_list_bytes(void) {
+    DSCElementType particle = {sizeof(Particle), NULL, NULL, NULL, NULL};
+
+    assert(dsc_list_init_bytes(NULL, NULL) == NULL);
+    assert(dsc_list_init(DSC_TYPE_BYTES) == NULL);
+
+    DSCList *list = dsc_list_init_bytes(&particle, NULL);
+    assert(list != NULL);
+
+    for (int i = 0; i < 300; ++i) {
+        Particle p = {i, {i * 0.25, 1.0, 2.0}};
+        assert(dsc_list_push_back(list, &p) == DSC_ERROR_OK);
+    }
+
+    Particle p = {-1, {0.0, 0.0, 0.0}};
+    assert(dsc_list_push_front(list, &p) == DSC_ERROR_OK);
+    assert(dsc_list_insert(list, &p, 150) == DSC_ERROR_OK);
+
+    assert(dsc_list_at(list, 150, &p) == DSC_ERROR_OK && p.id == -1);
+    assert(dsc_list_at(list, 151, &p) == DSC_ERROR_OK && p.id == 149);
+    assert(dsc_list_erase(list, 150) == DSC_ERROR_OK);
+
+    assert(dsc_list_pop_front(list, &p) == DSC_ERROR_OK && p.id == -1);
+    assert(dsc_list_back(list, &p) == DSC_ERROR_OK && p.id == 299);
+    assert(dsc_list_pop_back(list, &p) == DSC_ERROR_OK);
+    assert(p.id == 299 && p.position[0] == 299 * 0.25);
+    assert(dsc_list_front(list, &p) == DSC_ERROR_OK && p.id == 0);
+
+    size_t size;
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK && size == 299);
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+    list = dsc_list_init_bytes(&named, NULL);
+    assert(list != NULL);
+
+    for (int i = 0; i < 10; ++i) {
+        Named n = {i, "ken"};
+        assert(dsc_list_push_back(list, &n) == DSC_ERROR_OK);
+    }
+
+    Named out;
+    assert(dsc_list_at(list, 5, &out) == DSC_ERROR_OK && out.id == 5);
+    named_destroy(&out);
+
+    assert(dsc_list_pop_front(list, &out) == DSC_ERROR_OK && out.id == 0);
+    assert(named_live == 10);
+    named_destroy(&out);
+
+    assert(dsc_list_erase(list, 0) == DSC_ERROR_OK);
+    assert(named_live == 8);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+static bool sum_ints(const void *element, void *context) {
+    *(long *) context += *(const int *) element;
+    return true;
+}
+
+static bool stop_at_ten(const void *element, void *context) {
+    (*(int *) context)++;
+    return *(const int *) element < 10;
+}
+
+void test_dsc_list_cursor(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+    assert(list != NULL);
+
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    DSCListCursor cursor;
+    const void *element;
+    assert(dsc_list_cursor_init(list, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_list_cursor_next(&cursor, &element));
+        assert(*(const int *) element == i);
+    }
+    assert(!dsc_list_cursor_next(&cursor, &element));
+
+    long sum = 0;
+    assert(dsc_list_for_each(list, sum_ints, &sum) == DSC_ERROR_OK);
+    assert(sum == 4950);
+
+    int visited = 0;
+    assert(dsc_list_for_each(list, stop_at_ten, &visited) == DSC_ERROR_OK);
+    assert(visited == 11);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+
+    list = dsc_list_init(DSC_TYPE_STRING);
+    char *words[] = {"alpha", "beta", "gamma"};
+    for (size_t i = 0; i < 3; ++i) {
+        assert(dsc_list_push_back(list, &words[i]) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_list_cursor_init(list, &cursor) == DSC_ERROR_OK);
+    for (size_t i = 0; i < 3; ++i) {
+        assert(dsc_list_cursor_next(&cursor, &element));
+        assert(strcmp(element, words[i]) == 0);
+    }
+    assert(!dsc_list_cursor_next(&cursor, &element));
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+void test_dsc_list_move_swap(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_STRING);
+    DSCList *other = dsc_list_init(DSC_TYPE_STRING);
+    assert(list != NULL && other != NULL);
+
+    char *back = strdup("back");
+    char *front = strdup("front");
+    assert(dsc_list_push_back_move(list, &back) == DSC_ERROR_OK);
+    assert(dsc_list_push_front_move(list, &front) == DSC_ERROR_OK);
+
+    DSCStringView view;
+    assert(dsc_list_front_view(list, &view) == DSC_ERROR_OK);
+    assert(view.data == front);
+
+    assert(dsc_list_swap(list, other) == DSC_ERROR_OK);
+
+    bool empty;
+    assert(dsc_list_empty(list, &empty) == DSC_ERROR_OK && empty);
+
+    // The swapped nodes keep working with the other list's free slots
+    char *copy = "copy";
+    assert(dsc_list_push_back(other, &copy) == DSC_ERROR_OK);
+
+    char *result;
+    assert(dsc_list_pop_back(other, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "copy") == 0);
+    free(result);
+
+    assert(dsc_list_pop_back(other, &result) == DSC_ERROR_OK);
+    assert(result == back);
+    free(result);
+
+    assert(dsc_list_push_back(list, &copy) == DSC_ERROR_OK);
+
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+    assert(dsc_list_deinit(other) == DSC_ERROR_OK);
+}
+
+static bool is_multiple(const void *element, void *context) {
+    return *(const int *) element % *(const int *) context == 0;
+}
+
+void test_dsc_list_erase_if(void) {
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+    assert(list != NULL);
+
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+
+    // Multiples of three go, head and tail included
+    int divisor = 3;
+    size_t removed;
+    assert(dsc_list_erase_if(list, is_multiple, &divisor, &removed) == DSC_ERROR_OK);
+    assert(removed == 34);
+
+    size_t size;
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK && size == 66);
+
+    int value;
+    assert(dsc_list_front(list, &value) == DSC_ERROR_OK && value == 1);
+    assert(dsc_list_at(list, 2, &value) == DSC_ERROR_OK && value == 4);
+    assert(dsc_list_at(list, 65, &value) == DSC_ERROR_OK && value == 98);
+
+    // Only multiples of two stay
+    divisor = 2;
+    assert(dsc_list_retain(list, is_multiple, &divisor, &removed) == DSC_ERROR_OK);
+    assert(removed == 33);
+    assert(dsc_list_front(list, &value) == DSC_ERROR_OK && value == 2);
+
+    // The released nodes are reused
+    for (int i = 0; i < 10; ++i) {
+        assert(dsc_list_push_front(list, &i) == DSC_ERROR_OK);
+    }
+    assert(dsc_list_size(list, &size) == DSC_ERROR_OK && size == 43);
+
+    assert(dsc_list_erase_if(list, NULL, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    dsc_list_deinit(list);
+}
+
+int main(void) {
+    test_dsc_list_init_deinit();
+    test_dsc_list_push_pop();
+    test_dsc_list_insert_erase();
+    test_dsc_list_strings();
+    test_dsc_list_node_reuse();
+    test_dsc_list_bytes();
+    test_dsc_list_cursor();
+    test_dsc_list_move_swap();
+    test_dsc_list_erase_if();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
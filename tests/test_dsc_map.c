@@ -14,3 +14,848 @@
  * You should have received a copy of the GNU General Public License along with
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_map.h"
+
+static const DSCMapBackend backends[] = {
+    DSC_MAP_BACKEND_CHAINED,
+    DSC_MAP_BACKEND_OPEN,
+    DSC_MAP_BACKEND_SHARDED,
+};
+
+#define BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
+
+#define SHARDED_ITEMS 20000
+#define SHARDED_THREADS 4
+
+void test_dsc_map_init_deinit(void) {
+    DSCMap *map;
+
+    assert(dsc_map_init(NULL, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_map_init(&map, DSC_TYPE_UNKNOWN, DSC_TYPE_INT) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_DOUBLE, backends[b]) == DSC_ERROR_OK);
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_insert_get(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 1000; ++i) {
+            int value = i * i;
+            assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+        }
+
+        int key = 7;
+        int value = 0;
+        assert(dsc_map_insert(map, &key, &value) == DSC_ERROR_ALREADY_EXISTS);
+
+        for (int i = 0; i < 1000; ++i) {
+            assert(dsc_map_get(map, &i, &value) == DSC_ERROR_OK);
+            assert(value == i * i);
+        }
+
+        key = 1000;
+        assert(dsc_map_get(map, &key, &value) == DSC_ERROR_NOT_FOUND);
+
+        size_t size;
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK);
+        assert(size == 1000);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_erase(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 1000; ++i) {
+            assert(dsc_map_insert(map, &i, &i) == DSC_ERROR_OK);
+        }
+
+        for (int i = 0; i < 1000; i += 2) {
+            assert(dsc_map_erase(map, &i) == DSC_ERROR_OK);
+        }
+
+        bool contains;
+        for (int i = 0; i < 1000; ++i) {
+            assert(dsc_map_contains(map, &i, &contains) == DSC_ERROR_OK);
+            assert(contains == (i % 2 == 1));
+        }
+
+        int key = 0;
+        assert(dsc_map_erase(map, &key) == DSC_ERROR_NOT_FOUND);
+
+        assert(dsc_map_clear(map) == DSC_ERROR_OK);
+        assert(dsc_map_empty(map, &contains) == DSC_ERROR_OK);
+        assert(contains == true);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_strings(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+
+        char *key = "Hello";
+        char *value = "world!";
+        assert(dsc_map_insert(map, &key, &value) == DSC_ERROR_OK);
+
+        char buffer[] = "Hello";
+        char *lookup = buffer;
+        char *result;
+        assert(dsc_map_get(map, &lookup, &result) == DSC_ERROR_OK);
+        assert(strcmp(result, value) == 0);
+        free(result);
+
+        assert(dsc_map_erase(map, &lookup) == DSC_ERROR_OK);
+        assert(dsc_map_get(map, &lookup, &result) == DSC_ERROR_NOT_FOUND);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_incremental_rehash(void) {
+    DSCMap *map;
+    assert(dsc_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_map_incremental_rehash(map, true) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+    assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, DSC_MAP_BACKEND_OPEN) == DSC_ERROR_OK);
+    assert(dsc_map_incremental_rehash(map, true) == DSC_ERROR_OK);
+
+    int value;
+    for (int i = 0; i < 10000; ++i) {
+        value = -i;
+        assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+
+        // Every key stays reachable while old slots are still being drained
+        int probe = i / 2;
+        assert(dsc_map_get(map, &probe, &value) == DSC_ERROR_OK);
+        assert(value == -probe);
+    }
+
+    for (int i = 0; i < 10000; i += 3) {
+        assert(dsc_map_erase(map, &i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_map_incremental_rehash(map, false) == DSC_ERROR_OK);
+
+    bool contains;
+    for (int i = 0; i < 10000; ++i) {
+        assert(dsc_map_contains(map, &i, &contains) == DSC_ERROR_OK);
+        assert(contains == (i % 3 != 0));
+    }
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_map_batch(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_DOUBLE, backends[b]) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 500; ++i) {
+            double value = i * 0.25;
+            assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+        }
+
+        // Every other key is missing, and the count is not a multiple of the window
+        int keys[333];
+        double values[333];
+        DSCError results[333];
+        bool contains[333];
+        for (int i = 0; i < 333; ++i) {
+            keys[i] = i * 2 - 100;
+            values[i] = -1.0;
+        }
+
+        assert(dsc_map_get_batch(map, keys, 333, values, results) == DSC_ERROR_OK);
+        assert(dsc_map_contains_batch(map, keys, 333, contains) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 333; ++i) {
+            bool present = keys[i] >= 0 && keys[i] < 500;
+            assert(contains[i] == present);
+            assert(results[i] == (present ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND));
+            assert(values[i] == (present ? keys[i] * 0.25 : -1.0));
+        }
+
+        assert(dsc_map_get_batch(NULL, keys, 333, values, results) == DSC_ERROR_INVALID_ARGUMENT);
+        assert(dsc_map_contains_batch(map, keys, 333, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+
+        char *key = "key";
+        char *value = "value";
+        assert(dsc_map_insert(map, &key, &value) == DSC_ERROR_OK);
+
+        char *lookups[] = {"missing", "key"};
+        char *outputs[2] = {NULL, NULL};
+        assert(dsc_map_get_batch(map, lookups, 2, outputs, results) == DSC_ERROR_OK);
+        assert(results[0] == DSC_ERROR_NOT_FOUND && outputs[0] == NULL);
+        assert(results[1] == DSC_ERROR_OK && strcmp(outputs[1], "value") == 0);
+        free(outputs[1]);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_reserve_insert_range(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        size_t capacity;
+        size_t reserved;
+
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+        assert(dsc_map_reserve(map, 5000) == DSC_ERROR_OK);
+        assert(dsc_map_capacity(map, &reserved) == DSC_ERROR_OK);
+        assert(reserved > 5000);
+
+        int keys[5000];
+        int values[5000];
+        for (int i = 0; i < 5000; ++i) {
+            keys[i] = i;
+            values[i] = 3 * i;
+        }
+
+        // The reservation covers the whole range, so no rehash happens
+        assert(dsc_map_insert_range(map, keys, values, 5000) == DSC_ERROR_OK);
+        assert(dsc_map_capacity(map, &capacity) == DSC_ERROR_OK);
+        assert(capacity == reserved);
+
+        // Keys already present are skipped and keep their value
+        values[0] = -1;
+        assert(dsc_map_insert_range(map, keys, values, 1) == DSC_ERROR_OK);
+
+        size_t size;
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK);
+        assert(size == 5000);
+
+        int value;
+        for (int i = 0; i < 5000; ++i) {
+            assert(dsc_map_get(map, &i, &value) == DSC_ERROR_OK);
+            assert(value == 3 * i);
+        }
+
+        assert(dsc_map_reserve(map, 16) == DSC_ERROR_OK);
+        assert(dsc_map_capacity(map, &capacity) == DSC_ERROR_OK);
+        assert(capacity == reserved);
+
+        assert(dsc_map_reserve(NULL, 16) == DSC_ERROR_INVALID_ARGUMENT);
+        assert(dsc_map_insert_range(map, NULL, values, 1) == DSC_ERROR_INVALID_ARGUMENT);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+void test_dsc_map_short_long_keys(void) {
+    DSCMap *map;
+    assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_INT, DSC_MAP_BACKEND_OPEN) == DSC_ERROR_OK);
+
+    // Lengths on both sides of the inline limit
+    char keys[40][40];
+    for (int i = 0; i < 40; ++i) {
+        memset(keys[i], 'a' + i % 26, (size_t) i);
+        keys[i][i] = '\0';
+
+        char *key = keys[i];
+        assert(dsc_map_insert(map, &key, &i) == DSC_ERROR_OK);
+    }
+
+    for (int i = 0; i < 40; ++i) {
+        char buffer[40];
+        strcpy(buffer, keys[i]);
+
+        char *key = buffer;
+        int value;
+        assert(dsc_map_get(map, &key, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    // A key differing only past the inline buffer
+    char lookup[40];
+    strcpy(lookup, keys[30]);
+    lookup[29] = 'z';
+    char *key = lookup;
+    int value;
+    assert(dsc_map_get(map, &key, &value) == DSC_ERROR_NOT_FOUND);
+
+    for (int i = 0; i < 40; i += 2) {
+        key = keys[i];
+        assert(dsc_map_erase(map, &key) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_map_size(map, &size) == DSC_ERROR_OK);
+    assert(size == 20);
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_map_string_pool(void) {
+    DSCStringPool *pool;
+    assert(dsc_string_pool_init(&pool, NULL) == DSC_ERROR_OK);
+
+    const char *first;
+    const char *second;
+    assert(dsc_string_pool_intern(pool, "a rather long string key", 24, &first) == DSC_ERROR_OK);
+
+    char buffer[] = "a rather long string key";
+    assert(dsc_string_pool_intern(pool, buffer, strlen(buffer), &second) == DSC_ERROR_OK);
+    assert(first == second);
+
+    size_t size;
+    assert(dsc_string_pool_size(pool, &size) == DSC_ERROR_OK);
+    assert(size == 1);
+
+    DSCMap *chained;
+    assert(dsc_map_init_backend(&chained, DSC_TYPE_STRING, DSC_TYPE_INT, DSC_MAP_BACKEND_CHAINED) == DSC_ERROR_OK);
+    assert(dsc_map_use_string_pool(chained, pool) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_map_deinit(chained) == DSC_ERROR_OK);
+
+    DSCMap *lhs;
+    DSCMap *rhs;
+    assert(dsc_map_init_backend(&lhs, DSC_TYPE_STRING, DSC_TYPE_INT, DSC_MAP_BACKEND_OPEN) == DSC_ERROR_OK);
+    assert(dsc_map_init_backend(&rhs, DSC_TYPE_STRING, DSC_TYPE_INT, DSC_MAP_BACKEND_OPEN) == DSC_ERROR_OK);
+    assert(dsc_map_use_string_pool(lhs, pool) == DSC_ERROR_OK);
+    assert(dsc_map_use_string_pool(rhs, pool) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        char key_buffer[64];
+        snprintf(key_buffer, sizeof(key_buffer), "shared long key number %d", i);
+
+        char *key = key_buffer;
+        assert(dsc_map_insert(lhs, &key, &i) == DSC_ERROR_OK);
+        assert(dsc_map_insert(rhs, &key, &i) == DSC_ERROR_OK);
+    }
+
+    // Both maps share one copy of every key
+    assert(dsc_string_pool_size(pool, &size) == DSC_ERROR_OK);
+    assert(size == 101);
+
+    const char *interned;
+    assert(dsc_string_pool_intern(pool, "shared long key number 42", 25, &interned) == DSC_ERROR_OK);
+    assert(dsc_string_pool_size(pool, &size) == DSC_ERROR_OK);
+    assert(size == 101);
+
+    int value;
+    assert(dsc_map_get(lhs, &interned, &value) == DSC_ERROR_OK);
+    assert(value == 42);
+
+    assert(dsc_map_erase(lhs, &interned) == DSC_ERROR_OK);
+    assert(dsc_map_get(rhs, &interned, &value) == DSC_ERROR_OK);
+    assert(value == 42);
+
+    // Pools can only be attached to empty maps
+    assert(dsc_map_use_string_pool(rhs, pool) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_map_deinit(lhs) == DSC_ERROR_OK);
+    assert(dsc_map_deinit(rhs) == DSC_ERROR_OK);
+    assert(dsc_string_pool_deinit(pool) == DSC_ERROR_OK);
+}
+
+void test_dsc_map_get_view(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+
+        int key = 1;
+        char *value = "borrowed";
+        assert(dsc_map_insert(map, &key, &value) == DSC_ERROR_OK);
+
+        DSCStringView view;
+        assert(dsc_map_get_view(map, &key, &view) == DSC_ERROR_OK);
+        assert(view.length == 8);
+        assert(memcmp(view.data, "borrowed", 8) == 0);
+
+        // The view points into the map, not at the caller's string
+        assert(view.data != value);
+
+        key = 2;
+        assert(dsc_map_get_view(map, &key, &view) == DSC_ERROR_NOT_FOUND);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+
+    DSCMap *map;
+    assert(dsc_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    int key = 1;
+    DSCStringView view;
+    assert(dsc_map_insert(map, &key, &key) == DSC_ERROR_OK);
+    assert(dsc_map_get_view(map, &key, &view) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_map_bytes(void) {
+    DSCMap *map;
+    DSCElementType point = {sizeof(Point), NULL, NULL, NULL, NULL};
+
+    assert(dsc_map_init(&map, DSC_TYPE_BYTES, DSC_TYPE_INT) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_map_init_bytes(&map, DSC_TYPE_BYTES, NULL, DSC_TYPE_INT, NULL, NULL) ==
+           DSC_ERROR_INVALID_ARGUMENT);
+
+    // Record keys, primitive values
+    assert(dsc_map_init_bytes(&map, DSC_TYPE_BYTES, &point, DSC_TYPE_INT, NULL, NULL) ==
+           DSC_ERROR_OK);
+
+    Point keys[500];
+    int values[500];
+    for (int i = 0; i < 500; ++i) {
+        keys[i] = (Point) {i, i * 7};
+        values[i] = i * i;
+    }
+
+    assert(dsc_map_insert_range(map, keys, values, 500) == DSC_ERROR_OK);
+
+    int value;
+    Point key = {20, 140};
+    assert(dsc_map_get(map, &key, &value) == DSC_ERROR_OK && value == 400);
+    assert(dsc_map_erase(map, &key) == DSC_ERROR_OK);
+    assert(dsc_map_get(map, &key, &value) == DSC_ERROR_NOT_FOUND);
+
+    int batch[3] = {0};
+    DSCError results[3];
+    Point probes[3] = {{3, 21}, {20, 140}, {499, 3493}};
+    assert(dsc_map_get_batch(map, probes, 3, batch, results) == DSC_ERROR_OK);
+    assert(results[0] == DSC_ERROR_OK && batch[0] == 9);
+    assert(results[1] == DSC_ERROR_NOT_FOUND);
+    assert(results[2] == DSC_ERROR_OK && batch[2] == 499 * 499);
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+    // Primitive keys, record values that own memory
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+    assert(dsc_map_init_bytes(&map, DSC_TYPE_INT, NULL, DSC_TYPE_BYTES, &named, NULL) ==
+           DSC_ERROR_OK);
+    assert(dsc_map_incremental_rehash(map, true) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 200; ++i) {
+        Named n = {i, "margaret"};
+        assert(dsc_map_insert(map, &i, &n) == DSC_ERROR_OK);
+    }
+    assert(named_live == 200);
+
+    Named out;
+    int id = 123;
+    assert(dsc_map_get(map, &id, &out) == DSC_ERROR_OK);
+    assert(out.id == 123 && strcmp(out.name, "margaret") == 0);
+    named_destroy(&out);
+
+    assert(dsc_map_erase(map, &id) == DSC_ERROR_OK);
+    assert(named_live == 199);
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+static bool sum_entries(const void *key, const void *value, void *context) {
+    long *sums = context;
+    sums[0] += *(const int *) key;
+    sums[1] += *(const double *) value;
+    return true;
+}
+
+static bool stop_after_five(const void *key, const void *value, void *context) {
+    (void) key;
+    (void) value;
+    return ++*(int *) context < 5;
+}
+
+void test_dsc_map_cursor(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_DOUBLE, backends[b]) == DSC_ERROR_OK);
+
+        for (int key = 0; key < 1000; ++key) {
+            double value = key * 2;
+            assert(dsc_map_insert(map, &key, &value) == DSC_ERROR_OK);
+        }
+
+        // Every entry comes up exactly once, its value next to it
+        unsigned char seen[1000] = {0};
+        DSCMapCursor cursor;
+        const void *key;
+        const void *value;
+        assert(dsc_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+        while (dsc_map_cursor_next(&cursor, &key, &value)) {
+            int k = *(const int *) key;
+            assert(*(const double *) value == k * 2);
+            seen[k]++;
+        }
+
+        for (int k = 0; k < 1000; ++k) {
+            assert(seen[k] == 1);
+        }
+
+        long sums[2] = {0, 0};
+        assert(dsc_map_for_each(map, sum_entries, sums) == DSC_ERROR_OK);
+        assert(sums[0] == 499500 && sums[1] == 999000);
+
+        int visited = 0;
+        assert(dsc_map_for_each(map, stop_after_five, &visited) == DSC_ERROR_OK);
+        assert(visited == 5);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+        // String keys and values are yielded as their characters
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+        char *short_key = "key";
+        char *long_key = "a key too long to be stored inline";
+        char *name = "value";
+        assert(dsc_map_insert(map, &short_key, &name) == DSC_ERROR_OK);
+        assert(dsc_map_insert(map, &long_key, &name) == DSC_ERROR_OK);
+
+        int found = 0;
+        assert(dsc_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+        while (dsc_map_cursor_next(&cursor, &key, NULL)) {
+            assert(strcmp(key, short_key) == 0 || strcmp(key, long_key) == 0);
+            found++;
+        }
+        assert(found == 2);
+
+        assert(dsc_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+        assert(dsc_map_cursor_next(&cursor, &key, &value));
+        assert(strcmp(value, "value") == 0);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+}
+
+typedef struct ShardedWorker {
+    DSCMap *map;
+    int first; // The first key this thread owns
+} ShardedWorker;
+
+static void *sharded_writer(void *arg) {
+    ShardedWorker *worker = arg;
+
+    for (int key = worker->first; key < worker->first + SHARDED_ITEMS; ++key) {
+        int value = key * 2;
+        assert(dsc_map_insert(worker->map, &key, &value) == DSC_ERROR_OK);
+    }
+
+    // Every other key goes again, while the neighbours are still writing
+    for (int key = worker->first; key < worker->first + SHARDED_ITEMS; key += 2) {
+        assert(dsc_map_erase(worker->map, &key) == DSC_ERROR_OK);
+    }
+
+    return NULL;
+}
+
+static void *sharded_reader(void *arg) {
+    ShardedWorker *worker = arg;
+
+    // Keys of the other threads: either absent yet or holding their value
+    for (int key = 0; key < SHARDED_ITEMS * SHARDED_THREADS; ++key) {
+        int value;
+        DSCError error = dsc_map_get(worker->map, &key, &value);
+        assert(error == DSC_ERROR_NOT_FOUND || (error == DSC_ERROR_OK && value == key * 2));
+    }
+
+    return NULL;
+}
+
+void test_dsc_map_sharded(void) {
+    DSCMap *map;
+
+    assert(dsc_map_init_sharded(NULL, DSC_TYPE_INT, DSC_TYPE_INT, 0, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_map_init_sharded(&map, DSC_TYPE_BYTES, DSC_TYPE_INT, 0, NULL) == DSC_ERROR_INVALID_TYPE);
+
+    // A single shard behaves like a locked open map
+    assert(dsc_map_init_sharded(&map, DSC_TYPE_STRING, DSC_TYPE_INT, 1, NULL) == DSC_ERROR_OK);
+    char *alpha = "alpha";
+    int one = 1;
+    assert(dsc_map_insert(map, &alpha, &one) == DSC_ERROR_OK);
+    assert(dsc_map_insert(map, &alpha, &one) == DSC_ERROR_ALREADY_EXISTS);
+
+    // The pool is not thread-safe, so sharded maps refuse it
+    DSCStringPool *pool;
+    assert(dsc_string_pool_init(&pool, NULL) == DSC_ERROR_OK);
+    assert(dsc_map_use_string_pool(map, pool) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_string_pool_deinit(pool) == DSC_ERROR_OK);
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+
+    // Shard counts round up to a power of two
+    assert(dsc_map_init_sharded(&map, DSC_TYPE_INT, DSC_TYPE_INT, 5, NULL) == DSC_ERROR_OK);
+
+    pthread_t threads[SHARDED_THREADS * 2];
+    ShardedWorker workers[SHARDED_THREADS];
+
+    for (int t = 0; t < SHARDED_THREADS; ++t) {
+        workers[t].map = map;
+        workers[t].first = t * SHARDED_ITEMS;
+        assert(pthread_create(&threads[t], NULL, sharded_writer, &workers[t]) == 0);
+        assert(pthread_create(&threads[SHARDED_THREADS + t], NULL, sharded_reader, &workers[t]) == 0);
+    }
+
+    for (int t = 0; t < SHARDED_THREADS * 2; ++t) {
+        assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+    size_t size;
+    assert(dsc_map_size(map, &size) == DSC_ERROR_OK);
+    assert(size == SHARDED_ITEMS * SHARDED_THREADS / 2);
+
+    for (int key = 0; key < SHARDED_ITEMS * SHARDED_THREADS; ++key) {
+        bool contains;
+        assert(dsc_map_contains(map, &key, &contains) == DSC_ERROR_OK);
+        assert(contains == (key % 2 == 1));
+    }
+
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_map_move_swap(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        DSCMap *other;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+        assert(dsc_map_init_backend(&other, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 200; ++i) {
+            char *key = malloc(64);
+            char *value = malloc(16);
+            snprintf(key, 64, i % 2 ? "k%d" : "a key too long to be stored inline %d", i);
+            snprintf(value, 16, "v%d", i);
+            assert(dsc_map_insert_move(map, &key, &value) == DSC_ERROR_OK);
+        }
+
+        char *key = strdup("k1");
+        char *value = strdup("again");
+        assert(dsc_map_insert_move(map, &key, &value) == DSC_ERROR_ALREADY_EXISTS);
+        free(key);
+        free(value);
+
+        assert(dsc_map_swap(map, other) == DSC_ERROR_OK);
+
+        size_t size;
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 0);
+        assert(dsc_map_size(other, &size) == DSC_ERROR_OK && size == 200);
+
+        char *lookup = "a key too long to be stored inline 42";
+        char *result;
+        assert(dsc_map_get(other, &lookup, &result) == DSC_ERROR_OK);
+        assert(strcmp(result, "v42") == 0);
+        free(result);
+
+        // Both maps keep working after the swap
+        char *fresh = "fresh";
+        assert(dsc_map_insert(map, &fresh, &fresh) == DSC_ERROR_OK);
+        assert(dsc_map_erase(other, &lookup) == DSC_ERROR_OK);
+
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+        assert(dsc_map_deinit(other) == DSC_ERROR_OK);
+    }
+
+    // Swapping needs matching backends
+    DSCMap *open;
+    DSCMap *chained;
+    assert(dsc_map_init_backend(&open, DSC_TYPE_INT, DSC_TYPE_INT, DSC_MAP_BACKEND_OPEN) == DSC_ERROR_OK);
+    assert(dsc_map_init_backend(&chained, DSC_TYPE_INT, DSC_TYPE_INT, DSC_MAP_BACKEND_CHAINED) == DSC_ERROR_OK);
+    assert(dsc_map_swap(open, chained) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_map_deinit(open) == DSC_ERROR_OK);
+    assert(dsc_map_deinit(chained) == DSC_ERROR_OK);
+}
+
+static bool value_below(const void *key, const void *value, void *context) {
+    (void) key;
+    return *(const int *) value < *(const int *) context;
+}
+
+static bool digit_below(const void *key, const void *value, void *context) {
+    (void) key;
+    return *(const char *) value < *(const char *) context;
+}
+
+void test_dsc_map_erase_if(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+
+        for (int i = 0; i < 4000; ++i) {
+            int value = i * 2;
+            assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+        }
+
+        size_t before;
+        assert(dsc_map_capacity(map, &before) == DSC_ERROR_OK);
+
+        int limit = 7800;
+        size_t removed;
+        assert(dsc_map_erase_if(map, value_below, &limit, &removed) == DSC_ERROR_OK);
+        assert(removed == 3900);
+
+        size_t size;
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 100);
+
+        size_t after;
+        assert(dsc_map_capacity(map, &after) == DSC_ERROR_OK);
+        assert(after < before);
+
+        for (int i = 0; i < 4000; ++i) {
+            int value;
+            DSCError error = dsc_map_get(map, &i, &value);
+            assert(error == (i >= 3900 ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND));
+        }
+
+        limit = 7900;
+        assert(dsc_map_retain(map, value_below, &limit, &removed) == DSC_ERROR_OK);
+        assert(removed == 50);
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 50);
+
+        assert(dsc_map_erase_if(map, NULL, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+        dsc_map_deinit(map);
+    }
+
+    // String keys and values are released with their entries
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_STRING, DSC_TYPE_STRING, backends[b]) == DSC_ERROR_OK);
+
+        char key[64];
+        char value[16];
+        for (int i = 0; i < 200; ++i) {
+            snprintf(key, sizeof(key), i % 2 ? "k%d" : "a key too long to be stored inline %d", i);
+            snprintf(value, sizeof(value), "%d", i % 10);
+            char *k = key;
+            char *v = value;
+            assert(dsc_map_insert(map, &k, &v) == DSC_ERROR_OK);
+        }
+
+        char limit = '5';
+        size_t removed;
+        assert(dsc_map_erase_if(map, digit_below, &limit, &removed) == DSC_ERROR_OK);
+        assert(removed == 100);
+
+        size_t size;
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 100);
+
+        char *k = "k9";
+        char *v = NULL;
+        assert(dsc_map_get(map, &k, &v) == DSC_ERROR_OK);
+        assert(strcmp(v, "9") == 0);
+        free(v);
+
+        dsc_map_deinit(map);
+    }
+}
+
+void test_dsc_map_erase_if_during_resize(void) {
+    for (size_t b = 0; b < BACKEND_COUNT; ++b) {
+        if (backends[b] == DSC_MAP_BACKEND_CHAINED) {
+            continue;
+        }
+
+        // 450 entries leave an incremental resize partly done
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+        assert(dsc_map_incremental_rehash(map, true) == DSC_ERROR_OK);
+        for (int i = 0; i < 450; ++i) {
+            int value = i * 2;
+            assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+        }
+
+        int limit = 450;
+        size_t removed;
+        size_t size;
+        assert(dsc_map_retain(map, value_below, &limit, &removed) == DSC_ERROR_OK);
+        assert(removed == 225);
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 225);
+
+        for (int i = 0; i < 450; ++i) {
+            int value;
+            DSCError error = dsc_map_get(map, &i, &value);
+            assert(error == (i < 225 ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND));
+        }
+        dsc_map_deinit(map);
+
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) == DSC_ERROR_OK);
+        assert(dsc_map_incremental_rehash(map, true) == DSC_ERROR_OK);
+        for (int i = 0; i < 450; ++i) {
+            assert(dsc_map_insert(map, &i, &i) == DSC_ERROR_OK);
+        }
+
+        limit = 450;
+        assert(dsc_map_erase_if(map, value_below, &limit, &removed) == DSC_ERROR_OK);
+        assert(removed == 450);
+        assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == 0);
+        dsc_map_deinit(map);
+    }
+}
+
+int main(void) {
+    test_dsc_map_init_deinit();
+    test_dsc_map_insert_get();
+    test_dsc_map_erase();
+    test_dsc_map_strings();
+    test_dsc_map_incremental_rehash();
+    test_dsc_map_batch();
+    test_dsc_map_reserve_insert_range();
+    test_dsc_map_short_long_keys();
+    test_dsc_map_string_pool();
+    test_dsc_map_get_view();
+    test_dsc_map_bytes();
+    test_dsc_map_cursor();
+    test_dsc_map_sharded();
+    test_dsc_map_move_swap();
+    test_dsc_map_erase_if();
+    test_dsc_map_erase_if_during_resize();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,466 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_ordered_map.h"
+
+void test_dsc_ordered_map_init_deinit(void) {
+    DSCOrderedMap *map;
+
+    assert(dsc_ordered_map_init(NULL, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_UNKNOWN, DSC_TYPE_INT) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_INT, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_INT, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+    bool empty;
+    assert(dsc_ordered_map_empty(map, &empty) == DSC_ERROR_OK);
+    assert(empty);
+
+    int key = 1;
+    double value;
+    assert(dsc_ordered_map_get(map, &key, &value) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_ordered_map_erase(map, &key) == DSC_ERROR_NOT_FOUND);
+
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+    assert(dsc_ordered_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+    assert(!dsc_ordered_map_cursor_next(&cursor, &k, &v));
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_map_random(void) {
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Mirror every operation in a presence table indexed by key
+    enum { KEYS = 3000 };
+    static bool present[KEYS];
+    size_t count = 0;
+
+    unsigned int state = 4242;
+    for (int i = 0; i < 40000; ++i) {
+        state = state * 1103515245u + 12345u;
+        int key = (int) ((state >> 8) % KEYS);
+        int value = key * 7;
+
+        // Insert more often than erase at first, then drain
+        bool insert = (state >> 24) % 4 < (i < 20000 ? 3u : 1u);
+
+        if (insert) {
+            DSCError error = dsc_ordered_map_insert(map, &key, &value);
+            assert(error == (present[key] ? DSC_ERROR_ALREADY_EXISTS : DSC_ERROR_OK));
+            count += !present[key];
+            present[key] = true;
+        } else {
+            DSCError error = dsc_ordered_map_erase(map, &key);
+            assert(error == (present[key] ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND));
+            count -= present[key];
+            present[key] = false;
+        }
+
+        if (i % 5000 == 0 || i == 39999) {
+            size_t size;
+            assert(dsc_ordered_map_size(map, &size) == DSC_ERROR_OK);
+            assert(size == count);
+
+            DSCOrderedMapCursor cursor;
+            const void *k;
+            const void *v;
+            int expected = 0;
+
+            assert(dsc_ordered_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+            while (dsc_ordered_map_cursor_next(&cursor, &k, &v)) {
+                while (!present[expected]) {
+                    expected++;
+                }
+
+                assert(*(const int *) k == expected);
+                assert(*(const int *) v == expected * 7);
+                expected++;
+            }
+
+            while (expected < KEYS) {
+                assert(!present[expected++]);
+            }
+        }
+    }
+
+    for (int key = 0; key < KEYS; ++key) {
+        bool contains;
+        assert(dsc_ordered_map_contains(map, &key, &contains) == DSC_ERROR_OK);
+        assert(contains == present[key]);
+
+        if (present[key]) {
+            assert(dsc_ordered_map_erase(map, &key) == DSC_ERROR_OK);
+        }
+    }
+
+    bool empty;
+    assert(dsc_ordered_map_empty(map, &empty) == DSC_ERROR_OK);
+    assert(empty);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+static bool sum_range(const void *key, const void *value, void *context) {
+    (void) value;
+    *(long *) context += *(const int *) key;
+    return true;
+}
+
+static bool stop_after_three(const void *key, const void *value, void *context) {
+    (void) key;
+    (void) value;
+    return ++*(int *) context < 3;
+}
+
+void test_dsc_ordered_map_bounds(void) {
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Even keys 0 to 998
+    for (int i = 0; i < 500; ++i) {
+        int key = 2 * i;
+        assert(dsc_ordered_map_insert(map, &key, &i) == DSC_ERROR_OK);
+    }
+
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+
+    int key = 101;
+    assert(dsc_ordered_map_lower_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(*(const int *) k == 102);
+
+    key = 100;
+    assert(dsc_ordered_map_lower_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(*(const int *) k == 100);
+    assert(*(const int *) v == 50);
+
+    assert(dsc_ordered_map_upper_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(*(const int *) k == 102);
+
+    key = 998;
+    assert(dsc_ordered_map_upper_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(!dsc_ordered_map_cursor_next(&cursor, &k, &v));
+
+    key = -5;
+    assert(dsc_ordered_map_lower_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(*(const int *) k == 0);
+
+    // [100, 200) holds 100, 102, ..., 198
+    int low = 100;
+    int high = 200;
+    long sum = 0;
+    assert(dsc_ordered_map_range(map, &low, &high, sum_range, &sum) == DSC_ERROR_OK);
+    assert(sum == 50 * (100 + 198) / 2);
+
+    sum = 0;
+    assert(dsc_ordered_map_range(map, NULL, &high, sum_range, &sum) == DSC_ERROR_OK);
+    assert(sum == 100 * 198 / 2);
+
+    sum = 0;
+    assert(dsc_ordered_map_range(map, &high, NULL, sum_range, &sum) == DSC_ERROR_OK);
+    assert(sum == 400 * (200 + 998) / 2);
+
+    sum = 0;
+    assert(dsc_ordered_map_range(map, &high, &low, sum_range, &sum) == DSC_ERROR_OK);
+    assert(sum == 0);
+
+    int visited = 0;
+    assert(dsc_ordered_map_for_each(map, stop_after_three, &visited) == DSC_ERROR_OK);
+    assert(visited == 3);
+
+    assert(dsc_ordered_map_range(NULL, NULL, NULL, sum_range, &sum) ==
+           DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_ordered_map_lower_bound(map, NULL, &cursor) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_map_strings(void) {
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_STRING, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    const char *words[] = {"pear", "apple", "fig", "banana", "cherry", "date", "grape"};
+    const char *sorted[] = {"apple", "banana", "cherry", "date", "fig", "grape", "pear"};
+
+    for (int i = 0; i < 7; ++i) {
+        char *key = (char *) words[i];
+        char *value = (char *) words[(i + 1) % 7];
+        assert(dsc_ordered_map_insert(map, &key, &value) == DSC_ERROR_OK);
+    }
+
+    char *key = "fig";
+    char *value;
+    assert(dsc_ordered_map_get(map, &key, &value) == DSC_ERROR_OK);
+    assert(strcmp(value, "banana") == 0);
+    free(value);
+
+    DSCStringView view;
+    assert(dsc_ordered_map_get_view(map, &key, &view) == DSC_ERROR_OK);
+    assert(strcmp(view.data, "banana") == 0 && view.length == 6);
+
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+    assert(dsc_ordered_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 7; ++i) {
+        assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+        assert(strcmp(k, sorted[i]) == 0);
+    }
+    assert(!dsc_ordered_map_cursor_next(&cursor, &k, &v));
+
+    key = "c";
+    assert(dsc_ordered_map_lower_bound(map, &key, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(strcmp(k, "cherry") == 0);
+
+    key = "banana";
+    assert(dsc_ordered_map_erase(map, &key) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_clear(map) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_ordered_map_size(map, &size) == DSC_ERROR_OK);
+    assert(size == 0);
+
+    // The tree is usable again after a clear
+    assert(dsc_ordered_map_insert(map, &key, &key) == DSC_ERROR_OK);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_map_doubles(void) {
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_DOUBLE, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    double keys[] = {3.5, NAN, -1.0, 0.25, INFINITY};
+    for (int i = 0; i < 5; ++i) {
+        assert(dsc_ordered_map_insert(map, &keys[i], &i) == DSC_ERROR_OK);
+    }
+
+    // NaNs are equal to each other
+    double nan = NAN;
+    int value = 9;
+    assert(dsc_ordered_map_insert(map, &nan, &value) == DSC_ERROR_ALREADY_EXISTS);
+
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+    double expected[] = {-1.0, 0.25, 3.5, INFINITY};
+
+    assert(dsc_ordered_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 4; ++i) {
+        assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+        assert(*(const double *) k == expected[i]);
+    }
+
+    // NaN sorts last
+    assert(dsc_ordered_map_cursor_next(&cursor, &k, &v));
+    assert(isnan(*(const double *) k));
+    assert(*(const int *) v == 1);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_map_load_sorted(void) {
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_INT, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    enum { COUNT = 100000 };
+    int *keys = malloc(COUNT * sizeof(int));
+    int *values = malloc(COUNT * sizeof(int));
+    assert(keys != NULL && values != NULL);
+
+    for (int i = 0; i < COUNT; ++i) {
+        keys[i] = 3 * i;
+        values[i] = -i;
+    }
+
+    int unsorted[] = {1, 3, 2};
+    assert(dsc_ordered_map_load_sorted(map, unsorted, values, 3) == DSC_ERROR_INVALID_ARGUMENT);
+
+    int duplicates[] = {1, 1};
+    assert(dsc_ordered_map_load_sorted(map, duplicates, values, 2) ==
+           DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_ordered_map_load_sorted(map, keys, values, COUNT) == DSC_ERROR_OK);
+    assert(dsc_ordered_map_load_sorted(map, keys, values, 1) == DSC_ERROR_INVALID_ARGUMENT);
+
+    size_t size;
+    assert(dsc_ordered_map_size(map, &size) == DSC_ERROR_OK);
+    assert(size == COUNT);
+
+    for (int i = 0; i < COUNT; i += 97) {
+        int key = 3 * i;
+        int value;
+        assert(dsc_ordered_map_get(map, &key, &value) == DSC_ERROR_OK);
+        assert(value == -i);
+
+        key++;
+        assert(dsc_ordered_map_get(map, &key, &value) == DSC_ERROR_NOT_FOUND);
+    }
+
+    // The bulk-loaded tree takes regular updates
+    for (int i = 0; i < COUNT; i += 2) {
+        int key = 3 * i;
+        assert(dsc_ordered_map_erase(map, &key) == DSC_ERROR_OK);
+        key++;
+        assert(dsc_ordered_map_insert(map, &key, &i) == DSC_ERROR_OK);
+    }
+
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+    int previous = -1;
+    size_t walked = 0;
+
+    assert(dsc_ordered_map_cursor_init(map, &cursor) == DSC_ERROR_OK);
+    while (dsc_ordered_map_cursor_next(&cursor, &k, &v)) {
+        assert(*(const int *) k > previous);
+        previous = *(const int *) k;
+        walked++;
+    }
+    assert(walked == COUNT);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+
+    // String keys are copied
+    assert(dsc_ordered_map_init(&map, DSC_TYPE_STRING, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    char *words[] = {"alpha", "beta", "gamma"};
+    assert(dsc_ordered_map_load_sorted(map, words, values, 3) == DSC_ERROR_OK);
+
+    char *key = "gamma";
+    int value;
+    assert(dsc_ordered_map_get(map, &key, &value) == DSC_ERROR_OK);
+    assert(value == -2);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+
+    free(keys);
+    free(values);
+}
+
+typedef struct {
+    long timestamp;
+    int series;
+} Point;
+
+static int compare_points(const void *lhs, const void *rhs) {
+    const Point *a = lhs;
+    const Point *b = rhs;
+
+    if (a->series != b->series) {
+        return a->series < b->series ? -1 : 1;
+    }
+
+    return (a->timestamp > b->timestamp) - (a->timestamp < b->timestamp);
+}
+
+void test_dsc_ordered_map_bytes(void) {
+    DSCElementType element = {sizeof(Point), NULL, compare_points, NULL, NULL};
+    DSCOrderedMap *map;
+
+    assert(dsc_ordered_map_init_bytes(&map, DSC_TYPE_BYTES, &element, DSC_TYPE_DOUBLE, NULL,
+                                      NULL) == DSC_ERROR_OK);
+
+    for (int series = 0; series < 3; ++series) {
+        for (long t = 0; t < 100; ++t) {
+            Point point = {t * 10, series};
+            double reading = series * 1000.0 + (double) t;
+            assert(dsc_ordered_map_insert(map, &point, &reading) == DSC_ERROR_OK);
+        }
+    }
+
+    // Every reading of series 1 between t=200 and t=300
+    Point low = {200, 1};
+    Point high = {300, 1};
+    DSCOrderedMapCursor cursor;
+    const void *k;
+    const void *v;
+    int seen = 0;
+
+    assert(dsc_ordered_map_lower_bound(map, &low, &cursor) == DSC_ERROR_OK);
+    while (dsc_ordered_map_cursor_next(&cursor, &k, &v) && compare_points(k, &high) < 0) {
+        assert(((const Point *) k)->series == 1);
+        assert(*(const double *) v == 1000.0 + 20 + seen);
+        seen++;
+    }
+    assert(seen == 10);
+
+    assert(dsc_ordered_map_deinit(map) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_map_allocator(void) {
+    DSCArena *arena;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+
+    DSCAllocator allocator;
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCOrderedMap *map;
+    assert(dsc_ordered_map_init_allocator(&map, DSC_TYPE_STRING, DSC_TYPE_INT, &allocator) ==
+           DSC_ERROR_OK);
+
+    char buffer[16];
+    for (int i = 0; i < 2000; ++i) {
+        snprintf(buffer, sizeof(buffer), "key%05d", i);
+        char *key = buffer;
+        assert(dsc_ordered_map_insert(map, &key, &i) == DSC_ERROR_OK);
+    }
+
+    for (int i = 0; i < 2000; i += 3) {
+        snprintf(buffer, sizeof(buffer), "key%05d", i);
+        char *key = buffer;
+        assert(dsc_ordered_map_erase(map, &key) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_ordered_map_size(map, &size) == DSC_ERROR_OK);
+    assert(size == 1333);
+
+    // The arena takes the whole map down at once
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_ordered_map_init_deinit();
+    test_dsc_ordered_map_random();
+    test_dsc_ordered_map_bounds();
+    test_dsc_ordered_map_strings();
+    test_dsc_ordered_map_doubles();
+    test_dsc_ordered_map_load_sorted();
+    test_dsc_ordered_map_bytes();
+    test_dsc_ordered_map_allocator();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_ordered_set.h"
+
+void test_dsc_ordered_set_init_deinit(void) {
+    DSCOrderedSet *set;
+
+    assert(dsc_ordered_set_init(NULL, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_ordered_set_init(&set, DSC_TYPE_UNKNOWN) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_ordered_set_init(&set, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_ordered_set_init_bytes(&set, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_ordered_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    bool empty;
+    assert(dsc_ordered_set_empty(set, &empty) == DSC_ERROR_OK);
+    assert(empty);
+
+    assert(dsc_ordered_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_ordered_set_order(void) {
+    DSCOrderedSet *set;
+    assert(dsc_ordered_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Insert 0..4999 in a scrambled order
+    for (int i = 0; i < 5000; ++i) {
+        int value = (i * 2621) % 5000;
+        assert(dsc_ordered_set_insert(set, &value) == DSC_ERROR_OK);
+    }
+
+    int value = 42;
+    assert(dsc_ordered_set_insert(set, &value) == DSC_ERROR_ALREADY_EXISTS);
+
+    for (int i = 0; i < 5000; i += 2) {
+        assert(dsc_ordered_set_erase(set, &i) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_ordered_set_size(set, &size) == DSC_ERROR_OK);
+    assert(size == 2500);
+
+    DSCOrderedSetCursor cursor;
+    const void *element;
+    assert(dsc_ordered_set_cursor_init(set, &cursor) == DSC_ERROR_OK);
+    for (int i = 1; i < 5000; i += 2) {
+        assert(dsc_ordered_set_cursor_next(&cursor, &element));
+        assert(*(const int *) element == i);
+    }
+    assert(!dsc_ordered_set_cursor_next(&cursor, &element));
+
+    value = 100;
+    assert(dsc_ordered_set_lower_bound(set, &value, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_set_cursor_next(&cursor, &element));
+    assert(*(const int *) element == 101);
+
+    value = 101;
+    assert(dsc_ordered_set_upper_bound(set, &value, &cursor) == DSC_ERROR_OK);
+    assert(dsc_ordered_set_cursor_next(&cursor, &element));
+    assert(*(const int *) element == 103);
+
+    bool contains;
+    assert(dsc_ordered_set_contains(set, &value, &contains) == DSC_ERROR_OK);
+    assert(contains);
+
+    assert(dsc_ordered_set_deinit(set) == DSC_ERROR_OK);
+}
+
+static bool count_elements(const void *element, void *context) {
+    (void) element;
+    ++*(int *) context;
+    return true;
+}
+
+void test_dsc_ordered_set_range(void) {
+    DSCOrderedSet *set;
+    assert(dsc_ordered_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *words[] = {"ant", "bee", "cat", "dog", "eel", "fox"};
+    assert(dsc_ordered_set_load_sorted(set, words, 6) == DSC_ERROR_OK);
+
+    char *low = "b";
+    char *high = "e";
+    int count = 0;
+    assert(dsc_ordered_set_range(set, &low, &high, count_elements, &count) == DSC_ERROR_OK);
+    assert(count == 3);
+
+    count = 0;
+    assert(dsc_ordered_set_for_each(set, count_elements, &count) == DSC_ERROR_OK);
+    assert(count == 6);
+
+    char *unsorted[] = {"b", "a"};
+    assert(dsc_ordered_set_clear(set) == DSC_ERROR_OK);
+    assert(dsc_ordered_set_load_sorted(set, unsorted, 2) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_ordered_set_deinit(set) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_ordered_set_init_deinit();
+    test_dsc_ordered_set_order();
+    test_dsc_ordered_set_range();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,303 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_priority_queue.h"
+
+static int compare_ints(const void *lhs, const void *rhs) {
+    int a = *(const int *) lhs;
+    int b = *(const int *) rhs;
+    return (a > b) - (a < b);
+}
+
+void test_dsc_priority_queue_init_deinit(void) {
+    DSCPriorityQueue *queue;
+
+    assert(dsc_priority_queue_init(NULL, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_UNKNOWN) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    int value;
+    assert(dsc_priority_queue_top(queue, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_priority_queue_get(queue, 0, &value) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_priority_queue_push_pop(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    static int expected[5000];
+    unsigned int state = 2024;
+    for (int i = 0; i < 5000; ++i) {
+        state = state * 1103515245u + 12345u;
+        expected[i] = (int) (state >> 8) % 1000;
+        assert(dsc_priority_queue_push(queue, &expected[i], NULL) == DSC_ERROR_OK);
+    }
+
+    qsort(expected, 5000, sizeof(int), compare_ints);
+
+    int value;
+    assert(dsc_priority_queue_top(queue, &value) == DSC_ERROR_OK && value == expected[0]);
+
+    for (int i = 0; i < 5000; ++i) {
+        assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK);
+        assert(value == expected[i]);
+    }
+
+    bool empty;
+    assert(dsc_priority_queue_empty(queue, &empty) == DSC_ERROR_OK && empty);
+
+    // The order reverses only while the queue is empty
+    assert(dsc_priority_queue_set_max_first(queue, true) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_priority_queue_push(queue, &i, NULL) == DSC_ERROR_OK);
+    }
+    assert(dsc_priority_queue_set_max_first(queue, false) == DSC_ERROR_INVALID_ARGUMENT);
+
+    for (int i = 99; i >= 0; --i) {
+        assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK && value == i);
+    }
+
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_priority_queue_ranges(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+    // Filling an empty queue heapifies the array in one pass
+    static double values[1000];
+    for (int i = 0; i < 1000; ++i) {
+        values[i] = (i * 7919) % 1000;
+    }
+    assert(dsc_priority_queue_push_range(queue, values, 1000, NULL) == DSC_ERROR_OK);
+
+    // A small batch is sifted in element by element
+    double extra[3] = {-1.0, 500.5, 2000.0};
+    assert(dsc_priority_queue_push_range(queue, extra, 3, NULL) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_priority_queue_size(queue, &size) == DSC_ERROR_OK && size == 1003);
+
+    static double popped[1003];
+    assert(dsc_priority_queue_pop_range(queue, popped, 1004) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_priority_queue_pop_range(queue, popped, 10) == DSC_ERROR_OK);
+    assert(popped[0] == -1.0);
+    for (int i = 1; i < 10; ++i) {
+        assert(popped[i] == i - 1);
+    }
+
+    assert(dsc_priority_queue_pop_range(queue, popped, 993) == DSC_ERROR_OK);
+    for (int i = 1; i < 993; ++i) {
+        assert(popped[i - 1] <= popped[i]);
+    }
+    assert(popped[992] == 2000.0);
+
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_priority_queue_handles(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    DSCPriorityHandle handles[50];
+    int values[50];
+    for (int i = 0; i < 50; ++i) {
+        values[i] = 100 + i;
+    }
+    assert(dsc_priority_queue_push_range(queue, values, 50, handles) == DSC_ERROR_OK);
+
+    // Decrease a key below every other one
+    int value = 1;
+    assert(dsc_priority_queue_update(queue, handles[30], &value) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_top(queue, &value) == DSC_ERROR_OK && value == 1);
+
+    // Increase the key of the current top past every other one
+    value = 1000;
+    assert(dsc_priority_queue_update(queue, handles[30], &value) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_get(queue, handles[30], &value) == DSC_ERROR_OK);
+    assert(value == 1000);
+    assert(dsc_priority_queue_top(queue, &value) == DSC_ERROR_OK && value == 100);
+
+    assert(dsc_priority_queue_erase(queue, handles[0]) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_erase(queue, handles[0]) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_priority_queue_update(queue, handles[0], &value) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_priority_queue_erase(queue, 12345) == DSC_ERROR_NOT_FOUND);
+
+    // The other handles survive the elements moving around the heap
+    for (int i = 1; i < 50; ++i) {
+        assert(dsc_priority_queue_get(queue, handles[i], &value) == DSC_ERROR_OK);
+        assert(value == (i == 30 ? 1000 : 100 + i));
+    }
+
+    for (int i = 1; i < 50; ++i) {
+        if (i == 30) {
+            continue;
+        }
+        assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK);
+        assert(value == 100 + i);
+    }
+
+    assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK && value == 1000);
+    assert(dsc_priority_queue_get(queue, handles[30], &value) == DSC_ERROR_NOT_FOUND);
+
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_priority_queue_strings(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *words[] = {"pear", "apple", "fig", "cherry", "banana"};
+    DSCPriorityHandle handles[5];
+    assert(dsc_priority_queue_push_range(queue, words, 5, handles) == DSC_ERROR_OK);
+
+    char *replacement = "date";
+    assert(dsc_priority_queue_update(queue, handles[0], &replacement) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_erase(queue, handles[2]) == DSC_ERROR_OK);
+
+    char *top;
+    assert(dsc_priority_queue_top(queue, &top) == DSC_ERROR_OK);
+    assert(strcmp(top, "apple") == 0);
+    free(top);
+
+    char *popped[2];
+    assert(dsc_priority_queue_pop_range(queue, popped, 2) == DSC_ERROR_OK);
+    assert(strcmp(popped[0], "apple") == 0 && strcmp(popped[1], "banana") == 0);
+    free(popped[0]);
+    free(popped[1]);
+
+    // The strings left in the queue are released on deinit
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    double deadline;
+    int id;
+} Timer;
+
+static int compare_timers(const void *lhs, const void *rhs) {
+    double a = ((const Timer *) lhs)->deadline;
+    double b = ((const Timer *) rhs)->deadline;
+    return (a > b) - (a < b);
+}
+
+void test_dsc_priority_queue_bytes(void) {
+    DSCPriorityQueue *queue;
+    DSCElementType timer = {sizeof(Timer), NULL, compare_timers, NULL, NULL};
+
+    assert(dsc_priority_queue_init_bytes(&queue, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_priority_queue_init_bytes(&queue, &timer, NULL) == DSC_ERROR_OK);
+
+    DSCPriorityHandle handles[20];
+    for (int i = 0; i < 20; ++i) {
+        Timer t = {100.0 - i, i};
+        assert(dsc_priority_queue_push(queue, &t, &handles[i]) == DSC_ERROR_OK);
+    }
+
+    // Reschedule the latest timer to fire first
+    Timer t = {0.5, 0};
+    assert(dsc_priority_queue_update(queue, handles[0], &t) == DSC_ERROR_OK);
+
+    assert(dsc_priority_queue_pop(queue, &t) == DSC_ERROR_OK && t.id == 0);
+    for (int i = 19; i > 0; --i) {
+        assert(dsc_priority_queue_pop(queue, &t) == DSC_ERROR_OK && t.id == i);
+    }
+
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_priority_queue_growth(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    DSCGrowthPolicy policy = {1.5, DSC_GROWTH_SHRINK_RATIO, false};
+    assert(dsc_priority_queue_set_growth(queue, &policy) == DSC_ERROR_OK);
+
+    assert(dsc_priority_queue_reserve(queue, 1000) == DSC_ERROR_OK);
+    size_t capacity;
+    assert(dsc_priority_queue_capacity(queue, &capacity) == DSC_ERROR_OK && capacity == 1000);
+
+    for (int i = 1000; i > 0; --i) {
+        assert(dsc_priority_queue_push(queue, &i, NULL) == DSC_ERROR_OK);
+    }
+
+    int value;
+    for (int i = 1; i <= 990; ++i) {
+        assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK && value == i);
+    }
+
+    assert(dsc_priority_queue_capacity(queue, &capacity) == DSC_ERROR_OK);
+    assert(capacity < 1000 && capacity >= DSC_PRIORITY_QUEUE_INITIAL_CAPACITY);
+
+    assert(dsc_priority_queue_shrink_to_fit(queue) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_capacity(queue, &capacity) == DSC_ERROR_OK && capacity == 10);
+
+    for (int i = 991; i <= 1000; ++i) {
+        assert(dsc_priority_queue_pop(queue, &value) == DSC_ERROR_OK && value == i);
+    }
+
+    assert(dsc_priority_queue_clear(queue) == DSC_ERROR_OK);
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+static bool sum_ints(const void *element, void *context) {
+    *(long *) context += *(const int *) element;
+    return true;
+}
+
+void test_dsc_priority_queue_for_each(void) {
+    DSCPriorityQueue *queue;
+    assert(dsc_priority_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    for (int i = 12; i > 0; --i) {
+        assert(dsc_priority_queue_push(queue, &i, NULL) == DSC_ERROR_OK);
+    }
+
+    long sum = 0;
+    assert(dsc_priority_queue_for_each(queue, sum_ints, &sum) == DSC_ERROR_OK);
+    assert(sum == 78);
+
+    assert(dsc_priority_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_priority_queue_init_deinit();
+    test_dsc_priority_queue_push_pop();
+    test_dsc_priority_queue_ranges();
+    test_dsc_priority_queue_handles();
+    test_dsc_priority_queue_strings();
+    test_dsc_priority_queue_bytes();
+    test_dsc_priority_queue_growth();
+    test_dsc_priority_queue_for_each();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -14,3 +14,298 @@
  * You should have received a copy of the GNU General Public License along with
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_queue.h"
+
+void test_dsc_queue_init_deinit(void) {
+    DSCQueue *queue;
+
+    assert(dsc_queue_init(NULL, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_queue_init(&queue, DSC_TYPE_UNKNOWN) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+
+    assert(dsc_queue_init(&queue, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_queue_push_pop(void) {
+    DSCQueue *queue;
+    assert(dsc_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Interleave pushes and pops so that the ring wraps before it grows
+    int next = 0;
+    int expected = 0;
+    int value;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 10; ++i, ++next) {
+            assert(dsc_queue_push(queue, &next) == DSC_ERROR_OK);
+        }
+
+        for (int i = 0; i < 7; ++i, ++expected) {
+            assert(dsc_queue_pop(queue, &value) == DSC_ERROR_OK);
+            assert(value == expected);
+        }
+    }
+
+    assert(dsc_queue_front(queue, &value) == DSC_ERROR_OK);
+    assert(value == expected);
+    assert(dsc_queue_back(queue, &value) == DSC_ERROR_OK);
+    assert(value == next - 1);
+
+    while (expected < next) {
+        assert(dsc_queue_pop(queue, &value) == DSC_ERROR_OK);
+        assert(value == expected++);
+    }
+
+    bool empty;
+    assert(dsc_queue_empty(queue, &empty) == DSC_ERROR_OK);
+    assert(empty == true);
+    assert(dsc_queue_pop(queue, &value) == DSC_ERROR_EMPTY_CONTAINER);
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_queue_strings(void) {
+    DSCQueue *queue;
+    assert(dsc_queue_init(&queue, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *first = "first";
+    char *second = "second";
+    assert(dsc_queue_push(queue, &first) == DSC_ERROR_OK);
+    assert(dsc_queue_push(queue, &second) == DSC_ERROR_OK);
+
+    DSCStringView view;
+    assert(dsc_queue_front_view(queue, &view) == DSC_ERROR_OK);
+    assert(view.length == 5);
+    assert(memcmp(view.data, "first", 5) == 0);
+
+    char *result;
+    assert(dsc_queue_back(queue, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, second) == 0);
+    free(result);
+
+    assert(dsc_queue_pop(queue, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, first) == 0);
+    free(result);
+
+    assert(dsc_queue_pop(queue, &result) == DSC_ERROR_OK);
+    free(result);
+    assert(dsc_queue_front_view(queue, &view) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_queue_push(queue, &second) == DSC_ERROR_OK);
+
+    // The remaining string is freed with the queue
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_queue_growth(void) {
+    DSCQueue *queue;
+    size_t capacity;
+    assert(dsc_queue_init(&queue, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+    DSCGrowthPolicy policy = DSC_GROWTH_POLICY_DEFAULT;
+    policy.shrink_ratio = DSC_GROWTH_SHRINK_RATIO;
+    assert(dsc_queue_set_growth(queue, &policy) == DSC_ERROR_OK);
+
+    // Spike, then drain back to idle
+    for (int i = 0; i < 100000; ++i) {
+        double value = i;
+        assert(dsc_queue_push(queue, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_queue_capacity(queue, &capacity) == DSC_ERROR_OK);
+    assert(capacity >= 100000);
+
+    double value;
+    for (int i = 0; i < 99990; ++i) {
+        assert(dsc_queue_pop(queue, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    assert(dsc_queue_capacity(queue, &capacity) == DSC_ERROR_OK);
+    assert(capacity == DSC_QUEUE_INITIAL_CAPACITY);
+
+    for (int i = 99990; i < 100000; ++i) {
+        assert(dsc_queue_pop(queue, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    value = 1.0;
+    assert(dsc_queue_push(queue, &value) == DSC_ERROR_OK);
+    assert(dsc_queue_shrink_to_fit(queue) == DSC_ERROR_OK);
+    assert(dsc_queue_capacity(queue, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 1);
+    assert(dsc_queue_push(queue, &value) == DSC_ERROR_OK);
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    double position[3];
+} Particle;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_queue_bytes(void) {
+    DSCQueue *queue;
+    DSCElementType particle = {sizeof(Particle), NULL, NULL, NULL, NULL};
+
+    assert(dsc_queue_init_bytes(&queue, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_queue_init(&queue, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_queue_init_bytes(&queue, &particle, NULL) == DSC_ERROR_OK);
+
+    // Interleave pushes and pops so the ring wraps before it grows
+    int next = 0;
+    for (int i = 0; i < 100; ++i) {
+        Particle p = {i, {i * 2.0, 0.0, 0.0}};
+        assert(dsc_queue_push(queue, &p) == DSC_ERROR_OK);
+
+        if (i % 3 == 2) {
+            assert(dsc_queue_pop(queue, &p) == DSC_ERROR_OK);
+            assert(p.id == next && p.position[0] == next * 2.0);
+            next++;
+        }
+    }
+
+    Particle p;
+    assert(dsc_queue_back(queue, &p) == DSC_ERROR_OK && p.id == 99);
+
+    while (next < 100) {
+        assert(dsc_queue_front(queue, &p) == DSC_ERROR_OK && p.id == next);
+        assert(dsc_queue_pop(queue, &p) == DSC_ERROR_OK && p.id == next);
+        next++;
+    }
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+    assert(dsc_queue_init_bytes(&queue, &named, NULL) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 40; ++i) {
+        Named n = {i, "dennis"};
+        assert(dsc_queue_push(queue, &n) == DSC_ERROR_OK);
+    }
+
+    Named out;
+    assert(dsc_queue_pop(queue, &out) == DSC_ERROR_OK && out.id == 0);
+    named_destroy(&out);
+    assert(named_live == 39);
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+static bool sum_ints(const void *element, void *context) {
+    *(long *) context += *(const int *) element;
+    return true;
+}
+
+static bool stop_at_ten(const void *element, void *context) {
+    (*(int *) context)++;
+    return *(const int *) element < 10;
+}
+
+void test_dsc_queue_cursor(void) {
+    DSCQueue *queue;
+    assert(dsc_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    // Pop some first so that the elements wrap around the end of the buffer
+    for (int i = 0; i < 10; ++i) {
+        assert(dsc_queue_push(queue, &i) == DSC_ERROR_OK);
+    }
+    for (int i = 0; i < 10; ++i) {
+        int value;
+        assert(dsc_queue_pop(queue, &value) == DSC_ERROR_OK);
+    }
+    for (int i = 0; i < 12; ++i) {
+        assert(dsc_queue_push(queue, &i) == DSC_ERROR_OK);
+    }
+
+    DSCQueueCursor cursor;
+    const void *element;
+    assert(dsc_queue_cursor_init(queue, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 12; ++i) {
+        assert(dsc_queue_cursor_next(&cursor, &element));
+        assert(*(const int *) element == i);
+    }
+    assert(!dsc_queue_cursor_next(&cursor, &element));
+
+    long sum = 0;
+    assert(dsc_queue_for_each(queue, sum_ints, &sum) == DSC_ERROR_OK);
+    assert(sum == 66);
+
+    int visited = 0;
+    assert(dsc_queue_for_each(queue, stop_at_ten, &visited) == DSC_ERROR_OK);
+    assert(visited == 11);
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+}
+
+void test_dsc_queue_move_swap(void) {
+    DSCQueue *queue;
+    DSCQueue *other;
+    assert(dsc_queue_init(&queue, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_queue_init(&other, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *first = strdup("first");
+    char *second = strdup("second");
+    assert(dsc_queue_push_move(queue, &first) == DSC_ERROR_OK);
+    assert(dsc_queue_push_move(queue, &second) == DSC_ERROR_OK);
+
+    assert(dsc_queue_swap(queue, other) == DSC_ERROR_OK);
+
+    char *result;
+    assert(dsc_queue_pop(queue, &result) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_queue_pop(other, &result) == DSC_ERROR_OK);
+    assert(result == first);
+    free(result);
+
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+    assert(dsc_queue_deinit(other) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_queue_init_deinit();
+    test_dsc_queue_push_pop();
+    test_dsc_queue_strings();
+    test_dsc_queue_growth();
+    test_dsc_queue_bytes();
+    test_dsc_queue_cursor();
+    test_dsc_queue_move_swap();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
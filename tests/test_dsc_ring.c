@@ -0,0 +1,287 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_ring.h"
+
+#define ITEMS 100000
+#define THREADS 4
+
+void test_dsc_spsc_ring_basic(void) {
+    DSCSpscRing *ring;
+
+    assert(dsc_spsc_ring_init(NULL, DSC_TYPE_INT, 8) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_UNKNOWN, 8) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_BYTES, 8) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_INT, 0) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_INT, 5) == DSC_ERROR_OK);
+
+    size_t capacity;
+    assert(dsc_spsc_ring_capacity(ring, &capacity) == DSC_ERROR_OK && capacity == 8);
+
+    int value;
+    assert(dsc_spsc_ring_pop(ring, &value) == DSC_ERROR_EMPTY_CONTAINER);
+
+    for (int i = 0; i < 8; ++i) {
+        assert(dsc_spsc_ring_push(ring, &i) == DSC_ERROR_OK);
+    }
+    assert(dsc_spsc_ring_push(ring, &value) == DSC_ERROR_FULL);
+
+    size_t size;
+    assert(dsc_spsc_ring_size(ring, &size) == DSC_ERROR_OK && size == 8);
+
+    int out[8];
+    size_t popped;
+    assert(dsc_spsc_ring_pop_batch(ring, out, 3, &popped) == DSC_ERROR_OK && popped == 3);
+    assert(out[0] == 0 && out[2] == 2);
+
+    // The batch wraps around the end of the slots and stops when full
+    int in[5] = {8, 9, 10, 11, 12};
+    size_t pushed;
+    assert(dsc_spsc_ring_push_batch(ring, in, 5, &pushed) == DSC_ERROR_OK && pushed == 3);
+
+    assert(dsc_spsc_ring_pop_batch(ring, out, 8, &popped) == DSC_ERROR_OK && popped == 8);
+    for (int i = 0; i < 8; ++i) {
+        assert(out[i] == i + 3);
+    }
+
+    assert(dsc_spsc_ring_deinit(ring) == DSC_ERROR_OK);
+}
+
+void test_dsc_spsc_ring_strings(void) {
+    DSCSpscRing *ring;
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_STRING, 4) == DSC_ERROR_OK);
+
+    char buffer[16] = "hello";
+    char *s = buffer;
+    assert(dsc_spsc_ring_push(ring, &s) == DSC_ERROR_OK);
+    buffer[0] = 'j';
+    assert(dsc_spsc_ring_push(ring, &s) == DSC_ERROR_OK);
+
+    char *out;
+    assert(dsc_spsc_ring_pop(ring, &out) == DSC_ERROR_OK);
+    assert(strcmp(out, "hello") == 0 && out != buffer);
+    free(out);
+
+    // The string left behind is released with the ring
+    assert(dsc_spsc_ring_deinit(ring) == DSC_ERROR_OK);
+}
+
+static void *spsc_producer(void *arg) {
+    DSCSpscRing *ring = arg;
+
+    for (int i = 0; i < ITEMS; ) {
+        if (dsc_spsc_ring_push(ring, &i) == DSC_ERROR_OK) {
+            ++i;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+void test_dsc_spsc_ring_threads(void) {
+    DSCSpscRing *ring;
+    assert(dsc_spsc_ring_init(&ring, DSC_TYPE_INT, 256) == DSC_ERROR_OK);
+
+    pthread_t producer;
+    assert(pthread_create(&producer, NULL, spsc_producer, ring) == 0);
+
+    int expected = 0;
+    int batch[32];
+
+    while (expected < ITEMS) {
+        size_t popped;
+        assert(dsc_spsc_ring_pop_batch(ring, batch, 32, &popped) == DSC_ERROR_OK);
+
+        for (size_t i = 0; i < popped; ++i) {
+            assert(batch[i] == expected++);
+        }
+
+        if (popped == 0) {
+            sched_yield();
+        }
+    }
+
+    assert(pthread_join(producer, NULL) == 0);
+    assert(dsc_spsc_ring_deinit(ring) == DSC_ERROR_OK);
+}
+
+void test_dsc_mpmc_ring_basic(void) {
+    DSCMpmcRing *ring;
+
+    assert(dsc_mpmc_ring_init(&ring, DSC_TYPE_BYTES, 8) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_mpmc_ring_init(&ring, DSC_TYPE_DOUBLE, 4) == DSC_ERROR_OK);
+
+    double value = 0.5;
+    for (int i = 0; i < 4; ++i) {
+        assert(dsc_mpmc_ring_push(ring, &value) == DSC_ERROR_OK);
+        value += 1.0;
+    }
+    assert(dsc_mpmc_ring_push(ring, &value) == DSC_ERROR_FULL);
+
+    size_t size;
+    assert(dsc_mpmc_ring_size(ring, &size) == DSC_ERROR_OK && size == 4);
+
+    double out[4];
+    size_t popped;
+    assert(dsc_mpmc_ring_pop_batch(ring, out, 4, &popped) == DSC_ERROR_OK && popped == 4);
+    assert(out[0] == 0.5 && out[3] == 3.5);
+    assert(dsc_mpmc_ring_pop(ring, &value) == DSC_ERROR_EMPTY_CONTAINER);
+
+    double in[6] = {1, 2, 3, 4, 5, 6};
+    size_t pushed;
+    assert(dsc_mpmc_ring_push_batch(ring, in, 6, &pushed) == DSC_ERROR_OK && pushed == 4);
+    assert(dsc_mpmc_ring_pop(ring, &value) == DSC_ERROR_OK && value == 1.0);
+
+    assert(dsc_mpmc_ring_deinit(ring) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    char *payload;
+} Task;
+
+static int tasks_destroyed = 0;
+
+static void task_destroy(void *record) {
+    free(((Task *) record)->payload);
+    tasks_destroyed++;
+}
+
+void test_dsc_mpmc_ring_bytes(void) {
+    DSCMpmcRing *ring;
+    DSCElementType task = {sizeof(Task), NULL, NULL, NULL, task_destroy};
+
+    assert(dsc_mpmc_ring_init_bytes(&ring, NULL, 8, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_mpmc_ring_init_bytes(&ring, &task, 8, NULL) == DSC_ERROR_OK);
+
+    // Records are moved in: the ring owns the payload until it is popped
+    for (int i = 0; i < 3; ++i) {
+        Task t = {i, strdup("work")};
+        assert(dsc_mpmc_ring_push(ring, &t) == DSC_ERROR_OK);
+    }
+
+    Task out;
+    assert(dsc_mpmc_ring_pop(ring, &out) == DSC_ERROR_OK && out.id == 0);
+    assert(strcmp(out.payload, "work") == 0);
+    free(out.payload);
+
+    assert(dsc_mpmc_ring_deinit(ring) == DSC_ERROR_OK);
+    assert(tasks_destroyed == 2);
+}
+
+typedef struct {
+    DSCMpmcRing *ring;
+    int base;
+    long long sum;
+    int count;
+} Worker;
+
+static void *mpmc_producer(void *arg) {
+    Worker *worker = arg;
+    int batch[16];
+
+    for (int i = 0; i < ITEMS; i += 16) {
+        for (int j = 0; j < 16; ++j) {
+            batch[j] = worker->base + i + j;
+        }
+
+        size_t done = 0;
+        while (done < 16) {
+            size_t pushed;
+            assert(dsc_mpmc_ring_push_batch(worker->ring, batch + done, 16 - done,
+                                            &pushed) == DSC_ERROR_OK);
+            done += pushed;
+
+            if (pushed == 0) {
+                sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static _Atomic int consumed = 0;
+
+static void *mpmc_consumer(void *arg) {
+    Worker *worker = arg;
+    int value;
+
+    while (consumed < THREADS * ITEMS) {
+        if (dsc_mpmc_ring_pop(worker->ring, &value) == DSC_ERROR_OK) {
+            worker->sum += value;
+            worker->count++;
+            consumed++;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+void test_dsc_mpmc_ring_threads(void) {
+    DSCMpmcRing *ring;
+    assert(dsc_mpmc_ring_init(&ring, DSC_TYPE_INT, 1024) == DSC_ERROR_OK);
+
+    pthread_t threads[2 * THREADS];
+    Worker workers[2 * THREADS];
+
+    for (int i = 0; i < 2 * THREADS; ++i) {
+        workers[i] = (Worker) {ring, (i % THREADS) * ITEMS, 0, 0};
+        assert(pthread_create(&threads[i], NULL, i < THREADS ? mpmc_producer : mpmc_consumer,
+                              &workers[i]) == 0);
+    }
+
+    long long sum = 0;
+    int count = 0;
+
+    for (int i = 0; i < 2 * THREADS; ++i) {
+        assert(pthread_join(threads[i], NULL) == 0);
+        sum += workers[i].sum;
+        count += workers[i].count;
+    }
+
+    // Every value 0 .. THREADS * ITEMS - 1 is seen exactly once
+    long long n = (long long) THREADS * ITEMS;
+    assert(count == n);
+    assert(sum == n * (n - 1) / 2);
+
+    assert(dsc_mpmc_ring_deinit(ring) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_spsc_ring_basic();
+    test_dsc_spsc_ring_strings();
+    test_dsc_spsc_ring_threads();
+    test_dsc_mpmc_ring_basic();
+    test_dsc_mpmc_ring_bytes();
+    test_dsc_mpmc_ring_threads();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
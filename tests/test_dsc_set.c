@@ -14,3 +14,641 @@
  * You should have received a copy of the GNU General Public License along with
  * libdsc. If not, see <https://www.gnu.org/licenses/>.
  */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_set.h"
+
+void test_dsc_set_init_deinit(void) {
+    DSCSet *set;
+
+    assert(dsc_set_init(NULL, DSC_TYPE_INT) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_set_init(&set, DSC_TYPE_UNKNOWN) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_insert_contains(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 1000; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    int key = 42;
+    assert(dsc_set_insert(set, &key) == DSC_ERROR_ALREADY_EXISTS);
+
+    bool contains;
+    for (int i = 0; i < 1000; ++i) {
+        assert(dsc_set_contains(set, &i, &contains) == DSC_ERROR_OK);
+        assert(contains == true);
+    }
+
+    key = -1;
+    assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+    assert(contains == false);
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK);
+    assert(size == 1000);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_erase_clear(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char buffer[16];
+    char *key = buffer;
+    for (int i = 0; i < 100; ++i) {
+        snprintf(buffer, sizeof(buffer), "key%d", i);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    bool contains;
+    for (int i = 0; i < 100; i += 2) {
+        snprintf(buffer, sizeof(buffer), "key%d", i);
+        assert(dsc_set_erase(set, &key) == DSC_ERROR_OK);
+        assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+        assert(contains == false);
+    }
+
+    assert(dsc_set_erase(set, &key) == DSC_ERROR_NOT_FOUND);
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK);
+    assert(size == 50);
+
+    assert(dsc_set_clear(set) == DSC_ERROR_OK);
+    assert(dsc_set_empty(set, &contains) == DSC_ERROR_OK);
+    assert(contains == true);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_incremental_rehash(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    bool contains;
+    for (int i = 0; i < 10000; ++i) {
+        double key = i * 0.5;
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_ALREADY_EXISTS);
+    }
+
+    for (int i = 0; i < 10000; ++i) {
+        double key = i * 0.5;
+        assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+        assert(contains == true);
+        assert(dsc_set_erase(set, &key) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_empty(set, &contains) == DSC_ERROR_OK);
+    assert(contains == true);
+
+    // Zeros compare equal regardless of sign, so they must hash alike too
+    double zero = 0.0;
+    double negative_zero = -0.0;
+    assert(dsc_set_insert(set, &zero) == DSC_ERROR_OK);
+    assert(dsc_set_contains(set, &negative_zero, &contains) == DSC_ERROR_OK);
+    assert(contains == true);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_contains_batch(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 1000; i += 3) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    int keys[1000];
+    bool results[1000];
+    for (int i = 0; i < 1000; ++i) {
+        keys[i] = i;
+    }
+
+    assert(dsc_set_contains_batch(set, keys, 1000, results) == DSC_ERROR_OK);
+    for (int i = 0; i < 1000; ++i) {
+        assert(results[i] == (i % 3 == 0));
+    }
+
+    assert(dsc_set_contains_batch(set, NULL, 1000, results) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_reserve(void) {
+    DSCSet *set;
+    size_t reserved;
+    size_t capacity;
+
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_reserve(set, 3000) == DSC_ERROR_OK);
+    assert(dsc_set_capacity(set, &reserved) == DSC_ERROR_OK);
+    assert(reserved >= 3000);
+
+    for (int i = 0; i < 3000; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_capacity(set, &capacity) == DSC_ERROR_OK);
+    assert(capacity == reserved);
+
+    assert(dsc_set_reserve(NULL, 1) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_string_pool(void) {
+    DSCStringPool *pool;
+    assert(dsc_string_pool_init(&pool, NULL) == DSC_ERROR_OK);
+
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_set_use_string_pool(set, pool) == DSC_ERROR_OK);
+
+    char *words[] = {"short", "a key too long to be stored inline", "another long key for the pool"};
+    for (size_t i = 0; i < 3; ++i) {
+        assert(dsc_set_insert(set, &words[i]) == DSC_ERROR_OK);
+    }
+
+    // Only the long keys are interned
+    size_t size;
+    assert(dsc_string_pool_size(pool, &size) == DSC_ERROR_OK);
+    assert(size == 2);
+
+    char buffer[] = "a key too long to be stored inline";
+    char *key = buffer;
+    bool contains;
+    assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+    assert(contains == true);
+
+    assert(dsc_set_erase(set, &key) == DSC_ERROR_OK);
+    assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK);
+    assert(contains == false);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(dsc_string_pool_deinit(pool) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+/* Named records are identified by id alone */
+static uint64_t named_hash(const void *record, uint64_t seed) {
+    return ((uint64_t) ((const Named *) record)->id + seed) * 0x9E3779B97F4A7C15ULL;
+}
+
+static int named_compare(const void *lhs, const void *rhs) {
+    int a = ((const Named *) lhs)->id;
+    int b = ((const Named *) rhs)->id;
+    return (a > b) - (a < b);
+}
+
+void test_dsc_set_bytes(void) {
+    DSCSet *set;
+    DSCElementType point = {sizeof(Point), NULL, NULL, NULL, NULL};
+
+    assert(dsc_set_init_bytes(&set, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_set_init(&set, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_set_init_bytes(&set, &point, NULL) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 1000; ++i) {
+        Point p = {i, -i};
+        assert(dsc_set_insert(set, &p) == DSC_ERROR_OK);
+    }
+
+    Point p = {10, -10};
+    assert(dsc_set_insert(set, &p) == DSC_ERROR_ALREADY_EXISTS);
+    assert(dsc_set_erase(set, &p) == DSC_ERROR_OK);
+
+    Point probes[4] = {{10, -10}, {11, -11}, {11, 11}, {999, -999}};
+    bool found[4];
+    assert(dsc_set_contains_batch(set, probes, 4, found) == DSC_ERROR_OK);
+    assert(!found[0] && found[1] && !found[2] && found[3]);
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 999);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+    // Callbacks decide identity and own the names
+    DSCElementType named = {sizeof(Named), named_hash, named_compare, named_copy,
+                            named_destroy};
+    assert(dsc_set_init_bytes(&set, &named, NULL) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        Named n = {i, "edsger"};
+        assert(dsc_set_insert(set, &n) == DSC_ERROR_OK);
+    }
+
+    bool contains;
+    Named other = {42, "someone else"};
+    assert(dsc_set_contains(set, &other, &contains) == DSC_ERROR_OK && contains);
+    assert(dsc_set_insert(set, &other) == DSC_ERROR_ALREADY_EXISTS);
+    assert(dsc_set_erase(set, &other) == DSC_ERROR_OK);
+    assert(named_live == 99);
+
+    assert(dsc_set_clear(set) == DSC_ERROR_OK);
+    assert(named_live == 0);
+
+    Named n = {1, "tony"};
+    assert(dsc_set_insert(set, &n) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+static bool count_keys(const void *element, void *context) {
+    unsigned char *seen = context;
+    seen[*(const int *) element]++;
+    return true;
+}
+
+void test_dsc_set_cursor(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    // Stop right after a resize of more slots than one step migrates, so
+    // that some keys still sit in the old slots
+    int count = 0;
+    size_t initial;
+    assert(dsc_set_reserve(set, 150) == DSC_ERROR_OK);
+    assert(dsc_set_capacity(set, &initial) == DSC_ERROR_OK);
+    assert(initial == 256);
+    for (size_t capacity = initial; capacity == initial; ++count) {
+        assert(dsc_set_insert(set, &count) == DSC_ERROR_OK);
+        assert(dsc_set_capacity(set, &capacity) == DSC_ERROR_OK);
+    }
+
+    unsigned char seen[256] = {0};
+    assert(count <= 256);
+
+    DSCSetCursor cursor;
+    const void *element;
+    assert(dsc_set_cursor_init(set, &cursor) == DSC_ERROR_OK);
+    while (dsc_set_cursor_next(&cursor, &element)) {
+        seen[*(const int *) element]++;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        assert(seen[i] == 1);
+    }
+
+    memset(seen, 0, sizeof(seen));
+    assert(dsc_set_for_each(set, count_keys, seen) == DSC_ERROR_OK);
+    for (int i = 0; i < count; ++i) {
+        assert(seen[i] == 1);
+    }
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+void test_dsc_set_move_swap(void) {
+    DSCSet *set;
+    DSCSet *other;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_set_init(&other, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    // Short keys are copied inline, long ones adopted
+    char *keys[100];
+    for (int i = 0; i < 100; ++i) {
+        keys[i] = malloc(64);
+        snprintf(keys[i], 64, i % 2 ? "short %d" : "a key too long to be stored inline %d", i);
+        assert(dsc_set_insert_move(set, &keys[i]) == DSC_ERROR_OK);
+    }
+
+    // A duplicate is refused and stays with the caller
+    char *duplicate = strdup("short 1");
+    assert(dsc_set_insert_move(set, &duplicate) == DSC_ERROR_ALREADY_EXISTS);
+    free(duplicate);
+
+    assert(dsc_set_swap(set, other) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 0);
+    assert(dsc_set_size(other, &size) == DSC_ERROR_OK && size == 100);
+
+    char *key = "short 99";
+    bool contains;
+    assert(dsc_set_contains(other, &key, &contains) == DSC_ERROR_OK && contains);
+    assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK && !contains);
+
+    assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(other) == DSC_ERROR_OK);
+}
+
+static bool below(const void *element, void *context) {
+    return *(const int *) element < *(const int *) context;
+}
+
+static bool is_long(const void *element, void *context) {
+    (void) context;
+    return strlen(element) >= 16;
+}
+
+void test_dsc_set_erase_if(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    // Stop right after a resize so that some keys are still in the old slots
+    for (int i = 0; i < 2000; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    size_t before;
+    assert(dsc_set_capacity(set, &before) == DSC_ERROR_OK);
+
+    int limit = 1900;
+    size_t removed;
+    assert(dsc_set_erase_if(set, below, &limit, &removed) == DSC_ERROR_OK);
+    assert(removed == 1900);
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 100);
+
+    // The sparse table is rebuilt smaller
+    size_t after;
+    assert(dsc_set_capacity(set, &after) == DSC_ERROR_OK);
+    assert(after < before);
+
+    bool contains;
+    for (int i = 0; i < 2000; ++i) {
+        assert(dsc_set_contains(set, &i, &contains) == DSC_ERROR_OK);
+        assert(contains == (i >= 1900));
+    }
+
+    // Keep the upper half of what is left
+    limit = 1950;
+    assert(dsc_set_retain(set, below, &limit, &removed) == DSC_ERROR_OK);
+    assert(removed == 50);
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 50);
+
+    assert(dsc_set_erase_if(NULL, below, &limit, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    dsc_set_deinit(set);
+
+    // Heap and inline string keys are both released
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char buffer[64];
+    char *key = buffer;
+    for (int i = 0; i < 100; ++i) {
+        snprintf(buffer, sizeof(buffer), i % 2 ? "k%d" : "a key too long to be stored inline %d", i);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_erase_if(set, is_long, NULL, &removed) == DSC_ERROR_OK);
+    assert(removed == 50);
+
+    key = "k1";
+    assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK && contains);
+
+    dsc_set_deinit(set);
+}
+
+void test_dsc_set_erase_during_resize(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+
+    // Heap-stored keys, inserted until a resize has just started. The old
+    // slots are many times one migration step, so the resize stays in
+    // progress for the first few dozen keys below
+    char buffer[64];
+    char *key = buffer;
+    int count = 0;
+    size_t initial;
+    assert(dsc_set_reserve(set, 3000) == DSC_ERROR_OK);
+    assert(dsc_set_capacity(set, &initial) == DSC_ERROR_OK);
+    for (size_t capacity = initial; capacity == initial; ++count) {
+        snprintf(buffer, sizeof(buffer), "a key too long to be stored inline %d", count);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+        assert(dsc_set_capacity(set, &capacity) == DSC_ERROR_OK);
+    }
+
+    // Every erase migrates more slots, so keys are hit both before and after
+    // they have moved; none may be found, erased or rejected through a stale
+    // copy in the old slots
+    bool contains;
+    for (int i = 0; i < count; ++i) {
+        snprintf(buffer, sizeof(buffer), "a key too long to be stored inline %d", i);
+        assert(dsc_set_erase(set, &key) == DSC_ERROR_OK);
+        assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK && !contains);
+        assert(dsc_set_erase(set, &key) == DSC_ERROR_NOT_FOUND);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == (size_t) count);
+
+    for (int i = 0; i < count; ++i) {
+        snprintf(buffer, sizeof(buffer), "a key too long to be stored inline %d", i);
+        assert(dsc_set_contains(set, &key, &contains) == DSC_ERROR_OK && contains);
+    }
+
+    // Clearing mid-resize releases every key exactly once
+    assert(dsc_set_clear(set) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+/* Counts live blocks, so a test can tell when old slot arrays are released */
+static long counted_live = 0;
+
+static void *counted_alloc(void *context, size_t size) {
+    (void) context;
+    counted_live++;
+    return malloc(size);
+}
+
+static void *counted_realloc(void *context, void *ptr, size_t size) {
+    (void) context;
+    counted_live += ptr == NULL;
+    return realloc(ptr, size);
+}
+
+static void counted_free(void *context, void *ptr) {
+    (void) context;
+    counted_live -= ptr != NULL;
+    free(ptr);
+}
+
+static const DSCAllocator counted = {counted_alloc, counted_realloc, counted_free, NULL};
+
+/* Fill an incremental set until a resize starts, then take one more step so
+ * that part of the old slots has been migrated and part has not */
+static int start_partial_resize(DSCSet *set) {
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+    assert(dsc_set_reserve(set, 3000) == DSC_ERROR_OK);
+
+    int count = 0;
+    size_t initial;
+    assert(dsc_set_capacity(set, &initial) == DSC_ERROR_OK);
+    for (size_t capacity = initial; capacity == initial; ++count) {
+        assert(dsc_set_insert(set, &count) == DSC_ERROR_OK);
+        assert(dsc_set_capacity(set, &capacity) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_insert(set, &count) == DSC_ERROR_OK);
+
+    return count + 1;
+}
+
+static void assert_all_found(const DSCSet *set, int count) {
+    size_t size;
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == (size_t) count);
+
+    bool contains;
+    for (int i = 0; i < count; ++i) {
+        assert(dsc_set_contains(set, &i, &contains) == DSC_ERROR_OK && contains);
+    }
+}
+
+void test_dsc_set_finish_resize(void) {
+    // Every way of finishing a partly done resize moves every old element
+    // and releases the old control bytes and keys
+    DSCSet *set;
+    assert(dsc_set_init_allocator(&set, DSC_TYPE_INT, &counted) == DSC_ERROR_OK);
+    int count = start_partial_resize(set);
+    long live = counted_live;
+    assert(dsc_set_incremental_rehash(set, false) == DSC_ERROR_OK);
+    assert(counted_live == live - 2);
+    assert_all_found(set, count);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(counted_live == 0);
+
+    assert(dsc_set_init_allocator(&set, DSC_TYPE_INT, &counted) == DSC_ERROR_OK);
+    count = start_partial_resize(set);
+    live = counted_live;
+    assert(dsc_set_reserve(set, 100000) == DSC_ERROR_OK);
+    assert(counted_live == live - 2);
+    assert_all_found(set, count);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(counted_live == 0);
+
+    // A bulk insert reserves, and so rehashes, before it starts
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    count = start_partial_resize(set);
+    int more[5000];
+    for (int i = 0; i < 5000; ++i) {
+        more[i] = count + i;
+    }
+    assert(dsc_set_parallel_insert_range(set, more, 5000, NULL) == DSC_ERROR_OK);
+    assert_all_found(set, count + 5000);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+    // Inserting through the rest of the resize and into the next one
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    count = start_partial_resize(set);
+    for (int i = count; i < 20000; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+    assert_all_found(set, 20000);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+static bool always(const void *element, void *context) {
+    (void) element;
+    (void) context;
+    return true;
+}
+
+void test_dsc_set_erase_if_during_resize(void) {
+    // Erasing everything mid-resize reaches the keys still in the old slots
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_incremental_rehash(set, true) == DSC_ERROR_OK);
+    for (int i = 0; i < 450; ++i) {
+        assert(dsc_set_insert(set, &i) == DSC_ERROR_OK);
+    }
+
+    size_t removed;
+    size_t size;
+    assert(dsc_set_erase_if(set, always, NULL, &removed) == DSC_ERROR_OK);
+    assert(removed == 450);
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 0);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+    // Retaining part of a set whose resize is partly done
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    int count = start_partial_resize(set);
+    int limit = count / 2;
+    assert(dsc_set_retain(set, below, &limit, &removed) == DSC_ERROR_OK);
+    assert(removed == (size_t) (count - limit));
+    assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == (size_t) limit);
+
+    bool contains;
+    for (int i = 0; i < count; ++i) {
+        assert(dsc_set_contains(set, &i, &contains) == DSC_ERROR_OK);
+        assert(contains == (i < limit));
+    }
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_set_init_deinit();
+    test_dsc_set_insert_contains();
+    test_dsc_set_erase_clear();
+    test_dsc_set_incremental_rehash();
+    test_dsc_set_contains_batch();
+    test_dsc_set_reserve();
+    test_dsc_set_string_pool();
+    test_dsc_set_bytes();
+    test_dsc_set_cursor();
+    test_dsc_set_move_swap();
+    test_dsc_set_erase_if();
+    test_dsc_set_erase_during_resize();
+    test_dsc_set_finish_resize();
+    test_dsc_set_erase_if_during_resize();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
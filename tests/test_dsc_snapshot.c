@@ -0,0 +1,406 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/dsc_list.h"
+#include "../include/dsc_map.h"
+#include "../include/dsc_queue.h"
+#include "../include/dsc_set.h"
+#include "../include/dsc_snapshot.h"
+#include "../include/dsc_stack.h"
+#include "../include/dsc_vector.h"
+
+#define ITEMS 3000
+
+typedef struct {
+    int id;
+    char tag[12];
+} Record;
+
+static int record_compare(const void *lhs, const void *rhs) {
+    int a = ((const Record *) lhs)->id;
+    int b = ((const Record *) rhs)->id;
+    return (a > b) - (a < b);
+}
+
+static char path[] = "/tmp/test_dsc_snapshot_XXXXXX";
+
+static void make_path(void) {
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+}
+
+static void test_dsc_snapshot_sequences(void) {
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+    for (int i = 0; i < ITEMS; ++i) {
+        int value = i * 3 - 7;
+        assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_save(vector, path) == DSC_ERROR_OK);
+
+    DSCSnapshot *snapshot;
+    DSCSnapshotInfo info;
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK);
+    assert(info.kind == DSC_SNAPSHOT_SEQUENCE);
+    assert(info.key_type == DSC_TYPE_INT);
+    assert(info.value_type == DSC_TYPE_UNKNOWN);
+    assert(info.count == ITEMS);
+
+    for (size_t i = 0; i < ITEMS; ++i) {
+        const void *element;
+        const void *value = &info;
+        assert(dsc_snapshot_at(snapshot, i, &element, &value) == DSC_ERROR_OK);
+        assert(*(const int *) element == (int) i * 3 - 7);
+        assert(value == NULL);
+    }
+
+    const void *element;
+    size_t index;
+    int key = 2;
+    assert(dsc_snapshot_at(snapshot, ITEMS, &element, NULL) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_snapshot_find(snapshot, &key, &index) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Strings keep their order and contents, including the empty string
+    DSCList *list = dsc_list_init(DSC_TYPE_STRING);
+    assert(list != NULL);
+    const char *words[] = {"alpha", "", "a considerably longer string than the others", "z"};
+    for (size_t i = 0; i < 4; ++i) {
+        char *word = (char *) words[i];
+        assert(dsc_list_push_back(list, &word) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_list_save(list, path) == DSC_ERROR_OK);
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK);
+    assert(info.key_type == DSC_TYPE_STRING && info.count == 4);
+    for (size_t i = 0; i < 4; ++i) {
+        assert(dsc_snapshot_at(snapshot, i, &element, NULL) == DSC_ERROR_OK);
+        assert(strcmp(element, words[i]) == 0);
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // Stacks are saved bottom to top, and a wrapped queue front to back
+    DSCStack *stack;
+    assert(dsc_stack_init(&stack, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+    for (int i = 0; i < 10; ++i) {
+        double value = i / 4.0;
+        assert(dsc_stack_push(stack, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_stack_save(stack, path) == DSC_ERROR_OK);
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    for (size_t i = 0; i < 10; ++i) {
+        assert(dsc_snapshot_at(snapshot, i, &element, NULL) == DSC_ERROR_OK);
+        assert(*(const double *) element == i / 4.0);
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    DSCQueue *queue;
+    assert(dsc_queue_init_bytes(&queue, &(DSCElementType) {sizeof(Record), NULL, record_compare,
+                                                           NULL, NULL},
+                                NULL) == DSC_ERROR_OK);
+    for (int i = 0; i < 40; ++i) {
+        Record record = {i, "record"};
+        assert(dsc_queue_push(queue, &record) == DSC_ERROR_OK);
+        if (i % 2 == 0) {
+            assert(dsc_queue_pop(queue, &record) == DSC_ERROR_OK);
+        }
+    }
+
+    assert(dsc_queue_save(queue, path) == DSC_ERROR_OK);
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK);
+    assert(info.key_type == DSC_TYPE_BYTES && info.key_size == sizeof(Record));
+    assert(info.count == 20);
+    for (size_t i = 0; i < 20; ++i) {
+        assert(dsc_snapshot_at(snapshot, i, &element, NULL) == DSC_ERROR_OK);
+        assert(((const Record *) element)->id == (int) i + 20);
+        assert(strcmp(((const Record *) element)->tag, "record") == 0);
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+}
+
+static void test_dsc_snapshot_set_map(void) {
+    DSCSet *set;
+    assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    for (int i = 0; i < ITEMS; ++i) {
+        char buffer[32];
+        char *key = buffer;
+        snprintf(buffer, sizeof(buffer), "key-%d", i * 2);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_save(set, path) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+    DSCSnapshot *snapshot;
+    DSCSnapshotInfo info;
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK);
+    assert(info.kind == DSC_SNAPSHOT_SET && info.count == ITEMS);
+
+    for (int i = 0; i < 2 * ITEMS; ++i) {
+        char buffer[32];
+        char *key = buffer;
+        size_t index;
+        snprintf(buffer, sizeof(buffer), "key-%d", i);
+        DSCError error = dsc_snapshot_find(snapshot, &key, &index);
+
+        if (i % 2 == 0) {
+            const void *element;
+            assert(error == DSC_ERROR_OK);
+            assert(dsc_snapshot_at(snapshot, index, &element, NULL) == DSC_ERROR_OK);
+            assert(strcmp(element, buffer) == 0);
+        } else {
+            assert(error == DSC_ERROR_NOT_FOUND);
+        }
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // Every backend saves the same way
+    DSCMapBackend backends[] = {DSC_MAP_BACKEND_CHAINED, DSC_MAP_BACKEND_OPEN,
+                                DSC_MAP_BACKEND_SHARDED};
+    for (size_t b = 0; b < 3; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_STRING, backends[b]) ==
+               DSC_ERROR_OK);
+        for (int i = 0; i < ITEMS; ++i) {
+            char buffer[32];
+            char *value = buffer;
+            snprintf(buffer, sizeof(buffer), "value-%d", i);
+            assert(dsc_map_insert(map, &i, &value) == DSC_ERROR_OK);
+        }
+
+        assert(dsc_map_save(map, path) == DSC_ERROR_OK);
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+        assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+        assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK);
+        assert(info.kind == DSC_SNAPSHOT_MAP && info.count == ITEMS);
+        assert(info.key_type == DSC_TYPE_INT && info.value_type == DSC_TYPE_STRING);
+
+        for (int i = -5; i < ITEMS + 5; ++i) {
+            size_t index;
+            DSCError error = dsc_snapshot_find(snapshot, &i, &index);
+
+            if (i >= 0 && i < ITEMS) {
+                const void *key;
+                const void *value;
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), "value-%d", i);
+                assert(error == DSC_ERROR_OK);
+                assert(dsc_snapshot_at(snapshot, index, &key, &value) == DSC_ERROR_OK);
+                assert(*(const int *) key == i);
+                assert(strcmp(value, buffer) == 0);
+            } else {
+                assert(error == DSC_ERROR_NOT_FOUND);
+            }
+        }
+        assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+    }
+
+    // Record keys are looked up by their bytes
+    DSCElementType element = {sizeof(Record), NULL, record_compare, NULL, NULL};
+    DSCMap *map;
+    assert(dsc_map_init_bytes(&map, DSC_TYPE_BYTES, &element, DSC_TYPE_DOUBLE, NULL, NULL) ==
+           DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.id = i;
+        record.tag[0] = (char) ('a' + i % 26);
+        double value = i * 0.5;
+        assert(dsc_map_insert(map, &record, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_map_save(map, path) == DSC_ERROR_OK);
+    assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.id = i;
+        record.tag[0] = (char) ('a' + i % 26);
+
+        size_t index;
+        const void *key;
+        const void *value;
+        assert(dsc_snapshot_find(snapshot, &record, &index) == DSC_ERROR_OK);
+        assert(dsc_snapshot_at(snapshot, index, &key, &value) == DSC_ERROR_OK);
+        assert(memcmp(key, &record, sizeof(record)) == 0);
+        assert(*(const double *) value == i * 0.5);
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // An empty set still has an index to probe
+    assert(dsc_set_init(&set, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_set_save(set, path) == DSC_ERROR_OK);
+    assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    size_t index;
+    int key = 0;
+    assert(dsc_snapshot_find(snapshot, &key, &index) == DSC_ERROR_NOT_FOUND);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+}
+
+static void write_file(const void *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    assert(fwrite(data, 1, size, file) == size);
+    assert(fclose(file) == 0);
+}
+
+static void test_dsc_snapshot_invalid(void) {
+    DSCSnapshot *snapshot;
+    assert(dsc_snapshot_open(NULL, path) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_snapshot_open(&snapshot, "/nonexistent/dir/snapshot") == DSC_ERROR_IO);
+
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_vector_push_back(vector, "first") == DSC_ERROR_OK);
+    assert(dsc_vector_push_back(vector, "second") == DSC_ERROR_OK);
+    assert(dsc_vector_save(vector, "/nonexistent/dir/snapshot") == DSC_ERROR_IO);
+    assert(dsc_vector_save(vector, path) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+    unsigned char original[4096];
+    size_t size = fread(original, 1, sizeof(original), file);
+    assert(size > 0 && size < sizeof(original));
+    assert(fclose(file) == 0);
+
+    unsigned char bytes[4096];
+
+    // Truncated
+    write_file(original, size - 1);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_INVALID_FORMAT);
+    write_file(original, 10);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_INVALID_FORMAT);
+
+    // Bad magic
+    memcpy(bytes, original, size);
+    bytes[0] ^= 0xFF;
+    write_file(bytes, size);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_INVALID_FORMAT);
+
+    // Bad version
+    memcpy(bytes, original, size);
+    bytes[8] ^= 0xFF;
+    write_file(bytes, size);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_INVALID_FORMAT);
+
+    // A string pointing out of the pool opens but is caught when read
+    // (the header stores the offset of the key column at byte 64)
+    uint64_t keys_offset;
+    memcpy(&keys_offset, original + 64, sizeof(keys_offset));
+    assert(keys_offset < size);
+    memcpy(bytes, original, size);
+    memset(bytes + keys_offset, 0x7F, 8);
+    write_file(bytes, size);
+    const void *element;
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_at(snapshot, 0, &element, NULL) == DSC_ERROR_INVALID_FORMAT);
+    assert(dsc_snapshot_at(snapshot, 1, &element, NULL) == DSC_ERROR_OK);
+    assert(strcmp(element, "second") == 0);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // The original still opens
+    write_file(original, size);
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+}
+
+static void test_dsc_snapshot_resave(void) {
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+    for (int i = 0; i < 100000; ++i) {
+        assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_save(vector, path) == DSC_ERROR_OK);
+
+    DSCSnapshot *snapshot;
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+
+    // Saving a much smaller vector over the path leaves the open snapshot
+    // reading the file it mapped
+    assert(dsc_vector_clear(vector) == DSC_ERROR_OK);
+    int value = -1;
+    assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+    assert(dsc_vector_save(vector, path) == DSC_ERROR_OK);
+
+    const void *element;
+    for (size_t i = 0; i < 100000; ++i) {
+        assert(dsc_snapshot_at(snapshot, i, &element, NULL) == DSC_ERROR_OK);
+        assert(*(const int *) element == (int) i);
+    }
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // No temporary file is left behind
+    char temp_path[sizeof(path) + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    assert(access(temp_path, F_OK) != 0);
+
+    DSCSnapshotInfo info;
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK && info.count == 1);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    // A save that fails, here because the temporary file cannot be created,
+    // keeps the last good snapshot
+    assert(mkdir(temp_path, 0700) == 0);
+    assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+    assert(dsc_vector_save(vector, path) == DSC_ERROR_IO);
+    assert(rmdir(temp_path) == 0);
+
+    assert(dsc_snapshot_open(&snapshot, path) == DSC_ERROR_OK);
+    assert(dsc_snapshot_info(snapshot, &info) == DSC_ERROR_OK && info.count == 1);
+    assert(dsc_snapshot_close(snapshot) == DSC_ERROR_OK);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    make_path();
+
+    test_dsc_snapshot_sequences();
+    test_dsc_snapshot_set_map();
+    test_dsc_snapshot_invalid();
+    test_dsc_snapshot_resave();
+
+    unlink(path);
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -16,12 +16,13 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <assert.h>
 #include <string.h>
 
 #include "../include/dsc_stack.h"
 
-void dsc_stack_init_deinit(void) {
+void test_dsc_stack_init_deinit(void) {
     DSCStack *stack;
     assert(dsc_stack_init(NULL, DSC_TYPE_BOOL) == DSC_ERROR_INVALID_ARGUMENT);
     assert(dsc_stack_init(NULL, DSC_TYPE_CHAR) == DSC_ERROR_INVALID_ARGUMENT);
@@ -73,6 +74,140 @@ void test_dsc_stack_pop(void) {
 
 }
 
+void test_dsc_stack_growth(void) {
+    DSCStack *stack;
+    size_t capacity;
+    assert(dsc_stack_init(&stack, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    DSCGrowthPolicy policy = DSC_GROWTH_POLICY_DEFAULT;
+    policy.shrink_ratio = DSC_GROWTH_SHRINK_RATIO;
+    assert(dsc_stack_set_growth(stack, &policy) == DSC_ERROR_OK);
+
+    char *value = "burst";
+    for (int i = 0; i < 10000; ++i) {
+        assert(dsc_stack_push(stack, &value) == DSC_ERROR_OK);
+    }
+
+    size_t peak;
+    assert(dsc_stack_capacity(stack, &peak) == DSC_ERROR_OK);
+    assert(peak >= 10000);
+
+    char *result;
+    for (int i = 0; i < 10000; ++i) {
+        assert(dsc_stack_pop(stack, &result) == DSC_ERROR_OK);
+        assert(strcmp(result, value) == 0);
+        free(result);
+    }
+
+    // Draining the stack hands the burst capacity back
+    assert(dsc_stack_capacity(stack, &capacity) == DSC_ERROR_OK);
+    assert(capacity == DSC_STACK_INITIAL_CAPACITY);
+
+    assert(dsc_stack_push(stack, &value) == DSC_ERROR_OK);
+    assert(dsc_stack_shrink_to_fit(stack) == DSC_ERROR_OK);
+    assert(dsc_stack_capacity(stack, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 1);
+
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    double position[3];
+} Particle;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_stack_bytes(void) {
+    DSCStack *stack;
+    DSCElementType particle = {sizeof(Particle), NULL, NULL, NULL, NULL};
+
+    assert(dsc_stack_init_bytes(&stack, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_stack_init(&stack, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_stack_init_bytes(&stack, &particle, NULL) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 50; ++i) {
+        Particle p = {i, {i * 1.0, 0.0, -i * 1.0}};
+        assert(dsc_stack_push(stack, &p) == DSC_ERROR_OK);
+    }
+
+    Particle p;
+    for (int i = 49; i >= 0; --i) {
+        assert(dsc_stack_top(stack, &p) == DSC_ERROR_OK && p.id == i);
+        assert(dsc_stack_pop(stack, &p) == DSC_ERROR_OK);
+        assert(p.id == i && p.position[2] == -i * 1.0);
+    }
+
+    bool empty;
+    assert(dsc_stack_empty(stack, &empty) == DSC_ERROR_OK && empty);
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+    assert(dsc_stack_init_bytes(&stack, &named, NULL) == DSC_ERROR_OK);
+
+    Named n = {7, "linus"};
+    assert(dsc_stack_push(stack, &n) == DSC_ERROR_OK);
+    assert(dsc_stack_push(stack, &n) == DSC_ERROR_OK);
+
+    Named out;
+    assert(dsc_stack_top(stack, &out) == DSC_ERROR_OK);
+    assert(strcmp(out.name, "linus") == 0 && out.name != n.name);
+    named_destroy(&out);
+
+    assert(dsc_stack_pop(stack, &out) == DSC_ERROR_OK && named_live == 2);
+    named_destroy(&out);
+
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+void test_dsc_stack_move_swap(void) {
+    DSCStack *stack;
+    DSCStack *other;
+    assert(dsc_stack_init(&stack, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_stack_init(&other, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *string = strdup("moved");
+    assert(dsc_stack_push_move(stack, &string) == DSC_ERROR_OK);
+    assert(dsc_stack_swap(stack, other) == DSC_ERROR_OK);
+
+    bool empty;
+    assert(dsc_stack_empty(stack, &empty) == DSC_ERROR_OK && empty);
+
+    char *result;
+    assert(dsc_stack_pop(other, &result) == DSC_ERROR_OK);
+    assert(result == string);
+    free(result);
+
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+    assert(dsc_stack_deinit(other) == DSC_ERROR_OK);
+}
+
 int main(void) {
     test_dsc_stack_init_deinit();
     test_dsc_stack_size();
@@ -81,6 +216,9 @@ int main(void) {
     test_dsc_stack_top();
     test_dsc_stack_push();
     test_dsc_stack_pop();
+    test_dsc_stack_growth();
+    test_dsc_stack_bytes();
+    test_dsc_stack_move_swap();
 
     printf("All tests passed!\n");
 
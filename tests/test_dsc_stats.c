@@ -0,0 +1,176 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/dsc_list.h"
+#include "../include/dsc_map.h"
+#include "../include/dsc_queue.h"
+#include "../include/dsc_set.h"
+#include "../include/dsc_stack.h"
+#include "../include/dsc_vector.h"
+
+#define ITEMS 5000
+
+static size_t probe_total(const DSCStats *stats) {
+    size_t total = 0;
+    for (size_t i = 0; i < DSC_STATS_PROBE_BUCKETS; ++i) {
+        total += stats->probes[i];
+    }
+
+    return total;
+}
+
+static void assert_disabled(const DSCStats *stats) {
+    assert(!stats->enabled);
+    assert(stats->allocations == 0 && stats->allocated_bytes == 0);
+    assert(stats->reallocs == 0 && stats->rehashes == 0 && stats->rehash_ns == 0);
+    assert(probe_total(stats) == 0);
+    assert(stats->max_probe == 0 && stats->max_chain == 0);
+}
+
+static void test_dsc_stats_sequences(void) {
+    DSCStats stats;
+
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_vector_stats(NULL, &stats) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_stats(vector, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    for (int i = 0; i < ITEMS; ++i) {
+        assert(dsc_vector_push_back(vector, "element") == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_stats(vector, &stats) == DSC_ERROR_OK);
+    if (!stats.enabled) {
+        assert_disabled(&stats);
+    } else {
+        // One copy per string, plus the buffer and its growths
+        assert(stats.reallocs > 0);
+        assert(stats.allocations >= ITEMS + stats.reallocs);
+        assert(stats.allocated_bytes >= ITEMS * sizeof("element"));
+        assert(stats.rehashes == 0 && probe_total(&stats) == 0);
+    }
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    DSCStack *stack;
+    assert(dsc_stack_init(&stack, DSC_TYPE_INT) == DSC_ERROR_OK);
+    for (int i = 0; i < ITEMS; ++i) {
+        assert(dsc_stack_push(stack, &i) == DSC_ERROR_OK);
+    }
+    assert(dsc_stack_stats(stack, &stats) == DSC_ERROR_OK);
+    assert(!stats.enabled || (stats.reallocs > 0 && stats.allocations > stats.reallocs));
+    assert(dsc_stack_deinit(stack) == DSC_ERROR_OK);
+
+    DSCQueue *queue;
+    assert(dsc_queue_init(&queue, DSC_TYPE_INT) == DSC_ERROR_OK);
+    for (int i = 0; i < ITEMS; ++i) {
+        assert(dsc_queue_push(queue, &i) == DSC_ERROR_OK);
+    }
+    assert(dsc_queue_stats(queue, &stats) == DSC_ERROR_OK);
+    assert(!stats.enabled || (stats.reallocs > 0 && stats.allocations > stats.reallocs));
+    assert(dsc_queue_deinit(queue) == DSC_ERROR_OK);
+
+    DSCList *list = dsc_list_init(DSC_TYPE_INT);
+    assert(list != NULL);
+    for (int i = 0; i < ITEMS; ++i) {
+        assert(dsc_list_push_back(list, &i) == DSC_ERROR_OK);
+    }
+    assert(dsc_list_stats(list, &stats) == DSC_ERROR_OK);
+    assert(!stats.enabled || (stats.allocations > 0 && stats.reallocs == 0));
+    assert(dsc_list_deinit(list) == DSC_ERROR_OK);
+}
+
+static void test_dsc_stats_hashed(void) {
+    DSCStats stats;
+
+    DSCMapBackend backends[] = {DSC_MAP_BACKEND_CHAINED, DSC_MAP_BACKEND_OPEN,
+                                DSC_MAP_BACKEND_SHARDED};
+    for (size_t b = 0; b < 3; ++b) {
+        DSCMap *map;
+        assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_INT, backends[b]) ==
+               DSC_ERROR_OK);
+        for (int i = 0; i < ITEMS; ++i) {
+            assert(dsc_map_insert(map, &i, &i) == DSC_ERROR_OK);
+        }
+
+        assert(dsc_map_stats(map, &stats) == DSC_ERROR_OK);
+        if (!stats.enabled) {
+            assert_disabled(&stats);
+            assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+            continue;
+        }
+
+        size_t before = probe_total(&stats);
+        assert(before >= ITEMS);
+        assert(stats.rehashes > 0);
+        assert(stats.allocations > stats.rehashes);
+        assert(stats.max_probe >= 1);
+        if (backends[b] == DSC_MAP_BACKEND_CHAINED) {
+            assert(stats.max_chain >= 1 && stats.max_chain <= ITEMS);
+        } else {
+            assert(stats.max_chain == 0);
+        }
+
+        // Lookups probe too, hits and misses alike
+        for (int i = 0; i < 2 * ITEMS; ++i) {
+            bool found;
+            assert(dsc_map_contains(map, &i, &found) == DSC_ERROR_OK);
+            assert(found == (i < ITEMS));
+        }
+
+        assert(dsc_map_stats(map, &stats) == DSC_ERROR_OK);
+        assert(probe_total(&stats) == before + 2 * ITEMS);
+        assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+    }
+
+    // A set on an arena counts its allocations without ever freeing
+    DSCArena *arena;
+    DSCAllocator allocator;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCSet *set;
+    assert(dsc_set_init_allocator(&set, DSC_TYPE_STRING, &allocator) == DSC_ERROR_OK);
+    for (int i = 0; i < ITEMS; ++i) {
+        char buffer[32];
+        char *key = buffer;
+        snprintf(buffer, sizeof(buffer), "a long enough key %d", i);
+        assert(dsc_set_insert(set, &key) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_set_stats(set, &stats) == DSC_ERROR_OK);
+    if (stats.enabled) {
+        assert(stats.rehashes > 0);
+        assert(stats.allocations >= ITEMS);
+        assert(probe_total(&stats) >= ITEMS);
+    } else {
+        assert_disabled(&stats);
+    }
+    assert(dsc_set_clear(set) == DSC_ERROR_OK);
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_stats_sequences();
+    test_dsc_stats_hashed();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,339 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_map.h"
+#include "../include/dsc_set.h"
+#include "../include/dsc_thread_pool.h"
+#include "../include/dsc_vector.h"
+
+#define ITEMS 50000
+
+typedef struct {
+    int id;
+    char tag[12];
+} Record;
+
+static int record_compare(const void *lhs, const void *rhs) {
+    int a = ((const Record *) lhs)->id;
+    int b = ((const Record *) rhs)->id;
+    return (a > b) - (a < b);
+}
+
+static unsigned next_random(unsigned *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+/* Build pools of one and of four workers that split every input */
+static void make_pools(DSCThreadPool **pools) {
+    assert(dsc_thread_pool_init(&pools[0], 1) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_init(&pools[1], 4) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_set_cutoff(pools[0], 0) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_set_cutoff(pools[1], 0) == DSC_ERROR_OK);
+}
+
+void test_dsc_thread_pool_init_deinit(void) {
+    DSCThreadPool *pool;
+    size_t workers;
+
+    assert(dsc_thread_pool_init(NULL, 2) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_thread_pool_deinit(NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_thread_pool_workers(NULL, &workers) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_thread_pool_set_cutoff(NULL, 0) == DSC_ERROR_INVALID_ARGUMENT);
+
+    assert(dsc_thread_pool_init(&pool, 3) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_workers(pool, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_thread_pool_workers(pool, &workers) == DSC_ERROR_OK && workers == 3);
+    assert(dsc_thread_pool_deinit(pool) == DSC_ERROR_OK);
+
+    // One worker per CPU by default
+    assert(dsc_thread_pool_init(&pool, 0) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_workers(pool, &workers) == DSC_ERROR_OK && workers >= 1);
+    assert(dsc_thread_pool_deinit(pool) == DSC_ERROR_OK);
+}
+
+void test_dsc_thread_pool_sort(void) {
+    DSCThreadPool *pools[2];
+    make_pools(pools);
+
+    assert(dsc_vector_parallel_sort(NULL, pools[1]) == DSC_ERROR_INVALID_ARGUMENT);
+
+    unsigned state = 7;
+    const size_t sizes[] = {0, 3, 100, ITEMS};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (int p = -1; p < 2; ++p) {
+            DSCThreadPool *pool = p < 0 ? NULL : pools[p];
+            DSCVector *ints, *doubles, *strings, *records;
+            assert(dsc_vector_init(&ints, DSC_TYPE_INT) == DSC_ERROR_OK);
+            assert(dsc_vector_init(&doubles, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+            assert(dsc_vector_init(&strings, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+            DSCElementType record = {sizeof(Record), NULL, record_compare, NULL, NULL};
+            assert(dsc_vector_init_bytes(&records, &record, NULL) == DSC_ERROR_OK);
+
+            for (size_t i = 0; i < sizes[s]; ++i) {
+                // Few distinct values in the first half, so buckets repeat
+                int value = i < sizes[s] / 2 ? (int) (next_random(&state) % 16)
+                                             : (int) next_random(&state) - (1 << 22);
+                double d = i % 1000 == 3 ? NAN : value * 0.25;
+                char word[16];
+                snprintf(word, sizeof(word), "w%07u", next_random(&state) % 100000);
+                Record r = {value, "x"};
+
+                assert(dsc_vector_push_back(ints, &value) == DSC_ERROR_OK);
+                assert(dsc_vector_push_back(doubles, &d) == DSC_ERROR_OK);
+                assert(dsc_vector_push_back(strings, word) == DSC_ERROR_OK);
+                assert(dsc_vector_push_back(records, &r) == DSC_ERROR_OK);
+            }
+
+            assert(dsc_vector_parallel_sort(ints, pool) == DSC_ERROR_OK);
+            assert(dsc_vector_parallel_sort(doubles, pool) == DSC_ERROR_OK);
+            assert(dsc_vector_parallel_sort(strings, pool) == DSC_ERROR_OK);
+            assert(dsc_vector_parallel_sort(records, pool) == DSC_ERROR_OK);
+
+            int *int_data;
+            double *double_data;
+            char **string_data;
+            Record *record_data;
+            assert(dsc_vector_data(ints, (void **) &int_data) == DSC_ERROR_OK);
+            assert(dsc_vector_data(doubles, (void **) &double_data) == DSC_ERROR_OK);
+            assert(dsc_vector_data(strings, (void **) &string_data) == DSC_ERROR_OK);
+            assert(dsc_vector_data(records, (void **) &record_data) == DSC_ERROR_OK);
+
+            size_t nans = (sizes[s] + 996) / 1000;
+            for (size_t i = 1; i < sizes[s]; ++i) {
+                assert(int_data[i - 1] <= int_data[i]);
+                assert(strcmp(string_data[i - 1], string_data[i]) <= 0);
+                assert(record_data[i - 1].id <= record_data[i].id);
+                assert(record_data[i].id == int_data[i]);
+                assert(!isnan(double_data[i]) == (i < sizes[s] - nans));
+                assert(isnan(double_data[i]) || double_data[i - 1] <= double_data[i]);
+            }
+
+            assert(dsc_vector_deinit(ints) == DSC_ERROR_OK);
+            assert(dsc_vector_deinit(doubles) == DSC_ERROR_OK);
+            assert(dsc_vector_deinit(strings) == DSC_ERROR_OK);
+            assert(dsc_vector_deinit(records) == DSC_ERROR_OK);
+        }
+    }
+
+    assert(dsc_thread_pool_deinit(pools[0]) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_deinit(pools[1]) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    atomic_llong sum;
+    atomic_size_t visited;
+} Tally;
+
+static bool tally_visit(const void *element, void *context) {
+    Tally *tally = context;
+    atomic_fetch_add(&tally->sum, *(const int *) element);
+    atomic_fetch_add(&tally->visited, 1);
+    return true;
+}
+
+static bool tally_until_negative(const void *element, void *context) {
+    Tally *tally = context;
+    atomic_fetch_add(&tally->visited, 1);
+    return *(const int *) element >= 0;
+}
+
+/* An order-sensitive fold: a polynomial hash over the elements */
+typedef struct {
+    uint64_t hash;
+    uint64_t power;
+} Fold;
+
+static void fold_reduce(void *accumulator, const void *element, void *context) {
+    Fold *fold = accumulator;
+    (void) context;
+    fold->hash = fold->hash * 31 + (uint64_t) *(const int *) element;
+    fold->power *= 31;
+}
+
+static void fold_combine(void *accumulator, const void *partial, void *context) {
+    Fold *fold = accumulator;
+    const Fold *next = partial;
+    (void) context;
+    fold->hash = fold->hash * next->power + next->hash;
+    fold->power *= next->power;
+}
+
+void test_dsc_thread_pool_for_each_reduce(void) {
+    DSCThreadPool *pools[2];
+    make_pools(pools);
+
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    long long sum = 0;
+    Fold expected = {0, 1};
+    for (int i = 0; i < ITEMS; ++i) {
+        int value = i % 1000;
+        assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+        sum += value;
+        fold_reduce(&expected, &value, NULL);
+    }
+
+    assert(dsc_vector_parallel_for_each(NULL, pools[1], tally_visit, NULL) ==
+           DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_parallel_for_each(vector, pools[1], NULL, NULL) ==
+           DSC_ERROR_INVALID_ARGUMENT);
+
+    Fold fold = {0, 1};
+    assert(dsc_vector_parallel_reduce(vector, pools[1], fold_reduce, NULL, NULL, &fold,
+                                      sizeof(fold)) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_parallel_reduce(vector, pools[1], fold_reduce, fold_combine, NULL, &fold,
+                                      0) == DSC_ERROR_INVALID_ARGUMENT);
+
+    for (int p = -1; p < 2; ++p) {
+        DSCThreadPool *pool = p < 0 ? NULL : pools[p];
+
+        Tally tally = {0, 0};
+        assert(dsc_vector_parallel_for_each(vector, pool, tally_visit, &tally) == DSC_ERROR_OK);
+        assert(atomic_load(&tally.sum) == sum && atomic_load(&tally.visited) == ITEMS);
+
+        fold.hash = 0;
+        fold.power = 1;
+        assert(dsc_vector_parallel_reduce(vector, pool, fold_reduce, fold_combine, NULL, &fold,
+                                          sizeof(fold)) == DSC_ERROR_OK);
+        assert(fold.hash == expected.hash && fold.power == expected.power);
+    }
+
+    // A visitor returning false stops the walk well before the end
+    int stop = -1;
+    assert(dsc_vector_insert(vector, &stop, 10) == DSC_ERROR_OK);
+
+    Tally tally = {0, 0};
+    assert(dsc_vector_parallel_for_each(vector, NULL, tally_until_negative, &tally) ==
+           DSC_ERROR_OK);
+    assert(atomic_load(&tally.visited) == 11);
+
+    atomic_store(&tally.visited, 0);
+    assert(dsc_vector_parallel_for_each(vector, pools[1], tally_until_negative, &tally) ==
+           DSC_ERROR_OK);
+    assert(atomic_load(&tally.visited) < ITEMS);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_deinit(pools[0]) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_deinit(pools[1]) == DSC_ERROR_OK);
+}
+
+void test_dsc_thread_pool_bulk_build(void) {
+    DSCThreadPool *pools[2];
+    make_pools(pools);
+
+    // Vectors of keys with repeats, and values
+    DSCVector *keys, *values, *words;
+    assert(dsc_vector_init(&keys, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_vector_init(&values, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+    assert(dsc_vector_init(&words, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    for (int i = 0; i < ITEMS; ++i) {
+        int key = (i * 7) % (ITEMS / 2);
+        double value = key * 0.5;
+        char word[32];
+        snprintf(word, sizeof(word), i % 2 ? "key-%d" : "a-much-longer-key-%d", i % 10000);
+
+        assert(dsc_vector_push_back(keys, &key) == DSC_ERROR_OK);
+        assert(dsc_vector_push_back(values, &value) == DSC_ERROR_OK);
+        assert(dsc_vector_push_back(words, word) == DSC_ERROR_OK);
+    }
+
+    void *key_data, *value_data, *word_data;
+    assert(dsc_vector_data(keys, &key_data) == DSC_ERROR_OK);
+    assert(dsc_vector_data(values, &value_data) == DSC_ERROR_OK);
+    assert(dsc_vector_data(words, &word_data) == DSC_ERROR_OK);
+
+    for (int p = -1; p < 2; ++p) {
+        DSCThreadPool *pool = p < 0 ? NULL : pools[p];
+
+        DSCSet *set;
+        assert(dsc_set_init(&set, DSC_TYPE_STRING) == DSC_ERROR_OK);
+        assert(dsc_set_parallel_insert_range(NULL, word_data, ITEMS, pool) ==
+               DSC_ERROR_INVALID_ARGUMENT);
+        assert(dsc_set_parallel_insert_range(set, word_data, ITEMS, pool) == DSC_ERROR_OK);
+
+        size_t size;
+        bool present;
+        assert(dsc_set_size(set, &size) == DSC_ERROR_OK && size == 10000);
+
+        char *probe = "key-9999";
+        assert(dsc_set_contains(set, &probe, &present) == DSC_ERROR_OK && present);
+        probe = "a-much-longer-key-0";
+        assert(dsc_set_contains(set, &probe, &present) == DSC_ERROR_OK && present);
+        probe = "key-0";
+        assert(dsc_set_contains(set, &probe, &present) == DSC_ERROR_OK && !present);
+        assert(dsc_set_deinit(set) == DSC_ERROR_OK);
+
+        const DSCMapBackend backends[] = {DSC_MAP_BACKEND_CHAINED, DSC_MAP_BACKEND_OPEN,
+                                          DSC_MAP_BACKEND_SHARDED};
+
+        for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); ++b) {
+            DSCMap *map;
+            assert(dsc_map_init_backend(&map, DSC_TYPE_INT, DSC_TYPE_DOUBLE, backends[b]) ==
+                   DSC_ERROR_OK);
+
+            // Keys already present keep their value
+            int first = 0;
+            double kept = -1.0;
+            assert(dsc_map_insert(map, &first, &kept) == DSC_ERROR_OK);
+
+            assert(dsc_map_parallel_insert_range(map, key_data, NULL, ITEMS, pool) ==
+                   DSC_ERROR_INVALID_ARGUMENT);
+            assert(dsc_map_parallel_insert_range(map, key_data, value_data, ITEMS, pool) ==
+                   DSC_ERROR_OK);
+
+            assert(dsc_map_size(map, &size) == DSC_ERROR_OK && size == ITEMS / 2);
+
+            for (int key = 0; key < ITEMS / 2; ++key) {
+                double value;
+                assert(dsc_map_get(map, &key, &value) == DSC_ERROR_OK);
+                assert(value == (key == 0 ? -1.0 : key * 0.5));
+            }
+
+            assert(dsc_map_deinit(map) == DSC_ERROR_OK);
+        }
+    }
+
+    assert(dsc_vector_deinit(keys) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(values) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(words) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_deinit(pools[0]) == DSC_ERROR_OK);
+    assert(dsc_thread_pool_deinit(pools[1]) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_thread_pool_init_deinit();
+    test_dsc_thread_pool_sort();
+    test_dsc_thread_pool_for_each_reduce();
+    test_dsc_thread_pool_bulk_build();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_typed.h"
+
+typedef struct Point {
+    double x;
+    double y;
+} Point;
+
+/* Deliberately weak so that keys collide and probe chains form */
+static uint64_t weak_hash(uint64_t key, uint64_t seed) {
+    (void) seed;
+    return key % 7;
+}
+
+DSC_VECTOR_DEFINE(i32, int32_t)
+DSC_VECTOR_DEFINE(point, Point)
+DSC_MAP_DEFINE(u64_f64, uint64_t, double, dsc_hash_u64, dsc_typed_equal)
+DSC_MAP_DEFINE(str_int, const char *, int, dsc_typed_hash_string, dsc_typed_equal_string)
+DSC_MAP_DEFINE(weak, uint64_t, uint64_t, weak_hash, dsc_typed_equal)
+
+void test_dsc_typed_vector(void) {
+    DSCVector_i32 vector;
+    assert(dsc_vector_i32_init(NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_i32_init(&vector, NULL) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_empty(&vector));
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        assert(dsc_vector_i32_push_back(&vector, i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_i32_size(&vector) == 1000);
+
+    int64_t sum = 0;
+    const int32_t *data = dsc_vector_i32_data(&vector);
+    for (size_t i = 0; i < dsc_vector_i32_size(&vector); ++i) {
+        sum += data[i];
+    }
+    assert(sum == 999 * 1000 / 2);
+
+    int32_t value;
+    assert(dsc_vector_i32_at(&vector, 1000, &value) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_vector_i32_insert(&vector, 0, -1) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_at(&vector, 0, &value) == DSC_ERROR_OK);
+    assert(value == -1);
+    assert(dsc_vector_i32_at(&vector, 1, &value) == DSC_ERROR_OK);
+    assert(value == 0);
+
+    assert(dsc_vector_i32_erase(&vector, 0) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_set(&vector, 0, 7) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_pop_back(&vector, &value) == DSC_ERROR_OK);
+    assert(value == 999);
+    assert(dsc_vector_i32_at(&vector, 0, &value) == DSC_ERROR_OK);
+    assert(value == 7);
+
+    assert(dsc_vector_i32_shrink_to_fit(&vector) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_capacity(&vector) == 999);
+
+    assert(dsc_vector_i32_clear(&vector) == DSC_ERROR_OK);
+    assert(dsc_vector_i32_pop_back(&vector, &value) == DSC_ERROR_EMPTY_CONTAINER);
+
+    assert(dsc_vector_i32_deinit(&vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_typed_vector_struct(void) {
+    DSCArena *arena;
+    DSCAllocator allocator;
+    assert(dsc_arena_init(&arena, 0) == DSC_ERROR_OK);
+    assert(dsc_arena_allocator(arena, &allocator) == DSC_ERROR_OK);
+
+    DSCVector_point vector;
+    assert(dsc_vector_point_init(&vector, &allocator) == DSC_ERROR_OK);
+    assert(dsc_vector_point_reserve(&vector, 100) == DSC_ERROR_OK);
+    assert(dsc_vector_point_capacity(&vector) >= 100);
+
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_vector_point_push_back(&vector, (Point) {i, -i}) == DSC_ERROR_OK);
+    }
+
+    Point point;
+    assert(dsc_vector_point_at(&vector, 42, &point) == DSC_ERROR_OK);
+    assert(point.x == 42.0 && point.y == -42.0);
+
+    assert(dsc_arena_deinit(arena) == DSC_ERROR_OK);
+}
+
+void test_dsc_typed_map(void) {
+    DSCMap_u64_f64 map;
+    assert(dsc_map_u64_f64_init(&map, NULL) == DSC_ERROR_OK);
+    assert(dsc_map_u64_f64_find(&map, 1) == NULL);
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        assert(dsc_map_u64_f64_insert(&map, i, (double) i / 2) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_map_u64_f64_insert(&map, 5, 0.0) == DSC_ERROR_ALREADY_EXISTS);
+    assert(dsc_map_u64_f64_size(&map) == 10000);
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        double value;
+        assert(dsc_map_u64_f64_get(&map, i, &value) == DSC_ERROR_OK);
+        assert(value == (double) i / 2);
+    }
+
+    double *slot = dsc_map_u64_f64_find(&map, 10);
+    assert(slot != NULL);
+    *slot = -1.0;
+
+    double value;
+    assert(dsc_map_u64_f64_get(&map, 10, &value) == DSC_ERROR_OK);
+    assert(value == -1.0);
+
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        assert(dsc_map_u64_f64_erase(&map, i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_map_u64_f64_erase(&map, 0) == DSC_ERROR_NOT_FOUND);
+
+    bool contains;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        assert(dsc_map_u64_f64_contains(&map, i, &contains) == DSC_ERROR_OK);
+        assert(contains == (i % 2 == 1));
+    }
+
+    assert(dsc_map_u64_f64_clear(&map) == DSC_ERROR_OK);
+    assert(dsc_map_u64_f64_empty(&map));
+    assert(dsc_map_u64_f64_get(&map, 1, &value) == DSC_ERROR_NOT_FOUND);
+
+    assert(dsc_map_u64_f64_deinit(&map) == DSC_ERROR_OK);
+}
+
+void test_dsc_typed_map_collisions(void) {
+    DSCMap_weak map;
+    assert(dsc_map_weak_init(&map, NULL) == DSC_ERROR_OK);
+    assert(dsc_map_weak_reserve(&map, 100) == DSC_ERROR_OK);
+
+    size_t capacity = map.capacity;
+
+    // Churn through far more keys than fit so tombstones must be reclaimed
+    for (uint64_t round = 0; round < 50; ++round) {
+        for (uint64_t i = 0; i < 60; ++i) {
+            assert(dsc_map_weak_insert(&map, round * 1000 + i, i) == DSC_ERROR_OK);
+        }
+
+        for (uint64_t i = 0; i < 60; ++i) {
+            uint64_t *value = dsc_map_weak_find(&map, round * 1000 + i);
+            assert(value != NULL && *value == i);
+            assert(dsc_map_weak_erase(&map, round * 1000 + i) == DSC_ERROR_OK);
+        }
+    }
+
+    assert(dsc_map_weak_size(&map) == 0);
+    assert(map.capacity == capacity);
+
+    assert(dsc_map_weak_deinit(&map) == DSC_ERROR_OK);
+}
+
+void test_dsc_typed_map_strings(void) {
+    DSCMap_str_int map;
+    assert(dsc_map_str_int_init(&map, NULL) == DSC_ERROR_OK);
+
+    assert(dsc_map_str_int_insert(&map, "one", 1) == DSC_ERROR_OK);
+    assert(dsc_map_str_int_insert(&map, "two", 2) == DSC_ERROR_OK);
+
+    // Keys are compared by content, not by address
+    char buffer[] = "two";
+    int value;
+    assert(dsc_map_str_int_get(&map, buffer, &value) == DSC_ERROR_OK);
+    assert(value == 2);
+    assert(dsc_map_str_int_get(&map, "three", &value) == DSC_ERROR_NOT_FOUND);
+
+    assert(dsc_map_str_int_deinit(&map) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_typed_vector();
+    test_dsc_typed_vector_struct();
+    test_dsc_typed_map();
+    test_dsc_typed_map_collisions();
+    test_dsc_typed_map_strings();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}
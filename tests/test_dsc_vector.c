@@ -16,6 +16,9 @@
  */
 
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -129,19 +132,20 @@ void test_dsc_vector_capacity(void) {
         assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
     }
 
+    // The default policy grows by 1.5: 16, 24, 36, 54
     assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
-    assert(capacity == 2 * DSC_VECTOR_INITIAL_CAPACITY);
+    assert(capacity == 24);
 
     for (int i = 0; i <= 2 * DSC_VECTOR_INITIAL_CAPACITY; ++i) {
         assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
     }
 
     assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
-    assert(capacity == 4 * DSC_VECTOR_INITIAL_CAPACITY);
+    assert(capacity == 54);
 
     assert(dsc_vector_clear(vector) == DSC_ERROR_OK);
     assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
-    assert(capacity == 4 * DSC_VECTOR_INITIAL_CAPACITY);
+    assert(capacity == 54);
     
     assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
 }
@@ -194,9 +198,11 @@ void test_dsc_vector_front(void) {
     assert(dsc_vector_push_back(vector, &s) == DSC_ERROR_OK);
     assert(dsc_vector_front(vector, &front) == DSC_ERROR_OK);
     assert(strcmp(front, s) == 0);
+    free(front);
     assert(dsc_vector_push_back(vector, &t) == DSC_ERROR_OK);
     assert(dsc_vector_front(vector, &front) == DSC_ERROR_OK);
     assert(strcmp(front, s) == 0);
+    free(front);
 
     assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
 }
@@ -236,6 +242,704 @@ void test_dsc_vector_clear(void) {
     assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK);
     assert(size == 0);
     assert(dsc_vector_at(vector, 0, &value) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_vector_reserve_append_range(void) {
+    DSCVector *vector;
+    size_t capacity;
+    size_t size;
+
+    assert(dsc_vector_init(&vector, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+    assert(dsc_vector_reserve(vector, 1000) == DSC_ERROR_OK);
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 1000);
+
+    // Reserving less than the current capacity never shrinks
+    assert(dsc_vector_reserve(vector, 10) == DSC_ERROR_OK);
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 1000);
+
+    double values[1500];
+    for (int i = 0; i < 1500; ++i) {
+        values[i] = i * 1.5;
+    }
+
+    assert(dsc_vector_append_range(vector, values, 700) == DSC_ERROR_OK);
+    assert(dsc_vector_append_range(vector, values + 700, 800) == DSC_ERROR_OK);
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK);
+    assert(size == 1500);
+
+    double value;
+    for (int i = 0; i < 1500; ++i) {
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK);
+        assert(value == i * 1.5);
+    }
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *strings[] = {"alpha", "beta", "gamma"};
+    assert(dsc_vector_append_range(vector, strings, 3) == DSC_ERROR_OK);
+
+    char *result;
+    assert(dsc_vector_at(vector, 2, &result) == DSC_ERROR_OK);
+    assert(strcmp(result, "gamma") == 0);
+    free(result);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_vector_growth(void) {
+    DSCVector *vector;
+    size_t capacity;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    DSCGrowthPolicy policy = {2.0, 0.6, false};
+    assert(dsc_vector_set_growth(vector, &policy) == DSC_ERROR_INVALID_ARGUMENT);
+    policy.factor = 1.0;
+    policy.shrink_ratio = 0.0;
+    assert(dsc_vector_set_growth(vector, &policy) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_set_growth(vector, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    policy.factor = 2.0;
+    policy.shrink_ratio = 0.25;
+    assert(dsc_vector_set_growth(vector, &policy) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 1024; ++i) {
+        assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 1024);
+
+    // Popping below a quarter of the capacity shrinks to twice the size
+    int value;
+    for (int i = 0; i < 1024 - 255; ++i) {
+        assert(dsc_vector_pop_back(vector, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 510);
+
+    // Oscillating around the boundary does not reallocate again
+    assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+    assert(dsc_vector_pop_back(vector, &value) == DSC_ERROR_OK);
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 510);
+
+    for (int i = 0; i < 255; ++i) {
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK);
+        assert(value == i);
+    }
+
+    assert(dsc_vector_shrink_to_fit(vector) == DSC_ERROR_OK);
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 255);
+
+    assert(dsc_vector_clear(vector) == DSC_ERROR_OK);
+    assert(dsc_vector_shrink_to_fit(vector) == DSC_ERROR_OK);
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 0);
+    assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Huge-page rounding fills up whole 2 MiB pages
+    assert(dsc_vector_init(&vector, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+    policy = DSC_GROWTH_POLICY_DEFAULT;
+    policy.huge_pages = true;
+    assert(dsc_vector_set_growth(vector, &policy) == DSC_ERROR_OK);
+    assert(dsc_vector_reserve(vector, 300000) == DSC_ERROR_OK);
+
+    double d = 0.0;
+    for (size_t i = 0; i <= 300000; ++i) {
+        assert(dsc_vector_push_back(vector, &d) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_capacity(vector, &capacity) == DSC_ERROR_OK);
+    assert(capacity * sizeof(double) % DSC_GROWTH_HUGE_PAGE_SIZE == 0);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_vector_at_view(void) {
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char *value = "view";
+    assert(dsc_vector_push_back(vector, value) == DSC_ERROR_OK);
+
+    DSCStringView view;
+    assert(dsc_vector_at_view(vector, 0, &view) == DSC_ERROR_OK);
+    assert(view.length == 4);
+    assert(memcmp(view.data, "view", 4) == 0);
+    assert(dsc_vector_at_view(vector, 1, &view) == DSC_ERROR_OUT_OF_RANGE);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_vector_at_view(vector, 0, &view) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+typedef struct {
+    int id;
+    double position[3];
+} Particle;
+
+typedef struct {
+    int id;
+    char *name;
+} Named;
+
+static int named_live = 0;
+
+static DSCError named_copy(void *dest, const void *src) {
+    const Named *from = src;
+    Named *to = dest;
+
+    to->name = strdup(from->name);
+    if (to->name == NULL) {
+        return DSC_ERROR_OUT_OF_MEMORY;
+    }
+
+    to->id = from->id;
+    named_live++;
+
+    return DSC_ERROR_OK;
+}
+
+static void named_destroy(void *record) {
+    free(((Named *) record)->name);
+    named_live--;
+}
+
+void test_dsc_vector_bytes(void) {
+    DSCVector *vector;
+    DSCElementType particle = {sizeof(Particle), NULL, NULL, NULL, NULL};
+
+    assert(dsc_vector_init_bytes(NULL, &particle, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_init_bytes(&vector, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_init(&vector, DSC_TYPE_BYTES) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_vector_init_bytes(&vector, &particle, NULL) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        Particle p = {i, {i * 0.5, i * 1.5, i * 2.5}};
+        assert(dsc_vector_push_back(vector, &p) == DSC_ERROR_OK);
+    }
+
+    Particle p;
+    assert(dsc_vector_at(vector, 42, &p) == DSC_ERROR_OK);
+    assert(p.id == 42 && p.position[2] == 42 * 2.5);
+
+    Particle first = {-1, {0.0, 0.0, 0.0}};
+    assert(dsc_vector_insert(vector, &first, 0) == DSC_ERROR_OK);
+    assert(dsc_vector_front(vector, &p) == DSC_ERROR_OK && p.id == -1);
+    assert(dsc_vector_at(vector, 43, &p) == DSC_ERROR_OK && p.id == 42);
+    assert(dsc_vector_erase(vector, 0) == DSC_ERROR_OK);
+
+    assert(dsc_vector_pop_back(vector, &p) == DSC_ERROR_OK && p.id == 99);
+    assert(dsc_vector_back(vector, &p) == DSC_ERROR_OK && p.id == 98);
+
+    Particle range[3] = {{100, {0}}, {101, {0}}, {102, {0}}};
+    assert(dsc_vector_append_range(vector, range, 3) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 102);
+    assert(dsc_vector_at(vector, 101, &p) == DSC_ERROR_OK && p.id == 102);
+
+    DSCStringView view;
+    assert(dsc_vector_at_view(vector, 0, &view) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Records owning memory are copied in and out and destroyed when dropped
+    DSCElementType named = {sizeof(Named), NULL, NULL, named_copy, named_destroy};
+    assert(dsc_vector_init_bytes(&vector, &named, NULL) == DSC_ERROR_OK);
+
+    const char *names[] = {"ada", "grace", "barbara"};
+    for (int i = 0; i < 3; ++i) {
+        Named n = {i, (char *) names[i]};
+        assert(dsc_vector_push_back(vector, &n) == DSC_ERROR_OK);
+    }
+    assert(named_live == 3);
+
+    Named out;
+    assert(dsc_vector_at(vector, 1, &out) == DSC_ERROR_OK);
+    assert(out.id == 1 && strcmp(out.name, "grace") == 0);
+    assert(named_live == 4);
+    named_destroy(&out);
+
+    // Popping moves the record out, the caller now owns it
+    assert(dsc_vector_pop_back(vector, &out) == DSC_ERROR_OK);
+    assert(strcmp(out.name, "barbara") == 0 && named_live == 3);
+    named_destroy(&out);
+
+    assert(dsc_vector_erase(vector, 0) == DSC_ERROR_OK);
+    assert(named_live == 1);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+    assert(named_live == 0);
+}
+
+static bool sum_ints(const void *element, void *context) {
+    *(long *) context += *(const int *) element;
+    return true;
+}
+
+static bool stop_at_ten(const void *element, void *context) {
+    (*(int *) context)++;
+    return *(const int *) element < 10;
+}
+
+void test_dsc_vector_cursor(void) {
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    DSCVectorCursor cursor;
+    const void *element;
+    assert(dsc_vector_cursor_init(NULL, &cursor) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_cursor_init(vector, &cursor) == DSC_ERROR_OK);
+    assert(!dsc_vector_cursor_next(&cursor, &element));
+
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
+    }
+
+    // The cursor yields the vector's own slots, in order
+    assert(dsc_vector_cursor_init(vector, &cursor) == DSC_ERROR_OK);
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_vector_cursor_next(&cursor, &element));
+        assert(*(const int *) element == i);
+    }
+    assert(!dsc_vector_cursor_next(&cursor, &element));
+
+    long sum = 0;
+    assert(dsc_vector_for_each(vector, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_for_each(vector, sum_ints, &sum) == DSC_ERROR_OK);
+    assert(sum == 4950);
+
+    int visited = 0;
+    assert(dsc_vector_for_each(vector, stop_at_ten, &visited) == DSC_ERROR_OK);
+    assert(visited == 11);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Strings are yielded as their characters, without a copy
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_vector_push_back(vector, "first") == DSC_ERROR_OK);
+    assert(dsc_vector_push_back(vector, "second") == DSC_ERROR_OK);
+
+    DSCStringView view;
+    assert(dsc_vector_at_view(vector, 1, &view) == DSC_ERROR_OK);
+
+    assert(dsc_vector_cursor_init(vector, &cursor) == DSC_ERROR_OK);
+    assert(dsc_vector_cursor_next(&cursor, &element));
+    assert(strcmp(element, "first") == 0);
+    assert(dsc_vector_cursor_next(&cursor, &element));
+    assert(element == view.data);
+
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_vector_numeric(void) {
+    DSCVector *vector;
+
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    size_t count;
+    char *key = "x";
+    assert(dsc_vector_count(vector, &key, &count) == DSC_ERROR_INVALID_TYPE);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Every length from empty to several SIMD steps plus a tail, with the
+    // extremes and the needle moving around
+    for (int n = 0; n < 200; ++n) {
+        DSCVector *ints, *floats, *doubles;
+        assert(dsc_vector_init(&ints, DSC_TYPE_INT) == DSC_ERROR_OK);
+        assert(dsc_vector_init(&floats, DSC_TYPE_FLOAT) == DSC_ERROR_OK);
+        assert(dsc_vector_init(&doubles, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+        long long sum = 0;
+        int min = 0, max = 0;
+        size_t sevens = 0, first_seven = (size_t) n;
+
+        for (int i = 0; i < n; ++i) {
+            int value = (i * 37 + n) % 101 - 50;
+            if (i == n / 3) {
+                value = -1000 - n;
+            }
+            if (i == (n * 2) / 3 + 1 && i < n) {
+                value = 1000 + n;
+            }
+
+            float f = (float) value;
+            double d = value;
+            assert(dsc_vector_push_back(ints, &value) == DSC_ERROR_OK);
+            assert(dsc_vector_push_back(floats, &f) == DSC_ERROR_OK);
+            assert(dsc_vector_push_back(doubles, &d) == DSC_ERROR_OK);
+
+            sum += value;
+            min = i == 0 || value < min ? value : min;
+            max = i == 0 || value > max ? value : max;
+            if (value == 7) {
+                sevens++;
+                first_seven = first_seven < (size_t) i ? first_seven : (size_t) i;
+            }
+        }
+
+        int seven = 7;
+        float seven_f = 7;
+        double seven_d = 7;
+        size_t index;
+
+        assert(dsc_vector_count(ints, &seven, &count) == DSC_ERROR_OK && count == sevens);
+        assert(dsc_vector_count(floats, &seven_f, &count) == DSC_ERROR_OK && count == sevens);
+        assert(dsc_vector_count(doubles, &seven_d, &count) == DSC_ERROR_OK && count == sevens);
+
+        DSCError expected = sevens > 0 ? DSC_ERROR_OK : DSC_ERROR_NOT_FOUND;
+        assert(dsc_vector_find(ints, &seven, &index) == expected);
+        assert(sevens == 0 || index == first_seven);
+        assert(dsc_vector_find(floats, &seven_f, &index) == expected);
+        assert(sevens == 0 || index == first_seven);
+        assert(dsc_vector_find(doubles, &seven_d, &index) == expected);
+        assert(sevens == 0 || index == first_seven);
+
+        int64_t int_sum;
+        double float_sum, double_sum;
+        assert(dsc_vector_sum(ints, &int_sum) == DSC_ERROR_OK && int_sum == sum);
+        assert(dsc_vector_sum(floats, &float_sum) == DSC_ERROR_OK && float_sum == sum);
+        assert(dsc_vector_sum(doubles, &double_sum) == DSC_ERROR_OK && double_sum == sum);
+
+        int int_min, int_max;
+        float float_min, float_max;
+        double double_min, double_max;
+
+        if (n == 0) {
+            assert(dsc_vector_min(ints, &int_min) == DSC_ERROR_EMPTY_CONTAINER);
+            assert(dsc_vector_max(doubles, &double_max) == DSC_ERROR_EMPTY_CONTAINER);
+        } else {
+            assert(dsc_vector_min(ints, &int_min) == DSC_ERROR_OK && int_min == min);
+            assert(dsc_vector_max(ints, &int_max) == DSC_ERROR_OK && int_max == max);
+            assert(dsc_vector_min(floats, &float_min) == DSC_ERROR_OK && float_min == min);
+            assert(dsc_vector_max(floats, &float_max) == DSC_ERROR_OK && float_max == max);
+            assert(dsc_vector_min(doubles, &double_min) == DSC_ERROR_OK && double_min == min);
+            assert(dsc_vector_max(doubles, &double_max) == DSC_ERROR_OK && double_max == max);
+        }
+
+        assert(dsc_vector_deinit(ints) == DSC_ERROR_OK);
+        assert(dsc_vector_deinit(floats) == DSC_ERROR_OK);
+        assert(dsc_vector_deinit(doubles) == DSC_ERROR_OK);
+    }
+
+    // Sums of large ints do not overflow
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+    int big = INT_MAX;
+    for (int i = 0; i < 1000; ++i) {
+        assert(dsc_vector_push_back(vector, &big) == DSC_ERROR_OK);
+    }
+
+    int64_t total;
+    assert(dsc_vector_sum(vector, &total) == DSC_ERROR_OK);
+    assert(total == (int64_t) INT_MAX * 1000);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+static int particle_compare(const void *lhs, const void *rhs) {
+    int a = ((const Particle *) lhs)->id;
+    int b = ((const Particle *) rhs)->id;
+    return (a > b) - (a < b);
+}
+
+static unsigned sort_random(unsigned *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+void test_dsc_vector_sort(void) {
+    DSCVector *vector;
+    size_t index;
+
+    // Comparisons do not truncate fractions or overflow, and NaNs go last
+    double half = 0.5, fifth = 0.2, nan_d = NAN;
+    int int_min = INT_MIN;
+    DSCData data;
+    data.d = 0.2;
+    assert(dsc_compare(data, &half, DSC_TYPE_DOUBLE) < 0);
+    data.d = 0.5;
+    assert(dsc_compare(data, &fifth, DSC_TYPE_DOUBLE) > 0);
+    assert(dsc_compare(data, &half, DSC_TYPE_DOUBLE) == 0);
+    assert(dsc_compare(data, &nan_d, DSC_TYPE_DOUBLE) < 0);
+    data.d = NAN;
+    assert(dsc_compare(data, &half, DSC_TYPE_DOUBLE) > 0);
+    assert(dsc_compare(data, &nan_d, DSC_TYPE_DOUBLE) == 0);
+    data.i = INT_MAX;
+    assert(dsc_compare(data, &int_min, DSC_TYPE_INT) > 0);
+
+    assert(dsc_vector_sort(NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    // Sizes on both sides of the radix sort threshold, with duplicates, runs
+    // already in order and NaNs
+    const size_t sizes[] = {0, 1, 2, 17, 200, 511, 512, 5000};
+    unsigned state = 1;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        size_t n = sizes[s];
+        DSCVector *ints, *floats, *doubles;
+        assert(dsc_vector_init(&ints, DSC_TYPE_INT) == DSC_ERROR_OK);
+        assert(dsc_vector_init(&floats, DSC_TYPE_FLOAT) == DSC_ERROR_OK);
+        assert(dsc_vector_init(&doubles, DSC_TYPE_DOUBLE) == DSC_ERROR_OK);
+
+        for (size_t i = 0; i < n; ++i) {
+            int value = i < n / 4 ? (int) i : (int) (sort_random(&state) % 2001) - 1000;
+            if (i % 97 == 5) {
+                value = i % 2 ? INT_MIN : INT_MAX;
+            }
+
+            float f = i % 53 == 7 ? NAN : value / 4.0f;
+            double d = i % 53 == 7 ? -NAN : value / 8.0;
+            assert(dsc_vector_push_back(ints, &value) == DSC_ERROR_OK);
+            assert(dsc_vector_push_back(floats, &f) == DSC_ERROR_OK);
+            assert(dsc_vector_push_back(doubles, &d) == DSC_ERROR_OK);
+        }
+
+        assert(dsc_vector_sort(ints) == DSC_ERROR_OK);
+        assert(dsc_vector_sort(floats) == DSC_ERROR_OK);
+        assert(dsc_vector_sort(doubles) == DSC_ERROR_OK);
+
+        int previous = INT_MIN, current;
+        float previous_f = -INFINITY, current_f;
+        double previous_d = -INFINITY, current_d;
+        size_t nans = (n + 45) / 53;
+
+        for (size_t i = 0; i < n; ++i) {
+            assert(dsc_vector_at(ints, i, &current) == DSC_ERROR_OK);
+            assert(previous <= current);
+            previous = current;
+
+            assert(dsc_vector_at(floats, i, &current_f) == DSC_ERROR_OK);
+            assert(!isnan(current_f) == (i < n - nans));
+            assert(isnan(current_f) || previous_f <= current_f);
+            previous_f = current_f;
+
+            assert(dsc_vector_at(doubles, i, &current_d) == DSC_ERROR_OK);
+            assert(!isnan(current_d) == (i < n - nans));
+            assert(isnan(current_d) || previous_d <= current_d);
+            previous_d = current_d;
+        }
+
+        // Bounds bracket every copy of a value
+        if (n > 0) {
+            int probe;
+            assert(dsc_vector_at(ints, n / 2, &probe) == DSC_ERROR_OK);
+
+            size_t lower, upper;
+            assert(dsc_vector_lower_bound(ints, &probe, &lower) == DSC_ERROR_OK);
+            assert(dsc_vector_upper_bound(ints, &probe, &upper) == DSC_ERROR_OK);
+            assert(lower <= n / 2 && n / 2 < upper);
+            assert(dsc_vector_at(ints, lower, &current) == DSC_ERROR_OK && current == probe);
+            assert(lower == 0 || (dsc_vector_at(ints, lower - 1, &current) == DSC_ERROR_OK &&
+                                  current < probe));
+            assert(upper == n || (dsc_vector_at(ints, upper, &current) == DSC_ERROR_OK &&
+                                  current > probe));
+
+            double probe_d = NAN;
+            assert(dsc_vector_lower_bound(doubles, &probe_d, &lower) == DSC_ERROR_OK);
+            assert(lower == n - nans);
+        }
+
+        assert(dsc_vector_deinit(ints) == DSC_ERROR_OK);
+        assert(dsc_vector_deinit(floats) == DSC_ERROR_OK);
+        assert(dsc_vector_deinit(doubles) == DSC_ERROR_OK);
+    }
+
+    // Selection and partial sorting leave the right elements in front
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+    const int count = 1000;
+    for (int i = 0; i < count; ++i) {
+        int value = (i * 7919) % count;
+        assert(dsc_vector_push_back(vector, &value) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_nth_element(vector, count) == DSC_ERROR_OUT_OF_RANGE);
+    assert(dsc_vector_partial_sort(vector, count + 1) == DSC_ERROR_OUT_OF_RANGE);
+
+    int value;
+    assert(dsc_vector_nth_element(vector, 321) == DSC_ERROR_OK);
+    assert(dsc_vector_at(vector, 321, &value) == DSC_ERROR_OK && value == 321);
+    for (int i = 0; i < count; ++i) {
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK);
+        assert(i < 321 ? value < 321 : value >= 321);
+    }
+
+    assert(dsc_vector_partial_sort(vector, 0) == DSC_ERROR_OK);
+    assert(dsc_vector_partial_sort(vector, 50) == DSC_ERROR_OK);
+    for (int i = 0; i < 50; ++i) {
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK && value == i);
+    }
+
+    assert(dsc_vector_partial_sort(vector, count) == DSC_ERROR_OK);
+    for (int i = 0; i < count; ++i) {
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK && value == i);
+    }
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Strings sort by strcmp and are searched by their characters
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    const char *words[] = {"pear", "apple", "fig", "banana", "apple", "cherry"};
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+        assert(dsc_vector_push_back(vector, (void *) words[i]) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_sort(vector) == DSC_ERROR_OK);
+    const char *sorted[] = {"apple", "apple", "banana", "cherry", "fig", "pear"};
+    for (size_t i = 0; i < sizeof(sorted) / sizeof(sorted[0]); ++i) {
+        char *word;
+        assert(dsc_vector_at(vector, i, &word) == DSC_ERROR_OK);
+        assert(strcmp(word, sorted[i]) == 0);
+        free(word);
+    }
+
+    assert(dsc_vector_lower_bound(vector, "apple", &index) == DSC_ERROR_OK && index == 0);
+    assert(dsc_vector_upper_bound(vector, "apple", &index) == DSC_ERROR_OK && index == 2);
+    assert(dsc_vector_lower_bound(vector, "date", &index) == DSC_ERROR_OK && index == 4);
+    assert(dsc_vector_upper_bound(vector, "zucchini", &index) == DSC_ERROR_OK && index == 6);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+
+    // Records sort with the descriptor's compare callback
+    DSCElementType particle = {sizeof(Particle), NULL, particle_compare, NULL, NULL};
+    assert(dsc_vector_init_bytes(&vector, &particle, NULL) == DSC_ERROR_OK);
+    for (int i = 0; i < 300; ++i) {
+        Particle p = {(i * 131) % 300, {i, 0, 0}};
+        assert(dsc_vector_push_back(vector, &p) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_sort(vector) == DSC_ERROR_OK);
+    for (int i = 0; i < 300; ++i) {
+        Particle p;
+        assert(dsc_vector_at(vector, i, &p) == DSC_ERROR_OK && p.id == i);
+        assert(p.position[0] == (i * 71) % 300);
+    }
+
+    Particle key = {150, {0}};
+    assert(dsc_vector_lower_bound(vector, &key, &index) == DSC_ERROR_OK && index == 150);
+    assert(dsc_vector_upper_bound(vector, &key, &index) == DSC_ERROR_OK && index == 151);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+}
+
+void test_dsc_vector_move_swap(void) {
+    DSCVector *vector;
+    DSCVector *other;
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+    assert(dsc_vector_init(&other, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    // The vector takes the malloc'd strings as they are
+    char *strings[3];
+    for (int i = 0; i < 3; ++i) {
+        strings[i] = malloc(32);
+        snprintf(strings[i], 32, "string %d", i);
+        assert(dsc_vector_push_back_move(vector, strings[i]) == DSC_ERROR_OK);
+    }
+
+    void *data;
+    assert(dsc_vector_data(vector, &data) == DSC_ERROR_OK);
+    assert(((char **) data)[1] == strings[1]);
+
+    // Popping hands the same buffer back
+    char *popped;
+    assert(dsc_vector_pop_back(vector, &popped) == DSC_ERROR_OK);
+    assert(popped == strings[2]);
+    free(popped);
+
+    assert(dsc_vector_swap(vector, other) == DSC_ERROR_OK);
+
+    size_t size;
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 0);
+    assert(dsc_vector_size(other, &size) == DSC_ERROR_OK && size == 2);
+
+    char *front;
+    assert(dsc_vector_front(other, &front) == DSC_ERROR_OK);
+    assert(strcmp(front, "string 0") == 0);
+    free(front);
+
+    // Only vectors of one element type can swap
+    DSCVector *ints;
+    assert(dsc_vector_init(&ints, DSC_TYPE_INT) == DSC_ERROR_OK);
+    assert(dsc_vector_swap(vector, ints) == DSC_ERROR_INVALID_ARGUMENT);
+
+    int value = 5;
+    assert(dsc_vector_push_back_move(ints, &value) == DSC_ERROR_OK);
+    assert(dsc_vector_back(ints, &value) == DSC_ERROR_OK && value == 5);
+
+    assert(dsc_vector_deinit(ints) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(vector) == DSC_ERROR_OK);
+    assert(dsc_vector_deinit(other) == DSC_ERROR_OK);
+}
+
+static bool is_odd(const void *element, void *context) {
+    (void) context;
+    return *(const int *) element % 2 != 0;
+}
+
+static bool has_prefix(const void *element, void *context) {
+    return strncmp(element, context, strlen(context)) == 0;
+}
+
+void test_dsc_vector_erase_if(void) {
+    DSCVector *vector;
+    assert(dsc_vector_init(&vector, DSC_TYPE_INT) == DSC_ERROR_OK);
+
+    for (int i = 0; i < 1000; ++i) {
+        assert(dsc_vector_push_back(vector, &i) == DSC_ERROR_OK);
+    }
+
+    // The even values are kept, in order
+    size_t removed;
+    assert(dsc_vector_erase_if(vector, is_odd, NULL, &removed) == DSC_ERROR_OK);
+    assert(removed == 500);
+
+    size_t size;
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 500);
+
+    for (size_t i = 0; i < size; ++i) {
+        int value;
+        assert(dsc_vector_at(vector, i, &value) == DSC_ERROR_OK);
+        assert(value == (int) i * 2);
+    }
+
+    // Nothing left to match
+    assert(dsc_vector_erase_if(vector, is_odd, NULL, &removed) == DSC_ERROR_OK);
+    assert(removed == 0);
+
+    assert(dsc_vector_retain(vector, is_odd, NULL, NULL) == DSC_ERROR_OK);
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 0);
+
+    assert(dsc_vector_erase_if(NULL, is_odd, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_vector_erase_if(vector, NULL, NULL, NULL) == DSC_ERROR_INVALID_ARGUMENT);
+
+    dsc_vector_deinit(vector);
+
+    // Erased strings are freed, kept ones move down with their pointers
+    assert(dsc_vector_init(&vector, DSC_TYPE_STRING) == DSC_ERROR_OK);
+
+    char buffer[32];
+    for (int i = 0; i < 100; ++i) {
+        snprintf(buffer, sizeof(buffer), i % 3 ? "drop %d" : "keep %d", i);
+        assert(dsc_vector_push_back(vector, buffer) == DSC_ERROR_OK);
+    }
+
+    assert(dsc_vector_retain(vector, has_prefix, "keep", &removed) == DSC_ERROR_OK);
+    assert(removed == 66);
+    assert(dsc_vector_size(vector, &size) == DSC_ERROR_OK && size == 34);
+
+    char *string;
+    assert(dsc_vector_at(vector, 33, &string) == DSC_ERROR_OK);
+    assert(strcmp(string, "keep 99") == 0);
+    free(string);
+
+    dsc_vector_deinit(vector);
 }
 
 int main(void) {
@@ -250,6 +954,15 @@ int main(void) {
     test_dsc_vector_pop_back();
     test_dsc_vector_insert_erase();
     test_dsc_vector_clear();
+    test_dsc_vector_reserve_append_range();
+    test_dsc_vector_growth();
+    test_dsc_vector_at_view();
+    test_dsc_vector_bytes();
+    test_dsc_vector_cursor();
+    test_dsc_vector_numeric();
+    test_dsc_vector_sort();
+    test_dsc_vector_move_swap();
+    test_dsc_vector_erase_if();
 
     printf("All tests passed!\n");
 
@@ -0,0 +1,202 @@
+/*
+ * This file is part of libdsc.
+ *
+ * libdsc is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * libdsc is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libdsc. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dsc_work_deque.h"
+
+#define ITEMS 100000
+#define THIEVES 3
+
+void test_dsc_work_deque_owner(void) {
+    DSCWorkDeque *deque;
+
+    assert(dsc_work_deque_init(NULL, DSC_TYPE_INT, 0) == DSC_ERROR_INVALID_ARGUMENT);
+    assert(dsc_work_deque_init(&deque, DSC_TYPE_BYTES, 0) == DSC_ERROR_INVALID_TYPE);
+
+    assert(dsc_work_deque_init(&deque, DSC_TYPE_INT, 3) == DSC_ERROR_OK);
+
+    size_t capacity;
+    assert(dsc_work_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 4);
+
+    int value;
+    assert(dsc_work_deque_pop(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_work_deque_steal(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+
+    // Growing keeps every element at its position
+    for (int i = 0; i < 100; ++i) {
+        assert(dsc_work_deque_push(deque, &i) == DSC_ERROR_OK);
+    }
+
+    size_t size;
+    assert(dsc_work_deque_size(deque, &size) == DSC_ERROR_OK);
+    assert(size == 100);
+    assert(dsc_work_deque_capacity(deque, &capacity) == DSC_ERROR_OK);
+    assert(capacity == 128);
+
+    // The owner works newest first, thieves take the oldest
+    assert(dsc_work_deque_pop(deque, &value) == DSC_ERROR_OK && value == 99);
+    assert(dsc_work_deque_steal(deque, &value) == DSC_ERROR_OK && value == 0);
+    assert(dsc_work_deque_steal(deque, &value) == DSC_ERROR_OK && value == 1);
+
+    for (int expected = 98; expected >= 2; --expected) {
+        assert(dsc_work_deque_pop(deque, &value) == DSC_ERROR_OK && value == expected);
+    }
+
+    assert(dsc_work_deque_pop(deque, &value) == DSC_ERROR_EMPTY_CONTAINER);
+    assert(dsc_work_deque_size(deque, &size) == DSC_ERROR_OK && size == 0);
+
+    assert(dsc_work_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+void test_dsc_work_deque_strings(void) {
+    DSCWorkDeque *deque;
+    assert(dsc_work_deque_init(&deque, DSC_TYPE_STRING, 0) == DSC_ERROR_OK);
+
+    char buffer[16];
+    for (int i = 0; i < 10; ++i) {
+        snprintf(buffer, sizeof(buffer), "task-%d", i);
+        char *task = buffer;
+        assert(dsc_work_deque_push(deque, &task) == DSC_ERROR_OK);
+    }
+
+    char *task;
+    assert(dsc_work_deque_steal(deque, &task) == DSC_ERROR_OK);
+    assert(strcmp(task, "task-0") == 0);
+    free(task);
+    assert(dsc_work_deque_pop(deque, &task) == DSC_ERROR_OK);
+    assert(strcmp(task, "task-9") == 0);
+    free(task);
+
+    // The other eight are released by deinit
+    assert(dsc_work_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+typedef struct Thief {
+    DSCWorkDeque *deque;
+    _Atomic int *done;
+    unsigned char *seen;
+    _Atomic long long *sum;
+} Thief;
+
+static void *thief_run(void *arg) {
+    Thief *thief = arg;
+    long long sum = 0;
+
+    for (;;) {
+        int value;
+        if (dsc_work_deque_steal(thief->deque, &value) == DSC_ERROR_OK) {
+            assert(thief->seen[value] == 0);
+            thief->seen[value] = 1;
+            sum += value;
+        } else if (atomic_load(thief->done)) {
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+
+    atomic_fetch_add(thief->sum, sum);
+
+    return NULL;
+}
+
+void test_dsc_work_deque_concurrent(void) {
+    DSCWorkDeque *deque;
+    assert(dsc_work_deque_init(&deque, DSC_TYPE_INT, 2) == DSC_ERROR_OK);
+
+    _Atomic int done = 0;
+    _Atomic long long sum = 0;
+    unsigned char *seen = calloc(ITEMS, THIEVES + 1);
+    assert(seen != NULL);
+
+    pthread_t threads[THIEVES];
+    Thief thieves[THIEVES];
+
+    for (int t = 0; t < THIEVES; ++t) {
+        thieves[t] = (Thief) {deque, &done, seen + (size_t) (t + 1) * ITEMS, &sum};
+        assert(pthread_create(&threads[t], NULL, thief_run, &thieves[t]) == 0);
+    }
+
+    // The owner pushes in bursts and pops part of each one back, racing the
+    // thieves for the last elements and growing the slots as it goes
+    long long owner_sum = 0;
+    int next = 0;
+
+    while (next < ITEMS) {
+        for (int i = 0; i < 64 && next < ITEMS; ++i, ++next) {
+            assert(dsc_work_deque_push(deque, &next) == DSC_ERROR_OK);
+        }
+
+        for (int i = 0; i < 48; ++i) {
+            int value;
+            if (dsc_work_deque_pop(deque, &value) != DSC_ERROR_OK) {
+                break;
+            }
+
+            assert(seen[value] == 0);
+            seen[value] = 1;
+            owner_sum += value;
+        }
+
+        sched_yield();
+    }
+
+    int value;
+    while (dsc_work_deque_pop(deque, &value) == DSC_ERROR_OK) {
+        assert(seen[value] == 0);
+        seen[value] = 1;
+        owner_sum += value;
+    }
+
+    atomic_store(&done, 1);
+
+    for (int t = 0; t < THIEVES; ++t) {
+        assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+    // Every element went to exactly one thread
+    for (size_t i = 0; i < ITEMS; ++i) {
+        int owners = 0;
+        for (int t = 0; t <= THIEVES; ++t) {
+            owners += seen[(size_t) t * ITEMS + i];
+        }
+        assert(owners == 1);
+    }
+
+    assert(owner_sum + atomic_load(&sum) == (long long) ITEMS * (ITEMS - 1) / 2);
+
+    free(seen);
+    assert(dsc_work_deque_deinit(deque) == DSC_ERROR_OK);
+}
+
+int main(void) {
+    test_dsc_work_deque_owner();
+    test_dsc_work_deque_strings();
+    test_dsc_work_deque_concurrent();
+
+    printf("All tests passed!\n");
+
+    return EXIT_SUCCESS;
+}